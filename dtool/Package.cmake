@@ -348,6 +348,23 @@ package_option(ZLIB
 
 package_status(ZLIB "zlib")
 
+# LZ4
+find_package(LZ4 QUIET MODULE)
+
+package_option(LZ4
+  "Enables LZ4 compression of vertex data paged out to system RAM.")
+
+package_status(LZ4 "LZ4")
+
+# zstd
+find_package(Zstd QUIET MODULE)
+
+package_option(ZSTD
+  "Enables zstd compression of vertex data paged out to system RAM."
+  FOUND_AS Zstd)
+
+package_status(ZSTD "zstd")
+
 
 #
 # ------------ Image formats ------------
@@ -0,0 +1,563 @@
+/**
+ * PANDA 3D SOFTWARE
+ * Copyright (c) Carnegie Mellon University.  All rights reserved.
+ *
+ * All use of this software is subject to the terms of the revised BSD
+ * license.  You should have received a copy of this license along
+ * with this source code in a file named "LICENSE."
+ *
+ * @file collisionBroadphase.cxx
+ * @author djs3000
+ * @date 2026-10-16
+ */
+
+#include "collisionBroadphase.h"
+#include "config_collide.h"
+
+#include <algorithm>
+
+// We only vectorize the single-precision build; SSE2 is always available on
+// x86-64, and NEON on 64-bit ARM.
+#ifndef STDFLOAT_DOUBLE
+#if defined(__SSE2__) || (_M_IX86_FP >= 2) || defined(_M_X64) || defined(_M_AMD64)
+#include <xmmintrin.h>
+#include <emmintrin.h>
+#define BROADPHASE_USE_SSE2
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define BROADPHASE_USE_NEON
+#endif
+#endif
+
+/**
+ *
+ */
+CollisionBroadphase::
+CollisionBroadphase() :
+  _root(-1),
+  _free_list(-1),
+  _num_proxies(0),
+  _margin(collision_broadphase_margin)
+{
+}
+
+/**
+ * Removes all of the proxies from the tree.
+ */
+void CollisionBroadphase::
+clear() {
+  _nodes.clear();
+  _root = -1;
+  _free_list = -1;
+  _num_proxies = 0;
+}
+
+/**
+ * Adds a new box to the tree, and returns the proxy number that identifies
+ * it in subsequent calls.  The data is returned by the queries that find this
+ * box.
+ */
+int CollisionBroadphase::
+add_proxy(const LPoint3 &min_point, const LPoint3 &max_point, int data) {
+  int proxy = alloc_node();
+  Node &node = _nodes[proxy];
+
+  LVector3 margin = (max_point - min_point) * _margin;
+  node._min = min_point - margin;
+  node._max = max_point + margin;
+  node._child1 = -1;
+  node._child2 = -1;
+  node._height = 0;
+  node._data = data;
+
+  insert_leaf(proxy);
+  ++_num_proxies;
+  return proxy;
+}
+
+/**
+ * Removes the indicated proxy from the tree.  The proxy number may be reused
+ * by a subsequent call to add_proxy().
+ */
+void CollisionBroadphase::
+remove_proxy(int proxy) {
+  nassertv(proxy >= 0 && proxy < (int)_nodes.size());
+  nassertv(_nodes[proxy].is_leaf());
+
+  remove_leaf(proxy);
+  free_node(proxy);
+  --_num_proxies;
+}
+
+/**
+ * Updates the box of the indicated proxy.  If the new box is still within
+ * the enlarged box that is stored in the tree, and is not much smaller than
+ * it, nothing changes and false is returned.  Otherwise, the proxy is
+ * reinserted into the tree, and true is returned.
+ */
+bool CollisionBroadphase::
+move_proxy(int proxy, const LPoint3 &min_point, const LPoint3 &max_point) {
+  nassertr(proxy >= 0 && proxy < (int)_nodes.size(), false);
+  nassertr(_nodes[proxy].is_leaf(), false);
+
+  LVector3 margin = (max_point - min_point) * _margin;
+  Node &node = _nodes[proxy];
+  if (contains(node, min_point, max_point)) {
+    // It still fits.  But if the box has shrunk a lot, it is worth
+    // reinserting it anyway, since the oversized box would make false
+    // positives.
+    LPoint3 big_min = min_point - margin * 4;
+    LPoint3 big_max = max_point + margin * 4;
+    if (big_min[0] <= node._min[0] && node._max[0] <= big_max[0] &&
+        big_min[1] <= node._min[1] && node._max[1] <= big_max[1] &&
+        big_min[2] <= node._min[2] && node._max[2] <= big_max[2]) {
+      return false;
+    }
+  }
+
+  remove_leaf(proxy);
+
+  Node &moved = _nodes[proxy];
+  moved._min = min_point - margin;
+  moved._max = max_point + margin;
+
+  insert_leaf(proxy);
+  return true;
+}
+
+/**
+ * Appends to the result the data of all of the proxies whose boxes overlap
+ * with the indicated box.  The order of the results is not defined.
+ */
+void CollisionBroadphase::
+query_box(const LPoint3 &min_point, const LPoint3 &max_point,
+          pvector<int> &result) const {
+  if (_root < 0) {
+    return;
+  }
+
+  // Each node we visit pushes at most two children, so the stack can't get
+  // deeper than the tree is high.
+  int *stack = (int *)alloca(sizeof(int) * (get_height() + 2));
+  int stack_size = 0;
+  stack[stack_size++] = _root;
+
+  while (stack_size > 0) {
+    const Node &node = _nodes[stack[--stack_size]];
+    if (overlaps(node, min_point, max_point)) {
+      if (node.is_leaf()) {
+        result.push_back(node._data);
+      } else {
+        stack[stack_size++] = node._child1;
+        stack[stack_size++] = node._child2;
+      }
+    }
+  }
+}
+
+/**
+ * Appends to the result the data of all of the proxies whose boxes are
+ * intersected by the indicated line, restricted to the parametric range
+ * [t_min, t_max] along it.  The order of the results is not defined.
+ */
+void CollisionBroadphase::
+query_line(const LPoint3 &origin, const LVector3 &direction,
+           PN_stdfloat t_min, PN_stdfloat t_max,
+           pvector<int> &result) const {
+  if (_root < 0) {
+    return;
+  }
+
+  LVector3 inv_dir;
+  bool parallel[3];
+  for (int i = 0; i < 3; ++i) {
+    parallel[i] = (direction[i] == 0.0f);
+    inv_dir[i] = parallel[i] ? 0.0f : 1.0f / direction[i];
+  }
+
+  int *stack = (int *)alloca(sizeof(int) * (get_height() + 2));
+  int stack_size = 0;
+  stack[stack_size++] = _root;
+
+  while (stack_size > 0) {
+    const Node &node = _nodes[stack[--stack_size]];
+
+    // Clip the line against each pair of slabs in turn.
+    PN_stdfloat t0 = t_min;
+    PN_stdfloat t1 = t_max;
+    bool hit = true;
+    for (int i = 0; i < 3 && hit; ++i) {
+      if (parallel[i]) {
+        hit = (origin[i] >= node._min[i] && origin[i] <= node._max[i]);
+      } else {
+        PN_stdfloat ta = (node._min[i] - origin[i]) * inv_dir[i];
+        PN_stdfloat tb = (node._max[i] - origin[i]) * inv_dir[i];
+        if (ta > tb) {
+          std::swap(ta, tb);
+        }
+        t0 = std::max(t0, ta);
+        t1 = std::min(t1, tb);
+        hit = (t0 <= t1);
+      }
+    }
+
+    if (hit) {
+      if (node.is_leaf()) {
+        result.push_back(node._data);
+      } else {
+        stack[stack_size++] = node._child1;
+        stack[stack_size++] = node._child2;
+      }
+    }
+  }
+}
+
+/**
+ * Appends to the result the data of all of the proxies whose boxes are
+ * intersected by any of the rays of the packet, each along with a bit mask
+ * of the rays that intersect it, and where they enter it.  The tree is walked only once for all of
+ * the rays, which pays off when they are close together, as are the rays
+ * cast from one point.  The order of the results is not defined.
+ */
+void CollisionBroadphase::
+query_ray_packet(const RayPacket &packet, PacketHits &result) const {
+  if (_root < 0) {
+    return;
+  }
+
+  int *stack = (int *)alloca(sizeof(int) * (get_height() + 2));
+  int stack_size = 0;
+  stack[stack_size++] = _root;
+
+  while (stack_size > 0) {
+    const Node &node = _nodes[stack[--stack_size]];
+
+    PacketHit hit;
+    hit._lanes = test_ray_packet(packet, node, hit._t_near);
+    if (hit._lanes != 0) {
+      if (node.is_leaf()) {
+        hit._data = node._data;
+        result.push_back(hit);
+      } else {
+        stack[stack_size++] = node._child1;
+        stack[stack_size++] = node._child2;
+      }
+    }
+  }
+}
+
+/**
+ * Clips each ray of the packet against the slabs of the node's box, and
+ * returns a bit mask of the rays that intersect it.  The parametric distance
+ * at which each ray enters the box is stored in t_near.
+ */
+int CollisionBroadphase::
+test_ray_packet(const RayPacket &packet, const Node &node,
+                PN_stdfloat *t_near) {
+#if defined(BROADPHASE_USE_SSE2)
+  __m128 t0 = _mm_setzero_ps();
+  __m128 t1 = _mm_loadu_ps(packet._t_max);
+  for (int i = 0; i < 3; ++i) {
+    __m128 origin = _mm_loadu_ps(packet._origin[i]);
+    __m128 inv_dir = _mm_loadu_ps(packet._inv_dir[i]);
+    __m128 ta = _mm_mul_ps(_mm_sub_ps(_mm_set1_ps(node._min[i]), origin), inv_dir);
+    __m128 tb = _mm_mul_ps(_mm_sub_ps(_mm_set1_ps(node._max[i]), origin), inv_dir);
+    t0 = _mm_max_ps(t0, _mm_min_ps(ta, tb));
+    t1 = _mm_min_ps(t1, _mm_max_ps(ta, tb));
+  }
+  _mm_storeu_ps(t_near, t0);
+  return _mm_movemask_ps(_mm_cmple_ps(t0, t1));
+
+#elif defined(BROADPHASE_USE_NEON)
+  float32x4_t t0 = vdupq_n_f32(0.0f);
+  float32x4_t t1 = vld1q_f32(packet._t_max);
+  for (int i = 0; i < 3; ++i) {
+    float32x4_t origin = vld1q_f32(packet._origin[i]);
+    float32x4_t inv_dir = vld1q_f32(packet._inv_dir[i]);
+    float32x4_t ta = vmulq_f32(vsubq_f32(vdupq_n_f32(node._min[i]), origin), inv_dir);
+    float32x4_t tb = vmulq_f32(vsubq_f32(vdupq_n_f32(node._max[i]), origin), inv_dir);
+    t0 = vmaxq_f32(t0, vminq_f32(ta, tb));
+    t1 = vminq_f32(t1, vmaxq_f32(ta, tb));
+  }
+  vst1q_f32(t_near, t0);
+  uint32_t hit_lanes[4];
+  vst1q_u32(hit_lanes, vcleq_f32(t0, t1));
+  int lanes = 0;
+  for (int lane = 0; lane < 4; ++lane) {
+    lanes |= (hit_lanes[lane] & 1) << lane;
+  }
+  return lanes;
+
+#else
+  int lanes = 0;
+  for (int lane = 0; lane < 4; ++lane) {
+    PN_stdfloat t0 = 0.0f;
+    PN_stdfloat t1 = packet._t_max[lane];
+    for (int i = 0; i < 3; ++i) {
+      PN_stdfloat ta = (node._min[i] - packet._origin[i][lane]) * packet._inv_dir[i][lane];
+      PN_stdfloat tb = (node._max[i] - packet._origin[i][lane]) * packet._inv_dir[i][lane];
+      t0 = std::max(t0, std::min(ta, tb));
+      t1 = std::min(t1, std::max(ta, tb));
+    }
+    t_near[lane] = t0;
+    if (t0 <= t1) {
+      lanes |= 1 << lane;
+    }
+  }
+  return lanes;
+#endif
+}
+
+/**
+ * Checks the internal consistency of the tree.  Returns true if it is
+ * correct, false (after reporting an error) otherwise.  This is meant for
+ * debugging.
+ */
+bool CollisionBroadphase::
+validate() const {
+  int num_leaves = (_root < 0) ? 0 : validate_node(_root, -1);
+  if (num_leaves != _num_proxies) {
+    collide_cat.error()
+      << "CollisionBroadphase has " << num_leaves << " leaves, expected "
+      << _num_proxies << "\n";
+    return false;
+  }
+  return true;
+}
+
+/**
+ * Returns a node from the free list, or a newly allocated one.  Note that
+ * this may invalidate any references into _nodes.
+ */
+int CollisionBroadphase::
+alloc_node() {
+  if (_free_list < 0) {
+    _nodes.push_back(Node());
+    return (int)_nodes.size() - 1;
+  }
+
+  int index = _free_list;
+  _free_list = _nodes[index]._parent;
+  _nodes[index]._parent = -1;
+  return index;
+}
+
+/**
+ * Returns the indicated node to the free list.
+ */
+void CollisionBroadphase::
+free_node(int index) {
+  Node &node = _nodes[index];
+  node._parent = _free_list;
+  node._height = -1;
+  _free_list = index;
+}
+
+/**
+ * Inserts the indicated leaf, which is not yet part of the tree, at the place
+ * that adds the least total surface area to the tree.
+ */
+void CollisionBroadphase::
+insert_leaf(int leaf) {
+  if (_root < 0) {
+    _root = leaf;
+    _nodes[leaf]._parent = -1;
+    return;
+  }
+
+  LPoint3 leaf_min = _nodes[leaf]._min;
+  LPoint3 leaf_max = _nodes[leaf]._max;
+
+  // Walk down the tree, looking for the best sibling for the new leaf.
+  int index = _root;
+  while (!_nodes[index].is_leaf()) {
+    const Node &node = _nodes[index];
+
+    LPoint3 combined_min = leaf_min.fmin(node._min);
+    LPoint3 combined_max = leaf_max.fmax(node._max);
+    PN_stdfloat area = get_area(node._min, node._max);
+    PN_stdfloat combined_area = get_area(combined_min, combined_max);
+
+    // The cost of making the leaf a sibling of this node.
+    PN_stdfloat cost = 2.0f * combined_area;
+
+    // The minimum cost of pushing the leaf further down: all of the ancestors
+    // get bigger, including this one.
+    PN_stdfloat inheritance_cost = 2.0f * (combined_area - area);
+
+    PN_stdfloat child_costs[2];
+    int children[2] = {node._child1, node._child2};
+    for (int i = 0; i < 2; ++i) {
+      const Node &child = _nodes[children[i]];
+      PN_stdfloat child_area = get_area(leaf_min.fmin(child._min),
+                                        leaf_max.fmax(child._max));
+      if (!child.is_leaf()) {
+        child_area -= get_area(child._min, child._max);
+      }
+      child_costs[i] = child_area + inheritance_cost;
+    }
+
+    if (cost < child_costs[0] && cost < child_costs[1]) {
+      break;
+    }
+    index = (child_costs[0] < child_costs[1]) ? children[0] : children[1];
+  }
+
+  int sibling = index;
+  int new_parent = alloc_node();
+  int old_parent = _nodes[sibling]._parent;
+
+  Node &parent = _nodes[new_parent];
+  parent._parent = old_parent;
+  parent._child1 = sibling;
+  parent._child2 = leaf;
+  parent._data = -1;
+  refit(new_parent);
+
+  if (old_parent >= 0) {
+    Node &grand = _nodes[old_parent];
+    if (grand._child1 == sibling) {
+      grand._child1 = new_parent;
+    } else {
+      grand._child2 = new_parent;
+    }
+  } else {
+    _root = new_parent;
+  }
+  _nodes[sibling]._parent = new_parent;
+  _nodes[leaf]._parent = new_parent;
+
+  // Walk back up the tree, fixing the boxes and heights.
+  index = new_parent;
+  while (index >= 0) {
+    index = balance(index);
+    refit(index);
+    index = _nodes[index]._parent;
+  }
+}
+
+/**
+ * Removes the indicated leaf from the tree, along with its parent, which is
+ * replaced by the leaf's sibling.
+ */
+void CollisionBroadphase::
+remove_leaf(int leaf) {
+  if (leaf == _root) {
+    _root = -1;
+    return;
+  }
+
+  int parent = _nodes[leaf]._parent;
+  int grand = _nodes[parent]._parent;
+  int sibling = (_nodes[parent]._child1 == leaf)
+    ? _nodes[parent]._child2 : _nodes[parent]._child1;
+
+  free_node(parent);
+  _nodes[leaf]._parent = -1;
+
+  if (grand < 0) {
+    _root = sibling;
+    _nodes[sibling]._parent = -1;
+    return;
+  }
+
+  Node &grand_node = _nodes[grand];
+  if (grand_node._child1 == parent) {
+    grand_node._child1 = sibling;
+  } else {
+    grand_node._child2 = sibling;
+  }
+  _nodes[sibling]._parent = grand;
+
+  int index = grand;
+  while (index >= 0) {
+    index = balance(index);
+    refit(index);
+    index = _nodes[index]._parent;
+  }
+}
+
+/**
+ * If the subtrees of the indicated node differ in height by more than one,
+ * rotates the taller one up to take this node's place.  Returns the index of
+ * the node that is now at this position in the tree.
+ */
+int CollisionBroadphase::
+balance(int a) {
+  Node &node_a = _nodes[a];
+  if (node_a.is_leaf() || node_a._height < 2) {
+    return a;
+  }
+
+  int b = node_a._child1;
+  int c = node_a._child2;
+  int difference = _nodes[c]._height - _nodes[b]._height;
+  if (difference >= -1 && difference <= 1) {
+    return a;
+  }
+
+  // Rotate the taller child up.  Its taller grandchild stays with it, and the
+  // shorter one takes its place under a.
+  int up = (difference > 0) ? c : b;
+  Node &node_up = _nodes[up];
+  int g1 = node_up._child1;
+  int g2 = node_up._child2;
+  int keep = (_nodes[g1]._height > _nodes[g2]._height) ? g1 : g2;
+  int give = (keep == g1) ? g2 : g1;
+
+  node_up._child1 = a;
+  node_up._child2 = keep;
+  node_up._parent = node_a._parent;
+  node_a._parent = up;
+
+  if (node_up._parent >= 0) {
+    Node &parent = _nodes[node_up._parent];
+    if (parent._child1 == a) {
+      parent._child1 = up;
+    } else {
+      parent._child2 = up;
+    }
+  } else {
+    _root = up;
+  }
+
+  if (up == c) {
+    node_a._child2 = give;
+  } else {
+    node_a._child1 = give;
+  }
+  _nodes[give]._parent = a;
+
+  refit(a);
+  refit(up);
+  return up;
+}
+
+/**
+ * Recursively checks the indicated subtree, and returns the number of leaves
+ * in it, or a negative number if something is wrong.
+ */
+int CollisionBroadphase::
+validate_node(int index, int parent) const {
+  const Node &node = _nodes[index];
+  if (node._parent != parent) {
+    collide_cat.error()
+      << "CollisionBroadphase node " << index << " has parent "
+      << node._parent << ", expected " << parent << "\n";
+    return -(int)_nodes.size();
+  }
+  if (node.is_leaf()) {
+    return 1;
+  }
+
+  const Node &child1 = _nodes[node._child1];
+  const Node &child2 = _nodes[node._child2];
+  if (node._height != 1 + std::max(child1._height, child2._height) ||
+      !contains(node, child1._min, child1._max) ||
+      !contains(node, child2._min, child2._max)) {
+    collide_cat.error()
+      << "CollisionBroadphase node " << index << " does not fit its children\n";
+    return -(int)_nodes.size();
+  }
+  return validate_node(node._child1, index) + validate_node(node._child2, index);
+}
@@ -0,0 +1,134 @@
+/**
+ * PANDA 3D SOFTWARE
+ * Copyright (c) Carnegie Mellon University.  All rights reserved.
+ *
+ * All use of this software is subject to the terms of the revised BSD
+ * license.  You should have received a copy of this license along
+ * with this source code in a file named "LICENSE."
+ *
+ * @file collisionBroadphase.h
+ * @author djs3000
+ * @date 2026-10-16
+ */
+
+#ifndef COLLISIONBROADPHASE_H
+#define COLLISIONBROADPHASE_H
+
+#include "pandabase.h"
+#include "luse.h"
+#include "pvector.h"
+
+/**
+ * A dynamic tree of axis-aligned bounding boxes, used by the
+ * CollisionTraverser to quickly find the nodes whose bounds overlap with a
+ * collider's bounds.
+ *
+ * Each box added to the tree is a "proxy", identified by an integer, and
+ * carries an arbitrary integer of user data.  The tree stores each box
+ * enlarged by a small margin, so that moving a proxy by a small amount
+ * doesn't change the tree at all; otherwise, the proxy is removed and
+ * reinserted, and the tree is rebalanced by rotations as it goes, so that it
+ * stays shallow no matter what order the proxies are added in.
+ */
+class EXPCL_PANDA_COLLIDE CollisionBroadphase {
+public:
+  CollisionBroadphase();
+
+  void clear();
+
+  int add_proxy(const LPoint3 &min_point, const LPoint3 &max_point, int data);
+  void remove_proxy(int proxy);
+  bool move_proxy(int proxy, const LPoint3 &min_point, const LPoint3 &max_point);
+
+  INLINE int get_data(int proxy) const;
+  INLINE void set_data(int proxy, int data);
+  INLINE const LPoint3 &get_fat_min(int proxy) const;
+  INLINE const LPoint3 &get_fat_max(int proxy) const;
+
+  INLINE int get_num_proxies() const;
+  INLINE int get_height() const;
+
+  INLINE void set_margin(PN_stdfloat margin);
+  INLINE PN_stdfloat get_margin() const;
+
+  void query_box(const LPoint3 &min_point, const LPoint3 &max_point,
+                 pvector<int> &result) const;
+  void query_line(const LPoint3 &origin, const LVector3 &direction,
+                  PN_stdfloat t_min, PN_stdfloat t_max,
+                  pvector<int> &result) const;
+
+  // Up to four rays, stored in structure-of-arrays form so that they can be
+  // tested against a box together.  The unused lanes never hit anything.
+  class RayPacket {
+  public:
+    INLINE RayPacket();
+    INLINE void set_ray(int lane, const LPoint3 &origin,
+                        const LVector3 &direction, PN_stdfloat t_max);
+
+    PN_stdfloat _origin[3][4];
+    PN_stdfloat _inv_dir[3][4];
+    PN_stdfloat _t_max[4];
+  };
+
+  // The data of a proxy, along with a bit for each ray of the packet that
+  // intersects its box, and the parametric distance at which each of those
+  // rays enters it.
+  class PacketHit {
+  public:
+    int _data;
+    int _lanes;
+    PN_stdfloat _t_near[4];
+  };
+  typedef pvector<PacketHit> PacketHits;
+  void query_ray_packet(const RayPacket &packet, PacketHits &result) const;
+
+  bool validate() const;
+
+private:
+  class Node {
+  public:
+    INLINE bool is_leaf() const;
+
+    LPoint3 _min = LPoint3::zero();
+    LPoint3 _max = LPoint3::zero();
+
+    // For a node in the free list, _parent is the next free node.
+    int _parent = -1;
+    int _child1 = -1;
+    int _child2 = -1;
+
+    // The height of the subtree, 0 for a leaf, -1 for a free node.
+    int _height = -1;
+    int _data = -1;
+  };
+
+  int alloc_node();
+  void free_node(int index);
+
+  void insert_leaf(int leaf);
+  void remove_leaf(int leaf);
+  int balance(int index);
+  INLINE void refit(int index);
+
+  INLINE static PN_stdfloat get_area(const LPoint3 &min_point,
+                                     const LPoint3 &max_point);
+  INLINE static bool overlaps(const Node &node, const LPoint3 &min_point,
+                              const LPoint3 &max_point);
+  INLINE static bool contains(const Node &node, const LPoint3 &min_point,
+                              const LPoint3 &max_point);
+  static int test_ray_packet(const RayPacket &packet, const Node &node,
+                             PN_stdfloat *t_near);
+
+  int validate_node(int index, int parent) const;
+
+  typedef pvector<Node> Nodes;
+  Nodes _nodes;
+  int _root;
+  int _free_list;
+  int _num_proxies;
+  PN_stdfloat _margin;
+};
+
+#include "collisionBroadphase.I"
+
+#endif
@@ -53,6 +53,9 @@ make_copy() {
  */
 PT(CollisionEntry) CollisionCapsule::
 test_intersection(const CollisionEntry &entry) const {
+  if (entry.get_continuous()) {
+    return test_swept_intersection(entry, get_point_a(), get_radius());
+  }
   return entry.get_into()->test_intersection_from_capsule(entry);
 }
 
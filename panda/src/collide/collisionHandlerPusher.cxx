@@ -40,6 +40,7 @@ public:
 CollisionHandlerPusher::
 CollisionHandlerPusher() {
   _horizontal = pushers_horizontal;
+  _resolve_toi = false;
 }
 
 /**
@@ -57,6 +58,12 @@ write_datagram(Datagram &dg) const {
   CollisionHandlerPhysical::write_datagram(dg);
 
   dg.add_bool(_horizontal);
+
+  // This is only written if it is set, so that a pusher without it pickles
+  // the same way as before resolve_toi was added.
+  if (_resolve_toi) {
+    dg.add_bool(_resolve_toi);
+  }
 }
 
 /**
@@ -68,6 +75,7 @@ read_datagram(DatagramIterator &scan) {
   CollisionHandlerPhysical::read_datagram(scan);
 
   _horizontal = scan.get_bool();
+  _resolve_toi = (scan.get_remaining_size() > 0) && scan.get_bool();
 }
 
 /**
@@ -98,7 +106,19 @@ handle_entries() {
       okflag = false;
     } else {
       ColliderDef &def = (*ci).second;
-      {
+      LVector3 net_shove, force_normal;
+      if (_resolve_toi &&
+          shove_to_toi(def, from_node_path, entries, net_shove, force_normal)) {
+        CPT(TransformState) trans = def._target.get_transform();
+        LVecBase3 pos = trans->get_pos();
+        pos += net_shove * trans->get_mat();
+        def._target.set_transform(trans->set_pos(pos));
+        def.updated_transform();
+
+        apply_net_shove(def, net_shove, force_normal);
+        apply_linear_force(def, force_normal);
+
+      } else {
         // How to apply multiple shoves from different solids onto the same
         // collider?  One's first intuition is to vector sum all the shoves.
         // However, this causes problems when two parallel walls shove on the
@@ -267,6 +287,70 @@ handle_entries() {
   return okflag;
 }
 
+/**
+ * Looks for the entry in which the collider first ran into something along
+ * its path, as detected by a continuous traverser, and if there is one,
+ * computes the shove that moves the collider back to the point of impact and
+ * then slides it along the surface for the rest of its motion.  The shove is
+ * expressed in the coordinate space of the target node, like the ordinary
+ * shoves.  Returns false if there is no such entry, in which case the
+ * collider should be pushed out of the solids it is in as usual.
+ */
+bool CollisionHandlerPusher::
+shove_to_toi(ColliderDef &def, const NodePath &from_node_path,
+             const Entries &entries, LVector3 &net_shove,
+             LVector3 &force_normal) const {
+  const CollisionEntry *first = nullptr;
+  for (const CollisionEntry *entry : entries) {
+    if (entry->get_continuous() && entry->collided() &&
+        entry->get_t() > 0.0f && entry->get_t() < 1.0f &&
+        entry->has_contact_pos() && entry->has_contact_normal() &&
+        (first == nullptr || entry->get_t() < first->get_t())) {
+      first = entry;
+    }
+  }
+  if (first == nullptr) {
+    return false;
+  }
+
+  // The motion is measured in the space of the target's parent, since that
+  // is the space in which the target was moved.
+  NodePath parent = def._target.get_parent();
+  LVector3 remaining = from_node_path.get_pos_delta(parent) * (1.0f - first->get_t());
+  LVector3 normal = first->get_contact_normal(parent);
+  if (_horizontal) {
+    normal[2] = 0.0f;
+  }
+  if (!normal.normalize()) {
+    return false;
+  }
+
+  PN_stdfloat into = remaining.dot(normal);
+  if (into >= 0.0f) {
+    // It is moving away from the surface after all.
+    return false;
+  }
+
+  // Undoing the part of the remaining motion that goes into the surface
+  // leaves the collider sliding along it from the point of impact.
+  LVector3 shove = normal * -into;
+
+  #ifndef NDEBUG
+  if (collide_cat.is_debug()) {
+    collide_cat.debug()
+      << "Shove on " << from_node_path << " at time of impact " << first->get_t()
+      << " with " << first->get_into_node_path() << ": " << shove << "\n";
+  }
+  #endif
+
+  CPT(TransformState) inv_trans = def._target.get_transform()->get_inverse();
+  const LMatrix4 &inv_mat = inv_trans->get_mat();
+  net_shove = inv_mat.xform_vec(shove);
+  force_normal = inv_mat.xform_vec(normal);
+  force_normal.normalize();
+  return true;
+}
+
 /**
  * This is an optional hook for derived classes to do some work with the
  * ColliderDef and the force vector.
@@ -31,20 +31,28 @@ PUBLISHED:
   INLINE void set_horizontal(bool flag);
   INLINE bool get_horizontal() const;
 
+  INLINE void set_resolve_toi(bool flag);
+  INLINE bool get_resolve_toi() const;
+
 PUBLISHED:
   MAKE_PROPERTY(horizontal, get_horizontal, set_horizontal);
+  MAKE_PROPERTY(resolve_toi, get_resolve_toi, set_resolve_toi);
 
   void write_datagram(Datagram &destination) const;
   void read_datagram(DatagramIterator &source);
 
 protected:
   virtual bool handle_entries();
+  bool shove_to_toi(ColliderDef &def, const NodePath &from_node_path,
+                    const Entries &entries, LVector3 &net_shove,
+                    LVector3 &force_normal) const;
   virtual void apply_net_shove(
       ColliderDef &def, const LVector3 &net_shove,
       const LVector3 &force_normal);
   virtual void apply_linear_force(ColliderDef &def, const LVector3 &force);
 
   bool _horizontal;
+  bool _resolve_toi;
 
 
 public:
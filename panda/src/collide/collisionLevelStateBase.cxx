@@ -48,45 +48,49 @@ reserve(int num_colliders) {
 void CollisionLevelStateBase::
 prepare_collider(const ColliderDef &def, const NodePath &root) {
   _colliders.push_back(def);
+  _local_bounds.push_back(get_collider_bounds(def, root));
+  _parent_bounds = _local_bounds;
+}
 
+/**
+ * Returns the bounding volume of the indicated Collider, in the coordinate
+ * space of the root's parent, or NULL if the collider doesn't have a
+ * geometric bounding volume.
+ */
+CPT(GeometricBoundingVolume) CollisionLevelStateBase::
+get_collider_bounds(const ColliderDef &def, const NodePath &root) {
   const CollisionSolid *collider = def._collider;
   CPT(BoundingVolume) bv = collider->get_bounds();
   if (!bv->is_of_type(GeometricBoundingVolume::get_class_type())) {
-    _local_bounds.push_back(nullptr);
-  } else {
-    // We can use a plain pointer, rather than a PT() here, because we know we
-    // are going to save the volume in the vector, below.
-    GeometricBoundingVolume *gbv;
-    DCAST_INTO_V(gbv, bv->make_copy());
+    return nullptr;
+  }
 
-    // TODO: we need to make this logic work in the new relative world.  The
-    // bounding volume should be extended by the object's motion relative to
-    // each object it is considering a collision with.  That makes things
-    // complicated!
-    if (bv->as_bounding_sphere()) {
-      LPoint3 pos_delta = def._node_path.get_pos_delta(root);
+  PT(GeometricBoundingVolume) gbv = DCAST(GeometricBoundingVolume, bv->make_copy());
 
-      // LVector3 cap(pos_delta); if(cap.length()>fluid_cap_amount) {
-      // pos_delta=LPoint3(capcap.length())*fluid_cap_amount; }
-      if (pos_delta != LVector3::zero()) {
-        // If the node has a delta, we have to include the starting position
-        // in the volume as well.  We only do this for bounding spheres, since
-        // (a) other kinds of volumes may not extend so well, and (b) we've
-        // only implemented fluid-motion detection for CollisionSpheres
-        // anyway.
-        LMatrix4 inv_trans = LMatrix4::translate_mat(-pos_delta);
-        PT(GeometricBoundingVolume) gbv_prev;
-        gbv_prev = DCAST(GeometricBoundingVolume, bv->make_copy());
+  // TODO: we need to make this logic work in the new relative world.  The
+  // bounding volume should be extended by the object's motion relative to
+  // each object it is considering a collision with.  That makes things
+  // complicated!
+  if (bv->as_bounding_sphere()) {
+    LPoint3 pos_delta = def._node_path.get_pos_delta(root);
 
-        gbv_prev->xform(inv_trans);
-        gbv->extend_by(gbv_prev);
-      }
-    }
+    // LVector3 cap(pos_delta); if(cap.length()>fluid_cap_amount) {
+    // pos_delta=LPoint3(capcap.length())*fluid_cap_amount; }
+    if (pos_delta != LVector3::zero()) {
+      // If the node has a delta, we have to include the starting position in
+      // the volume as well.  We only do this for bounding spheres, since (a)
+      // other kinds of volumes may not extend so well, and (b) we've only
+      // implemented fluid-motion detection for CollisionSpheres anyway.
+      LMatrix4 inv_trans = LMatrix4::translate_mat(-pos_delta);
+      PT(GeometricBoundingVolume) gbv_prev;
+      gbv_prev = DCAST(GeometricBoundingVolume, bv->make_copy());
 
-    CPT(TransformState) rel_transform = def._node_path.get_transform(root.get_parent());
-    gbv->xform(rel_transform->get_mat());
-    _local_bounds.push_back(gbv);
+      gbv_prev->xform(inv_trans);
+      gbv->extend_by(gbv_prev);
+    }
   }
 
-  _parent_bounds = _local_bounds;
+  CPT(TransformState) rel_transform = def._node_path.get_transform(root.get_parent());
+  gbv->xform(rel_transform->get_mat());
+  return gbv;
 }
@@ -61,6 +61,9 @@ public:
   void reserve(int num_colliders);
   void prepare_collider(const ColliderDef &def, const NodePath &root);
 
+  static CPT(GeometricBoundingVolume) get_collider_bounds(const ColliderDef &def,
+                                                          const NodePath &root);
+
   INLINE NodePath get_node_path() const;
   INLINE PandaNode *node() const;
 
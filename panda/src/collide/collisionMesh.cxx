@@ -0,0 +1,1258 @@
+/**
+ * PANDA 3D SOFTWARE
+ * Copyright (c) Carnegie Mellon University.  All rights reserved.
+ *
+ * All use of this software is subject to the terms of the revised BSD
+ * license.  You should have received a copy of this license along
+ * with this source code in a file named "LICENSE."
+ *
+ * @file collisionMesh.cxx
+ * @author djs3000
+ * @date 2026-10-16
+ */
+
+#include "collisionMesh.h"
+#include "collisionEntry.h"
+#include "collisionSphere.h"
+#include "collisionLine.h"
+#include "collisionRay.h"
+#include "collisionSegment.h"
+#include "collisionCapsule.h"
+#include "collisionBox.h"
+#include "config_collide.h"
+#include "lightMutexHolder.h"
+#include "boundingBox.h"
+#include "datagram.h"
+#include "datagramIterator.h"
+#include "bamReader.h"
+#include "bamWriter.h"
+#include "geom.h"
+#include "geomTriangles.h"
+#include "geomLinestrips.h"
+#include "geomVertexReader.h"
+#include "geomVertexWriter.h"
+#include "indent.h"
+#include <algorithm>
+
+using std::max;
+using std::min;
+
+PStatCollector CollisionMesh::_volume_pcollector("Collision Volumes:CollisionMesh");
+PStatCollector CollisionMesh::_test_pcollector("Collision Tests:CollisionMesh");
+TypeHandle CollisionMesh::_type_handle;
+
+// The hierarchy is never made deeper than this, so that it can be traversed
+// with a fixed-size stack.
+static const int max_bvh_depth = 60;
+
+// Nodes with at most this many triangles are always made into leaves.
+static const size_t min_leaf_triangles = 2;
+
+// Nodes with more than this many triangles are never made into leaves,
+// unless the hierarchy is already as deep as it may become.
+static const size_t max_leaf_triangles = 8;
+
+// The number of bins along the split axis in which the centroids are sorted
+// for evaluating the surface area heuristic.
+static const int num_sah_bins = 16;
+
+// Used instead of an infinite reciprocal for a zero component of a ray's
+// direction, to avoid producing NaN in the slab test.
+static const PN_stdfloat huge_reciprocal = 1e30f;
+
+/**
+ * Clamps the indicated value to the range [0, 1].
+ */
+static INLINE PN_stdfloat
+clamp01(PN_stdfloat value) {
+  return max((PN_stdfloat)0, min(value, (PN_stdfloat)1));
+}
+
+/**
+ * Returns the parameters of the closest points between the two indicated
+ * segments.
+ */
+static void
+closest_segment_segment(PN_stdfloat &s, PN_stdfloat &t,
+                        const LPoint3 &p1, const LPoint3 &q1,
+                        const LPoint3 &p2, const LPoint3 &q2) {
+  LVector3 d1 = q1 - p1;
+  LVector3 d2 = q2 - p2;
+  LVector3 r = p1 - p2;
+  PN_stdfloat a = d1.length_squared();
+  PN_stdfloat e = d2.length_squared();
+  PN_stdfloat f = d2.dot(r);
+
+  if (a <= 0.0f && e <= 0.0f) {
+    s = t = 0.0f;
+    return;
+  }
+  if (a <= 0.0f) {
+    s = 0.0f;
+    t = clamp01(f / e);
+    return;
+  }
+
+  PN_stdfloat c = d1.dot(r);
+  if (e <= 0.0f) {
+    t = 0.0f;
+    s = clamp01(-c / a);
+    return;
+  }
+
+  PN_stdfloat b = d1.dot(d2);
+  PN_stdfloat denom = a * e - b * b;
+  s = (denom != 0.0f) ? clamp01((b * f - c * e) / denom) : 0.0f;
+  t = (b * s + f) / e;
+  if (t < 0.0f) {
+    t = 0.0f;
+    s = clamp01(-c / a);
+  } else if (t > 1.0f) {
+    t = 1.0f;
+    s = clamp01((b - c) / a);
+  }
+}
+
+/**
+ *
+ */
+CollisionMesh::
+CollisionMesh(const CollisionMesh &copy) :
+  CollisionSolid(copy),
+  _vertices(copy._vertices),
+  _triangles(copy._triangles),
+  _nodes(copy._nodes),
+  _bvh_stale(copy._bvh_stale.load(std::memory_order_relaxed))
+{
+}
+
+/**
+ *
+ */
+CollisionSolid *CollisionMesh::
+make_copy() {
+  return new CollisionMesh(*this);
+}
+
+/**
+ * Adds a new triangle to the mesh, given the indices of its three vertices,
+ * as returned by add_vertex().  The vertices should be in counterclockwise
+ * order when seen from the front of the triangle.
+ */
+void CollisionMesh::
+add_triangle(int a, int b, int c) {
+  int num_vertices = (int)_vertices.size();
+  nassertv(a >= 0 && a < num_vertices);
+  nassertv(b >= 0 && b < num_vertices);
+  nassertv(c >= 0 && c < num_vertices);
+
+  Triangle tri;
+  tri._v[0] = (uint32_t)a;
+  tri._v[1] = (uint32_t)b;
+  tri._v[2] = (uint32_t)c;
+  _triangles.push_back(tri);
+
+  _bvh_stale = true;
+  mark_viz_stale();
+}
+
+/**
+ * Adds all of the triangles of the indicated Geom to the mesh, after
+ * transforming its vertices by the indicated matrix.  Primitives other than
+ * polygons, as well as degenerate triangles, are ignored.
+ */
+void CollisionMesh::
+add_geom(const Geom *geom, const LMatrix4 &mat) {
+  nassertv(geom != nullptr);
+  if (geom->get_primitive_type() != Geom::PT_polygons) {
+    return;
+  }
+
+  CPT(GeomVertexData) vdata = geom->get_animated_vertex_data(true);
+  GeomVertexReader vertex(vdata, InternalName::get_vertex());
+  if (!vertex.has_column()) {
+    return;
+  }
+
+  size_t first_vertex = _vertices.size();
+  _vertices.reserve(first_vertex + vdata->get_num_rows());
+  while (!vertex.is_at_end()) {
+    _vertices.push_back(LPoint3(vertex.get_data3()) * mat);
+  }
+
+  int num_primitives = geom->get_num_primitives();
+  for (int i = 0; i < num_primitives; ++i) {
+    CPT(GeomPrimitive) tris = geom->get_primitive(i)->decompose();
+    nassertv(tris->is_of_type(GeomTriangles::get_class_type()));
+
+    int num_vertices = tris->get_num_vertices();
+    _triangles.reserve(_triangles.size() + num_vertices / 3);
+    for (int vi = 0; vi + 2 < num_vertices; vi += 3) {
+      Triangle tri;
+      tri._v[0] = (uint32_t)(first_vertex + tris->get_vertex(vi));
+      tri._v[1] = (uint32_t)(first_vertex + tris->get_vertex(vi + 1));
+      tri._v[2] = (uint32_t)(first_vertex + tris->get_vertex(vi + 2));
+      if (get_triangle_normal(tri).length_squared() > 0.0f) {
+        _triangles.push_back(tri);
+      }
+    }
+  }
+
+  _bvh_stale = true;
+  mark_internal_bounds_stale();
+  mark_viz_stale();
+}
+
+/**
+ * Builds the bounding volume hierarchy over the triangles.  This is done
+ * automatically the first time the mesh is tested against after it has been
+ * modified, but it may be called explicitly to avoid the delay at that
+ * point.  This reorders the triangles.
+ */
+void CollisionMesh::
+build_bvh() {
+  _nodes.clear();
+
+  size_t num_triangles = _triangles.size();
+  if (num_triangles == 0) {
+    _bvh_stale.store(false, std::memory_order_release);
+    return;
+  }
+
+  pvector<LPoint3> centroids(num_triangles, LPoint3::zero());
+  pvector<LPoint3> mins(num_triangles, LPoint3::zero());
+  pvector<LPoint3> maxs(num_triangles, LPoint3::zero());
+  pvector<uint32_t> order(num_triangles);
+  for (size_t i = 0; i < num_triangles; ++i) {
+    const Triangle &tri = _triangles[i];
+    const LPoint3 &a = _vertices[tri._v[0]];
+    const LPoint3 &b = _vertices[tri._v[1]];
+    const LPoint3 &c = _vertices[tri._v[2]];
+    mins[i].set(min(min(a[0], b[0]), c[0]),
+                min(min(a[1], b[1]), c[1]),
+                min(min(a[2], b[2]), c[2]));
+    maxs[i].set(max(max(a[0], b[0]), c[0]),
+                max(max(a[1], b[1]), c[1]),
+                max(max(a[2], b[2]), c[2]));
+    centroids[i] = (mins[i] + maxs[i]) * 0.5f;
+    order[i] = (uint32_t)i;
+  }
+
+  _nodes.reserve(num_triangles * 2 / min_leaf_triangles);
+  r_build_bvh(order, centroids, mins, maxs, 0, num_triangles, 0);
+
+  // Store the triangles in the order in which the leaves refer to them.
+  Triangles triangles;
+  triangles.reserve(num_triangles);
+  for (uint32_t ti : order) {
+    triangles.push_back(_triangles[ti]);
+  }
+  _triangles.swap(triangles);
+
+  if (collide_cat.is_debug()) {
+    collide_cat.debug()
+      << "Built BVH with " << _nodes.size() << " nodes over "
+      << num_triangles << " triangles\n";
+  }
+
+  _bvh_stale.store(false, std::memory_order_release);
+}
+
+/**
+ * Returns the number of levels of the bounding volume hierarchy, building it
+ * first if necessary.
+ */
+int CollisionMesh::
+get_bvh_depth() const {
+  check_bvh();
+  return _nodes.empty() ? 0 : r_get_bvh_depth(0);
+}
+
+/**
+ * Returns the point in space deemed to be the "origin" of the solid for
+ * collision purposes.  The closest intersection point to this origin point is
+ * considered to be the most significant.
+ */
+LPoint3 CollisionMesh::
+get_collision_origin() const {
+  CPT(BoundingVolume) bounds = get_bounds();
+  const BoundingBox *box = bounds->as_bounding_box();
+  if (box != nullptr && !box->is_empty()) {
+    return box->get_approx_center();
+  }
+  return LPoint3::origin();
+}
+
+/**
+ * Transforms the solid by the indicated matrix.
+ */
+void CollisionMesh::
+xform(const LMatrix4 &mat) {
+  for (LPoint3 &vertex : _vertices) {
+    vertex = vertex * mat;
+  }
+  if (!_triangles.empty()) {
+    _bvh_stale = true;
+  }
+  CollisionSolid::xform(mat);
+}
+
+/**
+ * Returns a PStatCollector that is used to count the number of bounding
+ * volume tests made against a solid of this type in a given frame.
+ */
+PStatCollector &CollisionMesh::
+get_volume_pcollector() {
+  return _volume_pcollector;
+}
+
+/**
+ * Returns a PStatCollector that is used to count the number of intersection
+ * tests made against a solid of this type in a given frame.
+ */
+PStatCollector &CollisionMesh::
+get_test_pcollector() {
+  return _test_pcollector;
+}
+
+/**
+ *
+ */
+void CollisionMesh::
+output(std::ostream &out) const {
+  out << "cmesh, " << _triangles.size() << " triangles";
+}
+
+/**
+ *
+ */
+void CollisionMesh::
+write(std::ostream &out, int indent_level) const {
+  indent(out, indent_level) << (*this) << "\n";
+}
+
+/**
+ *
+ */
+PT(BoundingVolume) CollisionMesh::
+compute_internal_bounds() const {
+  if (_vertices.empty()) {
+    return new BoundingBox;
+  }
+
+  LPoint3 n = _vertices[0];
+  LPoint3 x = n;
+  for (const LPoint3 &p : _vertices) {
+    n.set(min(n[0], p[0]),
+          min(n[1], p[1]),
+          min(n[2], p[2]));
+    x.set(max(x[0], p[0]),
+          max(x[1], p[1]),
+          max(x[2], p[2]));
+  }
+
+  return new BoundingBox(n, x);
+}
+
+/**
+ * This is part of the double-dispatch implementation of test_intersection().
+ * It is called when the "from" object is a sphere.
+ */
+PT(CollisionEntry) CollisionMesh::
+test_intersection_from_sphere(const CollisionEntry &entry) const {
+  const CollisionSphere *sphere;
+  DCAST_INTO_R(sphere, entry.get_from(), nullptr);
+
+  const LMatrix4 &wrt_mat = entry.get_wrt_mat();
+  LPoint3 from_center = sphere->get_center() * wrt_mat;
+  LVector3 from_radius_v =
+    LVector3(sphere->get_radius(), 0.0f, 0.0f) * wrt_mat;
+  PN_stdfloat from_radius = length(from_radius_v);
+  LVector3 from_extent(from_radius, from_radius, from_radius);
+
+  pvector<uint32_t> triangles;
+  if (find_triangles(from_center - from_extent, from_center + from_extent, triangles) == 0) {
+    return nullptr;
+  }
+
+  // Of all the triangles the sphere touches, we report the one it
+  // penetrates the deepest.
+  PN_stdfloat best_depth = -1.0f;
+  LPoint3 best_point;
+  LVector3 best_normal;
+  for (uint32_t ti : triangles) {
+    const Triangle &tri = _triangles[ti];
+    const LPoint3 &a = _vertices[tri._v[0]];
+    LVector3 normal = get_triangle_normal(tri);
+    if (!normal.normalize()) {
+      continue;
+    }
+
+    PN_stdfloat dist = normal.dot(from_center - a);
+    if (dist > from_radius || dist < -from_radius) {
+      continue;
+    }
+
+    LPoint3 point = closest_point_on_triangle(from_center, a,
+      _vertices[tri._v[1]], _vertices[tri._v[2]]);
+    if ((from_center - point).length_squared() > from_radius * from_radius) {
+      continue;
+    }
+
+    PN_stdfloat depth = from_radius - dist;
+    if (depth > best_depth) {
+      best_depth = depth;
+      best_point = point;
+      best_normal = normal;
+    }
+  }
+
+  if (best_depth < 0.0f) {
+    return nullptr;
+  }
+
+  if (collide_cat.is_debug()) {
+    collide_cat.debug()
+      << "intersection detected from " << entry.get_from_node_path()
+      << " into " << entry.get_into_node_path() << "\n";
+  }
+  PT(CollisionEntry) new_entry = new CollisionEntry(entry);
+
+  LVector3 normal = (has_effective_normal() && sphere->get_respect_effective_normal()) ? get_effective_normal() : best_normal;
+
+  new_entry->set_surface_normal(normal);
+  new_entry->set_surface_point(best_point);
+  new_entry->set_interior_point(best_point - normal * best_depth);
+
+  return new_entry;
+}
+
+/**
+ * This is part of the double-dispatch implementation of test_intersection().
+ * It is called when the "from" object is a line.
+ */
+PT(CollisionEntry) CollisionMesh::
+test_intersection_from_line(const CollisionEntry &entry) const {
+  const CollisionLine *line;
+  DCAST_INTO_R(line, entry.get_from(), nullptr);
+
+  const LMatrix4 &wrt_mat = entry.get_wrt_mat();
+  LPoint3 from_origin = line->get_origin() * wrt_mat;
+  LVector3 from_direction = line->get_direction() * wrt_mat;
+
+  return test_line(entry, from_origin, from_direction,
+                   -make_inf((PN_stdfloat)0), make_inf((PN_stdfloat)0),
+                   line->get_respect_effective_normal());
+}
+
+/**
+ * This is part of the double-dispatch implementation of test_intersection().
+ * It is called when the "from" object is a ray.
+ */
+PT(CollisionEntry) CollisionMesh::
+test_intersection_from_ray(const CollisionEntry &entry) const {
+  const CollisionRay *ray;
+  DCAST_INTO_R(ray, entry.get_from(), nullptr);
+
+  const LMatrix4 &wrt_mat = entry.get_wrt_mat();
+  LPoint3 from_origin = ray->get_origin() * wrt_mat;
+  LVector3 from_direction = ray->get_direction() * wrt_mat;
+
+  return test_line(entry, from_origin, from_direction,
+                   0.0f, make_inf((PN_stdfloat)0),
+                   ray->get_respect_effective_normal());
+}
+
+/**
+ * This is part of the double-dispatch implementation of test_intersection().
+ * It is called when the "from" object is a segment.
+ */
+PT(CollisionEntry) CollisionMesh::
+test_intersection_from_segment(const CollisionEntry &entry) const {
+  const CollisionSegment *segment;
+  DCAST_INTO_R(segment, entry.get_from(), nullptr);
+
+  const LMatrix4 &wrt_mat = entry.get_wrt_mat();
+  LPoint3 from_a = segment->get_point_a() * wrt_mat;
+  LPoint3 from_b = segment->get_point_b() * wrt_mat;
+
+  return test_line(entry, from_a, from_b - from_a, 0.0f, 1.0f,
+                   segment->get_respect_effective_normal());
+}
+
+/**
+ * This is part of the double-dispatch implementation of test_intersection().
+ * It is called when the "from" object is a capsule.
+ */
+PT(CollisionEntry) CollisionMesh::
+test_intersection_from_capsule(const CollisionEntry &entry) const {
+  const CollisionCapsule *capsule;
+  DCAST_INTO_R(capsule, entry.get_from(), nullptr);
+
+  const LMatrix4 &wrt_mat = entry.get_wrt_mat();
+  LPoint3 from_a = capsule->get_point_a() * wrt_mat;
+  LPoint3 from_b = capsule->get_point_b() * wrt_mat;
+  LVector3 from_radius_v =
+    LVector3(capsule->get_radius(), 0.0f, 0.0f) * wrt_mat;
+  PN_stdfloat from_radius = length(from_radius_v);
+  LVector3 from_extent(from_radius, from_radius, from_radius);
+
+  LPoint3 min_point(min(from_a[0], from_b[0]),
+                    min(from_a[1], from_b[1]),
+                    min(from_a[2], from_b[2]));
+  LPoint3 max_point(max(from_a[0], from_b[0]),
+                    max(from_a[1], from_b[1]),
+                    max(from_a[2], from_b[2]));
+
+  pvector<uint32_t> triangles;
+  if (find_triangles(min_point - from_extent, max_point + from_extent, triangles) == 0) {
+    return nullptr;
+  }
+
+  // As for the sphere, we report the triangle that is penetrated the deepest
+  // by the closest point of the capsule's inner segment.
+  PN_stdfloat best_depth = -1.0f;
+  LPoint3 best_point;
+  LVector3 best_normal;
+  for (uint32_t ti : triangles) {
+    const Triangle &tri = _triangles[ti];
+    const LPoint3 &a = _vertices[tri._v[0]];
+    LVector3 normal = get_triangle_normal(tri);
+    if (!normal.normalize()) {
+      continue;
+    }
+
+    LPoint3 seg_point, tri_point;
+    PN_stdfloat dist = closest_segment_triangle(seg_point, tri_point,
+      from_a, from_b, a, _vertices[tri._v[1]], _vertices[tri._v[2]]);
+    if (dist > from_radius) {
+      continue;
+    }
+
+    PN_stdfloat depth = from_radius - normal.dot(seg_point - tri_point);
+    if (depth > best_depth) {
+      best_depth = depth;
+      best_point = tri_point;
+      best_normal = normal;
+    }
+  }
+
+  if (best_depth < 0.0f) {
+    return nullptr;
+  }
+
+  if (collide_cat.is_debug()) {
+    collide_cat.debug()
+      << "intersection detected from " << entry.get_from_node_path()
+      << " into " << entry.get_into_node_path() << "\n";
+  }
+  PT(CollisionEntry) new_entry = new CollisionEntry(entry);
+
+  LVector3 normal = (has_effective_normal() && capsule->get_respect_effective_normal()) ? get_effective_normal() : best_normal;
+
+  new_entry->set_surface_normal(normal);
+  new_entry->set_surface_point(best_point);
+  new_entry->set_interior_point(best_point - normal * best_depth);
+
+  return new_entry;
+}
+
+/**
+ * This is part of the double-dispatch implementation of test_intersection().
+ * It is called when the "from" object is a box.
+ */
+PT(CollisionEntry) CollisionMesh::
+test_intersection_from_box(const CollisionEntry &entry) const {
+  const CollisionBox *box;
+  DCAST_INTO_R(box, entry.get_from(), nullptr);
+
+  const LMatrix4 &wrt_mat = entry.get_wrt_mat();
+  LPoint3 from_center = box->get_center() * wrt_mat;
+  LVector3 from_extents = box->get_dimensions() * 0.5f;
+
+  // Determine the basis vectors describing the box, scaled by its extents.
+  LVector3 box_axes[3] = {
+    wrt_mat.get_row3(0) * from_extents[0],
+    wrt_mat.get_row3(1) * from_extents[1],
+    wrt_mat.get_row3(2) * from_extents[2],
+  };
+
+  LVector3 from_extent(
+    cabs(box_axes[0][0]) + cabs(box_axes[1][0]) + cabs(box_axes[2][0]),
+    cabs(box_axes[0][1]) + cabs(box_axes[1][1]) + cabs(box_axes[2][1]),
+    cabs(box_axes[0][2]) + cabs(box_axes[1][2]) + cabs(box_axes[2][2]));
+
+  pvector<uint32_t> triangles;
+  if (find_triangles(from_center - from_extent, from_center + from_extent, triangles) == 0) {
+    return nullptr;
+  }
+
+  PN_stdfloat best_depth = -1.0f;
+  LPoint3 best_point;
+  LVector3 best_normal;
+  for (uint32_t ti : triangles) {
+    const Triangle &tri = _triangles[ti];
+    LPoint3 v[3] = {
+      _vertices[tri._v[0]] - from_center,
+      _vertices[tri._v[1]] - from_center,
+      _vertices[tri._v[2]] - from_center,
+    };
+    LVector3 normal = get_triangle_normal(tri);
+    if (!normal.normalize()) {
+      continue;
+    }
+
+    // First the plane of the triangle.
+    PN_stdfloat radius = cabs(normal.dot(box_axes[0])) +
+                         cabs(normal.dot(box_axes[1])) +
+                         cabs(normal.dot(box_axes[2]));
+    PN_stdfloat dist = -normal.dot(v[0]);
+    if (dist > radius || dist < -radius) {
+      continue;
+    }
+
+    // Then the separating axis test for the box axes and the cross products
+    // of the box axes with the triangle's edges.
+    LVector3 edges[3] = {v[1] - v[0], v[2] - v[1], v[0] - v[2]};
+    bool separated = false;
+    for (int i = 0; i < 12 && !separated; ++i) {
+      LVector3 axis = (i < 3) ? box_axes[i] : edges[(i - 3) / 3].cross(box_axes[(i - 3) % 3]);
+      PN_stdfloat p0 = axis.dot(v[0]);
+      PN_stdfloat p1 = axis.dot(v[1]);
+      PN_stdfloat p2 = axis.dot(v[2]);
+      PN_stdfloat r = cabs(axis.dot(box_axes[0])) +
+                      cabs(axis.dot(box_axes[1])) +
+                      cabs(axis.dot(box_axes[2]));
+      separated = (min(min(p0, p1), p2) > r || max(max(p0, p1), p2) < -r);
+    }
+    if (separated) {
+      continue;
+    }
+
+    PN_stdfloat depth = radius - dist;
+    if (depth > best_depth) {
+      best_depth = depth;
+      best_normal = normal;
+
+      // The deepest corner of the box, projected onto the triangle's plane.
+      LPoint3 corner = from_center;
+      for (int i = 0; i < 3; ++i) {
+        corner -= box_axes[i] * ((normal.dot(box_axes[i]) > 0.0f) ? 1.0f : -1.0f);
+      }
+      best_point = corner + normal * depth;
+    }
+  }
+
+  if (best_depth < 0.0f) {
+    return nullptr;
+  }
+
+  if (collide_cat.is_debug()) {
+    collide_cat.debug()
+      << "intersection detected from " << entry.get_from_node_path()
+      << " into " << entry.get_into_node_path() << "\n";
+  }
+  PT(CollisionEntry) new_entry = new CollisionEntry(entry);
+
+  LVector3 normal = (has_effective_normal() && box->get_respect_effective_normal()) ? get_effective_normal() : best_normal;
+
+  new_entry->set_surface_normal(normal);
+  new_entry->set_surface_point(best_point);
+  new_entry->set_interior_point(best_point - best_normal * best_depth);
+
+  return new_entry;
+}
+
+/**
+ * Fills the _viz_geom GeomNode up with Geoms suitable for rendering this
+ * solid.
+ */
+void CollisionMesh::
+fill_viz_geom() {
+  if (collide_cat.is_debug()) {
+    collide_cat.debug()
+      << "Recomputing viz for " << *this << "\n";
+  }
+
+  PT(GeomVertexData) vdata = new GeomVertexData
+    ("collision", GeomVertexFormat::get_v3(),
+     Geom::UH_static);
+  vdata->unclean_set_num_rows(_vertices.size());
+  GeomVertexWriter vertex(vdata, InternalName::get_vertex());
+  for (const LPoint3 &vert : _vertices) {
+    vertex.set_data3(vert);
+  }
+
+  PT(GeomTriangles) mesh = new GeomTriangles(Geom::UH_static);
+  PT(GeomLinestrips) wire = new GeomLinestrips(Geom::UH_static);
+  for (const Triangle &tri : _triangles) {
+    mesh->add_vertices(tri._v[0], tri._v[1], tri._v[2]);
+    mesh->close_primitive();
+    wire->add_vertices(tri._v[0], tri._v[1], tri._v[2]);
+    wire->add_vertex(tri._v[0]);
+    wire->close_primitive();
+  }
+
+  PT(Geom) geom = new Geom(vdata);
+  PT(Geom) geom2 = new Geom(vdata);
+  geom->add_primitive(mesh);
+  geom2->add_primitive(wire);
+  _viz_geom->add_geom(geom, get_solid_viz_state());
+  _viz_geom->add_geom(geom2, get_wireframe_viz_state());
+
+  _bounds_viz_geom->add_geom(geom, get_solid_bounds_viz_state());
+  _bounds_viz_geom->add_geom(geom2, get_wireframe_bounds_viz_state());
+}
+
+/**
+ * Recursively builds the part of the hierarchy over the triangles in the
+ * indicated range of the order vector, which is reordered such that each
+ * node's triangles are contiguous.  Returns the index of the new node.
+ */
+uint32_t CollisionMesh::
+r_build_bvh(pvector<uint32_t> &order, const pvector<LPoint3> &centroids,
+            const pvector<LPoint3> &mins, const pvector<LPoint3> &maxs,
+            size_t begin, size_t end, int depth) {
+  uint32_t index = (uint32_t)_nodes.size();
+  _nodes.resize(index + 1);
+
+  LPoint3 node_min = mins[order[begin]];
+  LPoint3 node_max = maxs[order[begin]];
+  LPoint3 centroid_min = centroids[order[begin]];
+  LPoint3 centroid_max = centroid_min;
+  for (size_t i = begin + 1; i < end; ++i) {
+    uint32_t ti = order[i];
+    for (int j = 0; j < 3; ++j) {
+      node_min[j] = min(node_min[j], mins[ti][j]);
+      node_max[j] = max(node_max[j], maxs[ti][j]);
+      centroid_min[j] = min(centroid_min[j], centroids[ti][j]);
+      centroid_max[j] = max(centroid_max[j], centroids[ti][j]);
+    }
+  }
+  _nodes[index]._min = node_min;
+  _nodes[index]._max = node_max;
+
+  size_t count = end - begin;
+  if (count <= min_leaf_triangles || depth >= max_bvh_depth) {
+    _nodes[index]._index = (uint32_t)begin;
+    _nodes[index]._count = (uint32_t)count;
+    return index;
+  }
+
+  // Split along the axis in which the centroids are spread the most.
+  LVector3 centroid_size = centroid_max - centroid_min;
+  int axis = 0;
+  if (centroid_size[1] > centroid_size[axis]) {
+    axis = 1;
+  }
+  if (centroid_size[2] > centroid_size[axis]) {
+    axis = 2;
+  }
+
+  size_t mid = begin;
+  if (centroid_size[axis] > 0.0f) {
+    // Sort the centroids into bins, and find the boundary between two bins
+    // that minimizes the surface area heuristic.
+    PN_stdfloat scale = num_sah_bins / centroid_size[axis];
+    int bin_counts[num_sah_bins] = {0};
+    LPoint3 bin_mins[num_sah_bins];
+    LPoint3 bin_maxs[num_sah_bins];
+    for (size_t i = begin; i < end; ++i) {
+      uint32_t ti = order[i];
+      int bin = min((int)((centroids[ti][axis] - centroid_min[axis]) * scale), num_sah_bins - 1);
+      if (bin_counts[bin]++ == 0) {
+        bin_mins[bin] = mins[ti];
+        bin_maxs[bin] = maxs[ti];
+      } else {
+        for (int j = 0; j < 3; ++j) {
+          bin_mins[bin][j] = min(bin_mins[bin][j], mins[ti][j]);
+          bin_maxs[bin][j] = max(bin_maxs[bin][j], maxs[ti][j]);
+        }
+      }
+    }
+
+    // Sweep from the right to get the cost of each right-hand side, then
+    // from the left to combine it with the left-hand side.
+    PN_stdfloat right_costs[num_sah_bins];
+    LPoint3 sweep_min, sweep_max;
+    int sweep_count = 0;
+    for (int bin = num_sah_bins - 1; bin > 0; --bin) {
+      if (bin_counts[bin] != 0) {
+        if (sweep_count == 0) {
+          sweep_min = bin_mins[bin];
+          sweep_max = bin_maxs[bin];
+        } else {
+          for (int j = 0; j < 3; ++j) {
+            sweep_min[j] = min(sweep_min[j], bin_mins[bin][j]);
+            sweep_max[j] = max(sweep_max[j], bin_maxs[bin][j]);
+          }
+        }
+        sweep_count += bin_counts[bin];
+      }
+      LVector3 d = sweep_max - sweep_min;
+      right_costs[bin] = (sweep_count == 0) ? 0.0f :
+        sweep_count * (d[0] * d[1] + d[1] * d[2] + d[2] * d[0]);
+    }
+
+    PN_stdfloat best_cost = make_inf((PN_stdfloat)0);
+    int best_bin = 0;
+    sweep_count = 0;
+    for (int bin = 0; bin < num_sah_bins - 1; ++bin) {
+      if (bin_counts[bin] != 0) {
+        if (sweep_count == 0) {
+          sweep_min = bin_mins[bin];
+          sweep_max = bin_maxs[bin];
+        } else {
+          for (int j = 0; j < 3; ++j) {
+            sweep_min[j] = min(sweep_min[j], bin_mins[bin][j]);
+            sweep_max[j] = max(sweep_max[j], bin_maxs[bin][j]);
+          }
+        }
+        sweep_count += bin_counts[bin];
+      }
+      if (sweep_count == 0 || sweep_count == (int)count) {
+        continue;
+      }
+      LVector3 d = sweep_max - sweep_min;
+      PN_stdfloat cost = sweep_count * (d[0] * d[1] + d[1] * d[2] + d[2] * d[0]) +
+                         right_costs[bin + 1];
+      if (cost < best_cost) {
+        best_cost = cost;
+        best_bin = bin;
+      }
+    }
+
+    // Compare this to the cost of testing all the triangles in a leaf; both
+    // are relative to the half surface area of this node, and we count the
+    // cost of visiting the two children as that of testing one triangle.
+    LVector3 d = node_max - node_min;
+    PN_stdfloat half_area = d[0] * d[1] + d[1] * d[2] + d[2] * d[0];
+    if (count <= max_leaf_triangles &&
+        (half_area <= 0.0f || 1.0f + best_cost / half_area >= (PN_stdfloat)count)) {
+      _nodes[index]._index = (uint32_t)begin;
+      _nodes[index]._count = (uint32_t)count;
+      return index;
+    }
+
+    if (best_cost < make_inf((PN_stdfloat)0)) {
+      mid = std::partition(order.begin() + begin, order.begin() + end,
+        [&](uint32_t ti) {
+          return min((int)((centroids[ti][axis] - centroid_min[axis]) * scale), num_sah_bins - 1) <= best_bin;
+        }) - order.begin();
+    }
+  }
+
+  if (mid == begin || mid == end) {
+    // The heuristic did not help us; all of the centroids are in one place.
+    // Just split the triangles in half.
+    mid = begin + count / 2;
+    std::nth_element(order.begin() + begin, order.begin() + mid, order.begin() + end,
+      [&](uint32_t a, uint32_t b) {
+        return centroids[a][axis] < centroids[b][axis];
+      });
+  }
+
+  r_build_bvh(order, centroids, mins, maxs, begin, mid, depth + 1);
+  uint32_t right = r_build_bvh(order, centroids, mins, maxs, mid, end, depth + 1);
+  _nodes[index]._index = right;
+  _nodes[index]._count = 0;
+  return index;
+}
+
+/**
+ * Returns the depth of the subtree rooted at the indicated node.
+ */
+int CollisionMesh::
+r_get_bvh_depth(uint32_t index) const {
+  const BVHNode &node = _nodes[index];
+  if (node.is_leaf()) {
+    return 1;
+  }
+  return 1 + max(r_get_bvh_depth(index + 1), r_get_bvh_depth(node._index));
+}
+
+/**
+ * The implementation of the line, ray and segment tests.  Finds the closest
+ * triangle that the line crosses between the indicated parametric values,
+ * and returns a new CollisionEntry for it, or nullptr if there is none.
+ */
+PT(CollisionEntry) CollisionMesh::
+test_line(const CollisionEntry &entry,
+          const LPoint3 &origin, const LVector3 &direction,
+          PN_stdfloat t_min, PN_stdfloat t_max,
+          bool respect_effective_normal) const {
+  check_bvh();
+  if (_nodes.empty()) {
+    return nullptr;
+  }
+
+  LVector3 inv_dir;
+  for (int i = 0; i < 3; ++i) {
+    inv_dir[i] = (direction[i] != 0.0f) ? 1.0f / direction[i] :
+      (std::signbit(direction[i]) ? -huge_reciprocal : huge_reciprocal);
+  }
+
+  PN_stdfloat best_t = t_max;
+  const Triangle *best_tri = nullptr;
+  int num_visited = 0;
+
+  uint32_t stack[max_bvh_depth + 4];
+  int sp = 0;
+  stack[sp++] = 0;
+  while (sp > 0) {
+    const BVHNode &node = _nodes[stack[--sp]];
+    ++num_visited;
+
+    PN_stdfloat t;
+    if (!intersects_box(t, node, origin, inv_dir, t_min, best_t)) {
+      continue;
+    }
+
+    if (node.is_leaf()) {
+      const Triangle *tri = &_triangles[node._index];
+      const Triangle *end = tri + node._count;
+      for (; tri != end; ++tri) {
+        if (intersects_triangle(t, origin, direction, _vertices[tri->_v[0]],
+                                _vertices[tri->_v[1]], _vertices[tri->_v[2]]) &&
+            t >= t_min && t <= best_t) {
+          best_t = t;
+          best_tri = tri;
+        }
+      }
+    } else {
+      // Visit the nearer child first, so that the farther one may be culled
+      // by the hit we find in the nearer one.
+      uint32_t near_child = (uint32_t)(&node - &_nodes[0]) + 1;
+      uint32_t far_child = node._index;
+      PN_stdfloat t_near, t_far;
+      bool hit_near = intersects_box(t_near, _nodes[near_child], origin, inv_dir, t_min, best_t);
+      bool hit_far = intersects_box(t_far, _nodes[far_child], origin, inv_dir, t_min, best_t);
+      if (hit_near && hit_far) {
+        if (t_far < t_near) {
+          std::swap(near_child, far_child);
+        }
+        stack[sp++] = far_child;
+        stack[sp++] = near_child;
+      } else if (hit_near) {
+        stack[sp++] = near_child;
+      } else if (hit_far) {
+        stack[sp++] = far_child;
+      }
+    }
+  }
+  _volume_pcollector.add_level(num_visited);
+
+  if (best_tri == nullptr) {
+    return nullptr;
+  }
+
+  if (collide_cat.is_debug()) {
+    collide_cat.debug()
+      << "intersection detected from " << entry.get_from_node_path()
+      << " into " << entry.get_into_node_path() << "\n";
+  }
+  PT(CollisionEntry) new_entry = new CollisionEntry(entry);
+
+  LVector3 normal;
+  if (has_effective_normal() && respect_effective_normal) {
+    normal = get_effective_normal();
+  } else {
+    normal = get_triangle_normal(*best_tri);
+    normal.normalize();
+  }
+
+  new_entry->set_surface_normal(normal);
+  new_entry->set_surface_point(origin + best_t * direction);
+
+  return new_entry;
+}
+
+/**
+ * Fills the result vector with the indices of all triangles in the leaves
+ * of the hierarchy whose boxes overlap with the indicated box.  Returns the
+ * number of triangles found.
+ */
+int CollisionMesh::
+find_triangles(const LPoint3 &min_point, const LPoint3 &max_point,
+               pvector<uint32_t> &result) const {
+  check_bvh();
+  if (_nodes.empty()) {
+    return 0;
+  }
+
+  int num_visited = 0;
+  uint32_t stack[max_bvh_depth + 4];
+  int sp = 0;
+  stack[sp++] = 0;
+  while (sp > 0) {
+    uint32_t index = stack[--sp];
+    const BVHNode &node = _nodes[index];
+    ++num_visited;
+    if (!overlaps(node, min_point, max_point)) {
+      continue;
+    }
+
+    if (node.is_leaf()) {
+      for (uint32_t ti = node._index; ti < node._index + node._count; ++ti) {
+        result.push_back(ti);
+      }
+    } else {
+      stack[sp++] = node._index;
+      stack[sp++] = index + 1;
+    }
+  }
+  _volume_pcollector.add_level(num_visited);
+
+  return (int)result.size();
+}
+
+/**
+ * Returns true if the indicated line crosses the box of the indicated node
+ * between the indicated parametric values, and sets t to the value at which
+ * it enters it.  inv_dir is the reciprocal of the line's direction.
+ */
+bool CollisionMesh::
+intersects_box(PN_stdfloat &t, const BVHNode &node,
+               const LPoint3 &origin, const LVector3 &inv_dir,
+               PN_stdfloat t_min, PN_stdfloat t_max) {
+  for (int i = 0; i < 3; ++i) {
+    PN_stdfloat t1 = (node._min[i] - origin[i]) * inv_dir[i];
+    PN_stdfloat t2 = (node._max[i] - origin[i]) * inv_dir[i];
+    if (t1 > t2) {
+      std::swap(t1, t2);
+    }
+    t_min = max(t_min, t1);
+    t_max = min(t_max, t2);
+    if (t_min > t_max) {
+      return false;
+    }
+  }
+  t = t_min;
+  return true;
+}
+
+/**
+ * Returns true if the indicated line crosses the indicated triangle, from
+ * either side, and sets t to the parametric value at which it does so.
+ */
+bool CollisionMesh::
+intersects_triangle(PN_stdfloat &t, const LPoint3 &origin,
+                    const LVector3 &direction, const LPoint3 &a,
+                    const LPoint3 &b, const LPoint3 &c) {
+  // This is the Moller-Trumbore algorithm.
+  LVector3 e1 = b - a;
+  LVector3 e2 = c - a;
+  LVector3 p = direction.cross(e2);
+  PN_stdfloat det = e1.dot(p);
+  if (det == 0.0f) {
+    return false;
+  }
+
+  PN_stdfloat inv_det = 1.0f / det;
+  LVector3 s = origin - a;
+  PN_stdfloat u = s.dot(p) * inv_det;
+  if (u < 0.0f || u > 1.0f) {
+    return false;
+  }
+
+  LVector3 q = s.cross(e1);
+  PN_stdfloat v = direction.dot(q) * inv_det;
+  if (v < 0.0f || u + v > 1.0f) {
+    return false;
+  }
+
+  t = e2.dot(q) * inv_det;
+  return true;
+}
+
+/**
+ * Returns the point on the indicated triangle that is closest to the
+ * indicated point.
+ */
+LPoint3 CollisionMesh::
+closest_point_on_triangle(const LPoint3 &p, const LPoint3 &a,
+                          const LPoint3 &b, const LPoint3 &c) {
+  // This determines which of the triangle's Voronoi regions the point is in.
+  LVector3 ab = b - a;
+  LVector3 ac = c - a;
+  LVector3 ap = p - a;
+  PN_stdfloat d1 = ab.dot(ap);
+  PN_stdfloat d2 = ac.dot(ap);
+  if (d1 <= 0.0f && d2 <= 0.0f) {
+    return a;
+  }
+
+  LVector3 bp = p - b;
+  PN_stdfloat d3 = ab.dot(bp);
+  PN_stdfloat d4 = ac.dot(bp);
+  if (d3 >= 0.0f && d4 <= d3) {
+    return b;
+  }
+
+  PN_stdfloat vc = d1 * d4 - d3 * d2;
+  if (vc <= 0.0f && d1 >= 0.0f && d3 <= 0.0f) {
+    return a + ab * (d1 / (d1 - d3));
+  }
+
+  LVector3 cp = p - c;
+  PN_stdfloat d5 = ab.dot(cp);
+  PN_stdfloat d6 = ac.dot(cp);
+  if (d6 >= 0.0f && d5 <= d6) {
+    return c;
+  }
+
+  PN_stdfloat vb = d5 * d2 - d1 * d6;
+  if (vb <= 0.0f && d2 >= 0.0f && d6 <= 0.0f) {
+    return a + ac * (d2 / (d2 - d6));
+  }
+
+  PN_stdfloat va = d3 * d6 - d5 * d4;
+  if (va <= 0.0f && (d4 - d3) >= 0.0f && (d5 - d6) >= 0.0f) {
+    return b + (c - b) * ((d4 - d3) / ((d4 - d3) + (d5 - d6)));
+  }
+
+  PN_stdfloat denom = 1.0f / (va + vb + vc);
+  return a + ab * (vb * denom) + ac * (vc * denom);
+}
+
+/**
+ * Finds the closest points between the segment from p to q and the indicated
+ * triangle, and returns the distance between them.
+ */
+PN_stdfloat CollisionMesh::
+closest_segment_triangle(LPoint3 &seg_point, LPoint3 &tri_point,
+                         const LPoint3 &p, const LPoint3 &q,
+                         const LPoint3 &a, const LPoint3 &b, const LPoint3 &c) {
+  // If the segment crosses the triangle, the distance is zero.
+  PN_stdfloat t;
+  LVector3 direction = q - p;
+  if (intersects_triangle(t, p, direction, a, b, c) && t >= 0.0f && t <= 1.0f) {
+    seg_point = p + direction * t;
+    tri_point = seg_point;
+    return 0.0f;
+  }
+
+  // Otherwise, the closest points are either between one of the segment's
+  // endpoints and the interior of the triangle, or between the segment and
+  // one of the triangle's edges.
+  tri_point = closest_point_on_triangle(p, a, b, c);
+  seg_point = p;
+  PN_stdfloat best_dist_sq = (tri_point - p).length_squared();
+
+  LPoint3 point = closest_point_on_triangle(q, a, b, c);
+  PN_stdfloat dist_sq = (point - q).length_squared();
+  if (dist_sq < best_dist_sq) {
+    best_dist_sq = dist_sq;
+    tri_point = point;
+    seg_point = q;
+  }
+
+  const LPoint3 *edges[3][2] = {{&a, &b}, {&b, &c}, {&c, &a}};
+  for (int i = 0; i < 3; ++i) {
+    const LPoint3 &e1 = *edges[i][0];
+    const LPoint3 &e2 = *edges[i][1];
+    PN_stdfloat s, u;
+    closest_segment_segment(s, u, p, q, e1, e2);
+    LPoint3 point1 = p + direction * s;
+    LPoint3 point2 = e1 + (e2 - e1) * u;
+    dist_sq = (point2 - point1).length_squared();
+    if (dist_sq < best_dist_sq) {
+      best_dist_sq = dist_sq;
+      seg_point = point1;
+      tri_point = point2;
+    }
+  }
+
+  return csqrt(best_dist_sq);
+}
+
+/**
+ * Factory method to generate a CollisionMesh object
+ */
+void CollisionMesh::
+register_with_read_factory() {
+  BamReader::get_factory()->register_factory(get_class_type(), make_CollisionMesh);
+}
+
+/**
+ * Function to write the important information in the particular object to a
+ * Datagram
+ */
+void CollisionMesh::
+write_datagram(BamWriter *manager, Datagram &me) {
+  // Write the hierarchy too, so that it need not be rebuilt on load.
+  check_bvh();
+
+  CollisionSolid::write_datagram(manager, me);
+
+  me.add_uint32(_vertices.size());
+  for (const LPoint3 &vertex : _vertices) {
+    vertex.write_datagram(me);
+  }
+
+  me.add_uint32(_triangles.size());
+  for (const Triangle &tri : _triangles) {
+    me.add_uint32(tri._v[0]);
+    me.add_uint32(tri._v[1]);
+    me.add_uint32(tri._v[2]);
+  }
+
+  me.add_uint32(_nodes.size());
+  for (const BVHNode &node : _nodes) {
+    node._min.write_datagram(me);
+    node._max.write_datagram(me);
+    me.add_uint32(node._index);
+    me.add_uint32(node._count);
+  }
+}
+
+/**
+ * Factory method to generate a CollisionMesh object
+ */
+TypedWritable *CollisionMesh::
+make_CollisionMesh(const FactoryParams &params) {
+  CollisionMesh *me = new CollisionMesh;
+  DatagramIterator scan;
+  BamReader *manager;
+
+  parse_params(params, scan, manager);
+  me->fillin(scan, manager);
+  return me;
+}
+
+/**
+ * Function that reads out of the datagram (or asks manager to read) all of
+ * the data that is needed to re-create this object and stores it in the
+ * appropiate place
+ */
+void CollisionMesh::
+fillin(DatagramIterator &scan, BamReader *manager) {
+  CollisionSolid::fillin(scan, manager);
+
+  size_t num_vertices = scan.get_uint32();
+  _vertices.resize(num_vertices);
+  for (size_t i = 0; i < num_vertices; ++i) {
+    _vertices[i].read_datagram(scan);
+  }
+
+  size_t num_triangles = scan.get_uint32();
+  _triangles.resize(num_triangles);
+  for (size_t i = 0; i < num_triangles; ++i) {
+    Triangle &tri = _triangles[i];
+    tri._v[0] = scan.get_uint32();
+    tri._v[1] = scan.get_uint32();
+    tri._v[2] = scan.get_uint32();
+  }
+
+  size_t num_nodes = scan.get_uint32();
+  _nodes.resize(num_nodes);
+  for (size_t i = 0; i < num_nodes; ++i) {
+    BVHNode &node = _nodes[i];
+    node._min.read_datagram(scan);
+    node._max.read_datagram(scan);
+    node._index = scan.get_uint32();
+    node._count = scan.get_uint32();
+  }
+
+  _bvh_stale = (num_nodes == 0 && num_triangles != 0);
+}
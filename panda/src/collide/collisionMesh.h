@@ -0,0 +1,188 @@
+/**
+ * PANDA 3D SOFTWARE
+ * Copyright (c) Carnegie Mellon University.  All rights reserved.
+ *
+ * All use of this software is subject to the terms of the revised BSD
+ * license.  You should have received a copy of this license along
+ * with this source code in a file named "LICENSE."
+ *
+ * @file collisionMesh.h
+ * @author djs3000
+ * @date 2026-10-16
+ */
+
+#ifndef COLLISIONMESH_H
+#define COLLISIONMESH_H
+
+#include "pandabase.h"
+#include "collisionSolid.h"
+#include "lightMutex.h"
+#include "patomic.h"
+#include "pvector.h"
+
+class Geom;
+
+/**
+ * A collision solid made of an arbitrary soup of triangles, which may stand
+ * in for a large number of CollisionPolygons.  The triangles are organized
+ * into a bounding volume hierarchy, so that the cost of a collision test
+ * grows only with the logarithm of the number of triangles.
+ *
+ * The hierarchy is built with the surface area heuristic the first time it
+ * is needed after the triangles have been changed, and is stored in a flat
+ * array in depth-first order, which is also written to the bam file.  Note
+ * that building the hierarchy reorders the triangles.
+ *
+ * Like a CollisionPolygon, each triangle is considered to be solid only on
+ * its front side for the purpose of sphere, capsule and box tests.  Rays,
+ * lines and segments hit either side, and only the closest hit is reported.
+ */
+class EXPCL_PANDA_COLLIDE CollisionMesh : public CollisionSolid {
+PUBLISHED:
+  INLINE CollisionMesh();
+
+  INLINE int add_vertex(const LPoint3 &vertex);
+  void add_triangle(int a, int b, int c);
+  void add_geom(const Geom *geom, const LMatrix4 &mat = LMatrix4::ident_mat());
+
+  INLINE int get_num_vertices() const;
+  INLINE const LPoint3 &get_vertex(int n) const;
+  MAKE_SEQ(get_vertices, get_num_vertices, get_vertex);
+  INLINE int get_num_triangles() const;
+  INLINE LVecBase3i get_triangle(int n) const;
+  MAKE_SEQ(get_triangles, get_num_triangles, get_triangle);
+
+  void build_bvh();
+  INLINE int get_num_bvh_nodes() const;
+  int get_bvh_depth() const;
+
+  virtual LPoint3 get_collision_origin() const;
+
+PUBLISHED:
+  MAKE_SEQ_PROPERTY(vertices, get_num_vertices, get_vertex);
+  MAKE_SEQ_PROPERTY(triangles, get_num_triangles, get_triangle);
+
+public:
+  CollisionMesh(const CollisionMesh &copy);
+  virtual CollisionSolid *make_copy();
+
+  virtual void xform(const LMatrix4 &mat);
+
+  virtual PStatCollector &get_volume_pcollector();
+  virtual PStatCollector &get_test_pcollector();
+
+  virtual void output(std::ostream &out) const;
+  virtual void write(std::ostream &out, int indent_level = 0) const;
+
+  INLINE static void flush_level();
+
+protected:
+  virtual PT(BoundingVolume) compute_internal_bounds() const;
+
+  virtual PT(CollisionEntry)
+    test_intersection_from_sphere(const CollisionEntry &entry) const;
+  virtual PT(CollisionEntry)
+    test_intersection_from_line(const CollisionEntry &entry) const;
+  virtual PT(CollisionEntry)
+    test_intersection_from_ray(const CollisionEntry &entry) const;
+  virtual PT(CollisionEntry)
+    test_intersection_from_segment(const CollisionEntry &entry) const;
+  virtual PT(CollisionEntry)
+    test_intersection_from_capsule(const CollisionEntry &entry) const;
+  virtual PT(CollisionEntry)
+    test_intersection_from_box(const CollisionEntry &entry) const;
+
+  virtual void fill_viz_geom();
+
+private:
+  class Triangle {
+  public:
+    uint32_t _v[3];
+  };
+
+  // A node of the hierarchy.  The nodes are stored in depth-first order, so
+  // the first child of an interior node immediately follows it, and _index
+  // is the index of the second child.  For a leaf, _count is nonzero, and
+  // _index is the first of its _count triangles.
+  class BVHNode {
+  public:
+    INLINE bool is_leaf() const;
+
+    LPoint3 _min = LPoint3::zero();
+    LPoint3 _max = LPoint3::zero();
+    uint32_t _index = 0;
+    uint32_t _count = 0;
+  };
+
+  INLINE void check_bvh() const;
+  uint32_t r_build_bvh(pvector<uint32_t> &order, const pvector<LPoint3> &centroids,
+                       const pvector<LPoint3> &mins, const pvector<LPoint3> &maxs,
+                       size_t begin, size_t end, int depth);
+  int r_get_bvh_depth(uint32_t index) const;
+
+  PT(CollisionEntry) test_line(const CollisionEntry &entry,
+                               const LPoint3 &origin, const LVector3 &direction,
+                               PN_stdfloat t_min, PN_stdfloat t_max,
+                               bool respect_effective_normal) const;
+  int find_triangles(const LPoint3 &min_point, const LPoint3 &max_point,
+                     pvector<uint32_t> &result) const;
+
+  INLINE LVector3 get_triangle_normal(const Triangle &tri) const;
+  INLINE static bool overlaps(const BVHNode &node, const LPoint3 &min_point,
+                              const LPoint3 &max_point);
+  static bool intersects_box(PN_stdfloat &t, const BVHNode &node,
+                             const LPoint3 &origin, const LVector3 &inv_dir,
+                             PN_stdfloat t_min, PN_stdfloat t_max);
+  static bool intersects_triangle(PN_stdfloat &t, const LPoint3 &origin,
+                                  const LVector3 &direction, const LPoint3 &a,
+                                  const LPoint3 &b, const LPoint3 &c);
+  static LPoint3 closest_point_on_triangle(const LPoint3 &p, const LPoint3 &a,
+                                           const LPoint3 &b, const LPoint3 &c);
+  static PN_stdfloat closest_segment_triangle(LPoint3 &seg_point, LPoint3 &tri_point,
+                                              const LPoint3 &p, const LPoint3 &q,
+                                              const LPoint3 &a, const LPoint3 &b,
+                                              const LPoint3 &c);
+
+  typedef pvector<LPoint3> Vertices;
+  typedef pvector<Triangle> Triangles;
+  typedef pvector<BVHNode> BVHNodes;
+
+  Vertices _vertices;
+  Triangles _triangles;
+  BVHNodes _nodes;
+  // This is checked without holding the lock; see check_bvh().
+  patomic<bool> _bvh_stale;
+  LightMutex _bvh_lock;
+
+  static PStatCollector _volume_pcollector;
+  static PStatCollector _test_pcollector;
+
+protected:
+  void fillin(DatagramIterator &scan, BamReader *manager);
+
+public:
+  static void register_with_read_factory();
+  virtual void write_datagram(BamWriter *manager, Datagram &me);
+
+  static TypedWritable *make_CollisionMesh(const FactoryParams &params);
+
+  static TypeHandle get_class_type() {
+    return _type_handle;
+  }
+  static void init_type() {
+    CollisionSolid::init_type();
+    register_type(_type_handle, "CollisionMesh",
+                  CollisionSolid::get_class_type());
+  }
+  virtual TypeHandle get_type() const {
+    return get_class_type();
+  }
+  virtual TypeHandle force_init_type() {init_type(); return get_class_type();}
+
+private:
+  static TypeHandle _type_handle;
+};
+
+#include "collisionMesh.I"
+
+#endif
@@ -0,0 +1,76 @@
+/**
+ * PANDA 3D SOFTWARE
+ * Copyright (c) Carnegie Mellon University.  All rights reserved.
+ *
+ * All use of this software is subject to the terms of the revised BSD
+ * license.  You should have received a copy of this license along
+ * with this source code in a file named "LICENSE."
+ *
+ * @file collisionRayQuery.cxx
+ * @author djs3000
+ * @date 2026-10-16
+ */
+
+#include "collisionRayQuery.h"
+
+TypeHandle CollisionRayQuery::_type_handle;
+
+/**
+ *
+ */
+CollisionRayQuery::
+CollisionRayQuery() {
+}
+
+/**
+ * Adds a new ray to the query, and returns its index.  The direction need not
+ * be normalized, but it may not be zero.
+ */
+size_t CollisionRayQuery::
+add_ray(const LPoint3 &origin, const LVector3 &direction) {
+  nassertr(!direction.almost_equal(LVector3::zero()), _origins.size());
+  _origins.push_back(origin);
+  _directions.push_back(direction);
+  _hits.push_back(Hit());
+  return _origins.size() - 1;
+}
+
+/**
+ * Replaces all of the rays in the query with the ones given by the
+ * corresponding origins and directions in the arrays, which must be of the
+ * same length.
+ */
+void CollisionRayQuery::
+set_rays(CPTA_LVecBase3 origins, CPTA_LVecBase3 directions) {
+  nassertv(origins.size() == directions.size());
+
+  clear_rays();
+  reserve(origins.size());
+  for (size_t i = 0; i < origins.size(); ++i) {
+    add_ray(origins[i], directions[i]);
+  }
+}
+
+/**
+ * Returns the number of rays that hit something the last time the query was
+ * cast.
+ */
+size_t CollisionRayQuery::
+get_num_hits() const {
+  size_t num_hits = 0;
+  for (const Hit &hit : _hits) {
+    if (hit._t >= 0.0f) {
+      ++num_hits;
+    }
+  }
+  return num_hits;
+}
+
+/**
+ *
+ */
+void CollisionRayQuery::
+output(std::ostream &out) const {
+  out << "CollisionRayQuery, " << get_num_rays() << " rays, "
+      << get_num_hits() << " hits";
+}
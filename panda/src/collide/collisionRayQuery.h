@@ -0,0 +1,105 @@
+/**
+ * PANDA 3D SOFTWARE
+ * Copyright (c) Carnegie Mellon University.  All rights reserved.
+ *
+ * All use of this software is subject to the terms of the revised BSD
+ * license.  You should have received a copy of this license along
+ * with this source code in a file named "LICENSE."
+ *
+ * @file collisionRayQuery.h
+ * @author djs3000
+ * @date 2026-10-16
+ */
+
+#ifndef COLLISIONRAYQUERY_H
+#define COLLISIONRAYQUERY_H
+
+#include "pandabase.h"
+
+#include "typedReferenceCount.h"
+#include "nodePath.h"
+#include "luse.h"
+#include "pta_LVecBase3.h"
+#include "pvector.h"
+
+/**
+ * A batch of rays to be cast into the scene all at once with
+ * CollisionTraverser::cast_rays(), along with the nearest hit found for each
+ * of them.
+ *
+ * This is meant for casting many rays every frame, for instance for line-of-
+ * sight tests, without having to set up a CollisionNode and a handler for
+ * each ray.  Each ray is given by an origin and a direction in the space of
+ * the root node passed to cast_rays(), and the hits are reported in that
+ * same space.
+ */
+class EXPCL_PANDA_COLLIDE CollisionRayQuery : public TypedReferenceCount {
+PUBLISHED:
+  CollisionRayQuery();
+
+  INLINE void clear_rays();
+  INLINE void reserve(size_t num_rays);
+  size_t add_ray(const LPoint3 &origin, const LVector3 &direction);
+  void set_rays(CPTA_LVecBase3 origins, CPTA_LVecBase3 directions);
+
+  INLINE size_t get_num_rays() const;
+  INLINE LPoint3 get_origin(size_t n) const;
+  INLINE LVector3 get_direction(size_t n) const;
+
+  INLINE bool has_hit(size_t n) const;
+  INLINE PN_stdfloat get_hit_t(size_t n) const;
+  INLINE LPoint3 get_hit_pos(size_t n) const;
+  INLINE LVector3 get_hit_normal(size_t n) const;
+  INLINE NodePath get_hit_node_path(size_t n) const;
+  size_t get_num_hits() const;
+
+  MAKE_PROPERTY(num_rays, get_num_rays);
+  MAKE_PROPERTY(num_hits, get_num_hits);
+
+  void output(std::ostream &out) const;
+
+public:
+  // The nearest hit of a ray.  _t is negative if the ray hit nothing.
+  class Hit {
+  public:
+    INLINE Hit();
+
+    PN_stdfloat _t;
+    LPoint3 _pos;
+    LVector3 _normal;
+    NodePath _node_path;
+  };
+
+private:
+  pvector<LPoint3> _origins;
+  pvector<LVector3> _directions;
+  pvector<Hit> _hits;
+
+public:
+  static TypeHandle get_class_type() {
+    return _type_handle;
+  }
+  static void init_type() {
+    TypedReferenceCount::init_type();
+    register_type(_type_handle, "CollisionRayQuery",
+                  TypedReferenceCount::get_class_type());
+  }
+  virtual TypeHandle get_type() const {
+    return get_class_type();
+  }
+  virtual TypeHandle force_init_type() {init_type(); return get_class_type();}
+
+private:
+  static TypeHandle _type_handle;
+
+  friend class CollisionTraverser;
+};
+
+INLINE std::ostream &operator << (std::ostream &out, const CollisionRayQuery &query) {
+  query.output(out);
+  return out;
+}
+
+#include "collisionRayQuery.I"
+
+#endif
@@ -275,6 +275,118 @@ test_intersection_from_box(const CollisionEntry &) const {
   return nullptr;
 }
 
+/**
+ * Implements the continuous collision test for a "from" sphere or capsule
+ * that is moving since the previous frame.  The point is any point of the
+ * solid, and the radius is the radius of the solid, both in the solid's own
+ * coordinate space.
+ *
+ * The solid is tested at a number of positions along the path from its
+ * previous position to its current position, spaced no further apart than
+ * its radius, so that it cannot pass through even an infinitely thin wall
+ * without being caught.  The cost is therefore proportional to the distance
+ * moved, relative to the radius.  The first position at which it collides is then
+ * refined by bisection.  Only the translation of the solid is considered;
+ * its orientation is taken to be the current one along the whole path.
+ *
+ * The resulting entry describes the surface that was hit, with the interior
+ * point moved along to the current position, so that a handler pushing the
+ * solid out pushes it back to the side from which it came.  The contact
+ * position is that of the indicated point at the last moment before the
+ * collision, and get_t() returns the fraction of the path at that moment.
+ */
+PT(CollisionEntry) CollisionSolid::
+test_swept_intersection(const CollisionEntry &entry, const LPoint3 &point,
+                        PN_stdfloat radius) const {
+  static const int flags =
+    CollisionEntry::F_respect_prev_transform | CollisionEntry::F_continuous;
+
+  CollisionEntry sample(entry);
+  sample._flags &= ~flags;
+
+  CPT(TransformState) wrt_space = entry.get_wrt_space();
+  CPT(TransformState) wrt_prev_space = entry.get_wrt_prev_space();
+  CPT(TransformState) inv_wrt_space = entry.get_inv_wrt_space();
+  const LMatrix4 &wrt_mat = wrt_space->get_mat();
+  const LMatrix4 &inv_wrt_mat = inv_wrt_space->get_mat();
+
+  LPoint3 from_a = point * wrt_prev_space->get_mat();
+  LPoint3 from_b = point * wrt_mat;
+  LVector3 delta = from_b - from_a;
+  PN_stdfloat from_radius = length(LVector3(radius, 0.0f, 0.0f) * wrt_mat);
+
+  // Tests a copy of this solid, moved back to the indicated fraction of its
+  // path.  The same copy is moved from one sample to the next.
+  PT(CollisionSolid) copy;
+  LVector3 copy_offset = LVector3::zero();
+  auto test_at = [&] (PN_stdfloat t) -> PT(CollisionEntry) {
+    if (copy == nullptr) {
+      copy = ((CollisionSolid *)this)->make_copy();
+      sample._from = copy;
+    }
+    LVector3 offset = inv_wrt_mat.xform_vec((t - 1.0f) * delta);
+    copy->xform(LMatrix4::translate_mat(offset - copy_offset));
+    copy_offset = offset;
+    return copy->test_intersection(sample);
+  };
+
+  if (from_radius <= 0.0f || delta.length_squared() <= from_radius * from_radius * 1.0e-6f) {
+    // It is hardly moving; just do the ordinary test.
+    return test_intersection(sample);
+  }
+
+  // If it is already colliding at the start of its path, this is a resting
+  // contact, which is resolved at the current position as usual.
+  PT(CollisionEntry) hit = test_at(0.0f);
+  if (hit != nullptr) {
+    sample._from = this;
+    return test_intersection(sample);
+  }
+
+  // There is no upper limit on the number of steps, since any gap wider than
+  // the radius could let the solid pass through a thin wall.
+  int num_steps = std::max(1, (int)cceil(delta.length() / from_radius));
+
+  PN_stdfloat t_lo = 0.0f;
+  PN_stdfloat t_hi = 1.0f;
+  for (int i = 1; i <= num_steps && hit == nullptr; ++i) {
+    PN_stdfloat t = (PN_stdfloat)i / (PN_stdfloat)num_steps;
+    hit = test_at(t);
+    if (hit != nullptr) {
+      t_hi = t;
+    } else {
+      t_lo = t;
+    }
+  }
+  if (hit == nullptr) {
+    return nullptr;
+  }
+
+  // Narrow down the moment of impact.
+  for (int i = 0; i < collision_sweep_iterations; ++i) {
+    PN_stdfloat t = (t_lo + t_hi) * 0.5f;
+    PT(CollisionEntry) result = test_at(t);
+    if (result != nullptr) {
+      hit = std::move(result);
+      t_hi = t;
+    } else {
+      t_lo = t;
+    }
+  }
+
+  hit->_from = this;
+  hit->_flags = (hit->_flags & ~flags) | (entry._flags & flags);
+  if (hit->has_interior_point()) {
+    hit->_interior_point += (1.0f - t_hi) * delta;
+  }
+  hit->set_contact_pos(from_a + t_lo * delta);
+  if (hit->has_surface_normal()) {
+    hit->set_contact_normal(hit->_surface_normal);
+  }
+  hit->set_t(t_lo);
+  return hit;
+}
+
 
 #ifndef NDEBUG
 class CollisionSolidUndefinedPair {
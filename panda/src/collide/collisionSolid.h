@@ -114,6 +114,10 @@ protected:
   virtual PT(CollisionEntry)
   test_intersection_from_box(const CollisionEntry &entry) const;
 
+  PT(CollisionEntry) test_swept_intersection(const CollisionEntry &entry,
+                                             const LPoint3 &point,
+                                             PN_stdfloat radius) const;
+
   static void report_undefined_intersection_test(TypeHandle from_type,
                                                  TypeHandle into_type);
   static void report_undefined_from_intersection(TypeHandle from_type);
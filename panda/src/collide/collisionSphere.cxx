@@ -57,6 +57,9 @@ make_copy() {
  */
 PT(CollisionEntry) CollisionSphere::
 test_intersection(const CollisionEntry &entry) const {
+  if (entry.get_continuous()) {
+    return test_swept_intersection(entry, get_center(), get_radius());
+  }
   return entry.get_into()->test_intersection_from_sphere(entry);
 }
 
@@ -17,12 +17,14 @@
 #include "collisionPolygon.h"
 #include "collisionGeom.h"
 #include "collisionRecorder.h"
+#include "collisionTraverserTask.h"
 #include "collisionVisualizer.h"
 #include "collisionSphere.h"
 #include "collisionBox.h"
 #include "collisionCapsule.h"
 #include "collisionPolygon.h"
 #include "collisionPlane.h"
+#include "collisionRay.h"
 #include "config_collide.h"
 #include "boundingSphere.h"
 #include "transformState.h"
@@ -32,12 +34,18 @@
 #include "geomTriangles.h"
 #include "geomVertexReader.h"
 #include "lodNode.h"
+#include "finiteBoundingVolume.h"
+#include "boundingLine.h"
 #include "nodePath.h"
 #include "pStatTimer.h"
+#include "lightMutexHolder.h"
+#include "asyncTaskManager.h"
 #include "indent.h"
 
 #include <algorithm>
+#include <limits>
 
+using std::max;
 using std::min;
 
 PStatCollector CollisionTraverser::_collisions_pcollector("App:Collisions");
@@ -65,15 +73,34 @@ public:
   const CollisionTraverser &_trav;
 };
 
+/**
+ * The RayEntries class is given to the collision tests in
+ * CollisionTraverser::cast_ray_into() in place of a real handler, to collect
+ * the entries detected for a ray.  It's not exported outside this file.
+ */
+class CollisionTraverser::RayEntries : public CollisionHandler {
+public:
+  virtual void add_entry(CollisionEntry *entry) {
+    _entries.push_back(entry);
+  }
+
+  pvector<PT(CollisionEntry)> _entries;
+};
+
 /**
  *
  */
 CollisionTraverser::
 CollisionTraverser(const std::string &name) :
   Namable(name),
-  _this_pcollector(_collisions_pcollector, name)
+  _this_pcollector(_collisions_pcollector, name),
+  _broadphase_pcollector(_this_pcollector, "broadphase")
 {
   _respect_prev_transform = respect_prev_transform;
+  _broadphase = collision_broadphase;
+  _continuous = collision_continuous;
+  _broadphase_seq = 0;
+  _broadphase_mask = CollideMask::all_off();
   #ifdef DO_COLLISION_RECORDING
   _recorder = nullptr;
   #endif
@@ -263,6 +290,16 @@ traverse(const NodePath &root) {
   }
   #endif  // DO_COLLISION_RECORDING
 
+  // Forget the meshes made for Geoms that have since been deleted.
+  GeomMeshes::iterator gmi = _geom_meshes.begin();
+  while (gmi != _geom_meshes.end()) {
+    if ((*gmi).second._geom.was_deleted()) {
+      gmi = _geom_meshes.erase(gmi);
+    } else {
+      ++gmi;
+    }
+  }
+
   Handlers::iterator hi;
   for (hi = _handlers.begin(); hi != _handlers.end(); ++hi) {
     if ((*hi).first->wants_all_potential_collidees()) {
@@ -272,8 +309,17 @@ traverse(const NodePath &root) {
   }
 
   bool traversal_done = false;
-  if ((int)_colliders.size() <= CollisionLevelStateSingle::get_max_colliders() ||
-      !allow_collider_multiple) {
+  if (_broadphase) {
+    // Find the candidate nodes for all of the colliders at once.  If
+    // collision-num-threads is set, the pairs found this way are tested in
+    // parallel.
+    traverse_broadphase(root);
+    traversal_done = true;
+  }
+
+  if (!traversal_done &&
+      ((int)_colliders.size() <= CollisionLevelStateSingle::get_max_colliders() ||
+       !allow_collider_multiple)) {
     // Use the single-word-at-a-time traverser, which might need to make lots
     // of passes.
     LevelStatesSingle level_states;
@@ -344,16 +390,58 @@ traverse(const NodePath &root) {
   }
   #endif  // DO_COLLISION_RECORDING
 
-  CollisionLevelStateBase::_node_volume_pcollector.flush_level();
-  _cnode_volume_pcollector.flush_level();
-  _gnode_volume_pcollector.flush_level();
-  _geom_volume_pcollector.flush_level();
+  flush_level();
+}
 
-  CollisionSphere::flush_level();
-  CollisionCapsule::flush_level();
-  CollisionPolygon::flush_level();
-  CollisionPlane::flush_level();
-  CollisionBox::flush_level();
+/**
+ * Casts all of the rays of the query into the scene at or below the indicated
+ * root, and stores the nearest hit of each ray in the query.  The rays only
+ * hit the nodes whose into collide mask has bits in common with the indicated
+ * mask, as if they were CollisionRays in a CollisionNode with that from
+ * collide mask.
+ *
+ * This is much cheaper than making a CollisionNode for each ray and calling
+ * traverse().  It does not involve the colliders and handlers of this
+ * traverser; it only shares the broadphase tree (see set_broadphase()) with
+ * traverse(), which is kept up-to-date from one call to the next, whatever
+ * the masks, so it is best to use a traverser that always casts into the same
+ * root.  The rays are
+ * walked down the tree in groups of four at a time, and if
+ * collision-num-threads is nonzero, large queries are divided among the
+ * worker threads.
+ */
+void CollisionTraverser::
+cast_rays(const NodePath &root, CollisionRayQuery *query, CollideMask mask) {
+  nassertv(!root.is_empty() && query != nullptr);
+  PStatTimer timer(_this_pcollector);
+
+  for (CollisionRayQuery::Hit &hit : query->_hits) {
+    hit = CollisionRayQuery::Hit();
+  }
+
+  CPT(TransformState) root_transform = root.get_transform();
+  if (root_transform->get_inverse_mat() == nullptr) {
+    return;
+  }
+
+  update_broadphase_tree(root, mask);
+  if (_into_defs.empty()) {
+    return;
+  }
+
+  size_t num_rays = query->get_num_rays();
+  bool parallel = (collision_num_threads > 0 && Thread::is_true_threads() &&
+                   num_rays > (size_t)max((int)collision_parallel_batch_size, 1));
+#ifdef DO_COLLISION_RECORDING
+  parallel = parallel && !has_recorder();
+#endif
+  if (parallel) {
+    cast_rays_parallel(query, mask, root_transform);
+  } else {
+    cast_ray_range(query, mask, root_transform, 0, num_rays);
+  }
+
+  flush_level();
 }
 
 #if defined(DO_COLLISION_RECORDING) || !defined(CPPPARSER)
@@ -577,6 +665,9 @@ r_traverse_single(CollisionLevelStateSingle &level_state, size_t pass) {
     entry._into_node_path = level_state.get_node_path();
     if (_respect_prev_transform) {
       entry._flags |= CollisionEntry::F_respect_prev_transform;
+      if (_continuous) {
+        entry._flags |= CollisionEntry::F_continuous;
+      }
     }
 
     int num_colliders = level_state.get_num_colliders();
@@ -593,8 +684,11 @@ r_traverse_single(CollisionLevelStateSingle &level_state, size_t pass) {
           entry._from_node_path = level_state.get_collider_node_path(c);
           entry._from = level_state.get_collider(c);
 
+          Colliders::const_iterator ci;
+          ci = _colliders.find(entry.get_from_node_path());
+          nassertv(ci != _colliders.end());
           compare_collider_to_node(
-              entry,
+              entry, (*ci).second,
               level_state.get_parent_bound(c),
               level_state.get_local_bound(c),
               level_state.get_node_bound());
@@ -617,6 +711,9 @@ r_traverse_single(CollisionLevelStateSingle &level_state, size_t pass) {
     entry._into_node_path = level_state.get_node_path();
     if (_respect_prev_transform) {
       entry._flags |= CollisionEntry::F_respect_prev_transform;
+      if (_continuous) {
+        entry._flags |= CollisionEntry::F_continuous;
+      }
     }
 
     int num_colliders = level_state.get_num_colliders();
@@ -632,8 +729,11 @@ r_traverse_single(CollisionLevelStateSingle &level_state, size_t pass) {
           entry._from_node_path = level_state.get_collider_node_path(c);
           entry._from = level_state.get_collider(c);
 
+          Colliders::const_iterator ci;
+          ci = _colliders.find(entry.get_from_node_path());
+          nassertv(ci != _colliders.end());
           compare_collider_to_geom_node(
-              entry,
+              entry, (*ci).second,
               level_state.get_parent_bound(c),
               level_state.get_local_bound(c),
               level_state.get_node_bound());
@@ -787,6 +887,9 @@ r_traverse_double(CollisionLevelStateDouble &level_state, size_t pass) {
     entry._into_node_path = level_state.get_node_path();
     if (_respect_prev_transform) {
       entry._flags |= CollisionEntry::F_respect_prev_transform;
+      if (_continuous) {
+        entry._flags |= CollisionEntry::F_continuous;
+      }
     }
 
     int num_colliders = level_state.get_num_colliders();
@@ -802,8 +905,11 @@ r_traverse_double(CollisionLevelStateDouble &level_state, size_t pass) {
           entry._from_node_path = level_state.get_collider_node_path(c);
           entry._from = level_state.get_collider(c);
 
+          Colliders::const_iterator ci;
+          ci = _colliders.find(entry.get_from_node_path());
+          nassertv(ci != _colliders.end());
           compare_collider_to_node(
-              entry,
+              entry, (*ci).second,
               level_state.get_parent_bound(c),
               level_state.get_local_bound(c),
               level_state.get_node_bound());
@@ -826,6 +932,9 @@ r_traverse_double(CollisionLevelStateDouble &level_state, size_t pass) {
     entry._into_node_path = level_state.get_node_path();
     if (_respect_prev_transform) {
       entry._flags |= CollisionEntry::F_respect_prev_transform;
+      if (_continuous) {
+        entry._flags |= CollisionEntry::F_continuous;
+      }
     }
 
     int num_colliders = level_state.get_num_colliders();
@@ -841,8 +950,11 @@ r_traverse_double(CollisionLevelStateDouble &level_state, size_t pass) {
           entry._from_node_path = level_state.get_collider_node_path(c);
           entry._from = level_state.get_collider(c);
 
+          Colliders::const_iterator ci;
+          ci = _colliders.find(entry.get_from_node_path());
+          nassertv(ci != _colliders.end());
           compare_collider_to_geom_node(
-              entry,
+              entry, (*ci).second,
               level_state.get_parent_bound(c),
               level_state.get_local_bound(c),
               level_state.get_node_bound());
@@ -996,6 +1108,9 @@ r_traverse_quad(CollisionLevelStateQuad &level_state, size_t pass) {
     entry._into_node_path = level_state.get_node_path();
     if (_respect_prev_transform) {
       entry._flags |= CollisionEntry::F_respect_prev_transform;
+      if (_continuous) {
+        entry._flags |= CollisionEntry::F_continuous;
+      }
     }
 
     int num_colliders = level_state.get_num_colliders();
@@ -1011,8 +1126,11 @@ r_traverse_quad(CollisionLevelStateQuad &level_state, size_t pass) {
           entry._from_node_path = level_state.get_collider_node_path(c);
           entry._from = level_state.get_collider(c);
 
+          Colliders::const_iterator ci;
+          ci = _colliders.find(entry.get_from_node_path());
+          nassertv(ci != _colliders.end());
           compare_collider_to_node(
-              entry,
+              entry, (*ci).second,
               level_state.get_parent_bound(c),
               level_state.get_local_bound(c),
               level_state.get_node_bound());
@@ -1035,6 +1153,9 @@ r_traverse_quad(CollisionLevelStateQuad &level_state, size_t pass) {
     entry._into_node_path = level_state.get_node_path();
     if (_respect_prev_transform) {
       entry._flags |= CollisionEntry::F_respect_prev_transform;
+      if (_continuous) {
+        entry._flags |= CollisionEntry::F_continuous;
+      }
     }
 
     int num_colliders = level_state.get_num_colliders();
@@ -1050,8 +1171,11 @@ r_traverse_quad(CollisionLevelStateQuad &level_state, size_t pass) {
           entry._from_node_path = level_state.get_collider_node_path(c);
           entry._from = level_state.get_collider(c);
 
+          Colliders::const_iterator ci;
+          ci = _colliders.find(entry.get_from_node_path());
+          nassertv(ci != _colliders.end());
           compare_collider_to_geom_node(
-              entry,
+              entry, (*ci).second,
               level_state.get_parent_bound(c),
               level_state.get_local_bound(c),
               level_state.get_node_bound());
@@ -1111,11 +1235,629 @@ r_traverse_quad(CollisionLevelStateQuad &level_state, size_t pass) {
   }
 }
 
+/**
+ * Computes the axis-aligned box, in the space described by the indicated
+ * matrix, that encloses the indicated finite bounding volume.  Returns false
+ * if the volume is not finite.
+ */
+static bool
+get_bounding_box(const BoundingVolume *bounds, const LMatrix4 &mat,
+                 LPoint3 &min_point, LPoint3 &max_point) {
+  const FiniteBoundingVolume *fbv = bounds->as_finite_bounding_volume();
+  if (fbv == nullptr || fbv->is_empty() || fbv->is_infinite()) {
+    return false;
+  }
+
+  LPoint3 local_min = fbv->get_min();
+  LPoint3 local_max = fbv->get_max();
+  LPoint3 center = mat.xform_point((local_min + local_max) * 0.5f);
+  LVector3 extent = (local_max - local_min) * 0.5f;
+
+  LVector3 new_extent;
+  for (int i = 0; i < 3; ++i) {
+    new_extent[i] = cabs(mat(0, i)) * extent[0] +
+                    cabs(mat(1, i)) * extent[1] +
+                    cabs(mat(2, i)) * extent[2];
+  }
+  min_point = center - new_extent;
+  max_point = center + new_extent;
+  return true;
+}
+
+/**
+ * Performs the traversal with the broadphase tree.  The nodes under the root
+ * that any collider might collide into are collected in a single pass over
+ * the scene graph, updating their boxes in the tree as needed; then each
+ * collider queries the tree for the nodes its bounds overlap.  The resulting
+ * pairs are tested in scene graph order, as the pass-based traversal would
+ * have done.
+ */
+void CollisionTraverser::
+traverse_broadphase(const NodePath &root) {
+  // Collect the colliders in the same order prepare_colliders() would.
+  BroadphaseColliders colliders;
+  colliders.reserve(_colliders.size());
+
+  int num_colliders = _colliders.size();
+  int *indirect = (int *)alloca(sizeof(int) * num_colliders);
+  for (int i = 0; i < num_colliders; ++i) {
+    indirect[i] = i;
+  }
+  std::sort(indirect, indirect + num_colliders, SortByColliderSort(*this));
+
+  CollideMask from_mask;
+  for (int i = 0; i < num_colliders; ++i) {
+    OrderedColliderDef &ocd = _ordered_colliders[indirect[i]];
+    const NodePath &cnode_path = ocd._node_path;
+
+    if (!cnode_path.is_same_graph(root)) {
+      if (ocd._in_graph) {
+        // Only report this warning once.
+        collide_cat.info()
+          << "Collider " << cnode_path
+          << " is not in scene graph.  Ignoring.\n";
+        ocd._in_graph = false;
+      }
+
+    } else {
+      ocd._in_graph = true;
+      CollisionNode *cnode = DCAST(CollisionNode, cnode_path.node());
+      from_mask |= cnode->get_from_collide_mask();
+
+      Colliders::const_iterator ci = _colliders.find(cnode_path);
+      nassertv(ci != _colliders.end());
+
+      BroadphaseCollider collider;
+      collider._def._node = cnode;
+      collider._def._node_path = cnode_path;
+      collider._handler = (*ci).second;
+
+      int num_solids = cnode->get_num_solids();
+      for (int s = 0; s < num_solids; ++s) {
+        collider._def._collider = cnode->get_solid(s);
+        collider._bounds = CollisionLevelStateBase::get_collider_bounds(collider._def, root);
+        colliders.push_back(collider);
+      }
+    }
+  }
+
+  update_broadphase_tree(root, from_mask);
+
+  // Now find the candidate pairs.  We sort them by node first, so that the
+  // handlers receive the entries in the same order as with a single pass.
+  BroadphasePairs pairs;
+  pvector<int> found;
+  for (size_t c = 0; c < colliders.size(); ++c) {
+    const BroadphaseCollider &collider = colliders[c];
+    found.clear();
+
+    LPoint3 min_point, max_point;
+    const BoundingLine *line;
+    if (collider._bounds != nullptr &&
+        get_bounding_box(collider._bounds, LMatrix4::ident_mat(), min_point, max_point)) {
+      _tree.query_box(min_point, max_point, found);
+      found.insert(found.end(), _infinite_into.begin(), _infinite_into.end());
+
+    } else if (collider._bounds != nullptr &&
+               (line = collider._bounds->as_bounding_line()) != nullptr) {
+      const LPoint3 &a = line->get_point_a();
+      _tree.query_line(a, line->get_point_b() - a,
+                       -std::numeric_limits<PN_stdfloat>::infinity(),
+                       std::numeric_limits<PN_stdfloat>::infinity(), found);
+      found.insert(found.end(), _infinite_into.begin(), _infinite_into.end());
+
+    } else if (collider._bounds == nullptr || !collider._bounds->is_empty()) {
+      // We can't tell what this one might hit; try everything.
+      for (size_t i = 0; i < _into_defs.size(); ++i) {
+        found.push_back((int)i);
+      }
+    }
+
+    CollisionNode *cnode = collider._def._node;
+    CollideMask cnode_mask = cnode->get_from_collide_mask();
+    for (int i : found) {
+      const IntoDef &def = _into_defs[i];
+      PandaNode *node = def._node_path.node();
+      if (node != cnode &&
+          !(cnode_mask & node->get_into_collide_mask()).is_zero() &&
+          !(cnode_mask & def._include_mask & def._net_mask).is_zero()) {
+        pairs.push_back(BroadphasePair(i, (int)c));
+      }
+    }
+  }
+  std::sort(pairs.begin(), pairs.end());
+
+  bool parallel = (collision_num_threads > 0 && Thread::is_true_threads() &&
+                   pairs.size() > (size_t)max((int)collision_parallel_batch_size, 1));
+#ifdef DO_COLLISION_RECORDING
+  // The recorder expects to be called from one thread only.
+  parallel = parallel && !has_recorder();
+#endif
+  if (parallel) {
+    test_broadphase_pairs_parallel(colliders, pairs);
+  } else {
+    for (const BroadphasePair &pair : pairs) {
+      const BroadphaseCollider &collider = colliders[pair.second];
+      test_broadphase_pair(_into_defs[pair.first], collider, collider._handler);
+    }
+  }
+}
+
+/**
+ * Walks the scene graph under the indicated root to collect the nodes that
+ * may be collided into by anything with the indicated from mask, and brings
+ * the broadphase tree up-to-date with their bounds.
+ *
+ * The tree keeps the nodes for every from mask it has been asked for since
+ * the root last changed, so that calls with different masks (for instance,
+ * traverse() alternating with cast_rays()) don't keep adding and removing
+ * the same nodes.  The callers therefore have to check the collide masks of
+ * the nodes they find in it.
+ */
+void CollisionTraverser::
+update_broadphase_tree(const NodePath &root, CollideMask from_mask) {
+  PStatTimer timer(_broadphase_pcollector);
+
+  // The boxes in the tree are stored in the space of the root's parent, so
+  // we have to start over if the root changes.
+  if (root != _broadphase_root) {
+    _tree.clear();
+    _proxies.clear();
+    _broadphase_root = root;
+    _broadphase_mask = CollideMask::all_off();
+  }
+  _tree.set_margin(collision_broadphase_margin);
+  _broadphase_mask |= from_mask;
+
+  ++_broadphase_seq;
+  _into_defs.clear();
+  _infinite_into.clear();
+  PandaNode *root_node = root.node();
+  if (!(root_node->get_net_collide_mask() & _broadphase_mask).is_zero()) {
+    r_collect_into_nodes(root, TransformState::make_identity(),
+                         CollideMask::all_on(), CollideMask::all_on(),
+                         _broadphase_mask, nullptr, nullptr);
+  }
+
+  // Remove the nodes that have gone away.
+  Proxies::iterator pi = _proxies.begin();
+  while (pi != _proxies.end()) {
+    if ((*pi).second._last_seen != _broadphase_seq) {
+      if ((*pi).second._proxy >= 0) {
+        _tree.remove_proxy((*pi).second._proxy);
+      }
+      pi = _proxies.erase(pi);
+    } else {
+      ++pi;
+    }
+  }
+}
+
+/**
+ * Tests the indicated collider against the indicated node found by the
+ * broadphase, passing the detected collisions to the indicated handler.
+ */
+void CollisionTraverser::
+test_broadphase_pair(const IntoDef &def, const BroadphaseCollider &collider,
+                     CollisionHandler *record) {
+  CollisionEntry entry;
+  entry._from_node = collider._def._node;
+  entry._from_node_path = collider._def._node_path;
+  entry._from = collider._def._collider;
+  entry._into_node = def._node_path.node();
+  entry._into_node_path = def._node_path;
+  if (_respect_prev_transform) {
+    entry._flags |= CollisionEntry::F_respect_prev_transform;
+    if (_continuous) {
+      entry._flags |= CollisionEntry::F_continuous;
+    }
+  }
+
+  // Bring the collider's bounds into the space of the node's parent and of
+  // the node itself, as the level states would have done on the way down.
+  // Below a node with final bounds, they don't test the bounds any more.
+  PT(GeometricBoundingVolume) parent_gbv;
+  PT(GeometricBoundingVolume) node_gbv;
+  if (collider._bounds != nullptr && !def._below_final) {
+    const LMatrix4 *inv_parent = def._parent_transform->get_inverse_mat();
+    if (inv_parent != nullptr) {
+      parent_gbv = DCAST(GeometricBoundingVolume, collider._bounds->make_copy());
+      parent_gbv->xform(*inv_parent);
+    }
+    const LMatrix4 *inv_node = def._net_transform->get_inverse_mat();
+    if (inv_node != nullptr && !def._is_final) {
+      node_gbv = DCAST(GeometricBoundingVolume, collider._bounds->make_copy());
+      node_gbv->xform(*inv_node);
+    }
+  }
+
+  CPT(BoundingVolume) node_bounds = entry._into_node->get_bounds();
+  const GeometricBoundingVolume *into_gbv = node_bounds->as_geometric_bounding_volume();
+
+  if (entry._into_node->is_collision_node()) {
+    compare_collider_to_node(entry, record, parent_gbv, node_gbv, into_gbv);
+  } else {
+    compare_collider_to_geom_node(entry, record, parent_gbv, node_gbv, into_gbv);
+  }
+}
+
+/**
+ * Tests the candidate pairs found by the broadphase on the "collide" task
+ * chain; see collision-num-threads.  The pairs are divided into consecutive
+ * batches, each of which collects its entries separately.  When they have
+ * all finished, the entries are passed on to the handlers on this thread, in
+ * the same order as they would have been by testing the pairs one by one.
+ */
+void CollisionTraverser::
+test_broadphase_pairs_parallel(const BroadphaseColliders &colliders,
+                               const BroadphasePairs &pairs) {
+  AsyncTaskManager *task_mgr = AsyncTaskManager::get_global_ptr();
+  AsyncTaskChain *chain = CollisionTraverserTask::get_task_chain();
+
+  size_t batch_size = (size_t)max((int)collision_parallel_batch_size, 1);
+  typedef pvector<PT(CollisionTraverserTask)> Tasks;
+  Tasks tasks;
+  tasks.reserve((pairs.size() + batch_size - 1) / batch_size);
+  for (size_t begin = 0; begin < pairs.size(); begin += batch_size) {
+    size_t end = min(begin + batch_size, pairs.size());
+    PT(CollisionTraverserTask) task =
+      new CollisionTraverserTask(this, &colliders, &pairs, begin, end);
+    task->set_task_chain(chain->get_name());
+    task_mgr->add(task);
+    tasks.push_back(std::move(task));
+  }
+
+  for (CollisionTraverserTask *task : tasks) {
+    task->wait();
+    task->flush();
+  }
+}
+
+/**
+ * Casts the rays of the query in the indicated range, which must be within
+ * the space of the root whose net transform is given, into the nodes
+ * collected by update_broadphase_tree().
+ */
+void CollisionTraverser::
+cast_ray_range(CollisionRayQuery *query, CollideMask mask,
+               const TransformState *root_transform, size_t begin, size_t end) {
+  const LMatrix4 &root_mat = root_transform->get_mat();
+  const LMatrix4 &inv_root_mat = *root_transform->get_inverse_mat();
+
+  CollisionBroadphase::PacketHits found;
+  typedef std::pair<PN_stdfloat, int> RayCandidate;
+  pvector<RayCandidate> candidates;
+
+  // The same ray and entries are used for every node that is tested.
+  PT(CollisionRay) ray = new CollisionRay;
+  RayEntries entries;
+  for (size_t first = begin; first < end; first += 4) {
+    int num_lanes = (int)min(end - first, (size_t)4);
+
+    // The tree is stored in the space of the root's parent.
+    CollisionBroadphase::RayPacket packet;
+    LPoint3 origins[4];
+    LVector3 directions[4];
+    for (int lane = 0; lane < num_lanes; ++lane) {
+      origins[lane] = query->_origins[first + lane] * root_mat;
+      directions[lane] = root_mat.xform_vec(query->_directions[first + lane]);
+      packet.set_ray(lane, origins[lane], directions[lane],
+                     std::numeric_limits<PN_stdfloat>::infinity());
+    }
+
+    found.clear();
+    _tree.query_ray_packet(packet, found);
+
+    for (int lane = 0; lane < num_lanes; ++lane) {
+      // Visit the nodes that the ray passes through from front to back, so
+      // that we can stop as soon as the nearest hit so far is nearer than
+      // the next node.  Ties go to the node that comes first in scene graph
+      // order.
+      candidates.clear();
+      for (const CollisionBroadphase::PacketHit &packet_hit : found) {
+        if (packet_hit._lanes & (1 << lane)) {
+          candidates.push_back(RayCandidate(packet_hit._t_near[lane], packet_hit._data));
+        }
+      }
+      for (int i : _infinite_into) {
+        candidates.push_back(RayCandidate(0.0f, i));
+      }
+      std::sort(candidates.begin(), candidates.end());
+
+      CollisionRayQuery::Hit &hit = query->_hits[first + lane];
+      for (const RayCandidate &candidate : candidates) {
+        if (hit._t >= 0.0f && candidate.first > hit._t) {
+          break;
+        }
+
+        const IntoDef &def = _into_defs[candidate.second];
+        PandaNode *node = def._node_path.node();
+        if ((mask & node->get_into_collide_mask()).is_zero() ||
+            (mask & def._include_mask & def._net_mask).is_zero()) {
+          continue;
+        }
+        const LMatrix4 *inv_net_mat = def._net_transform->get_inverse_mat();
+        if (inv_net_mat == nullptr) {
+          continue;
+        }
+
+        ray->set_origin(origins[lane] * (*inv_net_mat));
+        ray->set_direction(inv_net_mat->xform_vec(directions[lane]));
+
+        // These are the same bounds that the ray would compute for itself.
+        // Below a node with final bounds, the traverser doesn't test the
+        // bounds of the solids any more.
+        BoundingLine ray_bounds(ray->get_origin(),
+                                ray->get_origin() + ray->get_direction());
+        const GeometricBoundingVolume *ray_gbv = nullptr;
+        if (!def._is_final && !def._below_final) {
+          ray_gbv = &ray_bounds;
+        }
+
+        if (cast_ray_into(def, ray, ray_gbv, entries, hit)) {
+          // Bring the hit from the space of the node to that of the root.
+          LMatrix4 to_root_mat = def._net_transform->get_mat() * inv_root_mat;
+          hit._pos = hit._pos * to_root_mat;
+          hit._normal = to_root_mat.xform_vec(hit._normal);
+          hit._normal.normalize();
+        }
+      }
+    }
+  }
+}
+
+/**
+ * Tests the indicated ray, which is given in the space of the indicated
+ * node, against the node.  The ray's bounds are given as well, unless the
+ * node is or is below a node with final bounds.  The entries are only used
+ * to collect the results of the test, and are cleared first.  If the ray
+ * hits the node nearer than the indicated hit, replaces the hit with the new
+ * one, in the space of the node, and returns true; otherwise, returns false.
+ */
+bool CollisionTraverser::
+cast_ray_into(const IntoDef &def, CollisionRay *ray,
+              const GeometricBoundingVolume *ray_gbv, RayEntries &entries,
+              CollisionRayQuery::Hit &hit) {
+  const LPoint3 &origin = ray->get_origin();
+  const LVector3 &direction = ray->get_direction();
+
+  // The ray is already in the space of the node, so we test it as though it
+  // were parented to the node itself.
+  CollisionEntry entry;
+  entry._from = ray;
+  entry._from_node_path = def._node_path;
+  entry._into_node = def._node_path.node();
+  entry._into_node_path = def._node_path;
+
+  entries._entries.clear();
+  if (entry._into_node->is_collision_node()) {
+    compare_collider_to_node(entry, &entries, nullptr, ray_gbv, nullptr);
+  } else {
+    compare_collider_to_geom_node(entry, &entries, nullptr, ray_gbv, nullptr);
+  }
+
+  // The entries are all in the space of the node, like the ray.
+  bool found = false;
+  PN_stdfloat inv_length_squared = 1.0f / direction.length_squared();
+  for (const CollisionEntry *result : entries._entries) {
+    if (!result->has_surface_point()) {
+      continue;
+    }
+    PN_stdfloat t = (result->_surface_point - origin).dot(direction) * inv_length_squared;
+    t = max(t, (PN_stdfloat)0.0f);
+    if (hit._t < 0.0f || t < hit._t) {
+      hit._t = t;
+      hit._pos = result->_surface_point;
+      if (result->has_surface_normal()) {
+        hit._normal = result->_surface_normal;
+      } else {
+        hit._normal = -direction;
+      }
+      hit._node_path = def._node_path;
+      found = true;
+    }
+  }
+  return found;
+}
+
+/**
+ * Casts the rays of the query on the "collide" task chain; see
+ * collision-num-threads.  The rays are divided into consecutive batches,
+ * each of which stores the hits of its own rays in the query.
+ */
+void CollisionTraverser::
+cast_rays_parallel(CollisionRayQuery *query, CollideMask mask,
+                   const TransformState *root_transform) {
+  AsyncTaskManager *task_mgr = AsyncTaskManager::get_global_ptr();
+  AsyncTaskChain *chain = CollisionTraverserTask::get_task_chain();
+
+  // Keep the batches a multiple of the packet size.
+  size_t batch_size = (size_t)max((int)collision_parallel_batch_size, 1);
+  batch_size = (batch_size + 3) & ~(size_t)3;
+
+  size_t num_rays = query->get_num_rays();
+  typedef pvector<PT(CollisionTraverserTask)> Tasks;
+  Tasks tasks;
+  tasks.reserve((num_rays + batch_size - 1) / batch_size);
+  for (size_t begin = 0; begin < num_rays; begin += batch_size) {
+    size_t end = min(begin + batch_size, num_rays);
+    PT(CollisionTraverserTask) task =
+      new CollisionTraverserTask(this, query, mask, root_transform, begin, end);
+    task->set_task_chain(chain->get_name());
+    task_mgr->add(task);
+    tasks.push_back(std::move(task));
+  }
+
+  for (CollisionTraverserTask *task : tasks) {
+    task->wait();
+  }
+}
+
+/**
+ * Passes on the levels counted by the PStatCollectors during a traversal.
+ */
+void CollisionTraverser::
+flush_level() {
+  CollisionLevelStateBase::_node_volume_pcollector.flush_level();
+  _cnode_volume_pcollector.flush_level();
+  _gnode_volume_pcollector.flush_level();
+  _geom_volume_pcollector.flush_level();
+
+  CollisionSphere::flush_level();
+  CollisionCapsule::flush_level();
+  CollisionPolygon::flush_level();
+  CollisionPlane::flush_level();
+  CollisionBox::flush_level();
+  CollisionMesh::flush_level();
+}
+
+/**
+ * The recursive part of traverse_broadphase(), which collects the nodes at
+ * and below the indicated one that may be collided into by any collider with
+ * the indicated from mask.  The parent transform is the net transform of the
+ * node's parent, relative to the traversal root's parent.  If the node is
+ * below a node with final bounds, those bounds are given, along with the
+ * transform of that node's parent.
+ */
+void CollisionTraverser::
+r_collect_into_nodes(const NodePath &node_path,
+                     const TransformState *parent_transform,
+                     CollideMask parent_include_mask,
+                     CollideMask include_mask, CollideMask from_mask,
+                     const BoundingVolume *final_bounds,
+                     const TransformState *final_transform) {
+  Thread *current_thread = Thread::get_current_thread();
+  PandaNode *node = node_path.node();
+
+  CPT(TransformState) node_transform = node->get_transform(current_thread);
+  if (!node_transform->is_identity() &&
+      node_transform->get_inverse_mat() == nullptr) {
+    // No inverse.
+    return;
+  }
+  CPT(TransformState) net_transform = parent_transform->compose(node_transform);
+
+  if ((node->is_collision_node() || node->is_geom_node()) &&
+      !(node->get_into_collide_mask() & from_mask).is_zero()) {
+    IntoDef def;
+    def._node_path = node_path;
+    def._parent_transform = parent_transform;
+    def._net_transform = net_transform;
+    def._include_mask = parent_include_mask;
+    def._net_mask = node->get_net_collide_mask(current_thread);
+    def._below_final = (final_bounds != nullptr);
+    def._is_final = node->is_final(current_thread);
+    if (def._below_final) {
+      // Below a node with final bounds, the bounds of the nodes themselves
+      // may not be meaningful.
+      def._bounds = final_bounds;
+      def._bounds_transform = final_transform;
+    } else {
+      def._bounds = node->get_bounds(current_thread);
+      def._bounds_transform = parent_transform;
+    }
+
+    if (!def._bounds->is_empty()) {
+      _into_defs.push_back(std::move(def));
+      update_broadphase((int)_into_defs.size() - 1);
+    }
+  }
+
+  CPT(BoundingVolume) node_bounds;
+  if (final_bounds == nullptr && node->is_final(current_thread)) {
+    node_bounds = node->get_bounds(current_thread);
+    final_bounds = node_bounds;
+    final_transform = parent_transform;
+  }
+
+  PandaNode::Children children = node->get_children(current_thread);
+  int num_children = children.get_num_children();
+  int begin = 0;
+  int end = num_children;
+  bool is_lod = false;
+  int lowest_switch = -1;
+  if (node->has_single_child_visibility()) {
+    // If it's a switch node or sequence node, visit just the one visible
+    // child.
+    begin = node->get_visible_child();
+    end = begin + 1;
+    if (begin < 0 || begin >= num_children) {
+      return;
+    }
+  } else if (node->is_lod_node()) {
+    // If it's an LODNode, only the lowest level of detail may collide with
+    // visible geometry; see r_traverse_single().  As there, this only
+    // affects the descendants of the other levels, not the levels
+    // themselves.
+    is_lod = true;
+    lowest_switch = DCAST(LODNode, node)->get_lowest_switch();
+  }
+
+  for (int i = begin; i < end; ++i) {
+    const PandaNode::DownConnection &child = children.get_child_connection(i);
+    if (!(child.get_net_collide_mask() & include_mask & from_mask).is_zero()) {
+      CollideMask child_include_mask = include_mask;
+      if (is_lod && i != lowest_switch) {
+        child_include_mask &= ~GeomNode::get_default_collide_mask();
+      }
+      NodePath child_path(node_path, child.get_child(), current_thread);
+      r_collect_into_nodes(child_path, net_transform, include_mask,
+                           child_include_mask, from_mask,
+                           final_bounds, final_transform);
+    }
+  }
+}
+
+/**
+ * Brings the broadphase tree up-to-date with the bounds of the indicated
+ * node, which was just added to _into_defs.
+ */
+void CollisionTraverser::
+update_broadphase(int index) {
+  const IntoDef &def = _into_defs[index];
+
+  Proxies::iterator pi = _proxies.find(def._node_path);
+  if (pi == _proxies.end()) {
+    ProxyDef proxy_def;
+    proxy_def._proxy = -1;
+    proxy_def._last_seen = 0;
+    pi = _proxies.insert(Proxies::value_type(def._node_path, proxy_def)).first;
+  }
+  ProxyDef &proxy_def = (*pi).second;
+
+  if (proxy_def._last_seen == 0 ||
+      proxy_def._bounds != def._bounds ||
+      proxy_def._bounds_transform != def._bounds_transform) {
+    // The node has moved or changed shape since the last traversal.
+    LPoint3 min_point, max_point;
+    if (get_bounding_box(def._bounds, def._bounds_transform->get_mat(),
+                         min_point, max_point)) {
+      if (proxy_def._proxy >= 0) {
+        _tree.move_proxy(proxy_def._proxy, min_point, max_point);
+      } else {
+        proxy_def._proxy = _tree.add_proxy(min_point, max_point, index);
+      }
+    } else if (proxy_def._proxy >= 0) {
+      _tree.remove_proxy(proxy_def._proxy);
+      proxy_def._proxy = -1;
+    }
+    proxy_def._bounds = def._bounds;
+    proxy_def._bounds_transform = def._bounds_transform;
+  }
+  proxy_def._last_seen = _broadphase_seq;
+
+  if (proxy_def._proxy >= 0) {
+    _tree.set_data(proxy_def._proxy, index);
+  } else {
+    _infinite_into.push_back(index);
+  }
+}
+
 /**
  *
  */
 void CollisionTraverser::
-compare_collider_to_node(CollisionEntry &entry,
+compare_collider_to_node(CollisionEntry &entry, CollisionHandler *record,
                          const GeometricBoundingVolume *from_parent_gbv,
                          const GeometricBoundingVolume *from_node_gbv,
                          const GeometricBoundingVolume *into_node_gbv) {
@@ -1145,10 +1887,7 @@ compare_collider_to_node(CollisionEntry &entry,
     // we just tested, is the same as the solid's bounding volume.)
     if (num_solids == 1) {
       entry._into = cnode->_solids[0].get_read_pointer(current_thread);
-      Colliders::const_iterator ci;
-      ci = _colliders.find(entry.get_from_node_path());
-      nassertv(ci != _colliders.end());
-      entry.test_intersection((*ci).second, this);
+      entry.test_intersection(record, this);
     } else {
       CollisionNode::Solids::const_iterator si;
       for (si = cnode->_solids.begin(); si != cnode->_solids.end(); ++si) {
@@ -1161,7 +1900,7 @@ compare_collider_to_node(CollisionEntry &entry,
         CPT(BoundingVolume) solid_bv = entry._into->get_bounds();
         const GeometricBoundingVolume *solid_gbv = solid_bv->as_geometric_bounding_volume();
 
-        compare_collider_to_solid(entry, from_node_gbv, solid_gbv);
+        compare_collider_to_solid(entry, record, from_node_gbv, solid_gbv);
       }
     }
   }
@@ -1171,7 +1910,7 @@ compare_collider_to_node(CollisionEntry &entry,
  *
  */
 void CollisionTraverser::
-compare_collider_to_geom_node(CollisionEntry &entry,
+compare_collider_to_geom_node(CollisionEntry &entry, CollisionHandler *record,
                               const GeometricBoundingVolume *from_parent_gbv,
                               const GeometricBoundingVolume *from_node_gbv,
                               const GeometricBoundingVolume *into_node_gbv) {
@@ -1201,7 +1940,7 @@ compare_collider_to_geom_node(CollisionEntry &entry,
           geom_gbv = geom_bv->as_geometric_bounding_volume();
         }
 
-        compare_collider_to_geom(entry, geom, from_node_gbv, geom_gbv);
+        compare_collider_to_geom(entry, record, geom, from_node_gbv, geom_gbv);
       }
     }
   }
@@ -1211,7 +1950,7 @@ compare_collider_to_geom_node(CollisionEntry &entry,
  *
  */
 void CollisionTraverser::
-compare_collider_to_solid(CollisionEntry &entry,
+compare_collider_to_solid(CollisionEntry &entry, CollisionHandler *record,
                           const GeometricBoundingVolume *from_node_gbv,
                           const GeometricBoundingVolume *solid_gbv) {
   bool within_solid_bounds = true;
@@ -1231,10 +1970,7 @@ compare_collider_to_solid(CollisionEntry &entry,
 #endif  // NDEBUG
   }
   if (within_solid_bounds) {
-    Colliders::const_iterator ci;
-    ci = _colliders.find(entry.get_from_node_path());
-    nassertv(ci != _colliders.end());
-    entry.test_intersection((*ci).second, this);
+    entry.test_intersection(record, this);
   }
 }
 
@@ -1242,7 +1978,8 @@ compare_collider_to_solid(CollisionEntry &entry,
  *
  */
 void CollisionTraverser::
-compare_collider_to_geom(CollisionEntry &entry, const Geom *geom,
+compare_collider_to_geom(CollisionEntry &entry, CollisionHandler *record,
+                         const Geom *geom,
                          const GeometricBoundingVolume *from_node_gbv,
                          const GeometricBoundingVolume *geom_gbv) {
   bool within_geom_bounds = true;
@@ -1252,9 +1989,16 @@ compare_collider_to_geom(CollisionEntry &entry, const Geom *geom,
     _geom_volume_pcollector.add_level(1);
   }
   if (within_geom_bounds) {
-    Colliders::const_iterator ci;
-    ci = _colliders.find(entry.get_from_node_path());
-    nassertv(ci != _colliders.end());
+    if (geom->get_primitive_type() == Geom::PT_polygons &&
+        collision_geom_mesh_threshold > 0) {
+      // Test a large Geom all at once, as a CollisionMesh.
+      PT(CollisionMesh) mesh = get_geom_mesh(geom);
+      if (mesh != nullptr) {
+        entry._into = mesh;
+        entry.test_intersection(record, this);
+        return;
+      }
+    }
 
     if (geom->get_primitive_type() == Geom::PT_polygons) {
       Thread *current_thread = Thread::get_current_thread();
@@ -1295,7 +2039,7 @@ compare_collider_to_geom(CollisionEntry &entry, const Geom *geom,
               if (within_solid_bounds) {
                 PT(CollisionGeom) cgeom = new CollisionGeom(v[0], v[1], v[2]);
                 entry._into = cgeom;
-                entry.test_intersection((*ci).second, this);
+                entry.test_intersection(record, this);
               }
             }
           }
@@ -1325,7 +2069,7 @@ compare_collider_to_geom(CollisionEntry &entry, const Geom *geom,
               if (within_solid_bounds) {
                 PT(CollisionGeom) cgeom = new CollisionGeom(v[0], v[1], v[2]);
                 entry._into = cgeom;
-                entry.test_intersection((*ci).second, this);
+                entry.test_intersection(record, this);
               }
             }
           }
@@ -1388,6 +2132,61 @@ remove_handler(CollisionTraverser::Handlers::iterator hi) {
   return hi;
 }
 
+/**
+ * Returns a CollisionMesh made of the triangles of the indicated Geom, if it
+ * has at least as many as collision-geom-mesh-threshold, and its vertices are
+ * not animated.  The mesh is kept for subsequent traversals, and rebuilt if
+ * the Geom is modified.  Returns nullptr if the Geom should be tested
+ * triangle by triangle instead.
+ *
+ * This may be called by several threads at once during a parallel traversal.
+ */
+PT(CollisionMesh) CollisionTraverser::
+get_geom_mesh(const Geom *geom) {
+  Thread *current_thread = Thread::get_current_thread();
+  CPT(GeomVertexData) data = geom->get_vertex_data(current_thread);
+  if (data->get_transform_table() != nullptr ||
+      data->get_transform_blend_table() != nullptr ||
+      data->get_slider_table() != nullptr) {
+    return nullptr;
+  }
+
+  UpdateSeq geom_modified = geom->get_modified(current_thread);
+  UpdateSeq vdata_modified = data->get_modified(current_thread);
+
+  LightMutexHolder holder(_geom_meshes_lock);
+  GeomMeshes::iterator gmi = _geom_meshes.find(geom);
+  if (gmi != _geom_meshes.end()) {
+    const GeomMeshDef &def = (*gmi).second;
+    if (def._geom.is_valid_pointer() &&
+        def._geom_modified == geom_modified &&
+        def._vdata_modified == vdata_modified) {
+      return def._mesh;
+    }
+  }
+
+  // We also remember the Geoms that are too small, so that we needn't count
+  // their triangles again.
+  PT(CollisionMesh) mesh;
+  int num_triangles = 0;
+  int num_primitives = geom->get_num_primitives();
+  for (int i = 0; i < num_primitives; ++i) {
+    num_triangles += geom->get_primitive(i)->get_num_faces();
+  }
+  if (num_triangles >= collision_geom_mesh_threshold) {
+    mesh = new CollisionMesh;
+    mesh->add_geom(geom);
+    mesh->build_bvh();
+  }
+
+  GeomMeshDef &def = _geom_meshes[geom];
+  def._geom = geom;
+  def._geom_modified = geom_modified;
+  def._vdata_modified = vdata_modified;
+  def._mesh = mesh;
+  return mesh;
+}
+
 /**
  * Returns the PStatCollector suitable for timing the nth pass.
  */
@@ -18,16 +18,25 @@
 
 #include "collisionHandler.h"
 #include "collisionLevelState.h"
+#include "collisionBroadphase.h"
+#include "collisionMesh.h"
+#include "collisionRayQuery.h"
 
 #include "pointerTo.h"
+#include "weakPointerTo.h"
+#include "geom.h"
+#include "lightMutex.h"
 #include "pStatCollector.h"
 
 #include "pset.h"
+#include "pmap.h"
 #include "register_type.h"
 #include "extension.h"
 
 class CollisionNode;
+class CollisionRay;
 class CollisionRecorder;
+class CollisionTraverserTask;
 class CollisionVisualizer;
 class Geom;
 class NodePath;
@@ -53,6 +62,14 @@ PUBLISHED:
   MAKE_PROPERTY(respect_prev_transform, get_respect_prev_transform,
                                         set_respect_prev_transform);
 
+  INLINE void set_broadphase(bool flag);
+  INLINE bool get_broadphase() const;
+  MAKE_PROPERTY(broadphase, get_broadphase, set_broadphase);
+
+  INLINE void set_continuous(bool flag);
+  INLINE bool get_continuous() const;
+  MAKE_PROPERTY(continuous, get_continuous, set_continuous);
+
   void add_collider(const NodePath &collider, CollisionHandler *handler);
   bool remove_collider(const NodePath &collider);
   bool has_collider(const NodePath &collider) const;
@@ -64,6 +81,8 @@ PUBLISHED:
   MAKE_SEQ_PROPERTY(colliders, get_num_colliders, get_collider);
 
   BLOCKING void traverse(const NodePath &root);
+  BLOCKING void cast_rays(const NodePath &root, CollisionRayQuery *query,
+                          CollideMask mask);
 
 #if defined(DO_COLLISION_RECORDING) || !defined(CPPPARSER)
   void set_recorder(CollisionRecorder *recorder);
@@ -96,20 +115,32 @@ private:
   void prepare_colliders_quad(LevelStatesQuad &level_states, const NodePath &root);
   void r_traverse_quad(CollisionLevelStateQuad &level_state, size_t pass);
 
-  void compare_collider_to_node(CollisionEntry &entry,
+  void traverse_broadphase(const NodePath &root);
+  void update_broadphase_tree(const NodePath &root, CollideMask from_mask);
+  void r_collect_into_nodes(const NodePath &node_path,
+                            const TransformState *parent_transform,
+                            CollideMask parent_include_mask,
+                            CollideMask include_mask, CollideMask from_mask,
+                            const BoundingVolume *final_bounds,
+                            const TransformState *final_transform);
+  void update_broadphase(int index);
+
+  void compare_collider_to_node(CollisionEntry &entry, CollisionHandler *record,
                                 const GeometricBoundingVolume *from_parent_gbv,
                                 const GeometricBoundingVolume *from_node_gbv,
                                 const GeometricBoundingVolume *into_node_gbv);
-  void compare_collider_to_geom_node(CollisionEntry &entry,
+  void compare_collider_to_geom_node(CollisionEntry &entry, CollisionHandler *record,
                                      const GeometricBoundingVolume *from_parent_gbv,
                                      const GeometricBoundingVolume *from_node_gbv,
                                      const GeometricBoundingVolume *into_node_gbv);
-  void compare_collider_to_solid(CollisionEntry &entry,
+  void compare_collider_to_solid(CollisionEntry &entry, CollisionHandler *record,
                                  const GeometricBoundingVolume *from_node_gbv,
                                  const GeometricBoundingVolume *solid_gbv);
-  void compare_collider_to_geom(CollisionEntry &entry, const Geom *geom,
+  void compare_collider_to_geom(CollisionEntry &entry, CollisionHandler *record,
+                                const Geom *geom,
                                 const GeometricBoundingVolume *from_node_gbv,
                                 const GeometricBoundingVolume *solid_gbv);
+  PT(CollisionMesh) get_geom_mesh(const Geom *geom);
 
   PStatCollector &get_pass_collector(int pass);
 
@@ -133,6 +164,97 @@ private:
   Handlers::iterator remove_handler(Handlers::iterator hi);
 
   bool _respect_prev_transform;
+  bool _broadphase;
+  bool _continuous;
+
+  // The nodes that the colliders may collide into, as found by the
+  // broadphase traversal, in scene graph order.
+  class IntoDef {
+  public:
+    NodePath _node_path;
+    CPT(TransformState) _parent_transform;
+    CPT(TransformState) _net_transform;
+
+    // The traversal only visits the node for a collider whose from mask has
+    // bits in common with both of these.  The include mask is the one in
+    // effect at the node's parent.
+    CollideMask _include_mask;
+    CollideMask _net_mask;
+
+    // The bounds used for the broadphase, and the transform that brings them
+    // into the space of the root's parent.  These are normally the node's own
+    // bounds, but those of its nearest "final" ancestor if it has one.
+    CPT(BoundingVolume) _bounds;
+    CPT(TransformState) _bounds_transform;
+    bool _is_final;
+    bool _below_final;
+  };
+  typedef pvector<IntoDef> IntoDefs;
+  IntoDefs _into_defs;
+
+  // A collider as seen by the broadphase traversal, along with the handler
+  // that serves it.
+  class BroadphaseCollider {
+  public:
+    CollisionLevelStateBase::ColliderDef _def;
+    CPT(GeometricBoundingVolume) _bounds;
+    CollisionHandler *_handler;
+  };
+  typedef pvector<BroadphaseCollider> BroadphaseColliders;
+
+  // A candidate pair found by the broadphase: an index into _into_defs and
+  // an index into the BroadphaseColliders.
+  typedef std::pair<int, int> BroadphasePair;
+  typedef pvector<BroadphasePair> BroadphasePairs;
+
+  void test_broadphase_pair(const IntoDef &def,
+                            const BroadphaseCollider &collider,
+                            CollisionHandler *record);
+  void test_broadphase_pairs_parallel(const BroadphaseColliders &colliders,
+                                      const BroadphasePairs &pairs);
+
+  void cast_ray_range(CollisionRayQuery *query, CollideMask mask,
+                      const TransformState *root_transform,
+                      size_t begin, size_t end);
+  class RayEntries;
+  bool cast_ray_into(const IntoDef &def, CollisionRay *ray,
+                     const GeometricBoundingVolume *ray_gbv,
+                     RayEntries &entries, CollisionRayQuery::Hit &hit);
+  void cast_rays_parallel(CollisionRayQuery *query, CollideMask mask,
+                          const TransformState *root_transform);
+  static void flush_level();
+
+  // The node bounds that are currently stored in the broadphase tree.
+  class ProxyDef {
+  public:
+    int _proxy;
+    int _last_seen;
+    CPT(BoundingVolume) _bounds;
+    CPT(TransformState) _bounds_transform;
+  };
+  typedef pmap<NodePath, ProxyDef> Proxies;
+  Proxies _proxies;
+  CollisionBroadphase _tree;
+  NodePath _broadphase_root;
+  CollideMask _broadphase_mask;
+  int _broadphase_seq;
+
+  // Nodes with infinite bounds, which every collider must be tested with.
+  pvector<int> _infinite_into;
+
+  // The CollisionMeshes made for the large Geoms that have been collided
+  // with; see collision-geom-mesh-threshold.
+  class GeomMeshDef {
+  public:
+    WCPT(Geom) _geom;
+    UpdateSeq _geom_modified;
+    UpdateSeq _vdata_modified;
+    PT(CollisionMesh) _mesh;
+  };
+  typedef pmap<const Geom *, GeomMeshDef> GeomMeshes;
+  GeomMeshes _geom_meshes;
+  LightMutex _geom_meshes_lock;
+
 #ifdef DO_COLLISION_RECORDING
   CollisionRecorder *_recorder;
   NodePath _collision_visualizer_np;
@@ -149,6 +271,7 @@ private:
   static PStatCollector _geom_volume_pcollector;
 
   PStatCollector _this_pcollector;
+  PStatCollector _broadphase_pcollector;
   typedef pvector<PStatCollector> PassCollectors;
   PassCollectors _pass_collectors;
   // pstats category for actual collision detection (vs.  bounding heirarchy
@@ -168,6 +291,7 @@ private:
   static TypeHandle _type_handle;
 
   friend class SortByColliderSort;
+  friend class CollisionTraverserTask;
 };
 
 INLINE std::ostream &operator << (std::ostream &out, const CollisionTraverser &trav) {
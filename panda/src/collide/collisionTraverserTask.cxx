@@ -0,0 +1,141 @@
+/**
+ * PANDA 3D SOFTWARE
+ * Copyright (c) Carnegie Mellon University.  All rights reserved.
+ *
+ * All use of this software is subject to the terms of the revised BSD
+ * license.  You should have received a copy of this license along
+ * with this source code in a file named "LICENSE."
+ *
+ * @file collisionTraverserTask.cxx
+ * @author djs3000
+ * @date 2026-10-16
+ */
+
+#include "collisionTraverserTask.h"
+#include "asyncTaskManager.h"
+#include "config_collide.h"
+
+TypeHandle CollisionTraverserTask::_type_handle;
+
+/**
+ * Creates a task that will test the pairs in the indicated range when it is
+ * run.  The colliders and pairs must remain unchanged until it has finished.
+ */
+CollisionTraverserTask::
+CollisionTraverserTask(CollisionTraverser *trav,
+                       const CollisionTraverser::BroadphaseColliders *colliders,
+                       const CollisionTraverser::BroadphasePairs *pairs,
+                       size_t begin, size_t end) :
+  _trav(trav),
+  _pipeline_stage(Thread::get_current_pipeline_stage()),
+  _colliders(colliders),
+  _pairs(pairs),
+  _query(nullptr),
+  _begin(begin),
+  _end(end)
+{
+}
+
+/**
+ * Creates a task that will cast the rays of the query in the indicated range
+ * when it is run.  The query must not be modified until it has finished.
+ */
+CollisionTraverserTask::
+CollisionTraverserTask(CollisionTraverser *trav, CollisionRayQuery *query,
+                       CollideMask mask, const TransformState *root_transform,
+                       size_t begin, size_t end) :
+  _trav(trav),
+  _pipeline_stage(Thread::get_current_pipeline_stage()),
+  _colliders(nullptr),
+  _pairs(nullptr),
+  _query(query),
+  _mask(mask),
+  _root_transform(root_transform),
+  _begin(begin),
+  _end(end)
+{
+}
+
+/**
+ * Passes on all of the entries collected by the task to the handlers they
+ * are meant for, in the order in which they were recorded.  This must be
+ * called by the thread that called traverse(), after the task has finished.
+ */
+void CollisionTraverserTask::
+flush() {
+  for (const Recorder::Record &record : _recorder._records) {
+    record._handler->add_entry(record._entry);
+  }
+  _recorder._records.clear();
+}
+
+/**
+ * Returns the task chain on which the batches of a parallel traversal are
+ * run.  It is created, with collision-num-threads threads, the first time it
+ * is needed.
+ */
+AsyncTaskChain *CollisionTraverserTask::
+get_task_chain() {
+  static PT(AsyncTaskChain) chain = [] {
+    AsyncTaskManager *task_mgr = AsyncTaskManager::get_global_ptr();
+    PT(AsyncTaskChain) chain = task_mgr->make_task_chain("collide");
+    chain->set_num_threads(collision_num_threads);
+    return chain;
+  }();
+  return chain;
+}
+
+/**
+ * Tests the pairs on the current thread.
+ */
+AsyncTask::DoneStatus CollisionTraverserTask::
+do_task() {
+  // The worker threads are shared between all traversers, which may be
+  // running on different pipeline stages.
+  Thread::get_current_thread()->set_pipeline_stage(_pipeline_stage);
+
+  if (_query != nullptr) {
+    _trav->cast_ray_range(_query, _mask, _root_transform, _begin, _end);
+    return DS_done;
+  }
+
+  for (size_t i = _begin; i < _end; ++i) {
+    const CollisionTraverser::BroadphasePair &pair = (*_pairs)[i];
+    const CollisionTraverser::BroadphaseCollider &collider = (*_colliders)[pair.second];
+    _recorder.set_handler(collider._handler);
+    _trav->test_broadphase_pair(_trav->_into_defs[pair.first], collider, &_recorder);
+  }
+
+  return DS_done;
+}
+
+/**
+ *
+ */
+CollisionTraverserTask::Recorder::
+Recorder() :
+  _handler(nullptr)
+{
+}
+
+/**
+ * Sets the handler that the subsequently recorded entries are meant for.
+ * The recorder asks for the pairs that didn't collide only if it does.
+ */
+void CollisionTraverserTask::Recorder::
+set_handler(CollisionHandler *handler) {
+  _handler = handler;
+  _wants_all_potential_collidees = handler->wants_all_potential_collidees();
+}
+
+/**
+ * Remembers the entry, along with the handler of the pair being tested.
+ */
+void CollisionTraverserTask::Recorder::
+add_entry(CollisionEntry *entry) {
+  nassertv(entry != nullptr);
+  Record record;
+  record._handler = _handler;
+  record._entry = entry;
+  _records.push_back(std::move(record));
+}
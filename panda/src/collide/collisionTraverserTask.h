@@ -0,0 +1,109 @@
+/**
+ * PANDA 3D SOFTWARE
+ * Copyright (c) Carnegie Mellon University.  All rights reserved.
+ *
+ * All use of this software is subject to the terms of the revised BSD
+ * license.  You should have received a copy of this license along
+ * with this source code in a file named "LICENSE."
+ *
+ * @file collisionTraverserTask.h
+ * @author djs3000
+ * @date 2026-10-16
+ */
+
+#ifndef COLLISIONTRAVERSERTASK_H
+#define COLLISIONTRAVERSERTASK_H
+
+#include "pandabase.h"
+
+#include "asyncTask.h"
+#include "collisionHandler.h"
+#include "collisionEntry.h"
+#include "collisionTraverser.h"
+#include "collisionRayQuery.h"
+#include "collideMask.h"
+#include "transformState.h"
+#include "pointerTo.h"
+#include "pvector.h"
+
+/**
+ * This represents one batch of a parallel collision traversal; see
+ * collision-num-threads.  When it is run on one of the collide worker
+ * threads, it tests a consecutive range of the candidate pairs found by the
+ * broadphase, and collects the resulting CollisionEntries, so that they may
+ * later be passed on to the real CollisionHandlers on the calling thread in
+ * the same order in which a serial traversal would have produced them.
+ *
+ * It may also cast a consecutive range of the rays of a CollisionRayQuery,
+ * for CollisionTraverser::cast_rays(), in which case the hits are stored
+ * directly in the query.
+ */
+class EXPCL_PANDA_COLLIDE CollisionTraverserTask : public AsyncTask {
+public:
+  ALLOC_DELETED_CHAIN(CollisionTraverserTask);
+
+  CollisionTraverserTask(CollisionTraverser *trav,
+                         const CollisionTraverser::BroadphaseColliders *colliders,
+                         const CollisionTraverser::BroadphasePairs *pairs,
+                         size_t begin, size_t end);
+  CollisionTraverserTask(CollisionTraverser *trav, CollisionRayQuery *query,
+                         CollideMask mask, const TransformState *root_transform,
+                         size_t begin, size_t end);
+
+  void flush();
+
+  static AsyncTaskChain *get_task_chain();
+
+protected:
+  virtual AsyncTask::DoneStatus do_task();
+
+private:
+  // This is given to the collision tests in place of the real handlers, and
+  // remembers which real handler each entry is meant for.
+  class Recorder : public CollisionHandler {
+  public:
+    Recorder();
+
+    void set_handler(CollisionHandler *handler);
+    virtual void add_entry(CollisionEntry *entry);
+
+    class Record {
+    public:
+      CollisionHandler *_handler;
+      PT(CollisionEntry) _entry;
+    };
+    typedef pvector<Record> Records;
+    Records _records;
+    CollisionHandler *_handler;
+  };
+
+  CollisionTraverser *_trav;
+  int _pipeline_stage;
+  const CollisionTraverser::BroadphaseColliders *_colliders;
+  const CollisionTraverser::BroadphasePairs *_pairs;
+  CollisionRayQuery *_query;
+  CollideMask _mask;
+  CPT(TransformState) _root_transform;
+  size_t _begin;
+  size_t _end;
+  Recorder _recorder;
+
+public:
+  static TypeHandle get_class_type() {
+    return _type_handle;
+  }
+  static void init_type() {
+    AsyncTask::init_type();
+    register_type(_type_handle, "CollisionTraverserTask",
+                  AsyncTask::get_class_type());
+  }
+  virtual TypeHandle get_type() const {
+    return get_class_type();
+  }
+  virtual TypeHandle force_init_type() {init_type(); return get_class_type();}
+
+private:
+  static TypeHandle _type_handle;
+};
+
+#endif
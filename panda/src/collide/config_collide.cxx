@@ -26,6 +26,7 @@
 #include "collisionHandlerQueue.h"
 #include "collisionInvSphere.h"
 #include "collisionLine.h"
+#include "collisionMesh.h"
 #include "collisionLevelStateBase.h"
 #include "collisionGeom.h"
 #include "collisionNode.h"
@@ -34,11 +35,13 @@
 #include "collisionPolygon.h"
 #include "collisionFloorMesh.h"
 #include "collisionRay.h"
+#include "collisionRayQuery.h"
 #include "collisionRecorder.h"
 #include "collisionSegment.h"
 #include "collisionSolid.h"
 #include "collisionSphere.h"
 #include "collisionTraverser.h"
+#include "collisionTraverserTask.h"
 #include "collisionVisualizer.h"
 #include "dconfig.h"
 
@@ -77,6 +80,70 @@ ConfigVariableBool allow_collider_multiple
           "false, a one-word BitMask is always used instead, which is faster "
           "per pass, but may require more passes."));
 
+ConfigVariableBool collision_broadphase
+("collision-broadphase", false,
+ PRC_DESC("Set this true to have all CollisionTraversers find the nodes that "
+          "each collider might intersect with by querying a tree of the "
+          "world-space bounding boxes of the collidable nodes, rather than "
+          "by walking the scene graph once per group of colliders.  The "
+          "tree is kept from one traversal to the next, and updated as "
+          "the nodes move.  This is much faster when there are many "
+          "colliders.  It may also be enabled on a per-traverser basis "
+          "with CollisionTraverser::set_broadphase()."));
+
+ConfigVariableDouble collision_broadphase_margin
+("collision-broadphase-margin", 0.1,
+ PRC_DESC("The boxes stored in the broadphase tree are enlarged by this "
+          "fraction of their size on each side, so that a node that moves "
+          "a small distance does not have to be reinserted in the tree."));
+
+ConfigVariableInt collision_geom_mesh_threshold
+("collision-geom-mesh-threshold", 0,
+ PRC_DESC("If this is positive, a CollisionTraverser tests colliders against "
+          "a visible Geom with at least this many triangles by way of a "
+          "CollisionMesh, which it builds the first time and keeps for as "
+          "long as the Geom is unchanged, rather than by testing each "
+          "triangle in turn.  Only one contact with the Geom is reported "
+          "then, instead of one per triangle.  Geoms with animated vertices "
+          "are always tested triangle by triangle."));
+
+ConfigVariableInt collision_num_threads
+("collision-num-threads", 0,
+ PRC_DESC("Set this to a nonzero value to test the colliders of a "
+          "CollisionTraverser against the scene on the indicated number of "
+          "worker threads.  This applies to traversers that use the "
+          "broadphase; see collision-broadphase.  The collidable nodes are "
+          "first gathered on the calling thread; the candidate pairs "
+          "are then tested in batches on the worker threads, and the "
+          "detected collisions are passed on to the handlers on the calling "
+          "thread, in the same order as with a serial traversal.  This has "
+          "no effect if Panda was not compiled with true threading support, "
+          "or while a CollisionRecorder is attached."));
+
+ConfigVariableInt collision_parallel_batch_size
+("collision-parallel-batch-size", 64,
+ PRC_DESC("When collision-num-threads is nonzero, this is the number of "
+          "candidate collider/node pairs that are tested by each task on "
+          "the worker threads.  A traversal that finds no more than this "
+          "many pairs is done entirely on the calling thread.  The rays "
+          "cast by CollisionTraverser::cast_rays() are divided among the "
+          "tasks in the same way."));
+
+ConfigVariableBool collision_continuous
+("collision-continuous", false,
+ PRC_DESC("The default value of CollisionTraverser::set_continuous().  When "
+          "this is true, moving CollisionSpheres and CollisionCapsules are "
+          "swept along the path they took since the previous frame, so that "
+          "fast-moving objects cannot pass through thin walls between frames. "
+          "This requires respect_prev_transform to be useful, and has a "
+          "cost proportional to the distance moved."));
+
+ConfigVariableInt collision_sweep_iterations
+("collision-sweep-iterations", 8,
+ PRC_DESC("The number of bisection steps taken to narrow down the moment of "
+          "impact of a continuous collider, once a collision has been found "
+          "along its path."));
+
 ConfigVariableBool flatten_collision_nodes
 ("flatten-collision-nodes", false,
  PRC_DESC("Set this true to allow NodePath::flatten_medium() and "
@@ -139,6 +206,7 @@ init_libcollide() {
   CollisionHandlerQueue::init_type();
   CollisionInvSphere::init_type();
   CollisionLine::init_type();
+  CollisionMesh::init_type();
   CollisionLevelStateBase::init_type();
   CollisionGeom::init_type();
   CollisionNode::init_type();
@@ -147,10 +215,12 @@ init_libcollide() {
   CollisionPolygon::init_type();
   CollisionFloorMesh::init_type();
   CollisionRay::init_type();
+  CollisionRayQuery::init_type();
   CollisionSegment::init_type();
   CollisionSolid::init_type();
   CollisionSphere::init_type();
   CollisionTraverser::init_type();
+  CollisionTraverserTask::init_type();
 
 #ifdef DO_COLLISION_RECORDING
   CollisionRecorder::init_type();
@@ -165,6 +235,7 @@ init_libcollide() {
   CollisionCapsule::register_with_read_factory();
   CollisionInvSphere::register_with_read_factory();
   CollisionLine::register_with_read_factory();
+  CollisionMesh::register_with_read_factory();
   CollisionNode::register_with_read_factory();
   CollisionParabola::register_with_read_factory();
   CollisionPlane::register_with_read_factory();
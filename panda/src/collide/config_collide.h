@@ -25,6 +25,13 @@ NotifyCategoryDecl(collide, EXPCL_PANDA_COLLIDE, EXPTP_PANDA_COLLIDE);
 extern EXPCL_PANDA_COLLIDE ConfigVariableBool respect_prev_transform;
 extern EXPCL_PANDA_COLLIDE ConfigVariableBool respect_effective_normal;
 extern EXPCL_PANDA_COLLIDE ConfigVariableBool allow_collider_multiple;
+extern EXPCL_PANDA_COLLIDE ConfigVariableBool collision_broadphase;
+extern EXPCL_PANDA_COLLIDE ConfigVariableDouble collision_broadphase_margin;
+extern EXPCL_PANDA_COLLIDE ConfigVariableInt collision_geom_mesh_threshold;
+extern EXPCL_PANDA_COLLIDE ConfigVariableInt collision_num_threads;
+extern EXPCL_PANDA_COLLIDE ConfigVariableInt collision_parallel_batch_size;
+extern EXPCL_PANDA_COLLIDE ConfigVariableBool collision_continuous;
+extern EXPCL_PANDA_COLLIDE ConfigVariableInt collision_sweep_iterations;
 extern EXPCL_PANDA_COLLIDE ConfigVariableBool flatten_collision_nodes;
 extern EXPCL_PANDA_COLLIDE ConfigVariableDouble collision_parabola_bounds_threshold;
 extern EXPCL_PANDA_COLLIDE ConfigVariableInt collision_parabola_bounds_sample;
@@ -1,15 +1,18 @@
 #include "collisionLevelStateBase.cxx"
 #include "collisionLevelState.cxx"
 #include "collisionLine.cxx"
+#include "collisionMesh.cxx"
 #include "collisionNode.cxx"
 #include "collisionParabola.cxx"
 #include "collisionPlane.cxx"
 #include "collisionPolygon.cxx"
 #include "collisionFloorMesh.cxx"
 #include "collisionRay.cxx"
+#include "collisionRayQuery.cxx"
 #include "collisionRecorder.cxx"
 #include "collisionSegment.cxx"
 #include "collisionSolid.cxx"
 #include "collisionSphere.cxx"
 #include "collisionTraverser.cxx"
+#include "collisionTraverserTask.cxx"
 #include "collisionVisualizer.cxx"
@@ -0,0 +1,105 @@
+/**
+ * PANDA 3D SOFTWARE
+ * Copyright (c) Carnegie Mellon University.  All rights reserved.
+ *
+ * All use of this software is subject to the terms of the revised BSD
+ * license.  You should have received a copy of this license along
+ * with this source code in a file named "LICENSE."
+ *
+ * @file test_collision_broadphase.cxx
+ * @author djs3000
+ * @date 2026-10-16
+ */
+
+#include "pandabase.h"
+#include "collisionTraverser.h"
+#include "collisionHandlerQueue.h"
+#include "collisionNode.h"
+#include "collisionSphere.h"
+#include "nodePath.h"
+#include "nodePathCollection.h"
+#include "randomizer.h"
+#include "trueClock.h"
+
+// This compares the time taken by CollisionTraverser::traverse() with and
+// without the broadphase tree, for a large number of moving colliders among
+// a larger number of static spheres that are spread over a number of groups.
+// The colliders are moved before each traversal, as they would be in a game.
+
+static const int num_groups = 40;
+static const int num_into_per_group = 50;
+static const int num_colliders = 500;
+static const int num_iterations = 20;
+static const PN_stdfloat world_size = 200.0f;
+
+static double
+run(CollisionTraverser &trav, CollisionHandlerQueue *handler,
+    const NodePath &root, NodePathCollection &colliders, bool broadphase,
+    int &num_entries) {
+  Randomizer random(42);
+  TrueClock *clock = TrueClock::get_global_ptr();
+  trav.set_broadphase(broadphase);
+
+  double total = 0.0;
+  num_entries = 0;
+  for (int n = 0; n < num_iterations; ++n) {
+    for (int i = 0; i < colliders.get_num_paths(); ++i) {
+      colliders[i].set_pos(random.random_real(world_size),
+                           random.random_real(world_size),
+                           random.random_real(10));
+    }
+
+    double start = clock->get_short_time();
+    trav.traverse(root);
+    total += clock->get_short_time() - start;
+    num_entries += handler->get_num_entries();
+  }
+  return total;
+}
+
+int
+main(int argc, char *argv[]) {
+  Randomizer random(1);
+
+  NodePath root("root");
+  for (int gi = 0; gi < num_groups; ++gi) {
+    NodePath group = root.attach_new_node("group");
+    LPoint3 center(random.random_real(world_size), random.random_real(world_size), 0);
+    for (int ni = 0; ni < num_into_per_group; ++ni) {
+      PT(CollisionNode) cnode = new CollisionNode("into");
+      cnode->add_solid(new CollisionSphere(0, 0, 0, 1 + random.random_real(2)));
+      cnode->set_from_collide_mask(CollideMask::all_off());
+      NodePath np = group.attach_new_node(cnode);
+      np.set_pos(center + LVector3(random.random_real(40) - 20,
+                                   random.random_real(40) - 20,
+                                   random.random_real(10)));
+    }
+  }
+
+  PT(CollisionHandlerQueue) handler = new CollisionHandlerQueue;
+  CollisionTraverser trav;
+  NodePathCollection colliders;
+  for (int i = 0; i < num_colliders; ++i) {
+    PT(CollisionNode) cnode = new CollisionNode("from");
+    cnode->add_solid(new CollisionSphere(0, 0, 0, 1));
+    cnode->set_into_collide_mask(CollideMask::all_off());
+    NodePath np = root.attach_new_node(cnode);
+    trav.add_collider(np, handler);
+    colliders.add_path(np);
+  }
+
+  int pass_entries, broadphase_entries;
+  double pass_time = run(trav, handler, root, colliders, false, pass_entries);
+  double broadphase_time = run(trav, handler, root, colliders, true, broadphase_entries);
+
+  double scale_ms = 1000.0 / num_iterations;
+  nout << num_colliders << " colliders, "
+       << num_groups * num_into_per_group << " static spheres\n"
+       << "passes:     " << pass_time * scale_ms << " ms, "
+       << pass_entries << " entries\n"
+       << "broadphase: " << broadphase_time * scale_ms << " ms, "
+       << broadphase_entries << " entries ("
+       << pass_time / broadphase_time << "x)\n";
+
+  return (pass_entries == broadphase_entries) ? 0 : 1;
+}
@@ -14,6 +14,7 @@
 #include "config_cull.h"
 
 #include "cullBinBackToFront.h"
+#include "cullBinBackToFrontCoherent.h"
 #include "cullBinFixed.h"
 #include "cullBinFrontToBack.h"
 #include "cullBinStateSorted.h"
@@ -33,6 +34,14 @@ ConfigureFn(config_cull) {
   init_libcull();
 }
 
+ConfigVariableBool cull_bin_radix_sort
+("cull-bin-radix-sort", true,
+ PRC_DESC("Set this true to sort large state-sorted, back-to-front and "
+          "front-to-back bins by building an integer key for each object "
+          "and radix sorting on it, or false to compare the objects "
+          "directly with std::sort.  The resulting order is the same, "
+          "except that ties may be broken differently."));
+
 /**
  * Initializes the library.  This must be called at least once before any of
  * the functions or classes in this library can be used.  Normally it will be
@@ -48,6 +57,7 @@ init_libcull() {
   initialized = true;
 
   CullBinBackToFront::init_type();
+  CullBinBackToFrontCoherent::init_type();
   CullBinFixed::init_type();
   CullBinFrontToBack::init_type();
   CullBinStateSorted::init_type();
@@ -64,4 +74,6 @@ init_libcull() {
                                  CullBinFrontToBack::make_bin);
   bin_manager->register_bin_type(CullBinManager::BT_fixed,
                                  CullBinFixed::make_bin);
+  bin_manager->register_bin_type(CullBinManager::BT_back_to_front_coherent,
+                                 CullBinBackToFrontCoherent::make_bin);
 }
@@ -26,6 +26,8 @@ class DSearchPath;
 ConfigureDecl(config_cull, EXPCL_PANDA_CULL, EXPTP_PANDA_CULL);
 NotifyCategoryDecl(cull, EXPCL_PANDA_CULL, EXPTP_PANDA_CULL);
 
+extern ConfigVariableBool cull_bin_radix_sort;
+
 extern EXPCL_PANDA_CULL void init_libcull();
 
 #endif
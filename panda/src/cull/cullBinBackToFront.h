@@ -21,6 +21,7 @@
 #include "transformState.h"
 #include "renderState.h"
 #include "pointerTo.h"
+#include "radixSort.h"
 
 /**
  * A specific kind of CullBin that sorts geometry in order from furthest to
@@ -55,6 +56,7 @@ private:
 
     CullableObject *_object;
     PN_stdfloat _dist;
+    uint32_t _sort_key;
   };
 
   typedef pvector<ObjectData> Objects;
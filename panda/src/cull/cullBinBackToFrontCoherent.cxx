@@ -0,0 +1,205 @@
+/**
+ * PANDA 3D SOFTWARE
+ * Copyright (c) Carnegie Mellon University.  All rights reserved.
+ *
+ * All use of this software is subject to the terms of the revised BSD
+ * license.  You should have received a copy of this license along
+ * with this source code in a file named "LICENSE."
+ *
+ * @file cullBinBackToFrontCoherent.cxx
+ * @author djs3000
+ * @date 2026-10-16
+ */
+
+#include "cullBinBackToFrontCoherent.h"
+#include "graphicsStateGuardianBase.h"
+#include "geometricBoundingVolume.h"
+#include "cullableObject.h"
+#include "cullHandler.h"
+#include "pStatTimer.h"
+
+#include <algorithm>
+
+
+TypeHandle CullBinBackToFrontCoherent::_type_handle;
+
+/**
+ *
+ */
+CullBinBackToFrontCoherent::
+~CullBinBackToFrontCoherent() {
+  Objects::iterator oi;
+  for (oi = _objects.begin(); oi != _objects.end(); ++oi) {
+    CullableObject *object = (*oi)._object;
+    delete object;
+  }
+}
+
+/**
+ * Factory constructor for passing to the CullBinManager.
+ */
+CullBin *CullBinBackToFrontCoherent::
+make_bin(const std::string &name, GraphicsStateGuardianBase *gsg,
+         const PStatCollector &draw_region_pcollector) {
+  return new CullBinBackToFrontCoherent(name, gsg, draw_region_pcollector);
+}
+
+/**
+ * Returns a newly-allocated CullBin object that contains a copy of just the
+ * subset of the data from this CullBin object that is worth keeping around
+ * for next frame, which in this case is the order of the objects.
+ */
+PT(CullBin) CullBinBackToFrontCoherent::
+make_next() const {
+  return new CullBinBackToFrontCoherent(*this);
+}
+
+/**
+ * Adds a geom, along with its associated state, to the bin for rendering.
+ */
+void CullBinBackToFrontCoherent::
+add_object(CullableObject *object, Thread *current_thread) {
+  // Determine the center of the bounding volume.
+  CPT(BoundingVolume) volume = object->_geom->get_bounds(current_thread);
+  if (volume->is_empty()) {
+    delete object;
+    return;
+  }
+
+  const GeometricBoundingVolume *gbv = volume->as_geometric_bounding_volume();
+  nassertv(gbv != nullptr);
+
+  LPoint3 center = gbv->get_approx_center();
+  nassertv(object->_internal_transform != nullptr);
+  center = center * object->_internal_transform->get_mat();
+
+  PN_stdfloat distance = _gsg->compute_distance_to(center);
+  _objects.push_back(ObjectData(object, distance));
+}
+
+/**
+ * Called after all the geoms have been added, this indicates that the cull
+ * process is finished for this frame and gives the bins a chance to do any
+ * post-processing (like sorting) before moving on to draw.
+ */
+void CullBinBackToFrontCoherent::
+finish_cull(SceneSetup *, Thread *current_thread) {
+  PStatTimer timer(_cull_this_pcollector, current_thread);
+
+  // Identify each object, and look up where it was in last frame's order.
+  // Those that were there are put back in that order; the rest are set aside.
+  typedef SimpleHashMap<const Geom *, uint32_t, pointer_hash> Occurrences;
+  Occurrences occurrences;
+
+  static const size_t not_found = (size_t)-1;
+  pvector<size_t> by_rank(_ranks.get_num_entries(), not_found);
+  Objects new_objects;
+
+  size_t num_objects = _objects.size();
+  for (size_t i = 0; i < num_objects; ++i) {
+    ObjectData &data = _objects[i];
+    const Geom *geom = data._object->_geom;
+    int oi = occurrences.find(geom);
+    if (oi < 0) {
+      occurrences.store(geom, 1);
+      data._key._occurrence = 0;
+    } else {
+      data._key._occurrence = occurrences.modify_data(oi)++;
+    }
+    data._key._geom = geom;
+
+    int ri = _ranks.find(data._key);
+    if (ri >= 0) {
+      by_rank[_ranks.get_data(ri)] = i;
+    } else {
+      new_objects.push_back(data);
+    }
+  }
+
+  Objects sorted;
+  sorted.reserve(num_objects);
+  for (size_t i : by_rank) {
+    if (i != not_found) {
+      sorted.push_back(_objects[i]);
+    }
+  }
+
+  // Now repair the old order.  If it turns out to be too far off, as when
+  // the camera has turned around, we give up and sort it from scratch.
+  size_t num_old = sorted.size();
+  if (!insertion_sort(sorted, num_old * 4)) {
+    std::sort(sorted.begin(), sorted.end());
+  }
+
+  // The objects that weren't there last frame are sorted separately and
+  // merged in.
+  if (!new_objects.empty()) {
+    std::sort(new_objects.begin(), new_objects.end());
+    sorted.insert(sorted.end(), new_objects.begin(), new_objects.end());
+    std::inplace_merge(sorted.begin(), sorted.begin() + num_old, sorted.end());
+  }
+
+  _objects.swap(sorted);
+
+  // Remember the order for next frame.
+  _ranks.clear();
+  for (size_t i = 0; i < num_objects; ++i) {
+    _ranks.store(_objects[i]._key, (uint32_t)i);
+  }
+}
+
+/**
+ * Draws all the geoms in the bin, in the appropriate order.
+ */
+void CullBinBackToFrontCoherent::
+draw(bool force, Thread *current_thread) {
+  PStatTimer timer(_draw_this_pcollector, current_thread);
+
+  for (const ObjectData &data : _objects) {
+    data._object->draw(_gsg, force, current_thread);
+  }
+}
+
+/**
+ * Called by CullBin::make_result_graph() to add all the geoms to the special
+ * cull result scene graph.
+ */
+void CullBinBackToFrontCoherent::
+fill_result_graph(CullBin::ResultGraphBuilder &builder) {
+  Objects::const_iterator oi;
+  for (oi = _objects.begin(); oi != _objects.end(); ++oi) {
+    CullableObject *object = (*oi)._object;
+    builder.add_object(object);
+  }
+}
+
+/**
+ * Sorts the objects with an insertion sort, which is very fast if they are
+ * already nearly in order.  Returns false if it had to move objects more
+ * than max_moves places in total, in which case it stops early, leaving the
+ * objects only partially sorted.
+ */
+bool CullBinBackToFrontCoherent::
+insertion_sort(Objects &objects, size_t max_moves) {
+  size_t num_moves = 0;
+  size_t num_objects = objects.size();
+  for (size_t i = 1; i < num_objects; ++i) {
+    if (!(objects[i] < objects[i - 1])) {
+      continue;
+    }
+
+    ObjectData data = objects[i];
+    size_t j = i;
+    do {
+      objects[j] = objects[j - 1];
+      --j;
+    } while (j > 0 && data < objects[j - 1]);
+    objects[j] = data;
+
+    num_moves += i - j;
+    if (num_moves > max_moves) {
+      return false;
+    }
+  }
+  return true;
+}
@@ -0,0 +1,113 @@
+/**
+ * PANDA 3D SOFTWARE
+ * Copyright (c) Carnegie Mellon University.  All rights reserved.
+ *
+ * All use of this software is subject to the terms of the revised BSD
+ * license.  You should have received a copy of this license along
+ * with this source code in a file named "LICENSE."
+ *
+ * @file cullBinBackToFrontCoherent.h
+ * @author djs3000
+ * @date 2026-10-16
+ */
+
+#ifndef CULLBINBACKTOFRONTCOHERENT_H
+#define CULLBINBACKTOFRONTCOHERENT_H
+
+#include "pandabase.h"
+
+#include "cullBin.h"
+#include "geom.h"
+#include "pointerTo.h"
+#include "pvector.h"
+#include "simpleHashMap.h"
+
+/**
+ * A variant of CullBinBackToFront that takes advantage of the fact that the
+ * order of the objects usually changes very little from one frame to the
+ * next.  Instead of sorting from scratch, it starts from the order of the
+ * previous frame and repairs it with an insertion sort, which takes close to
+ * linear time when only a few objects have swapped places.  This is most
+ * useful for large bins of transparent particles or foliage.
+ *
+ * Objects are matched up with those of the previous frame by their Geom;
+ * objects that share a Geom are told apart by the order in which they are
+ * encountered in the cull traversal.
+ */
+class EXPCL_PANDA_CULL CullBinBackToFrontCoherent : public CullBin {
+public:
+  INLINE CullBinBackToFrontCoherent(const std::string &name,
+                                    GraphicsStateGuardianBase *gsg,
+                                    const PStatCollector &draw_region_pcollector);
+  INLINE CullBinBackToFrontCoherent(const CullBinBackToFrontCoherent &copy);
+  virtual ~CullBinBackToFrontCoherent();
+
+  static CullBin *make_bin(const std::string &name,
+                           GraphicsStateGuardianBase *gsg,
+                           const PStatCollector &draw_region_pcollector);
+  virtual PT(CullBin) make_next() const;
+
+  virtual void add_object(CullableObject *object, Thread *current_thread);
+  virtual void finish_cull(SceneSetup *scene_setup, Thread *current_thread);
+  virtual void draw(bool force, Thread *current_thread);
+
+protected:
+  virtual void fill_result_graph(ResultGraphBuilder &builder);
+
+private:
+  class ObjectKey {
+  public:
+    INLINE bool operator < (const ObjectKey &other) const;
+    INLINE size_t get_hash() const;
+    INLINE void output(std::ostream &out) const;
+
+    const Geom *_geom;
+    uint32_t _occurrence;
+
+    friend std::ostream &operator << (std::ostream &out, const ObjectKey &key) {
+      key.output(out);
+      return out;
+    }
+  };
+
+  class ObjectData {
+  public:
+    INLINE ObjectData(CullableObject *object, PN_stdfloat dist);
+    INLINE bool operator < (const ObjectData &other) const;
+
+    CullableObject *_object;
+    PN_stdfloat _dist;
+    ObjectKey _key;
+  };
+
+  typedef pvector<ObjectData> Objects;
+  static bool insertion_sort(Objects &objects, size_t max_moves);
+
+  Objects _objects;
+
+  // The position of each object in the sorted order of the previous frame,
+  // and then of this frame, once finish_cull() has been called.
+  typedef SimpleHashMap<ObjectKey, uint32_t, method_hash<ObjectKey, std::less<ObjectKey> > > Ranks;
+  Ranks _ranks;
+
+public:
+  static TypeHandle get_class_type() {
+    return _type_handle;
+  }
+  static void init_type() {
+    CullBin::init_type();
+    register_type(_type_handle, "CullBinBackToFrontCoherent",
+                  CullBin::get_class_type());
+  }
+  virtual TypeHandle get_type() const {
+    return get_class_type();
+  }
+  virtual TypeHandle force_init_type() {init_type(); return get_class_type();}
+
+private:
+  static TypeHandle _type_handle;
+};
+
+#include "cullBinBackToFrontCoherent.I"
+
+#endif
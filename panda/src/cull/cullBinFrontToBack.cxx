@@ -17,6 +17,7 @@
 #include "cullableObject.h"
 #include "cullHandler.h"
 #include "pStatTimer.h"
+#include "config_cull.h"
 
 #include <algorithm>
 
@@ -75,7 +76,13 @@ add_object(CullableObject *object, Thread *current_thread) {
 void CullBinFrontToBack::
 finish_cull(SceneSetup *, Thread *current_thread) {
   PStatTimer timer(_cull_this_pcollector, current_thread);
-  sort(_objects.begin(), _objects.end());
+  if (cull_bin_radix_sort && _objects.size() >= 64) {
+    // The sort keys are made to sort in the same order as operator <.
+    Objects scratch;
+    radix_sort(_objects, scratch, &ObjectData::_sort_key);
+  } else {
+    sort(_objects.begin(), _objects.end());
+  }
 }
 
 /**
@@ -22,6 +22,7 @@
 #include "transformState.h"
 #include "renderState.h"
 #include "pointerTo.h"
+#include "pvector.h"
 
 /**
  * A specific kind of CullBin that sorts geometry to collect items of the same
@@ -58,8 +59,11 @@ private:
 
     CullableObject *_object;
     const GeomVertexFormat *_format;
+    uint64_t _sort_key;
   };
 
+  void radix_sort_objects();
+
   typedef pvector<ObjectData> Objects;
   Objects _objects;
 
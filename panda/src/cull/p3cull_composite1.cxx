@@ -1,4 +1,5 @@
 #include "binCullHandler.cxx"
 #include "config_cull.cxx"
 #include "cullBinBackToFront.cxx"
+#include "cullBinBackToFrontCoherent.cxx"
 #include "cullBinFixed.cxx"
@@ -0,0 +1,45 @@
+/**
+ * PANDA 3D SOFTWARE
+ * Copyright (c) Carnegie Mellon University.  All rights reserved.
+ *
+ * All use of this software is subject to the terms of the revised BSD
+ * license.  You should have received a copy of this license along
+ * with this source code in a file named "LICENSE."
+ *
+ * @file radixSort.h
+ * @author djs3000
+ * @date 2026-10-16
+ */
+
+#ifndef RADIXSORT_H
+#define RADIXSORT_H
+
+#include "pandabase.h"
+#include "pvector.h"
+
+/**
+ * Sorts the elements in ascending order of the unsigned integer key stored
+ * in the indicated member of each element, using a least-significant-digit
+ * radix sort.  This takes linear time, and is stable, so elements with the
+ * same key keep their original order.
+ *
+ * The scratch vector is used as temporary storage; its contents are
+ * undefined afterwards.  It may be kept around to avoid allocating it again.
+ */
+template<class Element, class Key>
+INLINE void
+radix_sort(pvector<Element> &elements, pvector<Element> &scratch,
+           Key Element::*key);
+
+/**
+ * Returns an unsigned integer that sorts in the same order as the given
+ * floating-point value, for use as a radix sort key.  Double-precision
+ * values lose some precision on the way in, which does not matter much for
+ * sorting objects by distance.
+ */
+INLINE uint32_t
+radix_sort_float_key(float value);
+
+#include "radixSort.I"
+
+#endif
@@ -0,0 +1,147 @@
+/**
+ * PANDA 3D SOFTWARE
+ * Copyright (c) Carnegie Mellon University.  All rights reserved.
+ *
+ * All use of this software is subject to the terms of the revised BSD
+ * license.  You should have received a copy of this license along
+ * with this source code in a file named "LICENSE."
+ *
+ * @file test_cull_bin_sort.cxx
+ * @author djs3000
+ * @date 2026-10-16
+ */
+
+#include "pandabase.h"
+#include "config_cull.h"
+#include "cullBinStateSorted.h"
+#include "cullableObject.h"
+#include "radixSort.h"
+#include "renderState.h"
+#include "transformState.h"
+#include "colorAttrib.h"
+#include "textureAttrib.h"
+#include "transparencyAttrib.h"
+#include "texture.h"
+#include "pStatCollector.h"
+#include "randomizer.h"
+#include "trueClock.h"
+#include "pvector.h"
+
+#include <algorithm>
+
+// This compares the time taken to sort large cull bins with std::sort and
+// with a radix sort on precomputed keys.  The state-sorted case goes through
+// a real CullBinStateSorted; the depth-sorted case sorts an array set up the
+// same way as the one in CullBinBackToFront, since that bin needs a GSG to
+// compute the distances.
+
+static const int num_objects = 20000;
+static const int num_states = 500;
+static const int num_iterations = 50;
+
+static pvector<CPT(RenderState)> states;
+
+static double
+time_state_sorted(bool radix) {
+  cull_bin_radix_sort.set_value(radix);
+
+  TrueClock *clock = TrueClock::get_global_ptr();
+  Thread *current_thread = Thread::get_current_thread();
+  PStatCollector draw_pcollector("Draw");
+  CPT(TransformState) transform = TransformState::make_identity();
+
+  double total = 0.0;
+  for (int n = 0; n < num_iterations; ++n) {
+    CullBinStateSorted bin("bin", nullptr, draw_pcollector);
+    Randomizer random(n);
+    for (int i = 0; i < num_objects; ++i) {
+      const RenderState *state = states[random.random_int(num_states)];
+      bin.add_object(new CullableObject(nullptr, state, transform), current_thread);
+    }
+
+    double start = clock->get_short_time();
+    bin.finish_cull(nullptr, current_thread);
+    total += clock->get_short_time() - start;
+  }
+  return total;
+}
+
+class DepthData {
+public:
+  bool operator < (const DepthData &other) const {
+    return _dist > other._dist;
+  }
+
+  void *_object;
+  PN_stdfloat _dist;
+  uint32_t _sort_key;
+};
+
+static double
+time_back_to_front(bool radix, int &num_misordered) {
+  TrueClock *clock = TrueClock::get_global_ptr();
+
+  double total = 0.0;
+  num_misordered = 0;
+  for (int n = 0; n < num_iterations; ++n) {
+    pvector<DepthData> objects(num_objects);
+    Randomizer random(n);
+    for (DepthData &data : objects) {
+      data._object = nullptr;
+      data._dist = random.random_real(1000.0) - 10.0;
+      data._sort_key = ~radix_sort_float_key(data._dist);
+    }
+
+    double start = clock->get_short_time();
+    if (radix) {
+      pvector<DepthData> scratch;
+      radix_sort(objects, scratch, &DepthData::_sort_key);
+    } else {
+      std::sort(objects.begin(), objects.end());
+    }
+    total += clock->get_short_time() - start;
+
+    for (size_t i = 1; i < objects.size(); ++i) {
+      if (objects[i]._dist > objects[i - 1]._dist) {
+        ++num_misordered;
+      }
+    }
+  }
+  return total;
+}
+
+int
+main(int argc, char *argv[]) {
+  // Make up a pool of states that differ in their textures, colors and
+  // transparency, like a typical scene would.
+  Randomizer random(42);
+  pvector<PT(Texture)> textures;
+  for (int i = 0; i < num_states / 10; ++i) {
+    textures.push_back(new Texture("tex"));
+  }
+  for (int i = 0; i < num_states; ++i) {
+    states.push_back(RenderState::make(
+      TextureAttrib::make(textures[random.random_int(textures.size())]),
+      ColorAttrib::make_flat(LColor(random.random_real(1), 0, 0, 1)),
+      TransparencyAttrib::make(random.random_int(2) ? TransparencyAttrib::M_alpha : TransparencyAttrib::M_none)));
+  }
+
+  double sorted_time = time_state_sorted(false);
+  double radix_time = time_state_sorted(true);
+
+  int misordered_sorted, misordered_radix;
+  double depth_sorted_time = time_back_to_front(false, misordered_sorted);
+  double depth_radix_time = time_back_to_front(true, misordered_radix);
+
+  double scale = 1000.0 / num_iterations;
+  nout << num_objects << " objects, " << num_states << " states\n"
+       << "state sorted, std::sort:    " << sorted_time * scale << " ms\n"
+       << "state sorted, radix:        " << radix_time * scale << " ms ("
+       << sorted_time / radix_time << "x)\n"
+       << "back to front, std::sort:   " << depth_sorted_time * scale << " ms\n"
+       << "back to front, radix:       " << depth_radix_time * scale << " ms ("
+       << depth_sorted_time / depth_radix_time << "x)\n"
+       << misordered_sorted + misordered_radix << " misordered objects\n";
+
+  return (misordered_sorted + misordered_radix == 0) ? 0 : 1;
+}
@@ -38,6 +38,7 @@
 #include "pipeline.h"
 #include "throw_event.h"
 #include "bamCache.h"
+#include "textureStreamer.h"
 #include "cullableObject.h"
 #include "geomVertexArrayData.h"
 #include "vertexDataSaveFile.h"
@@ -94,6 +95,8 @@ PStatCollector GraphicsEngine::_vertex_data_resident_pcollector("Vertex Data:Res
 PStatCollector GraphicsEngine::_vertex_data_compressed_pcollector("Vertex Data:Compressed");
 PStatCollector GraphicsEngine::_vertex_data_unused_disk_pcollector("Vertex Data:Disk:Unused");
 PStatCollector GraphicsEngine::_vertex_data_used_disk_pcollector("Vertex Data:Disk:Used");
+PStatCollector GraphicsEngine::_vertex_data_free_pcollector("Vertex Data:Free");
+PStatCollector GraphicsEngine::_vertex_data_wasted_pcollector("Vertex Data:Free:Fragmented");
 
 // These are counted independently by the collision system; we redefine them
 // here so we can reset them at each frame.
@@ -793,6 +796,10 @@ render_frame() {
       _loaded_textures.clear();
     }
 
+    // Choose the resolution of the streamed textures, based on how large
+    // they appeared in the frame that was just culled.
+    TextureStreamer::update_global();
+
     // Now it's time to do any drawing from the main frame--after all of the
     // App code has executed, but before we begin the next frame.
     _app.do_frame(this, current_thread);
@@ -852,6 +859,9 @@ render_frame() {
     CullTraverser::_geom_nodes_pcollector.clear_level();
     CullTraverser::_pgui_nodes_pcollector.clear_level();
     CullTraverser::_geoms_pcollector.clear_level();
+    CullTraverser::_nodes_occluded_pcollector.clear_level();
+    CullTraverser::_instances_pcollector.clear_level();
+    CullTraverser::_instances_visible_pcollector.clear_level();
     GeomCacheManager::_geom_cache_active_pcollector.clear_level();
     GeomCacheManager::_geom_cache_record_pcollector.clear_level();
     GeomCacheManager::_geom_cache_erase_pcollector.clear_level();
@@ -911,6 +921,10 @@ render_frame() {
       _vertex_data_compressed_pcollector.set_level(compressed);
       _vertex_data_unused_disk_pcollector.set_level(total_disk - used_disk);
       _vertex_data_used_disk_pcollector.set_level(used_disk);
+
+      VertexDataBook &book = GeomVertexArrayData::get_book();
+      _vertex_data_free_pcollector.set_level(book.count_free_size());
+      _vertex_data_wasted_pcollector.set_level(book.count_wasted_size());
     }
 
 #endif  // DO_PSTATS
@@ -381,6 +381,8 @@ private:
   static PStatCollector _vertex_data_resident_pcollector;
   static PStatCollector _vertex_data_compressed_pcollector;
   static PStatCollector _vertex_data_used_disk_pcollector;
+  static PStatCollector _vertex_data_free_pcollector;
+  static PStatCollector _vertex_data_wasted_pcollector;
   static PStatCollector _vertex_data_unused_disk_pcollector;
 
   static PStatCollector _cnode_volume_pcollector;
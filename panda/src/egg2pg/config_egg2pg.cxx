@@ -74,6 +74,14 @@ ConfigVariableBool egg_combine_geoms
           "when possible.  This usually shouldn't be necessary, since the "
           "egg loader does a pretty good job of combining these by itself."));
 
+ConfigVariableBool egg_compact_vertices
+("egg-compact-vertices", false,
+ PRC_DESC("Set this true to store the normals and texture coordinates of "
+          "the loaded vertices in a compact format: octahedron-packed "
+          "normals and half-precision texture coordinates.  This saves "
+          "vertex memory and bandwidth, at a small cost in precision.  The "
+          "vertex positions are not changed."));
+
 ConfigVariableBool egg_rigid_geometry
 ("egg-rigid-geometry", false,
  PRC_DESC("Set this true to create rigid pieces of an animated character as "
@@ -201,6 +209,15 @@ ConfigVariableBool egg_force_srgb_textures
           "their envtype is set to a non-color map.  Keep in mind that the "
           "model-cache must be cleared after changing this setting."));
 
+ConfigVariableInt egg_collision_mesh_threshold
+("egg-collision-mesh-threshold", 0,
+ PRC_DESC("If this is positive, then a <Collide> group of type polyset with "
+          "at least this many polygons is loaded as a single CollisionMesh, "
+          "which organizes its triangles in a bounding volume hierarchy, "
+          "instead of as one CollisionPolygon per polygon.  This is much "
+          "faster to collide with for large groups.  Keep in mind that the "
+          "model-cache must be cleared after changing this setting."));
+
 ConfigureFn(config_egg2pg) {
   init_libegg2pg();
 }
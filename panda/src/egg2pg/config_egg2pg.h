@@ -39,6 +39,7 @@ extern EXPCL_PANDA_EGG2PG ConfigVariableBool egg_flatten;
 extern EXPCL_PANDA_EGG2PG ConfigVariableDouble egg_flatten_radius;
 extern EXPCL_PANDA_EGG2PG ConfigVariableBool egg_unify;
 extern EXPCL_PANDA_EGG2PG ConfigVariableBool egg_combine_geoms;
+extern EXPCL_PANDA_EGG2PG ConfigVariableBool egg_compact_vertices;
 extern EXPCL_PANDA_EGG2PG ConfigVariableBool egg_rigid_geometry;
 extern EXPCL_PANDA_EGG2PG ConfigVariableBool egg_flat_shading;
 extern EXPCL_PANDA_EGG2PG ConfigVariableBool egg_flat_colors;
@@ -55,6 +56,7 @@ extern EXPCL_PANDA_EGG2PG ConfigVariableDouble egg_vertex_membership_quantize;
 extern EXPCL_PANDA_EGG2PG ConfigVariableInt egg_vertex_max_num_joints;
 extern EXPCL_PANDA_EGG2PG ConfigVariableBool egg_implicit_alpha_binary;
 extern EXPCL_PANDA_EGG2PG ConfigVariableBool egg_force_srgb_textures;
+extern EXPCL_PANDA_EGG2PG ConfigVariableInt egg_collision_mesh_threshold;
 
 extern EXPCL_PANDA_EGG2PG void init_libegg2pg();
 
@@ -78,6 +78,7 @@
 #include "collisionPlane.h"
 #include "collisionPolygon.h"
 #include "collisionFloorMesh.h"
+#include "collisionMesh.h"
 #include "collisionBox.h"
 #include "parametricCurve.h"
 #include "nurbsCurve.h"
@@ -3050,6 +3051,22 @@ make_collision_polyset(EggGroup *egg_group, CollisionNode *cnode,
                        EggGroup::CollideFlags flags) {
   EggGroup *geom_group = find_collision_geometry(egg_group, flags);
   if (geom_group != nullptr) {
+    if (egg_collision_mesh_threshold > 0) {
+      // If there are enough polygons, make one CollisionMesh out of all of
+      // them instead.
+      int num_polygons = 0;
+      EggGroup::const_iterator ci;
+      for (ci = geom_group->begin(); ci != geom_group->end(); ++ci) {
+        if ((*ci)->is_of_type(EggPrimitive::get_class_type())) {
+          ++num_polygons;
+        }
+      }
+      if (num_polygons >= egg_collision_mesh_threshold) {
+        create_collision_mesh(cnode, geom_group, flags);
+        return;
+      }
+    }
+
     EggGroup::const_iterator ci;
     for (ci = geom_group->begin(); ci != geom_group->end(); ++ci) {
       if ((*ci)->is_of_type(EggPolygon::get_class_type())) {
@@ -3570,6 +3587,75 @@ create_collision_floor_mesh(CollisionNode *cnode,
 }
 
 
+/**
+ * Creates a single CollisionMesh from all of the polygons in the indicated
+ * group, and adds it to the indicated CollisionNode.
+ */
+void EggLoader::
+create_collision_mesh(CollisionNode *cnode, EggGroup *parent_group,
+                      EggGroup::CollideFlags flags) {
+  PT(EggGroup) group = new EggGroup;
+  EggGroup::const_iterator egi;
+  for (egi = parent_group->begin(); egi != parent_group->end(); ++egi) {
+    if ((*egi)->is_of_type(EggPolygon::get_class_type())) {
+      EggPolygon *poly = DCAST(EggPolygon, *egi);
+      if (!poly->triangulate_into(group, false)) {
+        egg2pg_cat.info()
+          << "Ignoring degenerate collision polygon in "
+          << parent_group->get_name()
+          << "\n";
+      }
+    } else if ((*egi)->is_of_type(EggCompositePrimitive::get_class_type())) {
+      EggCompositePrimitive *comp = DCAST(EggCompositePrimitive, *egi);
+      comp->triangulate_into(group);
+    }
+  }
+
+  // Share the vertices that have the same position between triangles.
+  PT(CollisionMesh) csmesh = new CollisionMesh;
+  pmap<LVertexd, int> indices;
+
+  EggGroup::const_iterator ci;
+  for (ci = group->begin(); ci != group->end(); ++ci) {
+    EggPolygon *poly = DCAST(EggPolygon, *ci);
+    size_t num_vertices = poly->size();
+    if (num_vertices < 3) {
+      continue;
+    }
+
+    pvector<int> poly_indices;
+    poly_indices.reserve(num_vertices);
+    EggPolygon::const_iterator vi;
+    for (vi = poly->begin(); vi != poly->end(); ++vi) {
+      LVertexd vert = (*vi)->get_pos3();
+      auto result = indices.insert(std::make_pair(vert, 0));
+      if (result.second) {
+        (*result.first).second = csmesh->add_vertex(LCAST(PN_stdfloat, vert));
+      }
+      poly_indices.push_back((*result.first).second);
+    }
+
+    for (size_t i = 2; i < num_vertices; ++i) {
+      int a = poly_indices[0];
+      int b = poly_indices[i - 1];
+      int c = poly_indices[i];
+      if (a != b && b != c && c != a) {
+        csmesh->add_triangle(a, b, c);
+      }
+    }
+  }
+
+  if (csmesh->get_num_triangles() == 0) {
+    egg2pg_cat.info()
+      << "empty collision solid\n";
+    return;
+  }
+
+  apply_collision_flags(csmesh, flags);
+  csmesh->xform(cnode->get_transform()->get_mat());
+  cnode->add_solid(csmesh);
+}
+
 /**
  * Walks back over the tree and applies the DeferredNodeProperties that were
  * saved up along the way.
@@ -199,6 +199,8 @@ private:
   void create_collision_floor_mesh(CollisionNode *cnode,
                                  EggGroup *parent_group,
                                  EggGroup::CollideFlags flags);
+  void create_collision_mesh(CollisionNode *cnode, EggGroup *parent_group,
+                             EggGroup::CollideFlags flags);
 
   void apply_deferred_nodes(PandaNode *node, const DeferredNodeProperty &prop);
   bool expand_all_object_types(EggNode *egg_node);
@@ -60,6 +60,11 @@ load_from_loader(EggLoader &loader) {
     }
   }
 
+  if (loader._root != nullptr && egg_compact_vertices) {
+    SceneGraphReducer gr;
+    gr.compact_vertices(loader._root, SceneGraphReducer::CV_attributes);
+  }
+
   return loader._root;
 }
 
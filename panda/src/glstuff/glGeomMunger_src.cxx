@@ -129,6 +129,23 @@ munge_format_impl(const GeomVertexFormat *orig,
       array_format->add_column(column->get_name(), 3, NT_float32,
                                column->get_contents(), column->get_start(),
                                column->get_column_alignment());
+
+    } else if (column->get_numeric_type() == NT_packed_oct16) {
+      // OpenGL has no octahedral normals; unpack to three half floats, or
+      // full floats if those are not supported either.  These are larger
+      // than the original, so they go at the end.
+      PT(GeomVertexArrayFormat) array_format = new_format->modify_array(array);
+      array_format->remove_column(column->get_name());
+      array_format->add_column(column->get_name(), 3,
+                               glgsg->_supports_vertex_half_float ? NT_float16 : NT_float32,
+                               C_normal);
+
+    } else if (column->get_numeric_type() == NT_float16 &&
+               !glgsg->_supports_vertex_half_float) {
+      PT(GeomVertexArrayFormat) array_format = new_format->modify_array(array);
+      array_format->remove_column(column->get_name());
+      array_format->add_column(column->get_name(), column->get_num_components(),
+                               NT_float32, column->get_contents());
     }
 #ifdef OPENGLES
     else if (column->get_numeric_type() == NT_float64) {
@@ -333,6 +350,23 @@ premunge_format_impl(const GeomVertexFormat *orig) {
       array_format->add_column(column->get_name(), 3, NT_float32,
                                column->get_contents(), column->get_start(),
                                column->get_column_alignment());
+
+    } else if (column->get_numeric_type() == NT_packed_oct16) {
+      // OpenGL has no octahedral normals; unpack to three half floats, or
+      // full floats if those are not supported either.  These are larger
+      // than the original, so they go at the end.
+      PT(GeomVertexArrayFormat) array_format = new_format->modify_array(array);
+      array_format->remove_column(column->get_name());
+      array_format->add_column(column->get_name(), 3,
+                               glgsg->_supports_vertex_half_float ? NT_float16 : NT_float32,
+                               C_normal);
+
+    } else if (column->get_numeric_type() == NT_float16 &&
+               !glgsg->_supports_vertex_half_float) {
+      PT(GeomVertexArrayFormat) array_format = new_format->modify_array(array);
+      array_format->remove_column(column->get_name());
+      array_format->add_column(column->get_name(), column->get_num_components(),
+                               NT_float32, column->get_contents());
     }
 #ifdef OPENGLES
     else if (column->get_numeric_type() == NT_float64) {
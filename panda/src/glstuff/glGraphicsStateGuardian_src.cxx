@@ -1374,6 +1374,11 @@ reset() {
 #ifdef OPENGLES
   _supports_packed_dabc = false;
   _supports_packed_ufloat = false;
+#ifdef OPENGLES_1
+  _supports_vertex_half_float = false;
+#else
+  _supports_vertex_half_float = is_at_least_gles_version(3, 0);
+#endif
 #else
   _supports_packed_dabc = (is_at_least_gl_version(3, 2) ||
                           has_extension("GL_ARB_vertex_array_bgra") ||
@@ -1382,6 +1387,9 @@ reset() {
   _supports_packed_ufloat = is_at_least_gl_version(4, 4) ||
                             has_extension("GL_ARB_vertex_type_10f_11f_11f_rev");
 
+  _supports_vertex_half_float = is_at_least_gl_version(3, 0) ||
+                                has_extension("GL_ARB_half_float_vertex");
+
   if (_supports_packed_dabc) {
     int number = 0;
     if (_gl_renderer.compare(0, 14, "AMD Radeon RX ") == 0) {
@@ -9637,6 +9645,17 @@ get_numeric_type(Geom::NumericType numeric_type) {
 #else
     break;
 #endif
+
+  case Geom::NT_float16:
+#ifndef OPENGLES_1
+    return GL_HALF_FLOAT;
+#else
+    break;
+#endif
+
+  case Geom::NT_packed_oct16:
+    // Must be unpacked by the munger.
+    break;
   }
 
   GLCAT.error()
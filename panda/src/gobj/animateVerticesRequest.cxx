@@ -23,6 +23,10 @@ AsyncTask::DoneStatus AnimateVerticesRequest::
 do_task() {
   Thread *current_thread = Thread::get_current_thread();
 
+  // Compute the animation for the stage that asked for it, which need not be
+  // the stage this thread is on.  The cached result is per stage.
+  current_thread->set_pipeline_stage(_pipeline_stage);
+
   // There is no need to store or return a result.  The GeomVertexData caches
   // the result and it will be used later in the rendering process.
   _geom_vertex_data->animate_vertices(true, current_thread);
@@ -44,6 +44,7 @@ protected:
 
 private:
   PT(GeomVertexData) _geom_vertex_data;
+  int _pipeline_stage;
 
 public:
   static TypeHandle get_class_type() {
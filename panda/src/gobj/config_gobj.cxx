@@ -127,10 +127,9 @@ ConfigVariableBool driver_compress_textures
           "or results by setting this true.  Setting it true may also "
           "allow you to take advantage of some exotic compression algorithm "
           "other than DXT1/3/5 that your graphics driver supports, but "
-          "which is unknown to Panda.  If the libsquish library is not "
-          "compiled into Panda, textures cannot be compressed in-memory, "
-          "and will always be handed to the graphics driver, regardless "
-          "of this setting."));
+          "which is unknown to Panda.  Panda compresses DXT1/3/5 and "
+          "RGTC textures itself; the libsquish library is used for DXT "
+          "compression instead, if it was compiled into Panda."));
 
 ConfigVariableBool driver_generate_mipmaps
 ("driver-generate-mipmaps", true,
@@ -300,6 +299,45 @@ ConfigVariableBool vertex_animation_align_16
           "impacts only vertex formats created within Panda subsystems; custom "
           "vertex formats are not affected."));
 
+ConfigVariableInt skinning_num_threads
+("skinning-num-threads", 0,
+ PRC_DESC("Set this to a nonzero value to split the CPU skinning of large "
+          "animated vertex tables across the indicated number of worker "
+          "threads, in addition to the thread that requests the animation.  "
+          "This has no effect if Panda was not compiled with true threading "
+          "support."));
+
+ConfigVariableInt skinning_parallel_min_vertices
+("skinning-parallel-min-vertices", 2048,
+ PRC_DESC("When skinning-num-threads is nonzero, vertex tables with fewer "
+          "than this number of vertices are skinned on the requesting "
+          "thread only, since the overhead of dispatching the work would "
+          "outweigh the benefit."));
+
+ConfigVariableInt texture_process_threads
+("texture-process-threads", 0,
+ PRC_DESC("Set this to a nonzero value to split the in-memory compression "
+          "and mipmap generation of large texture images across the "
+          "indicated number of worker threads, in addition to the thread "
+          "that requests it.  Mipmap levels, cube map faces, array layers "
+          "and horizontal strips of each image are processed in parallel.  "
+          "This has no effect if Panda was not compiled with true threading "
+          "support."));
+
+ConfigVariableInt texture_parallel_min_pixels
+("texture-parallel-min-pixels", 65536,
+ PRC_DESC("When texture-process-threads is nonzero, texture images with "
+          "fewer than this number of pixels, summed over all pages and "
+          "mipmap levels, are processed on the requesting thread only."));
+
+ConfigVariableBool texture_streaming
+("texture-streaming", false,
+ PRC_DESC("Set this true to load mipmapped textures initially with only "
+          "their smallest mipmap levels resident, and reload them at a "
+          "higher resolution in the background as they appear larger on "
+          "screen.  See TextureStreamer and the texture-stream-* "
+          "variables."));
+
 ConfigVariableBool vertex_colors_prefer_packed
 ("vertex-colors-prefer-packed",
 #ifdef _WIN32
@@ -479,6 +517,29 @@ ConfigVariableInt vertex_data_page_threads
           "is 0, this work will be done in the main thread, which may "
           "introduce occasional random chugs in rendering."));
 
+ConfigVariableBool vertex_data_size_classes
+("vertex-data-size-classes", true,
+ PRC_DESC("Set this true to round the size of each block of vertex data "
+          "that is paged into a VertexDataBook up to one of a fixed set of "
+          "size classes.  This wastes a little memory on each block, but "
+          "makes it much more likely that the gaps left by freed blocks can "
+          "be reused, which limits fragmentation over long sessions."));
+
+ConfigVariableInt vertex_data_defrag_bytes
+("vertex-data-defrag-bytes", 0,
+ PRC_DESC("Set this to a nonzero value to have the GraphicsEngine move up "
+          "to this many bytes of paged vertex data each frame, in order to "
+          "release sparsely used vertex pages and close the gaps within the "
+          "others.  This is done between frames, while the render threads "
+          "are idle; it must not be enabled if other threads may be reading "
+          "vertex data at that time."));
+
+ConfigVariableDouble vertex_data_evacuate_occupancy
+("vertex-data-evacuate-occupancy", 0.25,
+ PRC_DESC("When vertex data is defragmented, the blocks of the vertex pages "
+          "with less than this fraction of their bytes in use are moved "
+          "into other pages, so that the pages themselves can be freed."));
+
 ConfigVariableInt graphics_memory_limit
 ("graphics-memory-limit", -1,
  PRC_DESC("This is a default limit that is imposed on each GSG at "
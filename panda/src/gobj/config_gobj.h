@@ -55,6 +55,11 @@ extern EXPCL_PANDA_GOBJ ConfigVariableBool cache_generated_shaders;
 extern EXPCL_PANDA_GOBJ ConfigVariableBool vertices_float64;
 extern EXPCL_PANDA_GOBJ ConfigVariableInt vertex_column_alignment;
 extern EXPCL_PANDA_GOBJ ConfigVariableBool vertex_animation_align_16;
+extern EXPCL_PANDA_GOBJ ConfigVariableInt skinning_num_threads;
+extern EXPCL_PANDA_GOBJ ConfigVariableInt skinning_parallel_min_vertices;
+extern EXPCL_PANDA_GOBJ ConfigVariableInt texture_process_threads;
+extern EXPCL_PANDA_GOBJ ConfigVariableInt texture_parallel_min_pixels;
+extern EXPCL_PANDA_GOBJ ConfigVariableBool texture_streaming;
 extern EXPCL_PANDA_GOBJ ConfigVariableBool vertex_colors_prefer_packed;
 
 extern EXPCL_PANDA_GOBJ ConfigVariableEnum<AutoTextureScale> textures_power_2;
@@ -83,6 +88,9 @@ extern EXPCL_PANDA_GOBJ ConfigVariableFilename vertex_save_file_directory;
 extern EXPCL_PANDA_GOBJ ConfigVariableString vertex_save_file_prefix;
 extern EXPCL_PANDA_GOBJ ConfigVariableInt vertex_data_small_size;
 extern EXPCL_PANDA_GOBJ ConfigVariableInt vertex_data_page_threads;
+extern EXPCL_PANDA_GOBJ ConfigVariableBool vertex_data_size_classes;
+extern EXPCL_PANDA_GOBJ ConfigVariableInt vertex_data_defrag_bytes;
+extern EXPCL_PANDA_GOBJ ConfigVariableDouble vertex_data_evacuate_occupancy;
 extern EXPCL_PANDA_GOBJ ConfigVariableInt graphics_memory_limit;
 extern EXPCL_PANDA_GOBJ ConfigVariableInt sampler_object_limit;
 extern EXPCL_PANDA_GOBJ ConfigVariableDouble adaptive_lru_weight;
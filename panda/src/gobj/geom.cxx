@@ -13,6 +13,7 @@
 
 #include "geom.h"
 #include "geomPoints.h"
+#include "geomTriangles.h"
 #include "geomVertexReader.h"
 #include "geomVertexRewriter.h"
 #include "graphicsStateGuardianBase.h"
@@ -920,6 +921,73 @@ make_adjacency_in_place() {
   nassertv(all_is_valid);
 }
 
+/**
+ * Reorders the triangles of the GeomTriangles primitives within this Geom
+ * for better use of the post-transform vertex cache.  See
+ * GeomTriangles::optimize_vertex_cache().  Other kinds of primitives are
+ * left alone; you may want to call decompose_in_place() first.
+ *
+ * Don't call this in a downstream thread unless you don't mind it blowing
+ * away other changes you might have recently made in an upstream thread.
+ */
+void Geom::
+optimize_vertex_cache_in_place(int cache_size) {
+  Thread *current_thread = Thread::get_current_thread();
+  CDWriter cdata(_cycler, true, current_thread);
+
+  bool any_changed = false;
+  Primitives::iterator pi;
+  for (pi = cdata->_primitives.begin(); pi != cdata->_primitives.end(); ++pi) {
+    CPT(GeomPrimitive) prim = (*pi).get_read_pointer(current_thread);
+    if (prim->is_exact_type(GeomTriangles::get_class_type())) {
+      CPT(GeomPrimitive) new_prim = DCAST(GeomTriangles, prim)->optimize_vertex_cache(cache_size);
+      if (new_prim != prim) {
+        (*pi) = (GeomPrimitive *)new_prim.p();
+        any_changed = true;
+      }
+    }
+  }
+
+  if (any_changed) {
+    cdata->_modified = Geom::get_next_modified();
+    clear_cache_stage(current_thread);
+  }
+}
+
+/**
+ * Reorders clusters of triangles of the GeomTriangles primitives within this
+ * Geom to reduce overdraw.  See GeomTriangles::optimize_overdraw().  This
+ * should be called after optimize_vertex_cache_in_place().
+ *
+ * Don't call this in a downstream thread unless you don't mind it blowing
+ * away other changes you might have recently made in an upstream thread.
+ */
+void Geom::
+optimize_overdraw_in_place(PN_stdfloat threshold, int cache_size) {
+  Thread *current_thread = Thread::get_current_thread();
+  CDWriter cdata(_cycler, true, current_thread);
+
+  CPT(GeomVertexData) vertex_data = cdata->_data.get_read_pointer(current_thread);
+
+  bool any_changed = false;
+  Primitives::iterator pi;
+  for (pi = cdata->_primitives.begin(); pi != cdata->_primitives.end(); ++pi) {
+    CPT(GeomPrimitive) prim = (*pi).get_read_pointer(current_thread);
+    if (prim->is_exact_type(GeomTriangles::get_class_type())) {
+      CPT(GeomPrimitive) new_prim = DCAST(GeomTriangles, prim)->optimize_overdraw(vertex_data, threshold, cache_size);
+      if (new_prim != prim) {
+        (*pi) = (GeomPrimitive *)new_prim.p();
+        any_changed = true;
+      }
+    }
+  }
+
+  if (any_changed) {
+    cdata->_modified = Geom::get_next_modified();
+    clear_cache_stage(current_thread);
+  }
+}
+
 /**
  * Copies the primitives from the indicated Geom into this one.  This does
  * require that both Geoms contain the same fundamental type primitives, both
@@ -120,6 +120,9 @@ PUBLISHED:
   void make_lines_in_place();
   void make_patches_in_place();
   void make_adjacency_in_place();
+  void optimize_vertex_cache_in_place(int cache_size = 32);
+  void optimize_overdraw_in_place(PN_stdfloat threshold = 1.05f,
+                                  int cache_size = 32);
 
   virtual bool copy_primitives_from(const Geom *other);
 
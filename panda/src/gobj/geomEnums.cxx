@@ -113,6 +113,12 @@ operator << (ostream &out, GeomEnums::NumericType numeric_type) {
 
   case GeomEnums::NT_packed_ufloat:
     return out << "packed_ufloat";
+
+  case GeomEnums::NT_float16:
+    return out << "float16";
+
+  case GeomEnums::NT_packed_oct16:
+    return out << "packed_oct16";
   }
 
   return out << "**invalid numeric type (" << (int)numeric_type << ")**";
@@ -187,6 +187,8 @@ PUBLISHED:
     NT_int16,        // An integer -32768..32767
     NT_int32,        // An integer -2147483648..2147483647
     NT_packed_ufloat,// Three 10/11-bit float components packed in a uint32
+    NT_float16,      // A half-precision float
+    NT_packed_oct16, // A unit vector, octahedron-mapped to two int16 in a uint32
   };
 
   // The contents determine the semantic meaning of a numeric value within the
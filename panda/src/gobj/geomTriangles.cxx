@@ -18,6 +18,61 @@
 #include "bamWriter.h"
 #include "graphicsStateGuardianBase.h"
 #include "geomTrianglesAdjacency.h"
+#include "geomVertexReader.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <climits>
+#include <cmath>
+
+/**
+ * A symmetric 4x4 matrix representing the sum of the squared distances to a
+ * set of planes, used by GeomTriangles::simplify().
+ */
+class SimplifyQuadric {
+public:
+  SimplifyQuadric() {
+    _a00 = _a01 = _a02 = _a11 = _a12 = _a22 = 0.0;
+    _b0 = _b1 = _b2 = _c = 0.0;
+  }
+
+  SimplifyQuadric(const LVector3d &n, double d) {
+    _a00 = n[0] * n[0];
+    _a01 = n[0] * n[1];
+    _a02 = n[0] * n[2];
+    _a11 = n[1] * n[1];
+    _a12 = n[1] * n[2];
+    _a22 = n[2] * n[2];
+    _b0 = n[0] * d;
+    _b1 = n[1] * d;
+    _b2 = n[2] * d;
+    _c = d * d;
+  }
+
+  void operator += (const SimplifyQuadric &other) {
+    _a00 += other._a00;
+    _a01 += other._a01;
+    _a02 += other._a02;
+    _a11 += other._a11;
+    _a12 += other._a12;
+    _a22 += other._a22;
+    _b0 += other._b0;
+    _b1 += other._b1;
+    _b2 += other._b2;
+    _c += other._c;
+  }
+
+  double evaluate(const LPoint3d &p) const {
+    double x = p[0], y = p[1], z = p[2];
+    return _a00 * x * x + _a11 * y * y + _a22 * z * z
+      + 2.0 * (_a01 * x * y + _a02 * x * z + _a12 * y * z)
+      + 2.0 * (_b0 * x + _b1 * y + _b2 * z) + _c;
+  }
+
+private:
+  double _a00, _a01, _a02, _a11, _a12, _a22;
+  double _b0, _b1, _b2, _c;
+};
 
 using std::map;
 
@@ -153,6 +208,884 @@ get_num_vertices_per_primitive() const {
   return 3;
 }
 
+/**
+ * Returns a new primitive with the same triangles as this one, but
+ * reordered to make better use of the post-transform vertex cache on the
+ * graphics card, using Tom Forsyth's "linear-speed vertex cache
+ * optimisation" algorithm.  The cache is modeled as an LRU cache with the
+ * indicated number of entries; the result isn't very sensitive to the exact
+ * value, since the algorithm doesn't rely on the cache size being exact.
+ *
+ * The order of the vertices within each triangle is preserved, so the
+ * winding order and flat-shaded provoking vertex are not affected.  Returns
+ * this primitive unchanged if it is nonindexed, since there is no reuse to
+ * optimize in that case.
+ */
+CPT(GeomPrimitive) GeomTriangles::
+optimize_vertex_cache(int cache_size) const {
+  nassertr(cache_size > 3, this);
+  Thread *current_thread = Thread::get_current_thread();
+
+  pvector<int> indices;
+  int num_rows;
+  if (!get_triangle_indices(indices, num_rows, current_thread)) {
+    return this;
+  }
+  int num_triangles = (int)indices.size() / 3;
+
+  // Precompute the score tables.  A vertex scores higher if it is recently
+  // used, and if it has few triangles remaining, so that we don't leave lone
+  // triangles behind that will need to be picked up later.
+  static const int max_valence = 32;
+  pvector<float> cache_scores(cache_size);
+  for (int i = 0; i < cache_size; ++i) {
+    if (i < 3) {
+      // The vertices of the most recent triangle get a fixed score, so that
+      // we don't favor just using them again as part of a strip.
+      cache_scores[i] = 0.75f;
+    } else {
+      float scaler = 1.0f - (float)(i - 3) / (float)(cache_size - 3);
+      cache_scores[i] = std::pow(scaler, 1.5f);
+    }
+  }
+  float valence_scores[max_valence];
+  for (int i = 1; i < max_valence; ++i) {
+    valence_scores[i] = 2.0f / std::sqrt((float)i);
+  }
+  valence_scores[0] = 0.0f;
+
+  // Build the list of triangles that reference each vertex.  The triangles
+  // that haven't yet been emitted are kept at the front of each vertex's
+  // list.
+  pvector<int> remaining(num_rows, 0);
+  for (int index : indices) {
+    ++remaining[index];
+  }
+  pvector<int> offsets(num_rows + 1);
+  offsets[0] = 0;
+  for (int v = 0; v < num_rows; ++v) {
+    offsets[v + 1] = offsets[v] + remaining[v];
+  }
+  pvector<int> triangle_lists(indices.size());
+  {
+    pvector<int> fill(offsets);
+    for (size_t i = 0; i < indices.size(); ++i) {
+      triangle_lists[fill[indices[i]]++] = (int)(i / 3);
+    }
+  }
+
+  pvector<int> cache_pos(num_rows, -1);
+  pvector<bool> emitted(num_triangles, false);
+  pvector<int> cache, new_cache;
+  cache.reserve(cache_size + 3);
+  new_cache.reserve(cache_size + 3);
+
+  auto vertex_score = [&](int v) -> float {
+    int count = remaining[v];
+    if (count == 0) {
+      return -1.0f;
+    }
+    float score = (count < max_valence) ? valence_scores[count] : 2.0f / std::sqrt((float)count);
+    if (cache_pos[v] >= 0) {
+      score += cache_scores[cache_pos[v]];
+    }
+    return score;
+  };
+
+  pvector<int> result;
+  result.reserve(indices.size());
+
+  // We start with the first triangle, which is as good as any.
+  int best = 0;
+  int next_unemitted = 0;
+
+  for (int n = 0; n < num_triangles; ++n) {
+    if (best < 0) {
+      // None of the vertices in the cache have any triangles left.  Start
+      // over with the next triangle in the original order.
+      while (emitted[next_unemitted]) {
+        ++next_unemitted;
+      }
+      best = next_unemitted;
+    }
+
+    const int *tri = &indices[best * 3];
+    result.push_back(tri[0]);
+    result.push_back(tri[1]);
+    result.push_back(tri[2]);
+    emitted[best] = true;
+
+    // Remove the triangle from its vertices' lists of remaining triangles.
+    for (int k = 0; k < 3; ++k) {
+      int v = tri[k];
+      int *list = &triangle_lists[offsets[v]];
+      int count = remaining[v];
+      for (int i = 0; i < count; ++i) {
+        if (list[i] == best) {
+          std::swap(list[i], list[count - 1]);
+          break;
+        }
+      }
+      --remaining[v];
+    }
+
+    // Move the vertices to the front of the cache.
+    new_cache.clear();
+    for (int k = 0; k < 3; ++k) {
+      if (std::find(new_cache.begin(), new_cache.end(), tri[k]) == new_cache.end()) {
+        new_cache.push_back(tri[k]);
+      }
+    }
+    for (int v : cache) {
+      if (v != tri[0] && v != tri[1] && v != tri[2]) {
+        new_cache.push_back(v);
+      }
+    }
+    for (size_t i = cache_size; i < new_cache.size(); ++i) {
+      cache_pos[new_cache[i]] = -1;
+    }
+    if (new_cache.size() > (size_t)cache_size) {
+      new_cache.resize(cache_size);
+    }
+    cache.swap(new_cache);
+    for (size_t i = 0; i < cache.size(); ++i) {
+      cache_pos[cache[i]] = (int)i;
+    }
+
+    // Now choose the best of the remaining triangles that use any of the
+    // vertices in the cache.
+    best = -1;
+    float best_score = -1.0f;
+    for (int v : cache) {
+      const int *list = &triangle_lists[offsets[v]];
+      int count = remaining[v];
+      for (int i = 0; i < count; ++i) {
+        int t = list[i];
+        const int *other = &indices[t * 3];
+        float score = vertex_score(other[0]) + vertex_score(other[1]) + vertex_score(other[2]);
+        if (score > best_score) {
+          best_score = score;
+          best = t;
+        }
+      }
+    }
+  }
+
+  return make_with_indices(result);
+}
+
+/**
+ * Returns a new primitive with the same triangles as this one, but with
+ * clusters of triangles reordered so that those facing outward from the
+ * center of the mesh are drawn first, which tends to reduce overdraw since
+ * they are more likely to occlude the others.  This is the "Tipsify"
+ * approach described by Sander, Nehab and Barczak.
+ *
+ * This should be called on the result of optimize_vertex_cache().  The
+ * triangles are split into clusters at the points where the vertex cache
+ * would be flushed anyway, and further where this can be done without
+ * raising the ACMR above threshold times its original value, so that
+ * reordering the clusters doesn't undo the vertex cache optimization.
+ *
+ * Returns this primitive unchanged if it is nonindexed or if the vertex data
+ * has no vertex column.
+ */
+CPT(GeomPrimitive) GeomTriangles::
+optimize_overdraw(const GeomVertexData *vertex_data, PN_stdfloat threshold,
+                  int cache_size) const {
+  nassertr(vertex_data != nullptr && cache_size > 0, this);
+  Thread *current_thread = Thread::get_current_thread();
+
+  pvector<int> indices;
+  int num_rows;
+  if (!get_triangle_indices(indices, num_rows, current_thread)) {
+    return this;
+  }
+  int num_triangles = (int)indices.size() / 3;
+
+  GeomVertexReader vertex(vertex_data, InternalName::get_vertex(), current_thread);
+  if (!vertex.has_column() || num_rows > vertex_data->get_num_rows()) {
+    return this;
+  }
+
+  // We simulate a FIFO cache by recording the miss count at which each
+  // vertex was loaded.  Bumping the miss count by the cache size flushes it.
+  pvector<int> loaded_at(num_rows, INT_MIN / 2);
+  int time = 0;
+  auto count_misses = [&](int t) -> int {
+    int misses = 0;
+    for (int k = 0; k < 3; ++k) {
+      int v = indices[t * 3 + k];
+      if (time - loaded_at[v] >= cache_size) {
+        loaded_at[v] = time++;
+        ++misses;
+      }
+    }
+    return misses;
+  };
+
+  // The hard boundaries are where all three vertices of a triangle miss the
+  // cache; we can start a new cluster there at no cost.
+  pvector<int> hard_boundaries;
+  for (int t = 0; t < num_triangles; ++t) {
+    if (count_misses(t) == 3) {
+      hard_boundaries.push_back(t);
+    }
+  }
+  hard_boundaries.push_back(num_triangles);
+
+  // Now subdivide each of these clusters wherever the ACMR of the triangles
+  // since the start of the cluster is already good enough.
+  pvector<int> clusters;
+  for (size_t hi = 0; hi + 1 < hard_boundaries.size(); ++hi) {
+    int begin = hard_boundaries[hi];
+    int end = hard_boundaries[hi + 1];
+
+    time += cache_size;
+    int total_misses = 0;
+    for (int t = begin; t < end; ++t) {
+      total_misses += count_misses(t);
+    }
+    PN_stdfloat limit = threshold * (PN_stdfloat)total_misses / (PN_stdfloat)(end - begin);
+
+    time += cache_size;
+    clusters.push_back(begin);
+    int start = begin;
+    int misses = 0;
+    for (int t = begin; t < end - 1; ++t) {
+      misses += count_misses(t);
+      if ((PN_stdfloat)misses <= limit * (PN_stdfloat)(t + 1 - start)) {
+        clusters.push_back(t + 1);
+        start = t + 1;
+        misses = 0;
+        time += cache_size;
+      }
+    }
+  }
+  int num_clusters = (int)clusters.size();
+  clusters.push_back(num_triangles);
+
+  if (num_clusters < 2) {
+    return this;
+  }
+
+  // Compute the area-weighted centroid and the average normal of each
+  // cluster, and of the mesh as a whole.
+  pvector<LVecBase3> centroids(num_clusters, LVecBase3::zero());
+  pvector<LVector3> normals(num_clusters, LVector3::zero());
+  LVecBase3 mesh_centroid(0.0f, 0.0f, 0.0f);
+  PN_stdfloat mesh_area = 0.0f;
+  pvector<PN_stdfloat> areas(num_clusters);
+
+  for (int ci = 0; ci < num_clusters; ++ci) {
+    LVecBase3 centroid(0.0f, 0.0f, 0.0f);
+    LVector3 normal(0.0f, 0.0f, 0.0f);
+    PN_stdfloat area = 0.0f;
+    for (int t = clusters[ci]; t < clusters[ci + 1]; ++t) {
+      vertex.set_row_unsafe(indices[t * 3]);
+      LPoint3 p0 = vertex.get_data3();
+      vertex.set_row_unsafe(indices[t * 3 + 1]);
+      LPoint3 p1 = vertex.get_data3();
+      vertex.set_row_unsafe(indices[t * 3 + 2]);
+      LPoint3 p2 = vertex.get_data3();
+
+      LVector3 cross = (p1 - p0).cross(p2 - p0);
+      PN_stdfloat tri_area = cross.length();
+      centroid += (p0 + p1 + p2) * (tri_area / 3.0f);
+      normal += cross;
+      area += tri_area;
+    }
+    centroids[ci] = centroid;
+    normals[ci] = normal;
+    areas[ci] = area;
+    mesh_centroid += centroid;
+    mesh_area += area;
+  }
+  if (mesh_area > 0.0f) {
+    mesh_centroid /= mesh_area;
+  }
+
+  pvector<std::pair<PN_stdfloat, int> > sorted(num_clusters);
+  for (int ci = 0; ci < num_clusters; ++ci) {
+    PN_stdfloat key = 0.0f;
+    if (areas[ci] > 0.0f && normals[ci].normalize()) {
+      key = (centroids[ci] / areas[ci] - mesh_centroid).dot(normals[ci]);
+    }
+    // Sort in descending order of key, keeping the original order otherwise.
+    sorted[ci] = std::pair<PN_stdfloat, int>(-key, ci);
+  }
+  std::sort(sorted.begin(), sorted.end());
+
+  pvector<int> result;
+  result.reserve(indices.size());
+  for (const auto &entry : sorted) {
+    int ci = entry.second;
+    result.insert(result.end(), indices.begin() + clusters[ci] * 3,
+                  indices.begin() + clusters[ci + 1] * 3);
+  }
+
+  return make_with_indices(result);
+}
+
+/**
+ * Returns a new primitive with fewer triangles than this one, by repeatedly
+ * collapsing the edge that introduces the least error, according to the
+ * quadric error metric of Garland and Heckbert, until no more than
+ * target_num_triangles remain, or until the error would exceed max_error
+ * (in the units of the vertex positions).  A negative max_error means no
+ * limit on the error.
+ *
+ * Each edge is collapsed onto one of its existing vertices, so the vertex
+ * data itself is not modified and all of the vertex attributes are
+ * preserved.  Vertices on a mesh border or on a seam, where more than one
+ * vertex shares the same position (for instance because the UV's or normals
+ * are discontinuous), are never moved, and vertices are only collapsed onto
+ * vertices with the same joint weights.  This means that it may not be
+ * possible to reach the target.
+ *
+ * You may want to call remove_unused_vertices() on the vertex data
+ * afterwards, via the SceneGraphReducer.
+ */
+CPT(GeomPrimitive) GeomTriangles::
+simplify(const GeomVertexData *vertex_data, int target_num_triangles,
+         PN_stdfloat max_error) const {
+  return simplify(vertex_data, target_num_triangles, max_error, nullptr);
+}
+
+/**
+ * As above, but also stores the largest error introduced into result_error,
+ * if it is not NULL.  This is an estimate of the distance between the
+ * simplified surface and the original.
+ */
+CPT(GeomPrimitive) GeomTriangles::
+simplify(const GeomVertexData *vertex_data, int target_num_triangles,
+         PN_stdfloat max_error, PN_stdfloat *result_error) const {
+  nassertr(vertex_data != nullptr, this);
+  Thread *current_thread = Thread::get_current_thread();
+
+  if (result_error != nullptr) {
+    *result_error = 0.0f;
+  }
+
+  pvector<int> indices;
+  int num_rows;
+  if (!get_triangle_indices(indices, num_rows, current_thread)) {
+    return this;
+  }
+  int num_triangles = (int)indices.size() / 3;
+  if (num_triangles <= target_num_triangles) {
+    return this;
+  }
+
+  GeomVertexReader vertex(vertex_data, InternalName::get_vertex(), current_thread);
+  if (!vertex.has_column() || num_rows > vertex_data->get_num_rows()) {
+    return this;
+  }
+
+  pvector<LPoint3d> positions(num_rows, LPoint3d::zero());
+  for (int v = 0; v < num_rows; ++v) {
+    vertex.set_row_unsafe(v);
+    positions[v] = LCAST(double, vertex.get_data3());
+  }
+
+  // Find the vertices that share a position with another vertex, by sorting
+  // them by position.  Each vertex is mapped onto the lowest-numbered vertex
+  // at the same position.
+  pvector<int> pos_remap(num_rows);
+  pvector<bool> locked(num_rows, false);
+  {
+    pvector<int> order(num_rows);
+    for (int v = 0; v < num_rows; ++v) {
+      order[v] = v;
+    }
+    std::sort(order.begin(), order.end(), [&](int a, int b) {
+      int cmp = positions[a].compare_to(positions[b], 0.0);
+      return (cmp != 0) ? (cmp < 0) : (a < b);
+    });
+    for (int i = 0; i < num_rows; ) {
+      int j = i + 1;
+      while (j < num_rows && positions[order[j]] == positions[order[i]]) {
+        ++j;
+      }
+      for (int k = i; k < j; ++k) {
+        pos_remap[order[k]] = order[i];
+        if (j - i > 1) {
+          // This is a seam.
+          locked[order[k]] = true;
+        }
+      }
+      i = j;
+    }
+  }
+
+  // Lock the vertices on the border of the mesh: those on an edge that is
+  // used in only one direction.
+  {
+    pvector<uint64_t> edges;
+    edges.reserve(indices.size());
+    for (int t = 0; t < num_triangles; ++t) {
+      for (int k = 0; k < 3; ++k) {
+        uint64_t a = (uint32_t)pos_remap[indices[t * 3 + k]];
+        uint64_t b = (uint32_t)pos_remap[indices[t * 3 + (k + 1) % 3]];
+        edges.push_back((a << 32) | b);
+      }
+    }
+    std::sort(edges.begin(), edges.end());
+    for (uint64_t edge : edges) {
+      uint64_t reverse = (edge << 32) | (edge >> 32);
+      if (!std::binary_search(edges.begin(), edges.end(), reverse)) {
+        locked[(int)(edge >> 32)] = true;
+        locked[(int)(edge & 0xffffffff)] = true;
+      }
+    }
+    // The border vertices were identified by position; also lock the
+    // actual vertices that share that position.
+    for (int v = 0; v < num_rows; ++v) {
+      if (locked[pos_remap[v]]) {
+        locked[v] = true;
+      }
+    }
+  }
+
+  // Read the joint weights, if any, so that we only collapse vertices onto
+  // vertices that are animated the same way.
+  pvector<pvector<LVecBase4> > blend_values;
+  {
+    const GeomVertexFormat *format = vertex_data->get_format();
+    const InternalName *blend_columns[] = {
+      InternalName::get_transform_blend(),
+      InternalName::get_transform_index(),
+      InternalName::get_transform_weight(),
+    };
+    for (const InternalName *name : blend_columns) {
+      if (format->has_column(name)) {
+        GeomVertexReader reader(vertex_data, name, current_thread);
+        pvector<LVecBase4> values(num_rows, LVecBase4::zero());
+        for (int v = 0; v < num_rows; ++v) {
+          reader.set_row_unsafe(v);
+          values[v] = reader.get_data4();
+        }
+        blend_values.push_back(std::move(values));
+      }
+    }
+  }
+  auto same_blend = [&](int a, int b) -> bool {
+    for (const pvector<LVecBase4> &values : blend_values) {
+      if (values[a] != values[b]) {
+        return false;
+      }
+    }
+    return true;
+  };
+
+  // Compute the quadric for each vertex, which measures the sum of squared
+  // distances to the planes of the triangles around it.
+  pvector<SimplifyQuadric> quadrics(num_rows);
+  for (int t = 0; t < num_triangles; ++t) {
+    const LPoint3d &p0 = positions[indices[t * 3]];
+    const LPoint3d &p1 = positions[indices[t * 3 + 1]];
+    const LPoint3d &p2 = positions[indices[t * 3 + 2]];
+    LVector3d normal = (p1 - p0).cross(p2 - p0);
+    if (normal.normalize()) {
+      SimplifyQuadric quadric(normal, -normal.dot(p0));
+      for (int k = 0; k < 3; ++k) {
+        quadrics[indices[t * 3 + k]] += quadric;
+      }
+    }
+  }
+
+  double max_cost = (max_error >= 0.0f) ? (double)max_error * (double)max_error : DBL_MAX;
+  double result_cost = 0.0;
+
+  // The triangles around each vertex, rebuilt on each pass.
+  pvector<int> offsets(num_rows + 1);
+  pvector<int> vertex_triangles;
+
+  struct Collapse {
+    double _cost;
+    int _from;
+    int _to;
+    bool operator < (const Collapse &other) const {
+      return _cost < other._cost;
+    }
+  };
+  pvector<Collapse> collapses;
+  pvector<int> collapse_remap(num_rows);
+  pvector<bool> touched(num_rows);
+
+  while (num_triangles > target_num_triangles) {
+    // Build the list of triangles around each vertex.
+    std::fill(offsets.begin(), offsets.end(), 0);
+    for (int index : indices) {
+      ++offsets[index + 1];
+    }
+    for (int v = 0; v < num_rows; ++v) {
+      offsets[v + 1] += offsets[v];
+    }
+    vertex_triangles.resize(indices.size());
+    {
+      pvector<int> fill(offsets);
+      for (size_t i = 0; i < indices.size(); ++i) {
+        vertex_triangles[fill[indices[i]]++] = (int)(i / 3);
+      }
+    }
+
+    // Find all of the possible collapses, and sort them by cost.
+    collapses.clear();
+    for (int t = 0; t < num_triangles; ++t) {
+      for (int k = 0; k < 3; ++k) {
+        int a = indices[t * 3 + k];
+        int b = indices[t * 3 + (k + 1) % 3];
+        if (!locked[a] && same_blend(a, b)) {
+          SimplifyQuadric quadric = quadrics[a];
+          quadric += quadrics[b];
+          collapses.push_back({std::max(quadric.evaluate(positions[b]), 0.0), a, b});
+        }
+        if (!locked[b] && same_blend(a, b)) {
+          SimplifyQuadric quadric = quadrics[a];
+          quadric += quadrics[b];
+          collapses.push_back({std::max(quadric.evaluate(positions[a]), 0.0), b, a});
+        }
+      }
+    }
+    std::sort(collapses.begin(), collapses.end());
+
+    // Apply as many collapses as we can in this pass.  Once a vertex has been
+    // collapsed, we don't touch any of its neighbors again until the next
+    // pass, so that the flip test below remains valid.
+    for (int v = 0; v < num_rows; ++v) {
+      collapse_remap[v] = v;
+    }
+    std::fill(touched.begin(), touched.end(), false);
+
+    int num_remaining = num_triangles;
+    int num_collapsed = 0;
+    for (const Collapse &collapse : collapses) {
+      if (collapse._cost > max_cost || num_remaining <= target_num_triangles) {
+        break;
+      }
+      int from = collapse._from;
+      int to = collapse._to;
+      if (touched[from] || touched[to]) {
+        continue;
+      }
+
+      // Make sure that none of the triangles around the vertex would be
+      // flipped over by moving it, and count the ones that will disappear.
+      bool flips = false;
+      int num_removed = 0;
+      const LPoint3d &new_pos = positions[to];
+      for (int i = offsets[from]; i < offsets[from + 1] && !flips; ++i) {
+        const int *tri = &indices[vertex_triangles[i] * 3];
+        if (tri[0] == to || tri[1] == to || tri[2] == to) {
+          ++num_removed;
+          continue;
+        }
+        LPoint3d p[3];
+        LPoint3d q[3];
+        for (int k = 0; k < 3; ++k) {
+          p[k] = positions[tri[k]];
+          q[k] = (tri[k] == from) ? new_pos : p[k];
+        }
+        LVector3d old_normal = (p[1] - p[0]).cross(p[2] - p[0]);
+        LVector3d new_normal = (q[1] - q[0]).cross(q[2] - q[0]);
+        if (old_normal.dot(new_normal) <= 0.0) {
+          flips = true;
+        }
+      }
+      if (flips) {
+        continue;
+      }
+
+      collapse_remap[from] = to;
+      quadrics[to] += quadrics[from];
+      result_cost = std::max(result_cost, collapse._cost);
+      num_remaining -= num_removed;
+      ++num_collapsed;
+
+      touched[to] = true;
+      for (int i = offsets[from]; i < offsets[from + 1]; ++i) {
+        const int *tri = &indices[vertex_triangles[i] * 3];
+        touched[tri[0]] = true;
+        touched[tri[1]] = true;
+        touched[tri[2]] = true;
+      }
+    }
+
+    if (num_collapsed == 0) {
+      break;
+    }
+
+    // Now rewrite the index list, dropping the degenerate triangles.
+    size_t write = 0;
+    for (int t = 0; t < num_triangles; ++t) {
+      int a = collapse_remap[indices[t * 3]];
+      int b = collapse_remap[indices[t * 3 + 1]];
+      int c = collapse_remap[indices[t * 3 + 2]];
+      if (a != b && b != c && c != a) {
+        indices[write++] = a;
+        indices[write++] = b;
+        indices[write++] = c;
+      }
+    }
+    indices.resize(write);
+    num_triangles = (int)write / 3;
+  }
+
+  if (result_error != nullptr) {
+    *result_error = (PN_stdfloat)std::sqrt(result_cost);
+  }
+
+  if (num_triangles == (int)get_num_vertices() / 3) {
+    return this;
+  }
+  return make_with_indices(indices);
+}
+
+/**
+ * Splits the triangles into spatially coherent clusters of at most
+ * max_triangles triangles each, and appends a new primitive for each cluster
+ * to the indicated vector.  All of the new primitives index into the same
+ * vertex data as this one.
+ *
+ * Each cluster is grown from a seed triangle by repeatedly adding the
+ * neighboring triangle that lies closest to the cluster and faces the most
+ * nearly in the same direction, so that the clusters are compact and have a
+ * narrow cone of normals.  The seeds are taken in Morton order, so that even
+ * clusters that run out of neighbors stay close together.
+ */
+void GeomTriangles::
+make_clusters(pvector<CPT(GeomPrimitive)> &clusters,
+              const GeomVertexData *vertex_data, int max_triangles) const {
+  nassertv(vertex_data != nullptr && max_triangles > 0);
+  Thread *current_thread = Thread::get_current_thread();
+
+  if (!is_indexed()) {
+    PT(GeomPrimitive) indexed = make_copy();
+    indexed->make_indexed();
+    DCAST(GeomTriangles, indexed)->make_clusters(clusters, vertex_data, max_triangles);
+    return;
+  }
+
+  pvector<int> indices;
+  int num_rows;
+  get_triangle_indices(indices, num_rows, current_thread);
+  int num_triangles = (int)indices.size() / 3;
+
+  GeomVertexReader vertex(vertex_data, InternalName::get_vertex(), current_thread);
+  if (num_triangles <= max_triangles || !vertex.has_column() ||
+      num_rows > vertex_data->get_num_rows()) {
+    if (num_triangles > 0) {
+      clusters.push_back(this);
+    }
+    return;
+  }
+
+  pvector<LPoint3> positions(num_rows, LPoint3::zero());
+  for (int v = 0; v < num_rows; ++v) {
+    vertex.set_row_unsafe(v);
+    positions[v] = vertex.get_data3();
+  }
+
+  // Weld the vertices by position, so that triangles on either side of a
+  // texture or normal seam are still considered neighbors.
+  pvector<int> pos_remap(num_rows);
+  {
+    pvector<int> order(num_rows);
+    for (int v = 0; v < num_rows; ++v) {
+      order[v] = v;
+    }
+    std::sort(order.begin(), order.end(), [&](int a, int b) {
+      int cmp = positions[a].compare_to(positions[b], 0.0f);
+      return (cmp != 0) ? (cmp < 0) : (a < b);
+    });
+    for (int i = 0; i < num_rows; ) {
+      int j = i + 1;
+      while (j < num_rows && positions[order[j]] == positions[order[i]]) {
+        ++j;
+      }
+      for (int k = i; k < j; ++k) {
+        pos_remap[order[k]] = order[i];
+      }
+      i = j;
+    }
+  }
+
+  // Compute the centroid and normal of each triangle.
+  pvector<LPoint3> centroids(num_triangles, LPoint3::zero());
+  pvector<LVector3> normals(num_triangles, LVector3::zero());
+  LPoint3 min_point(FLT_MAX, FLT_MAX, FLT_MAX);
+  LPoint3 max_point(-FLT_MAX, -FLT_MAX, -FLT_MAX);
+  for (int t = 0; t < num_triangles; ++t) {
+    const LPoint3 &p0 = positions[indices[t * 3]];
+    const LPoint3 &p1 = positions[indices[t * 3 + 1]];
+    const LPoint3 &p2 = positions[indices[t * 3 + 2]];
+    centroids[t] = (p0 + p1 + p2) / 3.0f;
+    normals[t] = (p1 - p0).cross(p2 - p0);
+    normals[t].normalize();
+    min_point = min_point.fmin(centroids[t]);
+    max_point = max_point.fmax(centroids[t]);
+  }
+
+  // Sort the triangles by the Morton code of their centroid.
+  pvector<int> order(num_triangles);
+  {
+    LVecBase3 extent = max_point - min_point;
+    LVecBase3 scale(extent[0] > 0.0f ? 1023.0f / extent[0] : 0.0f,
+                    extent[1] > 0.0f ? 1023.0f / extent[1] : 0.0f,
+                    extent[2] > 0.0f ? 1023.0f / extent[2] : 0.0f);
+    pvector<uint32_t> codes(num_triangles);
+    for (int t = 0; t < num_triangles; ++t) {
+      uint32_t code = 0;
+      for (int c = 0; c < 3; ++c) {
+        uint32_t x = (uint32_t)((centroids[t][c] - min_point[c]) * scale[c]);
+        x = std::min(x, (uint32_t)1023);
+        x = (x | (x << 16)) & 0x030000ff;
+        x = (x | (x << 8)) & 0x0300f00f;
+        x = (x | (x << 4)) & 0x030c30c3;
+        x = (x | (x << 2)) & 0x09249249;
+        code |= x << c;
+      }
+      codes[t] = code;
+      order[t] = t;
+    }
+    std::sort(order.begin(), order.end(), [&](int a, int b) {
+      return codes[a] < codes[b];
+    });
+  }
+
+  // Build a table of the triangles around each (welded) vertex.
+  pvector<int> adjacency_start(num_rows + 1, 0);
+  pvector<int> adjacency(num_triangles * 3);
+  for (int i = 0; i < num_triangles * 3; ++i) {
+    ++adjacency_start[pos_remap[indices[i]] + 1];
+  }
+  for (int v = 0; v < num_rows; ++v) {
+    adjacency_start[v + 1] += adjacency_start[v];
+  }
+  {
+    pvector<int> fill(adjacency_start);
+    for (int i = 0; i < num_triangles * 3; ++i) {
+      adjacency[fill[pos_remap[indices[i]]]++] = i / 3;
+    }
+  }
+
+  pvector<bool> assigned(num_triangles, false);
+  pvector<int> frontier_stamp(num_triangles, -1);
+  pvector<int> frontier;
+  pvector<int> cluster_indices;
+  size_t next_seed = 0;
+  int cluster = 0;
+
+  while (true) {
+    while (next_seed < order.size() && assigned[order[next_seed]]) {
+      ++next_seed;
+    }
+    if (next_seed == order.size()) {
+      break;
+    }
+
+    cluster_indices.clear();
+    frontier.clear();
+    LVecBase3 center_sum(0.0f, 0.0f, 0.0f);
+    LVector3 normal_sum(0.0f, 0.0f, 0.0f);
+
+    int t = order[next_seed];
+    int cluster_size = 0;
+    while (true) {
+      assigned[t] = true;
+      ++cluster_size;
+      center_sum += centroids[t];
+      normal_sum += normals[t];
+      for (int i = 0; i < 3; ++i) {
+        int v = indices[t * 3 + i];
+        cluster_indices.push_back(v);
+
+        int w = pos_remap[v];
+        for (int a = adjacency_start[w]; a < adjacency_start[w + 1]; ++a) {
+          int u = adjacency[a];
+          if (!assigned[u] && frontier_stamp[u] != cluster) {
+            frontier_stamp[u] = cluster;
+            frontier.push_back(u);
+          }
+        }
+      }
+
+      if (cluster_size >= max_triangles) {
+        break;
+      }
+
+      // Choose the neighboring triangle that is closest to the center of the
+      // cluster, penalizing those that face away from its average normal.
+      LPoint3 center = center_sum / (PN_stdfloat)cluster_size;
+      LVector3 axis = normal_sum;
+      axis.normalize();
+
+      int best = -1;
+      PN_stdfloat best_score = FLT_MAX;
+      for (size_t f = 0; f < frontier.size(); ) {
+        int u = frontier[f];
+        if (assigned[u]) {
+          frontier[f] = frontier.back();
+          frontier.pop_back();
+          continue;
+        }
+        PN_stdfloat score = (centroids[u] - center).length() *
+          (2.0f - normals[u].dot(axis));
+        if (score < best_score) {
+          best_score = score;
+          best = u;
+        }
+        ++f;
+      }
+      if (best < 0) {
+        break;
+      }
+      t = best;
+    }
+
+    clusters.push_back(make_with_indices(cluster_indices));
+    ++cluster;
+  }
+}
+
+/**
+ * Returns the average cache miss ratio: the average number of vertices that
+ * need to be transformed per triangle, assuming a FIFO post-transform vertex
+ * cache with the indicated number of entries.  This ranges from 3.0 in the
+ * worst case down to about 0.5 for a well-optimized regular mesh.  Returns 0
+ * if there are no triangles.
+ */
+PN_stdfloat GeomTriangles::
+calc_acmr(int cache_size) const {
+  nassertr(cache_size > 0, 0.0f);
+  Thread *current_thread = Thread::get_current_thread();
+
+  GeomPrimitivePipelineReader from(this, current_thread);
+  int num_triangles = from.get_num_vertices() / 3;
+  if (num_triangles == 0) {
+    return 0.0f;
+  }
+  if (!from.is_indexed()) {
+    // Every vertex is distinct, so every vertex is a miss.
+    return 3.0f;
+  }
+
+  pvector<int> indices;
+  int num_rows;
+  get_triangle_indices(indices, num_rows, current_thread);
+
+  pvector<int> loaded_at(num_rows, INT_MIN / 2);
+  int time = 0;
+  for (int index : indices) {
+    if (time - loaded_at[index] >= cache_size) {
+      loaded_at[index] = time++;
+    }
+  }
+
+  return (PN_stdfloat)time / (PN_stdfloat)num_triangles;
+}
+
 /**
  * Calls the appropriate method on the GSG to draw the primitive.
  */
@@ -326,6 +1259,52 @@ rotate_impl() const {
   return new_vertices;
 }
 
+/**
+ * Reads the vertex indices of this primitive into the indicated array, and
+ * sets num_rows to one more than the highest index.  Returns false if the
+ * primitive is nonindexed or has fewer than two triangles, in which case
+ * there is nothing to reorder.
+ */
+bool GeomTriangles::
+get_triangle_indices(pvector<int> &indices, int &num_rows,
+                     Thread *current_thread) const {
+  GeomPrimitivePipelineReader from(this, current_thread);
+  if (!from.is_indexed()) {
+    return false;
+  }
+
+  int num_vertices = from.get_num_vertices() - from.get_num_vertices() % 3;
+  indices.resize(num_vertices);
+  num_rows = 0;
+  for (int i = 0; i < num_vertices; ++i) {
+    int index = from.get_vertex(i);
+    indices[i] = index;
+    num_rows = std::max(num_rows, index + 1);
+  }
+  return num_vertices >= 6;
+}
+
+/**
+ * Returns a copy of this primitive with its index list replaced with the
+ * indicated indices.
+ */
+CPT(GeomPrimitive) GeomTriangles::
+make_with_indices(const pvector<int> &indices) const {
+  PT(GeomTriangles) result = new GeomTriangles(*this);
+
+  PT(GeomVertexArrayData) new_vertices = make_index_data();
+  new_vertices->unclean_set_num_rows((int)indices.size());
+  {
+    GeomVertexWriter to(new_vertices, 0);
+    for (int index : indices) {
+      to.set_data1i(index);
+    }
+  }
+
+  result->set_vertices(std::move(new_vertices));
+  return result;
+}
+
 /**
  * Tells the BamReader how to create objects of type Geom.
  */
@@ -35,6 +35,25 @@ public:
 
   virtual int get_num_vertices_per_primitive() const;
 
+PUBLISHED:
+  CPT(GeomPrimitive) optimize_vertex_cache(int cache_size = 32) const;
+  CPT(GeomPrimitive) optimize_overdraw(const GeomVertexData *vertex_data,
+                                       PN_stdfloat threshold = 1.05f,
+                                       int cache_size = 32) const;
+  PN_stdfloat calc_acmr(int cache_size = 32) const;
+  CPT(GeomPrimitive) simplify(const GeomVertexData *vertex_data,
+                              int target_num_triangles,
+                              PN_stdfloat max_error = -1.0f) const;
+
+public:
+  CPT(GeomPrimitive) simplify(const GeomVertexData *vertex_data,
+                              int target_num_triangles,
+                              PN_stdfloat max_error,
+                              PN_stdfloat *result_error) const;
+  void make_clusters(pvector<CPT(GeomPrimitive)> &clusters,
+                     const GeomVertexData *vertex_data,
+                     int max_triangles) const;
+
 public:
   virtual bool draw(GraphicsStateGuardianBase *gsg,
                     const GeomPrimitivePipelineReader *reader,
@@ -66,6 +85,10 @@ public:
   virtual TypeHandle force_init_type() {init_type(); return get_class_type();}
 
 private:
+  bool get_triangle_indices(pvector<int> &indices, int &num_rows,
+                            Thread *current_thread) const;
+  CPT(GeomPrimitive) make_with_indices(const pvector<int> &indices) const;
+
   static TypeHandle _type_handle;
 
   friend class Geom;
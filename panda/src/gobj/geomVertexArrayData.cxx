@@ -289,8 +289,12 @@ release_all() {
 void GeomVertexArrayData::
 lru_epoch() {
   _independent_lru.begin_epoch();
-  VertexDataPage::get_global_lru(VertexDataPage::RC_resident)->begin_epoch();
-  VertexDataPage::get_global_lru(VertexDataPage::RC_compressed)->begin_epoch();
+  VertexDataPage::lru_epoch();
+
+  int defrag_bytes = vertex_data_defrag_bytes;
+  if (defrag_bytes > 0) {
+    _book.defragment((size_t)defrag_bytes);
+  }
 }
 
 /**
@@ -579,9 +579,14 @@ get_format_string(bool pad) const {
     case NT_uint32:
     case NT_packed_dcba:
     case NT_packed_dabc:
+    case NT_packed_oct16:
       fmt_code = 'I';
       break;
 
+    case NT_float16:
+      fmt_code = 'e';
+      break;
+
     case NT_float32:
       fmt_code = 'f';
       break;
@@ -126,6 +126,10 @@ output(std::ostream &out) const {
     out << "p";
     break;
 
+  case NT_float16:
+    out << "h";
+    break;
+
   case NT_float32:
     out << "f";
     break;
@@ -136,6 +140,7 @@ output(std::ostream &out) const {
 
   case NT_stdfloat:
   case NT_packed_ufloat:
+  case NT_packed_oct16:
     out << "?";
     break;
   }
@@ -200,9 +205,14 @@ setup() {
     break;
 
   case NT_packed_ufloat:
+  case NT_packed_oct16:
     _component_bytes = 4;  // sizeof(uint32_t)
     _num_values *= 3;
     break;
+
+  case NT_float16:
+    _component_bytes = 2;  // sizeof(uint16_t)
+    break;
   }
 
   if (_num_elements == 0) {
@@ -239,6 +249,15 @@ setup() {
  */
 GeomVertexColumn::Packer *GeomVertexColumn::
 make_packer() const {
+  if (get_numeric_type() == NT_packed_oct16) {
+    // This can only store a unit vector, whatever the contents.
+    if (get_num_components() != 1) {
+      gobj_cat.error()
+        << "GeomVertexColumn with numeric type NT_packed_oct16 must have 1 component!\n";
+    }
+    return new Packer_oct16;
+  }
+
   switch (get_contents()) {
   case C_point:
   case C_clip_point:
@@ -273,6 +292,11 @@ make_packer() const {
         }
       }
       break;
+    case NT_float16:
+      if (get_num_components() == 2) {
+        return new Packer_point_float16_2;
+      }
+      break;
     case NT_float64:
       if (sizeof(double) == sizeof(PN_float64)) {
         // Use the native float type implementation for a tiny bit more
@@ -480,6 +504,9 @@ get_data1f(const unsigned char *pointer) {
   case NT_float32:
     return *(const PN_float32 *)pointer;
 
+  case NT_float16:
+    return GeomVertexData::unpack_half(*(const uint16_t *)pointer);
+
   case NT_float64:
     return *(const PN_float64 *)pointer;
 
@@ -560,6 +587,14 @@ get_data2f(const unsigned char *pointer) {
       }
       return _v2;
 
+    case NT_float16:
+      {
+        const uint16_t *pi = (const uint16_t *)pointer;
+        _v2.set(GeomVertexData::unpack_half(pi[0]),
+                GeomVertexData::unpack_half(pi[1]));
+      }
+      return _v2;
+
     case NT_float64:
       {
         const PN_float64 *pi = (const PN_float64 *)pointer;
@@ -567,6 +602,7 @@ get_data2f(const unsigned char *pointer) {
       }
       return _v2;
 
+    case NT_packed_oct16:
     case NT_stdfloat:
       nassertr(false, _v2);
       return _v2;
@@ -666,6 +702,15 @@ get_data3f(const unsigned char *pointer) {
       }
       return _v3;
 
+    case NT_float16:
+      {
+        const uint16_t *pi = (const uint16_t *)pointer;
+        _v3.set(GeomVertexData::unpack_half(pi[0]),
+                GeomVertexData::unpack_half(pi[1]),
+                GeomVertexData::unpack_half(pi[2]));
+      }
+      return _v3;
+
     case NT_float64:
       {
         const PN_float64 *pi = (const PN_float64 *)pointer;
@@ -673,6 +718,7 @@ get_data3f(const unsigned char *pointer) {
       }
       return _v3;
 
+    case NT_packed_oct16:
     case NT_stdfloat:
       nassertr(false, _v3);
       return _v3;
@@ -786,6 +832,16 @@ get_data4f(const unsigned char *pointer) {
       }
       return _v4;
 
+    case NT_float16:
+      {
+        const uint16_t *pi = (const uint16_t *)pointer;
+        _v4.set(GeomVertexData::unpack_half(pi[0]),
+                GeomVertexData::unpack_half(pi[1]),
+                GeomVertexData::unpack_half(pi[2]),
+                GeomVertexData::unpack_half(pi[3]));
+      }
+      return _v4;
+
     case NT_float64:
       {
         const PN_float64 *pi = (const PN_float64 *)pointer;
@@ -793,6 +849,7 @@ get_data4f(const unsigned char *pointer) {
       }
       return _v4;
 
+    case NT_packed_oct16:
     case NT_stdfloat:
       nassertr(false, _v4);
       break;
@@ -857,9 +914,13 @@ get_data1d(const unsigned char *pointer) {
   case NT_float32:
     return *(const PN_float32 *)pointer;
 
+  case NT_float16:
+    return GeomVertexData::unpack_half(*(const uint16_t *)pointer);
+
   case NT_float64:
     return *(const PN_float64 *)pointer;
 
+  case NT_packed_oct16:
   case NT_stdfloat:
     nassertr(false, 0.0);
     return 0.0;
@@ -938,6 +999,14 @@ get_data2d(const unsigned char *pointer) {
       }
       return _v2d;
 
+    case NT_float16:
+      {
+        const uint16_t *pi = (const uint16_t *)pointer;
+        _v2d.set(GeomVertexData::unpack_half(pi[0]),
+                 GeomVertexData::unpack_half(pi[1]));
+      }
+      return _v2d;
+
     case NT_float64:
       {
         const PN_float64 *pi = (const PN_float64 *)pointer;
@@ -945,6 +1014,7 @@ get_data2d(const unsigned char *pointer) {
       }
       return _v2d;
 
+    case NT_packed_oct16:
     case NT_stdfloat:
       nassertr(false, _v2d);
       return _v2d;
@@ -1044,6 +1114,15 @@ get_data3d(const unsigned char *pointer) {
       }
       return _v3d;
 
+    case NT_float16:
+      {
+        const uint16_t *pi = (const uint16_t *)pointer;
+        _v3d.set(GeomVertexData::unpack_half(pi[0]),
+                 GeomVertexData::unpack_half(pi[1]),
+                 GeomVertexData::unpack_half(pi[2]));
+      }
+      return _v3d;
+
     case NT_float64:
       {
         const PN_float64 *pi = (const PN_float64 *)pointer;
@@ -1051,6 +1130,7 @@ get_data3d(const unsigned char *pointer) {
       }
       return _v3d;
 
+    case NT_packed_oct16:
     case NT_stdfloat:
       nassertr(false, _v3d);
       return _v3d;
@@ -1164,6 +1244,16 @@ get_data4d(const unsigned char *pointer) {
       }
       return _v4d;
 
+    case NT_float16:
+      {
+        const uint16_t *pi = (const uint16_t *)pointer;
+        _v4d.set(GeomVertexData::unpack_half(pi[0]),
+                 GeomVertexData::unpack_half(pi[1]),
+                 GeomVertexData::unpack_half(pi[2]),
+                 GeomVertexData::unpack_half(pi[3]));
+      }
+      return _v4d;
+
     case NT_float64:
       {
         const PN_float64 *pi = (const PN_float64 *)pointer;
@@ -1171,6 +1261,7 @@ get_data4d(const unsigned char *pointer) {
       }
       return _v4d;
 
+    case NT_packed_oct16:
     case NT_stdfloat:
       nassertr(false, _v4d);
       break;
@@ -1235,9 +1326,13 @@ get_data1i(const unsigned char *pointer) {
   case NT_float32:
     return (int)*(const PN_float32 *)pointer;
 
+  case NT_float16:
+    return (int)GeomVertexData::unpack_half(*(const uint16_t *)pointer);
+
   case NT_float64:
     return (int)*(const PN_float64 *)pointer;
 
+  case NT_packed_oct16:
   case NT_stdfloat:
     nassertr(false, 0);
     break;
@@ -1314,6 +1409,14 @@ get_data2i(const unsigned char *pointer) {
       }
       return _v2i;
 
+    case NT_float16:
+      {
+        const uint16_t *pi = (const uint16_t *)pointer;
+        _v2i.set((int)GeomVertexData::unpack_half(pi[0]),
+                 (int)GeomVertexData::unpack_half(pi[1]));
+      }
+      return _v2i;
+
     case NT_float64:
       {
         const PN_float64 *pi = (const PN_float64 *)pointer;
@@ -1321,6 +1424,7 @@ get_data2i(const unsigned char *pointer) {
       }
       return _v2i;
 
+    case NT_packed_oct16:
     case NT_stdfloat:
       nassertr(false, _v2i);
       break;
@@ -1417,6 +1521,15 @@ get_data3i(const unsigned char *pointer) {
       }
       return _v3i;
 
+    case NT_float16:
+      {
+        const uint16_t *pi = (const uint16_t *)pointer;
+        _v3i.set((int)GeomVertexData::unpack_half(pi[0]),
+                 (int)GeomVertexData::unpack_half(pi[1]),
+                 (int)GeomVertexData::unpack_half(pi[2]));
+      }
+      return _v3i;
+
     case NT_float64:
       {
         const PN_float64 *pi = (const PN_float64 *)pointer;
@@ -1424,6 +1537,7 @@ get_data3i(const unsigned char *pointer) {
       }
       return _v3i;
 
+    case NT_packed_oct16:
     case NT_stdfloat:
       nassertr(false, _v3i);
       break;
@@ -1534,6 +1648,16 @@ get_data4i(const unsigned char *pointer) {
       }
       return _v4i;
 
+    case NT_float16:
+      {
+        const uint16_t *pi = (const uint16_t *)pointer;
+        _v4i.set((int)GeomVertexData::unpack_half(pi[0]),
+                 (int)GeomVertexData::unpack_half(pi[1]),
+                 (int)GeomVertexData::unpack_half(pi[2]),
+                 (int)GeomVertexData::unpack_half(pi[3]));
+      }
+      return _v4i;
+
     case NT_float64:
       {
         const PN_float64 *pi = (const PN_float64 *)pointer;
@@ -1541,6 +1665,7 @@ get_data4i(const unsigned char *pointer) {
       }
       return _v4i;
 
+    case NT_packed_oct16:
     case NT_stdfloat:
       nassertr(false, _v4i);
       break;
@@ -1604,10 +1729,15 @@ set_data1f(unsigned char *pointer, float data) {
       *(PN_float32 *)pointer = data;
       break;
 
+    case NT_float16:
+      *(uint16_t *)pointer = GeomVertexData::pack_half(data);
+      break;
+
     case NT_float64:
       *(PN_float64 *)pointer = data;
       break;
 
+    case NT_packed_oct16:
     case NT_stdfloat:
       nassertv(false);
       break;
@@ -1693,6 +1823,14 @@ set_data2f(unsigned char *pointer, const LVecBase2f &data) {
       }
       break;
 
+    case NT_float16:
+      {
+        uint16_t *pi = (uint16_t *)pointer;
+        pi[0] = GeomVertexData::pack_half(data[0]);
+        pi[1] = GeomVertexData::pack_half(data[1]);
+      }
+      break;
+
     case NT_float64:
       {
         PN_float64 *pi = (PN_float64 *)pointer;
@@ -1701,6 +1839,7 @@ set_data2f(unsigned char *pointer, const LVecBase2f &data) {
       }
       break;
 
+    case NT_packed_oct16:
     case NT_stdfloat:
       nassertv(false);
       break;
@@ -1802,6 +1941,15 @@ set_data3f(unsigned char *pointer, const LVecBase3f &data) {
       }
       break;
 
+    case NT_float16:
+      {
+        uint16_t *pi = (uint16_t *)pointer;
+        pi[0] = GeomVertexData::pack_half(data[0]);
+        pi[1] = GeomVertexData::pack_half(data[1]);
+        pi[2] = GeomVertexData::pack_half(data[2]);
+      }
+      break;
+
     case NT_float64:
       {
         PN_float64 *pi = (PN_float64 *)pointer;
@@ -1811,6 +1959,7 @@ set_data3f(unsigned char *pointer, const LVecBase3f &data) {
       }
       break;
 
+    case NT_packed_oct16:
     case NT_stdfloat:
       nassertv(false);
       break;
@@ -1922,6 +2071,16 @@ set_data4f(unsigned char *pointer, const LVecBase4f &data) {
       }
       break;
 
+    case NT_float16:
+      {
+        uint16_t *pi = (uint16_t *)pointer;
+        pi[0] = GeomVertexData::pack_half(data[0]);
+        pi[1] = GeomVertexData::pack_half(data[1]);
+        pi[2] = GeomVertexData::pack_half(data[2]);
+        pi[3] = GeomVertexData::pack_half(data[3]);
+      }
+      break;
+
     case NT_float64:
       {
         PN_float64 *pi = (PN_float64 *)pointer;
@@ -1932,6 +2091,7 @@ set_data4f(unsigned char *pointer, const LVecBase4f &data) {
       }
       break;
 
+    case NT_packed_oct16:
     case NT_stdfloat:
       nassertv(false);
       break;
@@ -2003,10 +2163,15 @@ set_data1d(unsigned char *pointer, double data) {
       *(PN_float32 *)pointer = data;
       break;
 
+    case NT_float16:
+      *(uint16_t *)pointer = GeomVertexData::pack_half(data);
+      break;
+
     case NT_float64:
       *(PN_float64 *)pointer = data;
       break;
 
+    case NT_packed_oct16:
     case NT_stdfloat:
       nassertv(false);
       break;
@@ -2091,6 +2256,14 @@ set_data2d(unsigned char *pointer, const LVecBase2d &data) {
       }
       break;
 
+    case NT_float16:
+      {
+        uint16_t *pi = (uint16_t *)pointer;
+        pi[0] = GeomVertexData::pack_half(data[0]);
+        pi[1] = GeomVertexData::pack_half(data[1]);
+      }
+      break;
+
     case NT_float64:
       {
         PN_float64 *pi = (PN_float64 *)pointer;
@@ -2099,6 +2272,7 @@ set_data2d(unsigned char *pointer, const LVecBase2d &data) {
       }
       break;
 
+    case NT_packed_oct16:
     case NT_stdfloat:
       nassertv(false);
       break;
@@ -2200,6 +2374,15 @@ set_data3d(unsigned char *pointer, const LVecBase3d &data) {
       }
       break;
 
+    case NT_float16:
+      {
+        uint16_t *pi = (uint16_t *)pointer;
+        pi[0] = GeomVertexData::pack_half(data[0]);
+        pi[1] = GeomVertexData::pack_half(data[1]);
+        pi[2] = GeomVertexData::pack_half(data[2]);
+      }
+      break;
+
     case NT_float64:
       {
         PN_float64 *pi = (PN_float64 *)pointer;
@@ -2209,6 +2392,7 @@ set_data3d(unsigned char *pointer, const LVecBase3d &data) {
       }
       break;
 
+    case NT_packed_oct16:
     case NT_stdfloat:
       nassertv(false);
       break;
@@ -2320,6 +2504,16 @@ set_data4d(unsigned char *pointer, const LVecBase4d &data) {
       }
       break;
 
+    case NT_float16:
+      {
+        uint16_t *pi = (uint16_t *)pointer;
+        pi[0] = GeomVertexData::pack_half(data[0]);
+        pi[1] = GeomVertexData::pack_half(data[1]);
+        pi[2] = GeomVertexData::pack_half(data[2]);
+        pi[3] = GeomVertexData::pack_half(data[3]);
+      }
+      break;
+
     case NT_float64:
       {
         PN_float64 *pi = (PN_float64 *)pointer;
@@ -2330,6 +2524,7 @@ set_data4d(unsigned char *pointer, const LVecBase4d &data) {
       }
       break;
 
+    case NT_packed_oct16:
     case NT_stdfloat:
       nassertv(false);
       break;
@@ -2403,10 +2598,15 @@ set_data1i(unsigned char *pointer, int data) {
       *(PN_float32 *)pointer = (float)data;
       break;
 
+    case NT_float16:
+      *(uint16_t *)pointer = GeomVertexData::pack_half((float)data);
+      break;
+
     case NT_float64:
       *(PN_float64 *)pointer = (double)data;
       break;
 
+    case NT_packed_oct16:
     case NT_stdfloat:
       nassertv(false);
       break;
@@ -2491,6 +2691,14 @@ set_data2i(unsigned char *pointer, const LVecBase2i &data) {
       }
       break;
 
+    case NT_float16:
+      {
+        uint16_t *pi = (uint16_t *)pointer;
+        pi[0] = GeomVertexData::pack_half(data[0]);
+        pi[1] = GeomVertexData::pack_half(data[1]);
+      }
+      break;
+
     case NT_float64:
       {
         PN_float64 *pi = (PN_float64 *)pointer;
@@ -2499,6 +2707,7 @@ set_data2i(unsigned char *pointer, const LVecBase2i &data) {
       }
       break;
 
+    case NT_packed_oct16:
     case NT_stdfloat:
       nassertv(false);
       break;
@@ -2597,6 +2806,15 @@ set_data3i(unsigned char *pointer, const LVecBase3i &data) {
       }
       break;
 
+    case NT_float16:
+      {
+        uint16_t *pi = (uint16_t *)pointer;
+        pi[0] = GeomVertexData::pack_half(data[0]);
+        pi[1] = GeomVertexData::pack_half(data[1]);
+        pi[2] = GeomVertexData::pack_half(data[2]);
+      }
+      break;
+
     case NT_float64:
       {
         PN_float64 *pi = (PN_float64 *)pointer;
@@ -2606,6 +2824,7 @@ set_data3i(unsigned char *pointer, const LVecBase3i &data) {
       }
       break;
 
+    case NT_packed_oct16:
     case NT_stdfloat:
       nassertv(false);
       break;
@@ -2714,6 +2933,16 @@ set_data4i(unsigned char *pointer, const LVecBase4i &data) {
       }
       break;
 
+    case NT_float16:
+      {
+        uint16_t *pi = (uint16_t *)pointer;
+        pi[0] = GeomVertexData::pack_half(data[0]);
+        pi[1] = GeomVertexData::pack_half(data[1]);
+        pi[2] = GeomVertexData::pack_half(data[2]);
+        pi[3] = GeomVertexData::pack_half(data[3]);
+      }
+      break;
+
     case NT_float64:
       {
         PN_float64 *pi = (PN_float64 *)pointer;
@@ -2724,6 +2953,7 @@ set_data4i(unsigned char *pointer, const LVecBase4i &data) {
       }
       break;
 
+    case NT_packed_oct16:
     case NT_stdfloat:
       nassertv(false);
       break;
@@ -2881,6 +3111,16 @@ get_data4f(const unsigned char *pointer) {
       }
       return _v4;
 
+    case NT_float16:
+      {
+        const uint16_t *pi = (const uint16_t *)pointer;
+        _v4.set(GeomVertexData::unpack_half(pi[0]),
+                GeomVertexData::unpack_half(pi[1]),
+                GeomVertexData::unpack_half(pi[2]),
+                GeomVertexData::unpack_half(pi[3]));
+      }
+      return _v4;
+
     case NT_float64:
       {
         const PN_float64 *pi = (const PN_float64 *)pointer;
@@ -2888,6 +3128,7 @@ get_data4f(const unsigned char *pointer) {
       }
       return _v4;
 
+    case NT_packed_oct16:
     case NT_stdfloat:
       nassertr(false, _v4);
       break;
@@ -3037,6 +3278,16 @@ get_data4d(const unsigned char *pointer) {
       }
       return _v4d;
 
+    case NT_float16:
+      {
+        const uint16_t *pi = (const uint16_t *)pointer;
+        _v4d.set(GeomVertexData::unpack_half(pi[0]),
+                 GeomVertexData::unpack_half(pi[1]),
+                 GeomVertexData::unpack_half(pi[2]),
+                 GeomVertexData::unpack_half(pi[3]));
+      }
+      return _v4d;
+
     case NT_float64:
       {
         const PN_float64 *pi = (const PN_float64 *)pointer;
@@ -3044,6 +3295,7 @@ get_data4d(const unsigned char *pointer) {
       }
       return _v4d;
 
+    case NT_packed_oct16:
     case NT_stdfloat:
       nassertr(false, _v4d);
       break;
@@ -3182,6 +3434,16 @@ set_data4f(unsigned char *pointer, const LVecBase4f &data) {
       }
       break;
 
+    case NT_float16:
+      {
+        uint16_t *pi = (uint16_t *)pointer;
+        pi[0] = GeomVertexData::pack_half(data[0]);
+        pi[1] = GeomVertexData::pack_half(data[1]);
+        pi[2] = GeomVertexData::pack_half(data[2]);
+        pi[3] = GeomVertexData::pack_half(data[3]);
+      }
+      break;
+
     case NT_float64:
       {
         PN_float64 *pi = (PN_float64 *)pointer;
@@ -3192,6 +3454,7 @@ set_data4f(unsigned char *pointer, const LVecBase4f &data) {
       }
       break;
 
+    case NT_packed_oct16:
     case NT_stdfloat:
       nassertv(false);
       break;
@@ -3338,6 +3601,16 @@ set_data4d(unsigned char *pointer, const LVecBase4d &data) {
       }
       break;
 
+    case NT_float16:
+      {
+        uint16_t *pi = (uint16_t *)pointer;
+        pi[0] = GeomVertexData::pack_half(data[0]);
+        pi[1] = GeomVertexData::pack_half(data[1]);
+        pi[2] = GeomVertexData::pack_half(data[2]);
+        pi[3] = GeomVertexData::pack_half(data[3]);
+      }
+      break;
+
     case NT_float64:
       {
         PN_float64 *pi = (PN_float64 *)pointer;
@@ -3348,6 +3621,7 @@ set_data4d(unsigned char *pointer, const LVecBase4d &data) {
       }
       break;
 
+    case NT_packed_oct16:
     case NT_stdfloat:
       nassertv(false);
       break;
@@ -3420,6 +3694,9 @@ get_data1f(const unsigned char *pointer) {
   case NT_float32:
     return *(const PN_float32 *)pointer;
 
+  case NT_float16:
+    return GeomVertexData::unpack_half(*(const uint16_t *)pointer);
+
   case NT_float64:
     return *(const PN_float64 *)pointer;
 
@@ -3489,6 +3766,15 @@ get_data3f(const unsigned char *pointer) {
       }
       return _v3;
 
+    case NT_float16:
+      {
+        const uint16_t *pi = (const uint16_t *)pointer;
+        _v3.set(GeomVertexData::unpack_half(pi[0]),
+                GeomVertexData::unpack_half(pi[1]),
+                GeomVertexData::unpack_half(pi[2]));
+      }
+      return _v3;
+
     case NT_float64:
       {
         const PN_float64 *pi = (const PN_float64 *)pointer;
@@ -3496,6 +3782,7 @@ get_data3f(const unsigned char *pointer) {
       }
       return _v3;
 
+    case NT_packed_oct16:
     case NT_stdfloat:
     case NT_int8:
     case NT_int16:
@@ -3585,6 +3872,16 @@ get_data4f(const unsigned char *pointer) {
       }
       return _v4;
 
+    case NT_float16:
+      {
+        const uint16_t *pi = (const uint16_t *)pointer;
+        _v4.set(GeomVertexData::unpack_half(pi[0]),
+                GeomVertexData::unpack_half(pi[1]),
+                GeomVertexData::unpack_half(pi[2]),
+                GeomVertexData::unpack_half(pi[3]));
+      }
+      return _v4;
+
     case NT_float64:
       {
         const PN_float64 *pi = (const PN_float64 *)pointer;
@@ -3592,6 +3889,7 @@ get_data4f(const unsigned char *pointer) {
       }
       return _v4;
 
+    case NT_packed_oct16:
     case NT_stdfloat:
     case NT_int8:
     case NT_int16:
@@ -3635,6 +3933,9 @@ get_data1d(const unsigned char *pointer) {
   case NT_float32:
     return *(const PN_float32 *)pointer;
 
+  case NT_float16:
+    return GeomVertexData::unpack_half(*(const uint16_t *)pointer);
+
   case NT_float64:
     return *(const PN_float64 *)pointer;
 
@@ -3704,6 +4005,15 @@ get_data3d(const unsigned char *pointer) {
       }
       return _v3d;
 
+    case NT_float16:
+      {
+        const uint16_t *pi = (const uint16_t *)pointer;
+        _v3d.set(GeomVertexData::unpack_half(pi[0]),
+                 GeomVertexData::unpack_half(pi[1]),
+                 GeomVertexData::unpack_half(pi[2]));
+      }
+      return _v3d;
+
     case NT_float64:
       {
         const PN_float64 *pi = (const PN_float64 *)pointer;
@@ -3711,6 +4021,7 @@ get_data3d(const unsigned char *pointer) {
       }
       return _v3d;
 
+    case NT_packed_oct16:
     case NT_stdfloat:
     case NT_int8:
     case NT_int16:
@@ -3800,6 +4111,16 @@ get_data4d(const unsigned char *pointer) {
       }
       return _v4d;
 
+    case NT_float16:
+      {
+        const uint16_t *pi = (const uint16_t *)pointer;
+        _v4d.set(GeomVertexData::unpack_half(pi[0]),
+                 GeomVertexData::unpack_half(pi[1]),
+                 GeomVertexData::unpack_half(pi[2]),
+                 GeomVertexData::unpack_half(pi[3]));
+      }
+      return _v4d;
+
     case NT_float64:
       {
         const PN_float64 *pi = (const PN_float64 *)pointer;
@@ -3807,6 +4128,7 @@ get_data4d(const unsigned char *pointer) {
       }
       return _v4d;
 
+    case NT_packed_oct16:
     case NT_stdfloat:
     case NT_int8:
     case NT_int16:
@@ -3906,6 +4228,15 @@ set_data3f(unsigned char *pointer, const LVecBase3f &data) {
       }
       break;
 
+    case NT_float16:
+      {
+        uint16_t *pi = (uint16_t *)pointer;
+        pi[0] = GeomVertexData::pack_half(data[0]);
+        pi[1] = GeomVertexData::pack_half(data[1]);
+        pi[2] = GeomVertexData::pack_half(data[2]);
+      }
+      break;
+
     case NT_float64:
       {
         PN_float64 *pi = (PN_float64 *)pointer;
@@ -3915,6 +4246,7 @@ set_data3f(unsigned char *pointer, const LVecBase3f &data) {
       }
       break;
 
+    case NT_packed_oct16:
     case NT_stdfloat:
     case NT_int8:
     case NT_int16:
@@ -3999,6 +4331,16 @@ set_data4f(unsigned char *pointer, const LVecBase4f &data) {
       }
       break;
 
+    case NT_float16:
+      {
+        uint16_t *pi = (uint16_t *)pointer;
+        pi[0] = GeomVertexData::pack_half(data[0]);
+        pi[1] = GeomVertexData::pack_half(data[1]);
+        pi[2] = GeomVertexData::pack_half(data[2]);
+        pi[3] = GeomVertexData::pack_half(data[3]);
+      }
+      break;
+
     case NT_float64:
       {
         PN_float64 *pi = (PN_float64 *)pointer;
@@ -4009,6 +4351,7 @@ set_data4f(unsigned char *pointer, const LVecBase4f &data) {
       }
       break;
 
+    case NT_packed_oct16:
     case NT_stdfloat:
     case NT_int8:
     case NT_int16:
@@ -4109,6 +4452,15 @@ set_data3d(unsigned char *pointer, const LVecBase3d &data) {
       }
       break;
 
+    case NT_float16:
+      {
+        uint16_t *pi = (uint16_t *)pointer;
+        pi[0] = GeomVertexData::pack_half(data[0]);
+        pi[1] = GeomVertexData::pack_half(data[1]);
+        pi[2] = GeomVertexData::pack_half(data[2]);
+      }
+      break;
+
     case NT_float64:
       {
         PN_float64 *pi = (PN_float64 *)pointer;
@@ -4118,6 +4470,7 @@ set_data3d(unsigned char *pointer, const LVecBase3d &data) {
       }
       break;
 
+    case NT_packed_oct16:
     case NT_stdfloat:
     case NT_int8:
     case NT_int16:
@@ -4202,6 +4555,16 @@ set_data4d(unsigned char *pointer, const LVecBase4d &data) {
       }
       break;
 
+    case NT_float16:
+      {
+        uint16_t *pi = (uint16_t *)pointer;
+        pi[0] = GeomVertexData::pack_half(data[0]);
+        pi[1] = GeomVertexData::pack_half(data[1]);
+        pi[2] = GeomVertexData::pack_half(data[2]);
+        pi[3] = GeomVertexData::pack_half(data[3]);
+      }
+      break;
+
     case NT_float64:
       {
         PN_float64 *pi = (PN_float64 *)pointer;
@@ -4212,6 +4575,7 @@ set_data4d(unsigned char *pointer, const LVecBase4d &data) {
       }
       break;
 
+    case NT_packed_oct16:
     case NT_stdfloat:
     case NT_int8:
     case NT_int16:
@@ -4554,3 +4918,58 @@ set_data1i(unsigned char *pointer, int data) {
   *(uint16_t *)pointer = data;
   nassertv(*(uint16_t *)pointer == data);
 }
+
+/**
+ *
+ */
+const LVecBase2f &GeomVertexColumn::Packer_point_float16_2::
+get_data2f(const unsigned char *pointer) {
+  const uint16_t *pi = (const uint16_t *)pointer;
+  _v2.set(GeomVertexData::unpack_half(pi[0]),
+          GeomVertexData::unpack_half(pi[1]));
+  return _v2;
+}
+
+/**
+ *
+ */
+void GeomVertexColumn::Packer_point_float16_2::
+set_data2f(unsigned char *pointer, const LVecBase2f &data) {
+  uint16_t *pi = (uint16_t *)pointer;
+  pi[0] = GeomVertexData::pack_half(data[0]);
+  pi[1] = GeomVertexData::pack_half(data[1]);
+}
+
+/**
+ *
+ */
+const LVecBase3f &GeomVertexColumn::Packer_oct16::
+get_data3f(const unsigned char *pointer) {
+  _v3 = GeomVertexData::unpack_oct16(*(const uint32_t *)pointer);
+  return _v3;
+}
+
+/**
+ *
+ */
+const LVecBase3d &GeomVertexColumn::Packer_oct16::
+get_data3d(const unsigned char *pointer) {
+  _v3d = LCAST(double, GeomVertexData::unpack_oct16(*(const uint32_t *)pointer));
+  return _v3d;
+}
+
+/**
+ *
+ */
+void GeomVertexColumn::Packer_oct16::
+set_data3f(unsigned char *pointer, const LVecBase3f &data) {
+  *(uint32_t *)pointer = GeomVertexData::pack_oct16(data[0], data[1], data[2]);
+}
+
+/**
+ *
+ */
+void GeomVertexColumn::Packer_oct16::
+set_data3d(unsigned char *pointer, const LVecBase3d &data) {
+  *(uint32_t *)pointer = GeomVertexData::pack_oct16(data[0], data[1], data[2]);
+}
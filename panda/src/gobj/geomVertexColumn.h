@@ -427,6 +427,28 @@ private:
     }
   };
 
+  class Packer_point_float16_2 final : public Packer_point {
+  public:
+    virtual const LVecBase2f &get_data2f(const unsigned char *pointer);
+    virtual void set_data2f(unsigned char *pointer, const LVecBase2f &value);
+
+    virtual const char *get_name() const {
+      return "Packer_point_float16_2";
+    }
+  };
+
+  class Packer_oct16 final : public Packer {
+  public:
+    virtual const LVecBase3f &get_data3f(const unsigned char *pointer);
+    virtual const LVecBase3d &get_data3d(const unsigned char *pointer);
+    virtual void set_data3f(unsigned char *pointer, const LVecBase3f &value);
+    virtual void set_data3d(unsigned char *pointer, const LVecBase3d &value);
+
+    virtual const char *get_name() const {
+      return "Packer_oct16";
+    }
+  };
+
   friend class GeomVertexArrayFormat;
   friend class GeomVertexData;
   friend class GeomVertexReader;
@@ -21,6 +21,30 @@
 #include "bamWriter.h"
 #include "pset.h"
 #include "indent.h"
+#include "asyncTaskManager.h"
+#include "genericAsyncTask.h"
+
+// The bulk half-float conversions and the skinning kernels are vectorized
+// four values at a time.
+#if defined(__SSE2__) || (_M_IX86_FP >= 2) || defined(_M_X64) || defined(_M_AMD64)
+#include <emmintrin.h>
+#define VDATA_USE_SSE2
+#elif defined(__aarch64__) || defined(_M_ARM64)
+#include <arm_neon.h>
+#define VDATA_USE_NEON
+#endif
+
+#ifdef VDATA_USE_SSE2
+/**
+ * Stores the first three components of the vector, without touching whatever
+ * follows them in memory.
+ */
+static inline void
+store_xyz(float *to, __m128 v) {
+  _mm_storel_pi((__m64 *)to, v);
+  _mm_store_ss(to + 2, _mm_movehl_ps(v, v));
+}
+#endif  // VDATA_USE_SSE2
 
 using std::ostream;
 
@@ -551,6 +575,36 @@ copy_from(const GeomVertexData *source, bool keep_data_objects,
              array_data + source_column->get_start(), source_array_format->get_stride(),
              num_rows);
 
+        } else if (dest_column->get_numeric_type() == NT_float16 &&
+                   source_column->get_numeric_type() == NT_float32 &&
+                   dest_column->get_num_values() == source_column->get_num_values() &&
+                   dest_column->get_num_elements() == 1 &&
+                   source_column->get_num_elements() == 1) {
+          // Compressing floats to half-floats, as for a compact format.
+          PT(GeomVertexArrayDataHandle) dest_handle = modify_array_handle(dest_i);
+          unsigned char *dest_array_data = dest_handle->get_write_pointer();
+
+          float32_to_float16
+            (dest_array_data + dest_column->get_start(),
+             dest_array_format->get_stride(),
+             array_data + source_column->get_start(), source_array_format->get_stride(),
+             source_column->get_num_values(), num_rows);
+
+        } else if (dest_column->get_numeric_type() == NT_float32 &&
+                   source_column->get_numeric_type() == NT_float16 &&
+                   dest_column->get_num_values() == source_column->get_num_values() &&
+                   dest_column->get_num_elements() == 1 &&
+                   source_column->get_num_elements() == 1) {
+          // And back again, for hardware that can't render half-floats.
+          PT(GeomVertexArrayDataHandle) dest_handle = modify_array_handle(dest_i);
+          unsigned char *dest_array_data = dest_handle->get_write_pointer();
+
+          float16_to_float32
+            (dest_array_data + dest_column->get_start(),
+             dest_array_format->get_stride(),
+             array_data + source_column->get_start(), source_array_format->get_stride(),
+             source_column->get_num_values(), num_rows);
+
         } else {
           // A generic copy.
           if (gobj_cat.is_debug()) {
@@ -1376,6 +1430,147 @@ clear_cache_stage() {
   }
 }
 
+/**
+ * Quickly converts a column of 32-bit floats to half-precision floats.  The
+ * result is the same as that of pack_half(), but four values are converted
+ * at a time.
+ */
+void GeomVertexData::
+float32_to_float16(unsigned char *to, int to_stride,
+                   const unsigned char *from, int from_stride,
+                   int num_components, int num_records) {
+  if (gobj_cat.is_debug()) {
+    gobj_cat.debug()
+      << "float32_to_float16(" << (void *)to << ", " << to_stride
+      << ", " << (const void *)from << ", " << from_stride
+      << ", " << num_components << ", " << num_records << ")\n";
+  }
+
+  int num_values = num_components * num_records;
+  int ci = 0;
+  while (num_values > 0) {
+    // Gather up to four values, which may span several records.
+    int n = std::min(num_values, 4);
+    alignas(16) float in[4] = {0.0f, 0.0f, 0.0f, 0.0f};
+    alignas(16) uint32_t out[4];
+    uint16_t *dest[4];
+    for (int i = 0; i < n; ++i) {
+      in[i] = ((const PN_float32 *)from)[ci];
+      dest[i] = (uint16_t *)to + ci;
+      if (++ci == num_components) {
+        ci = 0;
+        from += from_stride;
+        to += to_stride;
+      }
+    }
+
+#if defined(VDATA_USE_SSE2)
+    // This is the vector form of the algorithm in pack_half().
+    __m128 f = _mm_load_ps(in);
+    __m128 just_sign = _mm_and_ps(f, _mm_castsi128_ps(_mm_set1_epi32(0x80000000u)));
+    __m128 abs_f = _mm_xor_ps(f, just_sign);
+    __m128i abs_i = _mm_castps_si128(abs_f);
+
+    __m128i is_nan = _mm_castps_si128(_mm_cmpunord_ps(abs_f, abs_f));
+    __m128i is_regular = _mm_cmpgt_epi32(_mm_set1_epi32(0x47800000), abs_i);
+    __m128i inf_or_nan = _mm_or_si128(_mm_and_si128(is_nan, _mm_set1_epi32(0x200)),
+                                      _mm_set1_epi32(0x7c00));
+
+    __m128i is_denormal = _mm_cmpgt_epi32(_mm_set1_epi32(0x38800000), abs_i);
+    __m128 magic = _mm_castsi128_ps(_mm_set1_epi32(0x3f000000));
+    __m128i denormal = _mm_sub_epi32(_mm_castps_si128(_mm_add_ps(abs_f, magic)),
+                                     _mm_castps_si128(magic));
+
+    __m128i mant_odd = _mm_srai_epi32(_mm_slli_epi32(abs_i, 31 - 13), 31);
+    __m128i normal = _mm_add_epi32(abs_i, _mm_set1_epi32((int)0xc8000fffu));
+    normal = _mm_srli_epi32(_mm_sub_epi32(normal, mant_odd), 13);
+
+    __m128i result = _mm_or_si128(_mm_and_si128(is_denormal, denormal),
+                                  _mm_andnot_si128(is_denormal, normal));
+    result = _mm_or_si128(_mm_and_si128(is_regular, result),
+                          _mm_andnot_si128(is_regular, inf_or_nan));
+    result = _mm_or_si128(result, _mm_srli_epi32(_mm_castps_si128(just_sign), 16));
+    _mm_store_si128((__m128i *)out, result);
+
+#elif defined(VDATA_USE_NEON)
+    uint16x4_t result = vreinterpret_u16_f16(vcvt_f16_f32(vld1q_f32(in)));
+    vst1q_u32(out, vmovl_u16(result));
+
+#else
+    for (int i = 0; i < 4; ++i) {
+      out[i] = pack_half(in[i]);
+    }
+#endif
+
+    for (int i = 0; i < n; ++i) {
+      *dest[i] = (uint16_t)out[i];
+    }
+    num_values -= n;
+  }
+}
+
+/**
+ * Quickly converts a column of half-precision floats to 32-bit floats.  The
+ * result is the same as that of unpack_half(), but four values are converted
+ * at a time.
+ */
+void GeomVertexData::
+float16_to_float32(unsigned char *to, int to_stride,
+                   const unsigned char *from, int from_stride,
+                   int num_components, int num_records) {
+  if (gobj_cat.is_debug()) {
+    gobj_cat.debug()
+      << "float16_to_float32(" << (void *)to << ", " << to_stride
+      << ", " << (const void *)from << ", " << from_stride
+      << ", " << num_components << ", " << num_records << ")\n";
+  }
+
+  int num_values = num_components * num_records;
+  int ci = 0;
+  while (num_values > 0) {
+    int n = std::min(num_values, 4);
+    alignas(16) uint32_t in[4] = {0, 0, 0, 0};
+    alignas(16) float out[4];
+    PN_float32 *dest[4];
+    for (int i = 0; i < n; ++i) {
+      in[i] = ((const uint16_t *)from)[ci];
+      dest[i] = (PN_float32 *)to + ci;
+      if (++ci == num_components) {
+        ci = 0;
+        from += from_stride;
+        to += to_stride;
+      }
+    }
+
+#if defined(VDATA_USE_SSE2)
+    // This is the vector form of the algorithm in unpack_half().
+    __m128i h = _mm_load_si128((const __m128i *)in);
+    __m128i exp_mant = _mm_and_si128(h, _mm_set1_epi32(0x7fff));
+    __m128i just_sign = _mm_xor_si128(h, exp_mant);
+    __m128 magic = _mm_castsi128_ps(_mm_set1_epi32((254 - 15) << 23));
+    __m128 scaled = _mm_mul_ps(_mm_castsi128_ps(_mm_slli_epi32(exp_mant, 13)), magic);
+    __m128i was_inf_nan = _mm_cmpgt_epi32(exp_mant, _mm_set1_epi32(0x7bff));
+    __m128i inf_nan_exp = _mm_and_si128(was_inf_nan, _mm_set1_epi32(0x7f800000));
+    __m128i sign_inf = _mm_or_si128(_mm_slli_epi32(just_sign, 16), inf_nan_exp);
+    _mm_store_ps(out, _mm_or_ps(scaled, _mm_castsi128_ps(sign_inf)));
+
+#elif defined(VDATA_USE_NEON)
+    uint16x4_t h = vmovn_u32(vld1q_u32(in));
+    vst1q_f32(out, vcvt_f32_f16(vreinterpret_f16_u16(h)));
+
+#else
+    for (int i = 0; i < 4; ++i) {
+      out[i] = unpack_half((uint16_t)in[i]);
+    }
+#endif
+
+    for (int i = 0; i < n; ++i) {
+      *dest[i] = out[i];
+    }
+    num_values -= n;
+  }
+}
+
 /**
  * Quickly converts DirectX-style color to OpenGL-style color.
  */
@@ -1569,6 +1764,14 @@ update_animated_vertices(GeomVertexData::CData *cdata, Thread *current_thread) {
       return;
     }
 
+    // Usually, all of the animated columns are 3- or 4-component floats, in
+    // which case they can all be skinned directly, possibly on several
+    // threads at once.
+    if (skin_float32_columns(cdata, new_data, tb_table, blend_array_index,
+                             current_thread)) {
+      return;
+    }
+
     CPT(GeomVertexArrayFormat) blend_array_format = orig_format->get_array(blend_array_index);
 
     if (blend_array_format->get_stride() == 2 &&
@@ -1811,30 +2014,7 @@ do_transform_vector_column(const GeomVertexFormat *format, GeomVertexRewriter &d
   LMatrix4 xform;
   bool normalize = false;
   if (data_column->get_contents() == C_normal) {
-    // This is to preserve perpendicularity to the surface.
-    LVecBase3 scale_sq(mat.get_row3(0).length_squared(),
-                       mat.get_row3(1).length_squared(),
-                       mat.get_row3(2).length_squared());
-    if (IS_THRESHOLD_EQUAL(scale_sq[0], scale_sq[1], 2.0e-3f) &&
-        IS_THRESHOLD_EQUAL(scale_sq[0], scale_sq[2], 2.0e-3f)) {
-      // There is a uniform scale.
-      LVecBase3 scale, shear, hpr;
-      if (IS_THRESHOLD_EQUAL(scale_sq[0], 1, 2.0e-3f)) {
-        // No scale to worry about.
-        xform = mat;
-      } else if (decompose_matrix(mat.get_upper_3(), scale, shear, hpr)) {
-        // Make a new matrix with scale/translate taken out of the equation.
-        compose_matrix(xform, LVecBase3(1, 1, 1), shear, hpr, LVecBase3::zero());
-      } else {
-        normalize = true;
-      }
-    } else {
-      // There is a non-uniform scale, so we need to do all this to preserve
-      // orthogonality to the surface.
-      xform.invert_from(mat);
-      xform.transpose_in_place();
-      normalize = true;
-    }
+    normalize = calc_normal_xform(mat, xform);
   } else {
     xform = mat;
   }
@@ -1879,6 +2059,274 @@ do_transform_vector_column(const GeomVertexFormat *format, GeomVertexRewriter &d
   }
 }
 
+/**
+ * Applies the transform blends to all of the point and vector columns of
+ * new_data, if they are all stored as 3- or 4-component float32 values.
+ * Returns false, having done nothing, if any of them is stored some other way.
+ *
+ * The vertices are first collected into runs that share a blend, so that the
+ * blended matrix of each blend is computed only once.  If skinning-num-threads
+ * is set and there are enough vertices, the runs are divided among that many
+ * threads, in addition to the current thread.
+ */
+bool GeomVertexData::
+skin_float32_columns(const GeomVertexData::CData *cdata,
+                     GeomVertexData *new_data,
+                     const TransformBlendTable *tb_table,
+                     int blend_array_index, Thread *current_thread) {
+  const GeomVertexFormat *new_format = new_data->get_format();
+  size_t num_points = new_format->get_num_points();
+  size_t num_columns = num_points + new_format->get_num_vectors();
+
+  // Make sure all of the columns can be handled here before modifying
+  // anything.
+  bool any_normals = false;
+  for (size_t ci = 0; ci < num_columns; ++ci) {
+    const InternalName *name = (ci < num_points)
+      ? new_format->get_point(ci) : new_format->get_vector(ci - num_points);
+    const GeomVertexColumn *column = new_format->get_column(name);
+    nassertr(column != nullptr, false);
+    if (column->get_numeric_type() != NT_float32 ||
+        column->get_num_elements() != 1 ||
+        (column->get_num_values() != 3 && column->get_num_values() != 4)) {
+      return false;
+    }
+    if (ci >= num_points && column->get_contents() == C_normal) {
+      any_normals = true;
+    }
+  }
+
+  SkinColumns columns;
+  columns.reserve(num_columns);
+  pvector<PT(GeomVertexArrayDataHandle)> handles(new_format->get_num_arrays());
+  for (size_t ci = 0; ci < num_columns; ++ci) {
+    const InternalName *name = (ci < num_points)
+      ? new_format->get_point(ci) : new_format->get_vector(ci - num_points);
+    int array_index;
+    const GeomVertexColumn *column;
+    new_format->get_array_info(name, array_index, column);
+    if (handles[array_index] == nullptr) {
+      handles[array_index] = new_data->modify_array_handle(array_index);
+    }
+
+    SkinColumn skin_column;
+    skin_column._data = handles[array_index]->get_write_pointer() + column->get_start();
+    skin_column._stride = new_format->get_array(array_index)->get_stride();
+    skin_column._num_values = column->get_num_values();
+    skin_column._contents = (ci < num_points) ? C_point : column->get_contents();
+    columns.push_back(skin_column);
+  }
+
+  // Collect the runs of consecutive vertices that share a blend.
+  const SparseArray &rows = tb_table->get_rows();
+  int num_subranges = rows.get_num_subranges();
+  int num_vertices = 0;
+  SkinRuns runs;
+
+  const GeomVertexArrayFormat *blend_array_format = cdata->_format->get_array(blend_array_index);
+  if (blend_array_format->get_stride() == 2 &&
+      blend_array_format->get_column(0)->get_component_bytes() == 2) {
+    // The blend indices are a table of ushorts.
+    CPT(GeomVertexArrayDataHandle) blend_array_handle =
+      new GeomVertexArrayDataHandle(cdata->_arrays[blend_array_index].get_read_pointer(current_thread), current_thread);
+    const unsigned short *blendt = (const unsigned short *)blend_array_handle->get_read_pointer(true);
+
+    for (int i = 0; i < num_subranges; ++i) {
+      int begin = rows.get_subrange_begin(i);
+      int end = rows.get_subrange_end(i);
+      for (int j = begin; j < end; ++j) {
+        int bi = blendt[j];
+        if (!runs.empty() && runs.back()._end == j && runs.back()._blend == bi) {
+          ++runs.back()._end;
+        } else {
+          runs.push_back({j, j + 1, bi});
+        }
+      }
+      num_vertices += end - begin;
+    }
+  } else {
+    GeomVertexReader blendi(this, InternalName::get_transform_blend());
+    nassertr(blendi.has_column(), false);
+
+    for (int i = 0; i < num_subranges; ++i) {
+      int begin = rows.get_subrange_begin(i);
+      int end = rows.get_subrange_end(i);
+      blendi.set_row_unsafe(begin);
+      for (int j = begin; j < end; ++j) {
+        int bi = blendi.get_data1i();
+        if (!runs.empty() && runs.back()._end == j && runs.back()._blend == bi) {
+          ++runs.back()._end;
+        } else {
+          runs.push_back({j, j + 1, bi});
+        }
+      }
+      num_vertices += end - begin;
+    }
+  }
+
+  // Compute the matrices for each blend up front.
+  int num_blends = tb_table->get_num_blends();
+  SkinBlends blends(num_blends, SkinBlend {
+    LMatrix4f::ident_mat(), LMatrix4f::ident_mat(), false });
+  for (int bi = 0; bi < num_blends; ++bi) {
+    LMatrix4 mat;
+    tb_table->get_blend(bi).get_blend(mat, current_thread);
+    blends[bi]._mat = LCAST(float, mat);
+    if (any_normals) {
+      LMatrix4 xform;
+      blends[bi]._normalize = calc_normal_xform(mat, xform);
+      blends[bi]._normal_mat = LCAST(float, xform);
+    }
+  }
+
+  // Divide the runs into jobs of roughly equal numbers of vertices, cutting
+  // runs in two where necessary.
+  int num_threads = skinning_num_threads;
+  size_t num_jobs = 1;
+  if (num_threads > 0 && Thread::is_true_threads() &&
+      num_vertices >= skinning_parallel_min_vertices) {
+    num_jobs = (size_t)num_threads + 1;
+  }
+
+  SkinJobs jobs(num_jobs);
+  for (SkinJob &job : jobs) {
+    job._columns = &columns;
+    job._blends = &blends;
+  }
+
+  if (num_jobs == 1) {
+    jobs[0]._runs.swap(runs);
+  } else {
+    int job_size = (num_vertices + (int)num_jobs - 1) / (int)num_jobs;
+    size_t ji = 0;
+    int job_vertices = 0;
+    for (SkinRun run : runs) {
+      while (run._begin < run._end) {
+        int count = std::min(run._end - run._begin, job_size - job_vertices);
+        jobs[ji]._runs.push_back({run._begin, run._begin + count, run._blend});
+        run._begin += count;
+        job_vertices += count;
+        if (job_vertices >= job_size && ji + 1 < num_jobs) {
+          ++ji;
+          job_vertices = 0;
+        }
+      }
+    }
+  }
+
+  if (num_jobs > 1) {
+    AsyncTaskManager *task_mgr = AsyncTaskManager::get_global_ptr();
+    static PT(AsyncTaskChain) chain = [task_mgr, num_threads] {
+      PT(AsyncTaskChain) chain = task_mgr->make_task_chain("skinning");
+      chain->set_num_threads(num_threads);
+      return chain;
+    }();
+
+    pvector<PT(GenericAsyncTask)> tasks;
+    for (size_t ji = 1; ji < num_jobs && !jobs[ji]._runs.empty(); ++ji) {
+      PT(GenericAsyncTask) task =
+        new GenericAsyncTask("skin_vertices", &skin_task, &jobs[ji]);
+      task->set_task_chain(chain->get_name());
+      task_mgr->add(task);
+      tasks.push_back(std::move(task));
+    }
+
+    // This thread takes care of the first part in the meantime.
+    do_skin_job(jobs[0]);
+
+    for (GenericAsyncTask *task : tasks) {
+      task->wait();
+    }
+  } else {
+    do_skin_job(jobs[0]);
+  }
+
+  return true;
+}
+
+/**
+ * Transforms the vertices of the given runs, in all of the columns.  This may
+ * be called from any thread.
+ */
+void GeomVertexData::
+do_skin_job(const GeomVertexData::SkinJob &job) {
+  for (const SkinColumn &column : *job._columns) {
+    for (const SkinRun &run : job._runs) {
+      const SkinBlend &blend = (*job._blends)[run._blend];
+      unsigned char *datat = column._data + run._begin * column._stride;
+      size_t num_rows = run._end - run._begin;
+
+      if (column._contents == C_point) {
+        if (column._num_values == 3) {
+          table_xform_point3f(datat, num_rows, column._stride, blend._mat);
+        } else {
+          table_xform_vecbase4f(datat, num_rows, column._stride, blend._mat);
+        }
+      } else if (column._contents == C_normal) {
+        if (blend._normalize) {
+          table_xform_normal3f(datat, num_rows, column._stride, blend._normal_mat);
+        } else if (column._num_values == 3) {
+          table_xform_vector3f(datat, num_rows, column._stride, blend._normal_mat);
+        } else {
+          table_xform_vecbase4f(datat, num_rows, column._stride, blend._normal_mat);
+        }
+      } else {
+        if (column._num_values == 3) {
+          table_xform_vector3f(datat, num_rows, column._stride, blend._mat);
+        } else {
+          table_xform_vecbase4f(datat, num_rows, column._stride, blend._mat);
+        }
+      }
+    }
+  }
+}
+
+/**
+ * The task function that runs one of the jobs created by
+ * skin_float32_columns() on one of the threads of the skinning task chain.
+ */
+AsyncTask::DoneStatus GeomVertexData::
+skin_task(GenericAsyncTask *task, void *user_data) {
+  do_skin_job(*(const SkinJob *)user_data);
+  return AsyncTask::DS_done;
+}
+
+/**
+ * Computes the matrix that should be used to transform normals by the
+ * indicated matrix, so that they remain perpendicular to the surface.
+ * Returns true if the normals will need to be normalized after applying the
+ * matrix, or false if it does not change their length.
+ */
+bool GeomVertexData::
+calc_normal_xform(const LMatrix4 &mat, LMatrix4 &xform) {
+  // This is to preserve perpendicularity to the surface.
+  LVecBase3 scale_sq(mat.get_row3(0).length_squared(),
+                     mat.get_row3(1).length_squared(),
+                     mat.get_row3(2).length_squared());
+  if (IS_THRESHOLD_EQUAL(scale_sq[0], scale_sq[1], 2.0e-3f) &&
+      IS_THRESHOLD_EQUAL(scale_sq[0], scale_sq[2], 2.0e-3f)) {
+    // There is a uniform scale.
+    LVecBase3 scale, shear, hpr;
+    if (IS_THRESHOLD_EQUAL(scale_sq[0], 1, 2.0e-3f)) {
+      // No scale to worry about.
+      xform = mat;
+    } else if (decompose_matrix(mat.get_upper_3(), scale, shear, hpr)) {
+      // Make a new matrix with scale/translate taken out of the equation.
+      compose_matrix(xform, LVecBase3(1, 1, 1), shear, hpr, LVecBase3::zero());
+    } else {
+      xform = mat;
+      return true;
+    }
+    return false;
+  }
+
+  // There is a non-uniform scale, so we need to do all this to preserve
+  // orthogonality to the surface.
+  xform.invert_from(mat);
+  xform.transpose_in_place();
+  return true;
+}
+
 /**
  * Transforms each of the LPoint3f objects in the indicated table by the
  * indicated matrix.
@@ -1886,12 +2334,27 @@ do_transform_vector_column(const GeomVertexFormat *format, GeomVertexRewriter &d
 void GeomVertexData::
 table_xform_point3f(unsigned char *datat, size_t num_rows, size_t stride,
                     const LMatrix4f &matf) {
+#ifdef VDATA_USE_SSE2
+  const float *m = matf.get_data();
+  __m128 r0 = _mm_loadu_ps(m);
+  __m128 r1 = _mm_loadu_ps(m + 4);
+  __m128 r2 = _mm_loadu_ps(m + 8);
+  __m128 r3 = _mm_loadu_ps(m + 12);
+  for (size_t i = 0; i < num_rows; ++i) {
+    float *v = (float *)(&datat[i * stride]);
+    __m128 p = _mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_set1_ps(v[0]), r0),
+                                     _mm_mul_ps(_mm_set1_ps(v[1]), r1)),
+                          _mm_add_ps(_mm_mul_ps(_mm_set1_ps(v[2]), r2), r3));
+    store_xyz(v, p);
+  }
+#else
   // We don't bother checking for the unaligned case here, because in practice
   // it doesn't matter with a 3-component point.
   for (size_t i = 0; i < num_rows; ++i) {
     LPoint3f &vertex = *(LPoint3f *)(&datat[i * stride]);
     vertex *= matf;
   }
+#endif  // VDATA_USE_SSE2
 }
 
 /**
@@ -1901,6 +2364,28 @@ table_xform_point3f(unsigned char *datat, size_t num_rows, size_t stride,
 void GeomVertexData::
 table_xform_normal3f(unsigned char *datat, size_t num_rows, size_t stride,
                      const LMatrix4f &matf) {
+#ifdef VDATA_USE_SSE2
+  const float *m = matf.get_data();
+  __m128 r0 = _mm_loadu_ps(m);
+  __m128 r1 = _mm_loadu_ps(m + 4);
+  __m128 r2 = _mm_loadu_ps(m + 8);
+  for (size_t i = 0; i < num_rows; ++i) {
+    float *v = (float *)(&datat[i * stride]);
+    __m128 n = _mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_set1_ps(v[0]), r0),
+                                     _mm_mul_ps(_mm_set1_ps(v[1]), r1)),
+                          _mm_mul_ps(_mm_set1_ps(v[2]), r2));
+
+    // Sum the squares of the first three components.
+    __m128 sq = _mm_mul_ps(n, n);
+    __m128 len_sq = _mm_add_ss(_mm_add_ss(sq, _mm_shuffle_ps(sq, sq, 0x55)),
+                               _mm_movehl_ps(sq, sq));
+    if (_mm_cvtss_f32(len_sq) != 0.0f) {
+      __m128 len = _mm_sqrt_ss(len_sq);
+      n = _mm_div_ps(n, _mm_shuffle_ps(len, len, 0x00));
+    }
+    store_xyz(v, n);
+  }
+#else
   // We don't bother checking for the unaligned case here, because in practice
   // it doesn't matter with a 3-component vector.
   for (size_t i = 0; i < num_rows; ++i) {
@@ -1908,6 +2393,7 @@ table_xform_normal3f(unsigned char *datat, size_t num_rows, size_t stride,
     vertex *= matf;
     vertex.normalize();
   }
+#endif  // VDATA_USE_SSE2
 }
 
 /**
@@ -1917,12 +2403,26 @@ table_xform_normal3f(unsigned char *datat, size_t num_rows, size_t stride,
 void GeomVertexData::
 table_xform_vector3f(unsigned char *datat, size_t num_rows, size_t stride,
                      const LMatrix4f &matf) {
+#ifdef VDATA_USE_SSE2
+  const float *m = matf.get_data();
+  __m128 r0 = _mm_loadu_ps(m);
+  __m128 r1 = _mm_loadu_ps(m + 4);
+  __m128 r2 = _mm_loadu_ps(m + 8);
+  for (size_t i = 0; i < num_rows; ++i) {
+    float *v = (float *)(&datat[i * stride]);
+    __m128 n = _mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_set1_ps(v[0]), r0),
+                                     _mm_mul_ps(_mm_set1_ps(v[1]), r1)),
+                          _mm_mul_ps(_mm_set1_ps(v[2]), r2));
+    store_xyz(v, n);
+  }
+#else
   // We don't bother checking for the unaligned case here, because in practice
   // it doesn't matter with a 3-component vector.
   for (size_t i = 0; i < num_rows; ++i) {
     LVector3f &vertex = *(LVector3f *)(&datat[i * stride]);
     vertex *= matf;
   }
+#endif  // VDATA_USE_SSE2
 }
 
 /**
@@ -1932,6 +2432,22 @@ table_xform_vector3f(unsigned char *datat, size_t num_rows, size_t stride,
 void GeomVertexData::
 table_xform_vecbase4f(unsigned char *datat, size_t num_rows, size_t stride,
                       const LMatrix4f &matf) {
+#ifdef VDATA_USE_SSE2
+  // These loads and stores don't care about alignment.
+  const float *m = matf.get_data();
+  __m128 r0 = _mm_loadu_ps(m);
+  __m128 r1 = _mm_loadu_ps(m + 4);
+  __m128 r2 = _mm_loadu_ps(m + 8);
+  __m128 r3 = _mm_loadu_ps(m + 12);
+  for (size_t i = 0; i < num_rows; ++i) {
+    float *v = (float *)(&datat[i * stride]);
+    __m128 p = _mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_set1_ps(v[0]), r0),
+                                     _mm_mul_ps(_mm_set1_ps(v[1]), r1)),
+                          _mm_add_ps(_mm_mul_ps(_mm_set1_ps(v[2]), r2),
+                                     _mm_mul_ps(_mm_set1_ps(v[3]), r3)));
+    _mm_storeu_ps(v, p);
+  }
+#else
 #if defined(HAVE_EIGEN) && defined(LINMATH_ALIGN)
   // Check if the table is unaligned.  If it is, we can't use the LVecBase4f
   // object directly, which assumes 16-byte alignment.
@@ -1953,6 +2469,7 @@ table_xform_vecbase4f(unsigned char *datat, size_t num_rows, size_t stride,
     LVecBase4f &vertex = *(LVecBase4f *)(&datat[i * stride]);
     vertex *= matf;
   }
+#endif  // VDATA_USE_SSE2
 }
 
 /**
@@ -2455,10 +2972,21 @@ set_num_rows(int n) {
       }
       break;
 
+    case NT_float16:
+      while (pointer < stop) {
+        uint16_t *pi = (uint16_t *)pointer;
+        for (int i = 0; i < num_values; i++) {
+          pi[i] = 0x3c00;
+        }
+        pointer += stride;
+      }
+      break;
+
     case NT_stdfloat:
     case NT_int8:
     case NT_int16:
     case NT_int32:
+    case NT_packed_oct16:
       // Shouldn't have this type in the format.
       nassertr(false, false);
       break;
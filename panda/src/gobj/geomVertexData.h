@@ -37,11 +37,21 @@
 #include "pointerTo.h"
 #include "pmap.h"
 #include "pvector.h"
+#include "epvector.h"
 #include "deletedChain.h"
+#include "asyncTask.h"
+
+#include <algorithm>
+#include <cmath>
+
+#ifdef __F16C__
+#include <immintrin.h>
+#endif
 
 class FactoryParams;
 class GeomVertexColumn;
 class GeomVertexRewriter;
+class GenericAsyncTask;
 
 /**
  * This defines the actual numeric vertex data stored in a Geom, in the
@@ -187,6 +197,12 @@ public:
   static INLINE float unpack_ufloat_b(uint32_t data);
   static INLINE float unpack_ufloat_c(uint32_t data);
 
+  static INLINE uint16_t pack_half(float data);
+  static INLINE float unpack_half(uint16_t data);
+
+  static INLINE uint32_t pack_oct16(float x, float y, float z);
+  static INLINE LVecBase3f unpack_oct16(uint32_t data);
+
 private:
   static void do_set_color(GeomVertexData *vdata, const LColor &color);
 
@@ -195,6 +211,14 @@ private:
                             const GeomVertexColumn *from_type,
                             int num_records);
   static void
+  float32_to_float16(unsigned char *to, int to_stride,
+                     const unsigned char *from, int from_stride,
+                     int num_components, int num_records);
+  static void
+  float16_to_float32(unsigned char *to, int to_stride,
+                     const unsigned char *from, int from_stride,
+                     int num_components, int num_records);
+  static void
   packed_argb_to_uint8_rgba(unsigned char *to, int to_stride,
                             const unsigned char *from, int from_stride,
                             int num_records);
@@ -342,6 +366,52 @@ private:
                                  const LMatrix4 &mat, int begin_row, int end_row);
   void do_transform_vector_column(const GeomVertexFormat *format, GeomVertexRewriter &data,
                                   const LMatrix4 &mat, int begin_row, int end_row);
+  static bool calc_normal_xform(const LMatrix4 &mat, LMatrix4 &xform);
+
+  // These are used by update_animated_vertices() to skin the float32 columns
+  // directly, possibly split across several threads.
+  class SkinColumn {
+  public:
+    unsigned char *_data;
+    size_t _stride;
+    int _num_values;
+    Contents _contents;
+  };
+  typedef pvector<SkinColumn> SkinColumns;
+
+  // The matrices to apply to the points and vectors, and to the normals, of
+  // one blend.
+  class SkinBlend {
+  public:
+    LMatrix4f _mat;
+    LMatrix4f _normal_mat;
+    bool _normalize;
+  };
+  typedef epvector<SkinBlend> SkinBlends;
+
+  // A range of consecutive vertices that share the same blend.
+  class SkinRun {
+  public:
+    int _begin;
+    int _end;
+    int _blend;
+  };
+  typedef pvector<SkinRun> SkinRuns;
+
+  class SkinJob {
+  public:
+    const SkinColumns *_columns;
+    const SkinBlends *_blends;
+    SkinRuns _runs;
+  };
+  typedef pvector<SkinJob> SkinJobs;
+
+  bool skin_float32_columns(const CData *cdata, GeomVertexData *new_data,
+                            const TransformBlendTable *tb_table,
+                            int blend_array_index, Thread *current_thread);
+  static void do_skin_job(const SkinJob &job);
+  static AsyncTask::DoneStatus skin_task(GenericAsyncTask *task, void *user_data);
+
   static void table_xform_point3f(unsigned char *datat, size_t num_rows,
                                   size_t stride, const LMatrix4f &matf);
   static void table_xform_normal3f(unsigned char *datat, size_t num_rows,
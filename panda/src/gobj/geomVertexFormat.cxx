@@ -266,6 +266,59 @@ get_union_format(const GeomVertexFormat *other) const {
   return GeomVertexFormat::register_format(new_format);
 }
 
+/**
+ * Returns a new GeomVertexFormat that stores the same columns in fewer bytes:
+ * 3-component floating-point normals are replaced by a single octahedron-
+ * mapped NT_packed_oct16 value, and floating-point texture coordinates are
+ * stored as half-precision floats.  Other columns, including the vertex
+ * positions, are kept as they are.  The columns are repacked within each
+ * array.
+ *
+ * This may only be called after the format has been registered.  The return
+ * value will also have been already registered.
+ */
+CPT(GeomVertexFormat) GeomVertexFormat::
+get_compact_format() const {
+  nassertr(is_registered(), nullptr);
+
+  PT(GeomVertexFormat) new_format = new GeomVertexFormat;
+  new_format->set_animation(_animation);
+
+  for (const GeomVertexArrayFormat *array_format : _arrays) {
+    PT(GeomVertexArrayFormat) new_array = new GeomVertexArrayFormat;
+    new_array->set_divisor(array_format->get_divisor());
+
+    size_t num_columns = array_format->get_num_columns();
+    for (size_t i = 0; i < num_columns; ++i) {
+      const GeomVertexColumn *column = array_format->get_column(i);
+      NumericType numeric_type = column->get_numeric_type();
+      bool is_float = (numeric_type == NT_float32 || numeric_type == NT_float64);
+
+      if (is_float && column->get_num_elements() == 1 &&
+          column->get_contents() == C_normal &&
+          column->get_num_components() == 3) {
+        new_array->add_column(column->get_name(), 1, NT_packed_oct16, C_normal);
+
+      } else if (is_float && column->get_num_elements() == 1 &&
+                 column->get_contents() == C_texcoord) {
+        new_array->add_column(column->get_name(), column->get_num_components(),
+                              NT_float16, C_texcoord);
+
+      } else {
+        new_array->add_column(GeomVertexColumn(
+          column->get_name(), column->get_num_components(), numeric_type,
+          column->get_contents(), new_array->get_total_bytes(),
+          column->get_column_alignment(), column->get_num_elements(),
+          column->get_element_stride()));
+      }
+    }
+
+    new_format->add_array(new_array);
+  }
+
+  return GeomVertexFormat::register_format(new_format);
+}
+
 /**
  * Returns a modifiable pointer to the indicated array.  This means
  * duplicating it if it is shared or registered.
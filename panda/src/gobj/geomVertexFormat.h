@@ -74,6 +74,7 @@ PUBLISHED:
   CPT(GeomVertexFormat) get_post_animated_format() const;
   CPT(GeomVertexFormat) get_post_instanced_format() const;
   CPT(GeomVertexFormat) get_union_format(const GeomVertexFormat *other) const;
+  CPT(GeomVertexFormat) get_compact_format() const;
 
   INLINE size_t get_num_arrays() const;
   INLINE const GeomVertexArrayFormat *get_array(size_t array) const;
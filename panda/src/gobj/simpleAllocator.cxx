@@ -197,6 +197,35 @@ void SimpleAllocator::
 changed_contiguous() {
 }
 
+/**
+ * Moves the indicated block into the place held by dest, which must be a
+ * block of the same size that was just allocated for it, possibly from a
+ * different allocator that shares the same lock.  The place previously held
+ * by the block is then freed, leaving dest unattached; the caller should
+ * delete it.  The caller is responsible for copying the contents.
+ *
+ * Note that freeing the old place may cause its allocator to delete itself,
+ * if it is a VertexDataPage that has become empty.
+ *
+ * Assumes the lock is already held.
+ */
+void SimpleAllocator::
+do_replace_block(SimpleAllocatorBlock *block, SimpleAllocatorBlock *dest) {
+  nassertv(block->_allocator != nullptr && dest->_allocator != nullptr);
+  nassertv(block->_size == dest->_size);
+
+  LinkedListNode *dest_next = dest->_next;
+  dest->remove_from_list();
+  dest->insert_before(block);
+  block->remove_from_list();
+  block->insert_before(dest_next);
+
+  std::swap(block->_allocator, dest->_allocator);
+  std::swap(block->_start, dest->_start);
+
+  dest->do_free();
+}
+
 /**
  *
  */
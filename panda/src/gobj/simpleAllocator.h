@@ -53,6 +53,10 @@ protected:
   INLINE void mark_contiguous(const LinkedListNode *block);
   virtual void changed_contiguous();
 
+  INLINE static void do_move_block(SimpleAllocatorBlock *block, size_t start);
+  static void do_replace_block(SimpleAllocatorBlock *block,
+                               SimpleAllocatorBlock *dest);
+
 protected:
 /*
  * This is implemented as a linked-list chain of allocated blocks.  Free
@@ -188,6 +188,45 @@ do_evict_to(size_t target_size, bool hard_evict) {
   }
 }
 
+/**
+ * Walks through the pages in the LRU, starting with the most recently used
+ * one, and calls prefetch_lru() on each of them, until the pages that are
+ * being prefetched add up to at least max_size bytes.  Returns the total
+ * size reported by the pages.
+ *
+ * This is intended for an LRU of pages that have been evicted to some slower
+ * form of storage, to give the pages that are most likely to be needed again
+ * the chance to bring themselves back before they are actually requested.
+ */
+size_t SimpleLru::
+prefetch_recent(size_t max_size) {
+  LightMutexHolder holder(_global_lock);
+
+  // Store the current head of the list.  If pages re-enqueue themselves on
+  // this LRU during this traversal, we don't want to visit them twice.
+  SimpleLruPage *end = (SimpleLruPage *)_next;
+
+  size_t total = 0;
+  SimpleLruPage *node = (SimpleLruPage *)_prev;
+  while (node != (LinkedListNode *)this && total < max_size) {
+    SimpleLruPage *prev = (SimpleLruPage *)node->_prev;
+
+    if (node != _active_marker) {
+      // We must release the lock while we call prefetch_lru().
+      _global_lock.unlock();
+      total += node->prefetch_lru();
+      _global_lock.lock();
+    }
+
+    if (node == end) {
+      break;
+    }
+    node = prev;
+  }
+
+  return total;
+}
+
 /**
  * Checks that the LRU is internally consistent.  Assume the lock is already
  * held.
@@ -230,6 +269,18 @@ evict_lru() {
   dequeue_lru();
 }
 
+/**
+ * Called by SimpleLru::prefetch_recent() to give the page a chance to bring
+ * itself back from wherever it was evicted to, before it is needed.  Returns
+ * the number of bytes that the page is bringing back, or 0 if it declines.
+ *
+ * The base class does nothing.
+ */
+size_t SimpleLruPage::
+prefetch_lru() {
+  return 0;
+}
+
 /**
  *
  */
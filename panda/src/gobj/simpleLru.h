@@ -38,6 +38,7 @@ PUBLISHED:
   INLINE void consider_evict();
   INLINE void evict_to(size_t target_size);
   INLINE void begin_epoch();
+  size_t prefetch_recent(size_t max_size);
 
   INLINE bool validate();
 
@@ -82,6 +83,7 @@ PUBLISHED:
   INLINE void set_lru_size(size_t lru_size);
 
   virtual void evict_lru();
+  virtual size_t prefetch_lru();
 
   virtual void output(std::ostream &out) const;
   virtual void write(std::ostream &out, int indent_level) const;
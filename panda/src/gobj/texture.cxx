@@ -44,11 +44,19 @@
 #include "texturePeeker.h"
 #include "convert_srgb.h"
 #include "asyncTaskManager.h"
+#include "genericAsyncTask.h"
 
 #ifdef HAVE_SQUISH
 #include <squish.h>
 #endif  // HAVE_SQUISH
 
+// The block compressors and the box filter can process a whole block or
+// several pixels at a time with SSE2.
+#if defined(__SSE2__) || (_M_IX86_FP >= 2) || defined(_M_X64) || defined(_M_AMD64)
+#include <emmintrin.h>
+#define TEXTURE_USE_SSE2
+#endif
+
 #include <stddef.h>
 
 using std::endl;
@@ -2670,6 +2678,135 @@ texture_uploaded() {
   }
 }
 
+/**
+ * Marks this texture as being managed by the TextureStreamer, or not.  While
+ * it is streamed, the RAM image is trimmed to the current stream level each
+ * time it is reloaded.  This is normally called only by the TextureStreamer.
+ */
+void Texture::
+set_streamed(bool streamed) {
+  CDWriter cdata(_cycler, true);
+  cdata->_streamed = streamed;
+}
+
+/**
+ * Drops the indicated number of highest-resolution mipmap levels from the
+ * texture, without rereading it.  This is possible if the RAM image is
+ * available and has at least that many levels, or if the texture has neither
+ * a RAM image nor been prepared yet, so that the new level will simply take
+ * effect when it is first loaded.
+ *
+ * Returns true if the texture is now at the requested level, or false if it
+ * needs to be reloaded with load_stream_level() instead.
+ */
+bool Texture::
+set_stream_level(int level) {
+  CDWriter cdata(_cycler, true);
+  if (level == cdata->_stream_level) {
+    return true;
+  }
+  if (level < cdata->_stream_level) {
+    // We can't get the higher levels back without rereading the image.
+    return false;
+  }
+
+  if (do_has_ram_image(cdata)) {
+    do_trim_to_stream_level(cdata, level);
+    return cdata->_stream_level == level;
+  }
+
+  {
+    MutexHolder holder(_lock);
+    if (!_prepared_views.empty()) {
+      // The graphics card still has the larger image; we need to load the
+      // smaller one to replace it.
+      return false;
+    }
+  }
+
+  int delta = level - cdata->_stream_level;
+  cdata->_x_size = max(cdata->_x_size >> delta, 1);
+  cdata->_y_size = max(cdata->_y_size >> delta, 1);
+  if (cdata->_texture_type == TT_3d_texture) {
+    cdata->_z_size = max(cdata->_z_size >> delta, 1);
+  }
+  cdata->_stream_level = level;
+  cdata->inc_properties_modified();
+  return true;
+}
+
+/**
+ * Rereads the texture image from the texture cache or from disk, keeping only
+ * the mipmap levels from the indicated level onward, and replaces the RAM
+ * image with it.  The texture is not locked while the image is being read, so
+ * this may be called from a background thread while the texture remains in
+ * use for rendering.
+ *
+ * Returns true on success, or false if the texture could not be reloaded.
+ */
+bool Texture::
+load_stream_level(int level) {
+  Thread *current_thread = Thread::get_current_thread();
+
+  // Wait for any other threads that might be reloading this texture.
+  MutexHolder holder(_lock);
+  while (_reloading) {
+    _cvar.wait();
+  }
+
+  PT(Texture) tex;
+  {
+    CDReader cdata(_cycler, current_thread);
+    if (!do_can_reload(cdata)) {
+      return false;
+    }
+    tex = do_make_copy(cdata);
+  }
+  _reloading = true;
+  _lock.unlock();
+
+  // Perform the actual reload in a copy of the texture, while our own mutex
+  // is left unlocked.
+  bool success;
+  {
+    CDWriter cdata_tex(tex->_cycler, true, current_thread);
+    cdata_tex->_streamed = true;
+    cdata_tex->_stream_level = level;
+    tex->do_reload_ram_image(cdata_tex, true);
+    success = tex->do_has_ram_image(cdata_tex);
+  }
+
+  _lock.lock();
+
+  if (success) {
+    CDWriter cdataw(_cycler, true, current_thread);
+    CDReader cdata_tex(tex->_cycler, current_thread);
+
+    cdataw->_orig_file_x_size = cdata_tex->_orig_file_x_size;
+    cdataw->_orig_file_y_size = cdata_tex->_orig_file_y_size;
+    cdataw->_x_size = cdata_tex->_x_size;
+    cdataw->_y_size = cdata_tex->_y_size;
+    cdataw->_z_size = cdata_tex->_z_size;
+    cdataw->_num_components = cdata_tex->_num_components;
+    cdataw->_component_width = cdata_tex->_component_width;
+    cdataw->_format = cdata_tex->_format;
+    cdataw->_component_type = cdata_tex->_component_type;
+    cdataw->_ram_image_compression = cdata_tex->_ram_image_compression;
+    cdataw->_ram_images = cdata_tex->_ram_images;
+    cdataw->_stream_level = cdata_tex->_stream_level;
+    cdataw->_loaded_from_image = true;
+
+    cdataw->inc_properties_modified();
+    cdataw->inc_image_modified();
+  }
+
+  nassertr(_reloading, false);
+  _reloading = false;
+  _cvar.notify_all();
+
+  return success;
+}
+
 /**
  * Should be overridden by derived classes to return true if cull_callback()
  * has been defined.  Otherwise, returns false to indicate cull_callback()
@@ -2677,7 +2814,15 @@ texture_uploaded() {
  */
 bool Texture::
 has_cull_callback() const {
-  return false;
+  // Streamed textures want to know how large they appear on screen.  The
+  // answer is cached by the RenderStates that use this texture, so if
+  // texture-streaming is on, any texture that might start streaming later
+  // asks for the callback as well.
+  if (is_streamed()) {
+    return true;
+  }
+  return texture_streaming && get_type() == Texture::get_class_type() &&
+    has_fullpath();
 }
 
 /**
@@ -5577,6 +5722,11 @@ do_reload_ram_image(CData *cdata, bool allow_compression) {
   BamCache *cache = BamCache::get_global_ptr();
   PT(BamCacheRecord) record;
 
+  // A streamed texture keeps its current resolution across reloads.  The
+  // image is always read in full, and trimmed after it has been cached.
+  int stream_level = cdata->_streamed ? cdata->_stream_level : 0;
+  cdata->_stream_level = 0;
+
   if (!do_has_compression(cdata)) {
     allow_compression = false;
   }
@@ -5644,6 +5794,7 @@ do_reload_ram_image(CData *cdata, bool allow_compression) {
             }
           }
 
+          do_trim_to_stream_level(cdata, stream_level);
           return;
         }
       }
@@ -5695,6 +5846,13 @@ do_reload_ram_image(CData *cdata, bool allow_compression) {
     }
   }
 
+  if (do_has_ram_image(cdata)) {
+    do_trim_to_stream_level(cdata, stream_level);
+  } else {
+    // The reload failed; the texture is still at its old resolution.
+    cdata->_stream_level = stream_level;
+  }
+
   // Remove any pending asynchronous reload operation.
   if (cdata->_reload_task != nullptr) {
     cdata->_reload_task->remove();
@@ -6107,81 +6265,22 @@ do_compress_ram_image(CData *cdata, Texture::CompressionMode compression,
   }
 
   if (compression == CM_rgtc) {
-    // We should compress RGTC ourselves, as squish does not support it.
-    if (cdata->_component_type != T_unsigned_byte) {
+    // We compress RGTC ourselves, as squish does not support it.
+    if (cdata->_component_type != T_unsigned_byte ||
+        cdata->_num_components > 2) {
       return false;
     }
-
-    if (!do_has_all_ram_mipmap_images(cdata)) {
-      // If we're about to compress the RAM image, we should ensure that we
-      // have all of the mipmap levels first.
-      do_generate_ram_mipmap_images(cdata, false);
-    }
-
-    RamImages compressed_ram_images;
-    compressed_ram_images.resize(cdata->_ram_images.size());
-
-    for (size_t n = 0; n < cdata->_ram_images.size(); ++n) {
-      const RamImage *uncompressed_image = &cdata->_ram_images[n];
-
-      int x_size = do_get_expected_mipmap_x_size(cdata, n);
-      int y_size = do_get_expected_mipmap_y_size(cdata, n);
-      int num_pages = do_get_expected_mipmap_num_pages(cdata, n);
-
-      // It is important that we handle image sizes that aren't a multiple of
-      // the block size, since this method may be used to compress mipmaps,
-      // which go all the way to 1x1.  Pad the image if necessary.
-      RamImage temp_image;
-      if ((x_size | y_size) & 0x3) {
-        int virtual_x_size = x_size;
-        int virtual_y_size = y_size;
-        x_size = (x_size + 3) & ~0x3;
-        y_size = (y_size + 3) & ~0x3;
-
-        temp_image._page_size = x_size * y_size * cdata->_num_components;
-        temp_image._image = PTA_uchar::empty_array(temp_image._page_size * num_pages);
-
-        for (int z = 0; z < num_pages; ++z) {
-          unsigned char *dest = temp_image._image.p() + z * temp_image._page_size;
-          unsigned const char *src = uncompressed_image->_image.p() + z * uncompressed_image->_page_size;
-
-          for (int y = 0; y < virtual_y_size; ++y) {
-            memcpy(dest, src, virtual_x_size);
-            src += virtual_x_size;
-            dest += x_size;
-          }
-        }
-
-        uncompressed_image = &temp_image;
-      }
-
-      // Create a new image to hold the compressed texture pages.
-      RamImage &compressed_image = compressed_ram_images[n];
-      compressed_image._page_size = (x_size * y_size * cdata->_num_components) >> 1;
-      compressed_image._image = PTA_uchar::empty_array(compressed_image._page_size * num_pages);
-
-      if (cdata->_num_components == 1) {
-        do_compress_ram_image_bc4(*uncompressed_image, compressed_image,
-                                  x_size, y_size, num_pages);
-      } else if (cdata->_num_components == 2) {
-        do_compress_ram_image_bc5(*uncompressed_image, compressed_image,
-                                  x_size, y_size, num_pages);
-      } else {
-        // Invalid.
-        return false;
-      }
-    }
-
-    cdata->_ram_images.swap(compressed_ram_images);
-    cdata->_ram_image_compression = CM_rgtc;
-    return true;
+    return do_compress_ram_image_blocks(cdata, compression, 0);
   }
 
-#ifdef HAVE_SQUISH
-  if (cdata->_texture_type != TT_3d_texture &&
+  if ((compression == CM_dxt1 || compression == CM_dxt3 || compression == CM_dxt5) &&
+      cdata->_texture_type != TT_3d_texture &&
       cdata->_texture_type != TT_2d_texture_array &&
       cdata->_component_type == T_unsigned_byte) {
+    // If we have squish, we use it, since it produces better results.  If we
+    // don't, we fall back to our own range-fit encoder.
     int squish_flags = 0;
+#ifdef HAVE_SQUISH
     switch (compression) {
     case CM_dxt1:
       squish_flags |= squish::kDxt1;
@@ -6199,34 +6298,29 @@ do_compress_ram_image(CData *cdata, Texture::CompressionMode compression,
       break;
     }
 
-    if (squish_flags != 0) {
-      // This compression mode is supported by squish; use it.
-      switch (quality_level) {
-      case QL_fastest:
-        squish_flags |= squish::kColourRangeFit;
-        break;
-
-      case QL_normal:
-        // ColourClusterFit is just too slow for everyday use.
-        squish_flags |= squish::kColourRangeFit;
-        // squish_flags |= squish::kColourClusterFit;
-        break;
+    switch (quality_level) {
+    case QL_fastest:
+      squish_flags |= squish::kColourRangeFit;
+      break;
 
-      case QL_best:
-        squish_flags |= squish::kColourIterativeClusterFit;
-        break;
+    case QL_normal:
+      // ColourClusterFit is just too slow for everyday use.
+      squish_flags |= squish::kColourRangeFit;
+      // squish_flags |= squish::kColourClusterFit;
+      break;
 
-      default:
-        break;
-      }
+    case QL_best:
+      squish_flags |= squish::kColourIterativeClusterFit;
+      break;
 
-      if (do_squish(cdata, compression, squish_flags)) {
-        return true;
-      }
+    default:
+      break;
     }
-  }
 #endif  // HAVE_SQUISH
 
+    return do_compress_ram_image_blocks(cdata, compression, squish_flags);
+  }
+
   return false;
 }
 
@@ -6303,263 +6397,531 @@ do_uncompress_ram_image(CData *cdata) {
 }
 
 /**
- * Compresses a RAM image using BC4 compression.
+ * Compresses all of the RAM images, which must be uncompressed and have
+ * unsigned byte components, using one of the block compression modes: RGTC
+ * or DXT1/3/5.  If squish_flags is nonzero, the squish library is used for
+ * DXT compression; otherwise, the built-in encoder is used.
+ *
+ * The pages of all mipmap levels are divided into strips of blocks, which are
+ * compressed in parallel if texture-process-threads is set.
+ */
+bool Texture::
+do_compress_ram_image_blocks(CData *cdata, Texture::CompressionMode compression,
+                             int squish_flags) {
+  nassertr(cdata->_ram_image_compression == CM_off, false);
+  nassertr(cdata->_component_type == T_unsigned_byte, false);
+
+  if (!do_has_all_ram_mipmap_images(cdata)) {
+    // If we're about to compress the RAM image, we should ensure that we have
+    // all of the mipmap levels first.
+    do_generate_ram_mipmap_images(cdata, false);
+  }
+
+  // The number of bytes in each compressed 4x4 block.
+  size_t block_size = 16;
+  if (compression == CM_dxt1 ||
+      (compression == CM_rgtc && cdata->_num_components == 1)) {
+    block_size = 8;
+  }
+
+  ImageJob job {};
+  if (compression == CM_rgtc) {
+    job._func = &compress_rgtc_rows;
+  } else {
+    job._func = &compress_dxt_rows;
+  }
+  job._num_components = cdata->_num_components;
+  job._pixel_size = cdata->_num_components;
+  job._compression = compression;
+  job._squish_flags = squish_flags;
+
+  RamImages compressed_ram_images;
+  compressed_ram_images.resize(cdata->_ram_images.size());
+
+  ImageJobs jobs;
+  size_t num_pixels = 0;
+  for (size_t n = 0; n < cdata->_ram_images.size(); ++n) {
+    const RamImage &uncompressed_image = cdata->_ram_images[n];
+
+    // It is important that we handle image sizes that aren't a multiple of
+    // the block size, since this method may be used to compress mipmaps,
+    // which go all the way to 1x1.  The kernels replicate the edge pixels
+    // into the partial blocks.
+    int x_size = do_get_expected_mipmap_x_size(cdata, n);
+    int y_size = do_get_expected_mipmap_y_size(cdata, n);
+    int num_pages = do_get_expected_mipmap_num_pages(cdata, n);
+    int x_blocks = (x_size + 3) >> 2;
+    int y_blocks = (y_size + 3) >> 2;
+
+    nassertr(uncompressed_image._page_size >= (size_t)x_size * (size_t)y_size * job._pixel_size, false);
+    nassertr(uncompressed_image._image.size() >= uncompressed_image._page_size * num_pages, false);
+
+    RamImage &compressed_image = compressed_ram_images[n];
+    compressed_image._page_size = (size_t)x_blocks * (size_t)y_blocks * block_size;
+    compressed_image._image = PTA_uchar::empty_array(compressed_image._page_size * num_pages);
+
+    job._x_size = x_size;
+    job._y_size = y_size;
+    for (int z = 0; z < num_pages; ++z) {
+      job._src = uncompressed_image._image.p() + z * uncompressed_image._page_size;
+      job._dest = compressed_image._image.p() + z * compressed_image._page_size;
+      add_image_jobs(jobs, job, y_blocks, (size_t)x_blocks * 16);
+    }
+    num_pixels += (size_t)x_size * (size_t)y_size * (size_t)num_pages;
+  }
+
+  run_image_jobs(jobs, num_pixels);
+
+  cdata->_ram_images.swap(compressed_ram_images);
+  cdata->_ram_image_compression = compression;
+  return true;
+}
+
+/**
+ * Divides the indicated number of rows of the page described by the given
+ * job into strips, and adds a job for each strip.  row_pixels is the number
+ * of pixels touched by each row, which is used to choose the strip size.
  */
 void Texture::
-do_compress_ram_image_bc4(const RamImage &uncompressed_image,
-                          RamImage &compressed_image,
-                          int x_size, int y_size, int num_pages) {
-  int x_blocks = (x_size >> 2);
-  int y_blocks = (y_size >> 2);
+add_image_jobs(ImageJobs &jobs, const ImageJob &job,
+               int num_rows, size_t row_pixels) {
+  // Make the strips large enough to be worth handing off to another thread.
+  int rows_per_job = (int)max((size_t)16384 / max(row_pixels, (size_t)1), (size_t)1);
 
-  // NB. This algorithm isn't fully optimal, since it doesn't try to make use
-  // of the secondary interpolation mode supported by BC4.  This is not
-  // important for most textures, but it may be added in the future.
+  for (int y = 0; y < num_rows; y += rows_per_job) {
+    jobs.push_back(job);
+    jobs.back()._begin = y;
+    jobs.back()._end = min(y + rows_per_job, num_rows);
+  }
+}
 
-  nassertv((size_t)x_blocks * (size_t)y_blocks * 4 * 4 <= uncompressed_image._page_size);
-  nassertv((size_t)x_size * (size_t)y_size == uncompressed_image._page_size);
+/**
+ * Runs all of the indicated jobs, and returns when they have all finished.
+ * If texture-process-threads is set and there is enough work to do, as
+ * indicated by num_pixels, the jobs are spread across the threads of the
+ * "texture" task chain, with the calling thread taking a share as well.
+ */
+void Texture::
+run_image_jobs(const ImageJobs &jobs, size_t num_pixels) {
+  int num_threads = texture_process_threads;
+  if (num_threads <= 0 || jobs.size() <= 1 || !Thread::is_true_threads() ||
+      num_pixels < (size_t)texture_parallel_min_pixels) {
+    for (const ImageJob &job : jobs) {
+      job._func(job);
+    }
+    return;
+  }
 
-  static const int remap[] = {1, 7, 6, 5, 4, 3, 2, 0};
+  AsyncTaskManager *task_mgr = AsyncTaskManager::get_global_ptr();
+  static PT(AsyncTaskChain) chain = task_mgr->make_task_chain("texture");
+  chain->set_num_threads(num_threads);
 
-  for (int z = 0; z < num_pages; ++z) {
-    unsigned char *dest = compressed_image._image.p() + z * compressed_image._page_size;
-    unsigned const char *src = uncompressed_image._image.p() + z * uncompressed_image._page_size;
+  // Each group takes every num_groups'th job.  The jobs of one page are all
+  // about the same size, so this divides the work fairly evenly.
+  size_t num_groups = min((size_t)num_threads + 1, jobs.size());
+  pvector<ImageJobGroup> groups(num_groups);
+  for (size_t gi = 0; gi < num_groups; ++gi) {
+    groups[gi]._jobs = &jobs;
+    groups[gi]._first = gi;
+    groups[gi]._step = num_groups;
+  }
 
-    // Convert one 4 x 4 block at a time.
-    for (int y = 0; y < y_blocks; ++y) {
-      for (int x = 0; x < x_blocks; ++x) {
-        int a, b, c, d;
-        float fac, add;
-        unsigned char minv, maxv;
-        unsigned const char *blk = src;
-
-        // Find the minimum and maximum value in the block.
-        minv = blk[0];
-        maxv = blk[0];
-        minv = min(blk[1], minv); maxv = max(blk[1], maxv);
-        minv = min(blk[2], minv); maxv = max(blk[2], maxv);
-        minv = min(blk[3], minv); maxv = max(blk[3], maxv);
-        blk += x_size;
-        minv = min(blk[0], minv); maxv = max(blk[0], maxv);
-        minv = min(blk[1], minv); maxv = max(blk[1], maxv);
-        minv = min(blk[2], minv); maxv = max(blk[2], maxv);
-        minv = min(blk[3], minv); maxv = max(blk[3], maxv);
-        blk += x_size;
-        minv = min(blk[0], minv); maxv = max(blk[0], maxv);
-        minv = min(blk[1], minv); maxv = max(blk[1], maxv);
-        minv = min(blk[2], minv); maxv = max(blk[2], maxv);
-        minv = min(blk[3], minv); maxv = max(blk[3], maxv);
-        blk += x_size;
-        minv = min(blk[0], minv); maxv = max(blk[0], maxv);
-        minv = min(blk[1], minv); maxv = max(blk[1], maxv);
-        minv = min(blk[2], minv); maxv = max(blk[2], maxv);
-        minv = min(blk[3], minv); maxv = max(blk[3], maxv);
-
-        // Now calculate the index for each pixel.
-        blk = src;
-        if (maxv > minv) {
-          fac = 7.5f / (maxv - minv);
-        } else {
-          fac = 0;
+  pvector<PT(GenericAsyncTask)> tasks;
+  for (size_t gi = 1; gi < num_groups; ++gi) {
+    PT(GenericAsyncTask) task =
+      new GenericAsyncTask("process_texture", &image_job_task, &groups[gi]);
+    task->set_task_chain("texture");
+    task_mgr->add(task);
+    tasks.push_back(std::move(task));
+  }
+
+  // This thread takes care of the first group in the meantime.
+  do_image_job_group(groups[0]);
+
+  for (GenericAsyncTask *task : tasks) {
+    task->wait();
+  }
+}
+
+/**
+ * Runs the jobs of the indicated group, one after the other.  This may be
+ * called from any thread.
+ */
+void Texture::
+do_image_job_group(const ImageJobGroup &group) {
+  const ImageJobs &jobs = *group._jobs;
+  for (size_t ji = group._first; ji < jobs.size(); ji += group._step) {
+    jobs[ji]._func(jobs[ji]);
+  }
+}
+
+/**
+ * The task function that runs one of the job groups created by
+ * run_image_jobs() on one of the threads of the texture task chain.
+ */
+AsyncTask::DoneStatus Texture::
+image_job_task(GenericAsyncTask *task, void *user_data) {
+  do_image_job_group(*(const ImageJobGroup *)user_data);
+  return AsyncTask::DS_done;
+}
+
+/**
+ * Compresses a range of block rows of one page using BC4 (for one-component
+ * images) or BC5 (for two-component images) compression.  This may be
+ * called from any thread.
+ */
+void Texture::
+compress_rgtc_rows(const ImageJob &job) {
+  int x_blocks = (job._x_size + 3) >> 2;
+  size_t block_size = 8 * job._num_components;
+  unsigned char *dest = job._dest + (size_t)job._begin * x_blocks * block_size;
+
+  for (int by = job._begin; by < job._end; ++by) {
+    // Replicate the last row if the height isn't a multiple of 4.
+    const unsigned char *rows[4];
+    for (int i = 0; i < 4; ++i) {
+      int y = min(by * 4 + i, job._y_size - 1);
+      rows[i] = job._src + (size_t)y * job._x_size * job._pixel_size;
+    }
+
+    for (int bx = 0; bx < x_blocks; ++bx) {
+      // And the last column if the width isn't a multiple of 4.
+      size_t cols[4];
+      for (int i = 0; i < 4; ++i) {
+        cols[i] = min(bx * 4 + i, job._x_size - 1) * job._pixel_size;
+      }
+
+      // BC5 is just two BC4 blocks, one for each channel.
+      for (int c = 0; c < job._num_components; ++c) {
+        unsigned char values[16];
+        for (int i = 0; i < 16; ++i) {
+          values[i] = rows[i >> 2][cols[i & 3] + c];
         }
-        add = -minv * fac;
-        a = (remap[(int)(blk[0] * fac + add)])
-          | (remap[(int)(blk[1] * fac + add)] << 3)
-          | (remap[(int)(blk[2] * fac + add)] << 6)
-          | (remap[(int)(blk[3] * fac + add)] << 9);
-        blk += x_size;
-        b = (remap[(int)(blk[0] * fac + add)] << 4)
-          | (remap[(int)(blk[1] * fac + add)] << 7)
-          | (remap[(int)(blk[2] * fac + add)] << 10)
-          | (remap[(int)(blk[3] * fac + add)] << 13);
-        blk += x_size;
-        c = (remap[(int)(blk[0] * fac + add)])
-          | (remap[(int)(blk[1] * fac + add)] << 3)
-          | (remap[(int)(blk[2] * fac + add)] << 6)
-          | (remap[(int)(blk[3] * fac + add)] << 9);
-        blk += x_size;
-        d = (remap[(int)(blk[0] * fac + add)] << 4)
-          | (remap[(int)(blk[1] * fac + add)] << 7)
-          | (remap[(int)(blk[2] * fac + add)] << 10)
-          | (remap[(int)(blk[3] * fac + add)] << 13);
-
-        *(dest++) = maxv;
-        *(dest++) = minv;
-        *(dest++) = a & 0xff;
-        *(dest++) = (a >> 8) | (b & 0xf0);
-        *(dest++) = b >> 8;
-        *(dest++) = c & 0xff;
-        *(dest++) = (c >> 8) | (d & 0xf0);
-        *(dest++) = d >> 8;
-
-        // Advance to the beginning of the next 4x4 block.
-        src += 4;
-      }
-      src += x_size * 3;
+        encode_bc4_block(values, dest);
+        dest += 8;
+      }
     }
     Thread::consider_yield();
   }
 }
 
 /**
- * Compresses a RAM image using BC5 compression.
+ * Compresses a range of block rows of one page using DXT1, DXT3 or DXT5
+ * compression.  This may be called from any thread.
  */
 void Texture::
-do_compress_ram_image_bc5(const RamImage &uncompressed_image,
-                          RamImage &compressed_image,
-                          int x_size, int y_size, int num_pages) {
-  int x_blocks = (x_size >> 2);
-  int y_blocks = (y_size >> 2);
-  int stride = x_size * 2;
-
-  // BC5 uses the same compression algorithm as BC4, except repeated for two
-  // channels.
+compress_dxt_rows(const ImageJob &job) {
+  int x_blocks = (job._x_size + 3) >> 2;
+  size_t block_size = (job._compression == CM_dxt1) ? 8 : 16;
+  unsigned char *dest = job._dest + (size_t)job._begin * x_blocks * block_size;
+
+  // Unlike squish, our own DXT1 encoder only uses the transparent color if
+  // the image actually has an alpha channel.
+  bool binary_alpha = (job._num_components == 2 || job._num_components == 4);
+
+  for (int by = job._begin; by < job._end; ++by) {
+    const unsigned char *rows[4];
+    for (int i = 0; i < 4; ++i) {
+      int y = min(by * 4 + i, job._y_size - 1);
+      rows[i] = job._src + (size_t)y * job._x_size * job._pixel_size;
+    }
+
+    for (int bx = 0; bx < x_blocks; ++bx) {
+      // Convert the block to RGBA, replicating the edge pixels into the
+      // parts of the block that lie outside the image.
+      unsigned char tb[16 * 4];
+      unsigned char *t = tb;
+      for (int i = 0; i < 16; ++i) {
+        int xi = min(bx * 4 + (i & 3), job._x_size - 1);
+        const unsigned char *s = rows[i >> 2] + xi * job._pixel_size;
+        switch (job._num_components) {
+        case 1:
+          t[0] = s[0];   // r
+          t[1] = s[0];   // g
+          t[2] = s[0];   // b
+          t[3] = 255;    // a
+          break;
 
-  nassertv((size_t)x_blocks * (size_t)y_blocks * 4 * 4 * 2 <= uncompressed_image._page_size);
-  nassertv((size_t)stride * (size_t)y_size == uncompressed_image._page_size);
+        case 2:
+          t[0] = s[0];   // r
+          t[1] = s[0];   // g
+          t[2] = s[0];   // b
+          t[3] = s[1];   // a
+          break;
 
-  static const int remap[] = {1, 7, 6, 5, 4, 3, 2, 0};
+        case 3:
+          t[0] = s[2];   // r
+          t[1] = s[1];   // g
+          t[2] = s[0];   // b
+          t[3] = 255;    // a
+          break;
 
-  for (int z = 0; z < num_pages; ++z) {
-    unsigned char *dest = compressed_image._image.p() + z * compressed_image._page_size;
-    unsigned const char *src = uncompressed_image._image.p() + z * uncompressed_image._page_size;
+        case 4:
+          t[0] = s[2];   // r
+          t[1] = s[1];   // g
+          t[2] = s[0];   // b
+          t[3] = s[3];   // a
+          break;
+        }
+        t += 4;
+      }
 
-    // Convert one 4 x 4 block at a time.
-    for (int y = 0; y < y_blocks; ++y) {
-      for (int x = 0; x < x_blocks; ++x) {
-        int a, b, c, d;
-        float fac, add;
-        unsigned char minv, maxv;
-        unsigned const char *blk = src;
-
-        // Find the minimum and maximum red value in the block.
-        minv = blk[0];
-        maxv = blk[0];
-        minv = min(blk[2], minv); maxv = max(blk[2], maxv);
-        minv = min(blk[4], minv); maxv = max(blk[4], maxv);
-        minv = min(blk[6], minv); maxv = max(blk[6], maxv);
-        blk += stride;
-        minv = min(blk[0], minv); maxv = max(blk[0], maxv);
-        minv = min(blk[2], minv); maxv = max(blk[2], maxv);
-        minv = min(blk[4], minv); maxv = max(blk[4], maxv);
-        minv = min(blk[6], minv); maxv = max(blk[6], maxv);
-        blk += stride;
-        minv = min(blk[0], minv); maxv = max(blk[0], maxv);
-        minv = min(blk[2], minv); maxv = max(blk[2], maxv);
-        minv = min(blk[4], minv); maxv = max(blk[4], maxv);
-        minv = min(blk[6], minv); maxv = max(blk[6], maxv);
-        blk += stride;
-        minv = min(blk[0], minv); maxv = max(blk[0], maxv);
-        minv = min(blk[2], minv); maxv = max(blk[2], maxv);
-        minv = min(blk[4], minv); maxv = max(blk[4], maxv);
-        minv = min(blk[6], minv); maxv = max(blk[6], maxv);
-
-        // Now calculate the index for each pixel.
-        if (maxv > minv) {
-          fac = 7.5f / (maxv - minv);
-        } else {
-          fac = 0;
+#ifdef HAVE_SQUISH
+      if (job._squish_flags != 0) {
+        // Tell squish which pixels are really part of the image.
+        int mask = 0;
+        for (int i = 0; i < 16; ++i) {
+          if (bx * 4 + (i & 3) < job._x_size && by * 4 + (i >> 2) < job._y_size) {
+            mask |= (1 << i);
+          }
         }
-        add = -minv * fac;
-        blk = src;
-        a = (remap[(int)(blk[0] * fac + add)])
-          | (remap[(int)(blk[2] * fac + add)] << 3)
-          | (remap[(int)(blk[4] * fac + add)] << 6)
-          | (remap[(int)(blk[6] * fac + add)] << 9);
-        blk += stride;
-        b = (remap[(int)(blk[0] * fac + add)] << 4)
-          | (remap[(int)(blk[2] * fac + add)] << 7)
-          | (remap[(int)(blk[4] * fac + add)] << 10)
-          | (remap[(int)(blk[6] * fac + add)] << 13);
-        blk += stride;
-        c = (remap[(int)(blk[0] * fac + add)])
-          | (remap[(int)(blk[2] * fac + add)] << 3)
-          | (remap[(int)(blk[4] * fac + add)] << 6)
-          | (remap[(int)(blk[6] * fac + add)] << 9);
-        blk += stride;
-        d = (remap[(int)(blk[0] * fac + add)] << 4)
-          | (remap[(int)(blk[2] * fac + add)] << 7)
-          | (remap[(int)(blk[4] * fac + add)] << 10)
-          | (remap[(int)(blk[6] * fac + add)] << 13);
-
-        *(dest++) = maxv;
-        *(dest++) = minv;
-        *(dest++) = a & 0xff;
-        *(dest++) = (a >> 8) | (b & 0xf0);
-        *(dest++) = b >> 8;
-        *(dest++) = c & 0xff;
-        *(dest++) = (c >> 8) | (d & 0xf0);
-        *(dest++) = d >> 8;
-
-        // Find the minimum and maximum green value in the block.
-        blk = src + 1;
-        minv = blk[0];
-        maxv = blk[0];
-        minv = min(blk[2], minv); maxv = max(blk[2], maxv);
-        minv = min(blk[4], minv); maxv = max(blk[4], maxv);
-        minv = min(blk[6], minv); maxv = max(blk[6], maxv);
-        blk += stride;
-        minv = min(blk[0], minv); maxv = max(blk[0], maxv);
-        minv = min(blk[2], minv); maxv = max(blk[2], maxv);
-        minv = min(blk[4], minv); maxv = max(blk[4], maxv);
-        minv = min(blk[6], minv); maxv = max(blk[6], maxv);
-        blk += stride;
-        minv = min(blk[0], minv); maxv = max(blk[0], maxv);
-        minv = min(blk[2], minv); maxv = max(blk[2], maxv);
-        minv = min(blk[4], minv); maxv = max(blk[4], maxv);
-        minv = min(blk[6], minv); maxv = max(blk[6], maxv);
-        blk += stride;
-        minv = min(blk[0], minv); maxv = max(blk[0], maxv);
-        minv = min(blk[2], minv); maxv = max(blk[2], maxv);
-        minv = min(blk[4], minv); maxv = max(blk[4], maxv);
-        minv = min(blk[6], minv); maxv = max(blk[6], maxv);
-
-        // Now calculate the index for each pixel.
-        if (maxv > minv) {
-          fac = 7.5f / (maxv - minv);
+        squish::CompressMasked(tb, mask, dest, job._squish_flags);
+        dest += block_size;
+        continue;
+      }
+#endif  // HAVE_SQUISH
+
+      if (job._compression == CM_dxt1) {
+        encode_bc1_block(tb, binary_alpha, dest);
+
+      } else {
+        if (job._compression == CM_dxt3) {
+          encode_bc2_alpha_block(tb, dest);
         } else {
-          fac = 0;
+          // The DXT5 alpha block is encoded exactly like a BC4 block.
+          unsigned char alpha[16];
+          for (int i = 0; i < 16; ++i) {
+            alpha[i] = tb[i * 4 + 3];
+          }
+          encode_bc4_block(alpha, dest);
         }
-        add = -minv * fac;
-        blk = src + 1;
-        a = (remap[(int)(blk[0] * fac + add)])
-          | (remap[(int)(blk[2] * fac + add)] << 3)
-          | (remap[(int)(blk[4] * fac + add)] << 6)
-          | (remap[(int)(blk[6] * fac + add)] << 9);
-        blk += stride;
-        b = (remap[(int)(blk[0] * fac + add)] << 4)
-          | (remap[(int)(blk[2] * fac + add)] << 7)
-          | (remap[(int)(blk[4] * fac + add)] << 10)
-          | (remap[(int)(blk[6] * fac + add)] << 13);
-        blk += stride;
-        c = (remap[(int)(blk[0] * fac + add)])
-          | (remap[(int)(blk[2] * fac + add)] << 3)
-          | (remap[(int)(blk[4] * fac + add)] << 6)
-          | (remap[(int)(blk[6] * fac + add)] << 9);
-        blk += stride;
-        d = (remap[(int)(blk[0] * fac + add)] << 4)
-          | (remap[(int)(blk[2] * fac + add)] << 7)
-          | (remap[(int)(blk[4] * fac + add)] << 10)
-          | (remap[(int)(blk[6] * fac + add)] << 13);
-
-        *(dest++) = maxv;
-        *(dest++) = minv;
-        *(dest++) = a & 0xff;
-        *(dest++) = (a >> 8) | (b & 0xf0);
-        *(dest++) = b >> 8;
-        *(dest++) = c & 0xff;
-        *(dest++) = (c >> 8) | (d & 0xf0);
-        *(dest++) = d >> 8;
-
-        // Advance to the beginning of the next 4x4 block.
-        src += 8;
+        encode_bc1_block(tb, false, dest + 8);
       }
-      src += stride * 3;
+      dest += block_size;
     }
     Thread::consider_yield();
   }
 }
 
+/**
+ * Encodes the 16 values of a 4x4 block as an 8-byte BC4 block, which is also
+ * the format of the alpha part of a DXT5 block.
+ */
+void Texture::
+encode_bc4_block(const unsigned char values[16], unsigned char *dest) {
+  // NB. This algorithm isn't fully optimal, since it doesn't try to make use
+  // of the secondary interpolation mode supported by BC4.  This is not
+  // important for most textures, but it may be added in the future.
+  static const int remap[] = {1, 7, 6, 5, 4, 3, 2, 0};
+
+  unsigned char minv, maxv;
+  unsigned char indices[16];
+
+#ifdef TEXTURE_USE_SSE2
+  // Find the minimum and maximum value in the block.
+  __m128i v = _mm_loadu_si128((const __m128i *)values);
+  __m128i vmin = _mm_min_epu8(v, _mm_srli_si128(v, 8));
+  __m128i vmax = _mm_max_epu8(v, _mm_srli_si128(v, 8));
+  vmin = _mm_min_epu8(vmin, _mm_srli_si128(vmin, 4));
+  vmax = _mm_max_epu8(vmax, _mm_srli_si128(vmax, 4));
+  vmin = _mm_min_epu8(vmin, _mm_srli_si128(vmin, 2));
+  vmax = _mm_max_epu8(vmax, _mm_srli_si128(vmax, 2));
+  vmin = _mm_min_epu8(vmin, _mm_srli_si128(vmin, 1));
+  vmax = _mm_max_epu8(vmax, _mm_srli_si128(vmax, 1));
+  minv = (unsigned char)_mm_cvtsi128_si32(vmin);
+  maxv = (unsigned char)_mm_cvtsi128_si32(vmax);
+
+  float fac = (maxv > minv) ? 7.5f / (maxv - minv) : 0.0f;
+  float add = -minv * fac;
+
+  // Now calculate the index for each pixel, four at a time.
+  __m128 vfac = _mm_set1_ps(fac);
+  __m128 vadd = _mm_set1_ps(add);
+  __m128i zero = _mm_setzero_si128();
+  __m128i lo = _mm_unpacklo_epi8(v, zero);
+  __m128i hi = _mm_unpackhi_epi8(v, zero);
+  __m128i i0 = _mm_cvttps_epi32(_mm_add_ps(_mm_mul_ps(_mm_cvtepi32_ps(_mm_unpacklo_epi16(lo, zero)), vfac), vadd));
+  __m128i i1 = _mm_cvttps_epi32(_mm_add_ps(_mm_mul_ps(_mm_cvtepi32_ps(_mm_unpackhi_epi16(lo, zero)), vfac), vadd));
+  __m128i i2 = _mm_cvttps_epi32(_mm_add_ps(_mm_mul_ps(_mm_cvtepi32_ps(_mm_unpacklo_epi16(hi, zero)), vfac), vadd));
+  __m128i i3 = _mm_cvttps_epi32(_mm_add_ps(_mm_mul_ps(_mm_cvtepi32_ps(_mm_unpackhi_epi16(hi, zero)), vfac), vadd));
+  _mm_storeu_si128((__m128i *)indices,
+                   _mm_packus_epi16(_mm_packs_epi32(i0, i1), _mm_packs_epi32(i2, i3)));
+
+#else
+  // Find the minimum and maximum value in the block.
+  minv = values[0];
+  maxv = values[0];
+  for (int i = 1; i < 16; ++i) {
+    minv = min(values[i], minv);
+    maxv = max(values[i], maxv);
+  }
+
+  float fac = (maxv > minv) ? 7.5f / (maxv - minv) : 0.0f;
+  float add = -minv * fac;
+
+  // Now calculate the index for each pixel.
+  for (int i = 0; i < 16; ++i) {
+    indices[i] = (unsigned char)(int)(values[i] * fac + add);
+  }
+#endif  // TEXTURE_USE_SSE2
+
+  // Pack the 3-bit indices into 48 bits, first pixel in the lowest bits.
+  uint64_t bits = 0;
+  for (int i = 15; i >= 0; --i) {
+    bits = (bits << 3) | remap[indices[i]];
+  }
+
+  dest[0] = maxv;
+  dest[1] = minv;
+  for (int i = 0; i < 6; ++i) {
+    dest[i + 2] = (unsigned char)(bits >> (i * 8));
+  }
+}
+
+/**
+ * Encodes the color of a 4x4 block of RGBA pixels as an 8-byte BC1 block,
+ * which is also the color part of DXT3 and DXT5 blocks.  If binary_alpha is
+ * true, pixels with an alpha value below 128 are encoded as transparent.
+ *
+ * The endpoints are taken from the corners of the bounding box of the colors
+ * in the block, which is fast and good enough for most textures.
+ */
+void Texture::
+encode_bc1_block(const unsigned char rgba[64], bool binary_alpha,
+                 unsigned char *dest) {
+  // Find the bounding box of the opaque colors, as well as their sum.
+  int mn[3] = {255, 255, 255};
+  int mx[3] = {0, 0, 0};
+  int sum[3] = {0, 0, 0};
+  int count = 0;
+  bool transparent = false;
+  for (int i = 0; i < 16; ++i) {
+    const unsigned char *t = rgba + i * 4;
+    if (binary_alpha && t[3] < 128) {
+      transparent = true;
+      continue;
+    }
+    for (int c = 0; c < 3; ++c) {
+      mn[c] = min(mn[c], (int)t[c]);
+      mx[c] = max(mx[c], (int)t[c]);
+      sum[c] += t[c];
+    }
+    ++count;
+  }
+
+  if (count == 0) {
+    // The whole block is transparent.
+    memset(dest, 0, 4);
+    memset(dest + 4, 0xff, 4);
+    return;
+  }
+
+  // Choose the diagonal of the box that best follows the colors, by looking
+  // at the sign of the covariance of red and blue with green.
+  int cov_rg = 0;
+  int cov_bg = 0;
+  for (int i = 0; i < 16; ++i) {
+    const unsigned char *t = rgba + i * 4;
+    if (binary_alpha && t[3] < 128) {
+      continue;
+    }
+    int dg = t[1] * count - sum[1];
+    cov_rg += (t[0] * count - sum[0]) * dg;
+    cov_bg += (t[2] * count - sum[2]) * dg;
+  }
+
+  int e0[3] = {mx[0], mx[1], mx[2]};
+  int e1[3] = {mn[0], mn[1], mn[2]};
+  if (cov_rg < 0) {
+    swap(e0[0], e1[0]);
+  }
+  if (cov_bg < 0) {
+    swap(e0[2], e1[2]);
+  }
+
+  // Quantize the endpoints to 5:6:5.
+  unsigned int c0 = (((e0[0] * 31 + 127) / 255) << 11) |
+                    (((e0[1] * 63 + 127) / 255) << 5) |
+                    ((e0[2] * 31 + 127) / 255);
+  unsigned int c1 = (((e1[0] * 31 + 127) / 255) << 11) |
+                    (((e1[1] * 63 + 127) / 255) << 5) |
+                    ((e1[2] * 31 + 127) / 255);
+
+  // The order of the endpoints selects the mode: the first must be greater
+  // for four colors, or not greater for three colors plus transparency.
+  if (transparent ? (c0 > c1) : (c0 < c1)) {
+    swap(c0, c1);
+  }
+
+  // Build the palette the decoder will use from the quantized endpoints.
+  int palette[4][3];
+  unsigned int cs[2] = {c0, c1};
+  for (int e = 0; e < 2; ++e) {
+    int r = (cs[e] >> 11) & 0x1f;
+    int g = (cs[e] >> 5) & 0x3f;
+    int b = cs[e] & 0x1f;
+    palette[e][0] = (r << 3) | (r >> 2);
+    palette[e][1] = (g << 2) | (g >> 4);
+    palette[e][2] = (b << 3) | (b >> 2);
+  }
+  int num_colors;
+  if (transparent) {
+    for (int c = 0; c < 3; ++c) {
+      palette[2][c] = (palette[0][c] + palette[1][c]) / 2;
+    }
+    num_colors = 3;
+  } else {
+    for (int c = 0; c < 3; ++c) {
+      palette[2][c] = (palette[0][c] * 2 + palette[1][c]) / 3;
+      palette[3][c] = (palette[0][c] + palette[1][c] * 2) / 3;
+    }
+    num_colors = 4;
+  }
+
+  // Now pick the nearest palette entry for each pixel.
+  unsigned int indices = 0;
+  for (int i = 15; i >= 0; --i) {
+    const unsigned char *t = rgba + i * 4;
+    unsigned int best = 3;
+    if (!binary_alpha || t[3] >= 128) {
+      int best_dist = 0x7fffffff;
+      for (int p = 0; p < num_colors; ++p) {
+        int dr = t[0] - palette[p][0];
+        int dg = t[1] - palette[p][1];
+        int db = t[2] - palette[p][2];
+        int dist = dr * dr + dg * dg + db * db;
+        if (dist < best_dist) {
+          best_dist = dist;
+          best = p;
+        }
+      }
+    }
+    indices = (indices << 2) | best;
+  }
+
+  dest[0] = c0 & 0xff;
+  dest[1] = c0 >> 8;
+  dest[2] = c1 & 0xff;
+  dest[3] = c1 >> 8;
+  dest[4] = indices & 0xff;
+  dest[5] = (indices >> 8) & 0xff;
+  dest[6] = (indices >> 16) & 0xff;
+  dest[7] = indices >> 24;
+}
+
+/**
+ * Encodes the alpha of a 4x4 block of RGBA pixels as the explicit 4-bit alpha
+ * part of a DXT3 block.
+ */
+void Texture::
+encode_bc2_alpha_block(const unsigned char rgba[64], unsigned char *dest) {
+  for (int i = 0; i < 8; ++i) {
+    int a0 = (rgba[i * 8 + 3] * 15 + 127) / 255;
+    int a1 = (rgba[i * 8 + 7] * 15 + 127) / 255;
+    dest[i] = (unsigned char)(a0 | (a1 << 4));
+  }
+}
+
 /**
  * Decompresses a RAM image compressed using BC4.
  */
@@ -6567,60 +6929,29 @@ void Texture::
 do_uncompress_ram_image_bc4(const RamImage &compressed_image,
                             RamImage &uncompressed_image,
                             int x_size, int y_size, int num_pages) {
-  int x_blocks = (x_size >> 2);
-  int y_blocks = (y_size >> 2);
+  int x_blocks = (x_size + 3) >> 2;
+  int y_blocks = (y_size + 3) >> 2;
 
   for (int z = 0; z < num_pages; ++z) {
     unsigned char *dest = uncompressed_image._image.p() + z * uncompressed_image._page_size;
     unsigned const char *src = compressed_image._image.p() + z * compressed_image._page_size;
 
-    // Unconvert one 4 x 4 block at a time.
-    uint8_t tbl[8];
+    // Unconvert one 4 x 4 block at a time.  The blocks on the right and
+    // bottom edges may hang over the edge of the image.
+    unsigned char values[16];
     for (int y = 0; y < y_blocks; ++y) {
+      int rows = min(y_size - y * 4, 4);
       for (int x = 0; x < x_blocks; ++x) {
-        unsigned char *blk = dest;
-        tbl[0] = src[0];
-        tbl[1] = src[1];
-        if (tbl[0] > tbl[1]) {
-          tbl[2] = (tbl[0] * 6 + tbl[1] * 1) / 7.0f;
-          tbl[3] = (tbl[0] * 5 + tbl[1] * 2) / 7.0f;
-          tbl[4] = (tbl[0] * 4 + tbl[1] * 3) / 7.0f;
-          tbl[5] = (tbl[0] * 3 + tbl[1] * 4) / 7.0f;
-          tbl[6] = (tbl[0] * 2 + tbl[1] * 5) / 7.0f;
-          tbl[7] = (tbl[0] * 1 + tbl[1] * 6) / 7.0f;
-        } else {
-          tbl[2] = (tbl[0] * 4 + tbl[1] * 1) / 5.0f;
-          tbl[3] = (tbl[0] * 3 + tbl[1] * 2) / 5.0f;
-          tbl[4] = (tbl[0] * 2 + tbl[1] * 3) / 5.0f;
-          tbl[5] = (tbl[0] * 1 + tbl[1] * 4) / 5.0f;
-          tbl[6] = 0;
-          tbl[7] = 255;
+        int cols = min(x_size - x * 4, 4);
+        decode_bc4_block(src, values);
+        for (int j = 0; j < rows; ++j) {
+          unsigned char *blk = dest + (size_t)(y * 4 + j) * x_size + x * 4;
+          for (int i = 0; i < cols; ++i) {
+            blk[i] = values[j * 4 + i];
+          }
         }
-        int v = src[2] + (src[3] << 8) + (src[4] << 16);
-        blk[0] = tbl[v & 0x7];
-        blk[1] = tbl[(v & 0x000038) >> 3];
-        blk[2] = tbl[(v & 0x0001c0) >> 6];
-        blk[3] = tbl[(v & 0x000e00) >> 9];
-        blk += x_size;
-        blk[0] = tbl[(v & 0x007000) >> 12];
-        blk[1] = tbl[(v & 0x038000) >> 15];
-        blk[2] = tbl[(v & 0x1c0000) >> 18];
-        blk[3] = tbl[(v & 0xe00000) >> 21];
-        blk += x_size;
-        v = src[5] + (src[6] << 8) + (src[7] << 16);
-        blk[0] = tbl[v & 0x7];
-        blk[1] = tbl[(v & 0x000038) >> 3];
-        blk[2] = tbl[(v & 0x0001c0) >> 6];
-        blk[3] = tbl[(v & 0x000e00) >> 9];
-        blk += x_size;
-        blk[0] = tbl[(v & 0x007000) >> 12];
-        blk[1] = tbl[(v & 0x038000) >> 15];
-        blk[2] = tbl[(v & 0x1c0000) >> 18];
-        blk[3] = tbl[(v & 0xe00000) >> 21];
         src += 8;
-        dest += 4;
       }
-      dest += x_size * 3;
     }
     Thread::consider_yield();
   }
@@ -6633,102 +6964,74 @@ void Texture::
 do_uncompress_ram_image_bc5(const RamImage &compressed_image,
                             RamImage &uncompressed_image,
                             int x_size, int y_size, int num_pages) {
-  int x_blocks = (x_size >> 2);
-  int y_blocks = (y_size >> 2);
+  int x_blocks = (x_size + 3) >> 2;
+  int y_blocks = (y_size + 3) >> 2;
   int stride = x_size * 2;
 
   for (int z = 0; z < num_pages; ++z) {
     unsigned char *dest = uncompressed_image._image.p() + z * uncompressed_image._page_size;
     unsigned const char *src = compressed_image._image.p() + z * compressed_image._page_size;
 
-    // Unconvert one 4 x 4 block at a time.
-    uint8_t red[8];
-    uint8_t grn[8];
+    // Unconvert one 4 x 4 block at a time.  BC5 is just two BC4 blocks, one
+    // for each channel.
+    unsigned char red[16];
+    unsigned char grn[16];
     for (int y = 0; y < y_blocks; ++y) {
+      int rows = min(y_size - y * 4, 4);
       for (int x = 0; x < x_blocks; ++x) {
-        unsigned char *blk = dest;
-        red[0] = src[0];
-        red[1] = src[1];
-        if (red[0] > red[1]) {
-          red[2] = (red[0] * 6 + red[1] * 1) / 7.0f;
-          red[3] = (red[0] * 5 + red[1] * 2) / 7.0f;
-          red[4] = (red[0] * 4 + red[1] * 3) / 7.0f;
-          red[5] = (red[0] * 3 + red[1] * 4) / 7.0f;
-          red[6] = (red[0] * 2 + red[1] * 5) / 7.0f;
-          red[7] = (red[0] * 1 + red[1] * 6) / 7.0f;
-        } else {
-          red[2] = (red[0] * 4 + red[1] * 1) / 5.0f;
-          red[3] = (red[0] * 3 + red[1] * 2) / 5.0f;
-          red[4] = (red[0] * 2 + red[1] * 3) / 5.0f;
-          red[5] = (red[0] * 1 + red[1] * 4) / 5.0f;
-          red[6] = 0;
-          red[7] = 255;
-        }
-        grn[0] = src[8];
-        grn[1] = src[9];
-        if (grn[0] > grn[1]) {
-          grn[2] = (grn[0] * 6 + grn[1] * 1) / 7.0f;
-          grn[3] = (grn[0] * 5 + grn[1] * 2) / 7.0f;
-          grn[4] = (grn[0] * 4 + grn[1] * 3) / 7.0f;
-          grn[5] = (grn[0] * 3 + grn[1] * 4) / 7.0f;
-          grn[6] = (grn[0] * 2 + grn[1] * 5) / 7.0f;
-          grn[7] = (grn[0] * 1 + grn[1] * 6) / 7.0f;
-        } else {
-          grn[2] = (grn[0] * 4 + grn[1] * 1) / 5.0f;
-          grn[3] = (grn[0] * 3 + grn[1] * 2) / 5.0f;
-          grn[4] = (grn[0] * 2 + grn[1] * 3) / 5.0f;
-          grn[5] = (grn[0] * 1 + grn[1] * 4) / 5.0f;
-          grn[6] = 0;
-          grn[7] = 255;
+        int cols = min(x_size - x * 4, 4);
+        decode_bc4_block(src, red);
+        decode_bc4_block(src + 8, grn);
+        for (int j = 0; j < rows; ++j) {
+          unsigned char *blk = dest + (size_t)(y * 4 + j) * stride + x * 8;
+          for (int i = 0; i < cols; ++i) {
+            blk[i * 2] = red[j * 4 + i];
+            blk[i * 2 + 1] = grn[j * 4 + i];
+          }
         }
-        int r = src[2] + (src[3] << 8) + (src[4] << 16);
-        int g = src[10] + (src[11] << 8) + (src[12] << 16);
-        blk[0] = red[r & 0x7];
-        blk[1] = grn[g & 0x7];
-        blk[2] = red[(r & 0x000038) >> 3];
-        blk[3] = grn[(g & 0x000038) >> 3];
-        blk[4] = red[(r & 0x0001c0) >> 6];
-        blk[5] = grn[(g & 0x0001c0) >> 6];
-        blk[6] = red[(r & 0x000e00) >> 9];
-        blk[7] = grn[(g & 0x000e00) >> 9];
-        blk += stride;
-        blk[0] = red[(r & 0x007000) >> 12];
-        blk[1] = grn[(g & 0x007000) >> 12];
-        blk[2] = red[(r & 0x038000) >> 15];
-        blk[3] = grn[(g & 0x038000) >> 15];
-        blk[4] = red[(r & 0x1c0000) >> 18];
-        blk[5] = grn[(g & 0x1c0000) >> 18];
-        blk[6] = red[(r & 0xe00000) >> 21];
-        blk[7] = grn[(g & 0xe00000) >> 21];
-        blk += stride;
-        r = src[5] + (src[6] << 8) + (src[7] << 16);
-        g = src[13] + (src[14] << 8) + (src[15] << 16);
-        blk[0] = red[r & 0x7];
-        blk[1] = grn[g & 0x7];
-        blk[2] = red[(r & 0x000038) >> 3];
-        blk[3] = grn[(g & 0x000038) >> 3];
-        blk[4] = red[(r & 0x0001c0) >> 6];
-        blk[5] = grn[(g & 0x0001c0) >> 6];
-        blk[6] = red[(r & 0x000e00) >> 9];
-        blk[7] = grn[(g & 0x000e00) >> 9];
-        blk += stride;
-        blk[0] = red[(r & 0x007000) >> 12];
-        blk[1] = grn[(g & 0x007000) >> 12];
-        blk[2] = red[(r & 0x038000) >> 15];
-        blk[3] = grn[(g & 0x038000) >> 15];
-        blk[4] = red[(r & 0x1c0000) >> 18];
-        blk[5] = grn[(g & 0x1c0000) >> 18];
-        blk[6] = red[(r & 0xe00000) >> 21];
-        blk[7] = grn[(g & 0xe00000) >> 21];
         src += 16;
-        dest += 8;
       }
-      dest += stride * 3;
     }
     Thread::consider_yield();
   }
 }
 
+/**
+ * Decodes an 8-byte BC4 block into the 16 values of a 4x4 block.
+ */
+void Texture::
+decode_bc4_block(const unsigned char *src, unsigned char values[16]) {
+  uint8_t tbl[8];
+  tbl[0] = src[0];
+  tbl[1] = src[1];
+  if (tbl[0] > tbl[1]) {
+    tbl[2] = (tbl[0] * 6 + tbl[1] * 1) / 7.0f;
+    tbl[3] = (tbl[0] * 5 + tbl[1] * 2) / 7.0f;
+    tbl[4] = (tbl[0] * 4 + tbl[1] * 3) / 7.0f;
+    tbl[5] = (tbl[0] * 3 + tbl[1] * 4) / 7.0f;
+    tbl[6] = (tbl[0] * 2 + tbl[1] * 5) / 7.0f;
+    tbl[7] = (tbl[0] * 1 + tbl[1] * 6) / 7.0f;
+  } else {
+    tbl[2] = (tbl[0] * 4 + tbl[1] * 1) / 5.0f;
+    tbl[3] = (tbl[0] * 3 + tbl[1] * 2) / 5.0f;
+    tbl[4] = (tbl[0] * 2 + tbl[1] * 3) / 5.0f;
+    tbl[5] = (tbl[0] * 1 + tbl[1] * 4) / 5.0f;
+    tbl[6] = 0;
+    tbl[7] = 255;
+  }
+
+  // The 3-bit indices are packed into 48 bits, first pixel in the lowest
+  // bits.
+  int v = src[2] + (src[3] << 8) + (src[4] << 16);
+  for (int i = 0; i < 8; ++i) {
+    values[i] = tbl[(v >> (i * 3)) & 0x7];
+  }
+  v = src[5] + (src[6] << 8) + (src[7] << 16);
+  for (int i = 0; i < 8; ++i) {
+    values[i + 8] = tbl[(v >> (i * 3)) & 0x7];
+  }
+}
+
 /**
  *
  */
@@ -6759,6 +7062,47 @@ do_has_all_ram_mipmap_images(const CData *cdata) const {
   return true;
 }
 
+/**
+ * Drops the highest-resolution mipmap levels from the RAM image, so that the
+ * indicated number of levels are missing relative to the full-resolution
+ * image, generating the mipmap levels first if necessary.  The texture size
+ * is reduced accordingly.  Does nothing if the image already has fewer
+ * levels than that.
+ *
+ * Assumes the lock is already held.
+ */
+void Texture::
+do_trim_to_stream_level(CData *cdata, int level) {
+  int delta = level - cdata->_stream_level;
+  if (delta <= 0 || !do_has_ram_image(cdata)) {
+    return;
+  }
+
+  if (!do_has_all_ram_mipmap_images(cdata)) {
+    do_generate_ram_mipmap_images(cdata, true);
+  }
+
+  // Always keep at least the smallest level.
+  delta = min(delta, (int)cdata->_ram_images.size() - 1);
+  if (delta <= 0) {
+    return;
+  }
+
+  int x_size = do_get_expected_mipmap_x_size(cdata, delta);
+  int y_size = do_get_expected_mipmap_y_size(cdata, delta);
+  int z_size = do_get_expected_mipmap_z_size(cdata, delta);
+
+  cdata->_ram_images.erase(cdata->_ram_images.begin(),
+                           cdata->_ram_images.begin() + delta);
+  cdata->_x_size = x_size;
+  cdata->_y_size = y_size;
+  cdata->_z_size = z_size;
+  cdata->_stream_level += delta;
+
+  cdata->inc_properties_modified();
+  cdata->inc_image_modified();
+}
+
 /**
  * Considers whether the z_size (or num_views) should automatically be
  * adjusted when the user loads a new page.  Returns true if the z size is
@@ -9399,7 +9743,6 @@ do_filter_2d_mipmap_pages(const CData *cdata,
   }
 
   size_t pixel_size = cdata->_num_components * cdata->_component_width;
-  size_t row_size = (size_t)x_size * pixel_size;
 
   int to_x_size = max(x_size >> 1, 1);
   int to_y_size = max(y_size >> 1, 1);
@@ -9408,94 +9751,132 @@ do_filter_2d_mipmap_pages(const CData *cdata,
   to._page_size = (size_t)to_y_size * to_row_size;
   to._image = PTA_uchar::empty_array(to._page_size * cdata->_z_size * cdata->_num_views, get_class_type());
 
-  bool alpha = has_alpha(cdata->_format);
-  int num_color_components = cdata->_num_components;
-  if (alpha) {
+  int num_pages = cdata->_z_size * cdata->_num_views;
+  nassertv(from._page_size >= (size_t)x_size * (size_t)y_size * pixel_size);
+  nassertv(from._image.size() >= from._page_size * num_pages);
+
+  ImageJob job {};
+  job._func = &filter_2d_rows;
+  job._x_size = x_size;
+  job._y_size = y_size;
+  job._num_components = cdata->_num_components;
+  job._pixel_size = pixel_size;
+  job._filter_component = filter_component;
+  job._filter_alpha = filter_alpha;
+  job._alpha = has_alpha(cdata->_format);
+
+  // Each page is divided into strips of rows, which may be filtered in
+  // parallel.
+  ImageJobs jobs;
+  for (int z = 0; z < num_pages; ++z) {
+    job._src = from._image.p() + z * from._page_size;
+    job._dest = to._image.p() + z * to._page_size;
+    add_image_jobs(jobs, job, to_y_size, (size_t)to_x_size * 4);
+  }
+
+  run_image_jobs(jobs, (size_t)x_size * (size_t)y_size * (size_t)num_pages);
+}
+
+/**
+ * Generates a range of rows of one page of the next mipmap level, as
+ * described by the job.  This may be called from any thread.
+ */
+void Texture::
+filter_2d_rows(const ImageJob &job) {
+  size_t pixel_size = job._pixel_size;
+  size_t row_size = (size_t)job._x_size * pixel_size;
+  int to_x_size = max(job._x_size >> 1, 1);
+  size_t to_row_size = (size_t)to_x_size * pixel_size;
+
+  // If the previous level is only one pixel wide or high, each pixel is
+  // averaged with itself in that direction.  An odd last pixel or row is
+  // skipped.
+  size_t pixel_step = (job._x_size != 1) ? pixel_size : 0;
+  size_t row_step = (job._y_size != 1) ? row_size : 0;
+
+  int num_color_components = job._num_components;
+  if (job._alpha) {
     --num_color_components;
   }
 
-  int num_pages = cdata->_z_size * cdata->_num_views;
-  for (int z = 0; z < num_pages; ++z) {
-    // For each level.
-    unsigned char *p = to._image.p() + z * to._page_size;
-    nassertv(p <= to._image.p() + to._image.size() + to._page_size);
-    const unsigned char *q = from._image.p() + z * from._page_size;
-    nassertv(q <= from._image.p() + from._image.size() + from._page_size);
-    if (y_size != 1) {
-      int y;
-      for (y = 0; y < y_size - 1; y += 2) {
-        // For each row.
-        nassertv(p == to._image.p() + z * to._page_size + (y / 2) * to_row_size);
-        nassertv(q == from._image.p() + z * from._page_size + y * row_size);
-        if (x_size != 1) {
-          int x;
-          for (x = 0; x < x_size - 1; x += 2) {
-            // For each pixel.
-            for (int c = 0; c < num_color_components; ++c) {
-              // For each component.
-              filter_component(p, q, pixel_size, row_size);
-            }
-            if (alpha) {
-              filter_alpha(p, q, pixel_size, row_size);
-            }
-            q += pixel_size;
-          }
-          if (x < x_size) {
-            // Skip the last odd pixel.
-            q += pixel_size;
-          }
-        } else {
-          // Just one pixel.
-          for (int c = 0; c < num_color_components; ++c) {
-            // For each component.
-            filter_component(p, q, 0, row_size);
-          }
-          if (alpha) {
-            filter_alpha(p, q, 0, row_size);
-          }
-        }
-        q += row_size;
-        Thread::consider_yield();
-      }
-      if (y < y_size) {
-        // Skip the last odd row.
-        q += row_size;
+  for (int y = job._begin; y < job._end; ++y) {
+    // For each row.
+    unsigned char *p = job._dest + (size_t)y * to_row_size;
+    const unsigned char *q = job._src + (size_t)y * 2 * row_step;
+    int x = 0;
+
+#ifdef TEXTURE_USE_SSE2
+    if (job._filter_component == &filter_2d_unsigned_byte &&
+        job._filter_alpha == &filter_2d_unsigned_byte &&
+        pixel_step != 0 && row_step != 0) {
+      x = filter_2d_row_unsigned_byte_sse2(p, q, pixel_size, row_size, to_x_size);
+      p += x * pixel_size;
+      q += x * 2 * pixel_size;
+    }
+#endif  // TEXTURE_USE_SSE2
+
+    for (; x < to_x_size; ++x) {
+      // For each pixel.
+      for (int c = 0; c < num_color_components; ++c) {
+        // For each component.
+        job._filter_component(p, q, pixel_step, row_step);
       }
-    } else {
-      // Just one row.
-      if (x_size != 1) {
-        int x;
-        for (x = 0; x < x_size - 1; x += 2) {
-          // For each pixel.
-          for (int c = 0; c < num_color_components; ++c) {
-            // For each component.
-            filter_component(p, q, pixel_size, 0);
-          }
-          if (alpha) {
-            filter_alpha(p, q, pixel_size, 0);
-          }
-          q += pixel_size;
-        }
-        if (x < x_size) {
-          // Skip the last odd pixel.
-          q += pixel_size;
-        }
-      } else {
-        // Just one pixel.
-        for (int c = 0; c < num_color_components; ++c) {
-          // For each component.
-          filter_component(p, q, 0, 0);
-        }
-        if (alpha) {
-          filter_alpha(p, q, pixel_size, 0);
-        }
+      if (job._alpha) {
+        job._filter_alpha(p, q, pixel_step, row_step);
       }
+      q += pixel_step;
     }
+    Thread::consider_yield();
+  }
+}
 
-    nassertv(p == to._image.p() + (z + 1) * to._page_size);
-    nassertv(q == from._image.p() + (z + 1) * from._page_size);
+#ifdef TEXTURE_USE_SSE2
+/**
+ * Averages the 2x2 blocks of a pair of rows of unsigned byte pixels into a
+ * row of the next mipmap level, like filter_2d_unsigned_byte() does, but
+ * several pixels at a time.  Handles only 1- and 4-byte pixels.  Returns the
+ * number of destination pixels that were written; the caller should filter
+ * the remaining pixels, if any.
+ */
+int Texture::
+filter_2d_row_unsigned_byte_sse2(unsigned char *p, const unsigned char *q,
+                                 size_t pixel_size, size_t row_size,
+                                 int to_x_size) {
+  const __m128i zero = _mm_setzero_si128();
+  int x = 0;
+
+  if (pixel_size == 4) {
+    // Each iteration reduces four pixels from each row to two pixels.
+    for (; x + 2 <= to_x_size; x += 2) {
+      __m128i r0 = _mm_loadu_si128((const __m128i *)q);
+      __m128i r1 = _mm_loadu_si128((const __m128i *)(q + row_size));
+      __m128i lo = _mm_add_epi16(_mm_unpacklo_epi8(r0, zero), _mm_unpacklo_epi8(r1, zero));
+      __m128i hi = _mm_add_epi16(_mm_unpackhi_epi8(r0, zero), _mm_unpackhi_epi8(r1, zero));
+      __m128i sum = _mm_add_epi16(_mm_unpacklo_epi64(lo, hi), _mm_unpackhi_epi64(lo, hi));
+      sum = _mm_srli_epi16(sum, 2);
+      _mm_storel_epi64((__m128i *)p, _mm_packus_epi16(sum, sum));
+      p += 8;
+      q += 16;
+    }
+
+  } else if (pixel_size == 1) {
+    // Each iteration reduces sixteen pixels from each row to eight pixels.
+    const __m128i mask = _mm_set1_epi16(0xff);
+    for (; x + 8 <= to_x_size; x += 8) {
+      __m128i r0 = _mm_loadu_si128((const __m128i *)q);
+      __m128i r1 = _mm_loadu_si128((const __m128i *)(q + row_size));
+      __m128i sum = _mm_add_epi16(_mm_add_epi16(_mm_and_si128(r0, mask), _mm_srli_epi16(r0, 8)),
+                                  _mm_add_epi16(_mm_and_si128(r1, mask), _mm_srli_epi16(r1, 8)));
+      sum = _mm_srli_epi16(sum, 2);
+      _mm_storel_epi64((__m128i *)p, _mm_packus_epi16(sum, sum));
+      p += 8;
+      q += 16;
+    }
   }
+
+  return x;
 }
+#endif  // TEXTURE_USE_SSE2
 
 /**
  * Generates the next mipmap level from the previous one, treating all the
@@ -9925,97 +10306,6 @@ filter_3d_float(unsigned char *&p, const unsigned char *&q,
   q += 4;
 }
 
-/**
- * Invokes the squish library to compress the RAM image(s).
- */
-bool Texture::
-do_squish(CData *cdata, Texture::CompressionMode compression, int squish_flags) {
-#ifdef HAVE_SQUISH
-  if (!do_has_all_ram_mipmap_images(cdata)) {
-    // If we're about to compress the RAM image, we should ensure that we have
-    // all of the mipmap levels first.
-    do_generate_ram_mipmap_images(cdata, false);
-  }
-
-  RamImages compressed_ram_images;
-  compressed_ram_images.reserve(cdata->_ram_images.size());
-  for (size_t n = 0; n < cdata->_ram_images.size(); ++n) {
-    RamImage compressed_image;
-    int x_size = do_get_expected_mipmap_x_size(cdata, n);
-    int y_size = do_get_expected_mipmap_y_size(cdata, n);
-    int num_pages = do_get_expected_mipmap_num_pages(cdata, n);
-    int page_size = squish::GetStorageRequirements(x_size, y_size, squish_flags);
-    int cell_size = squish::GetStorageRequirements(4, 4, squish_flags);
-
-    compressed_image._page_size = page_size;
-    compressed_image._image = PTA_uchar::empty_array(page_size * num_pages);
-    for (int z = 0; z < num_pages; ++z) {
-      unsigned char *dest_page = compressed_image._image.p() + z * page_size;
-      unsigned const char *source_page = cdata->_ram_images[n]._image.p() + z * cdata->_ram_images[n]._page_size;
-      unsigned const char *source_page_end = source_page + cdata->_ram_images[n]._page_size;
-      // Convert one 4 x 4 cell at a time.
-      unsigned char *d = dest_page;
-      for (int y = 0; y < y_size; y += 4) {
-        for (int x = 0; x < x_size; x += 4) {
-          unsigned char tb[16 * 4];
-          int mask = 0;
-          unsigned char *t = tb;
-          for (int i = 0; i < 16; ++i) {
-            int xi = x + i % 4;
-            int yi = y + i / 4;
-            unsigned const char *s = source_page + (yi * x_size + xi) * cdata->_num_components;
-            if (s < source_page_end) {
-              switch (cdata->_num_components) {
-              case 1:
-                t[0] = s[0];   // r
-                t[1] = s[0];   // g
-                t[2] = s[0];   // b
-                t[3] = 255;    // a
-                break;
-
-              case 2:
-                t[0] = s[0];   // r
-                t[1] = s[0];   // g
-                t[2] = s[0];   // b
-                t[3] = s[1];   // a
-                break;
-
-              case 3:
-                t[0] = s[2];   // r
-                t[1] = s[1];   // g
-                t[2] = s[0];   // b
-                t[3] = 255;    // a
-                break;
-
-              case 4:
-                t[0] = s[2];   // r
-                t[1] = s[1];   // g
-                t[2] = s[0];   // b
-                t[3] = s[3];   // a
-                break;
-              }
-              mask |= (1 << i);
-            }
-            t += 4;
-          }
-          squish::CompressMasked(tb, mask, d, squish_flags);
-          d += cell_size;
-          Thread::consider_yield();
-        }
-      }
-    }
-    compressed_ram_images.push_back(compressed_image);
-  }
-  cdata->_ram_images.swap(compressed_ram_images);
-  cdata->_ram_image_compression = compression;
-  return true;
-
-#else  // HAVE_SQUISH
-  return false;
-
-#endif  // HAVE_SQUISH
-}
-
 /**
  * Invokes the squish library to uncompress the RAM image(s).
  */
@@ -10804,6 +11094,9 @@ CData() {
 
   _has_clear_color = false;
 
+  _stream_level = 0;
+  _streamed = false;
+
   _modified_pages.resize(1);
   _modified_pages[0]._z_end = (size_t)-1;
   _modified_pages[0]._modified = _image_modified;
@@ -10873,6 +11166,8 @@ do_assign(const Texture::CData *copy) {
   _auto_texture_scale = copy->_auto_texture_scale;
   _ram_image_compression = copy->_ram_image_compression;
   _ram_images = copy->_ram_images;
+  _stream_level = copy->_stream_level;
+  _streamed = copy->_streamed;
   _simple_x_size = copy->_simple_x_size;
   _simple_y_size = copy->_simple_y_size;
   _simple_ram_image = copy->_simple_ram_image;
@@ -53,6 +53,7 @@ class PreparedGraphicsObjects;
 class CullTraverser;
 class CullTraverserData;
 class TexturePeeker;
+class GenericAsyncTask;
 struct DDSHeader;
 
 /**
@@ -469,9 +470,14 @@ PUBLISHED:
   virtual bool get_keep_ram_image() const;
   virtual bool is_cacheable() const;
 
+  INLINE int get_stream_level() const;
+  INLINE bool is_streamed() const;
+
   MAKE_PROPERTY(ram_image_compression, get_ram_image_compression);
   MAKE_PROPERTY(keep_ram_image, get_keep_ram_image, set_keep_ram_image);
   MAKE_PROPERTY(cacheable, is_cacheable);
+  MAKE_PROPERTY(stream_level, get_stream_level);
+  MAKE_PROPERTY(streamed, is_streamed);
 
   BLOCKING INLINE bool compress_ram_image(CompressionMode compression = CM_on,
                                           QualityLevel quality_level = QL_default,
@@ -623,6 +629,10 @@ PUBLISHED:
 public:
   void texture_uploaded();
 
+  void set_streamed(bool streamed);
+  bool set_stream_level(int level);
+  bool load_stream_level(int level);
+
   virtual bool has_cull_callback() const;
   virtual bool cull_callback(CullTraverser *trav, const CullTraverserData &data) const;
 
@@ -713,15 +723,14 @@ protected:
                              GraphicsStateGuardianBase *gsg);
   bool do_uncompress_ram_image(CData *cdata);
 
-  static void do_compress_ram_image_bc4(const RamImage &src, RamImage &dest,
-                                        int x_size, int y_size, int z_size);
-  static void do_compress_ram_image_bc5(const RamImage &src, RamImage &dest,
-                                        int x_size, int y_size, int z_size);
+  bool do_compress_ram_image_blocks(CData *cdata, CompressionMode compression,
+                                    int squish_flags);
   static void do_uncompress_ram_image_bc4(const RamImage &src, RamImage &dest,
                                           int x_size, int y_size, int z_size);
   static void do_uncompress_ram_image_bc5(const RamImage &src, RamImage &dest,
                                           int x_size, int y_size, int z_size);
   bool do_has_all_ram_mipmap_images(const CData *cdata) const;
+  void do_trim_to_stream_level(CData *cdata, int level);
 
   bool do_reconsider_z_size(CData *cdata, int z, const LoaderOptions &options);
   virtual void do_allocate_pages(CData *cdata);
@@ -928,7 +937,57 @@ private:
   static void filter_3d_float(unsigned char *&p, const unsigned char *&q,
                               size_t pixel_size, size_t row_size, size_t page_size);
 
-  bool do_squish(CData *cdata, CompressionMode compression, int squish_flags);
+  // Describes a range of rows (or rows of blocks) of one page of a RAM image,
+  // which can be processed independently of any other range.
+  class ImageJob {
+  public:
+    void (*_func)(const ImageJob &job);
+    const unsigned char *_src;
+    unsigned char *_dest;
+    int _x_size;
+    int _y_size;
+    int _begin;
+    int _end;
+    int _num_components;
+    size_t _pixel_size;
+    CompressionMode _compression;
+    int _squish_flags;
+    Filter2DComponent *_filter_component;
+    Filter2DComponent *_filter_alpha;
+    bool _alpha;
+  };
+  typedef pvector<ImageJob> ImageJobs;
+
+  class ImageJobGroup {
+  public:
+    const ImageJobs *_jobs;
+    size_t _first;
+    size_t _step;
+  };
+
+  static void add_image_jobs(ImageJobs &jobs, const ImageJob &job,
+                             int num_rows, size_t row_pixels);
+  static void run_image_jobs(const ImageJobs &jobs, size_t num_pixels);
+  static void do_image_job_group(const ImageJobGroup &group);
+  static AsyncTask::DoneStatus image_job_task(GenericAsyncTask *task,
+                                              void *user_data);
+
+  static void filter_2d_rows(const ImageJob &job);
+  static int filter_2d_row_unsigned_byte_sse2(unsigned char *p,
+                                              const unsigned char *q,
+                                              size_t pixel_size,
+                                              size_t row_size, int to_x_size);
+  static void compress_rgtc_rows(const ImageJob &job);
+  static void compress_dxt_rows(const ImageJob &job);
+  static void encode_bc4_block(const unsigned char values[16],
+                               unsigned char *dest);
+  static void decode_bc4_block(const unsigned char *src,
+                               unsigned char values[16]);
+  static void encode_bc1_block(const unsigned char rgba[64],
+                               bool binary_alpha, unsigned char *dest);
+  static void encode_bc2_alpha_block(const unsigned char rgba[64],
+                                     unsigned char *dest);
+
   bool do_unsquish(CData *cdata, int squish_flags);
 
 protected:
@@ -1014,6 +1073,13 @@ protected:
     // mipmap levels.
     RamImages _ram_images;
 
+    // The number of highest-resolution mipmap levels that have been dropped
+    // from the RAM image (and from _x_size etc.) by the TextureStreamer.  If
+    // _streamed is true, this many levels are dropped again whenever the
+    // image is reloaded.
+    int _stream_level;
+    bool _streamed;
+
     // This is the simple image, which may be loaded before the texture is
     // loaded from disk.  It exists only for 2-d textures.
     RamImage _simple_ram_image;
@@ -23,6 +23,7 @@
 #include "bamCacheRecord.h"
 #include "pnmFileTypeRegistry.h"
 #include "texturePoolFilter.h"
+#include "textureStreamer.h"
 #include "configVariableList.h"
 #include "load_dso.h"
 #include "mutexHolder.h"
@@ -425,11 +426,7 @@ ns_load_texture(const Filename &orig_filename, int primary_file_num_channels,
   }
 
   if (cache->get_cache_compressed_textures() && tex->has_compression()) {
-#ifndef HAVE_SQUISH
-    bool needs_driver_compression = true;
-#else
     bool needs_driver_compression = driver_compress_textures;
-#endif // HAVE_SQUISH
     if (needs_driver_compression) {
       // We don't want to save the uncompressed version; we'll save the
       // compressed version when it becomes available.
@@ -478,6 +475,11 @@ ns_load_texture(const Filename &orig_filename, int primary_file_num_channels,
     tex->clear_ram_image();
   }
 
+  if (texture_streaming) {
+    // Start out with only the mipmap tail resident.
+    TextureStreamer::get_global_ptr()->add_texture(tex);
+  }
+
   nassertr(!tex->get_fullpath().empty(), tex);
 
   // Finally, apply any post-loading texture filters.
@@ -559,11 +561,7 @@ ns_load_texture(const Filename &orig_filename,
   }
 
   if (cache->get_cache_compressed_textures() && tex->has_compression()) {
-#ifndef HAVE_SQUISH
-    bool needs_driver_compression = true;
-#else
     bool needs_driver_compression = driver_compress_textures;
-#endif // HAVE_SQUISH
     if (needs_driver_compression) {
       // We don't want to save the uncompressed version; we'll save the
       // compressed version when it becomes available.
@@ -613,6 +611,11 @@ ns_load_texture(const Filename &orig_filename,
     tex->clear_ram_image();
   }
 
+  if (texture_streaming) {
+    // Start out with only the mipmap tail resident.
+    TextureStreamer::get_global_ptr()->add_texture(tex);
+  }
+
   nassertr(!tex->get_fullpath().empty(), tex);
 
   // Finally, apply any post-loading texture filters.
@@ -674,11 +677,7 @@ ns_load_3d_texture(const Filename &filename_pattern,
   }
 
   if (cache->get_cache_compressed_textures() && tex->has_compression()) {
-#ifndef HAVE_SQUISH
-    bool needs_driver_compression = true;
-#else
     bool needs_driver_compression = driver_compress_textures;
-#endif // HAVE_SQUISH
     if (needs_driver_compression) {
       // We don't want to save the uncompressed version; we'll save the
       // compressed version when it becomes available.
@@ -776,11 +775,7 @@ ns_load_2d_texture_array(const Filename &filename_pattern,
   }
 
   if (cache->get_cache_compressed_textures() && tex->has_compression()) {
-#ifndef HAVE_SQUISH
-    bool needs_driver_compression = true;
-#else
     bool needs_driver_compression = driver_compress_textures;
-#endif // HAVE_SQUISH
     if (needs_driver_compression) {
       // We don't want to save the uncompressed version; we'll save the
       // compressed version when it becomes available.
@@ -878,11 +873,7 @@ ns_load_cube_map(const Filename &filename_pattern, bool read_mipmaps,
   }
 
   if (cache->get_cache_compressed_textures() && tex->has_compression()) {
-#ifndef HAVE_SQUISH
-    bool needs_driver_compression = true;
-#else
     bool needs_driver_compression = driver_compress_textures;
-#endif // HAVE_SQUISH
     if (needs_driver_compression) {
       // We don't want to save the uncompressed version; we'll save the
       // compressed version when it becomes available.
@@ -0,0 +1,521 @@
+/**
+ * PANDA 3D SOFTWARE
+ * Copyright (c) Carnegie Mellon University.  All rights reserved.
+ *
+ * All use of this software is subject to the terms of the revised BSD
+ * license.  You should have received a copy of this license along
+ * with this source code in a file named "LICENSE."
+ *
+ * @file textureStreamer.cxx
+ * @author djs3000
+ * @date 2026-10-16
+ */
+
+#include "textureStreamer.h"
+#include "config_gobj.h"
+#include "lightMutexHolder.h"
+#include "asyncTaskManager.h"
+#include "genericAsyncTask.h"
+#include "pStatCollector.h"
+#include "pStatTimer.h"
+#include "configVariableInt64.h"
+
+#include <algorithm>
+#include <queue>
+
+ConfigVariableInt64 texture_stream_budget
+("texture-stream-budget", -1,
+ PRC_DESC("Specifies the maximum number of bytes of texture memory that all "
+          "streamed textures together may occupy.  When the budget is "
+          "exceeded, the textures that have the most texels per pixel on "
+          "screen are reduced first.  The mipmap tail of each texture is "
+          "always kept, regardless of the budget.  Set it to -1 for no "
+          "limit."));
+
+ConfigVariableInt texture_stream_min_size
+("texture-stream-min-size", 64,
+ PRC_DESC("Streamed textures keep at least the mipmap levels that are this "
+          "many pixels or smaller on a side resident, and drop down to these "
+          "levels when they have not been seen for a while."));
+
+ConfigVariableInt texture_stream_threads
+("texture-stream-threads", 1,
+ PRC_DESC("The number of threads that reload streamed textures at a higher "
+          "or lower resolution in the background.  If this is 0, the "
+          "reloads are instead performed when the global AsyncTaskManager "
+          "is polled."));
+
+ConfigVariableInt texture_stream_max_loads
+("texture-stream-max-loads", 4,
+ PRC_DESC("The maximum number of streamed textures that may be reloading at "
+          "the same time.  The textures that appear largest on screen are "
+          "reloaded first."));
+
+ConfigVariableInt texture_stream_evict_frames
+("texture-stream-evict-frames", 60,
+ PRC_DESC("The number of frames a streamed texture may go unseen before it "
+          "is reduced to its mipmap tail."));
+
+static PStatCollector _update_pcollector("App:Texture streaming");
+
+TextureStreamer *TextureStreamer::_global_ptr = nullptr;
+
+/**
+ *
+ */
+TextureStreamer::
+TextureStreamer() :
+  _memory_budget((size_t)texture_stream_budget.get_value()),
+  _frame(0)
+{
+}
+
+/**
+ * Starts managing the resolution of the indicated texture, and immediately
+ * reduces it to its mipmap tail, if this can be done without rereading it.
+ * Returns true if the texture was added, or false if it is not eligible for
+ * streaming or was already added.
+ *
+ * Unless texture-streaming is set, the texture should be added before it is
+ * first rendered, since the RenderStates that have already been culled with
+ * it will not report its size on screen.
+ */
+bool TextureStreamer::
+add_texture(Texture *tex) {
+  nassertr(tex != nullptr, false);
+
+  // We can only stream textures that can be reloaded from disk, at a lower
+  // resolution, as many times as we like.
+  if (tex->get_type() != Texture::get_class_type() ||
+      !tex->has_fullpath() || !tex->uses_mipmaps() ||
+      tex->get_texture_type() == Texture::TT_buffer_texture ||
+      tex->get_stream_level() != 0) {
+    return false;
+  }
+
+  int x_size = tex->get_x_size();
+  int y_size = tex->get_y_size();
+  int z_size = tex->get_z_size();
+  bool is_3d = (tex->get_texture_type() == Texture::TT_3d_texture);
+  int num_pages = tex->get_num_views() * (is_3d ? 1 : z_size);
+
+  // Estimate the number of bytes per texel from the RAM image, if we have
+  // it, since it may be compressed.
+  double texel_size = tex->get_num_components() * tex->get_component_width();
+  if (tex->has_ram_image() && x_size * y_size * z_size > 0) {
+    texel_size = (double)tex->get_ram_mipmap_page_size(0) /
+      ((double)x_size * y_size * (is_3d ? z_size : 1));
+  }
+
+  Entry entry;
+  entry._texture = tex;
+  entry._max_dimension = std::max(x_size, y_size);
+  entry._level = 0;
+  entry._min_level = 0;
+  entry._screen_size = 0;
+  entry._last_screen_size = 0;
+  entry._last_seen_frame = -1;
+
+  // Tabulate the cumulative size of the mipmap chain from each level down.
+  pvector<size_t> sizes;
+  int n = 0;
+  while (true) {
+    int x = std::max(x_size >> n, 1);
+    int y = std::max(y_size >> n, 1);
+    int z = is_3d ? std::max(z_size >> n, 1) : num_pages;
+    sizes.push_back((size_t)(texel_size * x * y * z));
+    if (x == 1 && y == 1 && (!is_3d || z == 1)) {
+      break;
+    }
+    ++n;
+  }
+  entry._level_sizes.resize(sizes.size());
+  size_t total = 0;
+  for (int i = (int)sizes.size() - 1; i >= 0; --i) {
+    total += sizes[i];
+    entry._level_sizes[i] = total;
+  }
+
+  int min_size = std::max((int)texture_stream_min_size, 1);
+  entry._tail_level = 0;
+  while (entry._tail_level + 1 < (int)sizes.size() &&
+         (entry._max_dimension >> entry._tail_level) > min_size) {
+    ++entry._tail_level;
+  }
+  entry._target_level = entry._tail_level;
+
+  LightMutexHolder holder(_lock);
+  Entries::iterator ei = _entries.find(tex);
+  if (ei != _entries.end()) {
+    if (!(*ei).second._texture.was_deleted()) {
+      return false;
+    }
+    // This is a stale entry for a deleted texture that happened to have the
+    // same address.
+    _entries.erase(ei);
+  }
+
+  tex->set_streamed(true);
+  if (tex->set_stream_level(entry._tail_level)) {
+    entry._level = entry._tail_level;
+  }
+  _entries[tex] = std::move(entry);
+  return true;
+}
+
+/**
+ * Stops managing the resolution of the indicated texture.  The texture keeps
+ * whatever resolution it currently has; it returns to its full resolution the
+ * next time it is reloaded.  Returns true if the texture was being managed.
+ */
+bool TextureStreamer::
+remove_texture(Texture *tex) {
+  LightMutexHolder holder(_lock);
+  Entries::iterator ei = _entries.find(tex);
+  if (ei == _entries.end()) {
+    return false;
+  }
+  bool was_deleted = (*ei).second._texture.was_deleted();
+  _entries.erase(ei);
+  if (was_deleted) {
+    return false;
+  }
+  tex->set_streamed(false);
+  return true;
+}
+
+/**
+ * Returns true if the indicated texture is being managed by this streamer.
+ */
+bool TextureStreamer::
+has_texture(Texture *tex) const {
+  LightMutexHolder holder(_lock);
+  Entries::const_iterator ei = _entries.find(tex);
+  return ei != _entries.end() && !(*ei).second._texture.was_deleted();
+}
+
+/**
+ * Returns the number of textures being managed by this streamer.
+ */
+size_t TextureStreamer::
+get_num_textures() const {
+  LightMutexHolder holder(_lock);
+  return _entries.size();
+}
+
+/**
+ * Sets the maximum number of bytes that all of the streamed textures together
+ * may occupy.  This is initialized from texture-stream-budget.  Pass
+ * (size_t)-1 for no limit.
+ */
+void TextureStreamer::
+set_memory_budget(size_t budget) {
+  LightMutexHolder holder(_lock);
+  _memory_budget = budget;
+}
+
+/**
+ * Returns the maximum number of bytes that all of the streamed textures
+ * together may occupy.  See set_memory_budget().
+ */
+size_t TextureStreamer::
+get_memory_budget() const {
+  LightMutexHolder holder(_lock);
+  return _memory_budget;
+}
+
+/**
+ * Returns the estimated number of bytes occupied by all of the streamed
+ * textures at their current resolution.
+ */
+size_t TextureStreamer::
+get_resident_size() const {
+  LightMutexHolder holder(_lock);
+  size_t total = 0;
+  for (const auto &item : _entries) {
+    const Entry &entry = item.second;
+    total += entry._level_sizes[std::min(entry._level, (int)entry._level_sizes.size() - 1)];
+  }
+  return total;
+}
+
+/**
+ * Returns the number of textures that are currently being reloaded at a
+ * different resolution.
+ */
+size_t TextureStreamer::
+get_num_pending() const {
+  LightMutexHolder holder(_lock);
+  size_t count = 0;
+  for (const auto &item : _entries) {
+    if (item.second._task != nullptr) {
+      ++count;
+    }
+  }
+  return count;
+}
+
+/**
+ * Reports that the indicated texture was seen during the cull traversal,
+ * applied to an object that is the indicated number of pixels across on
+ * screen.  This is normally called by the TextureAttrib.
+ */
+void TextureStreamer::
+request_screen_size(Texture *tex, PN_stdfloat screen_size) {
+  LightMutexHolder holder(_lock);
+  Entries::iterator ei = _entries.find(tex);
+  if (ei != _entries.end()) {
+    Entry &entry = (*ei).second;
+    entry._screen_size = std::max(entry._screen_size, std::max(screen_size, (PN_stdfloat)1));
+  }
+}
+
+/**
+ * Reports the screen sizes of several textures at once, as collected during a
+ * cull traversal.  This is equivalent to calling request_screen_size() for
+ * each of them, but takes the lock only once.
+ */
+void TextureStreamer::
+request_screen_sizes(const ScreenSizes &sizes) {
+  LightMutexHolder holder(_lock);
+  for (const auto &item : sizes) {
+    Entries::iterator ei = _entries.find(item.first);
+    if (ei != _entries.end()) {
+      Entry &entry = (*ei).second;
+      entry._screen_size = std::max(entry._screen_size, std::max(item.second, (PN_stdfloat)1));
+    }
+  }
+}
+
+/**
+ * Chooses a new resolution for each of the streamed textures, based on the
+ * screen sizes reported since the last call, and begins reloading the ones
+ * whose resolution needs to change.  This is called once per frame by the
+ * GraphicsEngine.
+ */
+void TextureStreamer::
+update() {
+  PStatTimer timer(_update_pcollector);
+  LightMutexHolder holder(_lock);
+  ++_frame;
+
+  int evict_frames = texture_stream_evict_frames;
+
+  size_t total = 0;
+  Entries::iterator ei = _entries.begin();
+  while (ei != _entries.end()) {
+    Entry &entry = (*ei).second;
+    if (entry._texture.was_deleted()) {
+      ei = _entries.erase(ei);
+      continue;
+    }
+
+    if (entry._screen_size > 0) {
+      entry._last_screen_size = entry._screen_size;
+      entry._last_seen_frame = _frame;
+      entry._screen_size = 0;
+    }
+
+    if (entry._last_seen_frame < 0 ||
+        _frame - entry._last_seen_frame > evict_frames) {
+      // It hasn't been seen in a while; keep only the mipmap tail.
+      entry._target_level = entry._tail_level;
+    } else {
+      entry._target_level = entry.calc_level(entry._last_screen_size);
+    }
+    total += entry._level_sizes[entry._target_level];
+    ++ei;
+  }
+
+  if (total > _memory_budget) {
+    // We're over budget.  Repeatedly drop a level from whichever texture
+    // currently has the most texels per pixel on screen.
+    typedef std::pair<double, Entry *> Candidate;
+    std::priority_queue<Candidate> queue;
+    for (auto &item : _entries) {
+      Entry &entry = item.second;
+      if (entry._target_level < entry._tail_level) {
+        double texels = (double)(entry._max_dimension >> entry._target_level);
+        queue.push(Candidate(texels / entry._last_screen_size, &entry));
+      }
+    }
+
+    while (total > _memory_budget && !queue.empty()) {
+      Entry &entry = *queue.top().second;
+      queue.pop();
+      total -= entry._level_sizes[entry._target_level];
+      ++entry._target_level;
+      total += entry._level_sizes[entry._target_level];
+      if (entry._target_level < entry._tail_level) {
+        double texels = (double)(entry._max_dimension >> entry._target_level);
+        queue.push(Candidate(texels / entry._last_screen_size, &entry));
+      }
+    }
+  }
+
+  // Now act on the decisions.  Reductions are applied first, since they free
+  // up memory; then the textures that appear largest on screen are loaded.
+  int num_loading = 0;
+  pvector<Entry *> loads;
+  for (auto &item : _entries) {
+    Entry &entry = item.second;
+    if (entry._task != nullptr) {
+      ++num_loading;
+      continue;
+    }
+    if (entry._target_level == entry._level) {
+      continue;
+    }
+
+    PT(Texture) tex = entry._texture.lock();
+    if (tex == nullptr) {
+      continue;
+    }
+    if (tex->set_stream_level(entry._target_level)) {
+      entry._level = entry._target_level;
+    } else {
+      loads.push_back(&entry);
+    }
+  }
+
+  std::sort(loads.begin(), loads.end(), [](const Entry *a, const Entry *b) {
+    if ((a->_target_level > a->_level) != (b->_target_level > b->_level)) {
+      return a->_target_level > a->_level;
+    }
+    return a->_last_screen_size > b->_last_screen_size;
+  });
+
+  int max_loads = texture_stream_max_loads;
+  for (Entry *entry : loads) {
+    if (num_loading >= max_loads) {
+      break;
+    }
+    PT(Texture) tex = entry->_texture.lock();
+    if (tex != nullptr) {
+      start_load(*entry, tex);
+      ++num_loading;
+    }
+  }
+}
+
+/**
+ * Waits for all of the textures that are currently being reloaded to finish.
+ */
+void TextureStreamer::
+wait_pending() {
+  pvector<PT(GenericAsyncTask)> tasks;
+  {
+    LightMutexHolder holder(_lock);
+    for (const auto &item : _entries) {
+      if (item.second._task != nullptr) {
+        tasks.push_back(item.second._task);
+      }
+    }
+  }
+
+  for (GenericAsyncTask *task : tasks) {
+    task->wait();
+  }
+}
+
+/**
+ * Returns the global TextureStreamer, creating it if necessary.
+ */
+TextureStreamer *TextureStreamer::
+get_global_ptr() {
+  if (_global_ptr == nullptr) {
+    _global_ptr = new TextureStreamer;
+  }
+  return _global_ptr;
+}
+
+/**
+ * Returns the number of high-resolution levels that should be dropped from
+ * the texture to give it about one texel per pixel when it is drawn at the
+ * indicated size on screen.  This is never less than the minimum level that
+ * can be loaded.
+ */
+int TextureStreamer::Entry::
+calc_level(PN_stdfloat screen_size) const {
+  int level = _min_level;
+  while (level < _tail_level &&
+         (PN_stdfloat)(_max_dimension >> (level + 1)) >= screen_size) {
+    ++level;
+  }
+  return level;
+}
+
+/**
+ * Begins reloading the texture at its target level on the texture_stream
+ * task chain.  Assumes the lock is held.
+ */
+void TextureStreamer::
+start_load(Entry &entry, Texture *tex) {
+  AsyncTaskManager *task_mgr = AsyncTaskManager::get_global_ptr();
+  static PT(AsyncTaskChain) chain = [task_mgr] {
+    PT(AsyncTaskChain) chain = task_mgr->make_task_chain("texture_stream");
+    chain->set_num_threads(texture_stream_threads);
+    return chain;
+  }();
+
+  LoadRequest *request = new LoadRequest;
+  request->_streamer = this;
+  request->_texture = tex;
+  request->_level = entry._target_level;
+  request->_success = false;
+
+  PT(GenericAsyncTask) task =
+    new GenericAsyncTask("stream_texture", &load_task, request);
+  task->set_upon_death(&load_done);
+  task->set_task_chain(chain->get_name());
+  entry._task = task;
+  task_mgr->add(task);
+}
+
+/**
+ * The task function that reloads a texture at its new resolution.
+ */
+AsyncTask::DoneStatus TextureStreamer::
+load_task(GenericAsyncTask *task, void *user_data) {
+  LoadRequest *request = (LoadRequest *)user_data;
+  Texture *tex = request->_texture;
+  request->_success = tex->load_stream_level(request->_level);
+
+  TextureStreamer *streamer = request->_streamer;
+  LightMutexHolder holder(streamer->_lock);
+  Entries::iterator ei = streamer->_entries.find(tex);
+  if (ei != streamer->_entries.end() && (*ei).second._task == task) {
+    Entry &entry = (*ei).second;
+    entry._task = nullptr;
+    if (request->_success) {
+      entry._level = tex->get_stream_level();
+    } else {
+      // Don't try again; pin it to the resolution it has.
+      entry._min_level = entry._level;
+      entry._tail_level = entry._level;
+      if (gobj_cat.is_debug()) {
+        gobj_cat.debug()
+          << "Unable to stream texture " << tex->get_name() << "\n";
+      }
+    }
+  }
+  return AsyncTask::DS_done;
+}
+
+/**
+ * Called when a reload task is finished or removed.
+ */
+void TextureStreamer::
+load_done(GenericAsyncTask *task, bool clean_exit, void *user_data) {
+  LoadRequest *request = (LoadRequest *)user_data;
+  if (!clean_exit) {
+    // The task was removed before it could run.
+    TextureStreamer *streamer = request->_streamer;
+    LightMutexHolder holder(streamer->_lock);
+    Entries::iterator ei = streamer->_entries.find(request->_texture);
+    if (ei != streamer->_entries.end() && (*ei).second._task == task) {
+      (*ei).second._task = nullptr;
+    }
+  }
+  delete request;
+}
@@ -0,0 +1,127 @@
+/**
+ * PANDA 3D SOFTWARE
+ * Copyright (c) Carnegie Mellon University.  All rights reserved.
+ *
+ * All use of this software is subject to the terms of the revised BSD
+ * license.  You should have received a copy of this license along
+ * with this source code in a file named "LICENSE."
+ *
+ * @file textureStreamer.h
+ * @author djs3000
+ * @date 2026-10-16
+ */
+
+#ifndef TEXTURESTREAMER_H
+#define TEXTURESTREAMER_H
+
+#include "pandabase.h"
+#include "texture.h"
+#include "asyncTask.h"
+#include "weakPointerTo.h"
+#include "lightMutex.h"
+#include "pmap.h"
+#include "pvector.h"
+
+class GenericAsyncTask;
+
+/**
+ * Decides at which resolution each streamed texture should be resident.
+ *
+ * A streamed texture initially keeps only its mipmap tail: the mipmap levels
+ * no larger than texture-stream-min-size on a side.  During the cull
+ * traversal, the projected screen size of each streamed texture is reported
+ * to the streamer.  Once per frame, update() chooses the number of high-
+ * resolution levels to drop from each texture, so that it has roughly one
+ * texel per pixel on screen and all of the streamed textures together fit
+ * within the memory budget.  Textures that need more detail are then reloaded
+ * from the texture cache or from disk on the "texture_stream" task chain,
+ * while rendering continues with the resolution that is already resident.
+ *
+ * Textures are added automatically by the TexturePool if texture-streaming
+ * is set.  Only textures with mipmaps that can be reloaded from disk are
+ * eligible.
+ */
+class EXPCL_PANDA_GOBJ TextureStreamer {
+protected:
+  TextureStreamer();
+
+PUBLISHED:
+  bool add_texture(Texture *tex);
+  bool remove_texture(Texture *tex);
+  bool has_texture(Texture *tex) const;
+  size_t get_num_textures() const;
+
+  void set_memory_budget(size_t budget);
+  size_t get_memory_budget() const;
+  size_t get_resident_size() const;
+  size_t get_num_pending() const;
+
+  void request_screen_size(Texture *tex, PN_stdfloat screen_size);
+  void update();
+  BLOCKING void wait_pending();
+
+  MAKE_PROPERTY(num_textures, get_num_textures);
+  MAKE_PROPERTY(memory_budget, get_memory_budget, set_memory_budget);
+  MAKE_PROPERTY(resident_size, get_resident_size);
+  MAKE_PROPERTY(num_pending, get_num_pending);
+
+  static TextureStreamer *get_global_ptr();
+
+public:
+  typedef pmap<Texture *, PN_stdfloat> ScreenSizes;
+  void request_screen_sizes(const ScreenSizes &sizes);
+
+  INLINE static void update_global();
+
+private:
+  class Entry {
+  public:
+    int calc_level(PN_stdfloat screen_size) const;
+
+    WPT(Texture) _texture;
+    int _max_dimension;
+    int _tail_level;
+    int _level;
+
+    // The highest resolution that may be loaded.  This is raised if the
+    // texture fails to load, so that we don't keep trying.
+    int _min_level;
+    int _target_level;
+
+    // The number of bytes needed to keep each level, and all of the smaller
+    // ones below it, resident.
+    pvector<size_t> _level_sizes;
+
+    // The largest screen size reported since the last update, and the one
+    // used for the most recent decision.
+    PN_stdfloat _screen_size;
+    PN_stdfloat _last_screen_size;
+    int _last_seen_frame;
+
+    PT(GenericAsyncTask) _task;
+  };
+  typedef pmap<Texture *, Entry> Entries;
+
+  class LoadRequest {
+  public:
+    TextureStreamer *_streamer;
+    PT(Texture) _texture;
+    int _level;
+    bool _success;
+  };
+
+  void start_load(Entry &entry, Texture *tex);
+  static AsyncTask::DoneStatus load_task(GenericAsyncTask *task, void *user_data);
+  static void load_done(GenericAsyncTask *task, bool clean_exit, void *user_data);
+
+  mutable LightMutex _lock;
+  Entries _entries;
+  size_t _memory_budget;
+  int _frame;
+
+  static TextureStreamer *_global_ptr;
+};
+
+#include "textureStreamer.I"
+
+#endif
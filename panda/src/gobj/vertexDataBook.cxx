@@ -12,7 +12,15 @@
  */
 
 #include "vertexDataBook.h"
+#include "vertexDataBlock.h"
 #include "mutexHolder.h"
+#include "pStatTimer.h"
+#include "config_gobj.h"
+#include "pbitops.h"
+
+#include <algorithm>
+
+PStatCollector VertexDataBook::_defragment_pcollector("*:Vertex Data:Defragment");
 
 /**
  *
@@ -98,6 +106,124 @@ count_allocated_size(VertexDataPage::RamClass ram_class) const {
   return total;
 }
 
+/**
+ * Returns the total number of bytes within the pages owned by this book that
+ * are not allocated.
+ */
+size_t VertexDataBook::
+count_free_size() const {
+  MutexHolder holder(_lock);
+
+  size_t total = 0;
+  for (const VertexDataPage *page : _pages) {
+    total += page->_max_size - page->_total_size;
+  }
+  return total;
+}
+
+/**
+ * Returns the number of free bytes within the pages owned by this book that
+ * are not part of the largest free range of their page.  These bytes are
+ * lost to fragmentation: they can only be used for blocks that happen to fit
+ * in the gaps.  defragment() reduces this number.
+ */
+size_t VertexDataBook::
+count_wasted_size() const {
+  MutexHolder holder(_lock);
+
+  size_t total = 0;
+  for (const VertexDataPage *page : _pages) {
+    size_t free_size, largest_free;
+    page->do_count_free(free_size, largest_free);
+    total += free_size - largest_free;
+  }
+  return total;
+}
+
+/**
+ * Returns the fraction of the free bytes within the pages owned by this book
+ * that is lost to fragmentation, as reported by count_wasted_size().  This is
+ * 0 if the free space in each page is contiguous.
+ */
+double VertexDataBook::
+get_fragmentation() const {
+  MutexHolder holder(_lock);
+
+  size_t free_total = 0;
+  size_t wasted_total = 0;
+  for (const VertexDataPage *page : _pages) {
+    size_t free_size, largest_free;
+    page->do_count_free(free_size, largest_free);
+    free_total += free_size;
+    wasted_total += free_size - largest_free;
+  }
+  return free_total != 0 ? (double)wasted_total / (double)free_total : 0.0;
+}
+
+/**
+ * Moves up to max_bytes of allocated blocks around within the resident pages
+ * of this book to reduce fragmentation, and returns the number of bytes
+ * moved.  First, the blocks of the least occupied pages (see
+ * vertex-data-evacuate-occupancy) are moved into the most occupied pages, so
+ * that the emptied pages can be released; then, the blocks of the remaining
+ * pages are slid together to close the gaps between them.
+ *
+ * The VertexDataBlock objects keep their identity, so the vertex buffers that
+ * reference them are unaffected; but any pointer previously returned by
+ * VertexDataBlock::get_pointer() becomes invalid.  This must therefore only be
+ * called when no other thread may be reading vertex data, which is why the
+ * GraphicsEngine does it between frames (see vertex-data-defrag-bytes).
+ */
+size_t VertexDataBook::
+defragment(size_t max_bytes) {
+  MutexHolder holder(_lock);
+  PStatTimer timer(_defragment_pcollector);
+
+  pvector<VertexDataPage *> pages;
+  pages.reserve(_pages.size());
+  for (VertexDataPage *page : _pages) {
+    if (page->can_defragment()) {
+      pages.push_back(page);
+    }
+  }
+
+  // Sort the pages from the least occupied to the most occupied.
+  std::sort(pages.begin(), pages.end(),
+            [](const VertexDataPage *a, const VertexDataPage *b) {
+    return (double)a->_total_size / a->_max_size <
+           (double)b->_total_size / b->_max_size;
+  });
+
+  size_t moved = 0;
+  double max_occupancy = vertex_data_evacuate_occupancy;
+  for (size_t i = 0; i < pages.size() && moved < max_bytes; ++i) {
+    VertexDataPage *page = pages[i];
+    if ((double)page->_total_size > max_occupancy * page->_max_size) {
+      break;
+    }
+    bool deleted;
+    moved += page->do_evacuate(pages, max_bytes - moved, deleted);
+    if (deleted) {
+      pages[i] = nullptr;
+    }
+  }
+
+  for (VertexDataPage *page : pages) {
+    if (moved >= max_bytes) {
+      break;
+    }
+    if (page != nullptr) {
+      size_t free_size, largest_free;
+      page->do_count_free(free_size, largest_free);
+      if (largest_free < free_size) {
+        moved += page->do_compact(max_bytes - moved);
+      }
+    }
+  }
+
+  return moved;
+}
+
 /**
  * Writes all pages to disk immediately, just in case they get evicted later.
  * It makes sense to make this call just before taking down a loading screen,
@@ -114,6 +240,22 @@ save_to_disk() {
 }
 
 
+/**
+ * Returns the number of bytes that are actually reserved for a block of the
+ * indicated size.  Blocks are rounded up to one of eight size classes per
+ * power of two (or to a multiple of 16 bytes, for small blocks), so that the
+ * gap left by a freed block is likely to be reused by a later one.
+ */
+size_t VertexDataBook::
+get_size_class(size_t size) {
+  if (size <= 256) {
+    return (size + 15) & ~(size_t)15;
+  }
+  int bit = get_highest_on_bit((unsigned long long)(size - 1));
+  size_t step = (size_t)1 << (bit - 3);
+  return (size + step - 1) & ~(step - 1);
+}
+
 /**
  * Allocates and returns a new VertexDataBuffer of the requested size.
  *
@@ -121,6 +263,10 @@ save_to_disk() {
  */
 VertexDataBlock *VertexDataBook::
 do_alloc(size_t size) {
+  if (vertex_data_size_classes) {
+    size = get_size_class(size);
+  }
+
   // Look for an empty page of the appropriate size.  The _pages set is sorted
   // so that the pages with the smallest available blocks are at the front.
 
@@ -20,6 +20,7 @@
 #include "vertexDataPage.h"
 #include "indirectLess.h"
 #include "plist.h"
+#include "pStatCollector.h"
 
 class VertexDataBlock;
 
@@ -40,9 +41,16 @@ PUBLISHED:
   size_t count_total_page_size(VertexDataPage::RamClass ram_class) const;
   size_t count_allocated_size() const;
   size_t count_allocated_size(VertexDataPage::RamClass ram_class) const;
+  size_t count_free_size() const;
+  size_t count_wasted_size() const;
+  double get_fragmentation() const;
+
+  size_t defragment(size_t max_bytes);
 
   void save_to_disk();
 
+  static size_t get_size_class(size_t size);
+
 public:
   void reorder_page(VertexDataPage *page);
 
@@ -57,6 +65,8 @@ private:
   Pages _pages;
 
   Mutex _lock;
+
+  static PStatCollector _defragment_pcollector;
   friend class VertexDataPage;
 };
 
@@ -19,12 +19,23 @@
 #include "pStatTimer.h"
 #include "memoryHook.h"
 #include "config_gobj.h"
+#include "configVariableEnum.h"
+#include "trueClock.h"
+#include "string_utils.h"
 #include <algorithm>
 
 #ifdef HAVE_ZLIB
 #include <zlib.h>
 #endif
 
+#ifdef HAVE_LZ4
+#include <lz4.h>
+#endif
+
+#ifdef HAVE_ZSTD
+#include <zstd.h>
+#endif
+
 ConfigVariableInt max_resident_vertex_data
 ("max-resident-vertex-data", -1,
  PRC_DESC("Specifies the maximum number of bytes of all vertex data "
@@ -41,11 +52,37 @@ ConfigVariableInt max_compressed_vertex_data
           "the least-recently-used ones will be temporarily flushed to "
           "disk until they are needed.  Set it to -1 for no limit."));
 
+ConfigVariableEnum<VertexDataPage::CompressionMethod> vertex_data_compression_method
+("vertex-data-compression-method",
+#if defined(HAVE_LZ4)
+ VertexDataPage::CM_lz4,
+#elif defined(HAVE_ZSTD)
+ VertexDataPage::CM_zstd,
+#else
+ VertexDataPage::CM_zlib,
+#endif
+ PRC_DESC("Specifies the algorithm used to compress vertex data that is "
+          "evicted from max-resident-vertex-data into compressed RAM.  "
+          "Choose one of zlib, lz4, or zstd.  lz4 is by far the fastest to "
+          "compress and expand, zstd compresses better at a similar "
+          "expansion speed, and zlib is the slowest.  If the chosen method "
+          "was not compiled in, another available one is used instead."));
+
 ConfigVariableInt vertex_data_compression_level
 ("vertex-data-compression-level", 1,
- PRC_DESC("Specifies the zlib compression level to use when compressing "
-          "vertex data.  The number should be in the range 1 to 9, where "
-          "larger values are slower but give better compression."));
+ PRC_DESC("Specifies the compression level to use when compressing "
+          "vertex data with zlib or zstd.  For zlib, the number should be "
+          "in the range 1 to 9; for zstd, 1 to 19.  Larger values are "
+          "slower but give better compression.  This is ignored for lz4."));
+
+ConfigVariableInt max_prefetch_vertex_data
+("max-prefetch-vertex-data", 0,
+ PRC_DESC("Specifies the maximum number of bytes of compressed vertex data "
+          "that the paging threads may begin to expand each frame, ahead of "
+          "it actually being needed, while there is room for it within "
+          "max-resident-vertex-data.  The most recently used pages are "
+          "expanded first.  This only has an effect if vertex-data-page-"
+          "threads is nonzero.  Set it to 0 to expand pages only on demand."));
 
 ConfigVariableInt max_disk_vertex_data
 ("max-disk-vertex-data", -1,
@@ -80,6 +117,9 @@ PStatCollector VertexDataPage::_vdata_compress_pcollector("*:Vertex Data:Compres
 PStatCollector VertexDataPage::_vdata_decompress_pcollector("*:Vertex Data:Decompress");
 PStatCollector VertexDataPage::_vdata_save_pcollector("*:Vertex Data:Save");
 PStatCollector VertexDataPage::_vdata_restore_pcollector("*:Vertex Data:Restore");
+PStatCollector VertexDataPage::_page_in_latency_pcollector("Vertex page-in latency");
+PStatCollector VertexDataPage::_page_in_bytes_pcollector("Vertex page-in");
+PStatCollector VertexDataPage::_prefetch_bytes_pcollector("Vertex page-in:Prefetch");
 PStatCollector VertexDataPage::_thread_wait_pcollector("Wait:Idle");
 PStatCollector VertexDataPage::_alloc_pages_pcollector("System memory:MMap:Vertex data");
 
@@ -115,7 +155,9 @@ VertexDataPage(size_t book_size) :
   _size = 0;
   _uncompressed_size = 0;
   _ram_class = RC_resident;
+  _compression_method = CM_none;
   _pending_ram_class = RC_resident;
+  _request_time = 0.0;
 }
 
 /**
@@ -134,7 +176,9 @@ VertexDataPage(VertexDataBook *book, size_t page_size, size_t block_size) :
   _size = page_size;
 
   _uncompressed_size = _size;
+  _compression_method = CM_none;
   _pending_ram_class = RC_resident;
+  _request_time = 0.0;
   set_ram_class(RC_resident);
 }
 
@@ -207,6 +251,88 @@ flush_threads() {
   }
 }
 
+/**
+ * Marks that an epoch has passed in the resident and compressed LRU's, and
+ * gives them the chance to evict pages.  If max-prefetch-vertex-data is set,
+ * also starts expanding the most recently used compressed pages that fit in
+ * the available room of the resident LRU.  This is called once per frame.
+ */
+void VertexDataPage::
+lru_epoch() {
+  _resident_lru.begin_epoch();
+  _compressed_lru.begin_epoch();
+
+  int max_prefetch = max_prefetch_vertex_data;
+  if (max_prefetch > 0 && vertex_data_page_threads > 0 &&
+      Thread::is_threading_supported()) {
+    _compressed_lru.prefetch_recent((size_t)max_prefetch);
+  }
+
+  _page_in_latency_pcollector.flush_level();
+  _page_in_latency_pcollector.clear_level();
+  _page_in_bytes_pcollector.flush_level();
+  _page_in_bytes_pcollector.clear_level();
+  _prefetch_bytes_pcollector.flush_level();
+  _prefetch_bytes_pcollector.clear_level();
+}
+
+/**
+ * Returns true if the indicated compression method was compiled into Panda,
+ * and can therefore be used to compress vertex data.
+ */
+bool VertexDataPage::
+has_compression_method(CompressionMethod method) {
+  switch (method) {
+  case CM_none:
+    return true;
+
+  case CM_zlib:
+#ifdef HAVE_ZLIB
+    return true;
+#else
+    return false;
+#endif
+
+  case CM_lz4:
+#ifdef HAVE_LZ4
+    return true;
+#else
+    return false;
+#endif
+
+  case CM_zstd:
+#ifdef HAVE_ZSTD
+    return true;
+#else
+    return false;
+#endif
+  }
+
+  return false;
+}
+
+/**
+ * Returns the compression method that will be used to compress pages from now
+ * on.  This is the method specified by vertex-data-compression-method, unless
+ * that was not compiled in, in which case it is the fastest one that was, or
+ * CM_none if there are none.
+ */
+VertexDataPage::CompressionMethod VertexDataPage::
+get_compression_method() {
+  CompressionMethod method = vertex_data_compression_method;
+  if (has_compression_method(method)) {
+    return method;
+  }
+
+  static const CompressionMethod fallbacks[] = { CM_lz4, CM_zstd, CM_zlib };
+  for (CompressionMethod fallback : fallbacks) {
+    if (has_compression_method(fallback)) {
+      return fallback;
+    }
+  }
+  return CM_none;
+}
+
 /**
  *
  */
@@ -288,6 +414,32 @@ evict_lru() {
   }
 }
 
+/**
+ * Called by SimpleLru::prefetch_recent() on the pages of the compressed LRU,
+ * starting with the most recently used one.  If there is room for the
+ * expanded page in the resident LRU, asks the paging threads to expand it,
+ * and returns the number of bytes that it will occupy.  Otherwise, returns 0.
+ */
+size_t VertexDataPage::
+prefetch_lru() {
+  MutexHolder holder(_lock);
+
+  if (_ram_class != RC_compressed || _pending_ram_class != _ram_class) {
+    return 0;
+  }
+
+  // Leave the room that the pages already on their way in will take up.
+  size_t needed_size = _resident_lru.get_total_size() +
+    _pending_lru.get_total_size() + _uncompressed_size;
+  if (needed_size > _resident_lru.get_max_size()) {
+    return 0;
+  }
+
+  _prefetch_bytes_pcollector.add_level(_uncompressed_size);
+  request_ram_class(RC_resident);
+  return _uncompressed_size;
+}
+
 /**
  * Allocates a new block.  Returns NULL if a block of the requested size
  * cannot be allocated.
@@ -310,6 +462,145 @@ do_alloc(size_t size) {
   return block;
 }
 
+/**
+ * Returns true if the blocks of this page may be moved around by the
+ * defragmenter right now: that is, if the page is resident and the paging
+ * threads aren't about to do anything with it.
+ *
+ * Assumes the lock is already held.
+ */
+bool VertexDataPage::
+can_defragment() const {
+  if (_ram_class != RC_resident || _page_data == nullptr) {
+    return false;
+  }
+  MutexHolder holder(_tlock);
+  return _pending_ram_class == _ram_class;
+}
+
+/**
+ * Walks through the blocks of the page to determine the total number of free
+ * bytes, and the size of the largest free range.
+ *
+ * Assumes the lock is already held.
+ */
+void VertexDataPage::
+do_count_free(size_t &free_size, size_t &largest_free) const {
+  free_size = _max_size - _total_size;
+  largest_free = 0;
+
+  const LinkedListNode *head = (const SimpleAllocator *)this;
+  size_t end = 0;
+  const LinkedListNode *node = SimpleAllocator::_next;
+  while (node != head) {
+    const VertexDataBlock *block = (const VertexDataBlock *)node;
+    largest_free = std::max(largest_free, block->get_start() - end);
+    end = block->get_start() + block->get_size();
+    node = block->_next;
+  }
+  largest_free = std::max(largest_free, _max_size - end);
+}
+
+/**
+ * Moves as many blocks as possible, up to max_bytes worth, out of this page
+ * and into the indicated target pages, which are tried from last to first.
+ * The VertexDataBlock objects themselves are retained, so that the buffers
+ * that reference them will find their data in the new place.  Returns the
+ * number of bytes moved.
+ *
+ * If all of the blocks were moved, the page deletes itself, and deleted is
+ * set true.  In this case, the page may not be accessed again.
+ *
+ * Assumes the lock is already held.
+ */
+size_t VertexDataPage::
+do_evacuate(const pvector<VertexDataPage *> &targets, size_t max_bytes,
+            bool &deleted) {
+  size_t moved = 0;
+  deleted = false;
+
+  LinkedListNode *head = (SimpleAllocator *)this;
+  LinkedListNode *node = SimpleAllocator::_next;
+  while (node != head) {
+    VertexDataBlock *block = (VertexDataBlock *)node;
+    LinkedListNode *next = block->_next;
+    size_t size = block->get_size();
+    if (moved + size > max_bytes) {
+      break;
+    }
+
+    VertexDataBlock *dest = nullptr;
+    VertexDataPage *target = nullptr;
+    for (auto ti = targets.rbegin(); ti != targets.rend() && dest == nullptr; ++ti) {
+      target = *ti;
+      if (target != nullptr && target != this) {
+        dest = target->do_alloc(size);
+      }
+    }
+    if (dest == nullptr) {
+      // There's no room for it anywhere else.
+      break;
+    }
+
+    memcpy(target->_page_data + dest->get_start(),
+           _page_data + block->get_start(), size);
+    moved += size;
+
+    // If this was the last block, the page deletes itself here.
+    bool last = (next == head);
+    do_replace_block(block, dest);
+    delete dest;
+    if (last) {
+      deleted = true;
+      return moved;
+    }
+    node = next;
+  }
+
+  return moved;
+}
+
+/**
+ * Slides the blocks of this page toward the beginning, closing the gaps
+ * between them, until max_bytes have been moved.  Returns the number of
+ * bytes moved.
+ *
+ * Assumes the lock is already held.
+ */
+size_t VertexDataPage::
+do_compact(size_t max_bytes) {
+  size_t moved = 0;
+  size_t end = 0;
+  VertexDataBlock *last_moved = nullptr;
+
+  LinkedListNode *head = (SimpleAllocator *)this;
+  LinkedListNode *node = SimpleAllocator::_next;
+  while (node != head) {
+    VertexDataBlock *block = (VertexDataBlock *)node;
+    size_t start = block->get_start();
+    size_t size = block->get_size();
+    if (start > end) {
+      if (moved + size > max_bytes) {
+        break;
+      }
+      memmove(_page_data + end, _page_data + start, size);
+      do_move_block(block, end);
+      moved += size;
+      last_moved = block;
+      start = end;
+    }
+    end = start + size;
+    node = block->_next;
+  }
+
+  if (last_moved != nullptr) {
+    // The copy on disk no longer matches.
+    _saved_block.clear();
+    mark_contiguous(last_moved);
+  }
+  return moved;
+}
+
 /**
  * Short-circuits the thread and forces the page into resident status
  * immediately.
@@ -343,85 +634,61 @@ make_resident() {
     return;
   }
 
+  // If the page wasn't queued, we are blocking on it right now.
+  double request_time = _request_time;
+  if (request_time == 0.0) {
+    request_time = TrueClock::get_global_ptr()->get_short_time();
+  }
+  _request_time = 0.0;
+
   if (_ram_class == RC_disk) {
     do_restore_from_disk();
   }
 
   if (_ram_class == RC_compressed) {
-#ifdef HAVE_ZLIB
     PStatTimer timer(_vdata_decompress_pcollector);
 
     if (gobj_cat.is_debug()) {
       gobj_cat.debug()
         << "Expanding page from " << _size
-        << " to " << _uncompressed_size << "\n";
+        << " to " << _uncompressed_size << " with "
+        << _compression_method << "\n";
     }
-    size_t new_allocated_size = round_up(_uncompressed_size);
-    unsigned char *new_data = alloc_page_data(new_allocated_size);
-    unsigned char *end_data = new_data + new_allocated_size;
 
-    z_stream z_source;
-#ifdef USE_MEMORY_NOWRAPPERS
-    z_source.zalloc = Z_NULL;
-    z_source.zfree = Z_NULL;
-#else
-    z_source.zalloc = (alloc_func)&do_zlib_alloc;
-    z_source.zfree = (free_func)&do_zlib_free;
-#endif
+    bool success = true;
+    switch (_compression_method) {
+    case CM_none:
+      break;
 
-    z_source.opaque = Z_NULL;
-    z_source.msg = (char *) "no error message";
+    case CM_zlib:
+      success = do_decompress_zlib();
+      break;
 
-    z_source.next_in = (Bytef *)(char *)_page_data;
-    z_source.avail_in = _size;
-    z_source.next_out = (Bytef *)new_data;
-    z_source.avail_out = new_allocated_size;
+    case CM_lz4:
+      success = do_decompress_lz4();
+      break;
 
-    int result = inflateInit(&z_source);
-    if (result < 0) {
-      nassert_raise("zlib error");
-      return;
+    case CM_zstd:
+      success = do_decompress_zstd();
+      break;
     }
-    Thread::consider_yield();
-
-    size_t output_size = 0;
-
-    int flush = 0;
-    result = 0;
-    while (result != Z_STREAM_END) {
-      unsigned char *start_out = (unsigned char *)z_source.next_out;
-      nassertv(start_out < end_data);
-      z_source.avail_out = std::min((size_t)(end_data - start_out), (size_t)inflate_page_size);
-      nassertv(z_source.avail_out != 0);
-      result = inflate(&z_source, flush);
-      if (result < 0 && result != Z_BUF_ERROR) {
-        nassert_raise("zlib error");
-        return;
-      }
-      size_t bytes_produced = (size_t)((unsigned char *)z_source.next_out - start_out);
-      output_size += bytes_produced;
-      if (bytes_produced == 0) {
-        // If we ever produce no bytes, then start flushing the output.
-        flush = Z_FINISH;
-      }
-
-      Thread::consider_yield();
+    if (!success) {
+      return;
     }
-    nassertv(z_source.avail_in == 0);
-    nassertv(output_size == _uncompressed_size);
-
-    result = inflateEnd(&z_source);
-    nassertv(result == Z_OK);
-
-    free_page_data(_page_data, _allocated_size);
-    _page_data = new_data;
-    _size = _uncompressed_size;
-    _allocated_size = new_allocated_size;
-#endif
+    nassertv(_size == _uncompressed_size);
 
     set_lru_size(_size);
     set_ram_class(RC_resident);
   }
+
+  if (_ram_class == RC_resident) {
+    double latency = TrueClock::get_global_ptr()->get_short_time() - request_time;
+    // Report the longest wait within each frame.
+    if (latency > _page_in_latency_pcollector.get_level()) {
+      _page_in_latency_pcollector.set_level(latency);
+    }
+    _page_in_bytes_pcollector.add_level(_size);
+  }
 }
 
 /**
@@ -445,109 +712,340 @@ make_compressed() {
   if (_ram_class == RC_resident) {
     nassertv(_size == _uncompressed_size);
 
-#ifdef HAVE_ZLIB
     PStatTimer timer(_vdata_compress_pcollector);
 
-    DeflatePage *page = new DeflatePage;
-    DeflatePage *head = page;
+    CompressionMethod method = get_compression_method();
+    bool success = true;
+    switch (method) {
+    case CM_none:
+      break;
 
-    z_stream z_dest;
+    case CM_zlib:
+      success = do_compress_zlib();
+      break;
+
+    case CM_lz4:
+      success = do_compress_lz4();
+      break;
+
+    case CM_zstd:
+      success = do_compress_zstd();
+      break;
+    }
+    if (!success) {
+      return;
+    }
+    _compression_method = method;
+
+    if (gobj_cat.is_debug()) {
+      gobj_cat.debug()
+        << "Compressed " << *this << " from " << _uncompressed_size
+        << " to " << _size << " with " << method << "\n";
+    }
+
+    set_lru_size(_size);
+    set_ram_class(RC_compressed);
+  }
+}
+
+/**
+ * Compresses the resident page data with zlib, replacing it with the
+ * compressed data.  Returns true on success.  Assumes the lock is held.
+ */
+bool VertexDataPage::
+do_compress_zlib() {
+#ifdef HAVE_ZLIB
+  DeflatePage *page = new DeflatePage;
+  DeflatePage *head = page;
+
+  z_stream z_dest;
 #ifdef USE_MEMORY_NOWRAPPERS
-    z_dest.zalloc = Z_NULL;
-    z_dest.zfree = Z_NULL;
+  z_dest.zalloc = Z_NULL;
+  z_dest.zfree = Z_NULL;
 #else
-    z_dest.zalloc = (alloc_func)&do_zlib_alloc;
-    z_dest.zfree = (free_func)&do_zlib_free;
+  z_dest.zalloc = (alloc_func)&do_zlib_alloc;
+  z_dest.zfree = (free_func)&do_zlib_free;
 #endif
 
-    z_dest.opaque = Z_NULL;
-    z_dest.msg = (char *) "no error message";
+  z_dest.opaque = Z_NULL;
+  z_dest.msg = (char *) "no error message";
+
+  int result = deflateInit(&z_dest, vertex_data_compression_level);
+  if (result < 0) {
+    nassert_raise("zlib error");
+    return false;
+  }
+  Thread::consider_yield();
+
+  z_dest.next_in = (Bytef *)(char *)_page_data;
+  z_dest.avail_in = _uncompressed_size;
+  size_t output_size = 0;
+
+  // Compress the data into one or more individual pages.  We have to
+  // compress it page-at-a-time, since we're not really sure how big the
+  // result will be (so we can't easily pre-allocate a buffer).
+  int flush = 0;
+  result = 0;
+  while (result != Z_STREAM_END) {
+    unsigned char *start_out = (page->_buffer + page->_used_size);
+    z_dest.next_out = (Bytef *)start_out;
+    z_dest.avail_out = (size_t)deflate_page_size - page->_used_size;
+    if (z_dest.avail_out == 0) {
+      DeflatePage *new_page = new DeflatePage;
+      page->_next = new_page;
+      page = new_page;
+      start_out = page->_buffer;
+      z_dest.next_out = (Bytef *)start_out;
+      z_dest.avail_out = deflate_page_size;
+    }
 
-    int result = deflateInit(&z_dest, vertex_data_compression_level);
-    if (result < 0) {
+    result = deflate(&z_dest, flush);
+    if (result < 0 && result != Z_BUF_ERROR) {
       nassert_raise("zlib error");
-      return;
+      return false;
     }
+    size_t bytes_produced = (size_t)((unsigned char *)z_dest.next_out - start_out);
+    page->_used_size += bytes_produced;
+    nassertr(page->_used_size <= deflate_page_size, false);
+    output_size += bytes_produced;
+    if (bytes_produced == 0) {
+      // If we ever produce no bytes, then start flushing the output.
+      flush = Z_FINISH;
+    }
+
     Thread::consider_yield();
+  }
+  nassertr(z_dest.avail_in == 0, false);
+
+  result = deflateEnd(&z_dest);
+  nassertr(result == Z_OK, false);
+
+  // Now we know how big the result will be.  Allocate a buffer, and copy the
+  // data from the various pages.
+
+  size_t new_allocated_size = round_up(output_size);
+  unsigned char *new_data = alloc_page_data(new_allocated_size);
+
+  size_t copied_size = 0;
+  unsigned char *p = new_data;
+  page = head;
+  while (page != nullptr) {
+    memcpy(p, page->_buffer, page->_used_size);
+    copied_size += page->_used_size;
+    p += page->_used_size;
+    DeflatePage *next = page->_next;
+    delete page;
+    page = next;
+  }
+  nassertr(copied_size == output_size, false);
 
-    z_dest.next_in = (Bytef *)(char *)_page_data;
-    z_dest.avail_in = _uncompressed_size;
-    size_t output_size = 0;
-
-    // Compress the data into one or more individual pages.  We have to
-    // compress it page-at-a-time, since we're not really sure how big the
-    // result will be (so we can't easily pre-allocate a buffer).
-    int flush = 0;
-    result = 0;
-    while (result != Z_STREAM_END) {
-      unsigned char *start_out = (page->_buffer + page->_used_size);
-      z_dest.next_out = (Bytef *)start_out;
-      z_dest.avail_out = (size_t)deflate_page_size - page->_used_size;
-      if (z_dest.avail_out == 0) {
-        DeflatePage *new_page = new DeflatePage;
-        page->_next = new_page;
-        page = new_page;
-        start_out = page->_buffer;
-        z_dest.next_out = (Bytef *)start_out;
-        z_dest.avail_out = deflate_page_size;
-      }
+  // Now free the original, uncompressed data, and put this new compressed
+  // buffer in its place.
+  replace_page_data(new_data, output_size, new_allocated_size);
+  return true;
+#else
+  return false;
+#endif  // HAVE_ZLIB
+}
 
-      result = deflate(&z_dest, flush);
-      if (result < 0 && result != Z_BUF_ERROR) {
-        nassert_raise("zlib error");
-        return;
-      }
-      size_t bytes_produced = (size_t)((unsigned char *)z_dest.next_out - start_out);
-      page->_used_size += bytes_produced;
-      nassertv(page->_used_size <= deflate_page_size);
-      output_size += bytes_produced;
-      if (bytes_produced == 0) {
-        // If we ever produce no bytes, then start flushing the output.
-        flush = Z_FINISH;
-      }
+/**
+ * Expands the page data that was compressed with zlib.  Returns true on
+ * success.  Assumes the lock is held.
+ */
+bool VertexDataPage::
+do_decompress_zlib() {
+#ifdef HAVE_ZLIB
+  size_t new_allocated_size = round_up(_uncompressed_size);
+  unsigned char *new_data = alloc_page_data(new_allocated_size);
+  unsigned char *end_data = new_data + new_allocated_size;
+
+  z_stream z_source;
+#ifdef USE_MEMORY_NOWRAPPERS
+  z_source.zalloc = Z_NULL;
+  z_source.zfree = Z_NULL;
+#else
+  z_source.zalloc = (alloc_func)&do_zlib_alloc;
+  z_source.zfree = (free_func)&do_zlib_free;
+#endif
 
-      Thread::consider_yield();
+  z_source.opaque = Z_NULL;
+  z_source.msg = (char *) "no error message";
+
+  z_source.next_in = (Bytef *)(char *)_page_data;
+  z_source.avail_in = _size;
+  z_source.next_out = (Bytef *)new_data;
+  z_source.avail_out = new_allocated_size;
+
+  int result = inflateInit(&z_source);
+  if (result < 0) {
+    nassert_raise("zlib error");
+    return false;
+  }
+  Thread::consider_yield();
+
+  size_t output_size = 0;
+
+  int flush = 0;
+  result = 0;
+  while (result != Z_STREAM_END) {
+    unsigned char *start_out = (unsigned char *)z_source.next_out;
+    nassertr(start_out < end_data, false);
+    z_source.avail_out = std::min((size_t)(end_data - start_out), (size_t)inflate_page_size);
+    nassertr(z_source.avail_out != 0, false);
+    result = inflate(&z_source, flush);
+    if (result < 0 && result != Z_BUF_ERROR) {
+      nassert_raise("zlib error");
+      return false;
+    }
+    size_t bytes_produced = (size_t)((unsigned char *)z_source.next_out - start_out);
+    output_size += bytes_produced;
+    if (bytes_produced == 0) {
+      // If we ever produce no bytes, then start flushing the output.
+      flush = Z_FINISH;
     }
-    nassertv(z_dest.avail_in == 0);
 
-    result = deflateEnd(&z_dest);
-    nassertv(result == Z_OK);
+    Thread::consider_yield();
+  }
+  nassertr(z_source.avail_in == 0, false);
+  nassertr(output_size == _uncompressed_size, false);
 
-    // Now we know how big the result will be.  Allocate a buffer, and copy
-    // the data from the various pages.
+  result = inflateEnd(&z_source);
+  nassertr(result == Z_OK, false);
 
-    size_t new_allocated_size = round_up(output_size);
-    unsigned char *new_data = alloc_page_data(new_allocated_size);
+  replace_page_data(new_data, _uncompressed_size, new_allocated_size);
+  return true;
+#else
+  return false;
+#endif  // HAVE_ZLIB
+}
 
-    size_t copied_size = 0;
-    unsigned char *p = new_data;
-    page = head;
-    while (page != nullptr) {
-      memcpy(p, page->_buffer, page->_used_size);
-      copied_size += page->_used_size;
-      p += page->_used_size;
-      DeflatePage *next = page->_next;
-      delete page;
-      page = next;
-    }
-    nassertv(copied_size == output_size);
+/**
+ * Compresses the resident page data with LZ4, replacing it with the
+ * compressed data.  Returns true on success.  Assumes the lock is held.
+ */
+bool VertexDataPage::
+do_compress_lz4() {
+#ifdef HAVE_LZ4
+  // LZ4 needs the whole output buffer up front, so we compress into a
+  // worst-case buffer and copy the result into a page of the right size.
+  int bound = LZ4_compressBound((int)_uncompressed_size);
+  nassertr(bound > 0, false);
+  char *buffer = (char *)PANDA_MALLOC_ARRAY(bound);
+
+  int output_size = LZ4_compress_default((const char *)_page_data, buffer,
+                                         (int)_uncompressed_size, bound);
+  if (output_size <= 0) {
+    PANDA_FREE_ARRAY(buffer);
+    nassert_raise("lz4 error");
+    return false;
+  }
 
-    // Now free the original, uncompressed data, and put this new compressed
-    // buffer in its place.
-    free_page_data(_page_data, _allocated_size);
-    _page_data = new_data;
-    _size = output_size;
-    _allocated_size = new_allocated_size;
+  size_t new_allocated_size = round_up((size_t)output_size);
+  unsigned char *new_data = alloc_page_data(new_allocated_size);
+  memcpy(new_data, buffer, output_size);
+  PANDA_FREE_ARRAY(buffer);
 
-    if (gobj_cat.is_debug()) {
-      gobj_cat.debug()
-        << "Compressed " << *this << " from " << _uncompressed_size
-        << " to " << _size << "\n";
-    }
-#endif
-    set_lru_size(_size);
-    set_ram_class(RC_compressed);
+  replace_page_data(new_data, (size_t)output_size, new_allocated_size);
+  return true;
+#else
+  return false;
+#endif  // HAVE_LZ4
+}
+
+/**
+ * Expands the page data that was compressed with LZ4.  Returns true on
+ * success.  Assumes the lock is held.
+ */
+bool VertexDataPage::
+do_decompress_lz4() {
+#ifdef HAVE_LZ4
+  size_t new_allocated_size = round_up(_uncompressed_size);
+  unsigned char *new_data = alloc_page_data(new_allocated_size);
+
+  int output_size = LZ4_decompress_safe((const char *)_page_data,
+                                        (char *)new_data, (int)_size,
+                                        (int)new_allocated_size);
+  if (output_size < 0 || (size_t)output_size != _uncompressed_size) {
+    free_page_data(new_data, new_allocated_size);
+    nassert_raise("lz4 error");
+    return false;
+  }
+
+  replace_page_data(new_data, _uncompressed_size, new_allocated_size);
+  return true;
+#else
+  return false;
+#endif  // HAVE_LZ4
+}
+
+/**
+ * Compresses the resident page data with zstd, replacing it with the
+ * compressed data.  Returns true on success.  Assumes the lock is held.
+ */
+bool VertexDataPage::
+do_compress_zstd() {
+#ifdef HAVE_ZSTD
+  size_t bound = ZSTD_compressBound(_uncompressed_size);
+  void *buffer = PANDA_MALLOC_ARRAY(bound);
+
+  size_t output_size = ZSTD_compress(buffer, bound, _page_data,
+                                     _uncompressed_size,
+                                     vertex_data_compression_level);
+  if (ZSTD_isError(output_size)) {
+    PANDA_FREE_ARRAY(buffer);
+    gobj_cat.error()
+      << "zstd error: " << ZSTD_getErrorName(output_size) << "\n";
+    return false;
+  }
+
+  size_t new_allocated_size = round_up(output_size);
+  unsigned char *new_data = alloc_page_data(new_allocated_size);
+  memcpy(new_data, buffer, output_size);
+  PANDA_FREE_ARRAY(buffer);
+
+  replace_page_data(new_data, output_size, new_allocated_size);
+  return true;
+#else
+  return false;
+#endif  // HAVE_ZSTD
+}
+
+/**
+ * Expands the page data that was compressed with zstd.  Returns true on
+ * success.  Assumes the lock is held.
+ */
+bool VertexDataPage::
+do_decompress_zstd() {
+#ifdef HAVE_ZSTD
+  size_t new_allocated_size = round_up(_uncompressed_size);
+  unsigned char *new_data = alloc_page_data(new_allocated_size);
+
+  size_t output_size = ZSTD_decompress(new_data, new_allocated_size,
+                                       _page_data, _size);
+  if (ZSTD_isError(output_size) || output_size != _uncompressed_size) {
+    free_page_data(new_data, new_allocated_size);
+    nassert_raise("zstd error");
+    return false;
   }
+
+  replace_page_data(new_data, _uncompressed_size, new_allocated_size);
+  return true;
+#else
+  return false;
+#endif  // HAVE_ZSTD
+}
+
+/**
+ * Frees the current page data, and replaces it with the indicated buffer,
+ * which was allocated with alloc_page_data().  Assumes the lock is held.
+ */
+void VertexDataPage::
+replace_page_data(unsigned char *new_data, size_t new_size,
+                  size_t new_allocated_size) {
+  free_page_data(_page_data, _allocated_size);
+  _page_data = new_data;
+  _size = new_size;
+  _allocated_size = new_allocated_size;
 }
 
 /**
@@ -796,6 +1294,9 @@ add_page(VertexDataPage *page, RamClass ram_class) {
 
     page->_pending_ram_class = ram_class;
     if (ram_class == RC_resident) {
+      if (page->_request_time == 0.0) {
+        page->_request_time = TrueClock::get_global_ptr()->get_short_time();
+      }
       _pending_reads.push_back(page);
     } else {
       _pending_writes.push_back(page);
@@ -986,3 +1487,50 @@ thread_main() {
     Thread::consider_yield();
   }
 }
+
+/**
+ *
+ */
+std::ostream &
+operator << (std::ostream &out, VertexDataPage::CompressionMethod method) {
+  switch (method) {
+  case VertexDataPage::CM_none:
+    return out << "none";
+
+  case VertexDataPage::CM_zlib:
+    return out << "zlib";
+
+  case VertexDataPage::CM_lz4:
+    return out << "lz4";
+
+  case VertexDataPage::CM_zstd:
+    return out << "zstd";
+  }
+
+  return out << "**invalid CompressionMethod (" << (int)method << ")**";
+}
+
+/**
+ *
+ */
+std::istream &
+operator >> (std::istream &in, VertexDataPage::CompressionMethod &method) {
+  std::string word;
+  in >> word;
+
+  if (cmp_nocase(word, "none") == 0) {
+    method = VertexDataPage::CM_none;
+  } else if (cmp_nocase(word, "zlib") == 0) {
+    method = VertexDataPage::CM_zlib;
+  } else if (cmp_nocase(word, "lz4") == 0) {
+    method = VertexDataPage::CM_lz4;
+  } else if (cmp_nocase(word, "zstd") == 0) {
+    method = VertexDataPage::CM_zstd;
+
+  } else {
+    gobj_cat->error() << "Invalid compression method: " << word << "\n";
+    method = VertexDataPage::CM_zlib;
+  }
+
+  return in;
+}
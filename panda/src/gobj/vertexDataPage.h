@@ -24,6 +24,7 @@
 #include "thread.h"
 #include "mutexHolder.h"
 #include "pdeque.h"
+#include "pvector.h"
 
 class VertexDataBook;
 class VertexDataBlock;
@@ -51,6 +52,15 @@ PUBLISHED:
     RC_end_of_list,  // list marker; do not use
   };
 
+  // The algorithms that may be used to compress pages in RAM.  Only those
+  // that were available when Panda was compiled can actually be used.
+  enum CompressionMethod {
+    CM_none,
+    CM_zlib,
+    CM_lz4,
+    CM_zstd,
+  };
+
   INLINE RamClass get_ram_class() const;
   INLINE RamClass get_pending_ram_class() const;
   INLINE void request_resident();
@@ -67,11 +77,16 @@ PUBLISHED:
 
   INLINE bool save_to_disk();
 
+  static bool has_compression_method(CompressionMethod method);
+  static CompressionMethod get_compression_method();
+  INLINE CompressionMethod get_page_compression_method() const;
+
   INLINE static int get_num_threads();
   INLINE static int get_num_pending_reads();
   INLINE static int get_num_pending_writes();
   static void stop_threads();
   static void flush_threads();
+  static void lru_epoch();
 
   virtual void output(std::ostream &out) const;
   virtual void write(std::ostream &out, int indent_level) const;
@@ -84,17 +99,33 @@ protected:
   virtual SimpleAllocatorBlock *make_block(size_t start, size_t size);
   virtual void changed_contiguous();
   virtual void evict_lru();
+  virtual size_t prefetch_lru();
 
 private:
   class PageThread;
 
   VertexDataBlock *do_alloc(size_t size);
 
+  bool can_defragment() const;
+  void do_count_free(size_t &free_size, size_t &largest_free) const;
+  size_t do_evacuate(const pvector<VertexDataPage *> &targets,
+                     size_t max_bytes, bool &deleted);
+  size_t do_compact(size_t max_bytes);
+
   void make_resident_now();
   void make_resident();
   void make_compressed();
   void make_disk();
 
+  bool do_compress_zlib();
+  bool do_decompress_zlib();
+  bool do_compress_lz4();
+  bool do_decompress_lz4();
+  bool do_compress_zstd();
+  bool do_decompress_zstd();
+  void replace_page_data(unsigned char *new_data, size_t new_size,
+                         size_t new_allocated_size);
+
   bool do_save_to_disk();
   void do_restore_from_disk();
 
@@ -158,6 +189,7 @@ private:
   unsigned char *_page_data;
   size_t _size, _allocated_size, _uncompressed_size;
   RamClass _ram_class;
+  CompressionMethod _compression_method;
   PT(VertexDataSaveBlock) _saved_block;
   size_t _book_size;
   size_t _block_size;
@@ -165,6 +197,10 @@ private:
   // Mutex _lock;   Inherited from SimpleAllocator.  Protects above members.
   RamClass _pending_ram_class;  // Protected by _tlock.
 
+  // The time at which the page was queued to be made resident, for measuring
+  // the page-in latency, or 0 if it is not waiting.
+  double _request_time;
+
   VertexDataBook *_book;  // never changes.
 
   enum { deflate_page_size = 1024, inflate_page_size = 1024 };
@@ -209,6 +245,9 @@ private:
   static PStatCollector _vdata_decompress_pcollector;
   static PStatCollector _vdata_save_pcollector;
   static PStatCollector _vdata_restore_pcollector;
+  static PStatCollector _page_in_latency_pcollector;
+  static PStatCollector _page_in_bytes_pcollector;
+  static PStatCollector _prefetch_bytes_pcollector;
   static PStatCollector _thread_wait_pcollector;
   static PStatCollector _alloc_pages_pcollector;
 
@@ -232,6 +271,9 @@ inline std::ostream &operator << (std::ostream &out, const VertexDataPage &page)
   return out;
 }
 
+EXPCL_PANDA_GOBJ std::ostream &operator << (std::ostream &out, VertexDataPage::CompressionMethod method);
+EXPCL_PANDA_GOBJ std::istream &operator >> (std::istream &in, VertexDataPage::CompressionMethod &method);
+
 #include "vertexDataPage.I"
 
 #endif
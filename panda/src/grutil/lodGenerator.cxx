@@ -0,0 +1,160 @@
+/**
+ * PANDA 3D SOFTWARE
+ * Copyright (c) Carnegie Mellon University.  All rights reserved.
+ *
+ * All use of this software is subject to the terms of the revised BSD
+ * license.  You should have received a copy of this license along
+ * with this source code in a file named "LICENSE."
+ *
+ * @file lodGenerator.cxx
+ * @author djs3000
+ * @date 2026-10-16
+ */
+
+#include "lodGenerator.h"
+#include "lodNode.h"
+#include "geomNode.h"
+#include "geomTriangles.h"
+#include "sceneGraphReducer.h"
+#include "boundingSphere.h"
+#include "config_gobj.h"
+#include "deg_2_rad.h"
+
+#include <cmath>
+
+/**
+ *
+ */
+LODGenerator::
+LODGenerator() :
+  _num_levels(4),
+  _reduction(0.5f),
+  _pixel_error(1.0f),
+  _screen_size(1920),
+  _fov(default_fov)
+{
+}
+
+/**
+ * Generates the levels of detail for the indicated model, and returns a new
+ * LODNode containing them, which may be used in place of the model.  The
+ * first child of the LODNode is a copy of the original model; each
+ * subsequent child has its triangles reduced by the reduction factor.  The
+ * model itself is not modified.
+ *
+ * The errors are measured in the coordinate space of the GeomNodes; any
+ * scale applied to the model below its root is not taken into account.
+ */
+NodePath LODGenerator::
+generate(const NodePath &source) {
+  nassertr_always(!source.is_empty(), NodePath::fail());
+  PandaNode *source_node = source.node();
+
+  PT(LODNode) lod = new LODNode(source_node->get_name());
+  _level_errors.clear();
+
+  LPoint3 center(0.0f, 0.0f, 0.0f);
+  PN_stdfloat radius = 0.0f;
+  {
+    // The LODNode needs the center in its own coordinate space, which
+    // includes the transform on the model.
+    BoundingSphere sphere;
+    CPT(BoundingVolume) bounds = source_node->get_bounds();
+    sphere.extend_by(bounds->as_geometric_bounding_volume());
+    if (!sphere.is_empty() && !sphere.is_infinite()) {
+      center = sphere.get_center() * source_node->get_transform()->get_mat();
+      radius = sphere.get_radius();
+    }
+  }
+  lod->set_center(center);
+
+  for (int level = 0; level < _num_levels; ++level) {
+    PT(PandaNode) copy = source_node->copy_subgraph();
+
+    PN_stdfloat error = 0.0f;
+    if (level > 0) {
+      error = r_simplify(copy, std::pow(_reduction, (PN_stdfloat)level));
+
+      SceneGraphReducer gr;
+      gr.remove_unused_vertices(copy);
+
+      // The error can't be less than the level before it.
+      error = std::max(error, _level_errors.back());
+    }
+    _level_errors.push_back(error);
+    lod->add_child(copy);
+  }
+
+  // Each level is used from the distance at which its error becomes smaller
+  // than the allowed pixel error, up to the distance at which the next
+  // level's does.  The last level is used until the whole model would be
+  // smaller than that.
+  PN_stdfloat out = 0.0f;
+  for (int level = 0; level < _num_levels; ++level) {
+    PN_stdfloat in;
+    if (level + 1 < _num_levels) {
+      in = error_to_distance(_level_errors[level + 1]);
+    } else {
+      in = error_to_distance(radius);
+    }
+    in = std::max(in, out);
+    lod->add_switch(in, out);
+    out = in;
+  }
+
+  return NodePath(lod);
+}
+
+/**
+ * Simplifies all of the triangles at this node and below to the indicated
+ * fraction of their original count.  Returns the largest error introduced.
+ */
+PN_stdfloat LODGenerator::
+r_simplify(PandaNode *node, PN_stdfloat ratio) {
+  PN_stdfloat error = 0.0f;
+
+  if (node->is_geom_node()) {
+    GeomNode *geom_node = DCAST(GeomNode, node);
+    int num_geoms = geom_node->get_num_geoms();
+    for (int i = 0; i < num_geoms; ++i) {
+      PT(Geom) geom = geom_node->modify_geom(i);
+      geom->decompose_in_place();
+
+      CPT(GeomVertexData) vdata = geom->get_vertex_data();
+      size_t num_primitives = geom->get_num_primitives();
+      for (size_t j = 0; j < num_primitives; ++j) {
+        CPT(GeomPrimitive) prim = geom->get_primitive(j);
+        if (!prim->is_exact_type(GeomTriangles::get_class_type())) {
+          continue;
+        }
+
+        int target = (int)std::ceil(prim->get_num_primitives() * ratio);
+        PN_stdfloat prim_error;
+        CPT(GeomPrimitive) new_prim =
+          DCAST(GeomTriangles, prim)->simplify(vdata, target, -1.0f, &prim_error);
+        if (new_prim != prim) {
+          geom->set_primitive(j, new_prim);
+          error = std::max(error, prim_error);
+        }
+      }
+    }
+  }
+
+  PandaNode::Children children = node->get_children();
+  int num_children = children.get_num_children();
+  for (int i = 0; i < num_children; ++i) {
+    error = std::max(error, r_simplify(children.get_child(i), ratio));
+  }
+
+  return error;
+}
+
+/**
+ * Returns the distance from the camera at which an error of the indicated
+ * size appears as large as the allowed pixel error.
+ */
+PN_stdfloat LODGenerator::
+error_to_distance(PN_stdfloat error) const {
+  PN_stdfloat tan_half_fov = std::tan(deg_2_rad(_fov) * 0.5f);
+  return error * (PN_stdfloat)_screen_size / (2.0f * tan_half_fov * _pixel_error);
+}
@@ -0,0 +1,72 @@
+/**
+ * PANDA 3D SOFTWARE
+ * Copyright (c) Carnegie Mellon University.  All rights reserved.
+ *
+ * All use of this software is subject to the terms of the revised BSD
+ * license.  You should have received a copy of this license along
+ * with this source code in a file named "LICENSE."
+ *
+ * @file lodGenerator.h
+ * @author djs3000
+ * @date 2026-10-16
+ */
+
+#ifndef LODGENERATOR_H
+#define LODGENERATOR_H
+
+#include "pandabase.h"
+#include "nodePath.h"
+
+class PandaNode;
+
+/**
+ * This class generates a series of progressively simpler versions of a
+ * model, by simplifying its triangles with GeomTriangles::simplify(), and
+ * wraps them in an LODNode.  The switch distances are chosen so that each
+ * level is used only when the error introduced by simplifying it would
+ * appear smaller than a given number of pixels on the screen.
+ */
+class EXPCL_PANDA_GRUTIL LODGenerator {
+PUBLISHED:
+  LODGenerator();
+
+  INLINE void set_num_levels(int num_levels);
+  INLINE int get_num_levels() const;
+  MAKE_PROPERTY(num_levels, get_num_levels, set_num_levels);
+
+  INLINE void set_reduction(PN_stdfloat reduction);
+  INLINE PN_stdfloat get_reduction() const;
+  MAKE_PROPERTY(reduction, get_reduction, set_reduction);
+
+  INLINE void set_pixel_error(PN_stdfloat pixel_error);
+  INLINE PN_stdfloat get_pixel_error() const;
+  MAKE_PROPERTY(pixel_error, get_pixel_error, set_pixel_error);
+
+  INLINE void set_screen_size(int screen_size);
+  INLINE int get_screen_size() const;
+  MAKE_PROPERTY(screen_size, get_screen_size, set_screen_size);
+
+  INLINE void set_fov(PN_stdfloat fov);
+  INLINE PN_stdfloat get_fov() const;
+  MAKE_PROPERTY(fov, get_fov, set_fov);
+
+  NodePath generate(const NodePath &source);
+
+  INLINE PN_stdfloat get_level_error(int n) const;
+
+private:
+  PN_stdfloat r_simplify(PandaNode *node, PN_stdfloat ratio);
+  PN_stdfloat error_to_distance(PN_stdfloat error) const;
+
+  int _num_levels;
+  PN_stdfloat _reduction;
+  PN_stdfloat _pixel_error;
+  int _screen_size;
+  PN_stdfloat _fov;
+
+  pvector<PN_stdfloat> _level_errors;
+};
+
+#include "lodGenerator.I"
+
+#endif
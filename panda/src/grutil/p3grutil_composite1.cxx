@@ -4,6 +4,7 @@
 #include "shaderTerrainMesh.cxx"
 #include "config_grutil.cxx"
 #include "lineSegs.cxx"
+#include "lodGenerator.cxx"
 #include "fisheyeMaker.cxx"
 #include "frameRateMeter.cxx"
 #include "sceneGraphAnalyzerMeter.cxx"
@@ -0,0 +1,349 @@
+/**
+ * PANDA 3D SOFTWARE
+ * Copyright (c) Carnegie Mellon University.  All rights reserved.
+ *
+ * All use of this software is subject to the terms of the revised BSD
+ * license.  You should have received a copy of this license along
+ * with this source code in a file named "LICENSE."
+ *
+ * @file boundingVolumeBatch.cxx
+ * @author djs3000
+ * @date 2026-10-16
+ */
+
+#include "boundingVolumeBatch.h"
+#include "boundingHexahedron.h"
+#include "boundingSphere.h"
+#include "boundingBox.h"
+
+// We only vectorize the single-precision build; SSE2 is always available on
+// x86-64, and NEON on 64-bit ARM.
+#ifndef STDFLOAT_DOUBLE
+#if defined(__SSE2__) || (_M_IX86_FP >= 2) || defined(_M_X64) || defined(_M_AMD64)
+#include <xmmintrin.h>
+#include <emmintrin.h>
+#define BATCH_USE_SSE2
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define BATCH_USE_NEON
+#endif
+#endif
+
+/**
+ * Adds a new volume to the batch.  Its index, for the purpose of
+ * get_result(), is the value of get_num_volumes() before this call.
+ */
+void BoundingVolumeBatch::
+add_volume(const GeometricBoundingVolume *volume) {
+  nassertv(volume != nullptr);
+
+  const BoundingSphere *sphere;
+  const BoundingBox *box;
+  if (volume->is_empty() || volume->is_infinite()) {
+    // These are handled by contains().
+
+  } else if ((sphere = volume->as_bounding_sphere()) != nullptr) {
+    add_sphere(sphere->get_center(), sphere->get_radius());
+    return;
+
+  } else if ((box = volume->as_bounding_box()) != nullptr) {
+    const LPoint3 &min = box->get_minq();
+    const LPoint3 &max = box->get_maxq();
+    LPoint3 center = (min + max) * 0.5f;
+    _center_x.push_back(center[0]);
+    _center_y.push_back(center[1]);
+    _center_z.push_back(center[2]);
+    _extent_x.push_back(max[0] - center[0]);
+    _extent_y.push_back(max[1] - center[1]);
+    _extent_z.push_back(max[2] - center[2]);
+    _radius.push_back(0.0f);
+    return;
+  }
+
+  // We still need a placeholder in the arrays, so that the indices line up.
+  _fallbacks.push_back(Fallbacks::value_type(_center_x.size(), volume));
+  _center_x.push_back(0.0f);
+  _center_y.push_back(0.0f);
+  _center_z.push_back(0.0f);
+  _extent_x.push_back(0.0f);
+  _extent_y.push_back(0.0f);
+  _extent_z.push_back(0.0f);
+  _radius.push_back(0.0f);
+}
+
+/**
+ * Determines how each of the volumes in the batch intersects with the
+ * indicated volume, as if contains() were called on it for each of them.
+ * The results may then be queried with get_result().
+ *
+ * If the given volume is a BoundingHexahedron, this uses vector instructions
+ * where they are available.
+ */
+void BoundingVolumeBatch::
+compute_contains(const GeometricBoundingVolume *volume) {
+  _results.resize(_center_x.size());
+  compute_contains(volume, _results.data());
+}
+
+/**
+ * Like compute_contains(), but never uses vector instructions.  This is
+ * mainly useful for comparing the two.
+ */
+void BoundingVolumeBatch::
+compute_contains_scalar(const GeometricBoundingVolume *volume) {
+  _results.resize(_center_x.size());
+  if (compute_fallback(volume, _results.data(), 0, _results.size())) {
+    return;
+  }
+
+  compute_scalar(volume->as_bounding_hexahedron(), 0, _results.size(),
+                 _results.data());
+
+  for (const Fallbacks::value_type &fallback : _fallbacks) {
+    _results[fallback.first] = volume->contains(fallback.second);
+  }
+}
+
+/**
+ * Like compute_contains(), but stores the results in the indicated array,
+ * which must have room for get_num_volumes() elements, rather than in the
+ * batch itself.  This allows the same batch to be used by several threads at
+ * once.
+ */
+void BoundingVolumeBatch::
+compute_contains(const GeometricBoundingVolume *volume, int *results) const {
+  compute_contains(volume, results, 0, _center_x.size());
+}
+
+/**
+ * Like the above, but only computes the results for the volumes in the range
+ * [begin, end).  The results are still stored at their own index in the
+ * array, so that several threads may each fill in part of the same array.
+ */
+void BoundingVolumeBatch::
+compute_contains(const GeometricBoundingVolume *volume, int *results,
+                 size_t begin, size_t end) const {
+  nassertv(begin <= end && end <= _center_x.size());
+  if (compute_fallback(volume, results, begin, end)) {
+    return;
+  }
+
+  const BoundingHexahedron *frustum = volume->as_bounding_hexahedron();
+#if defined(BATCH_USE_SSE2) || defined(BATCH_USE_NEON)
+  compute_simd(frustum, begin, end, results);
+#else
+  compute_scalar(frustum, begin, end, results);
+#endif
+
+  for (const Fallbacks::value_type &fallback : _fallbacks) {
+    if (fallback.first >= begin && fallback.first < end) {
+      results[fallback.first] = volume->contains(fallback.second);
+    }
+  }
+}
+
+/**
+ * Returns true if compute_contains() can make use of vector instructions on
+ * this platform.
+ */
+bool BoundingVolumeBatch::
+has_simd() {
+#if defined(BATCH_USE_SSE2) || defined(BATCH_USE_NEON)
+  return true;
+#else
+  return false;
+#endif
+}
+
+/**
+ * If the given volume is not something that we can handle in a batch, fills
+ * in the results in the given range by calling contains() on each volume and
+ * returns true.
+ */
+bool BoundingVolumeBatch::
+compute_fallback(const GeometricBoundingVolume *volume, int *results,
+                 size_t begin, size_t end) const {
+  if (volume->as_bounding_hexahedron() != nullptr &&
+      !volume->is_empty() && !volume->is_infinite()) {
+    return false;
+  }
+
+  // We no longer have the original spheres and boxes, so make them up again.
+  // This should be rare; view frustums are always hexahedrons.
+  Fallbacks::const_iterator fi = _fallbacks.begin();
+  while (fi != _fallbacks.end() && fi->first < begin) {
+    ++fi;
+  }
+  for (size_t i = begin; i < end; ++i) {
+    if (fi != _fallbacks.end() && fi->first == i) {
+      results[i] = volume->contains(fi->second);
+      ++fi;
+    } else if (_radius[i] != 0.0f) {
+      BoundingSphere sphere(LPoint3(_center_x[i], _center_y[i], _center_z[i]),
+                            _radius[i]);
+      results[i] = volume->contains(&sphere);
+    } else {
+      LVector3 extent(_extent_x[i], _extent_y[i], _extent_z[i]);
+      LPoint3 center(_center_x[i], _center_y[i], _center_z[i]);
+      BoundingBox box(center - extent, center + extent);
+      results[i] = volume->contains(&box);
+    }
+  }
+  return true;
+}
+
+/**
+ * Tests the volumes in the indicated range against the planes of the
+ * frustum, one at a time.
+ */
+void BoundingVolumeBatch::
+compute_scalar(const BoundingHexahedron *frustum, size_t begin, size_t end,
+               int *results) const {
+  int num_planes = frustum->get_num_planes();
+
+  for (size_t i = begin; i < end; ++i) {
+    int result = BoundingVolume::IF_possible | BoundingVolume::IF_some |
+                 BoundingVolume::IF_all;
+
+    for (int pi = 0; pi < num_planes; ++pi) {
+      LPlane plane = frustum->get_plane(pi);
+      PN_stdfloat dist = plane[0] * _center_x[i] + plane[1] * _center_y[i] +
+                         plane[2] * _center_z[i] + plane[3];
+      PN_stdfloat reach = cabs(plane[0]) * _extent_x[i] +
+                          cabs(plane[1]) * _extent_y[i] +
+                          cabs(plane[2]) * _extent_z[i] + _radius[i];
+
+      if (dist > reach) {
+        // The volume is completely in front of this plane; it's thus
+        // completely outside of the frustum.
+        result = BoundingVolume::IF_no_intersection;
+        break;
+
+      } else if (dist > -reach) {
+        // The volume is not completely behind this plane, but some of it is.
+        result &= ~BoundingVolume::IF_all;
+      }
+    }
+
+    results[i] = result;
+  }
+}
+
+/**
+ * Tests the volumes in the indicated range against the planes of the frustum
+ * four at a time.
+ */
+void BoundingVolumeBatch::
+compute_simd(const BoundingHexahedron *frustum, size_t begin, size_t end,
+             int *results) const {
+#if defined(BATCH_USE_SSE2) || defined(BATCH_USE_NEON)
+  static const int num_planes = 6;
+  nassertv(frustum->get_num_planes() == num_planes);
+
+  float plane_a[num_planes], plane_b[num_planes], plane_c[num_planes];
+  float plane_d[num_planes];
+  float abs_a[num_planes], abs_b[num_planes], abs_c[num_planes];
+  for (int pi = 0; pi < num_planes; ++pi) {
+    LPlane plane = frustum->get_plane(pi);
+    plane_a[pi] = plane[0];
+    plane_b[pi] = plane[1];
+    plane_c[pi] = plane[2];
+    plane_d[pi] = plane[3];
+    abs_a[pi] = cabs(plane[0]);
+    abs_b[pi] = cabs(plane[1]);
+    abs_c[pi] = cabs(plane[2]);
+  }
+
+  static const int all_result =
+    BoundingVolume::IF_possible | BoundingVolume::IF_some | BoundingVolume::IF_all;
+  static const int some_result =
+    BoundingVolume::IF_possible | BoundingVolume::IF_some;
+
+  size_t num_simd = begin + ((end - begin) & ~(size_t)3);
+
+  for (size_t i = begin; i < num_simd; i += 4) {
+    int out_bits, some_bits;
+
+#ifdef BATCH_USE_SSE2
+    __m128 cx = _mm_loadu_ps(&_center_x[i]);
+    __m128 cy = _mm_loadu_ps(&_center_y[i]);
+    __m128 cz = _mm_loadu_ps(&_center_z[i]);
+    __m128 ex = _mm_loadu_ps(&_extent_x[i]);
+    __m128 ey = _mm_loadu_ps(&_extent_y[i]);
+    __m128 ez = _mm_loadu_ps(&_extent_z[i]);
+    __m128 r = _mm_loadu_ps(&_radius[i]);
+    __m128 zero = _mm_setzero_ps();
+    __m128 out = zero;
+    __m128 some = zero;
+
+    for (int pi = 0; pi < num_planes; ++pi) {
+      __m128 dist = _mm_add_ps(
+        _mm_add_ps(_mm_mul_ps(cx, _mm_set1_ps(plane_a[pi])),
+                   _mm_mul_ps(cy, _mm_set1_ps(plane_b[pi]))),
+        _mm_add_ps(_mm_mul_ps(cz, _mm_set1_ps(plane_c[pi])),
+                   _mm_set1_ps(plane_d[pi])));
+      __m128 reach = _mm_add_ps(
+        _mm_add_ps(_mm_mul_ps(ex, _mm_set1_ps(abs_a[pi])),
+                   _mm_mul_ps(ey, _mm_set1_ps(abs_b[pi]))),
+        _mm_add_ps(_mm_mul_ps(ez, _mm_set1_ps(abs_c[pi])), r));
+
+      out = _mm_or_ps(out, _mm_cmpgt_ps(dist, reach));
+      some = _mm_or_ps(some, _mm_cmpgt_ps(_mm_add_ps(dist, reach), zero));
+    }
+
+    out_bits = _mm_movemask_ps(out);
+    some_bits = _mm_movemask_ps(some);
+
+#else  // BATCH_USE_NEON
+    float32x4_t cx = vld1q_f32(&_center_x[i]);
+    float32x4_t cy = vld1q_f32(&_center_y[i]);
+    float32x4_t cz = vld1q_f32(&_center_z[i]);
+    float32x4_t ex = vld1q_f32(&_extent_x[i]);
+    float32x4_t ey = vld1q_f32(&_extent_y[i]);
+    float32x4_t ez = vld1q_f32(&_extent_z[i]);
+    float32x4_t r = vld1q_f32(&_radius[i]);
+    float32x4_t zero = vdupq_n_f32(0.0f);
+    uint32x4_t out = vdupq_n_u32(0);
+    uint32x4_t some = vdupq_n_u32(0);
+
+    for (int pi = 0; pi < num_planes; ++pi) {
+      float32x4_t dist = vdupq_n_f32(plane_d[pi]);
+      dist = vmlaq_n_f32(dist, cx, plane_a[pi]);
+      dist = vmlaq_n_f32(dist, cy, plane_b[pi]);
+      dist = vmlaq_n_f32(dist, cz, plane_c[pi]);
+      float32x4_t reach = r;
+      reach = vmlaq_n_f32(reach, ex, abs_a[pi]);
+      reach = vmlaq_n_f32(reach, ey, abs_b[pi]);
+      reach = vmlaq_n_f32(reach, ez, abs_c[pi]);
+
+      out = vorrq_u32(out, vcgtq_f32(dist, reach));
+      some = vorrq_u32(some, vcgtq_f32(vaddq_f32(dist, reach), zero));
+    }
+
+    uint32_t out_lanes[4], some_lanes[4];
+    vst1q_u32(out_lanes, out);
+    vst1q_u32(some_lanes, some);
+    out_bits = some_bits = 0;
+    for (int lane = 0; lane < 4; ++lane) {
+      out_bits |= (out_lanes[lane] & 1) << lane;
+      some_bits |= (some_lanes[lane] & 1) << lane;
+    }
+#endif
+
+    for (int lane = 0; lane < 4; ++lane) {
+      int result;
+      if (out_bits & (1 << lane)) {
+        result = BoundingVolume::IF_no_intersection;
+      } else if (some_bits & (1 << lane)) {
+        result = some_result;
+      } else {
+        result = all_result;
+      }
+      results[i + lane] = result;
+    }
+  }
+
+  // Do the remainder one at a time.
+  compute_scalar(frustum, num_simd, end, results);
+#endif  // BATCH_USE_SSE2 || BATCH_USE_NEON
+}
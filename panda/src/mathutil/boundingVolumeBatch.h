@@ -0,0 +1,89 @@
+/**
+ * PANDA 3D SOFTWARE
+ * Copyright (c) Carnegie Mellon University.  All rights reserved.
+ *
+ * All use of this software is subject to the terms of the revised BSD
+ * license.  You should have received a copy of this license along
+ * with this source code in a file named "LICENSE."
+ *
+ * @file boundingVolumeBatch.h
+ * @author djs3000
+ * @date 2026-10-16
+ */
+
+#ifndef BOUNDINGVOLUMEBATCH_H
+#define BOUNDINGVOLUMEBATCH_H
+
+#include "pandabase.h"
+
+#include "geometricBoundingVolume.h"
+#include "pointerTo.h"
+#include "pvector.h"
+
+class BoundingHexahedron;
+
+/**
+ * This collects a number of bounding volumes so that they can all be tested
+ * against the same volume, typically a view frustum, in one go.
+ *
+ * BoundingSpheres and BoundingBoxes are stored in structure-of-arrays form,
+ * so that they can be tested against the planes of a BoundingHexahedron
+ * several at a time using SSE2 or NEON instructions, without any virtual
+ * function calls.  Any other kind of volume is passed on to contains().
+ */
+class EXPCL_PANDA_MATHUTIL BoundingVolumeBatch {
+PUBLISHED:
+  INLINE_MATHUTIL BoundingVolumeBatch();
+
+  INLINE_MATHUTIL void clear();
+  INLINE_MATHUTIL void reserve(size_t num_volumes);
+  void add_volume(const GeometricBoundingVolume *volume);
+  INLINE_MATHUTIL size_t get_num_volumes() const;
+
+  void compute_contains(const GeometricBoundingVolume *volume);
+  void compute_contains_scalar(const GeometricBoundingVolume *volume);
+  INLINE_MATHUTIL int get_result(size_t n) const;
+
+  static bool has_simd();
+
+public:
+  INLINE_MATHUTIL void add_sphere(const LPoint3 &center, PN_stdfloat radius);
+
+  void compute_contains(const GeometricBoundingVolume *volume,
+                        int *results) const;
+  void compute_contains(const GeometricBoundingVolume *volume, int *results,
+                        size_t begin, size_t end) const;
+
+private:
+  bool compute_fallback(const GeometricBoundingVolume *volume, int *results,
+                        size_t begin, size_t end) const;
+  void compute_scalar(const BoundingHexahedron *frustum, size_t begin,
+                      size_t end, int *results) const;
+  void compute_simd(const BoundingHexahedron *frustum, size_t begin,
+                    size_t end, int *results) const;
+
+private:
+  // Each volume is stored as a center point and an extent; a box has a half-
+  // size along each axis, and a sphere has a radius.  The distance from the
+  // center at which a plane with normal n touches the volume is then
+  // |n.x| * _extent_x + |n.y| * _extent_y + |n.z| * _extent_z + _radius.
+  typedef pvector<PN_stdfloat> Floats;
+  Floats _center_x;
+  Floats _center_y;
+  Floats _center_z;
+  Floats _extent_x;
+  Floats _extent_y;
+  Floats _extent_z;
+  Floats _radius;
+
+  // These are the volumes that must be tested with contains() instead, along
+  // with their index in the above arrays.
+  typedef pvector<std::pair<size_t, CPT(GeometricBoundingVolume)> > Fallbacks;
+  Fallbacks _fallbacks;
+
+  pvector<int> _results;
+};
+
+#include "boundingVolumeBatch.I"
+
+#endif
@@ -0,0 +1,98 @@
+/**
+ * PANDA 3D SOFTWARE
+ * Copyright (c) Carnegie Mellon University.  All rights reserved.
+ *
+ * All use of this software is subject to the terms of the revised BSD
+ * license.  You should have received a copy of this license along
+ * with this source code in a file named "LICENSE."
+ *
+ * @file test_bounding_batch.cxx
+ * @author djs3000
+ * @date 2026-10-16
+ */
+
+#include "luse.h"
+#include "boundingVolumeBatch.h"
+#include "boundingHexahedron.h"
+#include "boundingSphere.h"
+#include "boundingBox.h"
+#include "randomizer.h"
+#include "trueClock.h"
+#include "pvector.h"
+
+// This compares the time taken to test a number of bounding volumes against a
+// view frustum one at a time with contains(), with the scalar batch path, and
+// with the vectorized batch path.
+
+static const int num_volumes = 1000;
+static const int num_iterations = 2000;
+
+int
+main(int argc, char *argv[]) {
+  LFrustum frustum;
+  frustum.make_perspective(60.0f, 45.0f, 1.0f, 1000.0f);
+  BoundingHexahedron hexahedron(frustum, false);
+
+  Randomizer random(42);
+  pvector<CPT(GeometricBoundingVolume)> volumes;
+  BoundingVolumeBatch batch;
+  for (int i = 0; i < num_volumes; ++i) {
+    LPoint3 center(random.random_real(2000) - 1000,
+                   random.random_real(1200) - 100,
+                   random.random_real(2000) - 1000);
+    PN_stdfloat size = random.random_real(50) + 1;
+    if (i % 2 == 0) {
+      volumes.push_back(new BoundingSphere(center, size));
+    } else {
+      LVector3 extent(size, size * 0.5f, size * 2.0f);
+      volumes.push_back(new BoundingBox(center - extent, center + extent));
+    }
+    batch.add_volume(volumes.back());
+  }
+
+  TrueClock *clock = TrueClock::get_global_ptr();
+
+  // First, the traditional way.
+  pvector<int> expected(num_volumes);
+  double start = clock->get_short_time();
+  for (int n = 0; n < num_iterations; ++n) {
+    for (int i = 0; i < num_volumes; ++i) {
+      expected[i] = hexahedron.contains(volumes[i]);
+    }
+  }
+  double contains_time = clock->get_short_time() - start;
+
+  start = clock->get_short_time();
+  for (int n = 0; n < num_iterations; ++n) {
+    batch.compute_contains_scalar(&hexahedron);
+  }
+  double scalar_time = clock->get_short_time() - start;
+
+  int num_mismatched = 0;
+  for (int i = 0; i < num_volumes; ++i) {
+    if (batch.get_result(i) != expected[i]) {
+      ++num_mismatched;
+    }
+  }
+
+  start = clock->get_short_time();
+  for (int n = 0; n < num_iterations; ++n) {
+    batch.compute_contains(&hexahedron);
+  }
+  double simd_time = clock->get_short_time() - start;
+
+  for (int i = 0; i < num_volumes; ++i) {
+    if (batch.get_result(i) != expected[i]) {
+      ++num_mismatched;
+    }
+  }
+
+  double scale = 1.0e9 / ((double)num_volumes * num_iterations);
+  nout << "contains():        " << contains_time * scale << " ns per volume\n"
+       << "batch, scalar:     " << scalar_time * scale << " ns per volume\n"
+       << "batch, vectorized: " << simd_time * scale << " ns per volume"
+       << (BoundingVolumeBatch::has_simd() ? "\n" : " (not available)\n")
+       << num_mismatched << " mismatched results\n";
+
+  return (num_mismatched == 0) ? 0 : 1;
+}
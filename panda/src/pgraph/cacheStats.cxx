@@ -36,11 +36,11 @@ init() {
 void CacheStats::
 reset(double now) {
 #ifndef NDEBUG
-  _cache_hits = 0;
-  _cache_misses = 0;
-  _cache_adds = 0;
-  _cache_new_adds = 0;
-  _cache_dels = 0;
+  _cache_hits.store(0, std::memory_order_relaxed);
+  _cache_misses.store(0, std::memory_order_relaxed);
+  _cache_adds.store(0, std::memory_order_relaxed);
+  _cache_new_adds.store(0, std::memory_order_relaxed);
+  _cache_dels.store(0, std::memory_order_relaxed);
   _last_reset = now;
 #endif  // NDEBUG
 }
@@ -52,12 +52,16 @@ void CacheStats::
 write(std::ostream &out, const char *name) const {
 #ifndef NDEBUG
   int num_states = _num_states.load(std::memory_order_relaxed);
-  out << name << " cache: " << _cache_hits << " hits, "
-      << _cache_misses << " misses\n"
-      << _cache_adds + _cache_new_adds << "(" << _cache_new_adds << ") adds(new), "
-      << _cache_dels << " dels, "
-      << _total_cache_size << " / " << num_states << " = "
-      << (double)_total_cache_size / (double)num_states
+  int cache_adds = _cache_adds.load(std::memory_order_relaxed);
+  int cache_new_adds = _cache_new_adds.load(std::memory_order_relaxed);
+  int total_cache_size = _total_cache_size.load(std::memory_order_relaxed);
+  out << name << " cache: "
+      << _cache_hits.load(std::memory_order_relaxed) << " hits, "
+      << _cache_misses.load(std::memory_order_relaxed) << " misses\n"
+      << cache_adds + cache_new_adds << "(" << cache_new_adds << ") adds(new), "
+      << _cache_dels.load(std::memory_order_relaxed) << " dels, "
+      << total_cache_size << " / " << num_states << " = "
+      << (double)total_cache_size / (double)num_states
       << " average cache size\n";
 #endif  // NDEBUG
 }
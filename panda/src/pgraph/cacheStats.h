@@ -40,12 +40,14 @@ public:
 
 private:
 #ifndef NDEBUG
-  int _cache_hits = 0;
-  int _cache_misses = 0;
-  int _cache_adds = 0;
-  int _cache_new_adds = 0;
-  int _cache_dels = 0;
-  int _total_cache_size = 0;
+  // These may be updated by multiple threads at once, since the composition
+  // caches can be queried without holding the global lock.
+  patomic<int> _cache_hits {0};
+  patomic<int> _cache_misses {0};
+  patomic<int> _cache_adds {0};
+  patomic<int> _cache_new_adds {0};
+  patomic<int> _cache_dels {0};
+  patomic<int> _total_cache_size {0};
   patomic<int> _num_states {0};
   double _last_reset = 0.0;
 
@@ -31,6 +31,7 @@
 #include "cullBinAttrib.h"
 #include "cullResult.h"
 #include "cullTraverser.h"
+#include "cullTraverserTask.h"
 #include "cullableObject.h"
 #include "decalEffect.h"
 #include "depthBiasAttrib.h"
@@ -58,6 +59,7 @@
 #include "modelFlattenRequest.h"
 #include "modelLoadRequest.h"
 #include "modelSaveRequest.h"
+#include "meshletNode.h"
 #include "modelNode.h"
 #include "modelRoot.h"
 #include "nodePath.h"
@@ -70,6 +72,7 @@
 #include "portalNode.h"
 #include "occluderEffect.h"
 #include "occluderNode.h"
+#include "occlusionBuffer.h"
 #include "portalClipper.h"
 #include "renderAttrib.h"
 #include "renderEffect.h"
@@ -133,6 +136,89 @@ ConfigVariableBool debug_portal_cull
           "(You first need to enable portal culling, using the allow-portal-cull"
           "variable.)"));
 
+ConfigVariableInt cull_num_threads
+("cull-num-threads", 0,
+ PRC_DESC("Set this to a nonzero value to split the cull traversal of large "
+          "scenes across the indicated number of worker threads.  Subtrees "
+          "at cull-parallel-depth are traversed as separate tasks, and "
+          "their results are merged back in traversal order before they "
+          "are binned, so the rendered result is the same as with a serial "
+          "traversal.  The worker threads are started the first time they "
+          "are needed.  This has no effect if Panda was not compiled with "
+          "true threading support."));
+
+ConfigVariableInt cull_parallel_depth
+("cull-parallel-depth", 2,
+ PRC_DESC("When cull-num-threads is nonzero, this specifies the depth below "
+          "the scene root at which subtrees are handed off to the worker "
+          "threads."));
+
+ConfigVariableInt cull_parallel_min_vertices
+("cull-parallel-min-vertices", 1024,
+ PRC_DESC("When cull-num-threads is nonzero, subtrees that contain fewer "
+          "than this number of vertices are traversed inline, rather than "
+          "being handed off to a worker thread, since the overhead of "
+          "scheduling the task would outweigh the benefit."));
+
+ConfigVariableBool cull_parallel_callbacks
+("cull-parallel-callbacks", false,
+ PRC_DESC("When cull-num-threads is nonzero, the cull callbacks of nodes "
+          "such as LODNode and CallbackNode are normally still called on "
+          "the main cull thread: a worker thread that encounters such a "
+          "node hands it back, to be traversed after the worker is done.  "
+          "Set this true if all of the cull callbacks in your scene are "
+          "thread-safe, to let the worker threads call them directly."));
+
+ConfigVariableInt async_animation_threads
+("async-animation-threads", 0,
+ PRC_DESC("Set this to a nonzero value to compute the CPU vertex animation of "
+          "the visible Geoms on the indicated number of worker threads while "
+          "the cull traversal continues, rather than on the cull thread "
+          "itself.  The results are collected just before each Geom is "
+          "drawn.  This has no effect if Panda was not compiled with true "
+          "threading support."));
+
+ConfigVariableInt cull_batch_threshold
+("cull-batch-threshold", 8,
+ PRC_DESC("When a node has at least this many children, or a GeomNode has "
+          "at least this many Geoms, the cull traversal tests all of their "
+          "bounding volumes against the view frustum in one batch, using "
+          "vector instructions where available.  Set this to a very large "
+          "number to always test them one at a time."));
+
+ConfigVariableInt instance_cull_parallel_threshold
+("instance-cull-parallel-threshold", 16384,
+ PRC_DESC("When cull-num-threads is nonzero, an InstancedNode with at least "
+          "this many instances divides the frustum tests of its instances "
+          "among the cull worker threads."));
+
+ConfigVariableBool meshlet_cone_culling
+("meshlet-cone-culling", true,
+ PRC_DESC("Set this true to cull the clusters of a MeshletNode whose "
+          "triangles all face away from the camera, according to the cone "
+          "that bounds their normals.  Set it false to rely on the view "
+          "frustum test alone."));
+
+ConfigVariableBool auto_merge_geoms
+("auto-merge-geoms", false,
+ PRC_DESC("Set this true to combine, at cull time, the small Geoms that share "
+          "the same state and vertex format into larger Geoms, to reduce the "
+          "number of draw calls in scenes with many small objects.  Their "
+          "transforms are applied to the vertices on the CPU.  The combined "
+          "Geoms are reused in subsequent frames for as long as the same "
+          "Geoms remain visible and do not move.  Only Geoms in unsorted or "
+          "state-sorted bins, without a custom shader, are combined."));
+
+ConfigVariableInt auto_merge_max_vertices
+("auto-merge-max-vertices", 256,
+ PRC_DESC("When auto-merge-geoms is true, Geoms with more than this number "
+          "of vertices are drawn by themselves."));
+
+ConfigVariableInt auto_merge_min_geoms
+("auto-merge-min-geoms", 4,
+ PRC_DESC("When auto-merge-geoms is true, Geoms are only combined if at "
+          "least this many of them share the same state and vertex format."));
+
 ConfigVariableBool show_occluder_volumes
 ("show-occluder-volumes", false,
  PRC_DESC("Set this true to enable debug visualization of the volumes used "
@@ -201,12 +287,24 @@ ConfigVariableDouble garbage_collect_states_rate
 ("garbage-collect-states-rate", 1.0,
  PRC_DESC("The fraction of the total number of TransformStates "
           "(or RenderStates, or whatever) that are processed with "
-          "each garbage collection step.  Setting this smaller than "
+          "each garbage collection step.  States that were created since "
+          "the previous step are always processed.  Setting this smaller than "
           "1.0 will collect fewer states each frame, which may require "
           "less processing time, but risks getting unstable cache "
           "performance if states accumulate faster than they can be "
           "cleaned up."));
 
+ConfigVariableInt garbage_collect_states_budget
+("garbage-collect-states-budget", 0,
+ PRC_DESC("The maximum number of TransformStates (or RenderStates) that are "
+          "visited by a single garbage collection step, or 0 for no limit.  "
+          "States created since the previous step are always visited "
+          "first, since most transient states are released soon after "
+          "they are created; the remainder of the budget is spent on "
+          "the older states, resuming where the previous step left off.  "
+          "Setting this puts an upper bound on the time spent in "
+          "garbage collection each frame."));
+
 ConfigVariableBool transform_cache
 ("transform-cache", true,
  PRC_DESC("Set this true to enable the cache of TransformState objects.  "
@@ -307,6 +405,27 @@ ConfigVariableBool flatten_geoms
           "only the NodePath interfaces; you may still make the lower-level "
           "SceneGraphReducer calls directly."));
 
+ConfigVariableBool flatten_optimize_vertices
+("flatten-optimize-vertices", false,
+ PRC_DESC("When this is true, NodePath::flatten_strong() will finish by "
+          "reordering the triangles and vertices of the resulting Geoms for "
+          "better use of the vertex cache, and to reduce overdraw.  See "
+          "SceneGraphReducer::optimize_vertices()."));
+
+ConfigVariableInt optimize_vertex_cache_size
+("optimize-vertex-cache-size", 32,
+ PRC_DESC("The number of entries in the post-transform vertex cache that is "
+          "assumed by SceneGraphReducer::optimize_vertices() and "
+          "calc_acmr().  The result is not very sensitive to the exact "
+          "value."));
+
+ConfigVariableDouble optimize_overdraw_threshold
+("optimize-overdraw-threshold", 1.05,
+ PRC_DESC("The amount by which SceneGraphReducer::optimize_vertices() may "
+          "make the vertex cache miss ratio of a mesh worse, in order to "
+          "reorder its triangles to reduce overdraw.  1.0 means the ratio "
+          "may not get worse at all."));
+
 ConfigVariableInt max_lenses
 ("max-lenses", 100,
  PRC_DESC("Specifies an upper limit on the maximum number of lenses "
@@ -415,6 +534,7 @@ init_libpgraph() {
   CullBinAttrib::init_type();
   CullResult::init_type();
   CullTraverser::init_type();
+  CullTraverserTask::init_type();
   CullableObject::init_type();
   DecalEffect::init_type();
   DepthBiasAttrib::init_type();
@@ -438,6 +558,7 @@ init_libpgraph() {
   LoaderFileTypeBam::init_type();
   LogicOpAttrib::init_type();
   MaterialAttrib::init_type();
+  MeshletNode::init_type();
   ModelFlattenRequest::init_type();
   ModelLoadRequest::init_type();
   ModelSaveRequest::init_type();
@@ -454,6 +575,7 @@ init_libpgraph() {
   PortalNode::init_type();
   OccluderEffect::init_type();
   OccluderNode::init_type();
+  OcclusionBuffer::init_type();
   PortalClipper::init_type();
   RenderAttrib::init_type();
   RenderEffect::init_type();
@@ -505,6 +627,7 @@ init_libpgraph() {
   LightRampAttrib::register_with_read_factory();
   LogicOpAttrib::register_with_read_factory();
   MaterialAttrib::register_with_read_factory();
+  MeshletNode::register_with_read_factory();
   ModelNode::register_with_read_factory();
   ModelRoot::register_with_read_factory();
   PandaNode::register_with_read_factory();
@@ -34,6 +34,17 @@ extern EXPCL_PANDA_PGRAPH ConfigVariableBool fake_view_frustum_cull;
 extern ConfigVariableBool clip_plane_cull;
 extern ConfigVariableBool allow_portal_cull;
 extern ConfigVariableBool debug_portal_cull;
+extern ConfigVariableInt cull_num_threads;
+extern ConfigVariableInt cull_parallel_depth;
+extern ConfigVariableInt cull_parallel_min_vertices;
+extern ConfigVariableBool cull_parallel_callbacks;
+extern ConfigVariableInt async_animation_threads;
+extern ConfigVariableInt cull_batch_threshold;
+extern ConfigVariableInt instance_cull_parallel_threshold;
+extern ConfigVariableBool meshlet_cone_culling;
+extern ConfigVariableBool auto_merge_geoms;
+extern ConfigVariableInt auto_merge_max_vertices;
+extern ConfigVariableInt auto_merge_min_geoms;
 extern ConfigVariableBool show_occluder_volumes;
 extern ConfigVariableBool unambiguous_graph;
 extern ConfigVariableBool detect_graph_cycles;
@@ -45,6 +56,7 @@ extern ConfigVariableBool paranoid_const;
 extern ConfigVariableBool auto_break_cycles;
 extern EXPCL_PANDA_PGRAPH ConfigVariableBool garbage_collect_states;
 extern ConfigVariableDouble garbage_collect_states_rate;
+extern ConfigVariableInt garbage_collect_states_budget;
 extern ConfigVariableBool transform_cache;
 extern ConfigVariableBool state_cache;
 extern ConfigVariableBool uniquify_transforms;
@@ -57,6 +69,9 @@ extern ConfigVariableInt max_collect_indices;
 extern EXPCL_PANDA_PGRAPH ConfigVariableBool premunge_data;
 extern ConfigVariableBool preserve_geom_nodes;
 extern ConfigVariableBool flatten_geoms;
+extern ConfigVariableBool flatten_optimize_vertices;
+extern ConfigVariableInt optimize_vertex_cache_size;
+extern ConfigVariableDouble optimize_overdraw_threshold;
 extern EXPCL_PANDA_PGRAPH ConfigVariableInt max_lenses;
 
 extern ConfigVariableBool polylight_info;
@@ -310,6 +310,9 @@ parse_bin_type(const string &bin_type) {
   } else if (cmp_nocase_uh(bin_type, "front_to_back") == 0) {
     return BT_front_to_back;
 
+  } else if (cmp_nocase_uh(bin_type, "back_to_front_coherent") == 0) {
+    return BT_back_to_front_coherent;
+
   } else {
     return BT_invalid;
   }
@@ -338,6 +341,9 @@ operator << (std::ostream &out, CullBinManager::BinType bin_type) {
 
   case CullBinManager::BT_fixed:
     return out << "fixed";
+
+  case CullBinManager::BT_back_to_front_coherent:
+    return out << "back_to_front_coherent";
   }
 
   return out << "**invalid BinType(" << (int)bin_type << ")**";
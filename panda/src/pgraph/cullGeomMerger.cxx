@@ -0,0 +1,280 @@
+/**
+ * PANDA 3D SOFTWARE
+ * Copyright (c) Carnegie Mellon University.  All rights reserved.
+ *
+ * All use of this software is subject to the terms of the revised BSD
+ * license.  You should have received a copy of this license along
+ * with this source code in a file named "LICENSE."
+ *
+ * @file cullGeomMerger.cxx
+ * @author djs3000
+ * @date 2026-10-16
+ */
+
+#include "cullGeomMerger.h"
+#include "cullResult.h"
+#include "cullTraverser.h"
+#include "cullBinManager.h"
+#include "sceneSetup.h"
+#include "shaderAttrib.h"
+#include "texGenAttrib.h"
+#include "geomTriangles.h"
+#include "geomVertexWriter.h"
+#include "config_pgraph.h"
+#include "pStatTimer.h"
+
+PStatCollector CullGeomMerger::_merge_pcollector("Cull:Merge geoms");
+PStatCollector CullGeomMerger::_rebuild_pcollector("Cull:Merge geoms:Rebuild");
+
+/**
+ *
+ */
+CullGeomMerger::
+CullGeomMerger() {
+}
+
+/**
+ * Offers the indicated object, which has already been munged and is bound
+ * for the indicated bin, for combining with others.  If it is eligible, the
+ * merger takes ownership of it and returns true; it will be added to the bin,
+ * by itself or as part of a combined Geom, in finish_cull().  Otherwise,
+ * returns false and the caller should add it to the bin as usual.
+ */
+bool CullGeomMerger::
+add_object(CullableObject *object, int bin_index,
+           const CullTraverser *traverser) {
+  if (object->_geom == nullptr || object->_munged_data == nullptr ||
+      object->_draw_callback != nullptr || object->_instances != nullptr ||
+      object->_animate_request != nullptr) {
+    return false;
+  }
+
+  // Merging changes the draw order, which only the state-sorted and unsorted
+  // bins don't care about.
+  CullBinManager *bin_manager = CullBinManager::get_global_ptr();
+  CullBinManager::BinType bin_type = bin_manager->get_bin_type(bin_index);
+  if (bin_type != CullBinManager::BT_state_sorted &&
+      bin_type != CullBinManager::BT_unsorted) {
+    return false;
+  }
+
+  const Geom *geom = object->_geom;
+  const GeomVertexData *data = object->_munged_data;
+  if (data->get_num_rows() > auto_merge_max_vertices ||
+      geom->get_primitive_type() != Geom::PT_polygons ||
+      (geom->get_geom_rendering() & Geom::GR_adjacency) != 0) {
+    return false;
+  }
+
+  const GeomVertexFormat *format = data->get_format();
+  if (format->get_animation().get_animation_type() != Geom::AT_none ||
+      data->get_transform_table() != nullptr ||
+      data->get_transform_blend_table() != nullptr ||
+      data->get_slider_table() != nullptr) {
+    return false;
+  }
+
+  // A custom shader may rely on the model matrix, which will be the identity
+  // after the transform has been applied to the vertices.
+  const RenderState *state = object->_state;
+  const ShaderAttrib *shader;
+  if (state->get_attrib(shader) && shader->get_shader() != nullptr) {
+    return false;
+  }
+  const TexGenAttrib *tex_gen;
+  if (state->get_attrib(tex_gen) && !tex_gen->is_empty()) {
+    return false;
+  }
+
+  GroupKey key;
+  key._bin_index = bin_index;
+  key._state = object->_state;
+  key._format = format;
+  key._shade_model = geom->get_shade_model();
+
+  Member member;
+  member._object = object;
+  member._net_transform = traverser->get_scene()->get_cs_world_transform()->
+    invert_compose(object->_internal_transform);
+  _groups[std::move(key)].push_back(std::move(member));
+  return true;
+}
+
+/**
+ * Called after all of the objects have been added, to combine the ones that
+ * were collected and add the results to the bins of the indicated CullResult.
+ * The combined Geoms that were not used this frame are released.
+ */
+void CullGeomMerger::
+finish_cull(CullResult *result, SceneSetup *scene_setup,
+            Thread *current_thread) {
+  if (_groups.empty() && _cache.empty()) {
+    return;
+  }
+  PStatTimer timer(_merge_pcollector, current_thread);
+
+  size_t min_geoms = (size_t)std::max((int)auto_merge_min_geoms, 2);
+  CPT(TransformState) world_transform = scene_setup->get_cs_world_transform();
+
+  Cache cache;
+  for (auto &item : _groups) {
+    const GroupKey &key = item.first;
+    Members &members = item.second;
+    CullBin *bin = result->get_bin(key._bin_index);
+    nassertd(bin != nullptr) {
+      for (Member &member : members) {
+        delete member._object;
+      }
+      continue;
+    }
+
+    if (members.size() < min_geoms) {
+      // Not worth combining.
+      for (Member &member : members) {
+        bin->add_object(member._object, current_thread);
+      }
+      continue;
+    }
+
+    Cache::iterator ci = _cache.find(key);
+    Batches &batches = cache[key];
+
+    // Cut the list into batches that can be indexed with 16 bits.
+    size_t begin = 0;
+    while (begin < members.size()) {
+      size_t end = begin;
+      int num_rows = 0;
+      while (end < members.size()) {
+        int rows = members[end]._object->_munged_data->get_num_rows();
+        if (end > begin && num_rows + rows > 0xffff) {
+          break;
+        }
+        num_rows += rows;
+        ++end;
+      }
+
+      batches.push_back(Batch());
+      Batch &batch = batches.back();
+      size_t bi = batches.size() - 1;
+      if (ci != _cache.end() && bi < (*ci).second.size() &&
+          is_batch_valid((*ci).second[bi], members, begin, end)) {
+        // Nothing changed since last frame.
+        batch = std::move((*ci).second[bi]);
+      } else {
+        make_batch(batch, key, members, begin, end, current_thread);
+      }
+
+      CullableObject *object =
+        new CullableObject(batch._geom, key._state, world_transform);
+      object->_munged_data = batch._data;
+      bin->add_object(object, current_thread);
+
+      for (size_t i = begin; i < end; ++i) {
+        delete members[i]._object;
+      }
+      begin = end;
+    }
+  }
+
+  _groups.clear();
+  _cache.swap(cache);
+}
+
+/**
+ * Returns true if the indicated combined Geom was made from exactly the
+ * indicated range of members.
+ */
+bool CullGeomMerger::
+is_batch_valid(const Batch &batch, const Members &members,
+               size_t begin, size_t end) {
+  if (batch._sources.size() != end - begin) {
+    return false;
+  }
+  for (size_t i = begin; i < end; ++i) {
+    if (!batch._sources[i - begin].matches(members[i])) {
+      return false;
+    }
+  }
+  return true;
+}
+
+/**
+ * Combines the indicated range of members into a single Geom, with their net
+ * transforms applied to the vertices.
+ */
+void CullGeomMerger::
+make_batch(Batch &batch, const GroupKey &key, const Members &members,
+           size_t begin, size_t end, Thread *current_thread) {
+  PStatTimer timer(_rebuild_pcollector, current_thread);
+
+  const GeomVertexFormat *format = key._format;
+  size_t num_arrays = format->get_num_arrays();
+
+  int num_rows = 0;
+  int num_indices = 0;
+  batch._sources.clear();
+  batch._sources.reserve(end - begin);
+  for (size_t i = begin; i < end; ++i) {
+    const CullableObject *object = members[i]._object;
+    num_rows += object->_munged_data->get_num_rows();
+
+    const Geom *geom = object->_geom;
+    for (size_t pi = 0; pi < geom->get_num_primitives(); ++pi) {
+      num_indices += geom->get_primitive(pi)->decompose()->get_num_vertices();
+    }
+
+    Source source;
+    source._geom = object->_geom;
+    source._geom_modified = source._geom->get_modified(current_thread);
+    source._data = object->_munged_data;
+    source._data_modified = source._data->get_modified(current_thread);
+    source._net_transform = members[i]._net_transform;
+    batch._sources.push_back(std::move(source));
+  }
+
+  PT(GeomVertexData) data = new GeomVertexData("merged", format, Geom::UH_dynamic);
+  data->unclean_set_num_rows(num_rows);
+
+  PT(GeomTriangles) triangles = new GeomTriangles(Geom::UH_dynamic);
+  triangles->set_shade_model(key._shade_model);
+  triangles->set_index_type(Geom::NT_uint16);
+  PT(GeomVertexArrayData) indices = triangles->modify_vertices(num_indices);
+
+  {
+    GeomVertexWriter index(indices, 0, current_thread);
+    int row = 0;
+    for (size_t i = begin; i < end; ++i) {
+      const CullableObject *object = members[i]._object;
+      const GeomVertexData *source = object->_munged_data;
+      int source_rows = source->get_num_rows();
+
+      for (size_t ai = 0; ai < num_arrays; ++ai) {
+        size_t stride = format->get_array(ai)->get_stride();
+        CPT(GeomVertexArrayDataHandle) from = source->get_array_handle(ai);
+        PT(GeomVertexArrayDataHandle) to = data->modify_array_handle(ai);
+        to->copy_subdata_from(row * stride, source_rows * stride,
+                              from, 0, source_rows * stride);
+      }
+
+      const TransformState *net_transform = members[i]._net_transform;
+      if (!net_transform->is_identity()) {
+        data->transform_vertices(net_transform->get_mat(), row, row + source_rows);
+      }
+
+      const Geom *geom = object->_geom;
+      for (size_t pi = 0; pi < geom->get_num_primitives(); ++pi) {
+        CPT(GeomPrimitive) prim = geom->get_primitive(pi)->decompose();
+        int num_vertices = prim->get_num_vertices();
+        for (int vi = 0; vi < num_vertices; ++vi) {
+          index.set_data1i(prim->get_vertex(vi) + row);
+        }
+      }
+      row += source_rows;
+    }
+  }
+
+  PT(Geom) geom = new Geom(data);
+  geom->add_primitive(triangles);
+  batch._geom = geom;
+  batch._data = data;
+}
@@ -0,0 +1,116 @@
+/**
+ * PANDA 3D SOFTWARE
+ * Copyright (c) Carnegie Mellon University.  All rights reserved.
+ *
+ * All use of this software is subject to the terms of the revised BSD
+ * license.  You should have received a copy of this license along
+ * with this source code in a file named "LICENSE."
+ *
+ * @file cullGeomMerger.h
+ * @author djs3000
+ * @date 2026-10-16
+ */
+
+#ifndef CULLGEOMMERGER_H
+#define CULLGEOMMERGER_H
+
+#include "pandabase.h"
+#include "referenceCount.h"
+#include "cullableObject.h"
+#include "renderState.h"
+#include "transformState.h"
+#include "geom.h"
+#include "geomVertexData.h"
+#include "geomVertexFormat.h"
+#include "updateSeq.h"
+#include "pmap.h"
+#include "pvector.h"
+#include "pStatCollector.h"
+
+class CullResult;
+class CullTraverser;
+class SceneSetup;
+
+/**
+ * Collects the small Geoms that are added to a CullResult during the cull
+ * traversal, and combines the ones that share the same RenderState and
+ * vertex format into a single Geom, with the transform of each one applied to
+ * its vertices, so that they can be drawn with one call.  This is enabled
+ * with auto-merge-geoms.
+ *
+ * The combined Geoms are kept from one frame to the next, and are reused for
+ * as long as the same Geoms are seen at the same transforms, so a static
+ * scene is only combined once.  The merger is handed from each CullResult to
+ * the next by make_next().
+ */
+class EXPCL_PANDA_PGRAPH CullGeomMerger : public ReferenceCount {
+public:
+  CullGeomMerger();
+
+  bool add_object(CullableObject *object, int bin_index,
+                  const CullTraverser *traverser);
+  void finish_cull(CullResult *result, SceneSetup *scene_setup,
+                   Thread *current_thread);
+
+  INLINE size_t get_num_batches() const;
+
+private:
+  // The Geoms that may be combined with each other.
+  class GroupKey {
+  public:
+    INLINE bool operator < (const GroupKey &other) const;
+
+    int _bin_index;
+    CPT(RenderState) _state;
+    CPT(GeomVertexFormat) _format;
+    Geom::ShadeModel _shade_model;
+  };
+
+  class Member {
+  public:
+    CullableObject *_object;
+    CPT(TransformState) _net_transform;
+  };
+  typedef pvector<Member> Members;
+
+  // Identifies a Geom that went into a combined Geom, so that we can tell
+  // whether the combined Geom is still valid.
+  class Source {
+  public:
+    INLINE bool matches(const Member &member) const;
+
+    CPT(Geom) _geom;
+    UpdateSeq _geom_modified;
+    CPT(GeomVertexData) _data;
+    UpdateSeq _data_modified;
+    CPT(TransformState) _net_transform;
+  };
+  typedef pvector<Source> Sources;
+
+  class Batch {
+  public:
+    Sources _sources;
+    CPT(Geom) _geom;
+    CPT(GeomVertexData) _data;
+  };
+  typedef pvector<Batch> Batches;
+
+  typedef pmap<GroupKey, Members> Groups;
+  typedef pmap<GroupKey, Batches> Cache;
+
+  static bool is_batch_valid(const Batch &batch, const Members &members,
+                             size_t begin, size_t end);
+  static void make_batch(Batch &batch, const GroupKey &key,
+                         const Members &members, size_t begin, size_t end,
+                         Thread *current_thread);
+
+  Groups _groups;
+  Cache _cache;
+
+  static PStatCollector _merge_pcollector;
+  static PStatCollector _rebuild_pcollector;
+};
+
+#include "cullGeomMerger.I"
+
+#endif
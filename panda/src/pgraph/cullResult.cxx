@@ -68,6 +68,10 @@ CullResult(GraphicsStateGuardianBase *gsg,
 #ifndef NDEBUG
   _show_transparency = show_transparency.get_value();
 #endif
+
+  if (auto_merge_geoms) {
+    _merger = new CullGeomMerger;
+  }
 }
 
 /**
@@ -92,6 +96,11 @@ make_next() const {
     }
   }
 
+  if (new_result->_merger != nullptr && _merger != nullptr) {
+    // Keep the merged Geoms from this frame for reuse in the next one.
+    new_result->_merger = _merger;
+  }
+
   return new_result;
 }
 
@@ -253,7 +262,10 @@ add_object(CullableObject *object, const CullTraverser *traverser) {
     // The object may or may not now be fully resident, but this may not
     // matter, since the GSG may have the necessary buffers already loaded.
     // We'll let the GSG ultimately decide whether to render it.
-    bin->add_object(object, current_thread);
+    if (_merger == nullptr ||
+        !_merger->add_object(object, bin_index, traverser)) {
+      bin->add_object(object, current_thread);
+    }
   } else {
     delete object;
   }
@@ -268,6 +280,11 @@ void CullResult::
 finish_cull(SceneSetup *scene_setup, Thread *current_thread) {
   CullBinManager *bin_manager = CullBinManager::get_global_ptr();
 
+  if (_merger != nullptr) {
+    // Add the small Geoms that were held back, combined where possible.
+    _merger->finish_cull(this, scene_setup, current_thread);
+  }
+
   for (size_t i = 0; i < _bins.size(); ++i) {
     if (!bin_manager->get_bin_active(i)) {
       // If the bin isn't active, don't sort it, and don't draw it.  In fact,
@@ -26,6 +26,7 @@
 #include "pset.h"
 #include "pmap.h"
 #include "rescaleNormalAttrib.h"
+#include "cullGeomMerger.h"
 
 class CullTraverser;
 class GraphicsStateGuardianBase;
@@ -86,6 +87,9 @@ private:
   typedef pvector< PT(CullBin) > Bins;
   Bins _bins;
 
+  // This is only set if auto-merge-geoms is enabled.
+  PT(CullGeomMerger) _merger;
+
   bool _show_transparency = false;
 
 public:
@@ -28,6 +28,7 @@
 #include "boundingSphere.h"
 #include "boundingBox.h"
 #include "boundingHexahedron.h"
+#include "boundingVolumeBatch.h"
 #include "portalClipper.h"
 #include "geom.h"
 #include "geomTristrips.h"
@@ -35,12 +36,17 @@
 #include "geomLinestrips.h"
 #include "geomLines.h"
 #include "geomVertexWriter.h"
+#include "cullTraverserTask.h"
+#include "asyncTaskManager.h"
 
 PStatCollector CullTraverser::_nodes_pcollector("Nodes");
 PStatCollector CullTraverser::_geom_nodes_pcollector("Nodes:GeomNodes");
 PStatCollector CullTraverser::_pgui_nodes_pcollector("Nodes:GUI");
 PStatCollector CullTraverser::_geoms_pcollector("Geoms");
 PStatCollector CullTraverser::_geoms_occluded_pcollector("Geoms:Occluded");
+PStatCollector CullTraverser::_nodes_occluded_pcollector("Nodes:Occluded");
+PStatCollector CullTraverser::_instances_pcollector("Instances");
+PStatCollector CullTraverser::_instances_visible_pcollector("Instances:Visible");
 
 TypeHandle CullTraverser::_type_handle;
 
@@ -57,7 +63,10 @@ CullTraverser() :
   _initial_state(RenderState::make_empty()),
   _cull_handler(nullptr),
   _portal_clipper(nullptr),
-  _effective_incomplete_render(false)
+  _effective_incomplete_render(false),
+  _parallel_tasks(nullptr),
+  _depth(0),
+  _defer_task(nullptr)
 {
 }
 
@@ -77,7 +86,11 @@ CullTraverser(const CullTraverser &copy) :
   _view_frustum(copy._view_frustum),
   _cull_handler(copy._cull_handler),
   _portal_clipper(copy._portal_clipper),
-  _effective_incomplete_render(copy._effective_incomplete_render)
+  _effective_incomplete_render(copy._effective_incomplete_render),
+  _occlusion_buffer(copy._occlusion_buffer),
+  _parallel_tasks(nullptr),
+  _depth(0),
+  _defer_task(nullptr)
 {
 }
 
@@ -117,6 +130,10 @@ traverse(const NodePath &root) {
   nassertv(_cull_handler != nullptr);
   nassertv(_scene_setup != nullptr);
 
+  if (_occlusion_buffer != nullptr) {
+    _occlusion_buffer->render(_scene_setup, _current_thread);
+  }
+
   if (allow_portal_cull) {
     // This _view_frustum is in cull_center space Erik: obsolete?
     // PT(GeometricBoundingVolume) vf = _view_frustum;
@@ -160,6 +177,39 @@ traverse(const NodePath &root) {
       do_traverse(my_data);
     }
 
+  } else if (cull_num_threads > 0 && Thread::is_true_threads() &&
+             get_type() == get_class_type()) {
+    // Hand off the subtrees at cull-parallel-depth to the worker threads.
+    // This isn't done for subclasses, since the copy of the traverser made
+    // for each subtree would lose their extra behavior.
+    // Everything we find on this thread is collected in between the subtrees,
+    // so that we can pass it all on in the original traversal order.
+    CullHandler *cull_handler = _cull_handler;
+    ParallelTasks tasks;
+    tasks.push_back(new CullTraverserTask);
+    _cull_handler = tasks.back();
+    _parallel_tasks = &tasks;
+
+    {
+      CullTraverserData data(root, TransformState::make_identity(),
+                             _initial_state, _view_frustum,
+                             _current_thread);
+
+      if (data.is_in_view(_camera_mask)) {
+        do_traverse(data);
+      }
+    }
+
+    _parallel_tasks = nullptr;
+    _cull_handler = cull_handler;
+
+    for (CullTraverserTask *task : tasks) {
+      if (task->has_subtree()) {
+        task->wait();
+      }
+      task->flush(cull_handler, this);
+    }
+
   } else {
     CullTraverserData data(root, TransformState::make_identity(),
                            _initial_state, _view_frustum,
@@ -187,8 +237,30 @@ do_traverse(CullTraverserData &data) {
 
   PandaNode *node = data.node();
   PandaNodePipelineReader *node_reader = data.node_reader();
+
+  if (_occlusion_buffer != nullptr && is_occluded(data)) {
+    // The node is hidden behind the occluders.
+    _nodes_occluded_pcollector.add_level(1);
+    return;
+  }
+
   int fancy_bits = node_reader->get_fancy_bits();
 
+  if (_parallel_tasks != nullptr && _depth == cull_parallel_depth &&
+      node_reader->get_nested_vertices() >= cull_parallel_min_vertices &&
+      ((fancy_bits & PandaNode::FB_cull_callback) == 0 || cull_parallel_callbacks)) {
+    start_parallel_task(data);
+    return;
+  }
+
+  if (_defer_task != nullptr && (fancy_bits & PandaNode::FB_cull_callback) != 0) {
+    // We are on a worker thread, and there is no telling whether this node's
+    // cull callback may safely be called here.  Leave the whole node to the
+    // calling thread; it will traverse it when it merges our results.
+    _defer_task->defer(data);
+    return;
+  }
+
   if ((fancy_bits & ~PandaNode::FB_renderable) == 0 && data._cull_planes == nullptr) {
     // Nothing interesting in this node; just move on.
   }
@@ -203,7 +275,10 @@ do_traverse(CullTraverserData &data) {
     data.apply_transform_and_state(this);
 
     if (fancy_bits & PandaNode::FB_cull_callback) {
-      if (!node->cull_callback(this, data)) {
+      ++_depth;
+      bool keep_going = node->cull_callback(this, data);
+      --_depth;
+      if (!keep_going) {
         return;
       }
     }
@@ -234,9 +309,64 @@ do_traverse(CullTraverserData &data) {
   PandaNode::Children children = node_reader->get_children();
   node_reader->release();
   int num_children = children.get_num_children();
+  ++_depth;
+  if (data._view_frustum != nullptr && num_children >= cull_batch_threshold) {
+    traverse_children_batched(data, children);
+  } else {
+    for (int i = 0; i < num_children; ++i) {
+      const PandaNode::DownConnection &child = children.get_child_connection(i);
+      traverse_down(data, child, data._state);
+    }
+  }
+  --_depth;
+}
+
+/**
+ * Returns true if the node is entirely hidden behind the occluders of the
+ * occlusion buffer.  If the node is below an InstancedNode, this is only true
+ * if all of its instances are hidden.
+ */
+bool CullTraverser::
+is_occluded(CullTraverserData &data) const {
+  const BoundingVolume *bounds = data.node_reader()->get_bounds();
+  const LMatrix4 &net_mat = data._net_transform->get_mat();
+
+  if (data._instances == nullptr) {
+    return _occlusion_buffer->is_occluded(bounds, net_mat);
+  }
+
+  for (const InstanceList::Instance &instance : *data._instances) {
+    if (!_occlusion_buffer->is_occluded(bounds, instance.get_mat() * net_mat)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+/**
+ * Visits all of the given children of the current node, like do_traverse(),
+ * but tests all of their bounding volumes against the view frustum at once.
+ * This is worth doing when a node has many children.
+ */
+void CullTraverser::
+traverse_children_batched(CullTraverserData &data,
+                          const PandaNode::Children &children) {
+  int num_children = children.get_num_children();
+
+  BoundingVolumeBatch batch;
+  batch.reserve(num_children);
+  for (int i = 0; i < num_children; ++i) {
+    batch.add_volume(children.get_child_connection(i).get_bounds());
+  }
+  batch.compute_contains(data._view_frustum);
+
   for (int i = 0; i < num_children; ++i) {
     const PandaNode::DownConnection &child = children.get_child_connection(i);
-    traverse_down(data, child, data._state);
+    int result = BoundingVolume::IF_no_intersection;
+    if (child.compare_draw_mask(data._draw_mask, _camera_mask)) {
+      result = batch.get_result(i);
+    }
+    traverse_down(data, child, data._state, result);
   }
 }
 
@@ -246,6 +376,10 @@ do_traverse(CullTraverserData &data) {
  */
 void CullTraverser::
 end_traverse() {
+  if (!_texture_screen_sizes.empty()) {
+    TextureStreamer::get_global_ptr()->request_screen_sizes(_texture_screen_sizes);
+    _texture_screen_sizes.clear();
+  }
   _cull_handler->end_traverse();
 }
 
@@ -296,6 +430,23 @@ do_fake_cull(const CullTraverserData &data, PandaNode *child,
 #endif
 }
 
+/**
+ * Hands off the traversal of the indicated node, which has already been
+ * checked with is_in_view(), to one of the cull worker threads.  The objects
+ * recorded by this thread from now on are collected separately, so that they
+ * are passed on after those found in the subtree.
+ */
+void CullTraverser::
+start_parallel_task(CullTraverserData &data) {
+  PT(CullTraverserTask) task = new CullTraverserTask(*this, data);
+  task->set_task_chain(CullTraverserTask::get_task_chain()->get_name());
+  AsyncTaskManager::get_global_ptr()->add(task);
+  _parallel_tasks->push_back(std::move(task));
+
+  _parallel_tasks->push_back(new CullTraverserTask);
+  _cull_handler = _parallel_tasks->back();
+}
+
 /**
  * Draws an appropriate visualization of the node's external bounding volume.
  */
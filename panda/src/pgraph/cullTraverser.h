@@ -27,12 +27,16 @@
 #include "typedReferenceCount.h"
 #include "pStatCollector.h"
 #include "fogAttrib.h"
+#include "pvector.h"
+#include "occlusionBuffer.h"
+#include "textureStreamer.h"
 
 class GraphicsStateGuardian;
 class PandaNode;
 class CullHandler;
 class CullableObject;
 class CullTraverserData;
+class CullTraverserTask;
 class PortalClipper;
 class NodePath;
 
@@ -69,6 +73,9 @@ PUBLISHED:
   INLINE void set_view_frustum(GeometricBoundingVolume *view_frustum);
   INLINE GeometricBoundingVolume *get_view_frustum() const;
 
+  INLINE void set_occlusion_buffer(OcclusionBuffer *occlusion_buffer);
+  INLINE OcclusionBuffer *get_occlusion_buffer() const;
+
   INLINE void set_cull_handler(CullHandler *cull_handler);
   INLINE CullHandler *get_cull_handler() const;
 
@@ -99,11 +106,16 @@ public:
   INLINE void traverse_down(const CullTraverserData &data,
                             const PandaNode::DownConnection &child,
                             const RenderState *state);
+  INLINE void traverse_down(const CullTraverserData &data,
+                            const PandaNode::DownConnection &child,
+                            const RenderState *state, int result);
 
   void do_fake_cull(const CullTraverserData &data, PandaNode *child,
                     const TransformState *net_transform,
                     const RenderState *state);
 
+  INLINE void request_texture_screen_size(Texture *tex, PN_stdfloat screen_size);
+
 public:
   // Statistics
   static PStatCollector _nodes_pcollector;
@@ -111,6 +123,9 @@ public:
   static PStatCollector _pgui_nodes_pcollector;
   static PStatCollector _geoms_pcollector;
   static PStatCollector _geoms_occluded_pcollector;
+  static PStatCollector _nodes_occluded_pcollector;
+  static PStatCollector _instances_pcollector;
+  static PStatCollector _instances_visible_pcollector;
 
 private:
   void show_bounds(CullTraverserData &data, bool tight);
@@ -122,6 +137,11 @@ private:
   static const RenderState *get_bounds_inner_viz_state();
   static const RenderState *get_depth_offset_state();
 
+  bool is_occluded(CullTraverserData &data) const;
+  void traverse_children_batched(CullTraverserData &data,
+                                 const PandaNode::Children &children);
+  void start_parallel_task(CullTraverserData &data);
+
   GraphicsStateGuardianBase *_gsg;
   Thread *_current_thread;
   PT(SceneSetup) _scene_setup;
@@ -134,6 +154,22 @@ private:
   CullHandler *_cull_handler;
   PortalClipper *_portal_clipper;
   bool _effective_incomplete_render;
+  PT(OcclusionBuffer) _occlusion_buffer;
+
+  // These are used only while a parallel traversal is in progress; see
+  // cull-num-threads.
+  typedef pvector<PT(CullTraverserTask)> ParallelTasks;
+  ParallelTasks *_parallel_tasks;
+  int _depth;
+
+  // This is set on the copies that run on the worker threads, unless
+  // cull-parallel-callbacks is set.  Nodes with a cull callback are then
+  // handed back to the calling thread through this task.
+  CullTraverserTask *_defer_task;
+
+  // The screen sizes of the streamed textures seen during this traversal.
+  // These are passed on to the TextureStreamer in end_traverse().
+  TextureStreamer::ScreenSizes _texture_screen_sizes;
 
 public:
   static TypeHandle get_class_type() {
@@ -151,6 +187,8 @@ public:
 
 private:
   static TypeHandle _type_handle;
+
+  friend class CullTraverserTask;
 };
 
 #include "cullTraverserData.h"
@@ -0,0 +1,179 @@
+/**
+ * PANDA 3D SOFTWARE
+ * Copyright (c) Carnegie Mellon University.  All rights reserved.
+ *
+ * All use of this software is subject to the terms of the revised BSD
+ * license.  You should have received a copy of this license along
+ * with this source code in a file named "LICENSE."
+ *
+ * @file cullTraverserTask.cxx
+ * @author djs3000
+ * @date 2026-10-16
+ */
+
+#include "cullTraverserTask.h"
+#include "cullableObject.h"
+#include "asyncTaskManager.h"
+#include "config_pgraph.h"
+
+TypeHandle CullTraverserTask::_type_handle;
+
+/**
+ * Creates a task that merely collects the objects recorded by the calling
+ * thread.  It should not be added to a task manager.
+ */
+CullTraverserTask::
+CullTraverserTask() :
+  _pipeline_stage(0),
+  _portal_depth(0)
+{
+}
+
+/**
+ * Creates a task that will traverse the subtree indicated by the data, which
+ * has already been checked with is_in_view(), when it is run.
+ */
+CullTraverserTask::
+CullTraverserTask(const CullTraverser &trav, const CullTraverserData &data) :
+  _trav(new CullTraverser(trav)),
+  _pipeline_stage(trav.get_current_thread()->get_pipeline_stage()),
+  _node_path(data.get_node_path()),
+  _net_transform(data._net_transform),
+  _state(data._state),
+  _view_frustum(data._view_frustum),
+  _cull_planes(data._cull_planes),
+  _instances(data._instances),
+  _draw_mask(data._draw_mask),
+  _portal_depth(data._portal_depth)
+{
+  _trav->set_cull_handler(this);
+  if (!cull_parallel_callbacks) {
+    _trav->_defer_task = this;
+  }
+}
+
+/**
+ * Creates a task that merely stores the indicated node, so that it may be
+ * traversed later by the calling thread.  It should not be added to a task
+ * manager.
+ */
+CullTraverserTask::
+CullTraverserTask(const CullTraverserData &data) :
+  _pipeline_stage(0),
+  _node_path(data.get_node_path()),
+  _net_transform(data._net_transform),
+  _state(data._state),
+  _view_frustum(data._view_frustum),
+  _cull_planes(data._cull_planes),
+  _instances(data._instances),
+  _draw_mask(data._draw_mask),
+  _portal_depth(data._portal_depth)
+{
+}
+
+/**
+ * Deletes any objects that were never flushed, for instance because the
+ * traversal was abandoned.
+ */
+CullTraverserTask::
+~CullTraverserTask() {
+  for (CullableObject *object : _objects) {
+    delete object;
+  }
+}
+
+/**
+ * Stores the object until flush() is called.
+ */
+void CullTraverserTask::
+record_object(CullableObject *object, const CullTraverser *) {
+  _objects.push_back(object);
+}
+
+/**
+ * Called on the worker thread to hand the indicated node, which has already
+ * been checked with is_in_view(), back to the calling thread.  It will be
+ * traversed by flush(), in between the objects recorded before and after it.
+ */
+void CullTraverserTask::
+defer(const CullTraverserData &data) {
+  _deferred.push_back(new CullTraverserTask(data));
+  _objects.push_back(nullptr);
+}
+
+/**
+ * Passes on all of the objects collected so far to the indicated handler, in
+ * the order in which they were recorded.  Any deferred nodes are traversed
+ * with the indicated traverser at this point, which must be using the same
+ * handler.  This must be called by the thread that owns the handler, after
+ * the task has finished.
+ */
+void CullTraverserTask::
+flush(CullHandler *cull_handler, CullTraverser *traverser) {
+  Deferred::const_iterator di = _deferred.begin();
+  for (CullableObject *object : _objects) {
+    if (object != nullptr) {
+      cull_handler->record_object(object, traverser);
+    } else {
+      (*di)->traverse(traverser, traverser->get_current_thread());
+      ++di;
+    }
+  }
+  _objects.clear();
+  _deferred.clear();
+
+  // Pass on the screen sizes of the streamed textures seen by the worker.
+  if (_trav != nullptr) {
+    for (const auto &item : _trav->_texture_screen_sizes) {
+      traverser->request_texture_screen_size(item.first, item.second);
+    }
+    _trav->_texture_screen_sizes.clear();
+  }
+}
+
+/**
+ * Returns the task chain on which the subtrees of a parallel cull traversal
+ * are run.  It is created, with cull-num-threads threads, the first time it is
+ * needed.
+ */
+AsyncTaskChain *CullTraverserTask::
+get_task_chain() {
+  static PT(AsyncTaskChain) chain = [] {
+    AsyncTaskManager *task_mgr = AsyncTaskManager::get_global_ptr();
+    PT(AsyncTaskChain) chain = task_mgr->make_task_chain("cull");
+    chain->set_num_threads(cull_num_threads);
+    return chain;
+  }();
+  return chain;
+}
+
+/**
+ * Traverses the subtree on the current thread.
+ */
+AsyncTask::DoneStatus CullTraverserTask::
+do_task() {
+  nassertr(_trav != nullptr, DS_done);
+
+  // The worker threads are shared between all cull traversals, which may be
+  // running on different pipeline stages.
+  Thread *current_thread = Thread::get_current_thread();
+  current_thread->set_pipeline_stage(_pipeline_stage);
+  _trav->_current_thread = current_thread;
+
+  traverse(_trav, current_thread);
+  return DS_done;
+}
+
+/**
+ * Traverses the stored node with the indicated traverser.
+ */
+void CullTraverserTask::
+traverse(CullTraverser *trav, Thread *current_thread) {
+  CullTraverserData data(_node_path, _net_transform, _state, _view_frustum,
+                         current_thread);
+  data._cull_planes = _cull_planes;
+  data._instances = _instances;
+  data._draw_mask = _draw_mask;
+  data._portal_depth = _portal_depth;
+  trav->do_traverse(data);
+}
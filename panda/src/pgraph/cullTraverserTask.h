@@ -0,0 +1,109 @@
+/**
+ * PANDA 3D SOFTWARE
+ * Copyright (c) Carnegie Mellon University.  All rights reserved.
+ *
+ * All use of this software is subject to the terms of the revised BSD
+ * license.  You should have received a copy of this license along
+ * with this source code in a file named "LICENSE."
+ *
+ * @file cullTraverserTask.h
+ * @author djs3000
+ * @date 2026-10-16
+ */
+
+#ifndef CULLTRAVERSERTASK_H
+#define CULLTRAVERSERTASK_H
+
+#include "pandabase.h"
+
+#include "asyncTask.h"
+#include "asyncTaskChain.h"
+#include "cullHandler.h"
+#include "cullTraverser.h"
+#include "cullTraverserData.h"
+#include "nodePath.h"
+#include "pointerTo.h"
+#include "pvector.h"
+
+/**
+ * This represents one shard of a parallel cull traversal; see
+ * cull-num-threads.  It collects the CullableObjects recorded for one
+ * contiguous part of the traversal, so that they may later be passed on to
+ * the real CullHandler in the same order in which a serial traversal would
+ * have produced them.
+ *
+ * If it is constructed with a subtree, it traverses that subtree when it is
+ * run on one of the cull worker threads.  Otherwise, it merely collects the
+ * objects recorded by the calling thread between two such subtrees.
+ *
+ * Unless cull-parallel-callbacks is set, the worker threads do not call the
+ * cull callbacks of the nodes they encounter, since these may not be thread-
+ * safe.  Such a node is deferred instead, and traversed by the calling thread
+ * when the results are flushed.
+ */
+class EXPCL_PANDA_PGRAPH CullTraverserTask : public AsyncTask, public CullHandler {
+public:
+  ALLOC_DELETED_CHAIN(CullTraverserTask);
+
+  CullTraverserTask();
+  CullTraverserTask(const CullTraverser &trav, const CullTraverserData &data);
+  virtual ~CullTraverserTask();
+
+  INLINE bool has_subtree() const;
+
+  virtual void record_object(CullableObject *object,
+                             const CullTraverser *traverser);
+  void defer(const CullTraverserData &data);
+  void flush(CullHandler *cull_handler, CullTraverser *traverser);
+
+  static AsyncTaskChain *get_task_chain();
+
+protected:
+  virtual AsyncTask::DoneStatus do_task();
+
+private:
+  explicit CullTraverserTask(const CullTraverserData &data);
+  void traverse(CullTraverser *trav, Thread *current_thread);
+
+  PT(CullTraverser) _trav;
+  int _pipeline_stage;
+
+  // A copy of the CullTraverserData at the top of the subtree.  We can't
+  // store the CullTraverserData itself, since it refers to its parents on the
+  // stack of the thread that created it.
+  NodePath _node_path;
+  CPT(TransformState) _net_transform;
+  CPT(RenderState) _state;
+  PT(GeometricBoundingVolume) _view_frustum;
+  CPT(CullPlanes) _cull_planes;
+  CPT(InstanceList) _instances;
+  DrawMask _draw_mask;
+  int _portal_depth;
+
+  // A null pointer in _objects stands for the next of the _deferred nodes.
+  typedef pvector<CullableObject *> Objects;
+  Objects _objects;
+  typedef pvector<PT(CullTraverserTask)> Deferred;
+  Deferred _deferred;
+
+public:
+  static TypeHandle get_class_type() {
+    return _type_handle;
+  }
+  static void init_type() {
+    AsyncTask::init_type();
+    register_type(_type_handle, "CullTraverserTask",
+                  AsyncTask::get_class_type());
+  }
+  virtual TypeHandle get_type() const {
+    return get_class_type();
+  }
+  virtual TypeHandle force_init_type() {init_type(); return get_class_type();}
+
+private:
+  static TypeHandle _type_handle;
+};
+
+#include "cullTraverserTask.I"
+
+#endif
@@ -30,6 +30,7 @@
 #include "geomTriangles.h"
 #include "light.h"
 #include "lightMutexHolder.h"
+#include "asyncTaskManager.h"
 
 CullableObject::FormatMap CullableObject::_format_map;
 LightMutex CullableObject::_format_lock;
@@ -167,11 +168,20 @@ munge_geom(GraphicsStateGuardianBase *gsg, GeomMunger *munger,
     // hardware--then we have to calculate that animation now.
     bool cpu_animated = false;
 
-    CPT(GeomVertexData) animated_vertices =
-      _munged_data->animate_vertices(force, current_thread);
-    if (animated_vertices != _munged_data) {
+    if (async_animation_threads > 0 && _instances == nullptr &&
+        _munged_data->get_format()->get_animation().get_animation_type() == Geom::AT_panda &&
+        Thread::is_true_threads()) {
+      // Let another thread compute the animation while the cull traversal
+      // continues.  draw() picks up the result.
+      start_animation(current_thread);
       cpu_animated = true;
-      std::swap(_munged_data, animated_vertices);
+    } else {
+      CPT(GeomVertexData) animated_vertices =
+        _munged_data->animate_vertices(force, current_thread);
+      if (animated_vertices != _munged_data) {
+        cpu_animated = true;
+        std::swap(_munged_data, animated_vertices);
+      }
     }
 
     if (sattr != nullptr) {
@@ -222,6 +232,36 @@ output(std::ostream &out) const {
   }
 }
 
+/**
+ * Starts computing the animated vertices of _munged_data on one of the
+ * threads of the animation task chain.  The result is cached on the vertex
+ * data, and is picked up by finish_animation().
+ */
+void CullableObject::
+start_animation(Thread *current_thread) {
+  AsyncTaskManager *task_mgr = AsyncTaskManager::get_global_ptr();
+  static PT(AsyncTaskChain) chain = [task_mgr] {
+    PT(AsyncTaskChain) chain = task_mgr->make_task_chain("animation");
+    chain->set_num_threads(async_animation_threads);
+    return chain;
+  }();
+
+  _animate_request = new AnimateVerticesRequest((GeomVertexData *)_munged_data.p());
+  _animate_request->set_task_chain(chain->get_name());
+  task_mgr->add(_animate_request);
+}
+
+/**
+ * Waits for the request started by start_animation() to finish, and replaces
+ * _munged_data with the animated vertices.
+ */
+void CullableObject::
+finish_animation(Thread *current_thread) {
+  _animate_request->wait();
+  _animate_request.clear();
+  _munged_data = _munged_data->animate_vertices(true, current_thread);
+}
+
 /**
  * Returns a GeomVertexData that represents the results of computing the
  * instance arrays for this data.
@@ -31,6 +31,7 @@
 #include "callbackObject.h"
 #include "geomDrawCallbackData.h"
 #include "instanceList.h"
+#include "animateVerticesRequest.h"
 
 class CullTraverser;
 class GeomMunger;
@@ -77,7 +78,12 @@ public:
   CPT(InstanceList) _instances;
   int _num_instances = 1;
 
+  // Set while the vertex animation is being computed on another thread.
+  PT(AnimateVerticesRequest) _animate_request;
+
 private:
+  void start_animation(Thread *current_thread);
+  void finish_animation(Thread *current_thread);
   void munge_instances(Thread *current_thread);
   bool munge_points_to_quads(const CullTraverser *traverser, bool force);
 
@@ -37,6 +37,7 @@
 #include "graphicsStateGuardianBase.h"
 #include "boundingBox.h"
 #include "boundingSphere.h"
+#include "boundingVolumeBatch.h"
 #include "config_mathutil.h"
 #include "preparedGraphicsObjects.h"
 #include "instanceList.h"
@@ -528,7 +529,21 @@ add_for_draw(CullTraverser *trav, CullTraverserData &data) {
     }
   }
   else {
-    // More than one Geom.
+    // More than one Geom.  If there are many, it pays to test all of their
+    // bounding volumes against the view frustum at once.
+    BoundingVolumeBatch batch;
+    bool use_batch = (data._view_frustum != nullptr &&
+                      data._instances == nullptr &&
+                      num_geoms >= cull_batch_threshold);
+    if (use_batch) {
+      batch.reserve(num_geoms);
+      for (int i = 0; i < num_geoms; i++) {
+        CPT(BoundingVolume) geom_volume = geoms.get_geom(i)->get_bounds(current_thread);
+        batch.add_volume(geom_volume->as_geometric_bounding_volume());
+      }
+      batch.compute_contains(data._view_frustum);
+    }
+
     for (int i = 0; i < num_geoms; i++) {
       CPT(Geom) geom = geoms.get_geom(i);
       if (geom->is_empty()) {
@@ -552,8 +567,13 @@ add_for_draw(CullTraverser *trav, CullTraverserData &data) {
       }
 
       // Cull the individual Geom against the view frustum.
-      if (data._view_frustum != nullptr &&
-          !geom->is_in_view(data._view_frustum, current_thread)) {
+      if (use_batch) {
+        if (batch.get_result(i) == BoundingVolume::IF_no_intersection) {
+          // Cull this Geom.
+          continue;
+        }
+      } else if (data._view_frustum != nullptr &&
+                 !geom->is_in_view(data._view_frustum, current_thread)) {
         // Cull this Geom.
         continue;
       }
@@ -944,6 +944,27 @@ finish_apply() {
   _reversed_normals.clear();
 }
 
+/**
+ * Reorders the vertices of each GeomVertexData registered with
+ * register_vertices() into the order in which they are first referenced by
+ * the primitives of the associated Geoms.  This improves the locality of
+ * vertex fetches, especially after the primitives have been reordered with
+ * Geom::optimize_vertex_cache_in_place().
+ *
+ * All of the Geoms sharing a particular GeomVertexData must be registered,
+ * or the ones that weren't will be left pointing at the wrong vertices.
+ */
+void GeomTransformer::
+optimize_vertex_fetch() {
+  VertexDataAssocMap::iterator vi;
+  for (vi = _vdata_assoc.begin(); vi != _vdata_assoc.end(); ++vi) {
+    const GeomVertexData *vdata = (*vi).first;
+    VertexDataAssoc &assoc = (*vi).second;
+    assoc.optimize_vertex_fetch(vdata);
+  }
+  _vdata_assoc.clear();
+}
+
 /**
  * Collects together GeomVertexDatas from different geoms into one big (or
  * several big) GeomVertexDatas.  Returns the number of unique GeomVertexDatas
@@ -1565,3 +1586,132 @@ remove_unused_vertices(const GeomVertexData *vdata) {
     geom->set_vertex_data(new_vdata);
   }
 }
+
+/**
+ * Reorders the vertices of the indicated GeomVertexData into first-use order
+ * by the associated Geoms, and reindexes the Geoms accordingly.  Vertices
+ * that are not referenced at all are moved to the end.
+ */
+void GeomTransformer::VertexDataAssoc::
+optimize_vertex_fetch(const GeomVertexData *vdata) {
+  if (_geoms.empty()) {
+    // Trivial case.
+    return;
+  }
+
+  if (vdata->get_slider_table() != nullptr) {
+    // We don't attempt to remap the rows of the slider table.
+    return;
+  }
+
+  PT(Thread) current_thread = Thread::get_current_thread();
+
+  int num_vertices = vdata->get_num_rows();
+  pvector<int> remap_array(num_vertices, -1);
+  int new_index = 0;
+
+  GeomList::iterator gi;
+  for (gi = _geoms.begin(); gi != _geoms.end(); ++gi) {
+    Geom *geom = (*gi);
+    if (geom->get_vertex_data() != vdata) {
+      continue;
+    }
+
+    int num_primitives = geom->get_num_primitives();
+    for (int i = 0; i < num_primitives; ++i) {
+      GeomPrimitivePipelineReader reader(geom->get_primitive(i), current_thread);
+      int num_prim_vertices = reader.get_num_vertices();
+      for (int vi = 0; vi < num_prim_vertices; ++vi) {
+        int index = reader.get_vertex(vi);
+        nassertv(index >= 0 && index < num_vertices);
+        if (remap_array[index] < 0) {
+          remap_array[index] = new_index++;
+        }
+      }
+    }
+  }
+
+  bool is_identity = true;
+  for (int index = 0; index < num_vertices; ++index) {
+    if (remap_array[index] < 0) {
+      remap_array[index] = new_index++;
+    }
+    if (remap_array[index] != index) {
+      is_identity = false;
+    }
+  }
+  nassertv(new_index == num_vertices);
+
+  if (is_identity) {
+    // Already in the optimal order.
+    return;
+  }
+
+  // Now recopy the actual vertex data, one array at a time.
+  PT(GeomVertexData) new_vdata = new GeomVertexData(*vdata);
+  new_vdata->unclean_set_num_rows(num_vertices);
+
+  size_t num_arrays = vdata->get_num_arrays();
+  nassertv(num_arrays == new_vdata->get_num_arrays());
+
+  GeomVertexDataPipelineReader reader(vdata, current_thread);
+  reader.check_array_readers();
+  GeomVertexDataPipelineWriter writer(new_vdata, true, current_thread);
+  writer.check_array_writers();
+
+  for (size_t a = 0; a < num_arrays; ++a) {
+    const GeomVertexArrayDataHandle *array_reader = reader.get_array_reader(a);
+    GeomVertexArrayDataHandle *array_writer = writer.get_array_writer(a);
+
+    int stride = array_reader->get_array_format()->get_stride();
+    nassertv(stride == array_writer->get_array_format()->get_stride());
+
+    for (int index = 0; index < num_vertices; ++index) {
+      array_writer->copy_subdata_from(remap_array[index] * stride, stride,
+                                      array_reader,
+                                      index * stride, stride);
+    }
+  }
+
+  // Update the rows in the TransformBlendTable, if any.  These are no longer
+  // likely to be contiguous.
+  PT(TransformBlendTable) tbtable = new_vdata->modify_transform_blend_table();
+  if (!tbtable.is_null()) {
+    const SparseArray &rows = tbtable->get_rows();
+    SparseArray new_rows;
+    int num_subranges = rows.get_num_subranges();
+    for (int si = 0; si < num_subranges; ++si) {
+      int from = rows.get_subrange_begin(si);
+      int to = rows.get_subrange_end(si);
+      nassertv(from >= 0 && from < num_vertices && to > from && to <= num_vertices);
+      for (int index = from; index < to; ++index) {
+        new_rows.set_bit(remap_array[index]);
+      }
+    }
+    tbtable->set_rows(new_rows);
+  }
+
+  // Finally, reindex the Geoms.
+  for (gi = _geoms.begin(); gi != _geoms.end(); ++gi) {
+    Geom *geom = (*gi);
+    if (geom->get_vertex_data() != vdata) {
+      continue;
+    }
+
+    int num_primitives = geom->get_num_primitives();
+    for (int i = 0; i < num_primitives; ++i) {
+      PT(GeomPrimitive) prim = geom->modify_primitive(i);
+      prim->make_indexed();
+      PT(GeomVertexArrayData) vertices = prim->modify_vertices();
+      GeomVertexRewriter rewriter(vertices, 0, current_thread);
+
+      while (!rewriter.is_at_end()) {
+        int index = rewriter.get_data1i();
+        nassertv(index >= 0 && index < num_vertices);
+        rewriter.set_data1i(remap_array[index]);
+      }
+    }
+
+    geom->set_vertex_data(new_vdata);
+  }
+}
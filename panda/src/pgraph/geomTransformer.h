@@ -83,6 +83,7 @@ public:
   bool reverse(GeomNode *node);
 
   void finish_apply();
+  void optimize_vertex_fetch();
 
   int collect_vertex_data(Geom *geom, int collect_bits, bool format_only);
   int collect_vertex_data(GeomNode *node, int collect_bits, bool format_only);
@@ -104,6 +105,7 @@ private:
     bool _might_have_unused;
     GeomList _geoms;
     void remove_unused_vertices(const GeomVertexData *vdata);
+    void optimize_vertex_fetch(const GeomVertexData *vdata);
   };
   typedef pmap<CPT(GeomVertexData), VertexDataAssoc> VertexDataAssocMap;
   VertexDataAssocMap _vdata_assoc;
@@ -14,8 +14,13 @@
 #include "instancedNode.h"
 #include "boundingBox.h"
 #include "boundingSphere.h"
+#include "cullTraverser.h"
 #include "cullTraverserData.h"
 #include "cullPlanes.h"
+#include "config_pgraph.h"
+#include "lightMutexHolder.h"
+#include "asyncTaskManager.h"
+#include "genericAsyncTask.h"
 
 TypeHandle InstancedNode::_type_handle;
 TypeHandle InstancedNode::CData::_type_handle;
@@ -25,7 +30,9 @@ TypeHandle InstancedNode::CData::_type_handle;
  */
 InstancedNode::
 InstancedNode(const std::string &name) :
-  PandaNode(name)
+  PandaNode(name),
+  _instances_pcollector(CullTraverser::_instances_pcollector, name),
+  _instances_visible_pcollector(CullTraverser::_instances_visible_pcollector, name)
 {
   set_cull_callback();
 }
@@ -36,8 +43,11 @@ InstancedNode(const std::string &name) :
 InstancedNode::
 InstancedNode(const InstancedNode &copy) :
   PandaNode(copy),
-  _cycler(copy._cycler)
+  _cycler(copy._cycler),
+  _instances_pcollector(CullTraverser::_instances_pcollector, copy.get_name()),
+  _instances_visible_pcollector(CullTraverser::_instances_visible_pcollector, copy.get_name())
 {
+  // The cull cache is not copied; it refers to our children.
   set_cull_callback();
 }
 
@@ -46,6 +56,8 @@ InstancedNode(const InstancedNode &copy) :
  */
 InstancedNode::
 ~InstancedNode() {
+  _instances_pcollector.clear_level();
+  _instances_visible_pcollector.clear_level();
 }
 
 /**
@@ -218,20 +230,31 @@ cull_callback(CullTraverser *trav, CullTraverserData &data) {
     instances = new_list;
   }
 
-  if (data._view_frustum != nullptr || data._cull_planes != nullptr) {
-    // Culling is on, so we need to figure out which instances should be culled.
-    BitArray culled_instances;
-    culled_instances.set_range(0, instances->size());
+  size_t num_instances = instances->size();
+  BitArray culled_instances;
 
-    for (size_t ii = 0; ii < instances->size(); ++ii) {
-      if (data.is_instance_in_view((*instances)[ii].get_transform(), trav->get_camera_mask())) {
-        culled_instances.clear_bit(ii);
-      }
+  bool has_cull_planes = (data._cull_planes != nullptr && !data._cull_planes->is_empty());
+  if (data._view_frustum != nullptr || has_cull_planes) {
+    // Culling is on, so we need to figure out which instances should be
+    // culled.  We test the bounding spheres of all of the instances against
+    // the frustum at once.  If this is a list we made up above, it will be
+    // different next frame, so there's no use keeping the spheres around.
+    CPT(CullCache) cache = get_cull_cache(instances, data._instances == nullptr,
+                                          current_thread);
+    if (data._view_frustum != nullptr) {
+      compute_culled_instances(culled_instances, cache, data._view_frustum);
     }
+    if (has_cull_planes) {
+      // The clip planes and occluders are tested one instance at a time.
+      compute_plane_culled_instances(culled_instances, cache,
+                                     data._cull_planes, data._state);
+    }
+  }
 
-    if (!culled_instances.is_zero() && trav->get_fake_view_frustum_cull()) {
+  if (!culled_instances.is_zero()) {
+    if (trav->get_fake_view_frustum_cull()) {
       // The culled instances are drawn with the fake-view-frustum-cull effect.
-      data._instances = instances->without(culled_instances ^ BitArray::range(0, instances->size()));
+      data._instances = instances->without(culled_instances ^ BitArray::range(0, num_instances));
 
       Children children = data.node_reader()->get_children();
       int num_children = children.get_num_children();
@@ -243,6 +266,13 @@ cull_callback(CullTraverser *trav, CullTraverserData &data) {
     instances = instances->without(culled_instances);
   }
 
+#ifdef DO_PSTATS
+  CullTraverser::_instances_pcollector.add_level(num_instances);
+  CullTraverser::_instances_visible_pcollector.add_level(instances->size());
+  _instances_pcollector.set_level(num_instances);
+  _instances_visible_pcollector.set_level(instances->size());
+#endif
+
   if (instances->empty()) {
     // There are no instances, or they are all culled away.
     return false;
@@ -258,6 +288,207 @@ cull_callback(CullTraverser *trav, CullTraverserData &data) {
   return true;
 }
 
+/**
+ * Returns the bounding spheres of the given instances, relative to this node.
+ * If keep is true, they are saved for next time, and reused if the instances
+ * and the bounds of our children are still the same.
+ */
+CPT(InstancedNode::CullCache) InstancedNode::
+get_cull_cache(const InstanceList *instances, bool keep,
+               Thread *current_thread) const {
+  // The bounds sequence changes whenever the bounds of any of our children,
+  // or our list of instances, have changed.
+  UpdateSeq seq;
+  get_bounds(seq, current_thread);
+
+  if (keep) {
+    LightMutexHolder holder(_cull_cache_lock);
+    if (_cull_cache != nullptr && _cull_cache->_instances == instances &&
+        _cull_cache->_bounds_seq == seq) {
+      return _cull_cache;
+    }
+  }
+
+  PT(CullCache) cache = new CullCache;
+  cache->_instances = instances;
+  cache->_bounds_seq = seq;
+  cache->_infinite = false;
+  cache->_radius = 0;
+
+  // Find a sphere around all of our children.  This is placed by each of the
+  // instance transforms, scaled by their largest axis.
+  Children children = get_children(current_thread);
+  int num_children = children.get_num_children();
+  pvector<const GeometricBoundingVolume *> volumes;
+  volumes.reserve(num_children);
+  for (int i = 0; i < num_children; ++i) {
+    const GeometricBoundingVolume *child_gbv = children.get_child_connection(i).get_bounds();
+    if (child_gbv != nullptr) {
+      volumes.push_back(child_gbv);
+    }
+  }
+
+  BoundingSphere sphere;
+  if (!volumes.empty()) {
+    sphere.around(&volumes[0], &volumes[0] + volumes.size());
+  }
+
+  if (sphere.is_infinite()) {
+    cache->_infinite = true;
+
+  } else if (!sphere.is_empty()) {
+    cache->_center = sphere.get_center();
+    cache->_radius = sphere.get_radius();
+
+    cache->_batch.reserve(instances->size());
+    for (const InstanceList::Instance &instance : *instances) {
+      const LMatrix4 &mat = instance.get_mat();
+      cache->_batch.add_sphere(mat.xform_point(cache->_center),
+                               cache->get_instance_radius(mat));
+    }
+  }
+
+  if (keep) {
+    LightMutexHolder holder(_cull_cache_lock);
+    _cull_cache = cache;
+  }
+  return cache;
+}
+
+namespace {
+  // One part of the instances to be tested against the view frustum by one
+  // of the cull worker threads.
+  struct InstanceCullChunk {
+    const BoundingVolumeBatch *_batch;
+    const GeometricBoundingVolume *_view_frustum;
+    int *_results;
+    size_t _begin;
+    size_t _end;
+  };
+
+  AsyncTask::DoneStatus
+  cull_instance_chunk(GenericAsyncTask *task, void *user_data) {
+    const InstanceCullChunk *chunk = (const InstanceCullChunk *)user_data;
+    chunk->_batch->compute_contains(chunk->_view_frustum, chunk->_results,
+                                    chunk->_begin, chunk->_end);
+    return AsyncTask::DS_done;
+  }
+}
+
+/**
+ * Sets a bit in culled_instances for each instance whose bounding sphere is
+ * outside of the view frustum.  If there are many instances, the work is
+ * divided among the cull worker threads.
+ */
+void InstancedNode::
+compute_culled_instances(BitArray &culled_instances, const CullCache *cache,
+                         const GeometricBoundingVolume *view_frustum) {
+  if (cache->_infinite) {
+    return;
+  }
+
+  size_t num_instances = cache->_instances->size();
+  const BoundingVolumeBatch &batch = cache->_batch;
+  if (batch.get_num_volumes() != num_instances) {
+    // There is nothing to see under this node.
+    culled_instances.set_range(0, num_instances);
+    return;
+  }
+
+  pvector<int> results(num_instances);
+
+  if (cull_num_threads > 0 && Thread::is_true_threads() &&
+      num_instances >= (size_t)instance_cull_parallel_threshold) {
+    // This is a separate chain from the one used by the parallel cull
+    // traversal, since we may be called from one of its threads.
+    AsyncTaskManager *task_mgr = AsyncTaskManager::get_global_ptr();
+    static PT(AsyncTaskChain) chain = [task_mgr] {
+      PT(AsyncTaskChain) chain = task_mgr->make_task_chain("instance_cull");
+      chain->set_num_threads(cull_num_threads);
+      return chain;
+    }();
+
+    // This thread does the last chunk itself, while it waits for the others.
+    // The chunks are kept to a multiple of four, to keep the vector loop full.
+    size_t num_chunks = cull_num_threads + 1;
+    size_t chunk_size = ((num_instances + num_chunks - 1) / num_chunks + 3) & ~(size_t)3;
+
+    pvector<InstanceCullChunk> chunks;
+    chunks.reserve(num_chunks);
+    for (size_t begin = 0; begin < num_instances; begin += chunk_size) {
+      InstanceCullChunk chunk;
+      chunk._batch = &batch;
+      chunk._view_frustum = view_frustum;
+      chunk._results = results.data();
+      chunk._begin = begin;
+      chunk._end = std::min(begin + chunk_size, num_instances);
+      chunks.push_back(chunk);
+    }
+
+    pvector<PT(AsyncTask)> tasks;
+    tasks.reserve(chunks.size() - 1);
+    for (size_t ci = 0; ci + 1 < chunks.size(); ++ci) {
+      PT(AsyncTask) task = new GenericAsyncTask("instance_cull", &cull_instance_chunk, &chunks[ci]);
+      task->set_task_chain(chain->get_name());
+      task_mgr->add(task);
+      tasks.push_back(std::move(task));
+    }
+
+    cull_instance_chunk(nullptr, &chunks.back());
+
+    for (AsyncTask *task : tasks) {
+      task->wait();
+    }
+  } else {
+    batch.compute_contains(view_frustum, results.data());
+  }
+
+  for (size_t ii = 0; ii < num_instances; ++ii) {
+    if (results[ii] == BoundingVolume::IF_no_intersection) {
+      culled_instances.set_bit(ii);
+    }
+  }
+}
+
+/**
+ * Sets a bit in culled_instances for each instance whose bounding sphere is
+ * completely behind one of the clip planes or completely hidden by one of the
+ * occluders.  Instances that are already culled are not tested again.
+ */
+void InstancedNode::
+compute_plane_culled_instances(BitArray &culled_instances,
+                               const CullCache *cache,
+                               const CullPlanes *planes,
+                               const RenderState *state) {
+  if (cache->_infinite) {
+    return;
+  }
+
+  size_t num_instances = cache->_instances->size();
+  if (cache->_batch.get_num_volumes() != num_instances) {
+    // There is nothing to see under this node.
+    culled_instances.set_range(0, num_instances);
+    return;
+  }
+
+  for (size_t ii = 0; ii < num_instances; ++ii) {
+    if (culled_instances.get_bit(ii)) {
+      continue;
+    }
+    const LMatrix4 &mat = (*cache->_instances)[ii].get_mat();
+    BoundingSphere sphere(mat.xform_point(cache->_center),
+                          cache->get_instance_radius(mat));
+
+    // do_cull() may remove planes from the state, which we don't care about.
+    CPT(RenderState) instance_state = state;
+    int result;
+    planes->do_cull(result, instance_state, &sphere);
+    if (result == BoundingVolume::IF_no_intersection) {
+      culled_instances.set_bit(ii);
+    }
+  }
+}
+
 /**
  *
  */
@@ -18,6 +18,11 @@
 #include "pandaNode.h"
 #include "copyOnWritePointer.h"
 #include "instanceList.h"
+#include "boundingVolumeBatch.h"
+#include "bitArray.h"
+#include "lightMutex.h"
+#include "updateSeq.h"
+#include "pStatCollector.h"
 
 /**
  * This is a special node that instances its contents using a list of
@@ -75,6 +80,40 @@ protected:
                                        Thread *current_thread) const override;
 
 private:
+  // The bounding spheres of the instances, relative to this node, so that they
+  // can be tested against the view frustum all at once.  This is kept for as
+  // long as the instance list and the bounds of the children don't change.
+  class CullCache : public ReferenceCount {
+  public:
+    CPT(InstanceList) _instances;
+    UpdateSeq _bounds_seq;
+    bool _infinite;
+    BoundingVolumeBatch _batch;
+
+    // The sphere around the children, before the instance transforms.
+    LPoint3 _center;
+    PN_stdfloat _radius;
+
+    INLINE PN_stdfloat get_instance_radius(const LMatrix4 &mat) const;
+  };
+
+  CPT(CullCache) get_cull_cache(const InstanceList *instances,
+                                bool keep, Thread *current_thread) const;
+  static void compute_culled_instances(BitArray &culled_instances,
+                                       const CullCache *cache,
+                                       const GeometricBoundingVolume *view_frustum);
+  static void compute_plane_culled_instances(BitArray &culled_instances,
+                                             const CullCache *cache,
+                                             const CullPlanes *planes,
+                                             const RenderState *state);
+
+  mutable LightMutex _cull_cache_lock;
+  mutable CPT(CullCache) _cull_cache;
+
+  // The instance counts of this node, as of the last time it was culled.
+  PStatCollector _instances_pcollector;
+  PStatCollector _instances_visible_pcollector;
+
   // This is the data that must be cycled between pipeline stages.
   class EXPCL_PANDA_PGRAPH CData final : public CycleData {
   public:
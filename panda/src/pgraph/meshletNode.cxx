@@ -0,0 +1,485 @@
+/**
+ * PANDA 3D SOFTWARE
+ * Copyright (c) Carnegie Mellon University.  All rights reserved.
+ *
+ * All use of this software is subject to the terms of the revised BSD
+ * license.  You should have received a copy of this license along
+ * with this source code in a file named "LICENSE."
+ *
+ * @file meshletNode.cxx
+ * @author djs3000
+ * @date 2026-10-16
+ */
+
+#include "meshletNode.h"
+#include "geomTriangles.h"
+#include "geomVertexReader.h"
+#include "cullFaceAttrib.h"
+#include "cullableObject.h"
+#include "cullHandler.h"
+#include "cullTraverser.h"
+#include "cullTraverserData.h"
+#include "boundingVolumeBatch.h"
+#include "sceneSetup.h"
+#include "lens.h"
+#include "pStatCollector.h"
+#include "bamReader.h"
+#include "bamWriter.h"
+#include "datagram.h"
+#include "datagramIterator.h"
+#include "config_pgraph.h"
+
+#include <cfloat>
+
+TypeHandle MeshletNode::_type_handle;
+
+static PStatCollector _cone_culled_pcollector("Cull:Meshlets:Cone culled");
+
+/**
+ *
+ */
+MeshletNode::
+MeshletNode(const std::string &name) :
+  GeomNode(name)
+{
+  set_preserved(true);
+}
+
+/**
+ *
+ */
+MeshletNode::
+MeshletNode(const MeshletNode &copy) :
+  GeomNode(copy),
+  _cycler(copy._cycler)
+{
+}
+
+/**
+ * Returns a newly-allocated Node that is a shallow copy of this one.  It will
+ * be a different Node pointer, but its internal data may or may not be shared
+ * with that of the original Node.
+ */
+PandaNode *MeshletNode::
+make_copy() const {
+  return new MeshletNode(*this);
+}
+
+/**
+ * Transforms the contents of this node by the indicated matrix, if it means
+ * anything to do so.  The clusters are recomputed afterwards, since the
+ * vertices have moved.
+ */
+void MeshletNode::
+xform(const LMatrix4 &mat) {
+  GeomNode::xform(mat);
+  recompute_clusters();
+}
+
+/**
+ * Adds the node's contents to the CullResult we are building up during the
+ * cull traversal, so that it will be drawn at render time.
+ *
+ * In addition to the view frustum test performed by GeomNode, each cluster
+ * is rejected if its normal cone shows that all of its triangles face away
+ * from the camera.
+ */
+void MeshletNode::
+add_for_draw(CullTraverser *trav, CullTraverserData &data) {
+  if (data._instances != nullptr) {
+    // The cone test is only valid for a single camera position.
+    GeomNode::add_for_draw(trav, data);
+    return;
+  }
+
+  trav->_geom_nodes_pcollector.add_level(1);
+  Thread *current_thread = trav->get_current_thread();
+
+  Geoms geoms = get_geoms(current_thread);
+  int num_geoms = geoms.get_num_geoms();
+  trav->_geoms_pcollector.add_level(num_geoms);
+  CPT(TransformState) internal_transform = data.get_internal_transform(trav);
+
+  // Find the camera position in the coordinate space of this node.  The cone
+  // test assumes a perspective lens, and a transform that does not mirror the
+  // geometry, which would turn the triangles inside out.  We check the net
+  // transform for this, since the internal transform also includes the
+  // coordinate system conversion, which may be a mirroring one.
+  bool cone_culling = meshlet_cone_culling &&
+    !trav->get_scene()->get_lens()->is_orthographic() &&
+    data.get_net_transform(trav)->get_mat().get_upper_3().determinant() > 0.0f;
+  LPoint3 camera_pos;
+  if (cone_culling) {
+    camera_pos = internal_transform->get_inverse()->get_mat().get_row3(3);
+  }
+
+  CDReader cdata(_cycler, current_thread);
+  const Clusters &clusters = cdata->_clusters;
+
+  BoundingVolumeBatch batch;
+  bool use_batch = (data._view_frustum != nullptr &&
+                    num_geoms >= cull_batch_threshold);
+  if (use_batch) {
+    batch.reserve(num_geoms);
+    for (int i = 0; i < num_geoms; i++) {
+      CPT(BoundingVolume) geom_volume = geoms.get_geom(i)->get_bounds(current_thread);
+      batch.add_volume(geom_volume->as_geometric_bounding_volume());
+    }
+    batch.compute_contains(data._view_frustum);
+  }
+
+  int num_cone_culled = 0;
+  for (int i = 0; i < num_geoms; i++) {
+    CPT(Geom) geom = geoms.get_geom(i);
+    if (geom->is_empty()) {
+      continue;
+    }
+
+    if (use_batch) {
+      if (batch.get_result(i) == BoundingVolume::IF_no_intersection) {
+        continue;
+      }
+    } else if (data._view_frustum != nullptr &&
+               !geom->is_in_view(data._view_frustum, current_thread)) {
+      continue;
+    }
+
+    CPT(RenderState) state = data._state->compose(geoms.get_geom_state(i));
+
+    if (cone_culling && i < (int)clusters.size()) {
+      const Cluster &cluster = clusters[i];
+      if (cluster._cone_cutoff < 1.0f &&
+          is_facing_away(cluster, camera_pos) &&
+          cluster.is_current(geom, current_thread)) {
+        const CullFaceAttrib *cfa;
+        state->get_attrib_def(cfa);
+        if (cfa->get_effective_mode() == CullFaceAttrib::M_cull_clockwise) {
+          ++num_cone_culled;
+          continue;
+        }
+      }
+    }
+
+    if (state->has_cull_callback() && !state->cull_callback(trav, data)) {
+      continue;
+    }
+
+    if (data._cull_planes != nullptr) {
+      CPT(BoundingVolume) geom_volume = geom->get_bounds(current_thread);
+      const GeometricBoundingVolume *geom_gbv =
+        geom_volume->as_geometric_bounding_volume();
+      int result;
+      data._cull_planes->do_cull(result, state, geom_gbv);
+      if (result == BoundingVolume::IF_no_intersection) {
+        continue;
+      }
+    }
+
+    CullableObject *object =
+      new CullableObject(std::move(geom), std::move(state), internal_transform);
+    trav->get_cull_handler()->record_object(object, trav);
+  }
+
+  _cone_culled_pcollector.add_level(num_cone_culled);
+}
+
+/**
+ * Splits the triangles of the indicated Geom into clusters of at most
+ * max_triangles triangles each, and adds each cluster to the node as a
+ * separate Geom with the indicated state.  The clusters share the vertex data
+ * of the original Geom.  A Geom that does not contain triangles is added
+ * unchanged, without a normal cone.
+ */
+void MeshletNode::
+add_geom_clusters(const Geom *geom, const RenderState *state,
+                  int max_triangles) {
+  nassertv(geom != nullptr && state != nullptr && max_triangles > 0);
+  Thread *current_thread = Thread::get_current_thread();
+
+  pvector<PT(Geom)> new_geoms;
+  if (geom->get_primitive_type() != Geom::PT_polygons) {
+    new_geoms.push_back(geom->make_copy());
+
+  } else {
+    CPT(Geom) triangles = geom->decompose();
+    CPT(GeomVertexData) vdata = triangles->get_vertex_data(current_thread);
+
+    pvector<CPT(GeomPrimitive)> prims;
+    for (size_t i = 0; i < triangles->get_num_primitives(); ++i) {
+      CPT(GeomPrimitive) prim = triangles->get_primitive(i);
+      if (prim->is_of_type(GeomTriangles::get_class_type())) {
+        DCAST(GeomTriangles, prim)->make_clusters(prims, vdata, max_triangles);
+      } else {
+        prims.push_back(prim);
+      }
+    }
+
+    for (const GeomPrimitive *prim : prims) {
+      PT(Geom) new_geom = triangles->make_copy();
+      new_geom->clear_primitives();
+      new_geom->add_primitive(prim);
+      new_geoms.push_back(std::move(new_geom));
+    }
+  }
+
+  Clusters new_clusters(new_geoms.size());
+  for (size_t i = 0; i < new_geoms.size(); ++i) {
+    new_clusters[i].compute(new_geoms[i], current_thread);
+    add_geom(new_geoms[i], state);
+  }
+
+  CDWriter cdata(_cycler, true, current_thread);
+  cdata->_clusters.insert(cdata->_clusters.end(),
+                          new_clusters.begin(), new_clusters.end());
+}
+
+/**
+ * Adds clusters made from all of the Geoms of the indicated GeomNode, as if
+ * by calling add_geom_clusters() on each of them with its state.
+ */
+void MeshletNode::
+add_clusters_from(const GeomNode *other, int max_triangles) {
+  nassertv(other != nullptr);
+  Geoms geoms = other->get_geoms();
+  for (int i = 0; i < geoms.get_num_geoms(); ++i) {
+    add_geom_clusters(geoms.get_geom(i), geoms.get_geom_state(i), max_triangles);
+  }
+}
+
+/**
+ * Recomputes the bounding sphere and normal cone of each of the Geoms.  This
+ * should be called after the vertices have been modified; until then, the
+ * affected clusters are not culled by their normal cone.  It does not change
+ * the way the triangles are divided among the Geoms.
+ */
+void MeshletNode::
+recompute_clusters() {
+  Thread *current_thread = Thread::get_current_thread();
+  Geoms geoms = get_geoms(current_thread);
+
+  CDWriter cdata(_cycler, true, current_thread);
+  cdata->_clusters.clear();
+  cdata->_clusters.resize(geoms.get_num_geoms());
+  for (int i = 0; i < geoms.get_num_geoms(); ++i) {
+    cdata->_clusters[i].compute(geoms.get_geom(i), current_thread);
+  }
+}
+
+/**
+ *
+ */
+void MeshletNode::
+output(std::ostream &out) const {
+  GeomNode::output(out);
+  out << " (" << get_num_clusters() << " clusters)";
+}
+
+/**
+ * Returns true if the cone test shows that all of the triangles of the
+ * cluster face away from a camera at the indicated position.
+ */
+bool MeshletNode::
+is_facing_away(const Cluster &cluster, const LPoint3 &camera_pos) const {
+  LVector3 offset = cluster._center - camera_pos;
+  return offset.dot(cluster._cone_axis) >=
+    cluster._cone_cutoff * offset.length() + cluster._radius;
+}
+
+/**
+ * Computes the bounding sphere and normal cone of the triangles of the
+ * indicated Geom.  If the normals are spread too widely, or the Geom does not
+ * contain triangles, the cutoff is set to 1, which disables the cone test.
+ */
+void MeshletNode::Cluster::
+compute(const Geom *geom, Thread *current_thread) {
+  _geom = geom;
+  _geom_modified = geom->get_modified(current_thread);
+  CPT(GeomVertexData) vdata = geom->get_vertex_data(current_thread);
+  _data_modified = vdata->get_modified(current_thread);
+  _center = LPoint3::zero();
+  _radius = 0.0f;
+  _cone_axis = LVector3::zero();
+  _cone_cutoff = 1.0f;
+
+  if (geom->get_primitive_type() != Geom::PT_polygons) {
+    return;
+  }
+
+  CPT(Geom) triangles = geom->decompose();
+  GeomVertexReader vertex(vdata, InternalName::get_vertex(), current_thread);
+  if (!vertex.has_column()) {
+    return;
+  }
+
+  pvector<LVector3> normals;
+  LPoint3 min_point(FLT_MAX, FLT_MAX, FLT_MAX);
+  LPoint3 max_point(-FLT_MAX, -FLT_MAX, -FLT_MAX);
+  pvector<LPoint3> points;
+  LVector3 normal_sum(0.0f, 0.0f, 0.0f);
+
+  for (size_t pi = 0; pi < triangles->get_num_primitives(); ++pi) {
+    CPT(GeomPrimitive) prim = triangles->get_primitive(pi);
+    int num_vertices = prim->get_num_vertices();
+    for (int i = 0; i + 2 < num_vertices; i += 3) {
+      LPoint3 p[3];
+      for (int j = 0; j < 3; ++j) {
+        vertex.set_row(prim->get_vertex(i + j));
+        p[j] = vertex.get_data3();
+        min_point = min_point.fmin(p[j]);
+        max_point = max_point.fmax(p[j]);
+        points.push_back(p[j]);
+      }
+      LVector3 normal = (p[1] - p[0]).cross(p[2] - p[0]);
+      if (normal.normalize()) {
+        normals.push_back(normal);
+        normal_sum += normal;
+      }
+    }
+  }
+
+  if (points.empty()) {
+    return;
+  }
+
+  _center = (min_point + max_point) * 0.5f;
+  PN_stdfloat radius_squared = 0.0f;
+  for (const LPoint3 &point : points) {
+    radius_squared = std::max(radius_squared, (point - _center).length_squared());
+  }
+  _radius = csqrt(radius_squared);
+
+  if (normals.empty() || !normal_sum.normalize()) {
+    return;
+  }
+
+  PN_stdfloat min_dot = 1.0f;
+  for (const LVector3 &normal : normals) {
+    min_dot = std::min(min_dot, normal.dot(normal_sum));
+  }
+  if (min_dot <= 0.0f) {
+    // The normals span more than a hemisphere; there is no camera position
+    // from which all of the triangles are guaranteed to be facing away.
+    return;
+  }
+
+  _cone_axis = normal_sum;
+  _cone_cutoff = csqrt(std::max(1.0f - min_dot * min_dot, (PN_stdfloat)0.0f));
+}
+
+/**
+ * Returns true if the indicated Geom is still the one for which the cluster
+ * was computed, and it has not been modified since.
+ */
+bool MeshletNode::Cluster::
+is_current(const Geom *geom, Thread *current_thread) const {
+  return _geom == geom &&
+    _geom_modified == geom->get_modified(current_thread) &&
+    _data_modified == geom->get_vertex_data(current_thread)->get_modified(current_thread);
+}
+
+/**
+ * Tells the BamReader how to create objects of type MeshletNode.
+ */
+void MeshletNode::
+register_with_read_factory() {
+  BamReader::get_factory()->register_factory(get_class_type(), make_from_bam);
+}
+
+/**
+ * Writes the contents of this object to the datagram for shipping out to a
+ * Bam file.
+ */
+void MeshletNode::
+write_datagram(BamWriter *manager, Datagram &dg) {
+  GeomNode::write_datagram(manager, dg);
+  manager->write_cdata(dg, _cycler);
+}
+
+/**
+ * Called by the BamReader to perform any final actions needed for setting up
+ * the object after all objects have been read and all pointers have been
+ * completed.  This associates each cluster read from the file with its Geom.
+ */
+void MeshletNode::
+finalize(BamReader *manager) {
+  GeomNode::finalize(manager);
+
+  Thread *current_thread = Thread::get_current_thread();
+  Geoms geoms = get_geoms(current_thread);
+
+  CDWriter cdata(_cycler, true, current_thread);
+  Clusters &clusters = cdata->_clusters;
+  for (size_t i = 0; i < clusters.size() && (int)i < geoms.get_num_geoms(); ++i) {
+    Cluster &cluster = clusters[i];
+    cluster._geom = geoms.get_geom(i);
+    cluster._geom_modified = cluster._geom->get_modified(current_thread);
+    cluster._data_modified = cluster._geom->get_vertex_data(current_thread)->get_modified(current_thread);
+  }
+}
+
+/**
+ * This function is called by the BamReader's factory when a new object of
+ * type MeshletNode is encountered in the Bam file.  It should create the
+ * MeshletNode and extract its information from the file.
+ */
+TypedWritable *MeshletNode::
+make_from_bam(const FactoryParams &params) {
+  MeshletNode *node = new MeshletNode("");
+  DatagramIterator scan;
+  BamReader *manager;
+
+  parse_params(params, scan, manager);
+  node->fillin(scan, manager);
+  manager->register_finalize(node);
+
+  return node;
+}
+
+/**
+ * This internal function is called by make_from_bam to read in all of the
+ * relevant data from the BamFile for the new MeshletNode.
+ */
+void MeshletNode::
+fillin(DatagramIterator &scan, BamReader *manager) {
+  GeomNode::fillin(scan, manager);
+  manager->read_cdata(scan, _cycler);
+}
+
+/**
+ *
+ */
+CycleData *MeshletNode::CData::
+make_copy() const {
+  return new CData(*this);
+}
+
+/**
+ * Writes the contents of this object to the datagram for shipping out to a
+ * Bam file.
+ */
+void MeshletNode::CData::
+write_datagram(BamWriter *manager, Datagram &dg) const {
+  dg.add_uint32(_clusters.size());
+  for (const Cluster &cluster : _clusters) {
+    cluster._center.write_datagram(dg);
+    dg.add_stdfloat(cluster._radius);
+    cluster._cone_axis.write_datagram(dg);
+    dg.add_stdfloat(cluster._cone_cutoff);
+  }
+}
+
+/**
+ * This internal function is called by make_from_bam to read in all of the
+ * relevant data from the BamFile for the new MeshletNode.
+ */
+void MeshletNode::CData::
+fillin(DatagramIterator &scan, BamReader *manager) {
+  size_t num_clusters = scan.get_uint32();
+  _clusters.resize(num_clusters);
+  for (Cluster &cluster : _clusters) {
+    cluster._center.read_datagram(scan);
+    cluster._radius = scan.get_stdfloat();
+    cluster._cone_axis.read_datagram(scan);
+    cluster._cone_cutoff = scan.get_stdfloat();
+  }
+}
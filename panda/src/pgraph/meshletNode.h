@@ -0,0 +1,132 @@
+/**
+ * PANDA 3D SOFTWARE
+ * Copyright (c) Carnegie Mellon University.  All rights reserved.
+ *
+ * All use of this software is subject to the terms of the revised BSD
+ * license.  You should have received a copy of this license along
+ * with this source code in a file named "LICENSE."
+ *
+ * @file meshletNode.h
+ * @author djs3000
+ * @date 2026-10-16
+ */
+
+#ifndef MESHLETNODE_H
+#define MESHLETNODE_H
+
+#include "pandabase.h"
+#include "geomNode.h"
+#include "updateSeq.h"
+
+/**
+ * A special kind of GeomNode whose Geoms are small, spatially coherent
+ * clusters of triangles, each of which is culled individually.  In addition
+ * to the view frustum test that GeomNode already performs on each of its
+ * Geoms, each cluster stores a bounding sphere and a cone that bounds the
+ * normals of its triangles, so that clusters that face entirely away from the
+ * camera can be rejected before they are submitted for drawing.
+ *
+ * Use add_geom_clusters() or SceneGraphReducer::make_meshlets() to split
+ * large Geoms into clusters.  A MeshletNode is marked preserved, so that
+ * flattening the scene graph does not merge the clusters back together.
+ */
+class EXPCL_PANDA_PGRAPH MeshletNode : public GeomNode {
+PUBLISHED:
+  explicit MeshletNode(const std::string &name);
+
+protected:
+  MeshletNode(const MeshletNode &copy);
+
+public:
+  virtual PandaNode *make_copy() const;
+  virtual void xform(const LMatrix4 &mat);
+  virtual void add_for_draw(CullTraverser *trav, CullTraverserData &data);
+
+PUBLISHED:
+  void add_geom_clusters(const Geom *geom,
+                         const RenderState *state = RenderState::make_empty(),
+                         int max_triangles = 128);
+  void add_clusters_from(const GeomNode *other, int max_triangles = 128);
+  void recompute_clusters();
+
+  INLINE int get_num_clusters() const;
+  INLINE LPoint3 get_cluster_center(int n) const;
+  INLINE PN_stdfloat get_cluster_radius(int n) const;
+  INLINE bool has_cluster_cone(int n) const;
+  INLINE LVector3 get_cluster_cone_axis(int n) const;
+  INLINE PN_stdfloat get_cluster_cone_cutoff(int n) const;
+
+public:
+  virtual void output(std::ostream &out) const;
+
+private:
+  // The bounding sphere and normal cone of one of the Geoms.  The Geom and
+  // the modified stamps are recorded to detect when the Geom has been changed
+  // or replaced since the cone was computed, in which case the cone is not
+  // used.
+  class Cluster {
+  public:
+    void compute(const Geom *geom, Thread *current_thread);
+    bool is_current(const Geom *geom, Thread *current_thread) const;
+
+    CPT(Geom) _geom;
+    UpdateSeq _geom_modified;
+    UpdateSeq _data_modified;
+    LPoint3 _center;
+    PN_stdfloat _radius;
+    LVector3 _cone_axis;
+    PN_stdfloat _cone_cutoff;
+  };
+  typedef pvector<Cluster> Clusters;
+
+  bool is_facing_away(const Cluster &cluster, const LPoint3 &camera_pos) const;
+
+  // This is the data that must be cycled between pipeline stages.
+  class EXPCL_PANDA_PGRAPH CData : public CycleData {
+  public:
+    INLINE CData();
+    INLINE CData(const CData &copy);
+    virtual CycleData *make_copy() const;
+    virtual void write_datagram(BamWriter *manager, Datagram &dg) const;
+    virtual void fillin(DatagramIterator &scan, BamReader *manager);
+    virtual TypeHandle get_parent_type() const {
+      return MeshletNode::get_class_type();
+    }
+
+    Clusters _clusters;
+  };
+
+  PipelineCycler<CData> _cycler;
+  typedef CycleDataReader<CData> CDReader;
+  typedef CycleDataWriter<CData> CDWriter;
+
+public:
+  static void register_with_read_factory();
+  virtual void write_datagram(BamWriter *manager, Datagram &dg);
+  virtual void finalize(BamReader *manager);
+
+protected:
+  static TypedWritable *make_from_bam(const FactoryParams &params);
+  void fillin(DatagramIterator &scan, BamReader *manager);
+
+public:
+  static TypeHandle get_class_type() {
+    return _type_handle;
+  }
+  static void init_type() {
+    GeomNode::init_type();
+    register_type(_type_handle, "MeshletNode",
+                  GeomNode::get_class_type());
+  }
+  virtual TypeHandle get_type() const {
+    return get_class_type();
+  }
+  virtual TypeHandle force_init_type() {init_type(); return get_class_type();}
+
+private:
+  static TypeHandle _type_handle;
+};
+
+#include "meshletNode.I"
+
+#endif
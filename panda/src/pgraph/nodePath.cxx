@@ -5681,6 +5681,11 @@ flatten_strong() {
     gr.unify(node(), false);
   }
 
+  if (flatten_optimize_vertices) {
+    // This is done last, since unifying may undo some of its benefit.
+    gr.optimize_vertices(node());
+  }
+
   return num_removed;
 }
 
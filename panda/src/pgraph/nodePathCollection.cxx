@@ -555,6 +555,72 @@ set_attrib(const RenderAttrib *attrib, int priority) {
   }
 }
 
+/**
+ * Replaces the transform on each NodePath in the collection with the
+ * corresponding matrix from the array, which must have one entry for each
+ * NodePath.  The array may also be any object supporting the buffer protocol
+ * containing 4x4 matrices.
+ *
+ * This is equivalent to calling set_mat() on each NodePath, but much faster
+ * for large collections.
+ */
+void NodePathCollection::
+set_mats(CPTA_LMatrix4 mats) {
+  nassertv_always(mats.size() == _node_paths.size());
+
+  size_t num_paths = _node_paths.size();
+  pvector<CPT(TransformState)> transforms(num_paths);
+  TransformState::make_mat_array(transforms.data(), mats, num_paths);
+  set_transforms(transforms.data());
+}
+
+/**
+ * Replaces the translation, rotation, and scale components of each NodePath
+ * in the collection with the corresponding values from the arrays, which
+ * must each have one entry for each NodePath.  Shear is implicitly set to 0.
+ *
+ * This is equivalent to calling set_pos_hpr_scale() on each NodePath, but
+ * much faster for large collections.
+ */
+void NodePathCollection::
+set_pos_hpr_scale(CPTA_LVecBase3 pos, CPTA_LVecBase3 hpr,
+                  CPTA_LVecBase3 scale) {
+  nassertv_always(pos.size() == _node_paths.size() &&
+                  hpr.size() == _node_paths.size() &&
+                  scale.size() == _node_paths.size());
+
+  size_t num_paths = _node_paths.size();
+  pvector<CPT(TransformState)> transforms(num_paths);
+  TransformState::make_pos_hpr_scale_array(transforms.data(), pos, hpr,
+                                           scale, num_paths);
+  set_transforms(transforms.data());
+}
+
+/**
+ * Applies the indicated transforms, one for each NodePath in the collection,
+ * via PandaNode::set_transforms().  Empty NodePaths are skipped.
+ */
+void NodePathCollection::
+set_transforms(const CPT(TransformState) *transforms) {
+  size_t num_paths = _node_paths.size();
+  pvector<PandaNode *> nodes;
+  pvector<CPT(TransformState)> node_transforms;
+  nodes.reserve(num_paths);
+  node_transforms.reserve(num_paths);
+
+  for (size_t i = 0; i < num_paths; ++i) {
+    const NodePath &np = _node_paths[i];
+    if (np.is_empty()) {
+      continue;
+    }
+    nodes.push_back(np.node());
+    node_transforms.push_back(transforms[i]);
+  }
+
+  PandaNode::set_transforms(nodes.size(), nodes.data(),
+                            node_transforms.data(), true);
+}
+
 /**
  * Writes a brief one-line description of the NodePathCollection to the
  * indicated output stream.
@@ -17,6 +17,8 @@
 #include "pandabase.h"
 #include "nodePath.h"
 #include "pointerToArray.h"
+#include "pta_LMatrix4.h"
+#include "pta_LVecBase3.h"
 
 /**
  * This is a set of zero or more NodePaths.  It's handy for returning from
@@ -95,6 +97,10 @@ PUBLISHED:
 
   void set_attrib(const RenderAttrib *attrib, int priority = 0);
 
+  void set_mats(CPTA_LMatrix4 mats);
+  void set_pos_hpr_scale(CPTA_LVecBase3 pos, CPTA_LVecBase3 hpr,
+                         CPTA_LVecBase3 scale);
+
   void output(std::ostream &out) const;
   void write(std::ostream &out, int indent_level = 0) const;
 
@@ -104,6 +110,8 @@ private:
 
   // This typedef is used in set_attrib() and similar methods.
   typedef pmap<CPT(RenderState), CPT(RenderState) > StateMap;
+
+  void set_transforms(const CPT(TransformState) *transforms);
 };
 
 INLINE std::ostream &operator << (std::ostream &out, const NodePathCollection &col) {
@@ -0,0 +1,501 @@
+/**
+ * PANDA 3D SOFTWARE
+ * Copyright (c) Carnegie Mellon University.  All rights reserved.
+ *
+ * All use of this software is subject to the terms of the revised BSD
+ * license.  You should have received a copy of this license along
+ * with this source code in a file named "LICENSE."
+ *
+ * @file occlusionBuffer.cxx
+ * @author djs3000
+ * @date 2026-10-16
+ */
+
+#include "occlusionBuffer.h"
+#include "sceneSetup.h"
+#include "lens.h"
+#include "occluderNode.h"
+#include "geomNode.h"
+#include "geom.h"
+#include "geomPrimitive.h"
+#include "geomVertexReader.h"
+#include "nodePathCollection.h"
+#include "finiteBoundingVolume.h"
+#include "pStatTimer.h"
+#include "dcast.h"
+
+// We only vectorize the rasterizer where the vector instructions are
+// guaranteed to be available: SSE2 on x86-64, and NEON on 64-bit ARM.
+#if defined(__SSE2__) || (_M_IX86_FP >= 2) || defined(_M_X64) || defined(_M_AMD64)
+#include <xmmintrin.h>
+#include <emmintrin.h>
+#define OCCLUSION_USE_SSE2
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define OCCLUSION_USE_NEON
+#endif
+
+#include <float.h>
+
+using std::max;
+using std::min;
+
+// The depth stored in texels that aren't covered by any occluder.
+static const float far_depth = FLT_MAX;
+
+// Vertices closer than this to the plane of the camera are not projected.
+static const float min_w = 1.0e-5f;
+
+PStatCollector OcclusionBuffer::_render_pcollector("Cull:Occlusion buffer");
+
+TypeHandle OcclusionBuffer::_type_handle;
+
+/**
+ * Creates a buffer with the indicated resolution.  The x_size is rounded up
+ * to a multiple of 4.  The resolution need not be related to that of the
+ * window; something fairly low is recommended, since the time spent in
+ * render() is proportional to the number of pixels covered by occluders.
+ */
+OcclusionBuffer::
+OcclusionBuffer(int x_size, int y_size) :
+  _x_size((max(x_size, 1) + 3) & ~3),
+  _y_size(max(y_size, 1)),
+  _view_proj_mat(LMatrix4::ident_mat()),
+  _num_triangles(0)
+{
+  int level_x = _x_size;
+  int level_y = _y_size;
+  while (true) {
+    Level level;
+    level._x_size = level_x;
+    level._y_size = level_y;
+    level._depth.resize((size_t)level_x * (size_t)level_y, far_depth);
+    _levels.push_back(std::move(level));
+
+    if (level_x == 1 && level_y == 1) {
+      break;
+    }
+    level_x = (level_x + 1) / 2;
+    level_y = (level_y + 1) / 2;
+  }
+}
+
+/**
+ * Adds the indicated node as an occluder.  All of the GeomNodes and
+ * OccluderNodes at this node and below will be drawn into the buffer.
+ */
+void OcclusionBuffer::
+add_occluder(const NodePath &occluder) {
+  nassertv(!occluder.is_empty());
+  if (std::find(_occluders.begin(), _occluders.end(), occluder) == _occluders.end()) {
+    _occluders.push_back(occluder);
+  }
+}
+
+/**
+ * Removes the indicated occluder, which was previously added with
+ * add_occluder().  Returns true if it was removed, false if it wasn't in the
+ * list.
+ */
+bool OcclusionBuffer::
+remove_occluder(const NodePath &occluder) {
+  Occluders::iterator oi = std::find(_occluders.begin(), _occluders.end(), occluder);
+  if (oi == _occluders.end()) {
+    return false;
+  }
+  _occluders.erase(oi);
+  return true;
+}
+
+/**
+ * Draws all of the occluders into the buffer, as seen by the camera of the
+ * indicated scene.  This is normally called by the CullTraverser at the start
+ * of each traversal.
+ */
+void OcclusionBuffer::
+render(const SceneSetup *scene, Thread *current_thread) {
+  PStatTimer timer(_render_pcollector, current_thread);
+
+  const Lens *lens = scene->get_lens();
+  nassertv(lens != nullptr);
+  clear(scene->get_world_transform()->get_mat() * lens->get_projection_mat());
+
+  const NodePath &scene_root = scene->get_scene_root();
+  for (const NodePath &occluder : _occluders) {
+    if (!occluder.is_empty()) {
+      draw_occluder(occluder, scene_root, current_thread);
+    }
+  }
+
+  build_hierarchy();
+}
+
+/**
+ * Returns true if the indicated bounding volume, which is in the coordinate
+ * space defined by the given matrix (relative to the scene root), is
+ * entirely hidden behind the occluders drawn by the last call to render().
+ */
+bool OcclusionBuffer::
+is_occluded(const BoundingVolume *volume, const LMatrix4 &net_mat) const {
+  if (_num_triangles == 0 || volume->is_empty() || volume->is_infinite()) {
+    return false;
+  }
+
+  const FiniteBoundingVolume *fbv = volume->as_finite_bounding_volume();
+  if (fbv == nullptr) {
+    return false;
+  }
+
+  return is_box_occluded(fbv->get_min(), fbv->get_max(), net_mat * _view_proj_mat);
+}
+
+/**
+ * Returns the depth stored in the indicated pixel of the buffer, in
+ * normalized device coordinates, or a very large number if no occluder
+ * covers that pixel.  This is mainly useful for debugging.
+ */
+PN_stdfloat OcclusionBuffer::
+get_depth(int x, int y) const {
+  nassertr(x >= 0 && x < _x_size && y >= 0 && y < _y_size, far_depth);
+  return _levels[0]._depth[(size_t)y * _x_size + x];
+}
+
+/**
+ * Empties the buffer in preparation for drawing the occluders.  The matrix
+ * transforms from the space of the scene root to clip space.
+ */
+void OcclusionBuffer::
+clear(const LMatrix4 &view_proj_mat) {
+  _view_proj_mat = view_proj_mat;
+  _num_triangles = 0;
+
+  Level &level = _levels[0];
+  std::fill(level._depth.begin(), level._depth.end(), far_depth);
+}
+
+/**
+ * Draws the indicated triangle into the buffer.  The matrix transforms the
+ * vertices to clip space.
+ */
+void OcclusionBuffer::
+draw_triangle(const LPoint3 &p0, const LPoint3 &p1, const LPoint3 &p2,
+              const LMatrix4 &mat) {
+  draw_triangle_clip(LCAST(float, mat.xform(LVecBase4(p0, 1))),
+                     LCAST(float, mat.xform(LVecBase4(p1, 1))),
+                     LCAST(float, mat.xform(LVecBase4(p2, 1))));
+}
+
+/**
+ * Draws the indicated triangle, whose vertices are given in clip space, into
+ * the buffer.
+ *
+ * The pixels whose centers are covered by the triangle are written, with a
+ * depth no nearer than the triangle is anywhere within that pixel.  Testing
+ * only the centers means that the triangles of a mesh leave no gaps along
+ * their shared edges; since occluders are meant to lie within the objects
+ * they represent, the half pixel this may add at the silhouette is harmless.
+ * Triangles that cross the plane of the camera are skipped altogether.
+ */
+void OcclusionBuffer::
+draw_triangle_clip(const LVecBase4f &c0, const LVecBase4f &c1,
+                   const LVecBase4f &c2) {
+  if (c0[3] < min_w || c1[3] < min_w || c2[3] < min_w) {
+    return;
+  }
+
+  float half_x = (float)_x_size * 0.5f;
+  float half_y = (float)_y_size * 0.5f;
+
+  // Project to pixel coordinates.
+  float x[3], y[3], d[3];
+  const LVecBase4f *clip[3] = { &c0, &c1, &c2 };
+  for (int i = 0; i < 3; ++i) {
+    float iw = 1.0f / (*clip[i])[3];
+    x[i] = ((*clip[i])[0] * iw + 1.0f) * half_x;
+    y[i] = ((*clip[i])[1] * iw + 1.0f) * half_y;
+    d[i] = (*clip[i])[2] * iw;
+  }
+
+  float area = (x[1] - x[0]) * (y[2] - y[0]) - (x[2] - x[0]) * (y[1] - y[0]);
+  if (!(area > 0.0f || area < 0.0f)) {
+    // Degenerate, or not a number.
+    return;
+  }
+  if (area < 0.0f) {
+    // Occluders are double-sided.  Make it counter-clockwise.
+    std::swap(x[1], x[2]);
+    std::swap(y[1], y[2]);
+    std::swap(d[1], d[2]);
+    area = -area;
+  }
+
+  // Find the range of pixels to visit.
+  float min_x = max(min(min(x[0], x[1]), x[2]), -1.0f);
+  float max_x = min(max(max(x[0], x[1]), x[2]), (float)_x_size);
+  float min_y = max(min(min(y[0], y[1]), y[2]), -1.0f);
+  float max_y = min(max(max(y[0], y[1]), y[2]), (float)_y_size);
+  int px0 = max((int)floor(min_x), 0);
+  int px1 = min((int)ceil(max_x), _x_size - 1);
+  int py0 = max((int)floor(min_y), 0);
+  int py1 = min((int)ceil(max_y), _y_size - 1);
+  if (px0 > px1 || py0 > py1) {
+    return;
+  }
+
+  // Set up the edge functions, which are positive inside the triangle.  They
+  // are evaluated at the pixel center.
+  float ea[3], eb[3], ec[3];
+  for (int i = 0; i < 3; ++i) {
+    int j = (i + 1) % 3;
+    ea[i] = y[i] - y[j];
+    eb[i] = x[j] - x[i];
+    ec[i] = -(ea[i] * x[i] + eb[i] * y[i]);
+  }
+
+  // Set up the plane equation for the depth.  Similarly, it is offset to be
+  // the farthest depth within the pixel, but never farther than the triangle.
+  float da = ((d[1] - d[0]) * (y[2] - y[0]) - (d[2] - d[0]) * (y[1] - y[0])) / area;
+  float db = ((d[2] - d[0]) * (x[1] - x[0]) - (d[1] - d[0]) * (x[2] - x[0])) / area;
+  float dc = d[0] - da * x[0] - db * y[0] + 0.5f * (cabs(da) + cabs(db));
+  float max_d = max(max(d[0], d[1]), d[2]);
+
+  ++_num_triangles;
+
+  Level &level = _levels[0];
+
+  // The rows are a multiple of 4 wide, so we can always process 4 pixels at
+  // a time, starting from an aligned position.
+  px0 &= ~3;
+
+  for (int py = py0; py <= py1; ++py) {
+    float fy = (float)py + 0.5f;
+    float *row = &level._depth[(size_t)py * _x_size];
+
+#if defined(OCCLUSION_USE_SSE2)
+    __m128 zero = _mm_setzero_ps();
+    __m128 e0_row = _mm_set1_ps(eb[0] * fy + ec[0]);
+    __m128 e1_row = _mm_set1_ps(eb[1] * fy + ec[1]);
+    __m128 e2_row = _mm_set1_ps(eb[2] * fy + ec[2]);
+    __m128 d_row = _mm_set1_ps(db * fy + dc);
+    __m128 max_d4 = _mm_set1_ps(max_d);
+
+    for (int px = px0; px <= px1; px += 4) {
+      __m128 fx = _mm_add_ps(_mm_set1_ps((float)px + 0.5f),
+                             _mm_set_ps(3.0f, 2.0f, 1.0f, 0.0f));
+      __m128 e0 = _mm_add_ps(_mm_mul_ps(fx, _mm_set1_ps(ea[0])), e0_row);
+      __m128 e1 = _mm_add_ps(_mm_mul_ps(fx, _mm_set1_ps(ea[1])), e1_row);
+      __m128 e2 = _mm_add_ps(_mm_mul_ps(fx, _mm_set1_ps(ea[2])), e2_row);
+      __m128 inside = _mm_and_ps(_mm_and_ps(_mm_cmpge_ps(e0, zero),
+                                            _mm_cmpge_ps(e1, zero)),
+                                 _mm_cmpge_ps(e2, zero));
+      if (_mm_movemask_ps(inside) == 0) {
+        continue;
+      }
+
+      __m128 depth = _mm_add_ps(_mm_mul_ps(fx, _mm_set1_ps(da)), d_row);
+      depth = _mm_min_ps(depth, max_d4);
+
+      __m128 old_depth = _mm_loadu_ps(row + px);
+      __m128 new_depth = _mm_min_ps(old_depth, depth);
+      _mm_storeu_ps(row + px, _mm_or_ps(_mm_and_ps(inside, new_depth),
+                                        _mm_andnot_ps(inside, old_depth)));
+    }
+
+#elif defined(OCCLUSION_USE_NEON)
+    static const float lane_offsets[4] = { 0.0f, 1.0f, 2.0f, 3.0f };
+    float32x4_t zero = vdupq_n_f32(0.0f);
+    float32x4_t offsets = vld1q_f32(lane_offsets);
+    float32x4_t e0_row = vdupq_n_f32(eb[0] * fy + ec[0]);
+    float32x4_t e1_row = vdupq_n_f32(eb[1] * fy + ec[1]);
+    float32x4_t e2_row = vdupq_n_f32(eb[2] * fy + ec[2]);
+    float32x4_t d_row = vdupq_n_f32(db * fy + dc);
+    float32x4_t max_d4 = vdupq_n_f32(max_d);
+
+    for (int px = px0; px <= px1; px += 4) {
+      float32x4_t fx = vaddq_f32(vdupq_n_f32((float)px + 0.5f), offsets);
+      float32x4_t e0 = vmlaq_n_f32(e0_row, fx, ea[0]);
+      float32x4_t e1 = vmlaq_n_f32(e1_row, fx, ea[1]);
+      float32x4_t e2 = vmlaq_n_f32(e2_row, fx, ea[2]);
+      uint32x4_t inside = vandq_u32(vandq_u32(vcgeq_f32(e0, zero),
+                                              vcgeq_f32(e1, zero)),
+                                    vcgeq_f32(e2, zero));
+
+      float32x4_t depth = vminq_f32(vmlaq_n_f32(d_row, fx, da), max_d4);
+      float32x4_t old_depth = vld1q_f32(row + px);
+      vst1q_f32(row + px, vbslq_f32(inside, vminq_f32(old_depth, depth), old_depth));
+    }
+
+#else
+    for (int px = px0; px <= px1; ++px) {
+      float fx = (float)px + 0.5f;
+      if (ea[0] * fx + eb[0] * fy + ec[0] >= 0.0f &&
+          ea[1] * fx + eb[1] * fy + ec[1] >= 0.0f &&
+          ea[2] * fx + eb[2] * fy + ec[2] >= 0.0f) {
+        float depth = min(da * fx + db * fy + dc, max_d);
+        row[px] = min(row[px], depth);
+      }
+    }
+#endif
+  }
+}
+
+/**
+ * Recomputes the coarser levels of the buffer from the first level.  This
+ * must be called after drawing the occluders, before is_box_occluded().
+ */
+void OcclusionBuffer::
+build_hierarchy() {
+  for (size_t li = 1; li < _levels.size(); ++li) {
+    const Level &below = _levels[li - 1];
+    Level &level = _levels[li];
+
+    for (int ty = 0; ty < level._y_size; ++ty) {
+      int y0 = ty * 2;
+      int y1 = min(y0 + 1, below._y_size - 1);
+      const float *row0 = &below._depth[(size_t)y0 * below._x_size];
+      const float *row1 = &below._depth[(size_t)y1 * below._x_size];
+      float *row = &level._depth[(size_t)ty * level._x_size];
+
+      for (int tx = 0; tx < level._x_size; ++tx) {
+        int x0 = tx * 2;
+        int x1 = min(x0 + 1, below._x_size - 1);
+        row[tx] = max(max(row0[x0], row0[x1]), max(row1[x0], row1[x1]));
+      }
+    }
+  }
+}
+
+/**
+ * Returns true if the indicated axis-aligned box, transformed by the given
+ * matrix into clip space, is entirely hidden behind the occluders.
+ */
+bool OcclusionBuffer::
+is_box_occluded(const LPoint3 &min_point, const LPoint3 &max_point,
+                const LMatrix4 &mat) const {
+  float half_x = (float)_x_size * 0.5f;
+  float half_y = (float)_y_size * 0.5f;
+
+  // Since the box is convex, its extent on the screen and its nearest depth
+  // are all found at one of its corners.
+  float min_x = FLT_MAX, max_x = -FLT_MAX;
+  float min_y = FLT_MAX, max_y = -FLT_MAX;
+  float min_d = FLT_MAX;
+  for (int i = 0; i < 8; ++i) {
+    LVecBase4 corner((i & 1) ? max_point[0] : min_point[0],
+                     (i & 2) ? max_point[1] : min_point[1],
+                     (i & 4) ? max_point[2] : min_point[2], 1);
+    LVecBase4 clip = mat.xform(corner);
+    if (clip[3] < min_w) {
+      // The box reaches behind the camera; we must assume it's visible.
+      return false;
+    }
+
+    float iw = 1.0f / (float)clip[3];
+    float x = ((float)clip[0] * iw + 1.0f) * half_x;
+    float y = ((float)clip[1] * iw + 1.0f) * half_y;
+    min_x = min(min_x, x);
+    max_x = max(max_x, x);
+    min_y = min(min_y, y);
+    max_y = max(max_y, y);
+    min_d = min(min_d, (float)clip[2] * iw);
+  }
+
+  if (max_x < 0.0f || min_x >= (float)_x_size ||
+      max_y < 0.0f || min_y >= (float)_y_size) {
+    // It's off the screen.  We leave that for the view frustum to decide.
+    return false;
+  }
+
+  int px0 = max((int)floor(min_x), 0);
+  int px1 = min((int)floor(max_x), _x_size - 1);
+  int py0 = max((int)floor(min_y), 0);
+  int py1 = min((int)floor(max_y), _y_size - 1);
+
+  // Choose the finest level at which the box covers no more than 4x4
+  // texels.
+  size_t li = 0;
+  while (li + 1 < _levels.size() &&
+         ((px1 >> li) - (px0 >> li) > 3 || (py1 >> li) - (py0 >> li) > 3)) {
+    ++li;
+  }
+  const Level &level = _levels[li];
+
+  for (int ty = (py0 >> li); ty <= (py1 >> li); ++ty) {
+    const float *row = &level._depth[(size_t)ty * level._x_size];
+    for (int tx = (px0 >> li); tx <= (px1 >> li); ++tx) {
+      if (row[tx] >= min_d) {
+        // Some part of the box may be in front of the occluders here.
+        return false;
+      }
+    }
+  }
+
+  return true;
+}
+
+/**
+ * Draws all of the geometry of the indicated occluder into the buffer.
+ */
+void OcclusionBuffer::
+draw_occluder(const NodePath &occluder, const NodePath &scene_root,
+              Thread *current_thread) {
+  // find_all_matches() only searches below the node, so check the node itself
+  // separately.
+  NodePathCollection occluder_nodes = occluder.find_all_matches("**/+OccluderNode");
+  if (occluder.node()->is_of_type(OccluderNode::get_class_type())) {
+    occluder_nodes.add_path(occluder);
+  }
+  for (int i = 0; i < occluder_nodes.get_num_paths(); ++i) {
+    NodePath path = occluder_nodes.get_path(i);
+    OccluderNode *node = DCAST(OccluderNode, path.node());
+    if (node->get_num_vertices() != 4) {
+      continue;
+    }
+
+    CPT(TransformState) transform = path.get_transform(scene_root, current_thread);
+    LMatrix4 mat = transform->get_mat() * _view_proj_mat;
+    draw_triangle(node->get_vertex(0), node->get_vertex(1), node->get_vertex(2), mat);
+    draw_triangle(node->get_vertex(0), node->get_vertex(2), node->get_vertex(3), mat);
+  }
+
+  NodePathCollection geom_nodes = occluder.find_all_matches("**/+GeomNode");
+  if (occluder.node()->is_geom_node()) {
+    geom_nodes.add_path(occluder);
+  }
+  for (int i = 0; i < geom_nodes.get_num_paths(); ++i) {
+    NodePath path = geom_nodes.get_path(i);
+    GeomNode *node = DCAST(GeomNode, path.node());
+
+    CPT(TransformState) transform = path.get_transform(scene_root, current_thread);
+    LMatrix4 mat = transform->get_mat() * _view_proj_mat;
+
+    GeomNode::Geoms geoms = node->get_geoms(current_thread);
+    int num_geoms = geoms.get_num_geoms();
+    for (int gi = 0; gi < num_geoms; ++gi) {
+      CPT(Geom) geom = geoms.get_geom(gi);
+      if (geom->get_primitive_type() != Geom::PT_polygons) {
+        continue;
+      }
+
+      GeomVertexReader vertex(geom->get_vertex_data(current_thread),
+                              InternalName::get_vertex(), current_thread);
+      if (!vertex.has_column()) {
+        continue;
+      }
+
+      int num_primitives = geom->get_num_primitives();
+      for (int pi = 0; pi < num_primitives; ++pi) {
+        CPT(GeomPrimitive) prim = geom->get_primitive(pi)->decompose();
+        int num_vertices = prim->get_num_vertices();
+        for (int vi = 0; vi + 2 < num_vertices; vi += 3) {
+          LPoint3 p[3];
+          for (int k = 0; k < 3; ++k) {
+            vertex.set_row_unsafe(prim->get_vertex(vi + k));
+            p[k] = vertex.get_data3();
+          }
+          draw_triangle(p[0], p[1], p[2], mat);
+        }
+      }
+    }
+  }
+}
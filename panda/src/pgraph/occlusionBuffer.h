@@ -0,0 +1,135 @@
+/**
+ * PANDA 3D SOFTWARE
+ * Copyright (c) Carnegie Mellon University.  All rights reserved.
+ *
+ * All use of this software is subject to the terms of the revised BSD
+ * license.  You should have received a copy of this license along
+ * with this source code in a file named "LICENSE."
+ *
+ * @file occlusionBuffer.h
+ * @author djs3000
+ * @date 2026-10-16
+ */
+
+#ifndef OCCLUSIONBUFFER_H
+#define OCCLUSIONBUFFER_H
+
+#include "pandabase.h"
+
+#include "typedReferenceCount.h"
+#include "nodePath.h"
+#include "luse.h"
+#include "pvector.h"
+#include "pStatCollector.h"
+
+class SceneSetup;
+class BoundingVolume;
+
+/**
+ * This is a low-resolution depth buffer, maintained on the CPU, into which a
+ * set of designated occluders is rasterized at the start of each cull
+ * traversal.  The CullTraverser then tests the bounding volume of each node
+ * against it before descending into it, and skips the nodes that are
+ * entirely hidden behind the occluders.
+ *
+ * Since this doesn't involve the graphics pipe at all, it works equally well
+ * with tinydisplay or in an offscreen or headless setting.  Occluders should
+ * be simple, closed, low-polygon models (or OccluderNodes) that lie entirely
+ * within the objects they represent; they are not rendered by this class.
+ *
+ * The buffer is organized as a hierarchy of progressively smaller levels, in
+ * which each texel stores the farthest depth of the four below it, so that
+ * large objects can be tested against a handful of texels.
+ *
+ * Assign one to a DisplayRegion's CullTraverser with
+ * CullTraverser::set_occlusion_buffer().
+ */
+class EXPCL_PANDA_PGRAPH OcclusionBuffer : public TypedReferenceCount {
+PUBLISHED:
+  explicit OcclusionBuffer(int x_size = 256, int y_size = 128);
+
+  INLINE int get_x_size() const;
+  INLINE int get_y_size() const;
+
+  void add_occluder(const NodePath &occluder);
+  bool remove_occluder(const NodePath &occluder);
+  INLINE void clear_occluders();
+  INLINE size_t get_num_occluders() const;
+  INLINE NodePath get_occluder(size_t n) const;
+  MAKE_SEQ(get_occluders, get_num_occluders, get_occluder);
+
+  MAKE_PROPERTY(x_size, get_x_size);
+  MAKE_PROPERTY(y_size, get_y_size);
+  MAKE_SEQ_PROPERTY(occluders, get_num_occluders, get_occluder);
+
+  void render(const SceneSetup *scene, Thread *current_thread = Thread::get_current_thread());
+  bool is_occluded(const BoundingVolume *volume, const LMatrix4 &net_mat) const;
+
+  void clear(const LMatrix4 &view_proj_mat);
+  void draw_triangle(const LPoint3 &p0, const LPoint3 &p1, const LPoint3 &p2,
+                     const LMatrix4 &mat);
+  void build_hierarchy();
+  bool is_box_occluded(const LPoint3 &min, const LPoint3 &max,
+                       const LMatrix4 &mat) const;
+
+  INLINE int get_num_triangles() const;
+  PN_stdfloat get_depth(int x, int y) const;
+
+public:
+  void draw_triangle_clip(const LVecBase4f &c0, const LVecBase4f &c1,
+                          const LVecBase4f &c2);
+
+private:
+  void draw_occluder(const NodePath &occluder, const NodePath &scene_root,
+                     Thread *current_thread);
+
+private:
+  int _x_size;
+  int _y_size;
+
+  typedef pvector<NodePath> Occluders;
+  Occluders _occluders;
+
+  // This is the transform from world space to clip space of the camera for
+  // which the buffer was last rendered.
+  LMatrix4 _view_proj_mat;
+
+  // Each level stores one depth value (normalized device coordinates, so
+  // smaller is closer) per texel.  Level 0 is full resolution, and holds the
+  // nearest occluder depth at each pixel; each subsequent level is half the
+  // size of the previous one, and holds the farthest depth of the
+  // corresponding texels of the level below it.
+  class Level {
+  public:
+    int _x_size;
+    int _y_size;
+    pvector<float> _depth;
+  };
+  typedef pvector<Level> Levels;
+  Levels _levels;
+
+  int _num_triangles;
+
+  static PStatCollector _render_pcollector;
+
+public:
+  static TypeHandle get_class_type() {
+    return _type_handle;
+  }
+  static void init_type() {
+    TypedReferenceCount::init_type();
+    register_type(_type_handle, "OcclusionBuffer",
+                  TypedReferenceCount::get_class_type());
+  }
+  virtual TypeHandle get_type() const {
+    return get_class_type();
+  }
+  virtual TypeHandle force_init_type() {init_type(); return get_class_type();}
+
+private:
+  static TypeHandle _type_handle;
+};
+
+#include "occlusionBuffer.I"
+
+#endif
@@ -2,11 +2,13 @@
 #include "cullBinAttrib.cxx"
 #include "cullBinManager.cxx"
 #include "cullFaceAttrib.cxx"
+#include "cullGeomMerger.cxx"
 #include "cullHandler.cxx"
 #include "cullPlanes.cxx"
 #include "cullResult.cxx"
 #include "cullTraverser.cxx"
 #include "cullTraverserData.cxx"
+#include "cullTraverserTask.cxx"
 #include "cullableObject.cxx"
 #include "decalEffect.cxx"
 #include "depthBiasAttrib.cxx"
@@ -10,6 +10,7 @@
 #include "logicOpAttrib.cxx"
 #include "materialAttrib.cxx"
 #include "materialCollection.cxx"
+#include "meshletNode.cxx"
 #include "modelFlattenRequest.cxx"
 #include "modelLoadRequest.cxx"
 #include "modelSaveRequest.cxx"
@@ -20,6 +21,7 @@
 #include "nodePathComponent.cxx"
 #include "occluderEffect.cxx"
 #include "occluderNode.cxx"
+#include "occlusionBuffer.cxx"
 #include "pandaNode.cxx"
 #include "paramNodePath.cxx"
 #include "planeNode.cxx"
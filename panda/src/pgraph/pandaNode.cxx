@@ -968,6 +968,9 @@ set_effect(const RenderEffect *effect) {
     }
   }
   CLOSE_ITERATE_CURRENT_AND_UPSTREAM(_cycler);
+  // This invalidates anything that caches the subgraph by its bounds
+  // sequence, such as a StaticCullNode above us.
+  mark_bounds_stale(current_thread);
   mark_bam_modified();
 }
 
@@ -990,6 +993,7 @@ clear_effect(TypeHandle type) {
     }
   }
   CLOSE_ITERATE_CURRENT_AND_UPSTREAM(_cycler);
+  mark_bounds_stale(current_thread);
   mark_bam_modified();
 }
 
@@ -1041,6 +1045,7 @@ set_effects(const RenderEffects *effects, Thread *current_thread) {
     cdata->set_fancy_bit(FB_show_tight_bounds, effects->has_show_tight_bounds());
   }
   CLOSE_ITERATE_CURRENT_AND_UPSTREAM(_cycler);
+  mark_bounds_stale(current_thread);
   mark_bam_modified();
 }
 
@@ -1080,6 +1085,88 @@ set_transform(const TransformState *transform, Thread *current_thread) {
   }
 }
 
+/**
+ * Sets the transforms of many nodes at once.  This is equivalent to calling
+ * set_transform() on each of the nodes in turn, but it is cheaper when many
+ * of the nodes share a common parent, since each parent's bounding volume is
+ * marked stale only once, rather than once for every child that changed.
+ *
+ * If reset_prev_transform is true, this also does the work of
+ * reset_prev_transform() on each node, as NodePath::set_mat() does.
+ */
+void PandaNode::
+set_transforms(size_t num_nodes, PandaNode *const *nodes,
+               const CPT(TransformState) *transforms,
+               bool reset_prev_transform, Thread *current_thread) {
+  // The list of parents whose bounds still need to be marked stale, paired
+  // with the pipeline stage in which to mark them.
+  typedef pvector<std::pair<int, PT(PandaNode)> > StaleParents;
+  StaleParents stale_parents;
+
+  // Records which of the nodes were actually changed.
+  pvector<PandaNode *> changed;
+  changed.reserve(num_nodes);
+
+  for (size_t i = 0; i < num_nodes; ++i) {
+    PandaNode *node = nodes[i];
+    const TransformState *transform = transforms[i];
+    nassertd(node != nullptr && !transform->is_invalid()) continue;
+
+    bool any_changed = false;
+    OPEN_ITERATE_CURRENT_AND_UPSTREAM(node->_cycler, current_thread) {
+      CDStageWriter cdata(node->_cycler, pipeline_stage, current_thread);
+      if (cdata->_transform != transform) {
+        if (pipeline_stage == 0) {
+          // Back up the previous transform.
+          if (node->_prev_transform_valid != _reset_prev_transform_seq) {
+            cdata->_prev_transform = std::move(cdata->_transform);
+            node->_prev_transform_valid = _reset_prev_transform_seq;
+          }
+        }
+
+        cdata->_transform = transform;
+        cdata->set_fancy_bit(FB_transform, !transform->is_identity());
+        any_changed = true;
+
+        // This is what mark_bounds_stale() does, but while we are already
+        // holding the lock.  If the bounds were already stale, the parents
+        // will have been marked stale too, so there's nothing more to do.
+        if (cdata->_last_update == cdata->_next_update) {
+          ++cdata->_next_update;
+
+          Parents parents(cdata);
+          size_t num_parents = parents.get_num_parents();
+          for (size_t pi = 0; pi < num_parents; ++pi) {
+            stale_parents.push_back(StaleParents::value_type(pipeline_stage, parents.get_parent(pi)));
+          }
+        }
+      }
+
+      if (reset_prev_transform) {
+        cdata->_prev_transform = cdata->_transform;
+      }
+    }
+    CLOSE_ITERATE_CURRENT_AND_UPSTREAM(node->_cycler);
+
+    if (any_changed) {
+      changed.push_back(node);
+    }
+  }
+
+  // Now mark each parent stale, once.  We must not hold any node locks while
+  // walking up the graph.
+  std::sort(stale_parents.begin(), stale_parents.end());
+  StaleParents::iterator end = std::unique(stale_parents.begin(), stale_parents.end());
+  for (StaleParents::iterator pi = stale_parents.begin(); pi != end; ++pi) {
+    (*pi).second->mark_bounds_stale((*pi).first, current_thread);
+  }
+
+  for (PandaNode *node : changed) {
+    node->transform_changed();
+    node->mark_bam_modified();
+  }
+}
+
 /**
  * Sets the transform that represents this node's "previous" position, one
  * frame ago, for the purposes of detecting motion for accurate collision
@@ -1154,6 +1241,8 @@ set_tag(const string &key, const string &value, Thread *current_thread) {
     cdata->set_fancy_bit(FB_tag, true);
   }
   CLOSE_ITERATE_CURRENT_AND_UPSTREAM(_cycler);
+  // A tag may change the state applied by a camera's tag state key.
+  mark_bounds_stale(current_thread);
   mark_bam_modified();
 }
 
@@ -1169,6 +1258,7 @@ clear_tag(const string &key, Thread *current_thread) {
     cdata->set_fancy_bit(FB_tag, !cdata->_tag_data.is_empty());
   }
   CLOSE_ITERATE_CURRENT_AND_UPSTREAM(_cycler);
+  mark_bounds_stale(current_thread);
   mark_bam_modified();
 }
 
@@ -1197,6 +1287,7 @@ copy_tags(PandaNode *other) {
     cdataw->set_fancy_bit(FB_tag, !cdataw->_tag_data.is_empty());
   }
   CLOSE_ITERATE_CURRENT_AND_UPSTREAM(_cycler);
+  mark_bounds_stale(current_thread);
 
   // It's okay to copy the tags by pointer, because get_python_tags does a
   // copy-on-write.
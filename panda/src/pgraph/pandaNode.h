@@ -196,6 +196,11 @@ PUBLISHED:
                  Thread *current_thread = Thread::get_current_thread());
 
 public:
+  static void set_transforms(size_t num_nodes, PandaNode *const *nodes,
+                             const CPT(TransformState) *transforms,
+                             bool reset_prev_transform = false,
+                             Thread *current_thread = Thread::get_current_thread());
+
   void get_tag_keys(vector_string &keys) const;
   INLINE size_t get_num_tags() const;
   INLINE std::string get_tag_key(size_t i) const;
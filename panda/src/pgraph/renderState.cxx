@@ -39,10 +39,12 @@
 using std::ostream;
 
 LightReMutex *RenderState::_states_lock = nullptr;
+LightReMutex *RenderState::_cache_locks = nullptr;
 RenderState::States RenderState::_states;
 const RenderState *RenderState::_empty_state = nullptr;
 UpdateSeq RenderState::_last_cycle_detect;
 size_t RenderState::_garbage_index = 0;
+size_t RenderState::_garbage_young_index = 0;
 
 PStatCollector RenderState::_cache_update_pcollector("*:State Cache:Update");
 PStatCollector RenderState::_garbage_collect_pcollector("*:State Cache:Garbage Collect");
@@ -50,6 +52,7 @@ PStatCollector RenderState::_state_compose_pcollector("*:State Cache:Compose Sta
 PStatCollector RenderState::_state_invert_pcollector("*:State Cache:Invert State");
 PStatCollector RenderState::_node_counter("RenderStates:On nodes");
 PStatCollector RenderState::_cache_counter("RenderStates:Cached");
+PStatCollector RenderState::_reclaimed_counter("RenderStates:Reclaimed");
 PStatCollector RenderState::_state_break_cycles_pcollector("*:State Cache:Break Cycles");
 PStatCollector RenderState::_state_validate_pcollector("*:State Cache:Validate");
 
@@ -356,9 +359,32 @@ compose(const RenderState *other) const {
     return do_compose(other);
   }
 
+  {
+    // Is this composition already cached?  Looking it up only requires the
+    // lock for this particular state.
+    LightReMutexHolder holder(get_cache_lock(this));
+    int index = _composition_cache.find(other);
+    if (index != -1) {
+      const Composition &comp = _composition_cache.get_data(index);
+      if (comp._result != nullptr) {
+        // Here's the cache!
+        _cache_stats.inc_hits();
+        return comp._result;
+      }
+    }
+  }
+
+  // Not in the cache.  Compute a new result.  It's important that we don't
+  // hold the lock while we do this, or we lose the benefit of
+  // parallelization.
+  CPT(RenderState) result = do_compose(other);
+
+  // Modifying the cache requires the global lock as well as the locks for
+  // both of the states involved.
   LightReMutexHolder holder(*_states_lock);
+  LightReMutexHolder holder1(get_cache_lock(this));
+  LightReMutexHolder holder2(get_cache_lock(other));
 
-  // Is this composition already cached?
   int index = _composition_cache.find(other);
   if (index != -1) {
     Composition &comp = ((RenderState *)this)->_composition_cache.modify_data(index);
@@ -366,7 +392,6 @@ compose(const RenderState *other) const {
       // Well, it wasn't cached already, but we already had an entry (probably
       // created for the reverse direction), so use the same entry to store
       // the new result.
-      CPT(RenderState) result = do_compose(other);
       comp._result = result;
 
       if (result != (const RenderState *)this) {
@@ -387,8 +412,6 @@ compose(const RenderState *other) const {
 
   // The cache entry in this object is the only one that indicates the result;
   // the other will be NULL for now.
-  CPT(RenderState) result = do_compose(other);
-
   _cache_stats.add_total_size(1);
   _cache_stats.inc_adds(_composition_cache.is_empty());
 
@@ -445,9 +468,32 @@ invert_compose(const RenderState *other) const {
     return do_invert_compose(other);
   }
 
+  {
+    // Is this composition already cached?  Looking it up only requires the
+    // lock for this particular state.
+    LightReMutexHolder holder(get_cache_lock(this));
+    int index = _invert_composition_cache.find(other);
+    if (index != -1) {
+      const Composition &comp = _invert_composition_cache.get_data(index);
+      if (comp._result != nullptr) {
+        // Here's the cache!
+        _cache_stats.inc_hits();
+        return comp._result;
+      }
+    }
+  }
+
+  // Not in the cache.  Compute a new result.  It's important that we don't
+  // hold the lock while we do this, or we lose the benefit of
+  // parallelization.
+  CPT(RenderState) result = do_invert_compose(other);
+
+  // Modifying the cache requires the global lock as well as the locks for
+  // both of the states involved.
   LightReMutexHolder holder(*_states_lock);
+  LightReMutexHolder holder1(get_cache_lock(this));
+  LightReMutexHolder holder2(get_cache_lock(other));
 
-  // Is this composition already cached?
   int index = _invert_composition_cache.find(other);
   if (index != -1) {
     Composition &comp = ((RenderState *)this)->_invert_composition_cache.modify_data(index);
@@ -455,7 +501,6 @@ invert_compose(const RenderState *other) const {
       // Well, it wasn't cached already, but we already had an entry (probably
       // created for the reverse direction), so use the same entry to store
       // the new result.
-      CPT(RenderState) result = do_invert_compose(other);
       comp._result = result;
 
       if (result != (const RenderState *)this) {
@@ -476,8 +521,6 @@ invert_compose(const RenderState *other) const {
 
   // The cache entry in this object is the only one that indicates the result;
   // the other will be NULL for now.
-  CPT(RenderState) result = do_invert_compose(other);
-
   _cache_stats.add_total_size(1);
   _cache_stats.inc_adds(_invert_composition_cache.is_empty());
   ((RenderState *)this)->_invert_composition_cache[other]._result = result;
@@ -846,6 +889,7 @@ clear_cache() {
     TempStates::iterator ti;
     for (ti = temp_states.begin(); ti != temp_states.end(); ++ti) {
       RenderState *state = (RenderState *)(*ti).p();
+      LightReMutexHolder cache_holder(get_cache_lock(state));
 
       size_t i;
       size_t cache_size = (int)state->_composition_cache.get_num_entries();
@@ -886,6 +930,10 @@ clear_cache() {
  * appropriately.  It does no harm to call it even if this variable is not
  * true, but there is probably no advantage in that case.
  *
+ * Each call visits at most garbage-collect-states-budget states, resuming
+ * where the previous call left off, so that the cost may be spread over
+ * several frames.  Returns the number of states that were freed.
+ *
  * This automatically calls RenderAttrib::garbage_collect() as well.
  */
 int RenderState::
@@ -900,70 +948,73 @@ garbage_collect() {
 
   PStatTimer timer(_garbage_collect_pcollector);
   size_t orig_size = _states.get_num_entries();
-
-  // How many elements to process this pass?
   size_t size = orig_size;
-  size_t num_this_pass = std::max(0, int(size * garbage_collect_states_rate));
-  if (num_this_pass <= 0) {
-    return num_attribs;
+
+  // New states are always appended to the end of the table, so the states
+  // past _garbage_young_index have been created since the previous pass.
+  // Since most transient states are released soon after they are created,
+  // we make sure to visit all of those, and spend the rest of the budget on
+  // a fraction of the older states.
+  size_t old_size = std::min(_garbage_young_index, size);
+
+  size_t budget = size;
+  if (garbage_collect_states_budget > 0) {
+    budget = std::min(budget, (size_t)garbage_collect_states_budget);
   }
+  size_t num_young = std::min(size - old_size, budget);
+  size_t num_old = std::max(0, int(old_size * garbage_collect_states_rate));
+  num_old = std::min(num_old, budget - num_young);
 
   bool break_and_uniquify = (auto_break_cycles && uniquify_transforms);
 
+  // First, continue the sweep through the old generation where the previous
+  // pass left off.
   size_t si = _garbage_index;
-  if (si >= size) {
+  if (si >= old_size) {
     si = 0;
   }
-
-  num_this_pass = std::min(num_this_pass, size);
-  size_t stop_at_element = (si + num_this_pass) % size;
-
-  do {
-    RenderState *state = (RenderState *)_states.get_key(si);
-    if (break_and_uniquify) {
-      if (state->get_cache_ref_count() > 0 &&
-          state->get_ref_count() == state->get_cache_ref_count()) {
-        // If we have removed all the references to this state not in the
-        // cache, leaving only references in the cache, then we need to
-        // check for a cycle involving this RenderState and break it if it
-        // exists.
-        state->detect_and_break_cycles();
-      }
-    }
-
-    if (!state->unref_if_one()) {
-      // This state has recently been unreffed to 1 (the one we added when
-      // we stored it in the cache).  Now it's time to delete it.  This is
-      // safe, because we're holding the _states_lock, so it's not possible
-      // for some other thread to find the state in the cache and ref it
-      // while we're doing this.  Also, we've just made sure to unref it to 0,
-      // to ensure that another thread can't get it via a weak pointer.
-
-      state->release_new();
-      state->remove_cache_pointers();
-      state->cache_unref_only();
-      delete state;
-
+  while (num_old > 0 && old_size > 0) {
+    --num_old;
+    if (garbage_collect_element(si, break_and_uniquify)) {
       // When we removed it from the hash map, it swapped the last element
-      // with the one we just removed.  So the current index contains one we
-      // still need to visit.
+      // with the one we just removed.  If that was a young state, it has now
+      // been promoted to the old generation; otherwise the old generation
+      // has shrunk.  Either way, the current index contains one we still
+      // need to visit.
+      if (old_size == size) {
+        --old_size;
+      }
       --size;
-      --si;
-      if (stop_at_element > 0) {
-        --stop_at_element;
+      if (si >= old_size) {
+        si = 0;
       }
+    } else {
+      si = (si + 1) % old_size;
     }
-
-    si = (si + 1) % size;
-  } while (si != stop_at_element);
+  }
   _garbage_index = si;
 
-  nassertr(_states.get_num_entries() == size, 0);
+  // Now visit the young generation.  The states that survive this are
+  // promoted to the old generation.
+  si = old_size;
+  while (num_young > 0 && si < size) {
+    --num_young;
+    if (garbage_collect_element(si, break_and_uniquify)) {
+      --size;
+    } else {
+      ++si;
+    }
+  }
+  _garbage_young_index = si;
+
+  nassertr(_states.get_num_entries() == size, num_attribs);
 
 #ifdef _DEBUG
-  nassertr(_states.validate(), 0);
+  nassertr(_states.validate(), num_attribs);
 #endif
 
+  _reclaimed_counter.set_level((double)(orig_size - size));
+
   // If we just cleaned up a lot of states, see if we can reduce the table in
   // size.  This will help reduce iteration overhead in the future.
   _states.consider_shrink_table();
@@ -971,6 +1022,42 @@ garbage_collect() {
   return (int)orig_size - (int)size + num_attribs;
 }
 
+/**
+ * Visits the nth element of the _states table as part of garbage_collect(),
+ * and deletes it if it is no longer referenced outside of the cache.  Returns
+ * true if the state was deleted, in which case the last element of the table
+ * has been moved into its place.  Assumes the lock is held.
+ */
+bool RenderState::
+garbage_collect_element(size_t n, bool break_and_uniquify) {
+  RenderState *state = (RenderState *)_states.get_key(n);
+  if (break_and_uniquify) {
+    if (state->get_cache_ref_count() > 0 &&
+        state->get_ref_count() == state->get_cache_ref_count()) {
+      // If we have removed all the references to this state not in the
+      // cache, leaving only references in the cache, then we need to check
+      // for a cycle involving this RenderState and break it if it exists.
+      state->detect_and_break_cycles();
+    }
+  }
+
+  if (state->unref_if_one()) {
+    return false;
+  }
+
+  // This state has recently been unreffed to 1 (the one we added when we
+  // stored it in the cache).  Now it's time to delete it.  This is safe,
+  // because we're holding the _states_lock, so it's not possible for some
+  // other thread to find the state in the cache and ref it while we're doing
+  // this.  Also, we've just made sure to unref it to 0, to ensure that
+  // another thread can't get it via a weak pointer.
+  state->release_new();
+  state->remove_cache_pointers();
+  state->cache_unref_only();
+  delete state;
+  return true;
+}
+
 /**
  * Completely empties the cache of state + gsg -> munger, for all states and
  * all gsg's.  Normally there is no need to empty this cache.
@@ -1655,32 +1742,43 @@ remove_cache_pointers() {
     // Now we can remove the element from our cache.  We do this now, rather
     // than later, before any other RenderState objects have had a chance to
     // destruct, so we are confident that our iterator is still valid.
-    _composition_cache.remove_element(i);
-    _cache_stats.add_total_size(-1);
-    _cache_stats.inc_dels();
-
-    if (other != this) {
-      int oi = other->_composition_cache.find(this);
-
-      // We may or may not still be listed in the other's cache (it might be
-      // halfway through pulling entries out, from within its own destructor).
-      if (oi != -1) {
-        // Hold a copy of the other composition result, too.
-        Composition ocomp = other->_composition_cache.get_data(oi);
-
-        other->_composition_cache.remove_element(oi);
-        _cache_stats.add_total_size(-1);
-        _cache_stats.inc_dels();
-
-        // It's finally safe to let our held pointers go away.  This may have
-        // cascading effects as other RenderState objects are destructed, but
-        // there will be no harm done if they destruct now.
-        if (ocomp._result != nullptr && ocomp._result != other) {
-          cache_unref_delete(ocomp._result);
+
+    // Modifying the caches also requires holding the locks for both states,
+    // but we mustn't hold them while other objects are destructed.
+    Composition ocomp;
+    ocomp._result = nullptr;
+    {
+      LightReMutexHolder holder1(get_cache_lock(this));
+      LightReMutexHolder holder2(get_cache_lock(other));
+
+      _composition_cache.remove_element(i);
+      _cache_stats.add_total_size(-1);
+      _cache_stats.inc_dels();
+
+      if (other != this) {
+        int oi = other->_composition_cache.find(this);
+
+        // We may or may not still be listed in the other's cache (it might
+        // be halfway through pulling entries out, from within its own
+        // destructor).
+        if (oi != -1) {
+          // Hold a copy of the other composition result, too.
+          ocomp = other->_composition_cache.get_data(oi);
+
+          other->_composition_cache.remove_element(oi);
+          _cache_stats.add_total_size(-1);
+          _cache_stats.inc_dels();
         }
       }
     }
 
+    // It's finally safe to let our held pointers go away.  This may have
+    // cascading effects as other RenderState objects are destructed, but
+    // there will be no harm done if they destruct now.
+    if (ocomp._result != nullptr && ocomp._result != other) {
+      cache_unref_delete(ocomp._result);
+    }
+
     // It's finally safe to let our held pointers go away.  (See comment
     // above.)
     if (comp._result != nullptr && comp._result != this) {
@@ -1694,21 +1792,27 @@ remove_cache_pointers() {
     RenderState *other = (RenderState *)_invert_composition_cache.get_key(i);
     nassertv(other != this);
     Composition comp = _invert_composition_cache.get_data(i);
-    _invert_composition_cache.remove_element(i);
-    _cache_stats.add_total_size(-1);
-    _cache_stats.inc_dels();
-    if (other != this) {
-      int oi = other->_invert_composition_cache.find(this);
-      if (oi != -1) {
-        Composition ocomp = other->_invert_composition_cache.get_data(oi);
-        other->_invert_composition_cache.remove_element(oi);
-        _cache_stats.add_total_size(-1);
-        _cache_stats.inc_dels();
-        if (ocomp._result != nullptr && ocomp._result != other) {
-          cache_unref_delete(ocomp._result);
+    Composition ocomp;
+    ocomp._result = nullptr;
+    {
+      LightReMutexHolder holder1(get_cache_lock(this));
+      LightReMutexHolder holder2(get_cache_lock(other));
+      _invert_composition_cache.remove_element(i);
+      _cache_stats.add_total_size(-1);
+      _cache_stats.inc_dels();
+      if (other != this) {
+        int oi = other->_invert_composition_cache.find(this);
+        if (oi != -1) {
+          ocomp = other->_invert_composition_cache.get_data(oi);
+          other->_invert_composition_cache.remove_element(oi);
+          _cache_stats.add_total_size(-1);
+          _cache_stats.inc_dels();
         }
       }
     }
+    if (ocomp._result != nullptr && ocomp._result != other) {
+      cache_unref_delete(ocomp._result);
+    }
     if (comp._result != nullptr && comp._result != this) {
       cache_unref_delete(comp._result);
     }
@@ -1842,6 +1946,7 @@ init_states() {
   // OK because we guarantee that this method is called at static init time,
   // presumably when there is still only one thread in the world.
   _states_lock = new LightReMutex("RenderState::_states_lock");
+  _cache_locks = new LightReMutex[num_cache_locks];
   _cache_stats.init();
   nassertv(Thread::get_current_thread() == Thread::get_main_thread());
 
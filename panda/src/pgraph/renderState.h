@@ -211,6 +211,9 @@ private:
 
   void release_new();
   void remove_cache_pointers();
+  static bool garbage_collect_element(size_t n, bool break_and_uniquify);
+
+  INLINE static LightReMutex &get_cache_lock(const RenderState *state);
 
   void determine_bin_index();
   void determine_cull_callback();
@@ -237,6 +240,15 @@ private:
   // cache, which is encoded in _composition_cache and
   // _invert_composition_cache.
   static LightReMutex *_states_lock;
+
+  // These mutexes are striped over the RenderState objects by address.
+  // Modifying the composition cache of a RenderState requires holding
+  // _states_lock as well as the stripe for that RenderState, but a lookup in
+  // the composition cache only requires the stripe.  This keeps the common
+  // case of a cache hit in compose() from contending on _states_lock.
+  enum { num_cache_locks = 64 };
+  static LightReMutex *_cache_locks;
+
   typedef SimpleHashMap<const RenderState *, std::nullptr_t, indirect_compare_to_hash<const RenderState *> > States;
   static States _states;
   static const RenderState *_empty_state;
@@ -288,6 +300,10 @@ private:
   // cycle.
   static size_t _garbage_index;
 
+  // The states in _states at or past this index were added since the last
+  // garbage collection pass.
+  static size_t _garbage_young_index;
+
   static PStatCollector _cache_update_pcollector;
   static PStatCollector _garbage_collect_pcollector;
   static PStatCollector _state_compose_pcollector;
@@ -297,6 +313,7 @@ private:
 
   static PStatCollector _node_counter;
   static PStatCollector _cache_counter;
+  static PStatCollector _reclaimed_counter;
 
 private:
   // This is the actual data within the RenderState: a set of max_slots
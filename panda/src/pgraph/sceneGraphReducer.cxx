@@ -20,6 +20,10 @@
 #include "plist.h"
 #include "pmap.h"
 #include "geomNode.h"
+#include "geomTriangles.h"
+#include "meshletNode.h"
+#include "geomVertexReader.h"
+#include "geomVertexWriter.h"
 #include "config_gobj.h"
 #include "thread.h"
 
@@ -32,6 +36,9 @@ PStatCollector SceneGraphReducer::_make_nonindexed_collector("*:Flatten:make non
 PStatCollector SceneGraphReducer::_unify_collector("*:Flatten:unify");
 PStatCollector SceneGraphReducer::_remove_unused_collector("*:Flatten:remove unused vertices");
 PStatCollector SceneGraphReducer::_premunge_collector("*:Premunge");
+PStatCollector SceneGraphReducer::_optimize_vertices_collector("*:Flatten:optimize vertices");
+PStatCollector SceneGraphReducer::_make_meshlets_collector("*:Flatten:make meshlets");
+PStatCollector SceneGraphReducer::_compact_vertices_collector("*:Flatten:compact vertices");
 
 /**
  * Specifies the particular GraphicsStateGuardian that this object will
@@ -79,10 +86,15 @@ clear_gsg() {
  * node.  This will further reduce scene graph complexity, sometimes
  * substantially, at the cost of reduced spatial separation.
  *
+ * If optimize_vertices_bits is nonzero, optimize_vertices() is called on the
+ * root afterwards with these bits.  This is separate from
+ * combine_siblings_bits, so that it is not enabled by callers that pass ~0.
+ *
  * Returns the number of nodes removed from the graph.
  */
 int SceneGraphReducer::
-flatten(PandaNode *root, int combine_siblings_bits) {
+flatten(PandaNode *root, int combine_siblings_bits,
+        int optimize_vertices_bits) {
   nassertr(check_live_flatten(root), 0);
 
   PStatTimer timer(_flatten_collector);
@@ -116,6 +128,10 @@ flatten(PandaNode *root, int combine_siblings_bits) {
     // could convert cousins into siblings, which may get flattened next pass.
   } while ((combine_siblings_bits & CS_recurse) != 0 && num_pass_nodes != 0);
 
+  if (optimize_vertices_bits != 0) {
+    optimize_vertices(root, optimize_vertices_bits);
+  }
+
   return num_total_nodes;
 }
 
@@ -202,6 +218,103 @@ remove_unused_vertices(PandaNode *root) {
   Thread::consider_yield();
 }
 
+/**
+ * Reorders the triangles and vertices of the Geoms at this level and below
+ * for faster rendering, without changing their appearance.  The parameter
+ * optimize_bits is a union of bits defined in
+ * SceneGraphReducer::OptimizeVertices, which specifies which optimizations
+ * to perform.
+ *
+ * This is best done after unify(), since unify() may append primitives
+ * together in a way that undoes some of the benefit.  Only triangles are
+ * reordered, so this is also more effective after decompose().
+ */
+void SceneGraphReducer::
+optimize_vertices(PandaNode *root, int optimize_bits) {
+  nassertv(check_live_flatten(root));
+  PStatTimer timer(_optimize_vertices_collector);
+
+  PN_stdfloat acmr_before = 0.0f;
+  if (pgraph_cat.is_debug()) {
+    acmr_before = calc_acmr(root);
+  }
+
+  GeomTransformer transformer;
+  r_optimize_vertices(root, optimize_bits, transformer);
+  if ((optimize_bits & OV_vertex_fetch) != 0) {
+    transformer.optimize_vertex_fetch();
+  }
+
+  if (pgraph_cat.is_debug()) {
+    pgraph_cat.debug()
+      << "Optimized vertices of " << *root << ": ACMR went from "
+      << acmr_before << " to " << calc_acmr(root) << "\n";
+  }
+  Thread::consider_yield();
+}
+
+/**
+ * Replaces each GeomNode at this level and below that has a Geom with more
+ * than max_triangles triangles with a MeshletNode, in which each such Geom is
+ * split into spatially coherent clusters of at most that many triangles.
+ * Each cluster is then culled separately, against the view frustum and by
+ * the cone of its normals.  Returns the number of GeomNodes replaced.
+ *
+ * This is best done after flattening and after optimize_vertices(), since
+ * later changes to the vertices disable the cone test until
+ * MeshletNode::recompute_clusters() is called.
+ */
+int SceneGraphReducer::
+make_meshlets(PandaNode *root, int max_triangles) {
+  nassertr(check_live_flatten(root), 0);
+  nassertr(max_triangles > 0, 0);
+  PStatTimer timer(_make_meshlets_collector);
+
+  return r_make_meshlets(root, max_triangles);
+}
+
+/**
+ * Stores the vertices of the GeomNodes at this level and below in a more
+ * compact form, to save memory and vertex fetch bandwidth.  The parameter
+ * compact_bits is a union of bits defined in
+ * SceneGraphReducer::CompactVertices, which specifies what is to be
+ * compacted.  The rendered result is the same, up to the precision of the
+ * compact formats.
+ *
+ * Quantizing the positions changes the transform on the affected GeomNodes,
+ * so it is not done unless CV_positions is given, and it should be done after
+ * flatten(), which would otherwise undo it.
+ *
+ * Returns the number of GeomVertexDatas that were converted.
+ */
+int SceneGraphReducer::
+compact_vertices(PandaNode *root, int compact_bits) {
+  nassertr(check_live_flatten(root), 0);
+  PStatTimer timer(_compact_vertices_collector);
+
+  CompactedData compacted;
+  QuantizedDatas quantized;
+  return r_compact_vertices(root, compact_bits, compacted, quantized);
+}
+
+/**
+ * Returns the average cache miss ratio of all of the triangles at this level
+ * and below, weighted by the number of triangles in each primitive.  This is
+ * the average number of vertices that need to be transformed per triangle
+ * rendered, which is a good measure of the effectiveness of
+ * optimize_vertices().  See GeomTriangles::calc_acmr().
+ */
+PN_stdfloat SceneGraphReducer::
+calc_acmr(PandaNode *root) const {
+  double num_misses = 0.0;
+  int num_triangles = 0;
+  r_calc_acmr(root, num_misses, num_triangles);
+  if (num_triangles == 0) {
+    return 0.0f;
+  }
+  return (PN_stdfloat)(num_misses / num_triangles);
+}
+
 /**
  * In a non-release build, returns false if the node is correctly not in a
  * live scene graph.  (Calling flatten on a node that is part of a live scene
@@ -948,6 +1061,257 @@ r_decompose(PandaNode *node) {
   }
 }
 
+/**
+ * The recursive implementation of optimize_vertices().
+ */
+void SceneGraphReducer::
+r_optimize_vertices(PandaNode *node, int optimize_bits,
+                    GeomTransformer &transformer) {
+  if (node->is_geom_node()) {
+    GeomNode *geom_node = DCAST(GeomNode, node);
+    int cache_size = optimize_vertex_cache_size;
+    int num_geoms = geom_node->get_num_geoms();
+    for (int i = 0; i < num_geoms; ++i) {
+      PT(Geom) geom = geom_node->modify_geom(i);
+      if ((optimize_bits & OV_vertex_cache) != 0) {
+        geom->optimize_vertex_cache_in_place(cache_size);
+      }
+      if ((optimize_bits & OV_overdraw) != 0) {
+        geom->optimize_overdraw_in_place(optimize_overdraw_threshold, cache_size);
+      }
+    }
+    if ((optimize_bits & OV_vertex_fetch) != 0) {
+      transformer.register_vertices(geom_node, false);
+    }
+  }
+
+  PandaNode::Children children = node->get_children();
+  int num_children = children.get_num_children();
+  for (int i = 0; i < num_children; ++i) {
+    r_optimize_vertices(children.get_child(i), optimize_bits, transformer);
+  }
+  Thread::consider_yield();
+}
+
+/**
+ * The recursive implementation of make_meshlets().
+ */
+int SceneGraphReducer::
+r_make_meshlets(PandaNode *node, int max_triangles) {
+  int count = 0;
+
+  PandaNode::Children children = node->get_children();
+  int num_children = children.get_num_children();
+  for (int i = 0; i < num_children; ++i) {
+    count += r_make_meshlets(children.get_child(i), max_triangles);
+  }
+
+  if (node->is_exact_type(GeomNode::get_class_type())) {
+    GeomNode *geom_node = DCAST(GeomNode, node);
+    if (geom_node->get_preserved()) {
+      return count;
+    }
+
+    bool any_large = false;
+    int num_geoms = geom_node->get_num_geoms();
+    for (int i = 0; i < num_geoms && !any_large; ++i) {
+      CPT(Geom) geom = geom_node->get_geom(i);
+      if (geom->get_primitive_type() == Geom::PT_polygons) {
+        int num_triangles = 0;
+        for (size_t j = 0; j < geom->get_num_primitives(); ++j) {
+          num_triangles += geom->get_primitive(j)->get_num_faces();
+        }
+        any_large = (num_triangles > max_triangles);
+      }
+    }
+
+    if (any_large) {
+      PT(MeshletNode) meshlet_node = new MeshletNode(geom_node->get_name());
+      meshlet_node->add_clusters_from(geom_node, max_triangles);
+      meshlet_node->replace_node(geom_node);
+      ++count;
+    }
+  }
+
+  Thread::consider_yield();
+  return count;
+}
+
+/**
+ * The recursive implementation of compact_vertices().  The converted
+ * GeomVertexDatas are recorded, so that shared vertices remain shared.
+ */
+int SceneGraphReducer::
+r_compact_vertices(PandaNode *node, int compact_bits,
+                   CompactedData &compacted, QuantizedDatas &quantized) {
+  int count = 0;
+
+  if (node->is_geom_node()) {
+    GeomNode *geom_node = DCAST(GeomNode, node);
+    int num_geoms = geom_node->get_num_geoms();
+
+    if ((compact_bits & CV_attributes) != 0) {
+      for (int i = 0; i < num_geoms; ++i) {
+        CPT(GeomVertexData) vdata = geom_node->get_geom(i)->get_vertex_data();
+        CompactedData::iterator ci = compacted.find(vdata);
+        if (ci == compacted.end()) {
+          CPT(GeomVertexFormat) format = vdata->get_format()->get_compact_format();
+          CPT(GeomVertexData) new_vdata = vdata;
+          if (format != vdata->get_format()) {
+            new_vdata = vdata->convert_to(format);
+            ++count;
+          }
+          ci = compacted.insert(CompactedData::value_type(vdata, new_vdata)).first;
+        }
+        if ((*ci).second != vdata) {
+          geom_node->modify_geom(i)->set_vertex_data((*ci).second);
+        }
+      }
+    }
+
+    // The positions can only be quantized if all of the Geoms share the same
+    // vertices, since they are all drawn with the same transform.  An effect
+    // such as a billboard would not preserve the extra transform, and the
+    // children of the node would be affected by it.
+    if ((compact_bits & CV_positions) != 0 && num_geoms > 0 &&
+        node->get_num_children() == 0 && node->get_effects()->is_empty() &&
+        !node->get_transform()->is_invalid()) {
+      CPT(GeomVertexData) vdata = geom_node->get_geom(0)->get_vertex_data();
+      bool all_same = true;
+      for (int i = 1; i < num_geoms && all_same; ++i) {
+        all_same = (geom_node->get_geom(i)->get_vertex_data() == vdata);
+      }
+
+      if (all_same) {
+        QuantizedDatas::iterator qi = quantized.find(vdata);
+        if (qi == quantized.end()) {
+          QuantizedData result;
+          if (!quantize_positions(result, vdata)) {
+            result._vdata = nullptr;
+          } else {
+            ++count;
+          }
+          qi = quantized.insert(QuantizedDatas::value_type(vdata, result)).first;
+        }
+
+        const QuantizedData &result = (*qi).second;
+        if (result._vdata != nullptr) {
+          for (int i = 0; i < num_geoms; ++i) {
+            geom_node->modify_geom(i)->set_vertex_data(result._vdata);
+          }
+          LVecBase3 scale(result._scale, result._scale, result._scale);
+          node->set_transform(node->get_transform()->compose(
+            TransformState::make_pos_hpr_scale(result._center, LVecBase3::zero(), scale)));
+        }
+      }
+    }
+
+    if (node->is_of_type(MeshletNode::get_class_type())) {
+      // The cluster bounds are stored in the space of the vertices.
+      DCAST(MeshletNode, node)->recompute_clusters();
+    }
+  }
+
+  PandaNode::Children children = node->get_children();
+  int num_children = children.get_num_children();
+  for (int i = 0; i < num_children; ++i) {
+    count += r_compact_vertices(children.get_child(i), compact_bits,
+                                compacted, quantized);
+  }
+  Thread::consider_yield();
+  return count;
+}
+
+/**
+ * Makes a copy of the indicated vertex data in which the positions are stored
+ * as 16-bit integers, evenly spanning the bounding box of the vertices.  The
+ * original position is recovered by scaling by result._scale and adding
+ * result._center.  Returns false if the positions cannot be quantized.
+ */
+bool SceneGraphReducer::
+quantize_positions(QuantizedData &result, const GeomVertexData *vdata) {
+  const GeomVertexFormat *format = vdata->get_format();
+  const GeomVertexColumn *column = format->get_vertex_column();
+  if (column == nullptr || column->get_num_components() != 3 ||
+      column->get_num_elements() != 1 ||
+      (column->get_numeric_type() != GeomEnums::NT_float32 &&
+       column->get_numeric_type() != GeomEnums::NT_float64) ||
+      format->get_animation().get_animation_type() != GeomEnums::AT_none ||
+      format->get_num_morphs() != 0 || vdata->get_num_rows() == 0) {
+    return false;
+  }
+
+  LPoint3 min_point, max_point;
+  {
+    GeomVertexReader vertex(vdata, InternalName::get_vertex());
+    min_point = max_point = vertex.get_data3();
+    while (!vertex.is_at_end()) {
+      LPoint3 point = vertex.get_data3();
+      min_point.set(std::min(min_point[0], point[0]),
+                    std::min(min_point[1], point[1]),
+                    std::min(min_point[2], point[2]));
+      max_point.set(std::max(max_point[0], point[0]),
+                    std::max(max_point[1], point[1]),
+                    std::max(max_point[2], point[2]));
+    }
+  }
+
+  LVector3 half_extent = (max_point - min_point) * 0.5f;
+  PN_stdfloat extent = std::max(half_extent[0], std::max(half_extent[1], half_extent[2]));
+  result._center = (min_point + max_point) * 0.5f;
+  result._scale = (extent > 0.0f) ? extent / 32767.0f : 1.0f;
+
+  PT(GeomVertexFormat) new_format = new GeomVertexFormat(*format);
+  GeomVertexArrayFormat *array_format =
+    new_format->modify_array(format->get_array_with(InternalName::get_vertex()));
+  array_format->add_column(InternalName::get_vertex(), 3, GeomEnums::NT_int16,
+                           GeomEnums::C_point, column->get_start());
+  array_format->pack_columns();
+
+  PT(GeomVertexData) new_vdata = new GeomVertexData(*vdata);
+  new_vdata->set_format(GeomVertexFormat::register_format(new_format));
+
+  GeomVertexReader from(vdata, InternalName::get_vertex());
+  GeomVertexWriter to(new_vdata, InternalName::get_vertex());
+  while (!from.is_at_end()) {
+    LVecBase3 v = (from.get_data3() - result._center) / result._scale;
+    to.set_data3i((int)std::lrint(v[0]), (int)std::lrint(v[1]), (int)std::lrint(v[2]));
+  }
+
+  result._vdata = new_vdata;
+  return true;
+}
+
+/**
+ * The recursive implementation of calc_acmr().
+ */
+void SceneGraphReducer::
+r_calc_acmr(PandaNode *node, double &num_misses, int &num_triangles) const {
+  if (node->is_geom_node()) {
+    GeomNode *geom_node = DCAST(GeomNode, node);
+    int cache_size = optimize_vertex_cache_size;
+    int num_geoms = geom_node->get_num_geoms();
+    for (int i = 0; i < num_geoms; ++i) {
+      CPT(Geom) geom = geom_node->get_geom(i);
+      int num_primitives = geom->get_num_primitives();
+      for (int j = 0; j < num_primitives; ++j) {
+        CPT(GeomPrimitive) prim = geom->get_primitive(j)->decompose();
+        if (prim->is_exact_type(GeomTriangles::get_class_type())) {
+          int count = prim->get_num_primitives();
+          num_misses += DCAST(GeomTriangles, prim)->calc_acmr(cache_size) * count;
+          num_triangles += count;
+        }
+      }
+    }
+  }
+
+  PandaNode::Children children = node->get_children();
+  int num_children = children.get_num_children();
+  for (int i = 0; i < num_children; ++i) {
+    r_calc_acmr(children.get_child(i), num_misses, num_triangles);
+  }
+}
+
 /**
  * The recursive implementation of premunge().
  */
@@ -24,6 +24,7 @@
 #include "pStatTimer.h"
 #include "typedObject.h"
 #include "pointerTo.h"
+#include "pmap.h"
 #include "graphicsStateGuardianBase.h"
 
 class PandaNode;
@@ -59,6 +60,20 @@ PUBLISHED:
     CS_recurse         = 0x008,
   };
 
+  enum OptimizeVertices {
+    // If set, the triangles are reordered for better use of the post-
+    // transform vertex cache.
+    OV_vertex_cache    = 0x001,
+
+    // If set, clusters of triangles are then reordered to reduce overdraw.
+    OV_overdraw        = 0x002,
+
+    // If set, the vertices in each GeomVertexData are reordered into the
+    // order in which they are first used, for better locality of vertex
+    // fetches.
+    OV_vertex_fetch    = 0x004,
+  };
+
   enum CollectVertexData {
     // If set, two GeomVertexDatas with different names will not be collected
     // together.
@@ -113,6 +128,19 @@ PUBLISHED:
     MN_avoid_dynamic   = 0x004,
   };
 
+  enum CompactVertices {
+    // If set, floating-point normals and texture coordinates are stored in
+    // the format returned by GeomVertexFormat::get_compact_format().
+    CV_attributes      = 0x001,
+
+    // If set, the vertex positions of a GeomNode are quantized to 16-bit
+    // integers relative to the bounding box of its vertices, and the GeomNode
+    // is given a transform that maps them back.  This is only done for
+    // unanimated GeomNodes without children.  Since this changes the
+    // transforms in the scene graph, it must be requested explicitly.
+    CV_positions       = 0x002,
+  };
+
   void set_gsg(GraphicsStateGuardianBase *gsg);
   void clear_gsg();
   INLINE GraphicsStateGuardianBase *get_gsg() const;
@@ -124,7 +152,8 @@ PUBLISHED:
   INLINE void apply_attribs(PandaNode *node, const AccumulatedAttribs &attribs,
                             int attrib_types, GeomTransformer &transformer);
 
-  int flatten(PandaNode *root, int combine_siblings_bits);
+  int flatten(PandaNode *root, int combine_siblings_bits,
+              int optimize_vertices_bits = 0);
 
   int remove_column(PandaNode *root, const InternalName *column);
 
@@ -137,6 +166,10 @@ PUBLISHED:
   INLINE int make_nonindexed(PandaNode *root, int nonindexed_bits = ~0);
   void unify(PandaNode *root, bool preserve_order);
   void remove_unused_vertices(PandaNode *root);
+  void optimize_vertices(PandaNode *root, int optimize_bits = ~0);
+  PN_stdfloat calc_acmr(PandaNode *root) const;
+  int make_meshlets(PandaNode *root, int max_triangles = 128);
+  int compact_vertices(PandaNode *root, int compact_bits = CV_attributes);
 
   INLINE void premunge(PandaNode *root, const RenderState *initial_state);
   bool check_live_flatten(PandaNode *node);
@@ -177,6 +210,25 @@ protected:
   void r_unify(PandaNode *node, int max_indices, bool preserve_order);
   void r_register_vertices(PandaNode *node, GeomTransformer &transformer);
   void r_decompose(PandaNode *node);
+  void r_optimize_vertices(PandaNode *node, int optimize_bits,
+                           GeomTransformer &transformer);
+  void r_calc_acmr(PandaNode *node, double &num_misses,
+                   int &num_triangles) const;
+  int r_make_meshlets(PandaNode *node, int max_triangles);
+
+  class QuantizedData {
+  public:
+    CPT(GeomVertexData) _vdata;
+    LPoint3 _center;
+    PN_stdfloat _scale;
+  };
+  typedef pmap<CPT(GeomVertexData), CPT(GeomVertexData)> CompactedData;
+  typedef pmap<CPT(GeomVertexData), QuantizedData> QuantizedDatas;
+
+  int r_compact_vertices(PandaNode *node, int compact_bits,
+                         CompactedData &compacted, QuantizedDatas &quantized);
+  static bool quantize_positions(QuantizedData &result,
+                                 const GeomVertexData *vdata);
 
   void r_premunge(PandaNode *node, const RenderState *state);
 
@@ -194,6 +246,9 @@ private:
   static PStatCollector _unify_collector;
   static PStatCollector _remove_unused_collector;
   static PStatCollector _premunge_collector;
+  static PStatCollector _optimize_vertices_collector;
+  static PStatCollector _make_meshlets_collector;
+  static PStatCollector _compact_vertices_collector;
 };
 
 #include "sceneGraphReducer.I"
@@ -0,0 +1,124 @@
+/**
+ * PANDA 3D SOFTWARE
+ * Copyright (c) Carnegie Mellon University.  All rights reserved.
+ *
+ * All use of this software is subject to the terms of the revised BSD
+ * license.  You should have received a copy of this license along
+ * with this source code in a file named "LICENSE."
+ *
+ * @file test_batch_transform.cxx
+ * @author djs3000
+ * @date 2026-10-16
+ */
+
+#include "pandabase.h"
+#include "nodePath.h"
+#include "nodePathCollection.h"
+#include "pandaNode.h"
+#include "pta_LVecBase3.h"
+#include "pta_LMatrix4.h"
+#include "randomizer.h"
+#include "trueClock.h"
+
+// This compares the time taken to move many nodes with a loop over
+// NodePath::set_pos_hpr_scale() against the batched NodePathCollection
+// methods.  The nodes are spread over a number of groups, as they would be
+// in a typical scene, so that the batched version can mark each group's
+// bounds stale only once.  The bounds of the root are requested after each
+// frame, so that they are genuinely stale again on the next frame.
+
+static const int num_groups = 100;
+static const int num_nodes_per_group = 100;
+static const int num_iterations = 100;
+
+int
+main(int argc, char *argv[]) {
+  NodePath root("root");
+  NodePathCollection nodes;
+  for (int gi = 0; gi < num_groups; ++gi) {
+    NodePath group = root.attach_new_node("group");
+    for (int ni = 0; ni < num_nodes_per_group; ++ni) {
+      nodes.add_path(group.attach_new_node("node"));
+    }
+  }
+  int num_nodes = nodes.get_num_paths();
+
+  TrueClock *clock = TrueClock::get_global_ptr();
+  Randomizer random(42);
+
+  PTA_LVecBase3 pos = PTA_LVecBase3::empty_array(num_nodes);
+  PTA_LVecBase3 hpr = PTA_LVecBase3::empty_array(num_nodes);
+  PTA_LVecBase3 scale = PTA_LVecBase3::empty_array(num_nodes);
+  PTA_LMatrix4 mats = PTA_LMatrix4::empty_array(num_nodes);
+
+  double loop_time = 0.0;
+  double batch_time = 0.0;
+  double mat_loop_time = 0.0;
+  double mat_batch_time = 0.0;
+  int num_mismatched = 0;
+
+  for (int n = 0; n < num_iterations; ++n) {
+    for (int i = 0; i < num_nodes; ++i) {
+      pos[i].set(random.random_real(100), random.random_real(100), random.random_real(100));
+      hpr[i].set(random.random_real(360), random.random_real(360), 0);
+      scale[i].set(1, 1, 1 + random.random_real(1));
+      LMatrix4 mat;
+      compose_matrix(mat, scale[i], LVecBase3::zero(), hpr[i], pos[i]);
+      mats[i] = mat;
+    }
+
+    double start = clock->get_short_time();
+    for (int i = 0; i < num_nodes; ++i) {
+      nodes[i].set_pos_hpr_scale(pos[i], hpr[i], scale[i]);
+    }
+    loop_time += clock->get_short_time() - start;
+    root.get_bounds();
+
+    pvector<CPT(TransformState)> expected(num_nodes);
+    for (int i = 0; i < num_nodes; ++i) {
+      expected[i] = nodes[i].get_transform();
+      nodes[i].clear_transform();
+    }
+    root.get_bounds();
+
+    start = clock->get_short_time();
+    nodes.set_pos_hpr_scale(pos, hpr, scale);
+    batch_time += clock->get_short_time() - start;
+    root.get_bounds();
+
+    for (int i = 0; i < num_nodes; ++i) {
+      if (nodes[i].get_transform() != expected[i]) {
+        ++num_mismatched;
+      }
+    }
+
+    start = clock->get_short_time();
+    for (int i = 0; i < num_nodes; ++i) {
+      nodes[i].set_mat(mats[i]);
+    }
+    mat_loop_time += clock->get_short_time() - start;
+    root.get_bounds();
+
+    for (int i = 0; i < num_nodes; ++i) {
+      nodes[i].clear_transform();
+    }
+    root.get_bounds();
+
+    start = clock->get_short_time();
+    nodes.set_mats(mats);
+    mat_batch_time += clock->get_short_time() - start;
+    root.get_bounds();
+  }
+
+  double scale_ms = 1000.0 / num_iterations;
+  nout << num_nodes << " nodes in " << num_groups << " groups\n"
+       << "set_pos_hpr_scale, loop:    " << loop_time * scale_ms << " ms\n"
+       << "set_pos_hpr_scale, batched: " << batch_time * scale_ms << " ms ("
+       << loop_time / batch_time << "x)\n"
+       << "set_mat, loop:              " << mat_loop_time * scale_ms << " ms\n"
+       << "set_mats, batched:          " << mat_batch_time * scale_ms << " ms ("
+       << mat_loop_time / mat_batch_time << "x)\n"
+       << num_mismatched << " mismatched transforms\n";
+
+  return (num_mismatched == 0) ? 0 : 1;
+}
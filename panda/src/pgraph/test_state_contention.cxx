@@ -0,0 +1,134 @@
+/**
+ * PANDA 3D SOFTWARE
+ * Copyright (c) Carnegie Mellon University.  All rights reserved.
+ *
+ * All use of this software is subject to the terms of the revised BSD
+ * license.  You should have received a copy of this license along
+ * with this source code in a file named "LICENSE."
+ *
+ * @file test_state_contention.cxx
+ * @author djs3000
+ * @date 2026-10-16
+ */
+
+#include "pandabase.h"
+#include "thread.h"
+#include "lightMutex.h"
+#include "lightMutexHolder.h"
+#include "pmutex.h"
+#include "mutexHolder.h"
+#include "pointerTo.h"
+#include "pvector.h"
+#include "trueClock.h"
+#include "transformState.h"
+#include "renderState.h"
+#include "colorAttrib.h"
+#include "colorScaleAttrib.h"
+#include "randomizer.h"
+
+// This measures the throughput of TransformState::compose() and
+// RenderState::compose() with a varying number of threads, all hitting the
+// composition caches of a shared pool of states.  Each configuration is run
+// twice: once with the caches as they are, and once with every compose()
+// serialized through a single global mutex, which is how the caches behaved
+// when they were all protected by _states_lock.
+
+// The number of distinct states in the shared pool.
+static const int num_states = 256;
+
+// The number of compose() calls each thread makes per run.
+static const int compositions_per_thread = 200000;
+
+// The largest number of threads to try.
+static const int max_threads = 8;
+
+static pvector<CPT(TransformState)> transforms;
+static pvector<CPT(RenderState)> states;
+
+static LightMutex global_lock;
+static Mutex _output_lock;
+
+#define OUTPUT(stuff) { \
+  MutexHolder holder(_output_lock); \
+  stuff; \
+}
+
+class ComposeThread : public Thread {
+public:
+  ComposeThread(const std::string &name, int seed, bool serialize) :
+    Thread(name, name),
+    _seed(seed),
+    _serialize(serialize)
+  {
+  }
+
+  virtual void thread_main() {
+    Randomizer random(_seed);
+    for (int i = 0; i < compositions_per_thread; ++i) {
+      int a = random.random_int(num_states);
+      int b = random.random_int(num_states);
+      if (_serialize) {
+        LightMutexHolder holder(global_lock);
+        transforms[a]->compose(transforms[b]);
+        states[a]->compose(states[b]);
+      } else {
+        transforms[a]->compose(transforms[b]);
+        states[a]->compose(states[b]);
+      }
+    }
+  }
+
+  int _seed;
+  bool _serialize;
+};
+
+static double
+run(int num_threads, bool serialize) {
+  TrueClock *clock = TrueClock::get_global_ptr();
+  double start_time = clock->get_short_time();
+
+  typedef pvector<PT(ComposeThread)> Threads;
+  Threads threads;
+  for (int i = 0; i < num_threads; ++i) {
+    PT(ComposeThread) thread = new ComposeThread(
+      std::string(1, (char)('a' + i)), i + 1, serialize);
+    threads.push_back(thread);
+    thread->start(TP_normal, true);
+  }
+
+  for (ComposeThread *thread : threads) {
+    thread->join();
+  }
+
+  double elapsed_seconds = clock->get_short_time() - start_time;
+  return (double)num_threads * compositions_per_thread / elapsed_seconds;
+}
+
+int
+main(int argc, char *argv[]) {
+  Randomizer random(42);
+  for (int i = 0; i < num_states; ++i) {
+    transforms.push_back(TransformState::make_pos_hpr_scale(
+      LVecBase3(random.random_real(10), random.random_real(10), 0),
+      LVecBase3(random.random_real(360), 0, 0),
+      LVecBase3(1, 1, 1)));
+    states.push_back(RenderState::make(
+      ColorAttrib::make_flat(LColor(random.random_real(1), 0, 0, 1)),
+      ColorScaleAttrib::make(LVecBase4(1, random.random_real(1), 1, 1))));
+  }
+
+  // Warm up the caches, so that we are measuring the cache hit path.
+  run(1, false);
+
+  for (int num_threads = 1; num_threads <= max_threads; num_threads *= 2) {
+    double striped = run(num_threads, false);
+    double serialized = run(num_threads, true);
+    OUTPUT(nout << num_threads << " threads: "
+           << striped / 1000000.0 << " million compositions per second, "
+           << serialized / 1000000.0 << " with a global lock ("
+           << striped / serialized << "x)\n");
+  }
+
+  Thread::prepare_for_exit();
+  return 0;
+}
@@ -20,6 +20,10 @@
 #include "datagramIterator.h"
 #include "dcast.h"
 #include "textureStagePool.h"
+#include "cullTraverser.h"
+#include "cullTraverserData.h"
+#include "sceneSetup.h"
+#include "lens.h"
 
 CPT(RenderAttrib) TextureAttrib::_empty_attrib;
 CPT(RenderAttrib) TextureAttrib::_all_off_attrib;
@@ -451,17 +455,64 @@ has_cull_callback() const {
  */
 bool TextureAttrib::
 cull_callback(CullTraverser *trav, const CullTraverserData &data) const {
+  PN_stdfloat screen_size = -1;
+
   Stages::const_iterator si;
   for (si = _on_stages.begin(); si != _on_stages.end(); ++si) {
     Texture *texture = (*si)._texture;
     if (!texture->cull_callback(trav, data)) {
       return false;
     }
+    if (texture->is_streamed()) {
+      if (screen_size < 0) {
+        screen_size = calc_screen_size(trav, data);
+      }
+      trav->request_texture_screen_size(texture, screen_size);
+    }
   }
 
   return true;
 }
 
+/**
+ * Returns the approximate number of pixels that the node being traversed
+ * spans on screen, for the benefit of streamed textures.
+ */
+PN_stdfloat TextureAttrib::
+calc_screen_size(CullTraverser *trav, const CullTraverserData &data) {
+  SceneSetup *scene = trav->get_scene();
+  const Lens *lens = scene->get_lens();
+  const BoundingVolume *bounds = data.node_reader()->get_bounds();
+  if (lens == nullptr || bounds == nullptr || bounds->is_empty() ||
+      bounds->is_infinite()) {
+    return 0;
+  }
+  const FiniteBoundingVolume *fbv = bounds->as_finite_bounding_volume();
+  if (fbv == nullptr) {
+    return 0;
+  }
+
+  // Bring the bounding box into the space of the camera, and measure the
+  // radius of the sphere around it.
+  CPT(TransformState) modelview = data.get_modelview_transform(trav);
+  const LMatrix4 &mat = modelview->get_mat();
+  LPoint3 min_point = mat.xform_point(fbv->get_min());
+  LPoint3 max_point = mat.xform_point(fbv->get_max());
+  LPoint3 center = (min_point + max_point) * 0.5f;
+  PN_stdfloat radius = (max_point - min_point).length() * 0.5f;
+
+  // Now project it; the perspective divide shrinks it with the distance.
+  const LMatrix4 &proj = lens->get_projection_mat();
+  PN_stdfloat w = center.dot(proj.get_col3(3)) + proj(3, 3);
+  w = std::max(w, radius);
+  if (w <= 0) {
+    return 0;
+  }
+  PN_stdfloat x_size = radius * proj.get_col3(0).length() / w * scene->get_viewport_width();
+  PN_stdfloat y_size = radius * proj.get_col3(1).length() / w * scene->get_viewport_height();
+  return std::max(x_size, y_size);
+}
+
 /**
  * Intended to be overridden by derived TextureAttrib types to return a unique
  * number indicating whether this TextureAttrib is equivalent to the other
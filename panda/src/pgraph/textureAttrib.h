@@ -110,6 +110,8 @@ private:
   INLINE void check_sorted() const;
   void sort_on_stages();
 
+  static PN_stdfloat calc_screen_size(CullTraverser *trav, const CullTraverserData &data);
+
 private:
   class StageNode {
   public:
@@ -27,11 +27,13 @@
 using std::ostream;
 
 LightReMutex *TransformState::_states_lock = nullptr;
+LightReMutex *TransformState::_cache_locks = nullptr;
 TransformState::States TransformState::_states;
 CPT(TransformState) TransformState::_identity_state;
 CPT(TransformState) TransformState::_invalid_state;
 UpdateSeq TransformState::_last_cycle_detect;
 size_t TransformState::_garbage_index = 0;
+size_t TransformState::_garbage_young_index = 0;
 bool TransformState::_uniquify_matrix = true;
 
 PStatCollector TransformState::_cache_update_pcollector("*:State Cache:Update");
@@ -45,6 +47,7 @@ PStatCollector TransformState::_transform_validate_pcollector("*:State Cache:Val
 PStatCollector TransformState::_transform_hash_pcollector("*:State Cache:Calc Hash");
 PStatCollector TransformState::_node_counter("TransformStates:On nodes");
 PStatCollector TransformState::_cache_counter("TransformStates:Cached");
+PStatCollector TransformState::_reclaimed_counter("TransformStates:Reclaimed");
 
 CacheStats TransformState::_cache_stats;
 
@@ -298,6 +301,75 @@ make_mat(const LMatrix4 &mat) {
   return return_new(state);
 }
 
+/**
+ * Fills the result array with a TransformState for each of the indicated
+ * matrices.  This is equivalent to calling make_mat() on each of them, but
+ * faster, since the global table of states is only locked once.
+ */
+void TransformState::
+make_mat_array(CPT(TransformState) *result, const UnalignedLMatrix4 *mats,
+               size_t num_states) {
+  for (size_t i = 0; i < num_states; ++i) {
+    LMatrix4 mat(mats[i]);
+    if (mat.is_nan()) {
+      nassert_raise("mat.is_nan()");
+      result[i] = make_invalid();
+
+    } else if (mat.is_identity()) {
+      result[i] = make_identity();
+
+    } else {
+      TransformState *state = new TransformState;
+      state->_mat = mat;
+      state->_flags = F_mat_known;
+      result[i] = state;
+    }
+  }
+
+  return_new_array(result, num_states);
+}
+
+/**
+ * Fills the result array with a TransformState for each of the indicated
+ * sets of components.  This is equivalent to calling make_pos_hpr_scale() on
+ * each of them, but faster, since the global table of states is only locked
+ * once.  Either hpr or scale may be NULL, to leave the rotation or scale
+ * alone.
+ */
+void TransformState::
+make_pos_hpr_scale_array(CPT(TransformState) *result, const LVecBase3 *pos,
+                         const LVecBase3 *hpr, const LVecBase3 *scale,
+                         size_t num_states) {
+  static const LVecBase3 zero(0.0f, 0.0f, 0.0f);
+  static const LVecBase3 one(1.0f, 1.0f, 1.0f);
+
+  for (size_t i = 0; i < num_states; ++i) {
+    const LVecBase3 &this_pos = pos[i];
+    const LVecBase3 &this_hpr = (hpr != nullptr) ? hpr[i] : zero;
+    const LVecBase3 &this_scale = (scale != nullptr) ? scale[i] : one;
+
+    if (this_pos.is_nan() || this_hpr.is_nan() || this_scale.is_nan()) {
+      nassert_raise("pos, hpr or scale is NaN");
+      result[i] = make_invalid();
+
+    } else if (this_pos == zero && this_hpr == zero && this_scale == one) {
+      result[i] = make_identity();
+
+    } else {
+      TransformState *state = new TransformState;
+      state->_pos = this_pos;
+      state->_hpr = this_hpr;
+      state->_scale = this_scale;
+      state->_shear = zero;
+      state->_flags = F_components_given | F_hpr_given | F_components_known | F_hpr_known | F_has_components;
+      state->check_uniform_scale();
+      result[i] = state;
+    }
+  }
+
+  return_new_array(result, num_states);
+}
+
 /**
  * Makes a new two-dimensional TransformState with the specified components.
  */
@@ -569,16 +641,18 @@ compose(const TransformState *other) const {
     return do_compose(other);
   }
 
-  LightReMutexHolder holder(*_states_lock);
-
-  // Is this composition already cached?
-  int index = _composition_cache.find(other);
-  if (index != -1) {
-    const Composition &comp = _composition_cache.get_data(index);
-    if (comp._result != nullptr) {
-      // Success!
-      _cache_stats.inc_hits();
-      return comp._result;
+  {
+    // Is this composition already cached?  Looking it up only requires the
+    // lock for this particular state.
+    LightReMutexHolder holder(get_cache_lock(this));
+    int index = _composition_cache.find(other);
+    if (index != -1) {
+      const Composition &comp = _composition_cache.get_data(index);
+      if (comp._result != nullptr) {
+        // Success!
+        _cache_stats.inc_hits();
+        return comp._result;
+      }
     }
   }
 
@@ -587,8 +661,21 @@ compose(const TransformState *other) const {
   // parallelization.
   CPT(TransformState) result = do_compose(other);
 
+  // Modifying the cache requires the global lock as well as the locks for
+  // both of the states involved.
+  LightReMutexHolder holder(*_states_lock);
+  LightReMutexHolder holder1(get_cache_lock(this));
+  LightReMutexHolder holder2(get_cache_lock(other));
+
+  int index = _composition_cache.find(other);
   if (index != -1) {
     Composition &comp = _composition_cache.modify_data(index);
+    if (comp._result != nullptr) {
+      // Another thread computed it while we weren't holding the lock.
+      _cache_stats.inc_hits();
+      return comp._result;
+    }
+
     // Well, it wasn't cached already, but we already had an entry (probably
     // created for the reverse direction), so use the same entry to store
     // the new result.
@@ -676,15 +763,18 @@ invert_compose(const TransformState *other) const {
     return do_invert_compose(other);
   }
 
-  LightReMutexHolder holder(*_states_lock);
-
-  int index = _invert_composition_cache.find(other);
-  if (index != -1) {
-    const Composition &comp = _invert_composition_cache.get_data(index);
-    if (comp._result != nullptr) {
-      // Success!
-      _cache_stats.inc_hits();
-      return comp._result;
+  {
+    // Is this composition already cached?  Looking it up only requires the
+    // lock for this particular state.
+    LightReMutexHolder holder(get_cache_lock(this));
+    int index = _invert_composition_cache.find(other);
+    if (index != -1) {
+      const Composition &comp = _invert_composition_cache.get_data(index);
+      if (comp._result != nullptr) {
+        // Success!
+        _cache_stats.inc_hits();
+        return comp._result;
+      }
     }
   }
 
@@ -693,9 +783,21 @@ invert_compose(const TransformState *other) const {
   // parallelization.
   CPT(TransformState) result = do_invert_compose(other);
 
-  // Is this composition already cached?
+  // Modifying the cache requires the global lock as well as the locks for
+  // both of the states involved.
+  LightReMutexHolder holder(*_states_lock);
+  LightReMutexHolder holder1(get_cache_lock(this));
+  LightReMutexHolder holder2(get_cache_lock(other));
+
+  int index = _invert_composition_cache.find(other);
   if (index != -1) {
     Composition &comp = _invert_composition_cache.modify_data(index);
+    if (comp._result != nullptr) {
+      // Another thread computed it while we weren't holding the lock.
+      _cache_stats.inc_hits();
+      return comp._result;
+    }
+
     // Well, it wasn't cached already, but we already had an entry (probably
     // created for the reverse direction), so use the same entry to store
     // the new result.
@@ -1089,6 +1191,7 @@ clear_cache() {
     TempStates::iterator ti;
     for (ti = temp_states.begin(); ti != temp_states.end(); ++ti) {
       TransformState *state = (TransformState *)(*ti).p();
+      LightReMutexHolder cache_holder(get_cache_lock(state));
 
       size_t i;
       size_t cache_size = state->_composition_cache.get_num_entries();
@@ -1128,6 +1231,10 @@ clear_cache() {
  * garbage-collect-states is true to ensure that TransformStates get cleaned
  * up appropriately.  It does no harm to call it even if this variable is not
  * true, but there is probably no advantage in that case.
+ *
+ * Each call visits at most garbage-collect-states-budget states, resuming
+ * where the previous call left off, so that the cost may be spread over
+ * several frames.  Returns the number of states that were freed.
  */
 int TransformState::
 garbage_collect() {
@@ -1139,69 +1246,73 @@ garbage_collect() {
 
   PStatTimer timer(_garbage_collect_pcollector);
   size_t orig_size = _states.get_num_entries();
-
-  // How many elements to process this pass?
   size_t size = orig_size;
-  size_t num_this_pass = std::max(0, int(size * garbage_collect_states_rate));
-  if (num_this_pass <= 0) {
-    return 0;
+
+  // New states are always appended to the end of the table, so the states
+  // past _garbage_young_index have been created since the previous pass.
+  // Since most transient states are released soon after they are created,
+  // we make sure to visit all of those, and spend the rest of the budget on
+  // a fraction of the older states.
+  size_t old_size = std::min(_garbage_young_index, size);
+
+  size_t budget = size;
+  if (garbage_collect_states_budget > 0) {
+    budget = std::min(budget, (size_t)garbage_collect_states_budget);
   }
+  size_t num_young = std::min(size - old_size, budget);
+  size_t num_old = std::max(0, int(old_size * garbage_collect_states_rate));
+  num_old = std::min(num_old, budget - num_young);
 
   bool break_and_uniquify = (auto_break_cycles && uniquify_transforms);
 
+  // First, continue the sweep through the old generation where the previous
+  // pass left off.
   size_t si = _garbage_index;
-  if (si >= size) {
+  if (si >= old_size) {
     si = 0;
   }
-
-  num_this_pass = std::min(num_this_pass, size);
-  size_t stop_at_element = (si + num_this_pass) % size;
-
-  do {
-    TransformState *state = (TransformState *)_states.get_key(si);
-    if (break_and_uniquify) {
-      if (state->get_cache_ref_count() > 0 &&
-          state->get_ref_count() == state->get_cache_ref_count()) {
-        // If we have removed all the references to this state not in the
-        // cache, leaving only references in the cache, then we need to
-        // check for a cycle involving this TransformState and break it if
-        // it exists.
-        state->detect_and_break_cycles();
-      }
-    }
-
-    if (!state->unref_if_one()) {
-      // This state has recently been unreffed to 1 (the one we added when
-      // we stored it in the cache).  Now it's time to delete it.  This is
-      // safe, because we're holding the _states_lock, so it's not possible
-      // for some other thread to find the state in the cache and ref it
-      // while we're doing this.  Also, we've just made sure to unref it to 0,
-      // to ensure that another thread can't get it via a weak pointer.
-      state->release_new();
-      state->remove_cache_pointers();
-      state->cache_unref_only();
-      delete state;
-
+  while (num_old > 0 && old_size > 0) {
+    --num_old;
+    if (garbage_collect_element(si, break_and_uniquify)) {
       // When we removed it from the hash map, it swapped the last element
-      // with the one we just removed.  So the current index contains one we
-      // still need to visit.
+      // with the one we just removed.  If that was a young state, it has now
+      // been promoted to the old generation; otherwise the old generation
+      // has shrunk.  Either way, the current index contains one we still
+      // need to visit.
+      if (old_size == size) {
+        --old_size;
+      }
       --size;
-      --si;
-      if (stop_at_element > 0) {
-        --stop_at_element;
+      if (si >= old_size) {
+        si = 0;
       }
+    } else {
+      si = (si + 1) % old_size;
     }
-
-    si = (si + 1) % size;
-  } while (si != stop_at_element);
+  }
   _garbage_index = si;
 
+  // Now visit the young generation.  The states that survive this are
+  // promoted to the old generation.
+  si = old_size;
+  while (num_young > 0 && si < size) {
+    --num_young;
+    if (garbage_collect_element(si, break_and_uniquify)) {
+      --size;
+    } else {
+      ++si;
+    }
+  }
+  _garbage_young_index = si;
+
   nassertr(_states.get_num_entries() == size, 0);
 
 #ifdef _DEBUG
   nassertr(_states.validate(), 0);
 #endif
 
+  _reclaimed_counter.set_level((double)(orig_size - size));
+
   // If we just cleaned up a lot of states, see if we can reduce the table in
   // size.  This will help reduce iteration overhead in the future.
   _states.consider_shrink_table();
@@ -1209,6 +1320,42 @@ garbage_collect() {
   return (int)orig_size - (int)size;
 }
 
+/**
+ * Visits the nth element of the _states table as part of garbage_collect(),
+ * and deletes it if it is no longer referenced outside of the cache.  Returns
+ * true if the state was deleted, in which case the last element of the table
+ * has been moved into its place.  Assumes the lock is held.
+ */
+bool TransformState::
+garbage_collect_element(size_t n, bool break_and_uniquify) {
+  TransformState *state = (TransformState *)_states.get_key(n);
+  if (break_and_uniquify) {
+    if (state->get_cache_ref_count() > 0 &&
+        state->get_ref_count() == state->get_cache_ref_count()) {
+      // If we have removed all the references to this state not in the
+      // cache, leaving only references in the cache, then we need to check
+      // for a cycle involving this TransformState and break it if it exists.
+      state->detect_and_break_cycles();
+    }
+  }
+
+  if (state->unref_if_one()) {
+    return false;
+  }
+
+  // This state has recently been unreffed to 1 (the one we added when we
+  // stored it in the cache).  Now it's time to delete it.  This is safe,
+  // because we're holding the _states_lock, so it's not possible for some
+  // other thread to find the state in the cache and ref it while we're doing
+  // this.  Also, we've just made sure to unref it to 0, to ensure that
+  // another thread can't get it via a weak pointer.
+  state->release_new();
+  state->remove_cache_pointers();
+  state->cache_unref_only();
+  delete state;
+  return true;
+}
+
 /**
  * Detects all of the reference-count cycles in the cache and reports them to
  * standard output.
@@ -1388,6 +1535,7 @@ init_states() {
   // OK because we guarantee that this method is called at static init time,
   // presumably when there is still only one thread in the world.
   _states_lock = new LightReMutex("TransformState::_states_lock");
+  _cache_locks = new LightReMutex[num_cache_locks];
   _cache_stats.init();
   nassertv(Thread::get_current_thread() == Thread::get_main_thread());
 
@@ -1443,6 +1591,31 @@ return_new(TransformState *state) {
   return return_unique(state);
 }
 
+/**
+ * Applies return_new() to each of the newly-created states in the array, in
+ * place, holding the lock only once for all of them.
+ */
+void TransformState::
+return_new_array(CPT(TransformState) *states, size_t num_states) {
+  if (!uniquify_transforms || !transform_cache) {
+    return;
+  }
+
+#ifndef NDEBUG
+  if (paranoid_const) {
+    nassertv(validate_states());
+  }
+#endif
+
+  PStatTimer timer(_transform_new_pcollector);
+
+  LightReMutexHolder holder(*_states_lock);
+  for (size_t i = 0; i < num_states; ++i) {
+    // The identity and invalid states are already unique.
+    states[i] = do_return_unique((TransformState *)states[i].p());
+  }
+}
+
 /**
  * This function is used to share a common TransformState pointer for all
  * equivalent TransformState objects.
@@ -1469,7 +1642,14 @@ return_unique(TransformState *state) {
   PStatTimer timer(_transform_new_pcollector);
 
   LightReMutexHolder holder(*_states_lock);
+  return do_return_unique(state);
+}
 
+/**
+ * The implementation of return_unique(), assuming the lock is already held.
+ */
+CPT(TransformState) TransformState::
+do_return_unique(TransformState *state) {
   if (state->_saved_entry != -1) {
     // This state is already in the cache.  nassertr(_states.find(state) ==
     // state->_saved_entry, state);
@@ -1938,32 +2118,43 @@ remove_cache_pointers() {
     // Now we can remove the element from our cache.  We do this now, rather
     // than later, before any other TransformState objects have had a chance
     // to destruct, so we are confident that our iterator is still valid.
-    _composition_cache.remove_element(i);
-    _cache_stats.add_total_size(-1);
-    _cache_stats.inc_dels();
-
-    if (other != this) {
-      int oi = other->_composition_cache.find(this);
-
-      // We may or may not still be listed in the other's cache (it might be
-      // halfway through pulling entries out, from within its own destructor).
-      if (oi != -1) {
-        // Hold a copy of the other composition result, too.
-        Composition ocomp = other->_composition_cache.get_data(oi);
-
-        other->_composition_cache.remove_element(oi);
-        _cache_stats.add_total_size(-1);
-        _cache_stats.inc_dels();
-
-        // It's finally safe to let our held pointers go away.  This may have
-        // cascading effects as other TransformState objects are destructed,
-        // but there will be no harm done if they destruct now.
-        if (ocomp._result != nullptr && ocomp._result != other) {
-          cache_unref_delete(ocomp._result);
+
+    // Modifying the caches also requires holding the locks for both states,
+    // but we mustn't hold them while other objects are destructed.
+    Composition ocomp;
+    ocomp._result = nullptr;
+    {
+      LightReMutexHolder holder1(get_cache_lock(this));
+      LightReMutexHolder holder2(get_cache_lock(other));
+
+      _composition_cache.remove_element(i);
+      _cache_stats.add_total_size(-1);
+      _cache_stats.inc_dels();
+
+      if (other != this) {
+        int oi = other->_composition_cache.find(this);
+
+        // We may or may not still be listed in the other's cache (it might
+        // be halfway through pulling entries out, from within its own
+        // destructor).
+        if (oi != -1) {
+          // Hold a copy of the other composition result, too.
+          ocomp = other->_composition_cache.get_data(oi);
+
+          other->_composition_cache.remove_element(oi);
+          _cache_stats.add_total_size(-1);
+          _cache_stats.inc_dels();
         }
       }
     }
 
+    // It's finally safe to let our held pointers go away.  This may have
+    // cascading effects as other TransformState objects are destructed,
+    // but there will be no harm done if they destruct now.
+    if (ocomp._result != nullptr && ocomp._result != other) {
+      cache_unref_delete(ocomp._result);
+    }
+
     // It's finally safe to let our held pointers go away.  (See comment
     // above.)
     if (comp._result != nullptr && comp._result != this) {
@@ -1977,21 +2168,27 @@ remove_cache_pointers() {
     TransformState *other = (TransformState *)_invert_composition_cache.get_key(i);
     nassertv(other != this);
     Composition comp = _invert_composition_cache.get_data(i);
-    _invert_composition_cache.remove_element(i);
-    _cache_stats.add_total_size(-1);
-    _cache_stats.inc_dels();
-    if (other != this) {
-      int oi = other->_invert_composition_cache.find(this);
-      if (oi != -1) {
-        Composition ocomp = other->_invert_composition_cache.get_data(oi);
-        other->_invert_composition_cache.remove_element(oi);
-        _cache_stats.add_total_size(-1);
-        _cache_stats.inc_dels();
-        if (ocomp._result != nullptr && ocomp._result != other) {
-          cache_unref_delete(ocomp._result);
+    Composition ocomp;
+    ocomp._result = nullptr;
+    {
+      LightReMutexHolder holder1(get_cache_lock(this));
+      LightReMutexHolder holder2(get_cache_lock(other));
+      _invert_composition_cache.remove_element(i);
+      _cache_stats.add_total_size(-1);
+      _cache_stats.inc_dels();
+      if (other != this) {
+        int oi = other->_invert_composition_cache.find(this);
+        if (oi != -1) {
+          ocomp = other->_invert_composition_cache.get_data(oi);
+          other->_invert_composition_cache.remove_element(oi);
+          _cache_stats.add_total_size(-1);
+          _cache_stats.inc_dels();
         }
       }
     }
+    if (ocomp._result != nullptr && ocomp._result != other) {
+      cache_unref_delete(ocomp._result);
+    }
     if (comp._result != nullptr && comp._result != this) {
       cache_unref_delete(comp._result);
     }
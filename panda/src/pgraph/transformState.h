@@ -114,6 +114,17 @@ PUBLISHED:
                                                            PN_stdfloat shear);
   static CPT(TransformState) make_mat3(const LMatrix3 &mat);
 
+public:
+  static void make_mat_array(CPT(TransformState) *result,
+                             const UnalignedLMatrix4 *mats,
+                             size_t num_states);
+  static void make_pos_hpr_scale_array(CPT(TransformState) *result,
+                                       const LVecBase3 *pos,
+                                       const LVecBase3 *hpr,
+                                       const LVecBase3 *scale,
+                                       size_t num_states);
+
+PUBLISHED:
 
   INLINE bool is_identity() const;
   INLINE bool is_invalid() const;
@@ -239,6 +250,8 @@ private:
 
   static CPT(TransformState) return_new(TransformState *state);
   static CPT(TransformState) return_unique(TransformState *state);
+  static CPT(TransformState) do_return_unique(TransformState *state);
+  static void return_new_array(CPT(TransformState) *states, size_t num_states);
 
   CPT(TransformState) do_compose(const TransformState *other) const;
   CPT(TransformState) do_invert_compose(const TransformState *other) const;
@@ -254,12 +267,23 @@ private:
 
   void release_new();
   void remove_cache_pointers();
+  static bool garbage_collect_element(size_t n, bool break_and_uniquify);
+
+  INLINE static LightReMutex &get_cache_lock(const TransformState *state);
 
 private:
   // This mutex protects _states.  It also protects any modification to the
   // cache, which is encoded in _composition_cache and
   // _invert_composition_cache.
   static LightReMutex *_states_lock;
+
+  // These mutexes are striped over the TransformState objects by address.
+  // Modifying the composition cache of a TransformState requires holding
+  // _states_lock as well as the stripe for that TransformState, but a lookup
+  // in the composition cache only requires the stripe.  This keeps the
+  // common case of a cache hit in compose() from contending on _states_lock.
+  enum { num_cache_locks = 64 };
+  static LightReMutex *_cache_locks;
   typedef SimpleHashMap<const TransformState *, std::nullptr_t, indirect_equals_hash<const TransformState *> > States;
   static States _states;
   static CPT(TransformState) _identity_state;
@@ -299,6 +323,10 @@ private:
   // cycle.
   static size_t _garbage_index;
 
+  // The states in _states at or past this index were added since the last
+  // garbage collection pass.
+  static size_t _garbage_young_index;
+
   static bool _uniquify_matrix;
 
   static PStatCollector _cache_update_pcollector;
@@ -313,6 +341,7 @@ private:
 
   static PStatCollector _node_counter;
   static PStatCollector _cache_counter;
+  static PStatCollector _reclaimed_counter;
 
 private:
   // This is the actual data within the TransformState.
@@ -32,6 +32,7 @@
 #include "shaderGenerator.h"
 #include "sphereLight.h"
 #include "spotlight.h"
+#include "staticCullNode.h"
 #include "switchNode.h"
 #include "uvScrollNode.h"
 
@@ -132,6 +133,7 @@ init_libpgraphnodes() {
   ShaderGenerator::init_type();
   SphereLight::init_type();
   Spotlight::init_type();
+  StaticCullNode::init_type();
   SwitchNode::init_type();
   UvScrollNode::init_type();
 
@@ -148,6 +150,7 @@ init_libpgraphnodes() {
   SequenceNode::register_with_read_factory();
   SphereLight::register_with_read_factory();
   Spotlight::register_with_read_factory();
+  StaticCullNode::register_with_read_factory();
   SwitchNode::register_with_read_factory();
   UvScrollNode::register_with_read_factory();
 }
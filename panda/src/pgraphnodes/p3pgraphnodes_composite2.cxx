@@ -7,5 +7,6 @@
 #include "shaderGenerator.cxx"
 #include "sphereLight.cxx"
 #include "spotlight.cxx"
+#include "staticCullNode.cxx"
 #include "switchNode.cxx"
 #include "uvScrollNode.cxx"
@@ -0,0 +1,366 @@
+/**
+ * PANDA 3D SOFTWARE
+ * Copyright (c) Carnegie Mellon University.  All rights reserved.
+ *
+ * All use of this software is subject to the terms of the revised BSD
+ * license.  You should have received a copy of this license along
+ * with this source code in a file named "LICENSE."
+ *
+ * @file staticCullNode.cxx
+ * @author djs3000
+ * @date 2026-10-16
+ */
+
+#include "staticCullNode.h"
+#include "cullTraverser.h"
+#include "cullTraverserData.h"
+#include "cullableObject.h"
+#include "cullHandler.h"
+#include "geomNode.h"
+#include "occlusionBuffer.h"
+#include "lightMutexHolder.h"
+#include "bamReader.h"
+#include "datagramIterator.h"
+
+TypeHandle StaticCullNode::_type_handle;
+
+/**
+ *
+ */
+StaticCullNode::
+StaticCullNode(const std::string &name) :
+  PandaNode(name)
+{
+  PandaNode::set_cull_callback();
+}
+
+/**
+ * The cache is not copied; the new node will build its own the first time it
+ * is rendered.
+ */
+StaticCullNode::
+StaticCullNode(const StaticCullNode &copy) :
+  PandaNode(copy)
+{
+}
+
+/**
+ * Discards the cached cull results, forcing them to be recomputed the next
+ * time the node is rendered.  This is normally done automatically, but it is
+ * necessary if the vertices of one of the Geoms below this node are modified
+ * in place.
+ */
+void StaticCullNode::
+clear_cache() {
+  LightMutexHolder holder(_lock);
+  _cache.clear();
+}
+
+/**
+ * Returns true if the node currently has cached cull results that are still
+ * up-to-date with the subgraph below it and will be used the next time it is
+ * rendered, or false if the cache will need to be rebuilt first, or if the
+ * subgraph cannot be cached at all.
+ */
+bool StaticCullNode::
+is_cache_valid(Thread *current_thread) const {
+  UpdateSeq seq;
+  get_bounds(seq, current_thread);
+
+  LightMutexHolder holder(_lock);
+  return _cache != nullptr && _cache->_bounds_seq == seq && _cache->_cacheable;
+}
+
+/**
+ * Builds the cache now if it is not already up-to-date, rather than waiting
+ * for the next time the node is rendered.  This may be used to avoid a hitch
+ * on the first frame.  Returns true if the subgraph could be cached, or false
+ * if it will be traversed normally.
+ */
+bool StaticCullNode::
+update_cache(Thread *current_thread) {
+  PT(Cache) cache = get_cache(current_thread);
+  return cache->_cacheable;
+}
+
+/**
+ * Returns the number of Geoms stored in the cache, or 0 if the cache has not
+ * yet been built.
+ */
+size_t StaticCullNode::
+get_num_cached_geoms() const {
+  LightMutexHolder holder(_lock);
+  return (_cache != nullptr) ? _cache->_geoms.size() : 0;
+}
+
+/**
+ * Returns a newly-allocated Node that is a shallow copy of this one.  It will
+ * be a different Node pointer, but its internal data may or may not be shared
+ * with that of the original Node.
+ */
+PandaNode *StaticCullNode::
+make_copy() const {
+  return new StaticCullNode(*this);
+}
+
+/**
+ * Returns true if it is generally safe to combine this particular kind of
+ * PandaNode with other kinds of PandaNodes of compatible type, adding
+ * children or whatever.  For instance, an LODNode should not be combined with
+ * any other PandaNode, because its set of children is meaningful.
+ */
+bool StaticCullNode::
+safe_to_combine() const {
+  return false;
+}
+
+/**
+ * This function will be called during the cull traversal to perform any
+ * additional operations that should be performed at cull time.  This may
+ * include additional manipulation of render state or additional
+ * visible/invisible decisions, or any other arbitrary operation.
+ *
+ * Note that this function will *not* be called unless set_cull_callback() is
+ * called in the constructor of the derived class.  It is necessary to call
+ * set_cull_callback() to indicated that we require cull_callback() to be
+ * called.
+ *
+ * By the time this function is called, the node has already passed the
+ * bounding-volume test for the viewing frustum, and the node's transform and
+ * state have already been applied to the indicated CullTraverserData object.
+ *
+ * The return value is true if this node should be visible, or false if it
+ * should be culled.
+ */
+bool StaticCullNode::
+cull_callback(CullTraverser *trav, CullTraverserData &data) {
+  if (data._cull_planes != nullptr || data._instances != nullptr) {
+    // These would have to be applied to each of the Geoms individually; it
+    // is easier to let the normal traversal deal with them.
+    return true;
+  }
+
+  Thread *current_thread = trav->get_current_thread();
+  PT(Cache) cache = get_cache(current_thread);
+  if (!cache->_cacheable) {
+    return true;
+  }
+  if (trav->has_tag_state_key() &&
+      cache->_tag_keys.count(trav->get_tag_state_key()) != 0) {
+    // The camera would apply a different state to part of the subgraph.
+    return true;
+  }
+
+  size_t num_geoms = cache->_geoms.size();
+  trav->_geoms_pcollector.add_level(num_geoms);
+
+  // The results go into a local array rather than into the batch itself, so
+  // that several cull threads may share the same cache.
+  pvector<int> results;
+  if (data._view_frustum != nullptr) {
+    results.resize(num_geoms);
+    cache->_batch.compute_contains(data._view_frustum, results.data());
+  }
+
+  OcclusionBuffer *occlusion_buffer = trav->get_occlusion_buffer();
+  LMatrix4 net_mat;
+  if (occlusion_buffer != nullptr) {
+    net_mat = data.get_net_transform(trav)->get_mat();
+  }
+
+  CPT(TransformState) internal_transform = data.get_internal_transform(trav);
+  CullHandler *handler = trav->get_cull_handler();
+
+  for (size_t i = 0; i < num_geoms; ++i) {
+    if (!results.empty() && results[i] == BoundingVolume::IF_no_intersection) {
+      continue;
+    }
+    const CachedGeom &cached = cache->_geoms[i];
+    if (occlusion_buffer != nullptr &&
+        occlusion_buffer->is_occluded(cached._bounds, net_mat)) {
+      continue;
+    }
+
+    CPT(RenderState) state = data._state->compose(cached._state);
+    if (state->has_cull_callback() && !state->cull_callback(trav, data)) {
+      // Note that the attribs see the data for this node rather than for the
+      // original GeomNode, so that a streamed texture is sized according to
+      // the bounds of the whole subgraph, which is an overestimate.
+      continue;
+    }
+
+    CullableObject *object =
+      new CullableObject(cached._geom, std::move(state),
+                         internal_transform->compose(cached._transform));
+    handler->record_object(object, trav);
+  }
+
+  // We have already taken care of everything below this node.
+  return false;
+}
+
+/**
+ *
+ */
+void StaticCullNode::
+output(std::ostream &out) const {
+  PandaNode::output(out);
+  LightMutexHolder holder(_lock);
+  if (_cache != nullptr) {
+    if (_cache->_cacheable) {
+      out << " (" << _cache->_geoms.size() << " cached geoms)";
+    } else {
+      out << " (not cacheable)";
+    }
+  }
+}
+
+/**
+ * Returns the cache, rebuilding it first if anything below this node has
+ * changed since it was last built.
+ */
+PT(StaticCullNode::Cache) StaticCullNode::
+get_cache(Thread *current_thread) {
+  // The bounds sequence is bumped whenever the transform, state, effects,
+  // tags, bounds, Geoms or children of any node below us change.
+  UpdateSeq seq;
+  get_bounds(seq, current_thread);
+
+  LightMutexHolder holder(_lock);
+  if (_cache == nullptr || _cache->_bounds_seq != seq) {
+    _cache = build_cache(seq, current_thread);
+  }
+  return _cache;
+}
+
+/**
+ * Walks the subgraph below this node and returns a new cache describing all
+ * of the Geoms in it.
+ */
+PT(StaticCullNode::Cache) StaticCullNode::
+build_cache(UpdateSeq bounds_seq, Thread *current_thread) const {
+  PT(Cache) cache = new Cache(bounds_seq);
+
+  CPT(TransformState) transform = TransformState::make_identity();
+  CPT(RenderState) state = RenderState::make_empty();
+
+  Children children = get_children(current_thread);
+  size_t num_children = children.get_num_children();
+  for (size_t i = 0; i < num_children && cache->_cacheable; ++i) {
+    r_collect(cache, children.get_child(i), transform, state, current_thread);
+  }
+
+  if (!cache->_cacheable) {
+    cache->_geoms.clear();
+    return cache;
+  }
+
+  cache->_batch.reserve(cache->_geoms.size());
+  for (CachedGeom &cached : cache->_geoms) {
+    PT(BoundingVolume) bounds = cached._geom->get_bounds(current_thread)->make_copy();
+    GeometricBoundingVolume *gbv = bounds->as_geometric_bounding_volume();
+    nassertd(gbv != nullptr) {
+      cache->_cacheable = false;
+      cache->_geoms.clear();
+      return cache;
+    }
+    if (!cached._transform->is_identity()) {
+      gbv->xform(cached._transform->get_mat());
+    }
+    cached._bounds = gbv;
+    cache->_batch.add_volume(gbv);
+  }
+
+  return cache;
+}
+
+/**
+ * The recursive implementation of build_cache().  Clears _cacheable if it
+ * encounters anything that would need to be evaluated at cull time.
+ */
+void StaticCullNode::
+r_collect(Cache *cache, PandaNode *node, const TransformState *transform,
+          const RenderState *state, Thread *current_thread) {
+  int fancy_bits = node->get_fancy_bits(current_thread);
+
+  static const int uncacheable_bits =
+    PandaNode::FB_effects | PandaNode::FB_draw_mask |
+    PandaNode::FB_cull_callback | PandaNode::FB_decal |
+    PandaNode::FB_show_bounds | PandaNode::FB_show_tight_bounds;
+
+  if ((fancy_bits & uncacheable_bits) != 0 &&
+      !node->is_of_type(StaticCullNode::get_class_type())) {
+    cache->_cacheable = false;
+    return;
+  }
+  if ((fancy_bits & PandaNode::FB_renderable) != 0 && !node->is_geom_node()) {
+    // Some other kind of renderable node, which does its own thing in
+    // add_for_draw().
+    cache->_cacheable = false;
+    return;
+  }
+
+  CPT(TransformState) next_transform = transform->compose(node->get_transform(current_thread));
+  if (next_transform->is_invalid()) {
+    // The normal traversal would not render this subgraph either.
+    return;
+  }
+  CPT(RenderState) next_state = state->compose(node->get_state(current_thread));
+
+  if (fancy_bits & PandaNode::FB_tag) {
+    vector_string keys;
+    node->get_tag_keys(keys);
+    cache->_tag_keys.insert(keys.begin(), keys.end());
+  }
+
+  if (node->is_geom_node()) {
+    GeomNode *gnode = (GeomNode *)node;
+    GeomNode::Geoms geoms = gnode->get_geoms(current_thread);
+    int num_geoms = geoms.get_num_geoms();
+    for (int i = 0; i < num_geoms; ++i) {
+      CPT(Geom) geom = geoms.get_geom(i);
+      if (geom->is_empty()) {
+        continue;
+      }
+      CPT(RenderState) geom_state = next_state->compose(geoms.get_geom_state(i));
+
+      CachedGeom cached;
+      cached._geom = std::move(geom);
+      cached._state = std::move(geom_state);
+      cached._transform = next_transform;
+      cache->_geoms.push_back(std::move(cached));
+    }
+  }
+
+  Children children = node->get_children(current_thread);
+  size_t num_children = children.get_num_children();
+  for (size_t i = 0; i < num_children && cache->_cacheable; ++i) {
+    r_collect(cache, children.get_child(i), next_transform, next_state,
+              current_thread);
+  }
+}
+
+/**
+ * Tells the BamReader how to create objects of type StaticCullNode.
+ */
+void StaticCullNode::
+register_with_read_factory() {
+  BamReader::get_factory()->register_factory(get_class_type(), make_from_bam);
+}
+
+/**
+ * This function is called by the BamReader's factory when a new object of
+ * type StaticCullNode is encountered in the Bam file.  It should create the
+ * StaticCullNode and extract its information from the file.
+ */
+TypedWritable *StaticCullNode::
+make_from_bam(const FactoryParams &params) {
+  StaticCullNode *node = new StaticCullNode("");
+  DatagramIterator scan;
+  BamReader *manager;
+
+  parse_params(params, scan, manager);
+  node->fillin(scan, manager);
+
+  return node;
+}
@@ -0,0 +1,125 @@
+/**
+ * PANDA 3D SOFTWARE
+ * Copyright (c) Carnegie Mellon University.  All rights reserved.
+ *
+ * All use of this software is subject to the terms of the revised BSD
+ * license.  You should have received a copy of this license along
+ * with this source code in a file named "LICENSE."
+ *
+ * @file staticCullNode.h
+ * @author djs3000
+ * @date 2026-10-16
+ */
+
+#ifndef STATICCULLNODE_H
+#define STATICCULLNODE_H
+
+#include "pandabase.h"
+#include "pandaNode.h"
+#include "geom.h"
+#include "renderState.h"
+#include "transformState.h"
+#include "geometricBoundingVolume.h"
+#include "boundingVolumeBatch.h"
+#include "updateSeq.h"
+#include "lightMutex.h"
+#include "pointerTo.h"
+#include "pvector.h"
+#include "pset.h"
+
+/**
+ * A node that remembers the result of culling the subgraph below it, so that
+ * the cull traversal does not have to walk over it again every frame.
+ *
+ * The first time the node is visited, the Geoms below it are collected, along
+ * with their net state and transform relative to this node.  On subsequent
+ * frames, those Geoms are tested against the view frustum all at once and
+ * handed directly to the CullHandler.  The cache is rebuilt automatically
+ * whenever a transform, state, effect, tag, bounding volume or child anywhere
+ * below this node changes.
+ *
+ * This is only worthwhile for subgraphs that rarely change, such as static
+ * level geometry.  If the subgraph contains a node that needs to be evaluated
+ * at cull time, such as an LODNode, a billboard or a hidden node, the node
+ * quietly falls back to a normal traversal.  Render states with a cull
+ * callback, such as those with a streamed texture, are still cached; their
+ * callbacks are called with the data for this node.
+ */
+class EXPCL_PANDA_PGRAPHNODES StaticCullNode : public PandaNode {
+PUBLISHED:
+  explicit StaticCullNode(const std::string &name);
+
+  void clear_cache();
+  bool is_cache_valid(Thread *current_thread = Thread::get_current_thread()) const;
+  bool update_cache(Thread *current_thread = Thread::get_current_thread());
+  size_t get_num_cached_geoms() const;
+
+public:
+  StaticCullNode(const StaticCullNode &copy);
+
+  virtual PandaNode *make_copy() const;
+  virtual bool safe_to_combine() const;
+
+  virtual bool cull_callback(CullTraverser *trav, CullTraverserData &data);
+
+  virtual void output(std::ostream &out) const;
+
+private:
+  class CachedGeom {
+  public:
+    CPT(Geom) _geom;
+    CPT(RenderState) _state;
+    CPT(TransformState) _transform;
+    CPT(GeometricBoundingVolume) _bounds;
+  };
+  typedef pvector<CachedGeom> CachedGeoms;
+
+  class Cache : public ReferenceCount {
+  public:
+    INLINE Cache(UpdateSeq bounds_seq);
+
+    UpdateSeq _bounds_seq;
+    bool _cacheable;
+    CachedGeoms _geoms;
+    BoundingVolumeBatch _batch;
+    pset<std::string> _tag_keys;
+  };
+
+  PT(Cache) get_cache(Thread *current_thread);
+  PT(Cache) build_cache(UpdateSeq bounds_seq, Thread *current_thread) const;
+  static void r_collect(Cache *cache, PandaNode *node,
+                        const TransformState *transform,
+                        const RenderState *state, Thread *current_thread);
+
+  // The cache is derived entirely from the scene graph, so it is not
+  // pipelined; it is shared by all the cull threads instead.
+  mutable LightMutex _lock;
+  PT(Cache) _cache;
+
+public:
+  static void register_with_read_factory();
+
+protected:
+  static TypedWritable *make_from_bam(const FactoryParams &params);
+
+public:
+  static TypeHandle get_class_type() {
+    return _type_handle;
+  }
+  static void init_type() {
+    PandaNode::init_type();
+    register_type(_type_handle, "StaticCullNode",
+                  PandaNode::get_class_type());
+  }
+  virtual TypeHandle get_type() const {
+    return get_class_type();
+  }
+  virtual TypeHandle force_init_type() {init_type(); return get_class_type();}
+
+private:
+  static TypeHandle _type_handle;
+};
+
+#include "staticCullNode.I"
+
+#endif
@@ -21,6 +21,8 @@
 #include "config_chan.h"
 #include "pandaNode.h"
 #include "geomNode.h"
+#include "sceneGraphReducer.h"
+#include "lodGenerator.h"
 #include "renderState.h"
 #include "textureAttrib.h"
 #include "dcast.h"
@@ -82,6 +84,58 @@ EggToBam() :
      "default is nonzero, to remove it.",
      &EggToBam::dispatch_int, nullptr, &_egg_suppress_hidden);
 
+  add_option
+    ("lod", "levels", 0,
+     "Generates the indicated number of levels of detail from the model, "
+     "by simplifying its triangles, and places them under an LODNode at the "
+     "top of the model.  Each level has half as many triangles as the "
+     "previous one, and the switch distances are chosen so that the error "
+     "introduced by the simplification is no more than about a pixel on "
+     "the screen.",
+     &EggToBam::dispatch_int, &_has_lod_levels, &_lod_levels);
+
+  add_option
+    ("optimize", "", 0,
+     "Reorders the triangles and vertices of the geometry after it has been "
+     "loaded (and flattened, if requested), for better use of the vertex "
+     "cache on the graphics card and to reduce overdraw.  The average cache "
+     "miss ratio (ACMR) before and after is reported.",
+     &EggToBam::dispatch_none, &_optimize_vertices);
+
+  add_option
+    ("meshlets", "triangles", 0,
+     "Splits each Geom with more than the indicated number of triangles "
+     "into spatially coherent clusters of at most that many triangles, "
+     "stored in a MeshletNode, so that each cluster can be culled "
+     "separately, by the view frustum and by the direction it faces.  "
+     "A value between 64 and 256 is typical.",
+     &EggToBam::dispatch_int, &_has_meshlet_triangles, &_meshlet_triangles);
+
+  add_option
+    ("cmesh", "polygons", 0,
+     "Converts each <Collide> group of type polyset with at least the "
+     "indicated number of polygons into a single CollisionMesh, which "
+     "organizes the triangles in a bounding volume hierarchy so that it "
+     "is much faster to collide with than the equivalent number of "
+     "CollisionPolygons.  The hierarchy is stored in the bam file.  The "
+     "default if this is not specified is taken from the "
+     "egg-collision-mesh-threshold Config.prc variable.",
+     &EggToBam::dispatch_int, &_has_collision_mesh_threshold,
+     &_collision_mesh_threshold);
+
+  add_option
+    ("compact", "", 0,
+     "Stores the vertices in a more compact form: normals are packed into "
+     "32 bits, and texture coordinates are stored as half-precision floats.",
+     &EggToBam::dispatch_none, &_compact_vertices);
+
+  add_option
+    ("quantize", "", 0,
+     "Quantizes the vertex positions of each unanimated GeomNode to 16-bit "
+     "integers, and puts a transform on the node to scale them back.  This "
+     "changes the transforms in the scene graph, so it is off by default.",
+     &EggToBam::dispatch_none, &_quantize_positions);
+
   add_option
     ("ls", "", 0,
      "Writes a scene graph listing to standard output after the egg "
@@ -229,6 +283,11 @@ run() {
     egg_combine_geoms = (_egg_combine_geoms != 0);
   }
 
+  if (_has_collision_mesh_threshold) {
+    // Ditto with -cmesh.
+    egg_collision_mesh_threshold = _collision_mesh_threshold;
+  }
+
   // We always set egg_suppress_hidden.
   egg_suppress_hidden = _egg_suppress_hidden;
 
@@ -262,6 +321,51 @@ run() {
     exit(1);
   }
 
+  if (_has_lod_levels && _lod_levels > 1) {
+    // Move the model under a new node, so that the LODNode can be placed
+    // below the ModelRoot.
+    PT(PandaNode) model = new PandaNode(root->get_name());
+    model->steal_children(root);
+
+    LODGenerator generator;
+    generator.set_num_levels(_lod_levels);
+    NodePath lod = generator.generate(NodePath(model));
+    root->add_child(lod.node());
+
+    for (int i = 1; i < _lod_levels; ++i) {
+      nout << "Level " << i << " of detail has an error of "
+           << generator.get_level_error(i) << ".\n";
+    }
+  }
+
+  if (_optimize_vertices) {
+    SceneGraphReducer gr;
+    PN_stdfloat acmr_before = gr.calc_acmr(root);
+    gr.optimize_vertices(root);
+    PN_stdfloat acmr_after = gr.calc_acmr(root);
+    nout << "Vertex cache ACMR: " << acmr_before << " before, "
+         << acmr_after << " after optimization.\n";
+  }
+
+  if (_has_meshlet_triangles && _meshlet_triangles > 0) {
+    SceneGraphReducer gr;
+    int num_nodes = gr.make_meshlets(root, _meshlet_triangles);
+    nout << "Split " << num_nodes << " GeomNodes into meshlets.\n";
+  }
+
+  if (_compact_vertices || _quantize_positions) {
+    int compact_bits = 0;
+    if (_compact_vertices) {
+      compact_bits |= SceneGraphReducer::CV_attributes;
+    }
+    if (_quantize_positions) {
+      compact_bits |= SceneGraphReducer::CV_positions;
+    }
+    SceneGraphReducer gr;
+    int num_vdatas = gr.compact_vertices(root, compact_bits);
+    nout << "Compacted " << num_vdatas << " vertex tables.\n";
+  }
+
   if (_tex_ctex) {
 #ifndef HAVE_SQUISH
     if (!make_buffer()) {
@@ -56,6 +56,15 @@ private:
   int _egg_combine_geoms;
   bool _egg_suppress_hidden;
   bool _ls;
+  bool _optimize_vertices;
+  bool _has_lod_levels;
+  int _lod_levels;
+  bool _has_meshlet_triangles;
+  int _meshlet_triangles;
+  bool _has_collision_mesh_threshold;
+  int _collision_mesh_threshold;
+  bool _compact_vertices;
+  bool _quantize_positions;
   bool _has_compression_quality;
   int _compression_quality;
   bool _compression_off;
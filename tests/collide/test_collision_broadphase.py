@@ -0,0 +1,178 @@
+from panda3d import core
+
+
+def make_world():
+    root = core.NodePath("root")
+
+    # A grid of static spheres, some of them grouped under a moving parent.
+    group = root.attach_new_node("group")
+    for x in range(10):
+        for y in range(10):
+            parent = group if x < 3 else root
+            cnode = core.CollisionNode("into-%d-%d" % (x, y))
+            cnode.add_solid(core.CollisionSphere(0, 0, 0, 0.6))
+            cnode.set_from_collide_mask(0)
+            np = parent.attach_new_node(cnode)
+            np.set_pos(x * 2, y * 2, 0)
+
+    # Some visible geometry that may be collided with.
+    maker = core.CardMaker("card")
+    maker.set_frame(-1, 1, -1, 1)
+    card = root.attach_new_node(maker.generate())
+    card.set_pos(5, 5, 0)
+    card.set_p(-90)
+    card.node().set_into_collide_mask(core.GeomNode.get_default_collide_mask())
+
+    return root, group
+
+
+def add_colliders(root, trav, handler, count):
+    colliders = []
+    for i in range(count):
+        cnode = core.CollisionNode("from-%d" % (i))
+        cnode.add_solid(core.CollisionSphere(0, 0, 0, 0.5))
+        cnode.set_from_collide_mask(core.CollisionNode.get_default_collide_mask() |
+                                    core.GeomNode.get_default_collide_mask())
+        cnode.set_into_collide_mask(0)
+        np = root.attach_new_node(cnode)
+        np.set_pos((i * 7) % 20, (i * 3) % 20, (i % 3) * 0.25)
+        trav.add_collider(np, handler)
+        colliders.append(np)
+    return colliders
+
+
+def collect(trav, handler, root):
+    trav.traverse(root)
+    return [(entry.get_from_node_path().name, entry.get_into_node_path().name,
+             tuple(round(v, 4) for v in entry.get_surface_point(root)))
+            for entry in handler.entries]
+
+
+def test_broadphase_matches_passes():
+    root, group = make_world()
+    handler = core.CollisionHandlerQueue()
+    trav = core.CollisionTraverser()
+    colliders = add_colliders(root, trav, handler, 100)
+
+    for frame in range(3):
+        group.set_pos(frame * 0.3, frame * 0.5, 0)
+        for i, np in enumerate(colliders):
+            np.set_z(np.get_z() + (i % 5 - 2) * 0.1)
+
+        trav.broadphase = False
+        expected = collect(trav, handler, root)
+        trav.broadphase = True
+        result = collect(trav, handler, root)
+
+        assert len(expected) > 0
+        assert sorted(result) == sorted(expected)
+
+
+def test_broadphase_order():
+    # With few enough colliders for a single pass, the entries even come in
+    # the same order.
+    root, group = make_world()
+    handler = core.CollisionHandlerQueue()
+    trav = core.CollisionTraverser()
+    add_colliders(root, trav, handler, 20)
+
+    trav.broadphase = False
+    expected = collect(trav, handler, root)
+    trav.broadphase = True
+    result = collect(trav, handler, root)
+    assert len(expected) > 0
+    assert result == expected
+
+
+def test_broadphase_moving():
+    root = core.NodePath("root")
+    handler = core.CollisionHandlerQueue()
+    trav = core.CollisionTraverser()
+    trav.broadphase = True
+
+    into = core.CollisionNode("into")
+    into.add_solid(core.CollisionBox((0, 0, 0), 1, 1, 1))
+    into_np = root.attach_new_node(into)
+
+    from_node = core.CollisionNode("from")
+    from_node.add_solid(core.CollisionSphere(0, 0, 0, 0.5))
+    from_np = root.attach_new_node(from_node)
+    from_np.set_pos(0, 0, 1.25)
+    trav.add_collider(from_np, handler)
+
+    trav.traverse(root)
+    assert handler.get_num_entries() == 1
+
+    # Move the box away; the tree must notice.
+    into_np.set_pos(100, 0, 0)
+    trav.traverse(root)
+    assert handler.get_num_entries() == 0
+
+    # And back again, by moving its parent this time.
+    into_np.wrt_reparent_to(root.attach_new_node("parent"))
+    into_np.get_parent().set_pos(-100, 0, 0)
+    trav.traverse(root)
+    assert handler.get_num_entries() == 1
+
+    # Removed nodes disappear from the tree.
+    into_np.remove_node()
+    trav.traverse(root)
+    assert handler.get_num_entries() == 0
+
+
+def test_broadphase_ray():
+    root, group = make_world()
+    handler = core.CollisionHandlerQueue()
+    trav = core.CollisionTraverser()
+
+    ray = core.CollisionNode("ray")
+    ray.add_solid(core.CollisionRay((-5, 4, 0), (1, 0, 0)))
+    ray.set_into_collide_mask(0)
+    trav.add_collider(root.attach_new_node(ray), handler)
+
+    trav.broadphase = False
+    expected = collect(trav, handler, root)
+    trav.broadphase = True
+    result = collect(trav, handler, root)
+    assert len(expected) >= 10
+    assert result == expected
+
+
+def test_broadphase_switch_and_lod():
+    root = core.NodePath("root")
+    switch = core.SwitchNode("switch")
+    switch_np = root.attach_new_node(switch)
+    lod_np = root.attach_new_node(core.LODNode("lod"))
+    lod_np.node().add_switch(10, 0)
+    lod_np.node().add_switch(100, 10)
+
+    maker = core.CardMaker("card")
+    maker.set_frame(-1, 1, -1, 1)
+    for i in range(2):
+        cnode = core.CollisionNode("switch-%d" % (i))
+        cnode.add_solid(core.CollisionSphere(0, 0, 0, 1))
+        switch_np.attach_new_node(cnode)
+
+        # The GeomNode default mask is only removed below each level.
+        level_np = lod_np.attach_new_node("level-%d" % (i))
+        card = level_np.attach_new_node(maker.generate())
+        card.set_name("lod-%d" % (i))
+        card.set_p(-90)
+        card.node().set_into_collide_mask(core.GeomNode.get_default_collide_mask())
+    switch.set_visible_child(1)
+
+    handler = core.CollisionHandlerQueue()
+    trav = core.CollisionTraverser()
+    from_node = core.CollisionNode("from")
+    from_node.add_solid(core.CollisionSphere(0, 0, 0, 0.5))
+    from_node.set_from_collide_mask(core.CollisionNode.get_default_collide_mask() |
+                                    core.GeomNode.get_default_collide_mask())
+    from_node.set_into_collide_mask(0)
+    trav.add_collider(root.attach_new_node(from_node), handler)
+
+    trav.broadphase = False
+    expected = collect(trav, handler, root)
+    trav.broadphase = True
+    result = collect(trav, handler, root)
+    assert result == expected
+    assert sorted(set(e[1] for e in result)) == ["lod-1", "switch-1"]
@@ -0,0 +1,123 @@
+from panda3d import core
+import pytest
+
+
+def make_scene(into_solid, from_solid):
+    root = core.NodePath("root")
+
+    wall = core.CollisionNode("wall")
+    wall.add_solid(into_solid)
+    root.attach_new_node(wall)
+
+    mover = core.CollisionNode("mover")
+    mover.add_solid(from_solid)
+    np = root.attach_new_node(mover)
+    return root, np
+
+
+def make_traverser(continuous):
+    trav = core.CollisionTraverser()
+    trav.respect_prev_transform = True
+    trav.continuous = continuous
+    return trav
+
+
+@pytest.mark.parametrize("from_solid", [
+    core.CollisionSphere(0, 0, 0, 0.5),
+    core.CollisionCapsule((0, 0, 0), (0, 0, 1), 0.5),
+])
+def test_continuous_no_tunneling(from_solid):
+    root, np = make_scene(core.CollisionSphere(0, 0, 0, 0.2), from_solid)
+
+    # Moving clean past the obstacle in a single frame.
+    for continuous in (False, True):
+        np.set_pos(-3, 0, 0)
+        np.set_fluid_pos(3, 0, 0)
+
+        handler = core.CollisionHandlerQueue()
+        trav = make_traverser(continuous)
+        trav.add_collider(np, handler)
+        trav.traverse(root)
+
+        if not continuous:
+            # Without continuous collision, a sphere is already tested along
+            # the line that its center moves along, but a capsule tunnels.
+            if isinstance(from_solid, core.CollisionCapsule):
+                assert handler.get_num_entries() == 0
+            continue
+
+        assert handler.get_num_entries() == 1
+        entry = handler.get_entry(0)
+        assert entry.continuous
+        assert entry.collided()
+        assert entry.t == pytest.approx(2.3 / 6.0, abs=0.01)
+        assert entry.get_contact_pos(root).x == pytest.approx(-0.7, abs=0.02)
+        assert entry.get_contact_normal(root).x < 0
+
+
+def test_continuous_fast_projectile():
+    # A small, fast projectile crosses a thin wall far from where it started.
+    # Every gap of its radius along the path must be tested.
+    root, np = make_scene(core.CollisionBox((97.3, 0, 0), 0.01, 5, 5),
+                          core.CollisionSphere(0, 0, 0, 0.05))
+    np.set_pos(0, 0, 0)
+    np.set_fluid_pos(100, 0, 0)
+
+    handler = core.CollisionHandlerQueue()
+    trav = make_traverser(True)
+    trav.add_collider(np, handler)
+    trav.traverse(root)
+
+    assert handler.get_num_entries() == 1
+    entry = handler.get_entry(0)
+    assert entry.get_contact_pos(root).x == pytest.approx(97.24, abs=0.02)
+
+
+def test_continuous_resting():
+    # A collider that was already touching at its previous position is
+    # handled at its current position, as usual.
+    root, np = make_scene(core.CollisionSphere(0, 0, 0, 1),
+                          core.CollisionSphere(0, 0, 0, 0.5))
+    np.set_pos(-1, 0, 0)
+    np.set_fluid_pos(-0.9, 0, 0)
+
+    handler = core.CollisionHandlerQueue()
+    trav = make_traverser(True)
+    trav.add_collider(np, handler)
+    trav.traverse(root)
+
+    assert handler.get_num_entries() == 1
+    entry = handler.get_entry(0)
+    assert entry.get_surface_point(root).almost_equal((-1, 0, 0))
+
+
+def test_continuous_static():
+    # Without a previous transform, nothing is swept.
+    root, np = make_scene(core.CollisionSphere(0, 0, 0, 0.2),
+                          core.CollisionSphere(0, 0, 0, 0.5))
+    np.set_pos(3, 0, 0)
+
+    handler = core.CollisionHandlerQueue()
+    trav = make_traverser(True)
+    trav.add_collider(np, handler)
+    trav.traverse(root)
+    assert handler.get_num_entries() == 0
+
+
+def test_pusher_resolve_toi():
+    root, np = make_scene(core.CollisionBox((0, 0, 0), 0.05, 5, 5),
+                          core.CollisionSphere(0, 0, 0, 0.5))
+    np.set_pos(-3, 0, 0)
+    np.set_fluid_pos(3, 1, 0)
+
+    pusher = core.CollisionHandlerPusher()
+    pusher.resolve_toi = True
+    pusher.add_collider(np, np)
+    trav = make_traverser(True)
+    trav.add_collider(np, pusher)
+    trav.traverse(root)
+
+    # It stops at the wall, and slides along it for the rest of its motion.
+    assert np.get_x() == pytest.approx(-0.55, abs=0.02)
+    assert np.get_y() == pytest.approx(1)
+
@@ -106,3 +106,17 @@ def test_collision_handler_pusher_pickle():
     assert tuple(handler.out_patterns) == ()
     assert not handler.has_center()
     assert handler.horizontal
+    assert not handler.resolve_toi
+
+
+def test_collision_handler_pusher_pickle_resolve_toi():
+    from panda3d.core import CollisionHandlerPusher
+
+    handler = CollisionHandlerPusher()
+    handler.horizontal = True
+    handler.resolve_toi = True
+
+    handler = loads(dumps(handler, -1))
+
+    assert handler.horizontal
+    assert handler.resolve_toi
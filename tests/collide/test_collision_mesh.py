@@ -0,0 +1,274 @@
+from collisions import *
+from panda3d import core
+import pytest
+
+
+def make_terrain(size=12):
+    # A bumpy grid of quads, as both a CollisionMesh and a list of polygons.
+    def height(x, y):
+        return ((x * 7 + y * 3) % 5) * 0.2
+
+    mesh = core.CollisionMesh()
+    polys = []
+    for y in range(size + 1):
+        for x in range(size + 1):
+            mesh.add_vertex((x, y, height(x, y)))
+
+    for y in range(size):
+        for x in range(size):
+            a = y * (size + 1) + x
+            b = a + 1
+            c = a + size + 2
+            d = a + size + 1
+            mesh.add_triangle(a, b, c)
+            mesh.add_triangle(a, c, d)
+            polys.append(CollisionPolygon(mesh.get_vertex(a), mesh.get_vertex(b), mesh.get_vertex(c)))
+            polys.append(CollisionPolygon(mesh.get_vertex(a), mesh.get_vertex(c), mesh.get_vertex(d)))
+
+    return mesh, polys
+
+
+def collide_all(solid_from, solids_into):
+    root = NodePath("root")
+    node_from = CollisionNode("from")
+    node_from.add_solid(solid_from)
+    np_from = root.attach_new_node(node_from)
+
+    node_into = CollisionNode("into")
+    for solid in solids_into:
+        node_into.add_solid(solid)
+    root.attach_new_node(node_into)
+
+    trav = CollisionTraverser()
+    queue = CollisionHandlerQueue()
+    trav.add_collider(np_from, queue)
+    trav.traverse(root)
+    queue.sort_entries()
+    return queue.get_entries()
+
+
+def test_collision_mesh_bvh():
+    mesh, polys = make_terrain()
+    assert mesh.get_num_triangles() == len(polys)
+    assert mesh.get_num_bvh_nodes() > 1
+    depth = mesh.get_bvh_depth()
+    assert 1 < depth < 20
+
+    # The triangles are reordered, but still the same set.
+    tris = set(tuple(sorted(mesh.get_triangle(i))) for i in range(mesh.get_num_triangles()))
+    assert len(tris) == len(polys)
+
+
+def test_ray_into_mesh():
+    mesh, polys = make_terrain()
+
+    for i in range(40):
+        origin = Point3((i * 0.37) % 12, (i * 0.71) % 12, 5)
+        direction = Vec3(((i % 3) - 1) * 0.3, ((i % 5) - 2) * 0.2, -1)
+        ray = CollisionRay(origin, direction)
+
+        mesh_entries = collide_all(ray, [mesh])
+        poly_entries = collide_all(ray, polys)
+        assert len(mesh_entries) == (1 if poly_entries else 0)
+        if poly_entries:
+            assert mesh_entries[0].get_surface_point(NodePath()).almost_equal(
+                poly_entries[0].get_surface_point(NodePath()), 0.001)
+            assert mesh_entries[0].get_surface_normal(NodePath()).almost_equal(
+                poly_entries[0].get_surface_normal(NodePath()), 0.001)
+
+
+def test_segment_into_mesh():
+    mesh, polys = make_terrain()
+
+    entry, np_from, np_into = make_collision(CollisionSegment((3.5, 3.5, 5), (3.5, 3.5, -5)), mesh)
+    assert entry is not None
+    assert entry.get_surface_point(np_from).almost_equal(
+        collide_all(CollisionRay((3.5, 3.5, 5), (0, 0, -1)), polys)[0].get_surface_point(np_from), 0.001)
+
+    # Doesn't reach.
+    entry = make_collision(CollisionSegment((3.5, 3.5, 5), (3.5, 3.5, 2)), mesh)[0]
+    assert entry is None
+
+    entry = make_collision(CollisionLine((3.5, 3.5, 5), (0, 0, 1)), mesh)[0]
+    assert entry is not None
+
+
+def test_sphere_into_mesh():
+    mesh, polys = make_terrain()
+
+    for i in range(40):
+        center = Point3((i * 0.37) % 12, (i * 0.71) % 12, (i % 7) * 0.25)
+        sphere = CollisionSphere(center, 0.5)
+        mesh_entries = collide_all(sphere, [mesh])
+        poly_entries = collide_all(sphere, polys)
+        assert len(mesh_entries) == (1 if poly_entries else 0)
+
+    entry, np_from, np_into = make_collision(CollisionSphere(6.5, 6.5, 1.5, 0.5), mesh)
+    assert entry is None
+
+    # A sphere resting on a flat part of the mesh.
+    flat = core.CollisionMesh()
+    for v in [(0, 0, 0), (4, 0, 0), (4, 4, 0), (0, 4, 0)]:
+        flat.add_vertex(v)
+    flat.add_triangle(0, 1, 2)
+    flat.add_triangle(0, 2, 3)
+    entry, np_from, np_into = make_collision(CollisionSphere(1, 3, 0.5, 1), flat)
+    assert entry is not None
+    assert entry.get_surface_point(np_from).almost_equal(Point3(1, 3, 0))
+    assert entry.get_surface_normal(np_into).almost_equal(Vec3(0, 0, 1))
+    assert entry.get_interior_point(np_from).almost_equal(Point3(1, 3, -0.5))
+
+    # Far behind the triangles, there is no collision.
+    entry = make_collision(CollisionSphere(1, 3, -1.5, 1), flat)[0]
+    assert entry is None
+
+
+def test_capsule_into_mesh():
+    mesh, polys = make_terrain()
+
+    entry = make_collision(CollisionCapsule((3, 3, 2), (5, 5, 2), 0.5), mesh)[0]
+    assert entry is None
+
+    entry, np_from, np_into = make_collision(CollisionCapsule((3, 3, 1), (5, 5, 0.5), 0.5), mesh)
+    assert entry is not None
+    assert entry.get_surface_normal(np_into)[2] > 0
+
+    # A capsule going right through the mesh.
+    entry = make_collision(CollisionCapsule((6.2, 6.3, -3), (6.2, 6.3, 3), 0.1), mesh)[0]
+    assert entry is not None
+
+
+def test_box_into_mesh():
+    mesh, polys = make_terrain()
+
+    entry = make_collision(CollisionBox((6, 6, 3), 1, 1, 1), mesh)[0]
+    assert entry is None
+
+    entry, np_from, np_into = make_collision(CollisionBox((6, 6, 0.5), 1, 1, 1), mesh)
+    assert entry is not None
+    assert entry.get_surface_normal(np_into)[2] > 0
+
+    for i in range(20):
+        center = Point3((i * 0.37) % 12, (i * 0.71) % 12, (i % 7) * 0.25)
+        box = CollisionBox(center, 0.3, 0.4, 0.5)
+        assert (len(collide_all(box, [mesh])) > 0) == (len(collide_all(box, polys)) > 0)
+
+
+def test_collision_mesh_add_geom():
+    maker = core.CardMaker("card")
+    maker.set_frame(-1, 1, -1, 1)
+    card = maker.generate()
+
+    mesh = core.CollisionMesh()
+    mesh.add_geom(card.get_geom(0), core.Mat4.rotate_mat(-90, (1, 0, 0)))
+    assert mesh.get_num_triangles() == 2
+
+    entry, np_from, np_into = make_collision(CollisionRay((0.5, 0.5, 2), (0, 0, -1)), mesh)
+    assert entry is not None
+    assert entry.get_surface_point(np_from).almost_equal(Point3(0.5, 0.5, 0))
+
+
+def test_collision_mesh_xform():
+    # Flattening the node transforms the mesh in it.
+    mesh, polys = make_terrain()
+    np = NodePath(CollisionNode("mesh"))
+    np.node().add_solid(mesh)
+    np.set_x(100)
+    np.flatten_light()
+    mesh = np.node().get_solid(0)
+    assert type(mesh) is core.CollisionMesh
+
+    assert make_collision(CollisionRay((3.5, 3.5, 5), (0, 0, -1)), mesh)[0] is None
+    assert make_collision(CollisionRay((103.5, 3.5, 5), (0, 0, -1)), mesh)[0] is not None
+
+
+def test_collision_mesh_bam():
+    mesh, polys = make_terrain()
+    num_nodes = mesh.get_num_bvh_nodes()
+
+    data = mesh.encode_to_bam_stream()
+    mesh2 = core.CollisionMesh.decode_from_bam_stream(data)
+    assert mesh2.get_num_vertices() == mesh.get_num_vertices()
+    assert mesh2.get_num_triangles() == mesh.get_num_triangles()
+    assert mesh2.get_num_bvh_nodes() == num_nodes
+    for i in range(mesh.get_num_triangles()):
+        assert mesh2.get_triangle(i) == mesh.get_triangle(i)
+
+    ray = CollisionRay((3.5, 3.5, 5), (0, 0, -1))
+    entry1 = make_collision(ray, mesh)[0]
+    entry2 = make_collision(ray, mesh2)[0]
+    assert entry1.get_surface_point(NodePath()) == entry2.get_surface_point(NodePath())
+
+
+def test_egg_polyset_to_mesh():
+    egg = pytest.importorskip("panda3d.egg")
+
+    data = egg.EggData()
+    vpool = egg.EggVertexPool("vpool")
+    data.add_child(vpool)
+
+    group = egg.EggGroup("terrain")
+    group.set_cs_type(egg.EggGroup.CST_polyset)
+    group.set_collide_flags(egg.EggGroup.CF_descend)
+    data.add_child(group)
+
+    for x in range(4):
+        poly = egg.EggPolygon()
+        for pos in [(x, 0, 0), (x + 1, 0, 0), (x + 1, 1, 0), (x, 1, 0)]:
+            vertex = egg.EggVertex()
+            vertex.set_pos(core.Point3D(*pos))
+            poly.add_vertex(vpool.add_vertex(vertex))
+        group.add_child(poly)
+
+    page = core.load_prc_file_data("", "egg-collision-mesh-threshold 4")
+    try:
+        root = NodePath(egg.load_egg_data(data))
+    finally:
+        core.unload_prc_file(page)
+
+    cnode = root.find("**/+CollisionNode").node()
+    assert cnode.get_num_solids() == 1
+    solid = cnode.get_solid(0)
+    assert isinstance(solid, core.CollisionMesh)
+    assert solid.get_num_triangles() == 8
+    assert solid.get_num_vertices() == 10
+
+
+def test_geom_mesh_threshold():
+    # A grid of cards in one Geom, to be collided with as visible geometry.
+    root = NodePath("root")
+    maker = core.CardMaker("card")
+    for x in range(4):
+        maker.set_frame(x, x + 1, -1, 1)
+        root.attach_new_node(maker.generate())
+    root.flatten_strong()
+    root.set_p(-90)
+    root.flatten_light()
+    gnode = root.find("**/+GeomNode").node()
+    assert gnode.get_num_geoms() == 1
+
+    ray = CollisionNode("ray")
+    ray.add_solid(CollisionRay((2.5, 0.2, 1), (0, 0, -1)))
+    ray.set_from_collide_mask(core.GeomNode.get_default_collide_mask())
+    ray_np = root.attach_new_node(ray)
+
+    def traverse():
+        trav = CollisionTraverser()
+        queue = CollisionHandlerQueue()
+        trav.add_collider(ray_np, queue)
+        trav.traverse(root)
+        return [(entry.get_into().get_type().name, entry.get_surface_point(root))
+                for entry in queue.entries]
+
+    expected = traverse()
+    assert len(expected) == 1
+    assert expected[0][0] == 'CollisionGeom'
+
+    page = core.load_prc_file_data("", "collision-geom-mesh-threshold 4")
+    try:
+        result = traverse()
+    finally:
+        core.unload_prc_file(page)
+    assert len(result) == 1
+    assert result[0][0] == 'CollisionMesh'
+    assert result[0][1].almost_equal(expected[0][1])
@@ -0,0 +1,122 @@
+from panda3d import core
+import pytest
+
+
+@pytest.fixture
+def parallel():
+    page = core.load_prc_file_data("", "collision-num-threads 3\n"
+                                       "collision-parallel-batch-size 4")
+    yield
+    core.unload_prc_file(page)
+
+
+def make_world(num_colliders):
+    root = core.NodePath("root")
+
+    for x in range(8):
+        for y in range(8):
+            cnode = core.CollisionNode("into-%d-%d" % (x, y))
+            cnode.add_solid(core.CollisionSphere(0, 0, 0, 0.6))
+            cnode.add_solid(core.CollisionBox((0, 0, -1), 0.5, 0.5, 0.2))
+            cnode.set_from_collide_mask(0)
+            np = root.attach_new_node(cnode)
+            np.set_pos(x * 2, y * 2, 0)
+
+    maker = core.CardMaker("card")
+    maker.set_frame(-1, 1, -1, 1)
+    card = root.attach_new_node(maker.generate())
+    card.set_pos(5, 5, 0)
+    card.set_p(-90)
+    card.node().set_into_collide_mask(core.GeomNode.get_default_collide_mask())
+
+    colliders = []
+    for i in range(num_colliders):
+        cnode = core.CollisionNode("from-%d" % (i))
+        cnode.add_solid(core.CollisionSphere(0, 0, 0, 0.5))
+        cnode.set_from_collide_mask(core.CollisionNode.get_default_collide_mask() |
+                                    core.GeomNode.get_default_collide_mask())
+        cnode.set_into_collide_mask(0)
+        np = root.attach_new_node(cnode)
+        np.set_pos((i * 7) % 16, (i * 3) % 16, (i % 3) * 0.25)
+        colliders.append(np)
+
+    return root, colliders
+
+
+def collect(trav, handler, root):
+    trav.traverse(root)
+    return [(entry.get_from_node_path().name, entry.get_into_node_path().name,
+             entry.get_into().get_type().name,
+             tuple(round(v, 4) for v in entry.get_surface_point(root)))
+            for entry in handler.entries]
+
+
+def test_parallel_matches_serial(parallel):
+    if not core.Thread.is_true_threads():
+        pytest.skip("requires true threads")
+
+    root, colliders = make_world(60)
+    handler = core.CollisionHandlerQueue()
+    trav = core.CollisionTraverser()
+    trav.broadphase = True
+    for np in colliders:
+        trav.add_collider(np, handler)
+
+    result = collect(trav, handler, root)
+
+    page = core.load_prc_file_data("", "collision-num-threads 0")
+    expected = collect(trav, handler, root)
+    core.unload_prc_file(page)
+
+    # The entries come in exactly the same order.
+    assert len(expected) > 0
+    assert result == expected
+
+
+def test_parallel_repeatable(parallel):
+    root, colliders = make_world(60)
+    handler = core.CollisionHandlerQueue()
+    trav = core.CollisionTraverser()
+    trav.broadphase = True
+    for np in colliders:
+        trav.add_collider(np, handler)
+
+    first = collect(trav, handler, root)
+    for i in range(5):
+        assert collect(trav, handler, root) == first
+
+
+def test_parallel_handlers(parallel):
+    # Each collider's entries go to its own handler.  The colliders are given
+    # to the handlers in pairs, since only the even ones touch anything.
+    root, colliders = make_world(20)
+    handlers = [core.CollisionHandlerQueue(), core.CollisionHandlerQueue()]
+    trav = core.CollisionTraverser()
+    trav.broadphase = True
+    for i, np in enumerate(colliders):
+        trav.add_collider(np, handlers[(i // 2) % 2])
+
+    trav.traverse(root)
+    for i, handler in enumerate(handlers):
+        assert handler.get_num_entries() > 0
+        for entry in handler.entries:
+            index = int(entry.get_from_node_path().name.split("-")[1])
+            assert (index // 2) % 2 == i
+
+
+def test_parallel_without_broadphase(parallel):
+    # The worker threads are only used with the broadphase; without it, the
+    # ordinary traversal finds the same collisions.
+    root, colliders = make_world(20)
+    handler = core.CollisionHandlerQueue()
+    trav = core.CollisionTraverser()
+    trav.broadphase = False
+    for np in colliders:
+        trav.add_collider(np, handler)
+
+    result = collect(trav, handler, root)
+
+    trav.broadphase = True
+    expected = collect(trav, handler, root)
+    assert len(result) > 0
+    assert sorted(result) == sorted(expected)
@@ -0,0 +1,187 @@
+from panda3d import core
+import pytest
+
+
+def make_world():
+    root = core.NodePath("root")
+    world = root.attach_new_node("world")
+    world.set_pos(1, 2, 3)
+    world.set_h(30)
+
+    for x in range(6):
+        for y in range(6):
+            cnode = core.CollisionNode("into-%d-%d" % (x, y))
+            if (x + y) % 2:
+                cnode.add_solid(core.CollisionSphere(0, 0, 0, 0.6))
+            else:
+                cnode.add_solid(core.CollisionBox((0, 0, 0), 0.4, 0.5, 0.3))
+            np = world.attach_new_node(cnode)
+            np.set_pos(x * 3 - 7.5, y * 3 - 7.5, (x * y) % 3 - 1)
+
+    maker = core.CardMaker("floor")
+    maker.set_frame(-20, 20, -20, 20)
+    floor = world.attach_new_node(maker.generate())
+    floor.set_p(-90)
+    floor.set_z(-4)
+    floor.node().set_into_collide_mask(core.GeomNode.get_default_collide_mask())
+
+    return root
+
+
+def make_query():
+    query = core.CollisionRayQuery()
+    for i in range(200):
+        origin = ((i * 7) % 11 - 5, (i * 5) % 13 - 6, 6)
+        direction = ((i % 9) - 4, (i % 7) - 3, -8)
+        query.add_ray(origin, direction)
+    return query
+
+
+ALL_MASK = core.CollisionNode.get_default_collide_mask() | \
+           core.GeomNode.get_default_collide_mask()
+
+
+def cast_one(root, origin, direction, mask):
+    ray = core.CollisionRay(origin, direction)
+    cnode = core.CollisionNode("ray")
+    cnode.add_solid(ray)
+    cnode.set_from_collide_mask(mask)
+    cnode.set_into_collide_mask(0)
+    np = root.attach_new_node(cnode)
+
+    handler = core.CollisionHandlerQueue()
+    trav = core.CollisionTraverser()
+    trav.add_collider(np, handler)
+    trav.traverse(root)
+    np.remove_node()
+
+    handler.sort_entries()
+    if handler.get_num_entries() == 0:
+        return None
+    return handler.get_entry(0)
+
+
+@pytest.mark.parametrize("mask", [
+    ALL_MASK,
+    core.CollisionNode.get_default_collide_mask(),
+    core.GeomNode.get_default_collide_mask(),
+])
+def test_ray_query_matches_traverse(mask):
+    root = make_world()
+    query = make_query()
+    trav = core.CollisionTraverser()
+    trav.cast_rays(root, query, mask)
+
+    num_hits = 0
+    for i in range(query.num_rays):
+        entry = cast_one(root, query.get_origin(i), query.get_direction(i), mask)
+        if entry is None:
+            assert not query.has_hit(i)
+            assert query.get_hit_t(i) < 0
+            assert query.get_hit_node_path(i).is_empty()
+            continue
+
+        num_hits += 1
+        assert query.has_hit(i)
+        assert query.get_hit_node_path(i) == entry.get_into_node_path()
+        assert query.get_hit_pos(i).almost_equal(entry.get_surface_point(root), 0.001)
+        assert query.get_hit_normal(i).almost_equal(entry.get_surface_normal(root).normalized(), 0.001)
+
+        pos = query.get_origin(i) + query.get_direction(i) * query.get_hit_t(i)
+        assert pos.almost_equal(query.get_hit_pos(i), 0.001)
+
+    assert num_hits > 0
+    assert query.num_hits == num_hits
+
+
+def test_ray_query_miss():
+    root = make_world()
+    query = core.CollisionRayQuery()
+    query.add_ray((0, 0, 10), (0, 0, 1))
+    query.add_ray((0, 0, 10), (0, 0, -1))
+
+    trav = core.CollisionTraverser()
+    trav.cast_rays(root, query, ALL_MASK)
+    assert not query.has_hit(0)
+    assert query.has_hit(1)
+
+    # Nothing is hit with an empty mask.
+    trav.cast_rays(root, query, core.CollideMask.all_off())
+    assert query.num_hits == 0
+
+
+def test_ray_query_set_rays():
+    root = make_world()
+    query = make_query()
+    origins = core.PTA_LVecBase3f([query.get_origin(i) for i in range(query.num_rays)])
+    directions = core.PTA_LVecBase3f([query.get_direction(i) for i in range(query.num_rays)])
+
+    query2 = core.CollisionRayQuery()
+    query2.set_rays(origins, directions)
+    assert query2.num_rays == query.num_rays
+
+    trav = core.CollisionTraverser()
+    trav.cast_rays(root, query, ALL_MASK)
+    trav.cast_rays(root, query2, ALL_MASK)
+    for i in range(query.num_rays):
+        assert query2.get_hit_pos(i) == query.get_hit_pos(i)
+        assert query2.get_hit_node_path(i) == query.get_hit_node_path(i)
+
+
+def test_ray_query_interleaved():
+    # The masks of the queries and the traversals that share a traverser may
+    # differ from one call to the next.
+    root = make_world()
+    query = make_query()
+    cmask = core.CollisionNode.get_default_collide_mask()
+    gmask = core.GeomNode.get_default_collide_mask()
+
+    expected = {}
+    for mask in (cmask, gmask):
+        core.CollisionTraverser().cast_rays(root, query, mask)
+        expected[mask] = [query.get_hit_node_path(i) for i in range(query.num_rays)]
+
+    cnode = core.CollisionNode("sphere")
+    cnode.add_solid(core.CollisionSphere(0, 0, 0, 1))
+    cnode.set_from_collide_mask(gmask)
+    cnode.set_into_collide_mask(0)
+    np = root.find("world").attach_new_node(cnode)
+    np.set_pos(5, -1, -4)
+
+    handler = core.CollisionHandlerQueue()
+    trav = core.CollisionTraverser()
+    trav.broadphase = True
+    trav.add_collider(np, handler)
+    for mask in (cmask, gmask, cmask):
+        handler.clear_entries()
+        trav.traverse(root)
+        assert handler.get_num_entries() == 1
+        assert handler.get_entry(0).get_into_node().name == "floor"
+
+        trav.cast_rays(root, query, mask)
+        assert [query.get_hit_node_path(i) for i in range(query.num_rays)] == expected[mask]
+
+
+@pytest.fixture
+def parallel():
+    page = core.load_prc_file_data("", "collision-num-threads 3\n"
+                                       "collision-parallel-batch-size 8")
+    yield
+    core.unload_prc_file(page)
+
+
+def test_ray_query_parallel(parallel):
+    root = make_world()
+    query = make_query()
+    trav = core.CollisionTraverser()
+    trav.cast_rays(root, query, ALL_MASK)
+    result = [(query.get_hit_t(i), query.get_hit_pos(i), query.get_hit_node_path(i))
+              for i in range(query.num_rays)]
+
+    page = core.load_prc_file_data("", "collision-num-threads 0")
+    trav.cast_rays(root, query, ALL_MASK)
+    core.unload_prc_file(page)
+    expected = [(query.get_hit_t(i), query.get_hit_pos(i), query.get_hit_node_path(i))
+                for i in range(query.num_rays)]
+
+    assert result == expected
@@ -0,0 +1,141 @@
+from panda3d import core
+import pytest
+
+
+@pytest.fixture(params=["", "Cull/Draw"], ids=["serial", "threaded"])
+def buffer(request, graphics_pipe):
+    if request.param and not core.Thread.is_threading_supported():
+        pytest.skip("requires threading support")
+
+    engine = core.GraphicsEngine()
+    engine.set_threading_model(request.param)
+
+    fbprops = core.FrameBufferProperties()
+    fbprops.force_hardware = True
+    fbprops.set_rgba_bits(8, 8, 8, 8)
+
+    buffer = engine.make_output(
+        graphics_pipe,
+        'buffer',
+        0,
+        fbprops,
+        core.WindowProperties.size(32, 32),
+        core.GraphicsPipe.BF_refuse_window,
+    )
+    engine.open_windows()
+
+    if buffer is None:
+        pytest.skip("GraphicsPipe cannot make offscreen buffers")
+
+    buffer.set_clear_color_active(True)
+    buffer.set_clear_color((0, 0, 0, 1))
+
+    yield buffer
+
+    engine.remove_window(buffer)
+
+
+@pytest.fixture
+def async_animation():
+    if not core.Thread.is_true_threads():
+        pytest.skip("requires true threading support")
+
+    page = core.load_prc_file_data("", "async-animation-threads 2")
+    yield
+    core.unload_prc_file(page)
+
+
+def make_skinned_card(transform):
+    # A white card on the left of the view, that is entirely moved by the
+    # given transform.
+    format = core.GeomVertexFormat()
+    array = core.GeomVertexArrayFormat()
+    array.add_column("vertex", 3, core.Geom.NT_float32, core.Geom.C_point)
+    format.add_array(array)
+    blend_array = core.GeomVertexArrayFormat()
+    blend_array.add_column(core.InternalName.get_transform_blend(), 1,
+                           core.Geom.NT_uint16, core.Geom.C_index)
+    format.add_array(blend_array)
+    spec = core.GeomVertexAnimationSpec()
+    spec.set_panda()
+    format.set_animation(spec)
+    format = core.GeomVertexFormat.register_format(format)
+
+    table = core.TransformBlendTable()
+    table.add_blend(core.TransformBlend(transform, 1.0))
+    table.set_rows(core.SparseArray.range(0, 4))
+
+    vdata = core.GeomVertexData("card", format, core.Geom.UH_static)
+    vdata.set_transform_blend_table(table)
+    vdata.set_num_rows(4)
+    vertex = core.GeomVertexWriter(vdata, "vertex")
+    blend = core.GeomVertexWriter(vdata, core.InternalName.get_transform_blend())
+    for x, z in ((-3, -1), (-1, -1), (-1, 1), (-3, 1)):
+        vertex.set_data3(x, 0, z)
+        blend.set_data1i(0)
+
+    tris = core.GeomTriangles(core.Geom.UH_static)
+    tris.add_vertices(0, 1, 2)
+    tris.add_vertices(0, 2, 3)
+    geom = core.Geom(vdata)
+    geom.add_primitive(tris)
+    node = core.GeomNode("card")
+    node.add_geom(geom)
+    return node
+
+
+def render(buffer, transform):
+    scene = core.NodePath("root")
+    scene.set_two_sided(True)
+    lens = core.OrthographicLens()
+    lens.set_film_size(8, 8)
+    lens.set_near_far(1, 20)
+    camera = scene.attach_new_node(core.Camera("camera", lens))
+    camera.set_y(-10)
+    scene.attach_new_node(make_skinned_card(transform))
+
+    region = buffer.make_display_region()
+    region.camera = camera
+
+    texture = core.Texture("color")
+    buffer.add_render_texture(texture,
+                              core.GraphicsOutput.RTM_copy_ram,
+                              core.GraphicsOutput.RTP_color)
+    # A threaded pipeline needs a few frames for the scene to reach the draw
+    # stage.
+    for i in range(3):
+        buffer.engine.render_frame()
+    buffer.engine.sync_frame()
+    buffer.clear_render_textures()
+    buffer.remove_display_region(region)
+
+    data = bytes(texture.get_ram_image())
+    size = texture.x_size
+    # Returns true if the pixel was drawn with the white card.
+    return lambda x, y: data[(y * size + x) * 4] > 127
+
+
+def test_animate_vertices_async(buffer, async_animation):
+    transform = core.UserVertexTransform("transform")
+    transform.set_matrix(core.LMatrix4.translate_mat(2, 0, 0))
+
+    # The card has been moved from the left to the middle of the view.
+    fetch = render(buffer, transform)
+    assert fetch(16, 16)
+    assert not fetch(6, 16)
+
+
+def test_animate_vertices_async_matches_serial(buffer):
+    transform = core.UserVertexTransform("transform")
+    transform.set_matrix(core.LMatrix4.translate_mat(1, 0, 0.5))
+    serial = render(buffer, transform)
+
+    page = core.load_prc_file_data("", "async-animation-threads 2")
+    try:
+        result = render(buffer, transform)
+    finally:
+        core.unload_prc_file(page)
+
+    for y in range(32):
+        for x in range(32):
+            assert result(x, y) == serial(x, y)
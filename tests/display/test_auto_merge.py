@@ -0,0 +1,97 @@
+from panda3d import core
+import pytest
+
+
+@pytest.fixture
+def buffer(graphics_pipe):
+    engine = core.GraphicsEngine()
+    engine.set_threading_model("")
+
+    fbprops = core.FrameBufferProperties()
+    fbprops.force_hardware = True
+    fbprops.set_rgba_bits(8, 8, 8, 8)
+
+    buffer = engine.make_output(
+        graphics_pipe,
+        'buffer',
+        0,
+        fbprops,
+        core.WindowProperties.size(32, 32),
+        core.GraphicsPipe.BF_refuse_window,
+    )
+    engine.open_windows()
+
+    if buffer is None:
+        pytest.skip("GraphicsPipe cannot make offscreen buffers")
+
+    buffer.set_clear_color_active(True)
+    buffer.set_clear_color((0, 0, 0, 1))
+
+    yield buffer
+
+    engine.remove_window(buffer)
+
+
+def make_card(color):
+    vdata = core.GeomVertexData("card", core.GeomVertexFormat.get_v3c4(), core.Geom.UH_static)
+    vdata.unclean_set_num_rows(4)
+    vertex = core.GeomVertexWriter(vdata, "vertex")
+    vertex.set_data3(-0.5, 0, 0.5)
+    vertex.set_data3(-0.5, 0, -0.5)
+    vertex.set_data3(0.5, 0, 0.5)
+    vertex.set_data3(0.5, 0, -0.5)
+    writer = core.GeomVertexWriter(vdata, "color")
+    for i in range(4):
+        writer.set_data4(color)
+
+    strip = core.GeomTristrips(core.Geom.UH_static)
+    strip.add_next_vertices(4)
+    strip.close_primitive()
+
+    geom = core.Geom(vdata)
+    geom.add_primitive(strip)
+    gnode = core.GeomNode("card")
+    gnode.add_geom(geom)
+    return gnode
+
+
+def render_grid(buffer, auto_merge):
+    merge = core.ConfigVariableBool("auto-merge-geoms")
+    merge.set_value(auto_merge)
+
+    try:
+        scene = core.NodePath("root")
+        lens = core.OrthographicLens()
+        lens.set_film_size(4, 4)
+        lens.set_near_far(-10, 10)
+        camera = scene.attach_new_node(core.Camera("camera", lens))
+
+        for x in range(4):
+            for z in range(4):
+                color = (x / 3.0, z / 3.0, 1 - x / 3.0, 1)
+                card = scene.attach_new_node(make_card(color))
+                card.set_pos(x - 1.5, 0, z - 1.5)
+                card.set_scale(0.5 + x * 0.125, 1, 0.5 + z * 0.125)
+
+        region = buffer.make_display_region()
+        region.camera = camera
+
+        texture = core.Texture("color")
+        buffer.add_render_texture(texture,
+                                  core.GraphicsOutput.RTM_copy_ram,
+                                  core.GraphicsOutput.RTP_color)
+
+        # Render twice, so that the merged geometry is reused once.
+        buffer.engine.render_frame()
+        buffer.engine.render_frame()
+        buffer.clear_render_textures()
+        buffer.remove_display_region(region)
+        return bytes(texture.get_ram_image())
+    finally:
+        merge.clear_local_value()
+
+
+def test_auto_merge_matches_unmerged(buffer):
+    unmerged = render_grid(buffer, False)
+    merged = render_grid(buffer, True)
+    assert merged == unmerged
@@ -0,0 +1,237 @@
+from panda3d import core
+import random
+import pytest
+
+
+# More than the number of objects below which the bins fall back to
+# std::sort.
+NUM_CARDS = 100
+
+
+@pytest.fixture
+def buffer(graphics_pipe):
+    engine = core.GraphicsEngine()
+    engine.set_threading_model("")
+
+    fbprops = core.FrameBufferProperties()
+    fbprops.force_hardware = True
+    fbprops.set_rgba_bits(8, 8, 8, 8)
+
+    buffer = engine.make_output(
+        graphics_pipe,
+        'buffer',
+        0,
+        fbprops,
+        core.WindowProperties.size(128, 8),
+        core.GraphicsPipe.BF_refuse_window,
+    )
+    engine.open_windows()
+
+    if buffer is None:
+        pytest.skip("GraphicsPipe cannot make offscreen buffers")
+
+    buffer.set_clear_color_active(True)
+    buffer.set_clear_color((0, 0, 0, 1))
+
+    yield buffer
+
+    engine.remove_window(buffer)
+
+
+@pytest.fixture(params=[True, False], ids=["radix", "std"])
+def radix_sort(request):
+    page = core.load_prc_file_data("", "cull-bin-radix-sort %d" % (request.param))
+    yield request.param
+    core.unload_prc_file(page)
+
+
+def make_bin(bin_type):
+    name = "test_%s" % (bin_type)
+    manager = core.CullBinManager.get_global_ptr()
+    if manager.find_bin(name) < 0:
+        manager.add_bin(name, bin_type, 30)
+    return name
+
+
+def make_scene(bin_name, depths, shared=False):
+    # One unit is one pixel.  Card i covers columns i and i + 1, so each
+    # column shows which of the two cards that cover it was drawn last.  If
+    # shared is true, all of the cards share the same Geom.
+    scene = core.NodePath("root")
+    lens = core.OrthographicLens()
+    lens.set_film_size(128, 8)
+    lens.set_film_offset(64, 0)
+    lens.set_near_far(0.5, 1000)
+    camera = scene.attach_new_node(core.Camera("camera", lens))
+
+    maker = core.CardMaker("card")
+    maker.set_frame(0, 2, -4, 4)
+    template = core.NodePath(maker.generate())
+
+    cards = scene.attach_new_node("cards")
+    cards.set_depth_test(False)
+    cards.set_depth_write(False)
+    cards.set_bin(bin_name, 0)
+
+    # The cards are added in random order, so that the traversal order does
+    # not give the expected answer by accident.
+    order = list(range(len(depths)))
+    random.Random(1).shuffle(order)
+    for i in order:
+        if shared:
+            card = template.copy_to(cards)
+        else:
+            card = cards.attach_new_node(maker.generate())
+        card.name = str(i)
+        card.set_pos(i, depths[i], 0)
+        card.set_color((i + 1) / 255.0, 0, 0, 1)
+
+    return scene, camera
+
+
+def render(buffer, scene, camera):
+    region = buffer.make_display_region()
+    region.camera = camera
+    result = render_frame(buffer)
+    buffer.remove_display_region(region)
+    return result
+
+
+def render_frame(buffer):
+    texture = core.Texture("color")
+    buffer.add_render_texture(texture,
+                              core.GraphicsOutput.RTM_copy_ram,
+                              core.GraphicsOutput.RTP_color)
+    buffer.engine.render_frame()
+    buffer.clear_render_textures()
+
+    # Returns the index of the card that was drawn last in each column, or -1
+    # if the column is empty.  The image is in BGRA order.
+    data = bytes(texture.get_ram_image())
+    row = 4 * texture.x_size * 4
+    return [data[row + x * 4 + 2] - 1 for x in range(NUM_CARDS + 1)]
+
+
+def expected_columns(depths, key):
+    # Column x is covered by cards x - 1 and x; the one for which key is
+    # largest is drawn last.  A depth of None means there is no card.
+    columns = []
+    for x in range(NUM_CARDS + 1):
+        cards = [i for i in (x - 1, x)
+                 if 0 <= i < len(depths) and depths[i] is not None]
+        if cards:
+            columns.append(max(cards, key=lambda i: key(depths[i])))
+        else:
+            columns.append(-1)
+    return columns
+
+
+def make_depths(seed):
+    depths = list(range(1, NUM_CARDS + 1))
+    random.Random(seed).shuffle(depths)
+    return depths
+
+
+def test_cull_bin_back_to_front(buffer, radix_sort):
+    depths = make_depths(2)
+    bin_name = make_bin(core.CullBinEnums.BT_back_to_front)
+    scene, camera = make_scene(bin_name, depths)
+
+    # The nearest card is drawn last.
+    result = render(buffer, scene, camera)
+    assert result == expected_columns(depths, lambda depth: -depth)
+
+
+def test_cull_bin_front_to_back(buffer, radix_sort):
+    depths = make_depths(3)
+    bin_name = make_bin(core.CullBinEnums.BT_front_to_back)
+    scene, camera = make_scene(bin_name, depths)
+
+    # The farthest card is drawn last.
+    result = render(buffer, scene, camera)
+    assert result == expected_columns(depths, lambda depth: depth)
+
+
+def test_cull_bin_back_to_front_fractional(buffer, radix_sort):
+    # The distances differ by less than the spacing of the integers in the
+    # key, if the key were made by truncating the float.
+    depths = [10 + d / 1024.0 for d in make_depths(4)]
+    bin_name = make_bin(core.CullBinEnums.BT_back_to_front)
+    scene, camera = make_scene(bin_name, depths)
+
+    result = render(buffer, scene, camera)
+    assert result == expected_columns(depths, lambda depth: -depth)
+
+
+def test_cull_bin_state_sorted(buffer):
+    # Every card has a different state.  The order of the states is not
+    # something we can predict, but it should not depend on the way in which
+    # the bin is sorted.
+    depths = make_depths(5)
+    bin_name = make_bin(core.CullBinEnums.BT_state_sorted)
+    scene, camera = make_scene(bin_name, depths)
+
+    page = core.load_prc_file_data("", "cull-bin-radix-sort 0")
+    try:
+        expected = render(buffer, scene, camera)
+    finally:
+        core.unload_prc_file(page)
+
+    result = render(buffer, scene, camera)
+    assert result == expected
+    assert -1 not in result
+
+
+@pytest.mark.parametrize("shared", [False, True], ids=["unique", "shared"])
+def test_cull_bin_back_to_front_coherent(buffer, shared):
+    depths = make_depths(6)
+    bin_name = make_bin(core.CullBinEnums.BT_back_to_front_coherent)
+    scene, camera = make_scene(bin_name, depths, shared)
+    cards = scene.find("cards")
+
+    def back_to_front(depth):
+        return -depth
+
+    region = buffer.make_display_region()
+    region.camera = camera
+
+    # The first frame has nothing to start from.
+    assert render_frame(buffer) == expected_columns(depths, back_to_front)
+
+    # Nothing has changed, so the order of the last frame is right.
+    assert render_frame(buffer) == expected_columns(depths, back_to_front)
+
+    # A few of the cards move past their neighbors in depth.
+    rng = random.Random(7)
+    for n in range(5):
+        i = rng.randrange(NUM_CARDS)
+        depths[i] += rng.choice((-2.5, 2.5))
+        cards.find(str(i)).set_y(depths[i])
+    assert render_frame(buffer) == expected_columns(depths, back_to_front)
+
+    # Everything swaps places at once, so the order of the last frame is of
+    # no use.
+    for i in range(NUM_CARDS):
+        depths[i] = NUM_CARDS + 10 - depths[i]
+        cards.find(str(i)).set_y(depths[i])
+    assert render_frame(buffer) == expected_columns(depths, back_to_front)
+
+    # Some cards are removed, and they come back in a different order.
+    removed = list(range(0, NUM_CARDS, 7))
+    for i in removed:
+        cards.find(str(i)).detach_node()
+    assert render_frame(buffer) == expected_columns(
+        [None if i in removed else depth for i, depth in enumerate(depths)],
+        back_to_front)
+
+    maker = core.CardMaker("card")
+    maker.set_frame(0, 2, -4, 4)
+    for i in reversed(removed):
+        depths[i] = NUM_CARDS + 20 + i / 2.0
+        card = cards.attach_new_node(maker.generate())
+        card.name = str(i)
+        card.set_pos(i, depths[i], 0)
+        card.set_color((i + 1) / 255.0, 0, 0, 1)
+    assert render_frame(buffer) == expected_columns(depths, back_to_front)
+
+    buffer.remove_display_region(region)
@@ -0,0 +1,118 @@
+from panda3d import core
+import threading
+import pytest
+
+
+@pytest.fixture
+def buffer(graphics_pipe):
+    engine = core.GraphicsEngine()
+    engine.set_threading_model("")
+
+    fbprops = core.FrameBufferProperties()
+    fbprops.force_hardware = True
+    fbprops.set_rgba_bits(8, 8, 8, 8)
+
+    buffer = engine.make_output(
+        graphics_pipe,
+        'buffer',
+        0,
+        fbprops,
+        core.WindowProperties.size(32, 32),
+        core.GraphicsPipe.BF_refuse_window,
+    )
+    engine.open_windows()
+
+    if buffer is None:
+        pytest.skip("GraphicsPipe cannot make offscreen buffers")
+
+    buffer.set_clear_color_active(True)
+    buffer.set_clear_color((0, 0, 0, 1))
+
+    yield buffer
+
+    engine.remove_window(buffer)
+
+
+@pytest.fixture
+def parallel():
+    if not core.Thread.is_true_threads():
+        pytest.skip("requires true threading support")
+
+    page = core.load_prc_file_data("", "cull-num-threads 2\n"
+                                       "cull-parallel-depth 1\n"
+                                       "cull-parallel-min-vertices 0")
+    yield
+    core.unload_prc_file(page)
+
+
+def make_card(color):
+    maker = core.CardMaker("card")
+    maker.set_frame(-0.5, 0.5, -0.5, 0.5)
+    maker.set_color(color)
+    return maker.generate()
+
+
+def make_scene(callback):
+    scene = core.NodePath("root")
+    lens = core.OrthographicLens()
+    lens.set_film_size(4, 4)
+    lens.set_near_far(-10, 10)
+    camera = scene.attach_new_node(core.Camera("camera", lens))
+
+    for x in range(4):
+        # Each column is a subtree at cull-parallel-depth.
+        column = scene.attach_new_node("column")
+        for z in range(4):
+            color = (x / 3.0, z / 3.0, 1 - x / 3.0, 1)
+            parent = column
+            if z == 2:
+                parent = column.attach_new_node(core.CallbackNode("callback"))
+                parent.node().set_cull_callback(core.PythonCallbackObject(callback))
+            card = parent.attach_new_node(make_card(color))
+            card.set_pos(x - 1.5, 0, z - 1.5)
+
+    return scene, camera
+
+
+def render(buffer, callback):
+    scene, camera = make_scene(callback)
+    region = buffer.make_display_region()
+    region.camera = camera
+
+    texture = core.Texture("color")
+    buffer.add_render_texture(texture,
+                              core.GraphicsOutput.RTM_copy_ram,
+                              core.GraphicsOutput.RTP_color)
+    buffer.engine.render_frame()
+    buffer.clear_render_textures()
+    buffer.remove_display_region(region)
+    return bytes(texture.get_ram_image())
+
+
+def test_cull_parallel_matches_serial(buffer):
+    callback = lambda cbdata: cbdata.upcall()
+    serial = render(buffer, callback)
+
+    page = core.load_prc_file_data("", "cull-num-threads 2\n"
+                                       "cull-parallel-depth 1\n"
+                                       "cull-parallel-min-vertices 0")
+    try:
+        result = render(buffer, callback)
+    finally:
+        core.unload_prc_file(page)
+
+    assert result == serial
+
+
+def test_cull_parallel_callback_thread(buffer, parallel):
+    # The cull callbacks are still called on the thread that started the
+    # traversal, even though their parents were handed off to workers.
+    threads = []
+
+    def callback(cbdata):
+        threads.append(threading.get_ident())
+        cbdata.upcall()
+
+    render(buffer, callback)
+    assert len(threads) == 4
+    assert set(threads) == {threading.get_ident()}
@@ -0,0 +1,118 @@
+from panda3d import core
+import pytest
+
+
+@pytest.fixture
+def buffer(graphics_pipe):
+    engine = core.GraphicsEngine()
+    engine.set_threading_model("")
+
+    fbprops = core.FrameBufferProperties()
+    fbprops.force_hardware = True
+    fbprops.set_rgba_bits(8, 8, 8, 8)
+
+    buffer = engine.make_output(
+        graphics_pipe,
+        'buffer',
+        0,
+        fbprops,
+        core.WindowProperties.size(32, 32),
+        core.GraphicsPipe.BF_refuse_window,
+    )
+    engine.open_windows()
+
+    if buffer is None:
+        pytest.skip("GraphicsPipe cannot make offscreen buffers")
+
+    buffer.set_clear_color_active(True)
+    buffer.set_clear_color((0, 0, 0, 1))
+
+    yield buffer
+
+    engine.remove_window(buffer)
+
+
+def make_scene():
+    scene = core.NodePath("root")
+    lens = core.OrthographicLens()
+    lens.set_film_size(8, 8)
+    lens.set_near_far(1, 20)
+    camera = scene.attach_new_node(core.Camera("camera", lens))
+    camera.set_y(-10)
+
+    # Two instances of a white card, on the left and right of the view.
+    instanced = scene.attach_new_node(core.InstancedNode("instanced"))
+    instanced.node().instances.append((-2, 0, 0))
+    instanced.node().instances.append((2, 0, 0))
+
+    maker = core.CardMaker("card")
+    maker.set_frame(-1, 1, -1, 1)
+    instanced.attach_new_node(maker.generate())
+    return scene, camera, instanced
+
+
+def render(buffer, scene, camera):
+    region = buffer.make_display_region()
+    region.camera = camera
+
+    texture = core.Texture("color")
+    buffer.add_render_texture(texture,
+                              core.GraphicsOutput.RTM_copy_ram,
+                              core.GraphicsOutput.RTP_color)
+    buffer.engine.render_frame()
+    buffer.clear_render_textures()
+    buffer.remove_display_region(region)
+
+    data = bytes(texture.get_ram_image())
+    size = texture.x_size
+    # Returns true if the pixel was drawn with the white card.
+    return lambda x, y: data[(y * size + x) * 4] > 127
+
+
+def add_occluder(scene, x0, x1):
+    occluder = core.OccluderNode("occluder",
+                                 (x0, 0, -2), (x1, 0, -2),
+                                 (x1, 0, 2), (x0, 0, 2))
+    occluder.double_sided = True
+    np = scene.attach_new_node(occluder)
+    np.set_y(-5)
+    scene.set_occluder(np)
+
+
+def test_instanced_cull_visible(buffer):
+    scene, camera, instanced = make_scene()
+    fetch = render(buffer, scene, camera)
+    assert fetch(8, 16)
+    assert fetch(24, 16)
+    assert not fetch(16, 16)
+
+
+def test_instanced_cull_occluder(buffer):
+    # The occluder hides the left instance, but not the right one, so the
+    # instanced node as a whole is not culled.
+    scene, camera, instanced = make_scene()
+    add_occluder(scene, -3.5, -0.5)
+
+    fetch = render(buffer, scene, camera)
+    assert not fetch(8, 16)
+    assert fetch(24, 16)
+
+
+def test_instanced_cull_occluder_all(buffer):
+    scene, camera, instanced = make_scene()
+    add_occluder(scene, -3.5, 3.5)
+
+    fetch = render(buffer, scene, camera)
+    assert not fetch(8, 16)
+    assert not fetch(24, 16)
+
+
+def test_instanced_cull_frustum(buffer):
+    # An instance far outside of the view does not prevent the others from
+    # being drawn.
+    scene, camera, instanced = make_scene()
+    instanced.node().instances.append((100, 0, 0))
+
+    fetch = render(buffer, scene, camera)
+    assert fetch(8, 16)
+    assert fetch(24, 16)
@@ -0,0 +1,123 @@
+from panda3d import core
+import math
+import pytest
+
+
+@pytest.fixture
+def buffer(graphics_pipe):
+    engine = core.GraphicsEngine()
+    engine.set_threading_model("")
+
+    fbprops = core.FrameBufferProperties()
+    fbprops.force_hardware = True
+    fbprops.set_rgba_bits(8, 8, 8, 8)
+
+    buffer = engine.make_output(
+        graphics_pipe,
+        'buffer',
+        0,
+        fbprops,
+        core.WindowProperties.size(32, 32),
+        core.GraphicsPipe.BF_refuse_window,
+    )
+    engine.open_windows()
+
+    if buffer is None:
+        pytest.skip("GraphicsPipe cannot make offscreen buffers")
+
+    yield buffer
+
+    engine.remove_window(buffer)
+
+
+@pytest.fixture(params=[True, False], ids=["cone", "nocone"])
+def cone_culling(request):
+    page = core.load_prc_file_data("", "meshlet-cone-culling %d" % (request.param))
+    yield request.param
+    core.unload_prc_file(page)
+
+
+def make_sphere_meshlets(segments=32):
+    vdata = core.GeomVertexData('sphere', core.GeomVertexFormat.get_v3(), core.GeomEnums.UH_static)
+    writer = core.GeomVertexWriter(vdata, 'vertex')
+    rings = segments // 2
+    for r in range(rings + 1):
+        phi = math.pi * r / rings
+        for s in range(segments + 1):
+            theta = 2 * math.pi * s / segments
+            writer.add_data3(math.sin(phi) * math.cos(theta),
+                             math.sin(phi) * math.sin(theta),
+                             math.cos(phi))
+
+    prim = core.GeomTriangles(core.GeomEnums.UH_static)
+    for r in range(rings):
+        for s in range(segments):
+            v = r * (segments + 1) + s
+            prim.add_vertices(v, v + segments + 2, v + segments + 1)
+            prim.add_vertices(v, v + 1, v + segments + 2)
+
+    geom = core.Geom(vdata)
+    geom.add_primitive(prim)
+    node = core.GeomNode('sphere')
+    node.add_geom(geom)
+
+    meshlets = core.MeshletNode('sphere')
+    meshlets.add_clusters_from(node, 32)
+    return meshlets
+
+
+def count_drawn(buffer, scene, camera):
+    # Returns the number of Geoms that the cull traversal passed on to be
+    # drawn.
+    region = buffer.make_display_region()
+    region.camera = camera
+    buffer.engine.render_frame()
+    result = core.NodePath(region.make_cull_result_graph())
+    buffer.remove_display_region(region)
+
+    return sum(node.get_num_geoms()
+               for node in result.find_all_matches('**/+GeomNode').get_nodes())
+
+
+def make_scene(meshlets):
+    scene = core.NodePath("root")
+    lens = core.PerspectiveLens()
+    lens.set_fov(60)
+    lens.set_near_far(0.1, 100)
+    camera = scene.attach_new_node(core.Camera("camera", lens))
+    camera.set_y(-5)
+
+    sphere = scene.attach_new_node(meshlets)
+    return scene, camera, sphere
+
+
+def test_meshlet_cull_back_facing(buffer, cone_culling):
+    meshlets = make_sphere_meshlets()
+    scene, camera, sphere = make_scene(meshlets)
+    num_clusters = meshlets.get_num_clusters()
+
+    drawn = count_drawn(buffer, scene, camera)
+    if cone_culling:
+        # The clusters on the far side of the sphere are rejected.
+        assert 0 < drawn < num_clusters
+    else:
+        assert drawn == num_clusters
+
+
+def test_meshlet_cull_two_sided(buffer, cone_culling):
+    # Nothing is rejected when the back faces are visible.
+    meshlets = make_sphere_meshlets()
+    scene, camera, sphere = make_scene(meshlets)
+    sphere.set_two_sided(True)
+
+    assert count_drawn(buffer, scene, camera) == meshlets.get_num_clusters()
+
+
+def test_meshlet_cull_mirrored(buffer, cone_culling):
+    # A mirroring transform turns the sphere inside out, so the cone test
+    # would reject the wrong clusters; it is skipped.
+    meshlets = make_sphere_meshlets()
+    scene, camera, sphere = make_scene(meshlets)
+    sphere.set_sx(-1)
+
+    assert count_drawn(buffer, scene, camera) == meshlets.get_num_clusters()
@@ -0,0 +1,112 @@
+from panda3d import core
+import pytest
+
+
+@pytest.fixture
+def buffer(graphics_pipe):
+    engine = core.GraphicsEngine()
+    engine.set_threading_model("")
+
+    fbprops = core.FrameBufferProperties()
+    fbprops.force_hardware = True
+    fbprops.set_rgba_bits(8, 8, 8, 8)
+
+    buffer = engine.make_output(
+        graphics_pipe,
+        'buffer',
+        0,
+        fbprops,
+        core.WindowProperties.size(32, 32),
+        core.GraphicsPipe.BF_refuse_window,
+    )
+    engine.open_windows()
+
+    if buffer is None:
+        pytest.skip("GraphicsPipe cannot make offscreen buffers")
+
+    yield buffer
+
+    engine.remove_window(buffer)
+
+
+def make_card(size):
+    maker = core.CardMaker("card")
+    maker.set_frame(-size, size, -size, size)
+    return maker.generate()
+
+
+def add_probe(parent, name, reached):
+    # The cull callback is only called if the traversal reaches the node.  A
+    # CallbackNode has infinite bounds by default, so give it finite ones.
+    node = core.CallbackNode(name)
+    node.set_cull_callback(core.PythonCallbackObject(
+        lambda cbdata: (reached.append(name), cbdata.upcall())))
+    node.set_bounds(core.BoundingBox((-0.25, -0.1, -0.25), (0.25, 0.1, 0.25)))
+    np = parent.attach_new_node(node)
+    np.attach_new_node(make_card(0.25))
+    return np
+
+
+def cull(buffer, scene, camera):
+    occlusion = core.OcclusionBuffer(64, 64)
+    occlusion.add_occluder(scene.find("occluder"))
+
+    trav = core.CullTraverser()
+    trav.set_occlusion_buffer(occlusion)
+
+    region = buffer.make_display_region()
+    region.camera = camera
+    region.cull_traverser = trav
+    buffer.engine.render_frame()
+    buffer.remove_display_region(region)
+
+
+def make_scene():
+    scene = core.NodePath("root")
+    lens = core.OrthographicLens()
+    lens.set_film_size(8, 8)
+    lens.set_near_far(1, 20)
+    camera = scene.attach_new_node(core.Camera("camera", lens))
+    camera.set_y(-8)
+
+    # The occluder covers the middle of the view.  It is hidden, since only
+    # the occlusion buffer needs to see it.
+    occluder = scene.attach_new_node(make_card(1))
+    occluder.name = "occluder"
+    occluder.hide()
+    return scene, camera
+
+
+def test_occlusion_cull_hidden(buffer):
+    scene, camera = make_scene()
+    reached = []
+    add_probe(scene, "behind", reached).set_y(5)
+    add_probe(scene, "beside", reached).set_pos(3, 5, 0)
+    add_probe(scene, "in_front", reached).set_y(-4)
+
+    cull(buffer, scene, camera)
+    assert sorted(reached) == ["beside", "in_front"]
+
+
+def test_occlusion_cull_instanced(buffer):
+    # The prototype of the instances is behind the occluder, but the
+    # instances themselves are not.
+    scene, camera = make_scene()
+    instanced = scene.attach_new_node(core.InstancedNode("instanced"))
+    instanced.set_y(5)
+    instanced.node().instances.append((-3, 0, 0))
+    instanced.node().instances.append((3, 0, 0))
+
+    reached = []
+    add_probe(instanced, "prototype", reached)
+
+    cull(buffer, scene, camera)
+    assert reached == ["prototype"]
+
+    # When all of the instances are hidden, so is the prototype.
+    instanced.node().instances.clear()
+    instanced.node().instances.append((0, 0, 0.5))
+
+    del reached[:]
+    cull(buffer, scene, camera)
+    assert reached == []
@@ -0,0 +1,84 @@
+from panda3d import core
+import pytest
+
+
+@pytest.fixture
+def buffer(graphics_pipe):
+    engine = core.GraphicsEngine()
+    engine.set_threading_model("")
+
+    fbprops = core.FrameBufferProperties()
+    fbprops.force_hardware = True
+    fbprops.set_rgba_bits(8, 8, 8, 8)
+
+    buffer = engine.make_output(
+        graphics_pipe,
+        'buffer',
+        0,
+        fbprops,
+        core.WindowProperties.size(128, 128),
+        core.GraphicsPipe.BF_refuse_window,
+    )
+    engine.open_windows()
+
+    if buffer is None:
+        pytest.skip("GraphicsPipe cannot make offscreen buffers")
+
+    yield buffer
+
+    engine.remove_window(buffer)
+
+
+@pytest.fixture
+def streamed_texture(tmp_path):
+    image = core.PNMImage(256, 256, 3)
+    image.fill(0.25, 0.5, 0.75)
+    path = core.Filename.from_os_specific(str(tmp_path / "streamed.png"))
+    assert image.write(path)
+
+    tex = core.Texture("streamed")
+    assert tex.read(path)
+    tex.set_minfilter(core.SamplerState.FT_linear_mipmap_linear)
+
+    # The texture must be streamed before it is first rendered.
+    streamer = core.TextureStreamer.get_global_ptr()
+    budget = streamer.memory_budget
+    assert streamer.add_texture(tex)
+    yield tex
+    streamer.remove_texture(tex)
+    streamer.memory_budget = budget
+
+
+def cull(buffer, tex, size):
+    # One unit is one pixel.  The card is the indicated number of pixels on a
+    # side.
+    scene = core.NodePath("root")
+    lens = core.OrthographicLens()
+    lens.set_film_size(128, 128)
+    lens.set_near_far(1, 20)
+    camera = scene.attach_new_node(core.Camera("camera", lens))
+    camera.set_y(-10)
+
+    maker = core.CardMaker("card")
+    maker.set_frame(-size / 2.0, size / 2.0, -size / 2.0, size / 2.0)
+    card = scene.attach_new_node(maker.generate())
+    card.set_texture(tex)
+
+    region = buffer.make_display_region()
+    region.camera = camera
+    buffer.engine.render_frame()
+    buffer.remove_display_region(region)
+
+    streamer = core.TextureStreamer.get_global_ptr()
+    streamer.update()
+    streamer.wait_pending()
+
+
+@pytest.mark.parametrize("size,level", [(100, 0), (40, 1), (10, 2)])
+def test_texture_streaming_screen_size(buffer, streamed_texture, size, level):
+    # The level is chosen from the size of the card on screen, as measured
+    # during the cull traversal.  The measured size is somewhat larger than the
+    # card, since it is taken from a sphere around the card's bounds.
+    cull(buffer, streamed_texture, size)
+    assert streamed_texture.stream_level == level
+
@@ -163,3 +163,138 @@ def test_geom_linestrips_offset_indexed():
         cut,
         100103, 100104, 100005, 100006,
     )
+
+
+def make_grid_triangles(size, vdata=None):
+    # Builds a grid of triangles in a scrambled order, so that there is
+    # something for the vertex cache optimizer to do.
+    import random
+    rng = random.Random(1)
+
+    if vdata is not None:
+        writer = core.GeomVertexWriter(vdata, 'vertex')
+        for y in range(size + 1):
+            for x in range(size + 1):
+                writer.add_data3(x, y, 0)
+
+    tris = []
+    for y in range(size):
+        for x in range(size):
+            v = y * (size + 1) + x
+            tris.append((v, v + 1, v + size + 2))
+            tris.append((v, v + size + 2, v + size + 1))
+    rng.shuffle(tris)
+
+    prim = core.GeomTriangles(core.GeomEnums.UH_static)
+    for tri in tris:
+        prim.add_vertices(*tri)
+    return prim
+
+
+def triangle_set(prim):
+    verts = tuple(prim.get_vertex_list())
+    return sorted(verts[i:i + 3] for i in range(0, len(verts), 3))
+
+
+def test_geom_triangles_optimize_vertex_cache():
+    prim = make_grid_triangles(16)
+    before = prim.calc_acmr()
+
+    opt = prim.optimize_vertex_cache()
+    assert triangle_set(opt) == triangle_set(prim)
+    assert opt.calc_acmr() < before
+    assert opt.calc_acmr() < 1.0
+
+
+def test_geom_triangles_optimize_overdraw():
+    vdata = core.GeomVertexData('grid', core.GeomVertexFormat.get_v3(), core.GeomEnums.UH_static)
+    prim = make_grid_triangles(16, vdata).optimize_vertex_cache()
+
+    opt = prim.optimize_overdraw(vdata)
+    assert triangle_set(opt) == triangle_set(prim)
+    assert opt.calc_acmr() <= prim.calc_acmr() * 1.05 + 0.001
+
+
+def test_scene_graph_reducer_optimize_vertices():
+    vdata = core.GeomVertexData('grid', core.GeomVertexFormat.get_v3(), core.GeomEnums.UH_static)
+    prim = make_grid_triangles(8, vdata)
+    geom = core.Geom(vdata)
+    geom.add_primitive(prim)
+    node = core.GeomNode('grid')
+    node.add_geom(geom)
+
+    def triangle_positions(node):
+        geom = node.get_geom(0)
+        reader = core.GeomVertexReader(geom.get_vertex_data(), 'vertex')
+        verts = tuple(geom.get_primitive(0).get_vertex_list())
+        positions = []
+        for v in verts:
+            reader.set_row(v)
+            positions.append(tuple(reader.get_data3()))
+        return sorted(tuple(positions[i:i + 3]) for i in range(0, len(positions), 3))
+
+    before_positions = triangle_positions(node)
+
+    gr = core.SceneGraphReducer()
+    before = gr.calc_acmr(node)
+    gr.optimize_vertices(node)
+    assert gr.calc_acmr(node) < before
+    assert triangle_positions(node) == before_positions
+
+    # The vertices are now in the order in which they are first used.
+    verts = node.get_geom(0).get_primitive(0).get_vertex_list()
+    seen = []
+    for v in verts:
+        if v not in seen:
+            seen.append(v)
+    assert seen == list(range(len(seen)))
+
+
+def test_scene_graph_reducer_flatten_optimize_vertices():
+    vdata = core.GeomVertexData('grid', core.GeomVertexFormat.get_v3(), core.GeomEnums.UH_static)
+    prim = make_grid_triangles(8, vdata)
+    geom = core.Geom(vdata)
+    geom.add_primitive(prim)
+    node = core.GeomNode('grid')
+    node.add_geom(geom)
+    root = core.NodePath('root')
+    root.attach_new_node(node)
+    verts = tuple(prim.get_vertex_list())
+
+    # Passing all of the combine_siblings bits does not reorder the vertices.
+    gr = core.SceneGraphReducer()
+    gr.flatten(root.node(), ~0)
+    grid = root.find('**/+GeomNode').node()
+    assert tuple(grid.get_geom(0).get_primitive(0).get_vertex_list()) == verts
+
+    before = gr.calc_acmr(root.node())
+    gr.flatten(root.node(), 0, core.SceneGraphReducer.OV_vertex_cache)
+    assert gr.calc_acmr(root.node()) < before
+
+
+def test_geom_triangles_simplify():
+    size = 16
+    vdata = core.GeomVertexData('grid', core.GeomVertexFormat.get_v3(), core.GeomEnums.UH_static)
+    prim = make_grid_triangles(size, vdata)
+    assert prim.get_num_primitives() == size * size * 2
+
+    simple = prim.simplify(vdata, 100)
+    assert simple.get_num_primitives() < prim.get_num_primitives() // 2
+
+    # The grid is flat, so no error is introduced, and the border of the grid
+    # is kept intact.
+    used = set(simple.get_vertex_list())
+    for y in range(size + 1):
+        for x in range(size + 1):
+            if x in (0, size) or y in (0, size):
+                assert y * (size + 1) + x in used
+
+    # Nothing is collapsed if no error is allowed on a bumpy grid.  The bumps
+    # are random, so that no vertex lies in the plane of its neighbors.
+    import random
+    rng = random.Random(2)
+    writer = core.GeomVertexRewriter(vdata, 'vertex')
+    while not writer.is_at_end():
+        pos = writer.get_data3()
+        writer.set_data3(pos.x, pos.y, rng.random())
+    assert prim.simplify(vdata, 100, 0.0001) == prim
@@ -0,0 +1,83 @@
+from panda3d.core import GeomVertexArrayFormat, GeomVertexFormat, GeomVertexData
+from panda3d.core import GeomVertexAnimationSpec, GeomVertexReader, GeomVertexWriter
+from panda3d.core import TransformBlendTable, TransformBlend, UserVertexTransform
+from panda3d.core import Geom, InternalName, SparseArray, Thread, ConfigVariableInt
+from panda3d.core import LMatrix4, LVector3
+import pytest
+
+
+def make_skinned_vdata(num_rows, num_blends):
+    array = GeomVertexArrayFormat()
+    array.add_column("vertex", 3, Geom.NT_float32, Geom.C_point)
+    array.add_column("normal", 3, Geom.NT_float32, Geom.C_normal)
+    blend_array = GeomVertexArrayFormat()
+    blend_array.add_column(InternalName.get_transform_blend(), 1, Geom.NT_uint16, Geom.C_index)
+    format = GeomVertexFormat(array)
+    format.add_array(blend_array)
+    spec = GeomVertexAnimationSpec()
+    spec.set_panda()
+    format.set_animation(spec)
+    format = GeomVertexFormat.register_format(format)
+
+    table = TransformBlendTable()
+    transforms = []
+    for i in range(num_blends):
+        a = UserVertexTransform("a%d" % i)
+        b = UserVertexTransform("b%d" % i)
+        a.set_matrix(LMatrix4.translate_mat(i, 1, -i) * LMatrix4.rotate_mat(i * 10, (0, 0, 1)))
+        b.set_matrix(LMatrix4.scale_mat(1, 2, 0.5 + i))
+        table.add_blend(TransformBlend(a, 0.75, b, 0.25))
+        transforms += [a, b]
+    table.set_rows(SparseArray.range(0, num_rows))
+
+    vdata = GeomVertexData("test", format, Geom.UH_static)
+    vdata.set_transform_blend_table(table)
+    vdata.set_num_rows(num_rows)
+    vertex = GeomVertexWriter(vdata, 'vertex')
+    normal = GeomVertexWriter(vdata, 'normal')
+    blend = GeomVertexWriter(vdata, InternalName.get_transform_blend())
+    for i in range(num_rows):
+        vertex.set_data3(i * 0.5 - 3, i % 7, 1 - i * 0.25)
+        normal.set_data3(LVector3(i % 3 - 1, 1, i % 5).normalized())
+        blend.set_data1i((i // 5) % num_blends)
+    return vdata, table
+
+
+def check_animated(vdata, table):
+    animated = vdata.animate_vertices(True, Thread.get_current_thread())
+    assert animated != vdata
+
+    orig_vertex = GeomVertexReader(vdata, 'vertex')
+    orig_normal = GeomVertexReader(vdata, 'normal')
+    blend = GeomVertexReader(vdata, InternalName.get_transform_blend())
+    vertex = GeomVertexReader(animated, 'vertex')
+    normal = GeomVertexReader(animated, 'normal')
+    while not orig_vertex.is_at_end():
+        mat = LMatrix4()
+        table.get_blend(blend.get_data1i()).get_blend(mat, Thread.get_current_thread())
+        expected = mat.xform_point(orig_vertex.get_data3())
+        assert (vertex.get_data3() - expected).length() < 1e-4
+
+        inv = LMatrix4(mat)
+        inv.invert_in_place()
+        inv.transpose_in_place()
+        expected = inv.xform_vec(orig_normal.get_data3()).normalized()
+        assert (normal.get_data3() - expected).length() < 1e-4
+
+
+def test_animate_vertices():
+    vdata, table = make_skinned_vdata(100, 3)
+    check_animated(vdata, table)
+
+
+def test_animate_vertices_threaded():
+    num_threads = ConfigVariableInt("skinning-num-threads")
+    min_vertices = ConfigVariableInt("skinning-parallel-min-vertices")
+    num_threads.set_value(3)
+    min_vertices.set_value(1)
+    try:
+        vdata, table = make_skinned_vdata(1000, 4)
+        check_animated(vdata, table)
+    finally:
+        num_threads.clear_local_value()
+        min_vertices.clear_local_value()
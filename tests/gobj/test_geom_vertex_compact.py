@@ -0,0 +1,154 @@
+from panda3d.core import GeomVertexArrayFormat, GeomVertexFormat, GeomVertexData, Geom, GeomNode
+from panda3d.core import GeomVertexReader, GeomVertexWriter, GeomTriangles
+from panda3d.core import SceneGraphReducer, NodePath, LVector3
+import pytest
+
+
+def make_vdata(num_rows=16):
+    array = GeomVertexArrayFormat()
+    array.add_column("vertex", 3, Geom.NT_float32, Geom.C_point)
+    array.add_column("normal", 3, Geom.NT_float32, Geom.C_normal)
+    array.add_column("texcoord", 2, Geom.NT_float32, Geom.C_texcoord)
+    format = GeomVertexFormat.register_format(GeomVertexFormat(array))
+
+    vdata = GeomVertexData("test", format, Geom.UH_static)
+    vdata.set_num_rows(num_rows)
+    vertex = GeomVertexWriter(vdata, 'vertex')
+    normal = GeomVertexWriter(vdata, 'normal')
+    texcoord = GeomVertexWriter(vdata, 'texcoord')
+    for i in range(num_rows):
+        vertex.set_data3(i * 0.5 - 3, i * 0.25, 10 - i)
+        normal.set_data3(LVector3(i - 7.5, 2 - i % 5, (i % 3) - 1).normalized())
+        texcoord.set_data2(i / 16.0, 1 - i / 32.0)
+    return vdata
+
+
+def test_half_float_column():
+    array = GeomVertexArrayFormat()
+    array.add_column("texcoord", 2, Geom.NT_float16, Geom.C_texcoord)
+    assert array.get_stride() == 4
+
+    format = GeomVertexFormat.register_format(GeomVertexFormat(array))
+    vdata = GeomVertexData("test", format, Geom.UH_static)
+    vdata.set_num_rows(3)
+
+    writer = GeomVertexWriter(vdata, 'texcoord')
+    writer.set_data2(0.5, -2)
+    writer.set_data2(1 / 3.0, 65504)
+    writer.set_data2(1e-6, 1e6)
+
+    reader = GeomVertexReader(vdata, 'texcoord')
+    assert reader.get_data2() == (0.5, -2)
+    u, v = reader.get_data2()
+    assert u == pytest.approx(1 / 3.0, rel=1e-3)
+    assert v == 65504
+    u, v = reader.get_data2()
+    assert u == pytest.approx(1e-6, rel=5e-2)
+    assert v == float('inf')
+
+
+def test_oct16_normal_column():
+    array = GeomVertexArrayFormat()
+    array.add_column("normal", 1, Geom.NT_packed_oct16, Geom.C_normal)
+    assert array.get_stride() == 4
+
+    format = GeomVertexFormat.register_format(GeomVertexFormat(array))
+    vdata = GeomVertexData("test", format, Geom.UH_static)
+
+    normals = [(0, 0, 1), (0, 0, -1), (1, 0, 0), (0, -1, 0),
+               LVector3(1, 2, -3).normalized(), LVector3(-4, 1, 0.5).normalized()]
+    vdata.set_num_rows(len(normals))
+    writer = GeomVertexWriter(vdata, 'normal')
+    for normal in normals:
+        writer.set_data3(normal)
+
+    reader = GeomVertexReader(vdata, 'normal')
+    for normal in normals:
+        result = reader.get_data3()
+        assert result.length() == pytest.approx(1)
+        assert result.dot(normal) > 0.9999
+
+
+def test_compact_format():
+    vdata = make_vdata()
+    format = vdata.get_format().get_compact_format()
+    assert format.is_registered()
+
+    assert format.get_column('vertex').get_numeric_type() == Geom.NT_float32
+    assert format.get_column('normal').get_numeric_type() == Geom.NT_packed_oct16
+    assert format.get_column('texcoord').get_numeric_type() == Geom.NT_float16
+    assert format.get_array(0).get_stride() == 12 + 4 + 4
+
+    # Converting to a compact format, and back again.
+    compact = vdata.convert_to(format)
+    restored = compact.convert_to(vdata.get_format())
+
+    for name in ('vertex', 'normal', 'texcoord'):
+        orig = GeomVertexReader(vdata, name)
+        new = GeomVertexReader(restored, name)
+        while not orig.is_at_end():
+            a = orig.get_data3()
+            b = new.get_data3()
+            assert (a - b).length() < 1e-3
+
+
+def test_compact_vertices():
+    vdata = make_vdata()
+    tris = GeomTriangles(Geom.UH_static)
+    for i in range(0, 15, 3):
+        tris.add_vertices(i, i + 1, i + 2)
+    geom = Geom(vdata)
+    geom.add_primitive(tris)
+    node = GeomNode('gnode')
+    node.add_geom(geom)
+    root = NodePath('root')
+    path = root.attach_new_node(node)
+    path.set_pos(1, 2, 3)
+
+    bounds = path.get_tight_bounds(root)
+
+    gr = SceneGraphReducer()
+    assert gr.compact_vertices(root.node(), SceneGraphReducer.CV_attributes |
+                                            SceneGraphReducer.CV_positions) == 2
+
+    new_vdata = node.get_geom(0).get_vertex_data()
+    new_format = new_vdata.get_format()
+    assert new_format.get_column('vertex').get_numeric_type() == Geom.NT_int16
+    assert new_format.get_column('normal').get_numeric_type() == Geom.NT_packed_oct16
+    assert new_format.get_array(0).get_stride() == 8 + 4 + 4
+
+    # The positions are the same, once the new transform is applied.
+    mat = path.get_mat(root)
+    orig = GeomVertexReader(vdata, 'vertex')
+    new = GeomVertexReader(new_vdata, 'vertex')
+    while not orig.is_at_end():
+        a = orig.get_data3() + LVector3(1, 2, 3)
+        b = mat.xform_point(new.get_data3())
+        assert (a - b).length() < 1e-3
+
+    new_bounds = path.get_tight_bounds(root)
+    assert (new_bounds[0] - bounds[0]).length() < 1e-3
+    assert (new_bounds[1] - bounds[1]).length() < 1e-3
+
+
+def test_compact_vertices_default():
+    # By default, the positions and the transforms are left alone.
+    vdata = make_vdata()
+    tris = GeomTriangles(Geom.UH_static)
+    tris.add_vertices(0, 1, 2)
+    geom = Geom(vdata)
+    geom.add_primitive(tris)
+    node = GeomNode('gnode')
+    node.add_geom(geom)
+    root = NodePath('root')
+    path = root.attach_new_node(node)
+    path.set_pos(1, 2, 3)
+    mat = path.get_mat(root)
+
+    gr = SceneGraphReducer()
+    assert gr.compact_vertices(root.node()) == 1
+
+    new_format = node.get_geom(0).get_vertex_data().get_format()
+    assert new_format.get_column('vertex').get_numeric_type() == Geom.NT_float32
+    assert new_format.get_column('normal').get_numeric_type() == Geom.NT_packed_oct16
+    assert path.get_mat(root) == mat
@@ -1,4 +1,4 @@
-from panda3d.core import Texture, PNMImage, LColor
+from panda3d.core import Texture, PNMImage, LColor, ConfigVariableInt
 from array import array
 import math
 
@@ -134,3 +134,122 @@ def test_texture_clear_half():
     assert col.y == -inf
     assert col.z == -inf
     assert math.isnan(col.w)
+
+
+def make_test_texture(x_size, y_size, num_components, pages=1):
+    formats = {1: Texture.F_red, 2: Texture.F_rg, 3: Texture.F_rgb, 4: Texture.F_rgba}
+    tex = Texture("")
+    if pages == 1:
+        tex.setup_2d_texture(x_size, y_size, Texture.T_unsigned_byte, formats[num_components])
+    else:
+        tex.setup_2d_texture_array(x_size, y_size, pages, Texture.T_unsigned_byte, formats[num_components])
+    tex.set_minfilter(Texture.FT_linear_mipmap_linear)
+
+    data = bytearray()
+    for z in range(pages):
+        for y in range(y_size):
+            for x in range(x_size):
+                for c in range(num_components):
+                    data.append((x * 7 + y * 3 + z * 11 + c * 50) & 0xff)
+    tex.set_ram_image(bytes(data))
+    return tex, bytes(data)
+
+
+def process_in_parallel(func):
+    """ Calls func with texture-process-threads set, and returns the result. """
+
+    num_threads = ConfigVariableInt("texture-process-threads")
+    min_pixels = ConfigVariableInt("texture-parallel-min-pixels")
+    num_threads.set_value(3)
+    min_pixels.set_value(1)
+    try:
+        return func()
+    finally:
+        num_threads.clear_local_value()
+        min_pixels.clear_local_value()
+
+
+def decode_bc1_color(block):
+    c0 = block[0] | (block[1] << 8)
+    c1 = block[2] | (block[3] << 8)
+    palette = []
+    for c in (c0, c1):
+        r, g, b = c >> 11, (c >> 5) & 0x3f, c & 0x1f
+        palette.append(((r << 3) | (r >> 2), (g << 2) | (g >> 4), (b << 3) | (b >> 2)))
+    indices = block[4] | (block[5] << 8) | (block[6] << 16) | (block[7] << 24)
+    colors = []
+    for i in range(16):
+        index = (indices >> (i * 2)) & 3
+        if index < 2:
+            colors.append(palette[index])
+        elif index == 2 and c0 > c1:
+            colors.append(tuple((2 * a + b) // 3 for a, b in zip(*palette)))
+        elif index == 3 and c0 > c1:
+            colors.append(tuple((a + 2 * b) // 3 for a, b in zip(*palette)))
+        elif index == 2:
+            colors.append(tuple((a + b) // 2 for a, b in zip(*palette)))
+        else:
+            colors.append(None)
+    return colors
+
+
+def test_texture_generate_mipmaps():
+    tex, data = make_test_texture(33, 20, 4)
+    tex.generate_ram_mipmap_images()
+    assert tex.get_num_ram_mipmap_images() == 6
+
+    level1 = bytes(tex.get_ram_mipmap_image(1))
+    assert len(level1) == 16 * 10 * 4
+    for c in range(4):
+        # The average of the top-left 2x2 block of the original image.
+        expected = (data[c] + data[4 + c] + data[33 * 4 + c] + data[34 * 4 + c]) >> 2
+        assert level1[c] == expected
+
+    threaded, data = make_test_texture(33, 20, 4)
+    process_in_parallel(threaded.generate_ram_mipmap_images)
+    for n in range(tex.get_num_ram_mipmap_images()):
+        assert bytes(threaded.get_ram_mipmap_image(n)) == bytes(tex.get_ram_mipmap_image(n))
+
+
+def test_texture_compress_rgtc():
+    tex, data = make_test_texture(13, 7, 2)
+    assert tex.compress_ram_image(Texture.CM_rgtc)
+    assert tex.get_ram_image_compression() == Texture.CM_rgtc
+    assert len(tex.get_ram_image()) == 4 * 2 * 16
+
+    assert tex.uncompress_ram_image()
+    result = bytes(tex.get_ram_image())
+    assert len(result) == len(data)
+    assert max(abs(a - b) for a, b in zip(result, data)) <= 8
+
+
+def test_texture_compress_dxt1():
+    tex = Texture("")
+    tex.setup_2d_texture(6, 5, Texture.T_unsigned_byte, Texture.F_rgb)
+    tex.set_ram_image(b"\x00\x00\xff" * 30)
+    assert tex.compress_ram_image(Texture.CM_dxt1)
+    assert tex.get_ram_image_compression() == Texture.CM_dxt1
+
+    image = bytes(tex.get_ram_image())
+    assert len(image) == 2 * 2 * 8
+    for b in range(4):
+        assert decode_bc1_color(image[b * 8:b * 8 + 8]) == [(255, 0, 0)] * 16
+
+
+def test_texture_compress_dxt5():
+    tex, data = make_test_texture(16, 16, 4)
+    assert tex.compress_ram_image(Texture.CM_dxt5)
+    assert tex.get_ram_image_compression() == Texture.CM_dxt5
+    assert len(tex.get_ram_image()) == 4 * 4 * 16
+
+
+def test_texture_compress_parallel():
+    for mode, num_components, pages in ((Texture.CM_rgtc, 1, 3), (Texture.CM_dxt5, 4, 1)):
+        tex, data = make_test_texture(64, 64, num_components, pages)
+        assert tex.compress_ram_image(mode)
+
+        threaded, data = make_test_texture(64, 64, num_components, pages)
+        assert process_in_parallel(lambda: threaded.compress_ram_image(mode))
+        assert threaded.get_num_ram_mipmap_images() == tex.get_num_ram_mipmap_images()
+        for n in range(tex.get_num_ram_mipmap_images()):
+            assert bytes(threaded.get_ram_mipmap_image(n)) == bytes(tex.get_ram_mipmap_image(n))
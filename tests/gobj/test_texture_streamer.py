@@ -0,0 +1,95 @@
+from panda3d.core import Texture, TextureStreamer, SamplerState, PNMImage, Filename
+import pytest
+
+
+@pytest.fixture
+def streamed_texture(tmp_path):
+    image = PNMImage(256, 256, 3)
+    image.fill(0.25, 0.5, 0.75)
+    path = Filename.from_os_specific(str(tmp_path / "streamed.png"))
+    assert image.write(path)
+
+    tex = Texture("streamed")
+    assert tex.read(path)
+    tex.set_minfilter(SamplerState.FT_linear_mipmap_linear)
+
+    streamer = TextureStreamer.get_global_ptr()
+    budget = streamer.memory_budget
+    assert streamer.add_texture(tex)
+    yield tex
+    streamer.remove_texture(tex)
+    streamer.memory_budget = budget
+
+
+def test_texture_streamer_ineligible():
+    tex = Texture("not streamed")
+    tex.setup_2d_texture(256, 256, Texture.T_unsigned_byte, Texture.F_rgb)
+    tex.set_minfilter(SamplerState.FT_linear_mipmap_linear)
+    assert not TextureStreamer.get_global_ptr().add_texture(tex)
+    assert not tex.is_streamed()
+
+
+def test_texture_streamer_tail(streamed_texture):
+    tex = streamed_texture
+    assert tex.is_streamed()
+    assert tex.x_size == 64
+    assert tex.y_size == 64
+    assert tex.stream_level == 2
+    assert tex.get_ram_image_size() == 64 * 64 * 3
+
+
+def test_texture_streamer_upgrade(streamed_texture):
+    tex = streamed_texture
+    streamer = TextureStreamer.get_global_ptr()
+    streamer.request_screen_size(tex, 512)
+    streamer.update()
+    streamer.wait_pending()
+
+    assert tex.stream_level == 0
+    assert tex.x_size == 256
+    assert tex.y_size == 256
+    assert tex.has_ram_image()
+    assert tex.get_ram_image_size() == 256 * 256 * 3
+
+    # A medium size on screen only needs the second level.
+    streamer.request_screen_size(tex, 128)
+    streamer.update()
+    streamer.wait_pending()
+    assert tex.stream_level == 1
+    assert tex.x_size == 128
+
+
+def test_texture_streamer_budget(streamed_texture):
+    tex = streamed_texture
+    streamer = TextureStreamer.get_global_ptr()
+    streamer.request_screen_size(tex, 512)
+    streamer.update()
+    streamer.wait_pending()
+    assert tex.x_size == 256
+
+    # Shrink the budget so that only the mipmap tail fits.
+    streamer.memory_budget = 64 * 64 * 3 * 2
+    streamer.request_screen_size(tex, 512)
+    streamer.update()
+    streamer.wait_pending()
+    assert tex.stream_level == 2
+    assert tex.x_size == 64
+    assert streamer.resident_size <= streamer.memory_budget
+
+
+def test_texture_streamer_load_failure(streamed_texture, tmp_path):
+    tex = streamed_texture
+    streamer = TextureStreamer.get_global_ptr()
+
+    # The file is gone, so the texture can't be reloaded at a higher level.
+    (tmp_path / "streamed.png").unlink()
+    streamer.request_screen_size(tex, 512)
+    streamer.update()
+    streamer.wait_pending()
+    assert tex.stream_level == 2
+
+    # It is not tried again.
+    streamer.request_screen_size(tex, 512)
+    streamer.update()
+    assert streamer.num_pending == 0
+    assert tex.stream_level == 2
@@ -0,0 +1,77 @@
+from panda3d.core import VertexDataBook, GeomVertexArrayData, GeomVertexArrayFormat, Geom
+
+
+def test_vertex_data_book_size_class():
+    assert VertexDataBook.get_size_class(1) == 16
+    assert VertexDataBook.get_size_class(100) == 112
+    assert VertexDataBook.get_size_class(256) == 256
+    assert VertexDataBook.get_size_class(257) == 288
+    assert VertexDataBook.get_size_class(4096) == 4096
+    assert VertexDataBook.get_size_class(4097) == 4608
+
+    for size in range(1, 70000, 37):
+        size_class = VertexDataBook.get_size_class(size)
+        assert size <= size_class <= size * 1.125 + 15
+
+
+def test_vertex_data_book_compact():
+    book = VertexDataBook(4096)
+    blocks = [book.alloc(100) for i in range(100)]
+    assert blocks[0].get_size() == VertexDataBook.get_size_class(100)
+    assert book.count_wasted_size() == 0
+    assert book.get_fragmentation() == 0
+
+    # Free every other block, leaving gaps throughout the pages.
+    del blocks[::2]
+    assert book.count_wasted_size() > 0
+    assert book.get_fragmentation() > 0
+
+    num_pages = book.get_num_pages()
+    allocated = book.count_allocated_size()
+    assert book.defragment(1 << 20) > 0
+    assert book.count_wasted_size() == 0
+    assert book.get_fragmentation() == 0
+    assert book.count_allocated_size() == allocated
+    assert book.get_num_pages() <= num_pages
+
+
+def test_vertex_data_book_evacuate():
+    book = VertexDataBook(4096)
+    blocks = [book.alloc(256) for i in range(64)]
+    num_pages = book.get_num_pages()
+    assert num_pages > 1
+
+    # Leave only one block in each page but the last.
+    keep = []
+    for block in blocks:
+        if block.get_page() not in [b.get_page() for b in keep] or \
+           block.get_page() == blocks[-1].get_page():
+            keep.append(block)
+    del blocks
+
+    assert book.get_num_pages() == num_pages
+    book.defragment(1 << 20)
+    assert book.get_num_pages() < num_pages
+    assert book.count_wasted_size() == 0
+    for block in keep:
+        assert block.get_page() is not None
+
+
+def test_vertex_data_book_defragment_global():
+    book = GeomVertexArrayData.get_book()
+    format = GeomVertexArrayFormat("vertex", 3, Geom.NT_uint8, Geom.C_point)
+
+    arrays = []
+    for i in range(40):
+        array = GeomVertexArrayData(format, Geom.UH_static)
+        contents = bytes((i + j * 3) % 251 for j in range(3000 + i * 30))
+        array.modify_handle().copy_data_from(contents)
+        array.evict_lru()
+        arrays.append((array, contents))
+
+    # Release half of them, then move the rest around.
+    del arrays[::2]
+    book.defragment(1 << 24)
+
+    for array, contents in arrays:
+        assert bytes(array.get_handle().get_data()) == contents
@@ -0,0 +1,50 @@
+from panda3d.core import GeomVertexArrayData, GeomVertexArrayFormat
+from panda3d.core import VertexDataPage, Geom, load_prc_file_data, unload_prc_file
+import pytest
+
+
+METHODS = [VertexDataPage.CM_none, VertexDataPage.CM_zlib,
+           VertexDataPage.CM_lz4, VertexDataPage.CM_zstd]
+METHOD_NAMES = {
+    VertexDataPage.CM_none: "none",
+    VertexDataPage.CM_zlib: "zlib",
+    VertexDataPage.CM_lz4: "lz4",
+    VertexDataPage.CM_zstd: "zstd",
+}
+
+
+def test_compression_method_fallback():
+    assert VertexDataPage.has_compression_method(VertexDataPage.CM_none)
+    method = VertexDataPage.get_compression_method()
+    assert VertexDataPage.has_compression_method(method)
+
+
+@pytest.mark.parametrize("method", METHODS)
+def test_compress_page_round_trip(method):
+    if not VertexDataPage.has_compression_method(method):
+        pytest.skip("%s not available" % METHOD_NAMES[method])
+
+    page = load_prc_file_data("", "vertex-data-compression-method %s" % METHOD_NAMES[method])
+
+    compressed_lru = VertexDataPage.get_global_lru(VertexDataPage.RC_compressed)
+    resident_lru = VertexDataPage.get_global_lru(VertexDataPage.RC_resident)
+    orig_max_size = compressed_lru.get_max_size()
+    compressed_lru.set_max_size(1 << 30)
+
+    try:
+        format = GeomVertexArrayFormat("vertex", 3, Geom.NT_uint8, Geom.C_point)
+        array = GeomVertexArrayData(format, Geom.UH_static)
+        contents = bytes((i * 7) % 13 for i in range(30000))
+        array.modify_handle().copy_data_from(contents)
+
+        # Page the array out of its independent buffer into the book, and
+        # compress all of the resident pages.
+        array.evict_lru()
+        resident_lru.evict_to(0)
+        book = GeomVertexArrayData.get_book()
+        assert book.count_allocated_size(VertexDataPage.RC_compressed) > 0
+
+        assert bytes(array.get_handle().get_data()) == contents
+    finally:
+        compressed_lru.set_max_size(orig_max_size)
+        unload_prc_file(page)
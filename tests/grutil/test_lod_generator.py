@@ -0,0 +1,70 @@
+from panda3d import core
+
+
+def make_sphere(segments=24):
+    import math
+    vdata = core.GeomVertexData('sphere', core.GeomVertexFormat.get_v3(), core.GeomEnums.UH_static)
+    writer = core.GeomVertexWriter(vdata, 'vertex')
+    rings = segments // 2
+    for r in range(rings + 1):
+        phi = math.pi * r / rings
+        for s in range(segments + 1):
+            theta = 2 * math.pi * s / segments
+            writer.add_data3(math.sin(phi) * math.cos(theta),
+                             math.sin(phi) * math.sin(theta),
+                             math.cos(phi))
+
+    prim = core.GeomTriangles(core.GeomEnums.UH_static)
+    for r in range(rings):
+        for s in range(segments):
+            v = r * (segments + 1) + s
+            prim.add_vertices(v, v + segments + 1, v + segments + 2)
+            prim.add_vertices(v, v + segments + 2, v + 1)
+
+    geom = core.Geom(vdata)
+    geom.add_primitive(prim)
+    node = core.GeomNode('sphere')
+    node.add_geom(geom)
+    return core.NodePath(node)
+
+
+def count_triangles(np):
+    total = 0
+    for node in np.find_all_matches('**/+GeomNode'):
+        for geom in node.node().get_geoms():
+            for prim in geom.get_primitives():
+                total += prim.decompose().get_num_primitives()
+    return total
+
+
+def test_lod_generator():
+    model = make_sphere()
+    model.set_pos(1, 2, 3)
+    source_triangles = count_triangles(model)
+
+    gen = core.LODGenerator()
+    gen.num_levels = 3
+    lod_np = gen.generate(model)
+    lod = lod_np.node()
+    assert lod.is_of_type(core.LODNode)
+    assert lod.get_num_children() == 3
+    assert lod.get_num_switches() == 3
+    assert lod.get_center().almost_equal((1, 2, 3))
+
+    # Each level has fewer triangles, with an increasing error.
+    counts = [count_triangles(lod_np.get_child(i)) for i in range(3)]
+    assert counts[0] == source_triangles
+    assert counts[1] < counts[0]
+    assert counts[2] < counts[1]
+    assert gen.get_level_error(0) == 0
+    assert gen.get_level_error(1) <= gen.get_level_error(2)
+
+    # The switch distances are contiguous and increasing.
+    assert lod.get_out(0) == 0
+    for i in range(3):
+        assert lod.get_in(i) > lod.get_out(i)
+    for i in range(1, 3):
+        assert lod.get_out(i) == lod.get_in(i - 1)
+
+    # The original model is not modified.
+    assert count_triangles(model) == source_triangles
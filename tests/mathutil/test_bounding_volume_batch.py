@@ -0,0 +1,82 @@
+from panda3d.core import BoundingVolumeBatch, BoundingVolume
+from panda3d.core import BoundingHexahedron, BoundingSphere, BoundingBox
+from panda3d.core import BoundingPlane, OmniBoundingVolume
+import random
+
+
+def make_frustum():
+    return BoundingHexahedron((-10, 10, -10), (10, 10, -10),
+                              (10, 10, 10), (-10, 10, 10),
+                              (-1, 1, -1), (1, 1, -1),
+                              (1, 1, 1), (-1, 1, 1))
+
+
+def make_volumes(count):
+    rand = random.Random(42)
+    volumes = []
+    for i in range(count):
+        center = (rand.uniform(-15, 15), rand.uniform(-2, 15), rand.uniform(-15, 15))
+        size = rand.uniform(0.1, 3)
+        if i % 2 == 0:
+            volumes.append(BoundingSphere(center, size))
+        else:
+            volumes.append(BoundingBox(
+                (center[0] - size, center[1] - size * 0.5, center[2] - size * 2),
+                (center[0] + size, center[1] + size * 0.5, center[2] + size * 2)))
+    return volumes
+
+
+def test_bounding_volume_batch_frustum():
+    frustum = make_frustum()
+    volumes = make_volumes(103)
+
+    batch = BoundingVolumeBatch()
+    for volume in volumes:
+        batch.add_volume(volume)
+    assert batch.get_num_volumes() == len(volumes)
+
+    expected = [frustum.contains(volume) for volume in volumes]
+
+    # Make sure we're testing all of the cases.
+    assert BoundingVolume.IF_no_intersection in expected
+    assert BoundingVolume.IF_possible | BoundingVolume.IF_some in expected
+    assert BoundingVolume.IF_possible | BoundingVolume.IF_some | BoundingVolume.IF_all in expected
+
+    batch.compute_contains(frustum)
+    assert [batch.get_result(i) for i in range(len(volumes))] == expected
+
+    batch.compute_contains_scalar(frustum)
+    assert [batch.get_result(i) for i in range(len(volumes))] == expected
+
+
+def test_bounding_volume_batch_fallback():
+    frustum = make_frustum()
+    volumes = make_volumes(10)
+    volumes.insert(3, OmniBoundingVolume())
+    volumes.insert(7, BoundingSphere())
+    volumes.append(BoundingPlane((0, 0, 1, 0)))
+
+    batch = BoundingVolumeBatch()
+    for volume in volumes:
+        batch.add_volume(volume)
+
+    batch.compute_contains(frustum)
+    for i, volume in enumerate(volumes):
+        assert batch.get_result(i) == frustum.contains(volume)
+
+    # Test against something other than a hexahedron.
+    sphere = BoundingSphere((0, 5, 0), 4)
+    batch.compute_contains(sphere)
+    for i, volume in enumerate(volumes):
+        assert batch.get_result(i) == sphere.contains(volume)
+
+
+def test_bounding_volume_batch_clear():
+    batch = BoundingVolumeBatch()
+    batch.add_volume(BoundingSphere((0, 5, 0), 1))
+    batch.clear()
+    assert batch.get_num_volumes() == 0
+
+    batch.add_volume(BoundingSphere((0, -5, 0), 1))
+    batch.compute_contains(make_frustum())
+    assert batch.get_result(0) == BoundingVolume.IF_no_intersection
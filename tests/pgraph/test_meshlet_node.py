@@ -0,0 +1,82 @@
+from panda3d import core
+import math
+
+
+def make_sphere_node(segments=32):
+    vdata = core.GeomVertexData('sphere', core.GeomVertexFormat.get_v3(), core.GeomEnums.UH_static)
+    writer = core.GeomVertexWriter(vdata, 'vertex')
+    rings = segments // 2
+    for r in range(rings + 1):
+        phi = math.pi * r / rings
+        for s in range(segments + 1):
+            theta = 2 * math.pi * s / segments
+            writer.add_data3(math.sin(phi) * math.cos(theta),
+                             math.sin(phi) * math.sin(theta),
+                             math.cos(phi))
+
+    prim = core.GeomTriangles(core.GeomEnums.UH_static)
+    for r in range(rings):
+        for s in range(segments):
+            v = r * (segments + 1) + s
+            prim.add_vertices(v, v + segments + 2, v + segments + 1)
+            prim.add_vertices(v, v + 1, v + segments + 2)
+
+    geom = core.Geom(vdata)
+    geom.add_primitive(prim)
+    node = core.GeomNode('sphere')
+    node.add_geom(geom)
+    return node
+
+
+def triangle_set(node):
+    tris = set()
+    for geom in node.get_geoms():
+        for prim in geom.get_primitives():
+            verts = list(prim.get_vertex_list())
+            for i in range(0, len(verts), 3):
+                tris.add(tuple(verts[i:i + 3]))
+    return tris
+
+
+def test_make_meshlets():
+    root = core.NodePath('root')
+    np = root.attach_new_node(make_sphere_node())
+    np.set_pos(1, 2, 3)
+    before = triangle_set(np.node())
+
+    gr = core.SceneGraphReducer()
+    assert gr.make_meshlets(root.node(), 64) == 1
+
+    node = np.node()
+    assert node.is_of_type(core.MeshletNode)
+    assert node.name == 'sphere'
+    assert np.get_pos() == (1, 2, 3)
+    assert node.get_num_geoms() > 1
+    assert node.get_num_clusters() == node.get_num_geoms()
+    assert triangle_set(node) == before
+
+    num_cones = 0
+    for i in range(node.get_num_geoms()):
+        assert node.get_geom(i).get_primitive(0).get_num_primitives() <= 64
+        assert node.get_cluster_radius(i) > 0
+        if node.has_cluster_cone(i):
+            num_cones += 1
+            assert node.get_cluster_cone_cutoff(i) < 1
+    assert num_cones > 0
+
+    # Small GeomNodes are left alone.
+    assert gr.make_meshlets(root.node(), 100000) == 0
+
+
+def test_meshlet_node_bam():
+    node = core.MeshletNode('sphere')
+    node.add_clusters_from(make_sphere_node(), 64)
+    data = node.encode_to_bam_stream()
+    copy = core.PandaNode.decode_from_bam_stream(data)
+
+    assert copy.is_of_type(core.MeshletNode)
+    assert copy.get_num_clusters() == node.get_num_clusters()
+    for i in range(node.get_num_clusters()):
+        assert copy.get_cluster_center(i).almost_equal(node.get_cluster_center(i))
+        assert copy.has_cluster_cone(i) == node.has_cluster_cone(i)
+        assert copy.get_cluster_cone_axis(i).almost_equal(node.get_cluster_cone_axis(i))
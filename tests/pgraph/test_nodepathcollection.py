@@ -0,0 +1,69 @@
+from panda3d.core import NodePath, NodePathCollection
+from panda3d.core import PTA_LVecBase3f, PTA_LMatrix4f, Mat4, Vec3
+
+
+def make_collection(parent, count):
+    paths = NodePathCollection()
+    for i in range(count):
+        group = parent.attach_new_node("group%d" % (i % 3))
+        paths.add_path(group.attach_new_node("node%d" % i))
+    return paths
+
+
+def test_nodepathcollection_set_pos_hpr_scale():
+    root = NodePath("root")
+    paths = make_collection(root, 10)
+
+    pos = PTA_LVecBase3f()
+    hpr = PTA_LVecBase3f()
+    scale = PTA_LVecBase3f()
+    for i in range(10):
+        pos.push_back(Vec3(i, i * 2, -i))
+        hpr.push_back(Vec3(i * 10, 0, 0))
+        scale.push_back(Vec3(1, 1, 1 + i))
+
+    # The first path gets the identity transform.
+    pos[0] = Vec3(0)
+    scale[0] = Vec3(1)
+
+    paths.set_pos_hpr_scale(pos, hpr, scale)
+
+    for i, path in enumerate(paths):
+        expected = NodePath("expected")
+        expected.set_pos_hpr_scale(pos[i], hpr[i], scale[i])
+        assert path.get_transform() == expected.get_transform()
+
+    assert paths[0].get_transform().is_identity()
+
+
+def test_nodepathcollection_set_mats():
+    root = NodePath("root")
+    paths = make_collection(root, 5)
+
+    mats = PTA_LMatrix4f()
+    for i in range(5):
+        mats.push_back(Mat4.translate_mat(i, 0, 0) * Mat4.scale_mat(i + 1))
+
+    paths.set_mats(mats)
+
+    for i, path in enumerate(paths):
+        assert path.get_mat() == Mat4(mats[i])
+        assert path.node().get_prev_transform() == path.get_transform()
+
+
+def test_nodepathcollection_set_mats_empty():
+    root = NodePath("root")
+    paths = make_collection(root, 3)
+    paths.add_path(NodePath())
+    node = root.attach_new_node("last")
+    paths.add_path(node)
+
+    mats = PTA_LMatrix4f()
+    for i in range(5):
+        mats.push_back(Mat4.translate_mat(i, 0, 0))
+
+    # The empty path is skipped, and the others still get their transforms.
+    paths.set_mats(mats)
+    assert paths[0].get_mat() == Mat4.ident_mat()
+    assert paths[2].get_mat() == Mat4.translate_mat(2, 0, 0)
+    assert node.get_mat() == Mat4.translate_mat(4, 0, 0)
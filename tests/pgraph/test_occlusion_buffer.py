@@ -0,0 +1,57 @@
+from panda3d.core import OcclusionBuffer, Mat4, Point3, BoundingBox
+
+
+def make_buffer():
+    # With an identity matrix, the points are given directly in clip space.
+    buffer = OcclusionBuffer(64, 32)
+    buffer.clear(Mat4.ident_mat())
+    buffer.draw_triangle((-0.5, -0.5, 0), (0.5, -0.5, 0), (0.5, 0.5, 0), Mat4.ident_mat())
+    buffer.draw_triangle((-0.5, -0.5, 0), (0.5, 0.5, 0), (-0.5, 0.5, 0), Mat4.ident_mat())
+    buffer.build_hierarchy()
+    return buffer
+
+
+def test_occlusion_buffer_size():
+    buffer = OcclusionBuffer(30, 20)
+    assert buffer.x_size == 32
+    assert buffer.y_size == 20
+
+
+def test_occlusion_buffer_draw():
+    buffer = make_buffer()
+    assert buffer.get_num_triangles() == 2
+
+    # The middle is covered, the corners are not.
+    assert buffer.get_depth(32, 16) < 0.1
+    assert buffer.get_depth(0, 0) > 1000
+    assert buffer.get_depth(63, 31) > 1000
+
+
+def test_occlusion_buffer_occluded():
+    buffer = make_buffer()
+    mat = Mat4.ident_mat()
+
+    # Behind the occluder.
+    assert buffer.is_box_occluded((-0.2, -0.2, 0.5), (0.2, 0.2, 0.6), mat)
+
+    # In front of the occluder.
+    assert not buffer.is_box_occluded((-0.2, -0.2, -0.6), (0.2, 0.2, -0.5), mat)
+
+    # Intersecting the occluder.
+    assert not buffer.is_box_occluded((-0.2, -0.2, -0.1), (0.2, 0.2, 0.1), mat)
+
+    # Sticking out from behind the occluder.
+    assert not buffer.is_box_occluded((0.3, -0.2, 0.5), (0.7, 0.2, 0.6), mat)
+
+
+def test_occlusion_buffer_bounds():
+    buffer = make_buffer()
+    mat = Mat4.ident_mat()
+
+    assert buffer.is_occluded(BoundingBox((-0.2, -0.2, 0.5), (0.2, 0.2, 0.6)), mat)
+    assert not buffer.is_occluded(BoundingBox((-0.2, -0.2, -0.6), (0.2, 0.2, -0.5)), mat)
+
+    # Nothing is occluded after clearing the buffer.
+    buffer.clear(mat)
+    buffer.build_hierarchy()
+    assert not buffer.is_occluded(BoundingBox((-0.2, -0.2, 0.5), (0.2, 0.2, 0.6)), mat)
@@ -1,4 +1,4 @@
-from panda3d.core import TransformState, Mat4, Mat3
+from panda3d.core import TransformState, Mat4, Mat3, ConfigVariableInt
 
 
 def test_transform_identity():
@@ -66,3 +66,28 @@ def test_transform_invalid():
 
     state2 = TransformState.make_invalid()
     assert state.this == state2.this
+
+
+def test_transform_garbage_collect_budget():
+    budget = ConfigVariableInt('garbage-collect-states-budget')
+    budget.set_value(10)
+    try:
+        TransformState.garbage_collect()
+
+        # Create a bunch of states, which are immediately released.
+        num_states = TransformState.get_num_states()
+        for i in range(50):
+            TransformState.make_pos((i + 0.5, 1234.5, 0))
+        assert TransformState.get_num_states() >= num_states + 50
+
+        # They should be freed a few at a time.
+        total = 0
+        for i in range(20):
+            freed = TransformState.garbage_collect()
+            assert freed <= 10
+            total += freed
+
+        assert total >= 50
+        assert TransformState.get_num_states() <= num_states
+    finally:
+        budget.clear_local_value()
@@ -0,0 +1,115 @@
+from panda3d.core import StaticCullNode, NodePath, PandaNode
+
+
+def test_static_cull_node_empty_cache():
+    node = StaticCullNode("static")
+    assert node.get_num_cached_geoms() == 0
+    assert not node.is_cache_valid()
+
+    node.clear_cache()
+    assert node.get_num_cached_geoms() == 0
+
+
+def test_static_cull_node_copy():
+    node = StaticCullNode("static")
+    node.add_child(PandaNode("child"))
+
+    np = NodePath(node).copy_to(NodePath())
+    assert isinstance(np.node(), StaticCullNode)
+    assert np.node().name == "static"
+    assert np.get_num_children() == 1
+    assert not np.node().is_cache_valid()
+
+
+def test_static_cull_node_bam():
+    node = StaticCullNode("static")
+    node.add_child(PandaNode("child"))
+
+    data = NodePath(node).encode_to_bam_stream()
+    np = NodePath.decode_from_bam_stream(data)
+    assert isinstance(np.node(), StaticCullNode)
+    assert np.node().name == "static"
+    assert np.get_num_children() == 1
+
+
+def make_static_scene():
+    from panda3d.core import CardMaker
+
+    maker = CardMaker("card")
+    maker.set_frame(-1, 1, -1, 1)
+
+    static = NodePath(StaticCullNode("static"))
+    for x in range(3):
+        card = static.attach_new_node(maker.generate())
+        card.set_x(x * 3)
+    return static
+
+
+def test_static_cull_node_update_cache():
+    static = make_static_scene()
+    assert static.node().update_cache()
+    assert static.node().is_cache_valid()
+    assert static.node().get_num_cached_geoms() == 3
+
+    static.get_child(0).set_pos(0, 1, 0)
+    assert not static.node().is_cache_valid()
+    assert static.node().update_cache()
+    assert static.node().is_cache_valid()
+
+
+def test_static_cull_node_invalidate_tag():
+    static = make_static_scene()
+    card = static.get_child(1)
+    assert static.node().update_cache()
+
+    card.set_tag("key", "value")
+    assert not static.node().is_cache_valid()
+    assert static.node().update_cache()
+
+    card.clear_tag("key")
+    assert not static.node().is_cache_valid()
+    assert static.node().update_cache()
+
+    card.node().copy_tags(PandaNode("other"))
+    assert not static.node().is_cache_valid()
+
+
+def test_static_cull_node_invalidate_effects():
+    from panda3d.core import CompassEffect, RenderEffects
+
+    static = make_static_scene()
+    card = static.get_child(2)
+    assert static.node().update_cache()
+
+    # A node with an effect must be evaluated at cull time.
+    card.node().set_effect(CompassEffect.make(NodePath()))
+    assert not static.node().is_cache_valid()
+    assert not static.node().update_cache()
+
+    card.node().clear_effect(CompassEffect)
+    assert static.node().update_cache()
+
+    card.node().set_effects(RenderEffects.make(CompassEffect.make(NodePath())))
+    assert not static.node().update_cache()
+
+
+def test_static_cull_node_invalidate_geom_state():
+    from panda3d.core import ColorAttrib, RenderState
+
+    static = make_static_scene()
+    geom_node = static.get_child(0).node()
+    assert static.node().update_cache()
+
+    geom_node.set_geom_state(0, RenderState.make(ColorAttrib.make_flat((1, 0, 0, 1))))
+    assert not static.node().is_cache_valid()
+    assert static.node().update_cache()
+
+
+def test_static_cull_node_textured():
+    from panda3d.core import Texture
+
+    # Textured states are cached, even if the texture has a cull callback.
+    static = make_static_scene()
+    static.set_texture(Texture("texture"))
+    assert static.node().update_cache()
+    assert static.node().get_num_cached_geoms() == 3